@@ -204,6 +204,26 @@ namespace Ogre
 
         ConstBufferPool::BufferPool const *mLastBoundPool;
 
+        struct BonePalette
+        {
+            SkeletonInstance const             *skeleton;
+            RenderableAnimated::IndexMap const *indexMap;
+            uint32                              offset;
+
+            bool matches( const SkeletonInstance             *otherSkeleton,
+                          const RenderableAnimated::IndexMap *otherIndexMap ) const;
+        };
+
+        /// Bone palettes written by fillBuffersFor to the current texture buffer. Skinned
+        /// draws that would write the same palette reference it instead: the last one covers
+        /// Items sharing their SkeletonInstance; the rest are palettes of pose sources, which
+        /// all members of the pose group point to (see SkeletonInstance::setPoseSource).
+        BonePalette            mLastBonePalette;
+        FastArray<BonePalette> mPoseSourceBonePalettes;
+        /// mStartMappedTexBuffer at the time they were written. They can't be
+        /// referenced anymore once the texture buffer gets rebound
+        float const *mBonePalettesTexBufferStart;
+
         float mConstantBiasScale;
 
         bool                        mHasSeparateSamplers;
@@ -591,6 +611,7 @@ namespace Ogre
         static const IdString TwoSidedLighting;
         static const IdString ReceiveShadows;
         static const IdString UsePlanarReflections;
+        static const IdString SharedBonePalette;
 
         static const IdString NormalSamplingFormat;
         static const IdString NormalLa;
@@ -124,6 +124,7 @@ namespace Ogre
     const IdString PbsProperty::TwoSidedLighting = IdString( "two_sided_lighting" );
     const IdString PbsProperty::ReceiveShadows = IdString( "receive_shadows" );
     const IdString PbsProperty::UsePlanarReflections = IdString( "use_planar_reflections" );
+    const IdString PbsProperty::SharedBonePalette = IdString( "shared_bone_palette" );
 
     const IdString PbsProperty::NormalSamplingFormat = IdString( "normal_sampling_format" );
     const IdString PbsProperty::NormalLa = IdString( "normal_la" );
@@ -307,6 +308,7 @@ namespace Ogre
         mDecalsDiffuseMergedEmissive( false ),
         mDecalsSamplerblock( 0 ),
         mLastBoundPool( 0 ),
+        mBonePalettesTexBufferStart( 0 ),
         mConstantBiasScale( 0.1f ),
         mHasSeparateSamplers( 0 ),
         mLastDescTexture( 0 ),
@@ -334,6 +336,7 @@ namespace Ogre
         mAmbientLightMode( AmbientAutoNormal )
     {
         memset( mDecalsTextures, 0, sizeof( mDecalsTextures ) );
+        memset( &mLastBonePalette, 0, sizeof( mLastBonePalette ) );
 
         // Override defaults
         mLightGatheringMode = LightGatherForwardPlus;
@@ -345,6 +348,16 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     HlmsPbs::~HlmsPbs() { destroyAllBuffers(); }
     //-----------------------------------------------------------------------------------
+    bool HlmsPbs::BonePalette::matches( const SkeletonInstance             *otherSkeleton,
+                                        const RenderableAnimated::IndexMap *otherIndexMap ) const
+    {
+        return skeleton == otherSkeleton &&
+               ( indexMap == otherIndexMap ||
+                 ( indexMap->size() == otherIndexMap->size() &&
+                   !memcmp( indexMap->begin(), otherIndexMap->begin(),
+                            indexMap->size() * sizeof( unsigned short ) ) ) );
+    }
+    //-----------------------------------------------------------------------------------
     void HlmsPbs::_changeRenderSystem( RenderSystem *newRs )
     {
         ConstBufferPool::_changeRenderSystem( newRs );
@@ -760,6 +773,14 @@ namespace Ogre
         const bool fresnelWorkflow =
             datablock->getWorkflow() == HlmsPbsDatablock::SpecularAsFresnelWorkflow;
 
+        // v2 skeletal animation (without poses) reaches its bones through a small header that
+        // lets fillBuffersFor point it to a palette shared with other draws
+        if( renderable->hasSkeletonAnimation() && !renderable->getNumPoses() &&
+            !renderable->getVaos( VpNormal ).empty() )
+        {
+            setProperty( kNoTid, PbsProperty::SharedBonePalette, 1 );
+        }
+
         setProperty( kNoTid, PbsProperty::FresnelScalar,
                      datablock->hasSeparateFresnel() || metallicWorkflow );
         setProperty( kNoTid, PbsProperty::FresnelWorkflow, fresnelWorkflow );
@@ -1075,6 +1096,7 @@ namespace Ogre
                      itor->keyName != PbsProperty::UvDiffuse &&
                      itor->keyName != HlmsPsoProp::InputLayoutId &&
                      itor->keyName != HlmsBaseProp::Skeleton && itor->keyName != HlmsBaseProp::Pose &&
+                     itor->keyName != PbsProperty::SharedBonePalette &&
                      itor->keyName != HlmsBaseProp::PoseHalfPrecision &&
                      itor->keyName != HlmsBaseProp::PoseNormals &&
                      itor->keyName != HlmsBaseProp::BonesPerVertex &&
@@ -3000,6 +3022,9 @@ namespace Ogre
         mLastDescTexture = 0;
         mLastDescSampler = 0;
         mLastBoundPool = 0;
+        // Bones may have moved since the last pass
+        mLastBonePalette.skeleton = 0;
+        mPoseSourceBonePalettes.clear();
 
         if( mShadowFilter == ExponentialShadowMaps )
             mCurrentShadowmapSamplerblock = mShadowmapEsmSamplerblock;
@@ -3517,8 +3542,13 @@ namespace Ogre
                     const RenderableAnimated::IndexMap *indexMap =
                         renderableAnimated->getBlendIndexToBoneIndexMap();
 
+                    // Must match PbsProperty::SharedBonePalette. See calculateHashForPreCreate
+                    const bool sharedBonePalette = numPoses == 0u;
+
                     const size_t poseDataSize = numPoses > 0u ? ( 4u + poseWeightsNumFloats ) : 0u;
-                    const size_t minimumTexBufferSize = 12 * indexMap->size() + poseDataSize;
+                    const size_t paletteHeaderSize = sharedBonePalette ? 16u : 0u;
+                    const size_t minimumTexBufferSize =
+                        paletteHeaderSize + 12 * indexMap->size() + poseDataSize;
                     bool exceedsTexBuffer =
                         static_cast<size_t>( currentMappedTexBuffer - mStartMappedTexBuffer ) +
                             minimumTexBufferSize >=
@@ -3544,16 +3574,87 @@ namespace Ogre
                     *currentMappedConstBuffer = uint32( ( distToWorldMatStart << 9 ) |
                                                         ( datablock->getAssignedSlot() & 0x1FF ) );
 
-                    RenderableAnimated::IndexMap::const_iterator itBone = indexMap->begin();
-                    RenderableAnimated::IndexMap::const_iterator enBone = indexMap->end();
+                    const SkeletonInstance *paletteSkeleton = skeleton;
+                    bool writePalette = true;
 
-                    while( itBone != enBone )
+                    if( sharedBonePalette )
                     {
-                        const SimpleMatrixAf4x3 &mat4x3 = skeleton->_getBoneFullTransform( *itBone );
-                        mat4x3.streamTo4x3( currentMappedTexBuffer );
-                        currentMappedTexBuffer += 12;
+                        if( mBonePalettesTexBufferStart != mStartMappedTexBuffer )
+                        {
+                            mLastBonePalette.skeleton = 0;
+                            mPoseSourceBonePalettes.clear();
+                            mBonePalettesTexBufferStart = mStartMappedTexBuffer;
+                        }
+
+                        // Pose group members get skinned with the palette of their source
+                        Matrix4 paletteToWorld = Matrix4::IDENTITY;
+                        if( skeleton->_getPoseSourcePaletteTransform( paletteToWorld ) )
+                            paletteSkeleton = skeleton->getPoseSource();
+
+                        // By default the palette goes right after the header
+                        uint32 paletteOffset = static_cast<uint32>( distToWorldMatStart + 4u );
+                        if( mLastBonePalette.matches( paletteSkeleton, indexMap ) )
+                        {
+                            paletteOffset = mLastBonePalette.offset;
+                            writePalette = false;
+                        }
+                        else if( paletteSkeleton != skeleton )
+                        {
+                            FastArray<BonePalette>::const_iterator itPalette =
+                                mPoseSourceBonePalettes.begin();
+                            FastArray<BonePalette>::const_iterator enPalette =
+                                mPoseSourceBonePalettes.end();
+                            while( itPalette != enPalette &&
+                                   !itPalette->matches( paletteSkeleton, indexMap ) )
+                            {
+                                ++itPalette;
+                            }
+
+                            if( itPalette != enPalette )
+                            {
+                                paletteOffset = itPalette->offset;
+                                writePalette = false;
+                            }
+                        }
+
+                        if( writePalette )
+                        {
+                            mLastBonePalette.skeleton = paletteSkeleton;
+                            mLastBonePalette.indexMap = indexMap;
+                            mLastBonePalette.offset = paletteOffset;
+                            if( paletteSkeleton != skeleton )
+                                mPoseSourceBonePalettes.push_back( mLastBonePalette );
+                        }
 
-                        ++itBone;
+                        // mat4x3 paletteToWorld
+#if !OGRE_DOUBLE_PRECISION
+                        memcpy( currentMappedTexBuffer, &paletteToWorld, 4 * 3 * sizeof( float ) );
+#else
+                        for( int y = 0; y < 3; ++y )
+                        {
+                            for( int x = 0; x < 4; ++x )
+                                currentMappedTexBuffer[y * 4 + x] = paletteToWorld[y][x];
+                        }
+#endif
+                        // uint paletteStart
+                        memcpy( currentMappedTexBuffer + 12, &paletteOffset, sizeof( paletteOffset ) );
+                        currentMappedTexBuffer += paletteHeaderSize;
+                    }
+
+                    if( writePalette )
+                    {
+                        RenderableAnimated::IndexMap::const_iterator itBone = indexMap->begin();
+                        RenderableAnimated::IndexMap::const_iterator enBone = indexMap->end();
+
+                        while( itBone != enBone )
+                        {
+                            const SimpleMatrixAf4x3 &mat4x3 =
+                                paletteSkeleton->_getBoneFullTransform( *itBone );
+                            mat4x3.streamTo4x3( currentMappedTexBuffer );
+                            currentMappedTexBuffer += 12;
+
+                            ++itBone;
+                        }
                     }
                 }
             }
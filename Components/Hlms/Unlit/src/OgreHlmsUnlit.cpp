@@ -327,6 +327,8 @@ namespace Ogre
 
         setProperty( kNoTid, HlmsBaseProp::Skeleton, 0 );
         setProperty( kNoTid, HlmsBaseProp::Normal, 0 );
+        // HlmsBaseProp::OctahedralNormal is left as is. Custom pieces that read
+        // the normal need to know whether to call octahedronDecode
         setProperty( kNoTid, HlmsBaseProp::QTangent, 0 );
         setProperty( kNoTid, HlmsBaseProp::Tangent, 0 );
         setProperty( kNoTid, HlmsBaseProp::Tangent4, 0 );
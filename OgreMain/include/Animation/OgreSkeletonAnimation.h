@@ -48,6 +48,20 @@ namespace Ogre
 
     typedef vector<KeyFrameRigVec::const_iterator>::type KnownKeyFramesVec;
 
+    namespace SkeletonBlendMode
+    {
+        /// How an animation gets combined with the animations of lower layers.
+        /// See SkeletonAnimation::setBlendMode
+        enum SkeletonBlendMode
+        {
+            /// The animation is added on top of the current pose, scaled by its weight
+            Additive,
+            /// The current pose is blended towards the animation's pose by its weight.
+            /// Lower layers have no effect when the weight is 1
+            Override
+        };
+    }  // namespace SkeletonBlendMode
+
     /** \addtogroup Core
      *  @{
      */
@@ -75,8 +89,13 @@ namespace Ogre
     protected:
         IdString mName;
 
+        uint8                               mLayer;
+        SkeletonBlendMode::SkeletonBlendMode mBlendMode;
+
         /// One per track
         KnownKeyFramesVec mLastKnownKeyFrames;
+        /// One per track. Only allocated when the definition is compressed
+        RawSimdUniquePtr<CompressedKfCache, MEMCATEGORY_ANIMATION> mCompressedCache;
 
     public:
         SkeletonAnimation( const SkeletonAnimationDef *definition, const FastArray<size_t> *slotStarts,
@@ -159,6 +178,16 @@ namespace Ogre
         */
         void setBoneWeight( IdString boneName, Real weight );
 
+        /** Sets the per-bone weight of a bone and all of its children, recursively.
+            Useful to mask an animation to a part of the body (e.g. the upper body
+            starting from the spine) when playing it in a different layer.
+        @param boneName
+            The name of the root bone of the subtree. Does nothing if not found.
+        @param weight
+            Weight to apply to all bones in the subtree. See setBoneWeight.
+        */
+        void setSubtreeBoneWeight( IdString boneName, Real weight );
+
         /** Gets the current per-bone weight of a particular bone.
         @param boneName
             The name of the bone to get. If this animation doesn't affect that bone (or the
@@ -269,7 +298,41 @@ namespace Ogre
         void setEnabled( bool bEnable );
         bool getEnabled() const { return mEnabled; }
 
-        void _applyAnimation( const TransformArray &boneTransforms );
+        /** Sets the layer of this animation. Active animations are applied in ascending
+            layer order; animations in the same layer are applied in the order they were
+            enabled.
+        @remarks
+            Layers are mostly useful together with SkeletonBlendMode::Override. E.g. play
+            locomotion in layer 0, and a reload animation in layer 1 masked to the upper
+            body (see setSubtreeBoneWeight).
+            Default is 0.
+        */
+        void  setLayer( uint8 layer );
+        uint8 getLayer() const { return mLayer; }
+
+        /** Sets how this animation gets combined with the result of the animations applied
+            before it (see setLayer).
+        @remarks
+            To crossfade from animation A to B, put B in a higher layer in Override mode, and
+            raise its weight from 0 to 1 (see mWeight).
+            Default is SkeletonBlendMode::Additive, where the weights of all active
+            animations should add up to 1 to get a normalized blend.
+        */
+        void setBlendMode( SkeletonBlendMode::SkeletonBlendMode blendMode ) { mBlendMode = blendMode; }
+        SkeletonBlendMode::SkeletonBlendMode getBlendMode() const { return mBlendMode; }
+
+        /** Applies the animation to the bones.
+        @param numDepthLevels
+            Bones deeper in the hierarchy than this are not animated.
+            See SkeletonInstance::setAnimationLodLevels
+        @param threadIdx
+            Only the depth levels owned by this thread are animated.
+            See SkeletonInstance::_getOwnedDepthLevels
+        @param numThreads
+            Number of threads animating the same SkeletonInstance.
+        */
+        void _applyAnimation( const TransformArray &boneTransforms, size_t numDepthLevels,
+                              size_t threadIdx = 0u, size_t numThreads = 1u );
 
         void _swapBoneWeightsUniquePtr(
             RawSimdUniquePtr<ArrayReal, MEMCATEGORY_ANIMATION> &inOutBoneWeights );
@@ -62,6 +62,11 @@ namespace Ogre
 
         KfTransformArrayMemoryManager *mKfTransformMemoryManager;
 
+        /// CompressedKfTrack headers for all mTracks followed by their keyframes.
+        /// Null unless compress was called
+        void  *mCompressedData;
+        size_t mCompressedDataBytes;
+
         typedef vector<Real>::type              TimestampVec;
         typedef map<size_t, TimestampVec>::type TimestampsPerBlock;
 
@@ -88,6 +93,24 @@ namespace Ogre
                                              Real                      frameRate );
 
     public:
+        /// Max error allowed when compressing. See compress
+        struct CompressionSettings
+        {
+            /// Per component, in the units of the bone's local space
+            Real maxPositionError;
+            /// In radians
+            Real maxOrientationError;
+            /// Per component
+            Real maxScaleError;
+
+            CompressionSettings() :
+                maxPositionError( 0.0005f ),
+                maxOrientationError( 0.0005f ),
+                maxScaleError( 0.0005f )
+            {
+            }
+        };
+
         SkeletonAnimationDef();
         ~SkeletonAnimationDef();
 
@@ -100,6 +123,32 @@ namespace Ogre
 
         void build( const v1::Skeleton *skeleton, const v1::Animation *animation, Real frameRate );
 
+        /** Replaces the full precision keyframes with a compressed representation
+            (see CompressedKfTrack) to reduce memory usage and bandwidth:
+                - Keyframes that can be linearly interpolated from their neighbours
+                  within the given error are removed. This also collapses linear
+                  tracks down to their first & last keyframes.
+                - Position, orientation and scale channels that don't change are
+                  stored once instead of per keyframe.
+                - The rest are quantized to 16 bits per component (orientations use
+                  the smallest three representation).
+            Keyframes get decompressed with SIMD when sampled.
+        @remarks
+            Must be called before any SkeletonInstance using this animation is created.
+            Calling it on an already compressed animation does nothing.
+        @param settings
+            Max error introduced, including quantization.
+        */
+        void compress( const CompressionSettings &settings );
+
+        bool isCompressed() const { return mCompressedData != 0; }
+
+        /// Total number of keyframes across all tracks
+        size_t getNumKeyFrames() const;
+
+        /// Bytes of memory used by the keyframes
+        size_t getKeyFrameMemoryUsage() const;
+
         /// Dumps all the tracks in CSV format to the output string argument.
         /// Mostly for debugging purposes. (also easy example to show how to
         /// enumerate all the tracks and get the bones back from its block index)
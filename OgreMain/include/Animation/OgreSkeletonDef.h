@@ -77,7 +77,12 @@ namespace Ogre
         {
             size_t firstBoneIndex;
             size_t numBonesInLevel;
-            DepthLevelInfo() : firstBoneIndex( std::numeric_limits<size_t>::max() ), numBonesInLevel( 0 )
+            /// Index of the first block of this level in getBindPose
+            size_t firstBoneBlock;
+            DepthLevelInfo() :
+                firstBoneIndex( std::numeric_limits<size_t>::max() ),
+                numBonesInLevel( 0 ),
+                firstBoneBlock( 0 )
             {
             }
         };
@@ -199,6 +204,17 @@ namespace Ogre
             return ( blockIdx & 0xFF000000 ) | ( ( blockIdx & 0x00FFFFFF ) * ARRAY_PACKED_REALS );
         }
 
+        /** Compresses all the animations of this skeleton with the same error budget.
+            See SkeletonAnimationDef::compress.
+        @remarks
+            Must be called before any SkeletonInstance using this definition is created.
+            The memory saved is written to the log.
+        */
+        void compressAnimations( const SkeletonAnimationDef::CompressionSettings &errorBudget );
+
+        /// Returns the memory in bytes used by the keyframes of all the animations
+        size_t getAnimationMemoryUsage() const;
+
         /// @see mSlotToBone
         const IndexToIndexMap &getSlotToBone() const { return mSlotToBone; }
 
@@ -44,6 +44,29 @@ namespace Ogre
     typedef vector<SkeletonAnimation>::type   SkeletonAnimationVec;
     typedef vector<SkeletonAnimation *>::type ActiveAnimationsVec;
 
+    /// See SkeletonInstance::setAnimationLodLevels
+    struct AnimationLodLevel
+    {
+        /// The level is used once the LOD value of the SkeletonInstance's LOD source
+        /// reaches this value (see MovableObject::getLodValue). For the default
+        /// LodStrategy, it's the distance to the camera.
+        Real lodValue;
+        /// Animations are evaluated once every updateInterval frames. Must be >= 1
+        uint16 updateInterval;
+        /// Only this many depth levels of the bone hierarchy are animated. Deeper
+        /// bones (e.g. fingers) keep their last pose.
+        uint16 numAnimatedDepthLevels;
+
+        AnimationLodLevel( Real _lodValue, uint16 _updateInterval,
+                           uint16 _numAnimatedDepthLevels = 0xFFFF ) :
+            lodValue( _lodValue ),
+            updateInterval( _updateInterval ),
+            numAnimatedDepthLevels( _numAnimatedDepthLevels )
+        {
+        }
+    };
+    typedef FastArray<AnimationLodLevel> AnimationLodLevelVec;
+
     /** \addtogroup Core
      *  @{
      */
@@ -84,6 +107,8 @@ namespace Ogre
         TransformArray mBoneStartTransforms;  ///< The start of Transform at each depth level
 
         RawSimdUniquePtr<ArrayReal, MEMCATEGORY_ANIMATION> mManualBones;
+        /// Number of bones set with setManualBone
+        uint32 mNumManualBones;
 
         FastArray<size_t> mSlotStarts;
 
@@ -116,6 +141,24 @@ namespace Ogre
 
         uint16 mRefCount;
 
+        /// Depth levels animated during update. See _updateAnimationLod
+        uint16 mNumAnimatedDepthLevels;
+        /// Staggers the frames in which distant instances get updated
+        uint32 mAnimationLodPhase;
+
+        AnimationLodLevelVec const *mAnimationLodLevels;
+        MovableObject const        *mAnimationLodSource;
+
+        /// When not null, we copy its pose instead of evaluating our animations
+        SkeletonInstance const *mPoseSource;
+
+        /// See setParallelAnimation
+        bool mParallelAnimation;
+
+        /// Resets the first numDepthLevels levels to the binding pose.
+        /// See _updateBoneBlocks for threadIdx & numThreads
+        void resetToPose( size_t numDepthLevels, size_t threadIdx = 0u, size_t numThreads = 1u );
+
     public:
         SkeletonInstance( const SkeletonDef *skeletonDef, BoneMemoryManager *boneMemoryManager );
         ~SkeletonInstance();
@@ -127,6 +170,109 @@ namespace Ogre
         /// Resets the transform of all bones to the binding pose. Manual bones are not reset
         void resetToPose();
 
+        /** Sets the animation LOD levels, to evaluate animations of distant skeletons less
+            often and/or with less bones. Animation LOD needs a LOD source, see
+            setAnimationLodSource.
+        @remarks
+            Only the animations are throttled. Bones still follow the parent node every
+            frame, frozen in their last animated pose.
+        @param lodLevels
+            Levels sorted by AnimationLodLevel::lodValue in ascending order. Below the
+            first level, the skeleton is fully animated every frame.
+            The pointer is stored and can be shared by many SkeletonInstances; it must
+            remain valid until it is unset. Null to disable animation LOD.
+        */
+        void setAnimationLodLevels( const AnimationLodLevelVec *lodLevels );
+        const AnimationLodLevelVec *getAnimationLodLevels() const { return mAnimationLodLevels; }
+
+        /** Sets the MovableObject whose LOD value (as computed by SceneManager::updateAllLods)
+            selects the animation LOD level. Items set themselves as the LOD source
+            of the SkeletonInstance they create.
+        @param lodSource
+            Must outlive this SkeletonInstance, or be unset first. Can be null.
+        */
+        void setAnimationLodSource( const MovableObject *lodSource );
+        const MovableObject *getAnimationLodSource() const { return mAnimationLodSource; }
+
+        /** Instances with an updateInterval of N get animated in the frames where
+            ( frameCount + phase ) % N == 0. By default each instance gets a different
+            phase so that updates get spread evenly across frames.
+        */
+        void   setAnimationLodPhase( uint32 phase );
+        uint32 getAnimationLodPhase() const { return mAnimationLodPhase; }
+
+        /** Internal use. Selects the animation LOD level for this frame.
+        @return
+            True if update() should be called this frame.
+        */
+        bool _updateAnimationLod( uint32 frameCount );
+
+        /** Makes this SkeletonInstance copy the pose of another instance every frame, instead
+            of evaluating its own animations. All the instances following the same source form
+            a pose group: useful for crowds or machinery playing the same animations in sync,
+            as the animations get evaluated only once for the whole group.
+        @remarks
+            Only the local transform of the bones is copied. Each instance still follows its
+            own parent node, and manual bones (see setManualBone) are left untouched.
+        @par
+            Our own animations are ignored while following a source, but their state
+            (enabled, time, weight) is kept.
+        @param poseSource
+            Instance to copy the pose from. Must be based on the same SkeletonDef, belong to the
+            same SceneManager, and not follow another instance itself.
+            Must outlive this SkeletonInstance, or be unset first. Null to animate ourselves.
+        */
+        void                    setPoseSource( const SkeletonInstance *poseSource );
+        const SkeletonInstance *getPoseSource() const { return mPoseSource; }
+
+        /// Internal use. Copies the local transforms of the pose source's bones into ours.
+        void _copyPoseFromSource();
+
+        /** Internal use. Checks whether our bone palette (see _getBoneFullTransform) is the one
+            of our pose source, moved from its parent node to ours. If so, the Hlms can skin us
+            with the palette already uploaded for the source instead of uploading our own.
+        @param outPaletteToWorld [out]
+            Transform from the pose source's palette to ours. Only written when returning true.
+        @return
+            False if we have no pose source, or if manual bones or bones attached to a SceneNode
+            (see setSceneNodeAsParentOfBone) make our pose differ from the source's.
+        */
+        bool _getPoseSourcePaletteTransform( Matrix4 &outPaletteToWorld ) const;
+
+        /** When true, the animations of this SkeletonInstance are evaluated by all worker
+            threads at once, each taking a share of the SIMD bone blocks. Otherwise, each
+            instance is animated entirely by a single thread.
+        @remarks
+            Worth it for skeletons with many bones and many active animations (i.e. blend
+            trees with several layers) which would otherwise take much longer to animate
+            than the rest of the instances. It needs an extra sync between worker threads
+            in SceneManager::updateAllAnimations, thus it's a waste on simple skeletons.
+            Default is false.
+        */
+        void setParallelAnimation( bool bParallel ) { mParallelAnimation = bParallel; }
+        bool getParallelAnimation() const { return mParallelAnimation; }
+
+        /** Internal use. Same as update(), but only touches the depth levels owned by the
+            given thread. See _getOwnedDepthLevels.
+            All threads must be called with the same numThreads for the full skeleton
+            to get updated.
+        */
+        void _updateBoneBlocks( size_t threadIdx, size_t numThreads );
+
+        /** Internal use. Returns the depth levels [outFirst; outLast) animated by threadIdx
+            when numThreads threads animate this skeleton at once. outFirst == outLast if
+            the thread has nothing to do.
+        @remarks
+            Each thread gets a contiguous range of whole depth levels, balanced by their
+            number of bone blocks. Every depth level lives in its own memory pool, thus
+            threads never write to the same cache lines; and the bone blocks shared by
+            instances with few bones always end up in the same thread.
+            Animation LOD is ignored, so that every instance of the same SkeletonDef
+            agrees on the owner of each level.
+        */
+        void _getOwnedDepthLevels( size_t threadIdx, size_t numThreads, size_t &outFirst,
+                                   size_t &outLast ) const;
+
         /** Sets the given node to manual. Manual bones won't be reset to binding pose
             (see resetToPose) and thus are suitable for manual control. However if the
             bone is animated, you're responsible for resetting the position/rotation/scale
@@ -51,6 +51,43 @@ namespace Ogre
 
     typedef vector<KeyFrameRig>::type KeyFrameRigVec;
 
+    /** Quantized keyframes of a SkeletonTrack. See SkeletonAnimationDef::compress
+    @remarks
+        For each animated channel, every keyframe stores 3 uint16 per SIMD slot, laid out
+        SoA (all x, then all y, then all z) so they decode straight into an ArrayVector3:
+            - Position & scale: value = min + quantized * step
+            - Orientation: the smallest three components, 15 bits each, in range
+              [-1 / sqrt(2); 1 / sqrt(2)]. The index of the dropped (largest) component
+              is stored in the highest bit of the first two.
+        Channels that don't change are not stored per keyframe. mPosMin, mScaleMin and
+        mConstantOrientation hold their value instead.
+    */
+    struct CompressedKfTrack
+    {
+        ArrayVector3    mPosMin;
+        ArrayVector3    mPosStep;
+        ArrayVector3    mScaleMin;
+        ArrayVector3    mScaleStep;
+        ArrayQuaternion mConstantOrientation;
+
+        uint16 const *mKeyFrameData;
+        /// Number of uint16 per keyframe
+        uint32 mKeyFrameStride;
+        /// See SkeletonTrack::CompressedChannels
+        uint32 mAnimatedChannels;
+    };
+
+    /** The two keyframes of a compressed track that are being interpolated, already decoded.
+        Each SkeletonAnimation keeps one per track, so a keyframe is only decoded again
+        when playback moves on to another pair.
+    */
+    struct CompressedKfCache
+    {
+        KfTransform mKeyFrames[2];
+        /// Indices of mKeyFrames in the track. ~0 when nothing has been decoded yet
+        uint32 mKeyFrameIdx[2];
+    };
+
     typedef FastArray<BoneTransform> TransformArray;
 
     class _OgreExport SkeletonTrack : public OgreAllocatedObj
@@ -81,7 +118,21 @@ namespace Ogre
 
         KfTransformArrayMemoryManager *mLocalMemoryManager;
 
+        /// Null unless the track was compressed, in which case KeyFrameRig::mBoneTransform
+        /// is null. Owned by SkeletonAnimationDef.
+        CompressedKfTrack const *mCompressed;
+
+        /// Decodes keyframe keyFrameIdx of a compressed track.
+        void decompressKeyFrame( size_t keyFrameIdx, KfTransform &outTransform ) const;
+
     public:
+        enum CompressedChannels
+        {
+            ChannelPosition = 1u << 0u,
+            ChannelOrientation = 1u << 1u,
+            ChannelScale = 1u << 2u
+        };
+
         SkeletonTrack( uint32 boneBlockIdx, KfTransformArrayMemoryManager *kfTransformMemoryManager );
         ~SkeletonTrack();
 
@@ -98,6 +149,14 @@ namespace Ogre
         const KeyFrameRigVec &getKeyFrames() const { return mKeyFrameRigs; }
         KeyFrameRigVec       &_getKeyFrames() { return mKeyFrameRigs; }
 
+        bool isCompressed() const { return mCompressed != 0; }
+        /// Switches the track to the compressed keyframes. mKeyFrameRigs must already
+        /// match them. See SkeletonAnimationDef::compress
+        void _setCompressed( const CompressedKfTrack *compressed );
+
+        /// Retrieves the transforms of the given keyframe (decompressing them if needed)
+        void getKeyFrameTransform( size_t keyFrameIdx, KfTransform &outTransform ) const;
+
         inline void getKeyFrameRigAt( KeyFrameRigVec::const_iterator &inOutPrevFrame,
                                       KeyFrameRigVec::const_iterator &outNextFrame, Real frame ) const;
 
@@ -117,10 +176,19 @@ namespace Ogre
         @param KfTransforms [out]
             An array with all bone transformations, sorted by parent level.
             The key frames are only applied to affected bones.
+        @param bindPose [in]
+            Binding pose of the block animated by this track. When present, the bones are
+            blended towards the keyframe by the weight (SkeletonBlendMode::Override).
+            When null, the keyframe is added to the current transform instead.
+        @param inOutCompressedCache [in/out]
+            Only used by compressed tracks. Keyframes already decoded by previous calls.
+            When null, both keyframes are decoded on every call.
         */
         void applyKeyFrameRigAt( KeyFrameRigVec::const_iterator &inOutLastKnownKeyFrame, float frame,
                                  ArrayReal animWeight, const ArrayReal *RESTRICT_ALIAS perBoneWeights,
-                                 const TransformArray &KfTransforms ) const;
+                                 const TransformArray &KfTransforms,
+                                 const KfTransform *RESTRICT_ALIAS bindPose = 0,
+                                 CompressedKfCache *RESTRICT_ALIAS inOutCompressedCache = 0 ) const;
 
         /** Takes all KeyFrames and repeats the KfTransforms for every unused slot by a pattern
             based on the number of used slots. Only useful when
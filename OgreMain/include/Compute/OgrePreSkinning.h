@@ -0,0 +1,192 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-present Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgrePreSkinning_H_
+#define _OgrePreSkinning_H_
+
+#include "OgrePrerequisites.h"
+
+#include "Compositor/OgreCompositorWorkspaceListener.h"
+#include "OgreRenderable.h"
+#include "OgreResourceTransition.h"
+#include "Vao/OgreDynamicUploadRing.h"
+
+#include "ogrestd/map.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** Skins the vertices of animated Items once per frame using a compute shader, so that all
+        passes (regular, every shadow map, reflections, etc) draw them as static geometry instead
+        of each pass skinning them again in its vertex shader.
+    @remarks
+        Register it with CompositorManager2::addListener. Skinning happens in
+        allWorkspacesBeforeBeginUpdate, i.e. after SceneManager::updateSceneGraph updated the
+        animations and before any pass gets executed. Items which are not visible
+        (see MovableObject::setVisible) or not attached are skipped and keep last
+        frame's results.
+    @par
+        Each pre-skinned SubItem gets its own copy of the vertex buffer, with position,
+        normal and tangent in object space, and its own Vaos which are used for both the
+        regular and the shadow caster passes.
+        Compute shaders can't write to vertex buffers directly, therefore the results are
+        written to a UAV buffer and then copied on the GPU into the vertex buffer.
+    @par
+        SubItems are left untouched (and skinned in the vertex shader as usual) unless:
+            - Position is VET_FLOAT3 or VET_FLOAT4.
+            - Normal and tangent (both optional) are VET_FLOAT3 or VET_FLOAT4.
+              QTangents are not supported.
+            - Blend indices are VET_UBYTE4, blend weights VET_FLOAT1-4 or VET_UBYTE4_NORM.
+            - All of the above are in the same vertex buffer, aligned to 4 bytes.
+            - There is no pose animation.
+            - The submesh has its own vertex buffer (see MeshManager::setShareStaticBuffers).
+    @par
+        Requires the compute job "Compute/Algorithms/PreSkinning" from
+        Samples/Media/Compute/Algorithms/PreSkinning
+    */
+    class _OgreExport PreSkinning : public CompositorWorkspaceListener
+    {
+    protected:
+        struct SkinnedVertexBuffer
+        {
+            /// The vertex buffer from the Mesh
+            VertexBufferPacked *srcVertexBuffer;
+            /// Raw copy of srcVertexBuffer that compute shaders can read. Shared by all Items.
+            UavBufferPacked *srcUavBuffer;
+            UavBufferPacked *dstUavBuffer;
+            /// Copy of dstUavBuffer that gets rendered
+            VertexBufferPacked *dstVertexBuffer;
+
+            const RenderableAnimated::IndexMap *blendIndexToBoneIndexMap;
+
+            /// See vertexLayout0 & vertexLayout1 in PreSkinning_piece_cs.any
+            uint32 vertexLayout[8];
+
+            /// Bone matrices for this frame
+            DynamicUploadRing::Allocation boneMatrices;
+
+            SkinnedVertexBuffer() :
+                srcVertexBuffer( 0 ),
+                srcUavBuffer( 0 ),
+                dstUavBuffer( 0 ),
+                dstVertexBuffer( 0 ),
+                blendIndexToBoneIndexMap( 0 )
+            {
+                memset( vertexLayout, 0, sizeof( vertexLayout ) );
+            }
+        };
+
+        typedef vector<SkinnedVertexBuffer>::type SkinnedVertexBufferVec;
+
+        struct PreSkinnedItem
+        {
+            Item *item;
+            SkinnedVertexBufferVec buffers;
+            /// Vaos we created, to be destroyed when the Item is removed
+            VertexArrayObjectArray vaos;
+            /// SubItems that are pre-skinned
+            FastArray<SubItem *> subItems;
+        };
+
+        typedef vector<PreSkinnedItem>::type PreSkinnedItemVec;
+
+        struct SharedSrcBuffer
+        {
+            UavBufferPacked *uavBuffer;
+            uint32 refCount;
+        };
+
+        typedef map<VertexBufferPacked *, SharedSrcBuffer>::type SharedSrcBufferMap;
+
+        HlmsCompute *mHlmsCompute;
+        VaoManager *mVaoManager;
+        HlmsComputeJob *mJob;
+
+        PreSkinnedItemVec mItems;
+        SharedSrcBufferMap mSharedSrcBuffers;
+
+        /// Items being skinned this frame. Here to avoid reallocations
+        FastArray<PreSkinnedItem *> mItemsToSkin;
+
+        ResourceTransitionArray mResourceTransitions;
+
+        /** Fills skinnedBuffer.vertexLayout for the given Vao.
+        @return
+            False if the vertex format is not supported
+        */
+        static bool fillVertexLayout( const VertexArrayObject *vao,
+                                      SkinnedVertexBuffer &skinnedBuffer );
+
+        UavBufferPacked *acquireSrcBuffer( VertexBufferPacked *srcVertexBuffer );
+        void releaseSrcBuffer( VertexBufferPacked *srcVertexBuffer );
+
+        void destroy( PreSkinnedItem &preSkinnedItem );
+
+        void uploadBoneMatrices( PreSkinnedItem &preSkinnedItem );
+        void dispatch( const SkinnedVertexBuffer &skinnedBuffer );
+
+    public:
+        /**
+        @param vaoManager
+        @param hlmsCompute
+            Can be null as long as nothing gets pre-skinned (i.e. no Item was added)
+        */
+        PreSkinning( VaoManager *vaoManager, HlmsCompute *hlmsCompute );
+        virtual ~PreSkinning();
+
+        /** Starts pre-skinning the given Item.
+        @remarks
+            The Item must be removed (see removeItem) before it gets destroyed
+            or its Mesh gets unloaded.
+        @return
+            True if at least one of its SubItems will be pre-skinned.
+            False if none of them could (see class remarks) or if it has no skeleton.
+        */
+        bool addItem( Item *item );
+
+        /// Stops pre-skinning the given Item. Its SubItems go back to being
+        /// skinned in the vertex shader.
+        void removeItem( Item *item );
+
+        /// Removes all Items
+        void removeAllItems();
+
+        size_t getNumItems() const { return mItems.size(); }
+
+        /// Skins all the visible Items. Called automatically in allWorkspacesBeforeBeginUpdate.
+        void update();
+
+        /// CompositorWorkspaceListener override
+        void allWorkspacesBeforeBeginUpdate() override;
+    };
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
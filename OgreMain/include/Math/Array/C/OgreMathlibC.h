@@ -258,6 +258,12 @@ namespace Ogre
         /// Converts 32-bit integer to float
         static inline ArrayReal ConvertToF32( ArrayInt a ) { return static_cast<ArrayReal>( a ); }
 
+        /// Converts ARRAY_PACKED_REALS unsigned 16-bit integers, ANDed with mask, to float
+        static inline ArrayReal LoadU16ToF32( const uint16 *src, uint16 mask )
+        {
+            return static_cast<ArrayReal>( *src & mask );
+        }
+
         /// Returns the maximum value between a and b
         static inline ArrayReal Max( ArrayReal a, ArrayReal b ) { return std::max( a, b ); }
 
@@ -416,6 +416,12 @@ namespace Ogre
         /// Converts 32-bit integer to float
         static inline ArrayReal ConvertToF32( ArrayInt a ) { return vcvtq_f32_s32( a ); }
 
+        /// Converts ARRAY_PACKED_REALS unsigned 16-bit integers, ANDed with mask, to float
+        static inline ArrayReal LoadU16ToF32( const uint16 *src, uint16 mask )
+        {
+            return vcvtq_f32_u32( vmovl_u16( vand_u16( vld1_u16( src ), vdup_n_u16( mask ) ) ) );
+        }
+
         /// Returns the maximum value between a and b
         static inline ArrayReal Max( ArrayReal a, ArrayReal b ) { return vmaxq_f32( a, b ); }
 
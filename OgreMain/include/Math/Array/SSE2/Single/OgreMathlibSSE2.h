@@ -303,6 +303,14 @@ namespace Ogre
         /// Converts 32-bit integer to float
         static inline ArrayReal ConvertToF32( ArrayInt a ) { return _mm_cvtepi32_ps( a ); }
 
+        /// Converts ARRAY_PACKED_REALS unsigned 16-bit integers, ANDed with mask, to float
+        static inline ArrayReal LoadU16ToF32( const uint16 *src, uint16 mask )
+        {
+            __m128i val = _mm_loadl_epi64( reinterpret_cast<const __m128i *>( src ) );
+            val = _mm_and_si128( val, _mm_set1_epi16( static_cast<short>( mask ) ) );
+            return _mm_cvtepi32_ps( _mm_unpacklo_epi16( val, _mm_setzero_si128() ) );
+        }
+
         /// Returns the maximum value between a and b
         static inline ArrayReal Max( ArrayReal a, ArrayReal b ) { return _mm_max_ps( a, b ); }
 
@@ -0,0 +1,238 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreAsyncTextureReadbackBatcher_H_
+#define _OgreAsyncTextureReadbackBatcher_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgreTextureBox.h"
+#include "OgreTextureGpu.h"
+#include "OgreTimer.h"
+#include "Threading/OgreLightweightMutex.h"
+
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+     *  @{
+     */
+    /** \addtogroup Resources
+     *  @{
+     */
+
+    class _OgreExport AsyncTextureReadbackListener
+    {
+    public:
+        virtual ~AsyncTextureReadbackListener();
+
+        /** Called when a download requested via AsyncTextureReadbackBatcher::download is ready.
+        @param texture
+            The texture the data was downloaded from. For identification purposes only,
+            it may have been destroyed by the time this gets called.
+        @param mipLevel
+            Mip level that was downloaded.
+        @param box
+            The downloaded data. Only valid during this call; copy it if you need it later.
+        @param pixelFormat
+            Pixel format of the data (the texture's format family).
+        @param userData
+            Value passed to AsyncTextureReadbackBatcher::download.
+        @remarks
+            It's safe to call AsyncTextureReadbackBatcher::download from here, e.g. to
+            request the next readback. It will be delivered by a later update().
+        */
+        virtual void readbackFinished( TextureGpu *texture, uint8 mipLevel, const TextureBox &box,
+                                       PixelFormatGpu pixelFormat, void *userData ) = 0;
+    };
+
+    /** Reading back many small textures (probe captures, picking buffers, thumbnails, etc)
+        with an AsyncTextureTicket each means lots of tiny staging allocations, and lots
+        of fences or queryIsTransferDone calls.
+
+        This class batches them instead:
+            - AsyncTextureTickets are pooled by resolution & format and reused
+              across requests, so steady-state readbacks don't allocate.
+            - All transfers use inaccurate tracking, which relies on the
+              VaoManager's per-frame fence rather than one fence per transfer.
+            - update() checks each frame that has transfers in flight once,
+              and delivers all its results together.
+    @remarks
+        Results are delivered through AsyncTextureReadbackListener:
+            - With DeliveryMode Immediate, from within update().
+              Single slice downloads are handed over straight from the mapped
+              staging memory without copying.
+            - With DeliveryMode Deferred, results get copied to system RAM in
+              update() and listeners are called from dispatchDeferred(), which
+              can be called from any thread.
+
+        update() must be called from the render thread, once per frame
+        (e.g. after SceneManager::updateSceneGraph or Root::renderOneFrame).
+        Data is typically available 2-3 frames after it was requested.
+    */
+    class _OgreExport AsyncTextureReadbackBatcher : public OgreAllocatedObj
+    {
+    public:
+        enum DeliveryMode
+        {
+            Immediate,
+            Deferred
+        };
+
+        struct Stats
+        {
+            /// Number of downloads requested but not yet delivered
+            size_t numInFlight;
+            /// Bytes requested but not yet delivered
+            size_t bytesInFlight;
+            /// Number of downloads delivered since last resetStats
+            uint64 numCompleted;
+            /// Bytes delivered since last resetStats
+            uint64 bytesCompleted;
+            /// Sum of latencies (from download() to delivery), in frames
+            uint64 accumLatencyFrames;
+            /// Sum of latencies (from download() to delivery), in microseconds
+            uint64 accumLatencyUs;
+            uint32 maxLatencyFrames;
+            uint64 maxLatencyUs;
+            /// AsyncTextureTickets owned by the batcher (both in use & free)
+            size_t numTickets;
+
+            Stats();
+
+            float getAvgLatencyFrames() const;
+            float getAvgLatencyMs() const;
+        };
+
+    protected:
+        struct PendingDownload
+        {
+            AsyncTextureTicket           *ticket;
+            TextureGpu                   *texture;
+            AsyncTextureReadbackListener *listener;
+            void                         *userData;
+            uint32                        frameIssued;
+            uint64                        timeIssuedUs;
+            size_t                        sizeBytes;
+            uint8                         mipLevel;
+        };
+        typedef vector<PendingDownload>::type PendingDownloadVec;
+
+        struct DeferredResult
+        {
+            TextureGpu                   *texture;
+            AsyncTextureReadbackListener *listener;
+            void                         *userData;
+            TextureBox                    box;
+            PixelFormatGpu                pixelFormat;
+            uint8                         mipLevel;
+        };
+        typedef vector<DeferredResult>::type DeferredResultVec;
+
+        typedef vector<AsyncTextureTicket *>::type AsyncTextureTicketVec;
+
+        TextureGpuManager *mTextureManager;
+        VaoManager        *mVaoManager;
+        DeliveryMode       mDeliveryMode;
+
+        /// Sorted by frameIssued (requests are appended in order)
+        PendingDownloadVec    mPendingDownloads;
+        /// Downloads being processed by update(). Listeners may append to mPendingDownloads
+        PendingDownloadVec    mPendingDownloadsTmp;
+        AsyncTextureTicketVec mFreeTickets;
+
+        LightweightMutex  mDeferredMutex;
+        DeferredResultVec mDeferredResults;
+        DeferredResultVec mDeferredResultsTmp;
+
+        /// Reused by update() when a ticket can only map one slice at a time
+        vector<uint8>::type mScratch;
+
+        Timer mTimer;
+        Stats mStats;
+
+        AsyncTextureTicket *getTicket( uint32 width, uint32 height, uint32 depthOrSlices,
+                                       TextureTypes::TextureTypes textureType,
+                                       PixelFormatGpu             pixelFormatFamily );
+
+        /// Maps the ticket and delivers the result. The ticket is returned to the pool
+        void deliver( const PendingDownload &pending );
+
+    public:
+        AsyncTextureReadbackBatcher( TextureGpuManager *textureManager,
+                                     DeliveryMode       deliveryMode = Immediate );
+        ~AsyncTextureReadbackBatcher();
+
+        /** Requests downloading a texture (or a region of it) GPU -> CPU.
+            See AsyncTextureTicket::download for the requirements on textureSrc.
+        @param textureSrc
+            Texture to download from.
+        @param mipLevel
+            Mip level to download.
+        @param listener
+            Listener to notify once the data is ready. Must outlive the request.
+        @param userData
+            Passed back to listener.
+        @param srcBox
+            Region to download. Null to download the whole mip.
+        */
+        void download( TextureGpu *textureSrc, uint8 mipLevel, AsyncTextureReadbackListener *listener,
+                       void *userData = 0, TextureBox *srcBox = 0 );
+
+        /** Delivers every download whose frame has finished on the GPU.
+            Must be called from the render thread, ideally once per frame.
+        @param bWaitForAll
+            When true, stalls until every pending download is delivered.
+        */
+        void update( bool bWaitForAll = false );
+
+        /// Calls the listeners of results collected by update() when using DeliveryMode Deferred.
+        /// Can be called from any thread (but only from one thread at a time).
+        void dispatchDeferred();
+
+        /// Cancels all pending downloads without calling their listeners.
+        /// Deferred results already collected are discarded as well.
+        void cancelAll();
+
+        /// Destroys the pooled tickets not currently in use, releasing their staging memory.
+        void freeUnusedTickets();
+
+        const Stats &getStats() const { return mStats; }
+        void         resetStats();
+    };
+
+    /** @} */
+    /** @} */
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
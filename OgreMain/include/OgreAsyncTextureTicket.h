@@ -189,6 +189,8 @@ namespace Ogre
         uint32         getNumSlices() const;
         PixelFormatGpu getPixelFormatFamily() const;
 
+        TextureTypes::TextureTypes getTextureType() const { return mTextureType; }
+
         uint32 getBytesPerRow() const;
         size_t getBytesPerImage() const;
 
@@ -0,0 +1,92 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreBCnEncoder_H_
+#define _OgreBCnEncoder_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgrePixelFormatGpu.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+     *  @{
+     */
+    /** \addtogroup Image
+     *  @{
+     */
+    /** Simple and fast CPU encoder for BC1, BC3, BC4, BC5 & BC7 (mode 6 only).
+
+        It is meant for compressing textures at load time (see TextureFilter::CompressBCn),
+        thus it favours speed over quality: endpoints are fitted along the principal axis
+        of each 4x4 block, with one least squares refinement for BC1/BC3 colours.
+        Offline tools will produce better results.
+    @remarks
+        sRGB formats are encoded without any colour space conversion: the raw values
+        of an sRGB source are stored as-is into the sRGB variant of the block format.
+    */
+    class _OgreExport BCnEncoder
+    {
+    public:
+        /// Returns the uncompressed format the blocks of dstFormat are encoded from.
+        /// i.e. PFG_RGBA8_UNORM for BC1/BC3/BC7, PFG_R8_UNORM for BC4_UNORM.
+        /// Returns PFG_UNKNOWN if dstFormat can't be encoded.
+        static PixelFormatGpu getEncodingSourceFormat( PixelFormatGpu dstFormat );
+
+        /// Returns true if compress() can encode from srcFormat into dstFormat
+        static bool isSupported( PixelFormatGpu srcFormat, PixelFormatGpu dstFormat );
+
+        /** Compresses src into dst.
+        @param src
+            Source data. Its resolution doesn't need to be a multiple of 4
+            (edge texels are replicated to fill partial blocks).
+        @param srcFormat
+            Must be a format that isSupported() accepts.
+        @param dst
+            Destination. Must have the same resolution as src and enough
+            room for the compressed data.
+        @param dstFormat
+            One of PFG_BC1_UNORM, PFG_BC3_UNORM, PFG_BC4_UNORM, PFG_BC4_SNORM,
+            PFG_BC5_UNORM, PFG_BC5_SNORM, PFG_BC7_UNORM or their sRGB variants.
+        @param numThreads
+            Maximum number of threads to encode with, including the calling one.
+            Small images use fewer threads, as spawning them would cost more than it saves.
+        */
+        static void compress( const TextureBox &src, PixelFormatGpu srcFormat, TextureBox &dst,
+                              PixelFormatGpu dstFormat, uint32 numThreads = 1u );
+    };
+
+    /** @} */
+    /** @} */
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -236,6 +236,14 @@ namespace Ogre
             /// synchronize HBU_NO_OVERWRITE and avoid expensive stalls (specially on GL)
             VaoManager *mVaoManager;
 
+            /// Colour format of the vertex buffer. Cached by beginBillboards() to avoid
+            /// querying the RenderSystem for every billboard.
+            VertexElementType mColourType;
+
+            /// Contiguous copy of mActiveBillboards so that genVerticesBatch() can be
+            /// split across worker threads.
+            vector<const Billboard *>::type mBillboardsToGen;
+
             /// Internal method for culling individual billboards
             inline bool billboardVisible( const Camera *cam, const Billboard &bill );
 
@@ -269,6 +277,21 @@ namespace Ogre
             */
             void genVertices( const Vector3 *const offsets, const Billboard &pBillboard );
 
+            /** Returns true if the axes of all billboards are the same (i.e. the corners only
+                depend on each billboard's position and dimensions) and billboards aren't culled
+                individually. See genVerticesBatch().
+            */
+            bool canGenVerticesBatched() const;
+
+            /** Internal method for generating vertex data of
+                mBillboardsToGen[firstBillboard; firstBillboard + numBillboards) using SIMD.
+            @remarks
+                Produces the same output as injectBillboard() but can only be used if
+                canGenVerticesBatched() returns true.
+                Can be called from multiple threads as long as the ranges don't overlap.
+            */
+            void genVerticesBatch( size_t firstBillboard, size_t numBillboards );
+
             /** Internal method generates vertex offsets.
             @remarks
                 Takes in parametric offsets as generated from getParametericOffsets, width and height
@@ -201,6 +201,21 @@ namespace Ogre
             */
             EdgeData *build();
 
+            /** Lets build() split its work across the worker threads of the given SceneManager.
+            @remarks
+                Vertex welding and edge connection are split across threads by hashing,
+                so the result is exactly the same regardless of the number of threads.
+                Small inputs are always built on the calling thread.
+            @par
+                build() then blocks on SceneManager::executeUserScalableTask, thus it must
+                be called from the thread that updates the SceneManager, and not while it's
+                updating (e.g. not from a background loading thread).
+            @param sceneManager
+                Null (default) to build on the calling thread.
+            */
+            void          setSceneManager( SceneManager *sceneManager ) { mSceneManager = sceneManager; }
+            SceneManager *getSceneManager() const { return mSceneManager; }
+
             /// Debugging method
             void log( Log *l );
 
@@ -238,22 +253,6 @@ namespace Ogre
                     return a.indexSet < b.indexSet;
                 }
             };
-            /** Comparator for unique vertex list */
-            struct vectorLess
-            {
-                bool operator()( const Vector3 &a, const Vector3 &b ) const
-                {
-                    if( a.x < b.x )
-                        return true;
-                    if( a.x > b.x )
-                        return false;
-                    if( a.y < b.y )
-                        return true;
-                    if( a.y > b.y )
-                        return false;
-                    return a.z < b.z;
-                }
-            };
 
             typedef vector<const VertexData *>::type VertexDataList;
             typedef vector<Geometry>::type           GeometryList;
@@ -263,24 +262,10 @@ namespace Ogre
             VertexDataList   mVertexDataList;
             CommonVertexList mVertices;
             EdgeData        *mEdgeData;
-            /// Map for identifying common vertices
-            typedef map<Vector3, size_t, vectorLess>::type CommonVertexMap;
-            CommonVertexMap                                mCommonVertexMap;
-            /** Edge map, used to connect edges. Note we allow many triangles on an edge,
-            after connected an existing edge, we will remove it and never used again.
-            */
-            typedef multimap<std::pair<size_t, size_t>, std::pair<size_t, size_t> >::type EdgeMap;
-            EdgeMap                                                                       mEdgeMap;
-
-            void buildTrianglesEdges( const Geometry &geometry );
+            SceneManager    *mSceneManager;
 
-            /// Finds an existing common vertex, or inserts a new one
-            size_t findOrCreateCommonVertex( const Vector3 &vec, size_t vertexSet, size_t indexSet,
-                                             size_t originalIndex );
-            /// Connect existing edge or create a new edge - utility method during building
-            void connectOrCreateEdge( size_t vertexSet, size_t triangleIndex, size_t vertIndex0,
-                                      size_t vertIndex1, size_t sharedVertIndex0,
-                                      size_t sharedVertIndex1 );
+            /// Returns how many threads to use for a workload of numTriangles
+            size_t calculateNumThreads( size_t numTriangles ) const;
         };
         /** @} */
         /** @} */
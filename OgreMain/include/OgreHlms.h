@@ -1187,6 +1187,8 @@ namespace Ogre
         static const IdString PoseNormals;
 
         static const IdString Normal;
+        /// Normal is 2x16-bit SNORM, octahedral-encoded.
+        static const IdString OctahedralNormal;
         static const IdString QTangent;
         static const IdString Tangent;
         static const IdString Tangent4;
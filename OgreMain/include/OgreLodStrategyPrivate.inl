@@ -33,6 +33,7 @@ namespace Ogre
         for( size_t j = 0; j < ARRAY_PACKED_REALS; ++j )
         {
             MovableObject *owner = objData.mOwner[j];
+            owner->mLodValue = lodValues[j];
 
             // This may look like a lot of ugly indirections, but mLodMerged is a pointer that allows
             // sharing with many MovableObjects (it should perfectly fit even in small caches).
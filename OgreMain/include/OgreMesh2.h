@@ -32,6 +32,7 @@ THE SOFTWARE.
 
 #include "Math/Simple/OgreAabb.h"
 #include "OgreDataStream.h"
+#include "OgreMeshOptimizer.h"
 #include "OgreResource.h"
 #include "OgreVertexBoneAssignment.h"
 #include "Vao/OgreBufferPacked.h"
@@ -50,6 +51,7 @@ namespace Ogre
      */
 
     class LodStrategy;
+    class MeshSerializer;
 
     /** Resource holding data about 3D mesh.
     @remarks
@@ -148,6 +150,14 @@ namespace Ogre
         /// @copydoc Resource::calculateSize
         size_t calculateSize() const override;
 
+        /// Falls back to the file's timestamp when the mesh had no hash. See msUseTimestampAsHash
+        void applyTimestampAsHash();
+
+        /// @see importV1. When quantization is not null, halfPos
+        /// & halfTexCoords are ignored.
+        void importV1Impl( v1::Mesh *mesh, bool halfPos, bool halfTexCoords, bool qTangents,
+                           bool halfPose, const VertexQuantizationSettings *quantization );
+
     public:
         /** Default constructor - used by MeshManager
         @warning
@@ -454,16 +464,73 @@ namespace Ogre
         void importV1( v1::Mesh *mesh, bool halfPos, bool halfTexCoords, bool qTangents,
                        bool halfPose = true );
 
+        /** Imports a v1 mesh to this mesh, analyzing the range of each SubMesh's vertex data
+            to choose the smallest vertex format that satisfies the given precision requirements.
+            @see VertexQuantizationSettings
+        @remarks
+            Positions may be stored as 16-bit half, texture coordinates as 16-bit UNORM, SNORM
+            or half, and normals as QTangents (if there are tangents) or octahedral
+            2x16-bit SNORM; which usually halves the vertex size.
+            See the other importV1 overload for the rest of the parameters.
+        */
+        void importV1( v1::Mesh *mesh, const VertexQuantizationSettings &quantization,
+                       bool halfPose = true );
+
         /// Converts this SubMesh to an efficient arrangement. See Mesh::importV1 for an
         /// explanation on the parameters. @see dearrangeEfficientToInefficient
         /// to perform the opposite operation.
         void arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents );
 
+        /// Converts all submeshes to the smallest vertex format that satisfies
+        /// the given precision requirements. @see VertexQuantizationSettings
+        void arrangeEfficient( const VertexQuantizationSettings &quantization );
+
         /// Reverts the effects from arrangeEfficient by converting all 16-bit half float back
         /// to 32-bit float; and QTangents to Normal, Tangent + Reflection representation,
         /// which are more compatible for doing certain operations vertex operations in the CPU.
         void dearrangeToInefficient();
 
+        /** Reorders the indices (and optionally the vertices) of all submeshes for better
+            post-transform cache locality, less overdraw and sequential vertex fetches.
+            @see MeshOptimizer.
+        @remarks
+            The mesh must not be in use by any Item, as buffers and Vaos are recreated.
+            Shadow mapping Vaos are kept in sync (they're regenerated if they were
+            independent, or shared again if they weren't).
+            Large meshes can take long to optimize thus it is recommended to perform this
+            offline (i.e. OgreMeshTool -vc) and save it into the mesh file.
+        @param overdraw
+            When true, reorders clusters of triangles to reduce overdraw.
+        @param vertexFetch
+            When true, reorders vertices in the order they're first referenced.
+            Ignored for submeshes with pose animations.
+        @param overdrawThreshold
+            How much ACMR the overdraw optimization may sacrifice. e.g. 1.05 = up to 5% worse.
+        */
+        void optimizeVertexCache( bool overdraw = true, bool vertexFetch = true,
+                                  float overdrawThreshold = 1.05f );
+
+        /** Splits every LOD of every submesh into meshlets (small clusters of triangles)
+            with a bounding sphere and a normal cone, so they can be frustum and backface
+            culled individually (see MeshOptimizer::cullMeshlets and SubMesh::getMeshletBuffer).
+        @remarks
+            Indices are reordered so the triangles of each meshlet are contiguous.
+            Call it after optimizeVertexCache, which discards the meshlets.
+            The mesh must not be in use by any Item. Meshlets are saved by the MeshSerializer.
+        @param maxVertices
+            Max number of different vertices per meshlet.
+        @param maxTriangles
+            Max number of triangles per meshlet.
+        */
+        void buildMeshlets( uint32 maxVertices = 64u, uint32 maxTriangles = 124u );
+
+        /// Returns true if any submesh has meshlets.
+        bool hasMeshlets() const;
+
+        /// Returns the combined post-transform cache statistics of the first LOD of every
+        /// submesh, simulating a FIFO cache of the given size.
+        MeshOptimizer::VertexCacheStats analyzeVertexCache( uint32 cacheSize = 16u ) const;
+
         /// When this bool is false, prepareForShadowMapping will use the same Vaos for
         /// both regular and shadow mapping rendering. When it's true, it will
         /// calculate an optimized version to speed up shadow map rendering (uses a bit
@@ -494,6 +561,27 @@ namespace Ogre
         /// but are rather their own separate set of optimized geometry.
         bool hasIndependentShadowMappingVaos() const;
 
+        /** Marks the mesh as being loaded by MeshManager::loadAsync. Main thread only.
+        @remarks
+            While in this state the mesh is background loaded, thus load() returns
+            immediately and Items using it stay empty until loading finishes.
+        @return
+            False if the mesh is manual, already loaded or being loaded.
+        */
+        bool _beginAsyncLoad();
+
+        /// Reads and parses the file without touching the VaoManager. Safe to
+        /// call from a worker thread. Throws on failure.
+        void _parseAsyncLoad( MeshSerializer &serializer );
+
+        /// Creates the GPU buffers, sets the mesh as loaded and notifies the
+        /// listeners. Main thread only. Throws on failure.
+        void _finishAsyncLoad( MeshSerializer &serializer );
+
+        /// Reverts _beginAsyncLoad after _parseAsyncLoad or _finishAsyncLoad
+        /// failed, leaving the mesh unloaded. Main thread only.
+        void _abortAsyncLoad();
+
         /// will manually set the vao manager the mesh will use when it loads.
         /// setting this when the mesh is already loaded will cause a crash on unload, use with caution!
         inline void _setVaoManager( VaoManager *vaoManager ) { mVaoManager = vaoManager; }
@@ -66,7 +66,11 @@ namespace Ogre
 
         /// OGRE version v2.0+
         MESH_VERSION_2_1,
-        MESH_VERSION_LEGACY  // R0 & R1 (beta)
+        MESH_VERSION_LEGACY,  // R0 & R1 (beta), R2 (no meshlets)
+        /// Same as 2.1, but vertex & index buffers are stored page-aligned after the
+        /// mesh data and optionally compressed. Must be requested explicitly.
+        /// See MeshSerializer::setCompressPayloads
+        MESH_VERSION_3_0
     };
 
     /** \addtogroup Core
@@ -162,12 +166,39 @@ namespace Ogre
         */
         void importMesh( DataStreamPtr &stream, Mesh *pDest );
 
+        /** Same as importMesh, but the VaoManager isn't touched so it can be called from a
+            worker thread. The Mesh isn't usable until finishDeferredImport is called.
+        @remarks
+            The listener's processMeshCompleted is called by finishDeferredImport.
+            Only one deferred import can be in flight per MeshSerializer.
+        */
+        void importMeshDeferred( DataStreamPtr &stream, Mesh *pDest );
+
+        /** Creates the vertex & index buffers, Vaos and links the skeleton of the Mesh
+            previously parsed by importMeshDeferred. Must be called from the main thread.
+        */
+        void finishDeferredImport( Mesh *pDest );
+
+        /** Whether MESH_VERSION_3_0 exports compress vertex and index buffers.
+        @remarks
+            Compressed buffers take less disk space and I/O bandwidth, and are decompressed
+            quickly while loading. Uncompressed buffers can be used directly from a memory
+            mapped file. Meshes can be loaded either way regardless of this setting.
+            Default is true.
+        */
+        void setCompressPayloads( bool bCompress );
+        bool getCompressPayloads() const;
+
         /// Sets the listener for this serializer
         void setListener( MeshSerializerListener *listener );
         /// Returns the current listener
         MeshSerializerListener *getListener();
 
     protected:
+        /// Reads the header and returns the implementation that can read it.
+        /// Leaves the stream at the start.
+        MeshSerializerImpl *getImplForImport( DataStreamPtr &stream, Mesh *pDest );
+
         class MeshVersionData : public OgreAllocatedObj
         {
         public:
@@ -188,7 +219,10 @@ namespace Ogre
         typedef vector<MeshVersionData *>::type MeshVersionDataList;
         MeshVersionDataList                     mVersionData;
 
-        MeshSerializerListener *mListener;
+        MeshSerializerListener  *mListener;
+        MeshSerializerImpl_v3_0 *mImplV3;
+        /// Implementation that is holding an unfinished importMeshDeferred
+        MeshSerializerImpl *mDeferredImpl;
     };
 
     /**
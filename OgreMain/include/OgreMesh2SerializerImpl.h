@@ -84,6 +84,22 @@ namespace Ogre
         */
         void importMesh( DataStreamPtr &stream, Mesh *pDest, MeshSerializerListener *listener );
 
+        /** Same as importMesh, but doesn't touch the VaoManager nor the SkeletonManager thus
+            it can be called from a worker thread.
+        @remarks
+            The vertex & index data is kept in RAM until finishDeferredImport gets called
+            from the main thread. Only one deferred import can be in flight per serializer.
+        */
+        void importMeshDeferred( DataStreamPtr &stream, Mesh *pDest,
+                                 MeshSerializerListener *listener );
+
+        /// Creates the buffers, Vaos and skeleton of the Mesh previously
+        /// parsed by importMeshDeferred. Must be called from the main thread.
+        void finishDeferredImport( Mesh *pDest );
+
+        /// Frees the data of a deferred import that will never be finished.
+        void discardDeferredImport();
+
     protected:
         typedef vector<uint8>::type                     LodLevelVertexBufferTable;
         typedef vector<LodLevelVertexBufferTable>::type LodLevelVertexBufferTableVec;  // One per submesh
@@ -105,6 +121,22 @@ namespace Ogre
 
         typedef vector<SubMeshLod>::type SubMeshLodVec;
 
+        /// Vaos that will be created by finishDeferredImport
+        struct PendingSubMeshVao
+        {
+            SubMesh      *subMesh;
+            SubMeshLodVec submeshLods;
+            uint8         casterPass;
+        };
+
+        typedef vector<PendingSubMeshVao>::type PendingSubMeshVaoVec;
+
+        /// Parses the file. Shared by importMesh and importMeshDeferred
+        void importMeshChunks( DataStreamPtr &stream, Mesh *pMesh, MeshSerializerListener *listener );
+
+        /// Frees the RAM copies of the vertex & index data. Doesn't touch the Vaos.
+        static void freeSubMeshLods( SubMeshLodVec &submeshLods );
+
         // Internal methods
         virtual void writeSubMeshNameTable( const Mesh *pMesh );
         virtual void writeMeshHashForCaches( const Mesh *pMesh );
@@ -112,8 +144,16 @@ namespace Ogre
         virtual void writeSubMesh( const SubMesh *s, const LodLevelVertexBufferTable &lodVertexTable );
         virtual void writeSubMeshLod( const VertexArrayObject *vao, uint8 lodLevel, uint8 lodSource );
         virtual void writeSubMeshLodOperation( const VertexArrayObject *vao );
+        virtual void writeSubMeshMeshlets( const SubMesh *s );
         virtual void writeIndexes( IndexBufferPacked *indexBuffer );
+        virtual void writeIndexData( const void *indexData, uint32 indexCount, bool index32Bit );
         virtual void writeGeometry( const VertexBufferPackedVec &pGeom );
+        virtual void writeVertexBufferData( const void               *vertexData,
+                                            const VertexBufferPacked *vertexBuffer );
+        /// Called right after the number of VAO passes in the M_MESH chunk.
+        virtual void writePayloadHeader( size_t meshChunkEnd );
+        /// Called after the M_MESH chunk has been written.
+        virtual void writePayloads();
         virtual void writeSkeletonLink( const String &skelName );
 
         virtual void writeMeshLodLevel( const Mesh *pMesh );
@@ -135,9 +175,13 @@ namespace Ogre
         virtual size_t calcSubMeshLodSize( const VertexArrayObject *vao, bool skipVertexBuffer );
         virtual size_t calcGeometrySize( const VertexBufferPackedVec &vertexData );
         virtual size_t calcVertexDeclSize( const VertexBufferPackedVec &vertexData );
+        virtual size_t calcIndexDataSize( const IndexBufferPacked *indexBuffer );
+        virtual size_t calcVertexBufferDataSize( const VertexBufferPacked *vertexBuffer );
+        virtual size_t calcPayloadHeaderSize();
         size_t         calcHashForCachesSize();
         virtual size_t calcSkeletonLinkSize( const String &skelName );
         virtual size_t calcSubMeshLodOperationSize( const VertexArrayObject *vao );
+        virtual size_t calcSubMeshMeshletsSize( const SubMesh *s );
         virtual size_t calcSubMeshNameTableSize( const Mesh *pMesh );
         /*virtual size_t calcEdgeListSize(const Mesh* pMesh);
         virtual size_t calcEdgeListLodSize(const EdgeData* data, bool isManual);
@@ -163,10 +207,17 @@ namespace Ogre
         virtual void readSubMeshLod( DataStreamPtr &stream, Mesh *pMesh, SubMeshLod *subLod,
                                      uint8 currentLod );
         virtual void readIndexes( DataStreamPtr &stream, SubMeshLod *subLod );
+        virtual void readIndexData( DataStreamPtr &stream, void *dst, uint32 indexCount,
+                                    bool index32Bit );
         virtual void readGeometry( DataStreamPtr &stream, SubMeshLod *subLod );
         virtual void readVertexDeclaration( DataStreamPtr &stream, SubMeshLod *subLod );
         virtual void readVertexBuffer( DataStreamPtr &stream, SubMeshLod *subLod );
+        virtual void readVertexBufferData( DataStreamPtr &stream, uint8 *dst, size_t numVertices,
+                                           size_t bytesPerVertex );
+        virtual void readPayloadHeader( DataStreamPtr &stream );
         virtual void readSubMeshLodOperation( DataStreamPtr &stream, SubMeshLod *subLod );
+        virtual void readSubMeshMeshlets( DataStreamPtr &stream, SubMesh *sm,
+                                          uint8 numSubMeshLodLevels );
         /*virtual void readGeometry(DataStreamPtr& stream, Mesh* pMesh, VertexData* dest);
         virtual void readGeometryVertexDeclaration(DataStreamPtr& stream, Mesh* pMesh, VertexData* dest);
         virtual void readGeometryVertexElement(DataStreamPtr& stream, Mesh* pMesh, VertexData* dest);
@@ -188,6 +239,9 @@ namespace Ogre
         virtual void readPoseKeyFrame(DataStreamPtr& stream, VertexAnimationTrack* track);*/
 
         virtual void createSubMeshVao( SubMesh *sm, SubMeshLodVec &submeshLods, uint8 numVaoPasses );
+        /// Places the submesh in buffers shared with other meshes if it qualifies.
+        /// See MeshManager::setShareStaticBuffers. Returns false if it didn't.
+        bool createSharedSubMeshVao( SubMesh *sm, SubMeshLodVec &submeshLods, uint8 casterPass );
 
         /// Flip an entire vertex buffer to/from little endian
         /// working on the data pointer passed in pData
@@ -217,9 +271,84 @@ namespace Ogre
         uint64      mCalculatedHash[2];  // Calculated when exporting
         ushort      exportedLodCount;    // Needed to limit exported Edge data, when exporting
         VaoManager *mVaoManager;
+
+        /// When true, createSubMeshVao & readSkeletonLink postpone their work
+        /// until finishDeferredImport. See importMeshDeferred.
+        bool                 mDeferGpuWork;
+        PendingSubMeshVaoVec mPendingSubMeshVaos;
+        String               mPendingSkeletonName;
+    };
+
+    /** Implementation of the v3.0 .mesh format.
+    @remarks
+        Same as v2.1 R3, except the contents of index and vertex buffers (payloads) are not
+        stored inline. They're stored after the M_MESH chunk in a blob whose start is aligned to
+        PayloadAlignment (a memory page) and each payload is aligned to 16 bytes. This way
+        the file can be memory mapped and the buffers used in place, and the metadata can be
+        parsed without touching the bulk of the file.
+    @par
+        Each payload can be stored raw or compressed with MeshPayloadCodec.
+    */
+    class _OgrePrivate MeshSerializerImpl_v3_0 : public MeshSerializerImpl
+    {
+    public:
+        static const size_t PayloadAlignment;
+
+        enum PayloadCodec
+        {
+            PayloadRaw,
+            /// See MeshPayloadCodec
+            PayloadCompressed
+        };
+
+        MeshSerializerImpl_v3_0( VaoManager *vaoManager );
+        ~MeshSerializerImpl_v3_0() override;
+
+        /// When true (default), payloads are compressed when exporting,
+        /// unless they don't compress.
+        void setCompressPayloads( bool bCompress );
+        bool getCompressPayloads() const { return mCompressPayloads; }
+
+    protected:
+        void writeIndexData( const void *indexData, uint32 indexCount, bool index32Bit ) override;
+        void writeVertexBufferData( const void               *vertexData,
+                                    const VertexBufferPacked *vertexBuffer ) override;
+        void writePayloadHeader( size_t meshChunkEnd ) override;
+        void writePayloads() override;
+
+        size_t calcIndexDataSize( const IndexBufferPacked *indexBuffer ) override;
+        size_t calcVertexBufferDataSize( const VertexBufferPacked *vertexBuffer ) override;
+        size_t calcPayloadHeaderSize() override;
+
+        void readMesh( DataStreamPtr &stream, Mesh *pMesh, MeshSerializerListener *listener ) override;
+        void readIndexData( DataStreamPtr &stream, void *dst, uint32 indexCount,
+                            bool index32Bit ) override;
+        void readVertexBufferData( DataStreamPtr &stream, uint8 *dst, size_t numVertices,
+                                   size_t bytesPerVertex ) override;
+        void readPayloadHeader( DataStreamPtr &stream ) override;
+
+        /// Appends the data to mPayloadData and writes its descriptor.
+        void addPayload( const void *data, size_t sizeBytes, size_t stride );
+        /// Reads the descriptor and fills dst with the contents of the payload.
+        void readPayload( DataStreamPtr &stream, void *dst, size_t sizeBytes, size_t stride );
+
+        bool mCompressPayloads;
+
+        /// Absolute offset in the stream
+        size_t              mPayloadStart;
+        size_t              mPayloadEnd;
+        vector<uint8>::type mPayloadData;
+    };
+
+    /// Same as R3, but meshlets didn't exist
+    class _OgrePrivate MeshSerializerImpl_v2_1_R2 : public MeshSerializerImpl
+    {
+    public:
+        MeshSerializerImpl_v2_1_R2( VaoManager *vaoManager );
+        ~MeshSerializerImpl_v2_1_R2() override;
     };
 
-    class _OgrePrivate MeshSerializerImpl_v2_1_R1 : public MeshSerializerImpl
+    class _OgrePrivate MeshSerializerImpl_v2_1_R1 : public MeshSerializerImpl_v2_1_R2
     {
     public:
         MeshSerializerImpl_v2_1_R1( VaoManager *vaoManager );
@@ -66,6 +66,7 @@ namespace Ogre
             // bool skeletallyAnimated   // --removed in 2.1 (flag was never used!)
             // unsigned char numPasses. // Number of caster passes data. Must be 1 or 2.
             // string strategyName;
+            // uint32 payloadStart      // (v3.0 only) Absolute offset of the payload blob. See below
             M_SUBMESH             = 0x4000,
                 // char* materialName
                 // uint8 blendIndexToBoneIndexCount
@@ -88,6 +89,8 @@ namespace Ogre
                         // unsigned int* faceVertexIndices (indexCount)
                         // OR
                         // unsigned short* faceVertexIndices (indexCount)
+                        // OR (v3.0)
+                        // payload descriptor
                     M_SUBMESH_M_GEOMETRY = 0x4330,
                         // unsigned int vertexCount
                         // uint8 numSources;    //Number of vertex buffers.
@@ -100,9 +103,29 @@ namespace Ogre
                             // uint8 bindIndex;    // Index to bind this buffer to
                             // uint8 vertexSize;   // Per-vertex size, must agree with declaration at this index
                             // raw buffer data
+                            // OR (v3.0)
+                            // payload descriptor
                     M_SUBMESH_M_GEOMETRY_EXTERNAL_SOURCE = 0x4340,
                         // This section is mutually exclusive w/ M_SUBMESH_M_GEOMETRY
                         // uint8 lodSource; //Get this vertex buffer from a LOD different source.
+                M_SUBMESH_MESHLETS  = 0x4400, // optional, after all M_SUBMESH_LOD (since v2.1 R3)
+                    // uint8 numLodLevels   //Same as the submesh's, only for the normal pass.
+                    // (this section repeats numLodLevels times; the header isn't repeated)
+                        // uint32 numMeshlets
+                        // (repeats numMeshlets times)
+                            // uint32 indexStart, indexCount, vertexCount
+                            // float center[3], radius
+                            // float coneAxis[3], coneCutoff
+            // v3.0 payload descriptor:
+            //  uint8 codec         // 0 = raw, 1 = MeshPayloadCodec
+            //  uint32 offset       // Relative to payloadStart, multiple of 16
+            //  uint32 storedSize   // Size in bytes in the file (compressed size if codec = 1)
+            //
+            // v3.0 payload blob:
+            //  After the M_MESH chunk, zero padding follows up to payloadStart (which is a
+            //  multiple of 4096, and leaves room for at least one zeroed chunk header).
+            //  Then the payloads referenced by the descriptors, in the same endianness as the
+            //  rest of the file.
             M_MESH_SKELETON_LINK = 0x6000,
                 // Optional link to skeleton
                 // char* skeletonName           : name of .skeleton to use
@@ -33,7 +33,13 @@ THE SOFTWARE.
 #include "OgreResourceManager.h"
 #include "OgreSingleton.h"
 #include "OgreVector3.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreWaitableEvent.h"
 #include "Vao/OgreBufferPacked.h"
+#include "Vao/OgreVertexBufferPacked.h"
+
+#include <atomic>
 
 #include "OgreHeaderPrefix.h"
 
@@ -45,6 +51,8 @@ namespace Ogre
     /** \addtogroup Resources
      *  @{
      */
+    class MeshSerializer;
+
     /** Handles the management of mesh resources.
         @remarks
             This class deals with the runtime management of
@@ -62,11 +70,59 @@ namespace Ogre
                               bool isManual, ManualResourceLoader *loader,
                               const NameValuePairList *createParams ) override;
 
+        struct AsyncLoadRequest
+        {
+            MeshPtr         mesh;
+            MeshSerializer *serializer;
+            /// Empty when parsing succeeded
+            String errorDescription;
+        };
+        typedef vector<AsyncLoadRequest>::type AsyncLoadRequestVec;
+
+        /// Parses the meshes in mAsyncLoadRequests and moves them to mAsyncLoadResults.
+        /// Called from the worker thread.
+        void processAsyncLoadRequests();
+
         VaoManager *mVaoManager;
 
         // the factor by which the bounding box of an entity is padded
         Real mBoundsPaddingFactor;
 
+        ThreadHandlePtr mAsyncLoadWorkerThread;
+        WaitableEvent   mAsyncLoadWorkerEvent;
+        /// Woken by the worker thread every time a mesh gets parsed
+        WaitableEvent    mAsyncLoadResultsEvent;
+        LightweightMutex mAsyncLoadMutex;
+        /// Main thread -> worker thread. Protected by mAsyncLoadMutex
+        AsyncLoadRequestVec mAsyncLoadRequests;
+        /// Worker thread -> main thread. Protected by mAsyncLoadMutex
+        AsyncLoadRequestVec mAsyncLoadResults;
+        /// Main thread only
+        size_t mNumPendingAsyncLoads;
+        /// Written by the main thread, read by the worker thread
+        std::atomic<bool> mShuttingDown;
+
+    public:
+        /// Vertex & index buffers shared by many small static meshes. See setShareStaticBuffers
+        struct SharedGeometryBuffer
+        {
+            VertexBufferPacked *vertexBuffer;
+            IndexBufferPacked  *indexBuffer;
+            uint32              usedVertices;
+            uint32              usedIndices;
+            /// Number of Vaos referencing these buffers
+            uint32 numVaos;
+        };
+
+    protected:
+        typedef vector<SharedGeometryBuffer *>::type                   SharedGeometryBufferVec;
+        typedef map<VertexArrayObject *, SharedGeometryBuffer *>::type SharedVaoMap;
+
+        bool                    mShareStaticBuffers;
+        uint32                  mSharedBuffersMaxVertices;
+        SharedGeometryBufferVec mSharedGeometryBuffers;
+        SharedVaoMap            mSharedVaos;
+
     public:
         MeshManager();
         ~MeshManager() override;
@@ -161,6 +217,114 @@ namespace Ogre
                       BufferType indexBufferType = BT_IMMUTABLE, bool vertexBufferShadowed = true,
                       bool indexBufferShadowed = true );
 
+        /** Loads a mesh from a file in a worker thread.
+        @remarks
+            Reading and parsing the file (including decompressing v3.0 buffers) happens in
+            a worker thread. The vertex & index buffers are created from the main thread
+            during _update (called by Root every frame), then the mesh is marked as loaded
+            and its Resource::Listeners (e.g. Items using it) get notified.
+        @par
+            Until then, load() on this mesh returns immediately and Items created with it
+            stay empty (they don't render) until the mesh is ready.
+        @par
+            If loading fails, the error is logged and the mesh remains unloaded.
+            Don't remove the mesh while it is loading.
+        @note
+            If the mesh is manual, it is loaded synchronously.
+            If the mesh is already loaded, the listener is called immediately.
+        @param filename The name of the .mesh file
+        @param groupName The name of the resource group to assign the mesh to
+        @param listener
+            Optional. Added to the mesh before loading starts, so it can't miss
+            Resource::Listener::loadingComplete. It is not removed afterwards.
+        @param vertexBufferType See load()
+        @param indexBufferType See load()
+        @param vertexBufferShadowed See load()
+        @param indexBufferShadowed See load()
+        */
+        MeshPtr loadAsync( const String &filename, const String &groupName,
+                           Resource::Listener *listener = 0,
+                           BufferType vertexBufferType = BT_IMMUTABLE,
+                           BufferType indexBufferType = BT_IMMUTABLE, bool vertexBufferShadowed = true,
+                           bool indexBufferShadowed = true );
+
+        /// Finishes meshes whose worker thread part of loadAsync is done.
+        /// Called by Root every frame. Main thread only.
+        void _update();
+
+        /// Blocks until all meshes requested with loadAsync have finished loading (or failed).
+        void waitForAsyncLoads();
+
+        /// Number of meshes requested with loadAsync that haven't finished yet.
+        size_t getNumPendingAsyncLoads() const { return mNumPendingAsyncLoads; }
+
+        /// Stops the worker thread and aborts pending loadAsync requests. Called by Root.
+        void shutdown();
+
+        /// Entry point of the worker thread. Don't call directly.
+        unsigned long _updateAsyncLoadWorkerThread( ThreadHandle *threadHandle );
+
+        /** Places small static meshes into shared vertex & index buffers, so that they
+            end up using the same Vao and consecutive draws can be merged (e.g. into the
+            same indirect draw) instead of switching buffers for every mesh.
+        @remarks
+            Only affects v2 meshes loaded from file afterwards, and only submeshes that:
+                - Use BT_IMMUTABLE or BT_DEFAULT buffers without shadow copies
+                  (i.e. vertexBufferShadowed & indexBufferShadowed are false).
+                - Are indexed triangle lists with a single vertex buffer source.
+                - Have at most maxVerticesPerSubMesh vertices (all LODs combined).
+                - Are not skinned (i.e. have no blend indices), since skinning and
+                  PreSkinning work on whole vertex buffers.
+                - Have no meshlets, since Meshlet::indexStart is relative to the
+                  index buffer of each LOD.
+            Submeshes with the same vertex format and index type share the same buffers,
+            which are BT_DEFAULT. Each one uses its own range via baseVertex & firstIndex.
+        @par
+            The Vaos of a shared submesh only reference a range of the shared buffers, thus
+            the submesh can't be modified (e.g. arrangeEfficient, dearrangeToInefficient),
+            exported, nor optimized for shadow mapping. Meshes are not shared while
+            Mesh::msOptimizeForShadowMapping is true.
+        @par
+            Space in a shared buffer is not reused; the buffers are destroyed once every
+            mesh using them has been unloaded.
+        @param bShare
+            True to enable. Default is false.
+        @param maxVerticesPerSubMesh
+            Larger submeshes keep their own buffers. Clamped to 65536.
+        */
+        void setShareStaticBuffers( bool bShare, uint32 maxVerticesPerSubMesh = 4096u );
+        bool getShareStaticBuffers() const { return mShareStaticBuffers; }
+        uint32 getShareStaticBuffersMaxVertices() const { return mSharedBuffersMaxVertices; }
+
+        /// Number of shared buffers currently alive. See setShareStaticBuffers
+        size_t getNumSharedGeometryBuffers() const { return mSharedGeometryBuffers.size(); }
+
+        /** Returns a shared buffer with the given format that has room for numVertices and
+            numIndices, creating a new one if needed. See setShareStaticBuffers.
+        @return
+            Null if the request is too big to be shared.
+        */
+        SharedGeometryBuffer *_reserveSharedGeometry( const VertexElement2Vec &vertexElements,
+                                                      bool index32Bit, uint32 numVertices,
+                                                      uint32 numIndices );
+        /// Uploads the vertices to the shared buffer returned by _reserveSharedGeometry.
+        /// Returns the base vertex.
+        uint32 _uploadSharedVertices( SharedGeometryBuffer *sharedBuffer, const void *vertexData,
+                                      uint32 numVertices );
+        /** Uploads the indices to the shared buffer returned by _reserveSharedGeometry and
+            creates a Vao that renders them.
+        @param indexData
+            Indices relative to baseVertex. They get rebased in place.
+        */
+        VertexArrayObject *_createSharedVao( SharedGeometryBuffer *sharedBuffer, uint32 baseVertex,
+                                             void *indexData, uint32 numIndices );
+        /// Destroys a Vao created by _createSharedVao and the shared buffers if it was their
+        /// last user. Returns false (and does nothing) if the Vao doesn't use shared buffers.
+        bool _destroySharedVao( VertexArrayObject *vao );
+        /// True if the Vao was created by _createSharedVao, i.e. it only owns a range of
+        /// its vertex & index buffers.
+        bool _isSharedVao( const VertexArrayObject *vao ) const;
+
 #if OGRE_COMPILER == OGRE_COMPILER_CLANG
 #    pragma clang diagnostic pop
 #endif
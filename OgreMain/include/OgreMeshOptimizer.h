@@ -0,0 +1,220 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreMeshOptimizer_H_
+#define _OgreMeshOptimizer_H_
+
+#include "OgrePrerequisites.h"
+
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+     *  @{
+     */
+    /** \addtogroup Resources
+     *  @{
+     */
+
+    /** Reorders triangle lists and vertices for better GPU throughput.
+
+        All functions work on raw 32-bit triangle list indices so they can be used on
+        any source of geometry. Mesh::optimizeVertexCache applies them to v2 meshes.
+        The recommended order is:
+            1. optimizeVertexCache: Forsyth's algorithm; reorders triangles to increase
+               post-transform cache hits.
+            2. optimizeOverdraw: splits the result into clusters at cache-miss boundaries
+               (Tipsify style) and sorts the clusters so that outward facing ones are
+               rendered first, while keeping the ACMR under a threshold.
+            3. optimizeVertexFetch: reorders vertices in order of first use so the
+               pre-transform (memory) fetches become sequential.
+        buildMeshlets then splits the triangles into clusters with bounding spheres
+        and normal cones, which can be culled individually.
+    @remarks
+        ACMR (Average Cache Miss Ratio) is the number of vertex shader invocations per
+        triangle. Best case is ~0.5; worst case is 3.0.
+        ATVR (Average Transformed Vertex Ratio) is the number of vertex shader invocations
+        per referenced vertex. Best case is 1.0.
+    */
+    class _OgreExport MeshOptimizer
+    {
+    public:
+        struct VertexCacheStats
+        {
+            size_t numTriangles;
+            /// Number of different vertices referenced by the indices
+            size_t numVertices;
+            /// Number of vertex shader invocations, simulating a FIFO cache
+            size_t numCacheMisses;
+
+            VertexCacheStats();
+
+            float getAcmr() const;
+            float getAtvr() const;
+
+            VertexCacheStats &operator+=( const VertexCacheStats &other );
+        };
+
+        /** A small cluster of triangles (meshlet) that can be culled as a whole.
+        @remarks
+            The layout is 3 x 16 bytes so it can be uploaded as-is to a ReadOnlyBufferPacked
+            (see SubMesh::getMeshletBuffer) for GPU culling.
+            All data is in object space.
+        */
+        struct Meshlet
+        {
+            /// First index of the meshlet in the index buffer of its LOD.
+            uint32 indexStart;
+            /// Number of indices (3 per triangle).
+            uint32 indexCount;
+            /// Number of different vertices referenced by the meshlet.
+            uint32 vertexCount;
+            uint32 padding;
+
+            /// Bounding sphere.
+            float center[3];
+            float radius;
+
+            /// Normal cone. Seen from cameraPos, the whole meshlet is backfacing if:
+            ///     dot( center - cameraPos, coneAxis ) >=
+            ///         coneCutoff * length( center - cameraPos ) + radius
+            /// coneCutoff >= 1 means the normals are too spread apart to ever pass this test.
+            float coneAxis[3];
+            float coneCutoff;
+        };
+
+        typedef vector<Meshlet>::type MeshletVec;
+
+        /// Simulates a FIFO post-transform cache of the given size.
+        /// numIndices must be a multiple of 3 (triangle list).
+        static VertexCacheStats analyzeVertexCache( const uint32 *indices, size_t numIndices,
+                                                    size_t numVertices, uint32 cacheSize = 16u );
+
+        /** Reorders triangles to maximize post-transform cache hits.
+        @param outIndices [out]
+            Array of numIndices. Can't alias inIndices.
+        @param inIndices
+            Triangle list.
+        @param numIndices
+            Must be a multiple of 3.
+        @param numVertices
+            All indices must be in range [0; numVertices)
+        */
+        static void optimizeVertexCache( uint32 *outIndices, const uint32 *inIndices, size_t numIndices,
+                                         size_t numVertices );
+
+        /** Reorders clusters of triangles to reduce overdraw. Expects indices already
+            processed by optimizeVertexCache.
+        @param outIndices [out]
+            Array of numIndices. Can't alias inIndices.
+        @param positions
+            Pointer to the first vertex position (3 floats).
+        @param positionStride
+            Bytes between each vertex position.
+        @param threshold
+            How much the ACMR is allowed to degrade in exchange for less overdraw.
+            e.g. 1.05 means up to 5% worse. A value <= 1 only splits at hard boundaries.
+        @return
+            Number of clusters the triangles were split into.
+        */
+        static size_t optimizeOverdraw( uint32 *outIndices, const uint32 *inIndices,
+                                        size_t numIndices, const float *positions,
+                                        size_t positionStride, size_t numVertices,
+                                        float threshold = 1.05f );
+
+        /** Generates a remap table that orders vertices by first use.
+        @param outRemap [out]
+            Array of numVertices. outRemap[oldIdx] = newIdx. Vertices that are not
+            referenced are placed at the end, so the vertex count never changes.
+        @return
+            Number of vertices referenced by the indices.
+        */
+        static size_t optimizeVertexFetchRemap( uint32 *outRemap, const uint32 *indices,
+                                                size_t numIndices, size_t numVertices );
+
+        /** Splits a triangle list into meshlets. Meshlets are grown greedily through
+            adjacent triangles, so it's best to call optimizeVertexCache first.
+        @param outIndices [out]
+            Array of numIndices. Can't alias inIndices. The triangles of each meshlet
+            are contiguous.
+        @param outMeshlets [out]
+            The meshlets are appended to this array.
+        @param positions
+            Pointer to the first vertex position (3 floats).
+        @param positionStride
+            Bytes between each vertex position.
+        @param maxVertices
+            Max number of different vertices referenced by a meshlet. Must be >= 3.
+        @param maxTriangles
+            Max number of triangles per meshlet. Must be >= 1.
+        */
+        static void buildMeshlets( uint32 *outIndices, MeshletVec &outMeshlets, const uint32 *inIndices,
+                                   size_t numIndices, const float *positions, size_t positionStride,
+                                   size_t numVertices, uint32 maxVertices = 64u,
+                                   uint32 maxTriangles = 124u );
+
+        /** Frustum & backface culling of meshlets on the CPU.
+        @param outVisibleMeshlets [out]
+            Array of at least numMeshlets. Receives the index of each visible meshlet.
+        @param cameraPos
+            Camera position in object space.
+        @param planes
+            Planes in object space, pointing inwards (e.g. Frustum::getFrustumPlanes
+            transformed by the inverse of the world matrix). Can be null if numPlanes = 0.
+        @return
+            Number of visible meshlets.
+        */
+        static size_t cullMeshlets( uint32 *outVisibleMeshlets, const Meshlet *meshlets,
+                                    size_t numMeshlets, const Vector3 &cameraPos, const Plane *planes,
+                                    size_t numPlanes );
+
+        /// Copies the indices of the visible meshlets (as returned by cullMeshlets) into a
+        /// compacted index list. Returns the number of indices written.
+        static size_t compactMeshletIndices( uint32 *outIndices, const uint32 *indices,
+                                             const Meshlet *meshlets, const uint32 *visibleMeshlets,
+                                             size_t numVisibleMeshlets );
+
+        /// Applies the remap generated by optimizeVertexFetchRemap to indices. In place.
+        static void remapIndices( uint32 *indices, size_t numIndices, const uint32 *remap );
+
+        /// Applies the remap generated by optimizeVertexFetchRemap to a vertex buffer.
+        /// dst & src can't alias.
+        static void remapVertices( void *dst, const void *src, size_t numVertices,
+                                   size_t bytesPerVertex, const uint32 *remap );
+    };
+
+    /** @} */
+    /** @} */
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
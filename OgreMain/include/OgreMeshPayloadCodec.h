@@ -0,0 +1,108 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+
+#ifndef _OgreMeshPayloadCodec_H_
+#define _OgreMeshPayloadCodec_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+     *  @{
+     */
+    /** \addtogroup Resources
+     *  @{
+     */
+
+    /** Lossless compression for vertex and index buffers, used by the v3.0 .mesh format.
+
+        The data is first filtered like a vertex codec would: the buffer is split into
+        byte planes (byte 0 of every vertex, then byte 1 of every vertex, etc) and each
+        plane is delta encoded against the previous vertex. Smooth attributes and indices
+        then turn into long runs of small values, which are compressed by a byte oriented
+        LZ77 (LZ4-like) compressor.
+    @remarks
+        Decompression does not need any tables and runs at memory speed, which is what
+        matters when loading thousands of meshes. Compression is meant to be done offline
+        (i.e. by OgreMeshTool).
+    */
+    class _OgreExport MeshPayloadCodec
+    {
+    public:
+        /// Returns the size dst must have to guarantee compress() succeeds.
+        static size_t compressBound( size_t srcSize );
+
+        /** Compresses src.
+        @param src
+            Data to compress.
+        @param srcSize
+            Size in bytes of src.
+        @param stride
+            Bytes per vertex (or per index). Must be the same value passed to decompress.
+            If srcSize is not a multiple of stride, the data is treated as a stream of bytes.
+        @param dst
+            Where to store the compressed data.
+        @param dstCapacity
+            Size in bytes of dst.
+        @return
+            Size in bytes of the compressed data.
+            0 if it did not fit in dstCapacity; which means it's not worth compressing if
+            dstCapacity < srcSize.
+        */
+        static size_t compress( const void *src, size_t srcSize, size_t stride, void *dst,
+                                size_t dstCapacity );
+
+        /** Decompresses data generated by compress().
+        @param src
+            Compressed data.
+        @param srcSize
+            Size in bytes of the compressed data.
+        @param stride
+            Same value passed to compress.
+        @param dst
+            Where to store the decompressed data. Can't alias src.
+        @param dstSize
+            Exact size in bytes of the original data.
+        @return
+            False if the data is corrupt.
+        */
+        static bool decompress( const void *src, size_t srcSize, size_t stride, void *dst,
+                                size_t dstSize );
+    };
+
+    /** @} */
+    /** @} */
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -121,6 +121,8 @@ namespace Ogre
         // One for each submesh/Renderable
         FastArray<Real> const *mLodMesh;
         unsigned char          mCurrentMeshLod;
+        /// Last value computed by the LodStrategy. See getLodValue
+        Real mLodValue;
 
         /// Minimum pixel size to still render
         Real mMinPixelSize;
@@ -241,6 +243,10 @@ namespace Ogre
 
         unsigned char getCurrentMeshLod() const { return mCurrentMeshLod; }
 
+        /// Returns the LOD value (e.g. distance to the LOD camera for the default strategy)
+        /// from the last time SceneManager::updateAllLods processed this object.
+        Real getLodValue() const { return mLodValue; }
+
         /// Checks whether this MovableObject is static. @see setStatic
         bool isStatic() const;
 
@@ -173,6 +173,7 @@ namespace Ogre
     struct DescriptorSetUav;
     class DynLib;
     class DynLibManager;
+    class DynamicUploadRing;
     class EmitterDefData;
     class ErrorDialog;
     class ExternalTextureSourceManager;
@@ -337,6 +338,7 @@ namespace Ogre
     class VertexAnimationTrack;
     struct VertexArrayObject;
     class VertexBufferPacked;
+    struct VertexQuantizationSettings;
     class Window;
     class WireAabb;
     class WireBoundingBox;
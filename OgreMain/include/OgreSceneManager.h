@@ -417,6 +417,16 @@ namespace Ogre
         ObjectMemoryManagerVec mForwardPlusMemoryManagerCullList;
         SkeletonAnimManagerVec mSkeletonAnimManagerCulledList;
 
+        /// Incremented by updateAllAnimations. See SkeletonInstance::setAnimationLodLevels
+        uint32 mAnimationLodFrame;
+        /// One per thread. Set by updateAllAnimationsThread when it found SkeletonInstances
+        /// that must be finished by updateAllDeferredAnimationsThread.
+        /// See SkeletonInstance::setPoseSource & SkeletonInstance::setParallelAnimation
+        FastArray<uint8> mPendingDeferredAnimationsPerThread;
+        /// One list per thread. SkeletonInstances found by updateAllAnimationsThread that
+        /// must be animated by all threads. See SkeletonInstance::setParallelAnimation
+        vector<FastArray<SkeletonInstance *> >::type mParallelAnimationsPerThread;
+
         uint32 mNumDecals;
         uint32 mNumCubemapProbes;
 
@@ -801,6 +811,7 @@ namespace Ogre
         {
             CULL_FRUSTUM,
             UPDATE_ALL_ANIMATIONS,
+            UPDATE_ALL_DEFERRED_ANIMATIONS,
             UPDATE_ALL_TRANSFORMS,
             UPDATE_ALL_BONE_TO_TAG_TRANSFORMS,
             UPDATE_ALL_TAG_ON_TAG_TRANSFORMS,
@@ -899,6 +910,13 @@ namespace Ogre
             Must be unique for each worker thread
         */
         void updateAllAnimationsThread( size_t threadIdx );
+        /** Finishes the SkeletonInstances that updateAllAnimationsThread had to postpone.
+            First all threads animate a share of the bone blocks of every instance with
+            parallel animation (see SkeletonInstance::setParallelAnimation). After a sync,
+            instances following another (see SkeletonInstance::setPoseSource) copy its pose,
+            and the transforms get updated.
+        */
+        void updateAllDeferredAnimationsThread( size_t threadIdx );
         void updateAnimationTransforms( BySkeletonDef &bySkeletonDef, size_t threadIdx );
 
         /** Updates the Nodes from the given request inside a thread. @see updateAllTransforms
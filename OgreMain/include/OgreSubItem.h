@@ -84,6 +84,9 @@ namespace Ogre
         SubMesh      *mSubMesh;
         unsigned char mMaterialLodIndex;
 
+        /// True when rendering the Vaos set by _setPreSkinnedVaos
+        bool mPreSkinned;
+
         void setupSkeleton();
 
     public:
@@ -93,6 +96,15 @@ namespace Ogre
 
         void _setHlmsHashes( uint32 hash, uint32 casterHash ) override;
 
+        /** Renders the given Vaos (one per LOD) in all passes, including shadow casters,
+            as static geometry. Used by PreSkinning, which writes the skinned vertices.
+            Pass an empty array to go back to the SubMesh's Vaos and skeletal animation.
+        */
+        void _setPreSkinnedVaos( const VertexArrayObjectArray &vaos );
+
+        /// See PreSkinning
+        bool isPreSkinned() const { return mPreSkinned; }
+
         /** Accessor to get parent Item */
         Item *getParent() const { return mParentItem; }
 
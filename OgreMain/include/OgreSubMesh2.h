@@ -30,6 +30,7 @@ THE SOFTWARE.
 
 #include "OgrePrerequisites.h"
 
+#include "OgreMeshOptimizer.h"
 #include "OgreVertexBoneAssignment.h"
 #include "Vao/OgreVertexArrayObject.h"
 
@@ -45,6 +46,41 @@ namespace Ogre
     /** \addtogroup Resources
      *  @{
      */
+    /** Precision requirements used to automatically pick the smallest vertex format
+        for each SubMesh. @see Mesh::importV1 and Mesh::arrangeEfficient overloads.
+    @remarks
+        Every encoding chosen is decoded by the vertex fetch hardware, except octahedral
+        normals which are decoded by the Hlms (hlms_octahedral_normal).
+    */
+    struct _OgreExport VertexQuantizationSettings
+    {
+        /// Max position error allowed, relative to the largest dimension of the
+        /// SubMesh's bounds. Positions are stored as 16-bit half when the rounding
+        /// error stays below it, otherwise they're kept as 32-bit float.
+        float positionPrecision;
+        /// Max absolute error allowed for texture coordinates.
+        /// UVs in range [0; 1] or [-1; 1] are stored as 16-bit UNORM/SNORM, others
+        /// as 16-bit half when the rounding error stays below it.
+        float texCoordTolerance;
+        /// When true, normals without tangents are stored as 2x16-bit SNORM
+        /// octahedral-encoded normals (4 bytes instead of 12).
+        /// Normals with tangents are never octahedral-encoded (QTangents are used instead,
+        /// if enabled) so the whole tangent frame keeps the same precision.
+        bool octahedralNormals;
+        /// When true, tangents are generated for meshes that don't have them
+        /// (modifying the v1 mesh) so they can be stored as QTangents.
+        /// Only used by Mesh::importV1.
+        bool generateTangents;
+
+        VertexQuantizationSettings() :
+            positionPrecision( 1.0f / 2048.0f ),
+            texCoordTolerance( 0.5f / 2048.0f ),
+            octahedralNormals( true ),
+            generateTangents( false )
+        {
+        }
+    };
+
     /** Defines a part of a complete mesh.
         @remarks
             Meshes which make up the definition of a discrete 3D object
@@ -117,6 +153,12 @@ namespace Ogre
         std::map<Ogre::String, size_t> mPoseIndexMap;
         TexBufferPacked               *mPoseTexBuffer;
 
+        /// One entry per LOD in mVao[VpNormal]. Empty if meshlets haven't been built.
+        /// A LOD that can't be split (e.g. not an indexed triangle list) has no meshlets.
+        vector<MeshOptimizer::MeshletVec>::type mMeshlets;
+        /// GPU copy of mMeshlets, created on demand.
+        ReadOnlyBufferPacked *mMeshletBuffer;
+
     public:
         SubMesh();
         ~SubMesh();
@@ -190,14 +232,20 @@ namespace Ogre
         String getMaterialName() const { return mMaterialName; }
 
         /// Imports a v1 SubMesh @see Mesh::importV1. Automatically performs what arrangeEfficient does.
+        /// When quantization is not null, halfPos & halfTexCoords are ignored and the vertex
+        /// format is chosen automatically instead.
         void importFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords, bool qTangents,
-                           bool halfPose );
+                           bool halfPose, const VertexQuantizationSettings *quantization = 0 );
 
         /// Converts this SubMesh to an efficient arrangement. See Mesh::importV1 for an
         /// explanation on the parameters. @see dearrangeEfficientToInefficient
         /// to perform the opposite operation.
         void arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents );
 
+        /// Converts this SubMesh to the smallest vertex format that satisfies
+        /// the given precision requirements. @see VertexQuantizationSettings
+        void arrangeEfficient( const VertexQuantizationSettings &quantization );
+
         /// Reverts the effects from arrangeEfficient by converting all 16-bit half float back
         /// to 32-bit float; and QTangents to Normal, Tangent + Reflection representation,
         /// which are more compatible for doing certain operations vertex operations in the CPU.
@@ -205,6 +253,44 @@ namespace Ogre
 
         void _prepareForShadowMapping( bool forceSameBuffers );
 
+        /// Returns true if the Vaos only reference a range of MeshManager's shared buffers,
+        /// in which case they can't be modified nor exported. See MeshManager::setShareStaticBuffers
+        bool _isUsingSharedBuffers() const;
+
+        /// Reorders the triangles and vertices of this SubMesh for better GPU throughput.
+        /// See Mesh::optimizeVertexCache for an explanation on the parameters.
+        void optimizeVertexCache( bool overdraw, bool vertexFetch, float overdrawThreshold );
+
+        /// Splits every LOD into meshlets and reorders its indices so that the triangles
+        /// of each meshlet are contiguous. See Mesh::buildMeshlets.
+        void buildMeshlets( uint32 maxVertices, uint32 maxTriangles );
+
+        /// Destroys the meshlets (and their GPU buffer). Indices are left as they are.
+        void clearMeshlets();
+
+        /// Sets the meshlets, one array per LOD. The contents of the given array are swapped.
+        /// Used by the MeshSerializer. The indices must already be in meshlet order.
+        void _setMeshlets( vector<MeshOptimizer::MeshletVec>::type &meshlets );
+
+        bool hasMeshlets() const { return !mMeshlets.empty(); }
+
+        /// Returns the meshlets of the given LOD. Empty if there are none.
+        const MeshOptimizer::MeshletVec &getMeshlets( size_t lodIdx ) const;
+
+        /** Returns a buffer with the meshlets of every LOD, one after the other,
+            for GPU culling. The layout of each entry is MeshOptimizer::Meshlet
+            (i.e. 3 x uint4), see getMeshletBufferOffset for where each LOD starts.
+            Created the first time it is called; returns null if there are no meshlets.
+        */
+        ReadOnlyBufferPacked *getMeshletBuffer();
+
+        /// Index of the first meshlet of the given LOD in getMeshletBuffer.
+        uint32 getMeshletBufferOffset( size_t lodIdx ) const;
+
+        /// Simulates a post-transform cache of the given size on the first LOD.
+        /// Returns empty stats if the first LOD isn't an indexed triangle list.
+        MeshOptimizer::VertexCacheStats analyzeVertexCache( uint32 cacheSize = 16u ) const;
+
         uint16 getNumPoses() { return mNumPoses; }
 
         bool getPoseHalfPrecision() { return mPoseHalfPrecision; }
@@ -244,7 +330,11 @@ namespace Ogre
 
     protected:
         void importBuffersFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords, bool qTangents,
-                                  bool halfPose, size_t vaoPassIdx );
+                                  bool halfPose, size_t vaoPassIdx,
+                                  const VertexQuantizationSettings *quantization );
+
+        void arrangeEfficientImpl( bool halfPos, bool halfTexCoords, bool qTangents,
+                                   const VertexQuantizationSettings *quantization );
 
         /// Converts a v1 IndexBuffer to a v2 format. Returns nullptr if indexData is also nullptr
         IndexBufferPacked *importFromV1( v1::IndexData *indexData );
@@ -261,6 +351,8 @@ namespace Ogre
             Reads and writes from/to it.
         @param vaoManager
             Needed to create the new Vao
+        @param quantization
+            When not null, the vertex format is chosen automatically. Can be null.
         @return
             New Vao containing the dearranged buffers. It will share the index buffers
             with the original vao.
@@ -268,7 +360,8 @@ namespace Ogre
         static VertexArrayObject *arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
                                                     VertexArrayObject     *vao,
                                                     SharedVertexBufferMap &sharedBuffers,
-                                                    VaoManager            *vaoManager );
+                                                    VaoManager            *vaoManager,
+                                                    const VertexQuantizationSettings *quantization = 0 );
 
         /** @see dearrangeEfficientToInefficient. Works on an individual VertexArrayObject.
             Delegates work to the generic method @see _dearrangeEfficient which
@@ -319,13 +412,33 @@ namespace Ogre
             @see Mesh::importV1
         @param outVertexElements [out]
             Description of the buffer in the new v2 system.
+        @param quantization
+            When not null, the vertex format is chosen automatically. Can be null.
         @return
             Buffer pointer with reorganized data.
             Caller MUST free the pointer with OGRE_FREE_SIMD( MEMCATEGORY_GEOMETRY ).
         */
         static char *_arrangeEfficient( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords,
                                         bool qTangents, VertexElement2Vec *outVertexElements,
-                                        size_t vaoPassIdx );
+                                        size_t vaoPassIdx,
+                                        const VertexQuantizationSettings *quantization = 0 );
+
+        /** Analyzes the source data and replaces the types in vertexElements with the
+            smallest ones that satisfy the given precision requirements.
+            The result can be passed to _arrangeEfficient.
+        @param srcData
+            Array that points to the source data for every vertex element, in the same
+            order as inOutVertexElements (VES_TANGENT and VES_BINORMAL may follow at the end).
+        @param vertexCount
+            Number of vertices
+        @param inOutVertexElements [in/out]
+            The vertex format we're converting to. Only elements whose type still matches
+            the source (i.e. not already converted to QTangents) and are 32-bit floats
+            are considered.
+        */
+        static void _quantizeVertexElements( const SourceDataArray &srcData, size_t vertexCount,
+                                             const VertexQuantizationSettings &settings,
+                                             VertexElement2Vec &inOutVertexElements );
 
         /** Generic form that does the actual job for both v1 and v2 objects. Takes
             an array of pointers to source each vertex element, and returns a
@@ -369,6 +482,24 @@ namespace Ogre
 
     protected:
         void destroyShadowMappingVaos();
+
+        /// Returns false if the Vao isn't a triangle list with indices that can be reordered.
+        static bool readTriangleListIndices( const VertexArrayObject *vao,
+                                             vector<uint32>::type &outIndices );
+
+        /// Reads VES_POSITION as 3 floats per vertex. Returns false if the format is unsupported.
+        static bool readPositions( VertexArrayObject *vao, vector<float>::type &outPositions );
+
+        /// Creates an index buffer with the same type and settings as srcIndexBuffer
+        /// but with the given contents.
+        static IndexBufferPacked *createIndexBufferLike( const IndexBufferPacked *srcIndexBuffer,
+                                                         const vector<uint32>::type &indices,
+                                                         VaoManager *vaoManager );
+
+        /// After replacing the Vaos in mVao[VpNormal], shares them again with the shadow mapping
+        /// pass or regenerates independent ones. Call destroyShadowMappingVaos before
+        /// destroying the old Vaos, and pass what they were like at that time.
+        void restoreShadowMappingVaos( bool hadShadowVaos, bool independentShadowVaos );
     };
     /** @} */
     /** @} */
@@ -187,6 +187,20 @@ namespace Ogre
             Result build( VertexElementSemantic targetSemantic = VES_TANGENT,
                           unsigned short sourceTexCoordSet = 0, unsigned short index = 1 );
 
+            /** Lets build() split its work across the worker threads of the given SceneManager.
+            @remarks
+                Per face tangent spaces and the final normalisation are computed in parallel.
+                They are accumulated into vertices in the original order, so the result is
+                exactly the same regardless of the number of threads.
+                Small inputs are always processed on the calling thread.
+            @par
+                See EdgeListBuilder::setSceneManager for when it's safe to do so.
+            @param sceneManager
+                Null (default) to build on the calling thread.
+            */
+            void          setSceneManager( SceneManager *sceneManager ) { mSceneManager = sceneManager; }
+            SceneManager *getSceneManager() const { return mSceneManager; }
+
         protected:
             VertexData                         *mVData;
             typedef vector<IndexData *>::type   IndexDataList;
@@ -196,6 +210,9 @@ namespace Ogre
             bool                                mSplitMirrored;
             bool                                mSplitRotated;
             bool                                mStoreParityInW;
+            SceneManager                       *mSceneManager;
+
+            friend struct TangentSpaceCalcJob;
 
             struct VertexInfo
             {
@@ -231,10 +248,14 @@ namespace Ogre
                                             Vector3 &tsN );
             Real calculateAngleWeight( size_t v0, size_t v1, size_t v2 );
             int  calculateParity( const Vector3 &u, const Vector3 &v, const Vector3 &n );
-            void addFaceTangentSpaceToVertices( size_t indexSet, size_t faceIndex, size_t *localVertInd,
-                                                const Vector3 &faceTsU, const Vector3 &faceTsV,
-                                                const Vector3 &faceNorm, Result &result );
+            void addFaceTangentSpaceToVertices( size_t indexSet, size_t faceIndex,
+                                                const size_t *localVertInd, const Vector3 &faceTsU,
+                                                const Vector3 &faceTsV, const Vector3 &faceNorm,
+                                                int faceParity, const Real *angleWeights,
+                                                Result &result );
             void normaliseVertices();
+            /// Returns how many threads to use for a workload of numItems faces or vertices
+            size_t calculateNumThreads( size_t numItems ) const;
             void remapIndexes( Result &res );
             template <typename T>
             void remapIndexes( T *ibuf, size_t indexSet, Result &res )
@@ -59,6 +59,12 @@ namespace Ogre
             TypePrepareForNormalMapping         = 1u << 2u,
             TypeLeaveChannelR                   = 1u << 3u,
             TypePremultiplyAlpha                = 1u << 4u,
+            /// Compresses uncompressed 8-bit textures to BC1/BC3/BC4/BC5 after loading.
+            /// See CompressBCn.
+            TypeCompressBCn                     = 1u << 5u,
+            /// Same as TypeCompressBCn, but RGB & RGBA textures get compressed to BC7.
+            /// Has no effect unless TypeCompressBCn is also set.
+            TypeCompressBC7                     = 1u << 6u,
             // clang-format on
 
             TypeGenerateDefaultMipmaps = TypeGenerateSwMipmaps | TypeGenerateHwMipmaps
@@ -157,6 +163,35 @@ namespace Ogre
         public:
             void _executeStreaming( Image2 &image, TextureGpu *texture ) override;
         };
+        //-----------------------------------------------------------------------------------
+        /** Compresses the texture using BCnEncoder in the streaming thread, so that it consumes
+            less VRAM & bandwidth. Best suited for textures that don't ship precompressed.
+
+            Formats are selected based on the source format:
+                - RGBA8 / BGRA8 -> BC3 (BC7 with TypeCompressBC7)
+                - BGRX8 / RGB8 / BGR8 -> BC1 (BC7 with TypeCompressBC7)
+                - R8 -> BC4
+                - RG8 -> BC5 (i.e. after PrepareForNormalMapping)
+            sRGB is preserved. Anything else (including textures whose resolution is not
+            a multiple of 4, 1D and 3D textures, and formats the GPU can't sample)
+            is left untouched.
+        @remarks
+            Mipmaps are generated before compressing, thus HW mipmap generation is
+            replaced by SW mipmap generation when this filter is active.
+        */
+        class _OgreExport CompressBCn : public FilterBase
+        {
+            PixelFormatGpu mDstFormat;
+
+        public:
+            CompressBCn( PixelFormatGpu dstFormat ) : mDstFormat( dstFormat ) {}
+
+            /// Returns srcFormat if the image won't be compressed
+            static PixelFormatGpu getDestinationFormat( uint32 filters, PixelFormatGpu srcFormat,
+                                                        const Image2            &image,
+                                                        const TextureGpuManager *textureManager );
+            void _executeStreaming( Image2 &image, TextureGpu *texture ) override;
+        };
     }  // namespace TextureFilter
     /** @} */
     /** @} */
@@ -182,6 +182,10 @@ namespace Ogre
             ///
             /// This flag requires RenderToTexture.
             TilerMemoryless = 1u << 15u,
+            /// Prevents TextureGpuManager::setAutomaticBatchingMaxResolution from
+            /// automatically turning on AutomaticBatching for this texture.
+            /// Use it for textures accessed by custom code or shaders that expect a Type2D.
+            NoAutomaticBatching = 1u << 16u,
             // clang-format on
         };
     }
@@ -342,6 +346,9 @@ namespace Ogre
 
         /// See TextureFlags::TextureFlags
         uint32 mTextureFlags;
+        /// True while Resident if TextureGpuManager::setAutomaticBatchingMaxResolution
+        /// decided to batch this texture. mTextureFlags is left as the user set it.
+        bool mAutomaticBatchingApplied;
         /// Used if hasAutomaticBatching() == true
         uint32 mPoolId;
 
@@ -648,6 +655,10 @@ namespace Ogre
         /// TODO: This may be moved to a different class.
         virtual void swapBuffers() {}
 
+        /// The flags the texture was created with. See TextureFlags::TextureFlags
+        uint32 getTextureFlags() const { return mTextureFlags; }
+        /// True if created with TextureFlags::AutomaticBatching, or if
+        /// TextureGpuManager::setAutomaticBatchingMaxResolution batched it while Resident.
         bool hasAutomaticBatching() const;
         bool isTexture() const;
         bool isRenderToTexture() const;
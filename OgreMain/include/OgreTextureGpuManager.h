@@ -320,6 +320,12 @@ namespace Ogre
             bool autoDeleteImage;
             /// Indicates we're going to GpuResidency::OnSystemRam instead of Resident
             bool toSysRam;
+            /// True if image was loaded from the filtered texture cache. Only the
+            /// mipmap filters still need to run. See setFilteredTextureCacheFolder
+            bool loadedFromFilteredCache;
+            /// Where to save the image once its filters have been applied.
+            /// Empty if it shouldn't be saved. See setFilteredTextureCacheFolder
+            String filteredCachePath;
 
             LoadRequest( const String &_name, Archive *_archive,
                          ResourceLoadingListener *_loadingListener, Image2 *_image, TextureGpu *_texture,
@@ -332,7 +338,8 @@ namespace Ogre
                 sliceOrDepth( _sliceOrDepth ),
                 filters( _filters ),
                 autoDeleteImage( _autoDeleteImage ),
-                toSysRam( _toSysRam )
+                toSysRam( _toSysRam ),
+                loadedFromFilteredCache( false )
             {
             }
         };
@@ -572,6 +579,14 @@ namespace Ogre
 
         MetadataCacheMap mMetadataCache;
 
+        /// See setFilteredTextureCacheFolder. Empty if disabled
+        String mFilteredCacheFolder;
+        /// Makes the temporary files of concurrent saveToFilteredCache calls unique
+        std::atomic<uint32> mFilteredCacheTmpCounter;
+
+        /// See setAutomaticBatchingMaxResolution. 0 if disabled
+        uint32 mAutomaticBatchingMaxResolution;
+
         typedef vector<AsyncTextureTicket *>::type AsyncTextureTicketVec;
         AsyncTextureTicketVec                      mAsyncTextureTickets;
 
@@ -802,6 +817,31 @@ namespace Ogre
         void processLoadRequest( ObjCmdBuffer *commandBuffer, ThreadData &workerData,
                                  const LoadRequest &loadRequest );
 
+        /** Looks up the file in the filtered texture cache. See setFilteredTextureCacheFolder.
+            Can be called from any worker thread.
+        @param inOutData
+            Stream to the original file. It gets replaced by an in-memory copy that
+            can still be decoded if the file wasn't found in the cache.
+        @param outImage
+            Loaded from the cache on hit. Untouched on miss.
+        @param outFilteredCachePath
+            On miss, where to save the results once the filters have been applied.
+            Untouched on hit.
+        @return
+            True if the cache contained the file.
+        */
+        bool loadFromFilteredCache( DataStreamPtr &inOutData, const LoadRequest &loadRequest,
+                                    Image2 &outImage, String &outFilteredCachePath ) const;
+
+        /// Saves the image (after running its filters) to the filtered texture cache.
+        /// Does nothing if filteredCachePath is empty.
+        void saveToFilteredCache( const String &filteredCachePath, const String &name,
+                                  Image2 &image );
+
+        /// Returns a bitmask of the device capabilities that change the output of the
+        /// texture filters (i.e. BCn support and which formats can have HW mipmaps).
+        uint32 getFilteredCacheCapabilities() const;
+
     public:
         void _updateStreaming();
 
@@ -1293,6 +1333,87 @@ namespace Ogre
         */
         void setTrylockMutexFailureLimit( uint32 tryLockFailureLimit );
 
+        /** Enables a persistent, content-addressed cache of the final results after loading
+            a texture from file (i.e. decoded & after applying all the TextureFilter), stored
+            as OITD files in the given folder.
+
+            On the next run the worker thread loads the OITD directly instead of decoding
+            e.g. the PNG and running PrepareForNormalMapping, PremultiplyAlpha,
+            GenerateSwMipmaps, CompressBCn, etc. again.
+
+            Entries are keyed by a hash of the file's contents, the filter flags, and the
+            settings that affect their results (sRGB preference & default mipmap generation).
+            Thus renaming a file or changing its content is handled transparently.
+            The final pixel format is stored in the OITD itself.
+        @remarks
+            The folder must exist and be writable. Stale entries are never removed;
+            it is safe to delete the folder's contents at any time while Ogre isn't running.
+
+            Files that already are OITD are never cached.
+
+            HW mipmap generation (see GenerateHwMipmaps) still runs after loading from cache.
+
+            Call this function before loading any texture (or after waitForStreamingCompletion)
+            as worker threads read this value without synchronization.
+        @param folder
+            Full path to the folder. Empty string to disable (default).
+        */
+        void setFilteredTextureCacheFolder( const String &folder );
+        const String &getFilteredTextureCacheFolder() const { return mFilteredCacheFolder; }
+
+        /** Automatically places small textures into shared 2D arrays (i.e. as if they had been
+            created with TextureFlags::AutomaticBatching) so that many materials end up sharing
+            the same texture and descriptor set, and the RenderQueue can keep merging draws.
+
+            A texture gets batched when it becomes Resident if all of these are true:
+                - Its width and height are <= maxResolution.
+                - It is a regular TextureTypes::Type2D texture with a single slice.
+                - It isn't a RenderToTexture, Uav, ManualTexture, NotTexture nor MSAA.
+                - It wasn't created with TextureFlags::NoAutomaticBatching.
+
+            Pools are already grouped by resolution, pixel format and mipmap count;
+            and the number of slices per pool is controlled by
+            TextureGpuManagerListener::getNumSlicesFor.
+        @remarks
+            Hlms implementations that ship with Ogre handle batched textures transparently.
+            Custom shaders & code that read the texture directly (e.g. via
+            TextureGpu::getTextureType or TextureGpu::hasAutomaticBatching before the texture
+            is Resident) must be aware the texture may become a slice of a Type2DArray.
+            Use TextureFlags::NoAutomaticBatching for those textures.
+
+            Changing this value doesn't affect textures that are already Resident.
+            The decision is made again every time a texture becomes Resident, and
+            TextureGpu::getTextureFlags is never modified.
+        @param maxResolution
+            Max width & height to consider a texture for automatic batching.
+            0 to disable (default).
+        */
+        void setAutomaticBatchingMaxResolution( uint32 maxResolution );
+        uint32 getAutomaticBatchingMaxResolution() const { return mAutomaticBatchingMaxResolution; }
+
+        /// Returns true if the texture meets the criteria of setAutomaticBatchingMaxResolution
+        /// (except for TextureFlags::NoAutomaticBatching, which TextureGpu checks itself).
+        /// Its resolution, format and type must already be known.
+        bool _shouldApplyAutomaticBatching( const TextureGpu *texture ) const;
+
+        /** Returns the path of the filtered texture cache entry for the given file.
+            The key accounts for the file contents, the filters, the default mipmap
+            generation settings and the capabilities of the device.
+            Can be called from any thread.
+        @param fileData
+            Contents of the original file.
+        @param sRGB
+            See TextureGpu::prefersLoadingFromFileAsSRGB.
+        @return
+            Empty string if the filtered texture cache is disabled.
+        */
+        String _getFilteredCachePath( const void *fileData, size_t sizeBytes, uint32 filters,
+                                      bool sRGB ) const;
+
+        /// Returns a temporary path to write filteredCachePath to before renaming it.
+        /// Different on every call, so that worker threads don't collide. Thread safe.
+        String _getFilteredCacheTmpPath( const String &filteredCachePath );
+
         /** When enabled, we will profile the time it takes a texture
             to go from Resident to Ready and Log it.
         @param bProfile
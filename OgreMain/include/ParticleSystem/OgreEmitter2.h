@@ -63,6 +63,46 @@ namespace Ogre
 
         Vector2 mDimensions;
 
+        /** Initializes up to ARRAY_PACKED_REALS particles at once, given where they were
+            emitted in emitter space. Generates everything else (direction, velocity, colour,
+            TTL, etc) and transforms position & direction by the instance's transform using SIMD.
+
+            Emitters that only differ in how they pick the position of each particle should
+            split newHandles with getNextPackSize(), generate the positions of each pack
+            and call this.
+        @remarks
+            When newHandles is a full, aligned range of consecutive handles (which is what
+            ParticleSystemDef::allocParticleRange returns), whole packs are written at once.
+        @param cpuData
+            Not advanced.
+        @param newHandles
+            Particles to initialize.
+        @param localPos
+            Array with numParticles positions, in emitter space.
+        @param numParticles
+            Number of particles to initialize. Must be in range (0; ARRAY_PACKED_REALS].
+        @return
+            True if the particles were written as a whole SIMD pack.
+        */
+        bool initEmittedParticlesPack( const ParticleCpuData &cpuData,
+                                       const EmittedParticle *newHandles, const Vector3 *localPos,
+                                       size_t numParticles );
+
+    public:
+        /** Returns how many of newHandles should go in the next initEmittedParticlesPack() call.
+
+            A range of consecutive handles that doesn't start at a multiple of ARRAY_PACKED_REALS
+            gets its unaligned head in a pack of its own, so that the packs that follow are
+            aligned and can be written whole.
+        @param newHandles
+            Particles left to initialize.
+        @param numParticles
+            Number of particles left to initialize. Must be > 0.
+        @return
+            Value in range (0; min( numParticles, ARRAY_PACKED_REALS )].
+        */
+        static size_t getNextPackSize( const EmittedParticle *newHandles, size_t numParticles );
+
     public:
         EmitterDefData();
 
@@ -76,10 +116,14 @@ namespace Ogre
         /** Must be called by 1 thread.
         @param timeSinceLast
         @param instanceData[in/out]
+        @param emissionRateScale
+            Multiplier applied to the emission rate. Used for distance-based LOD.
+            See ParticleSystemDef::setEmissionLodDistance().
         @return
             Total number of particles to emit.
         */
-        uint32 genEmissionCount( Real timeSinceLast, EmitterInstanceData &instanceData ) const;
+        uint32 genEmissionCount( Real timeSinceLast, EmitterInstanceData &instanceData,
+                                 Real emissionRateScale = 1.0f ) const;
 
         /** Initializes particles
             Can be called by multiple threads.
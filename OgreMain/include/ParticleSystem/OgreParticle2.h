@@ -100,6 +100,22 @@ namespace Ogre
         int16 mColourRgb[3];
     };
 
+    /// Newly emitted particle to be uploaded to ParticleGpuSimulation.
+    /// Layout must match ParticleGpuSimulation_piece_cs.any
+    struct _OgrePrivate ParticleGpuSpawn
+    {
+        uint32 mHandle;
+        uint32 mPadding[3];
+        float  mPosition[3];
+        float  mTimeToLive;
+        float  mDirection[3];
+        float  mTotalTimeToLive;
+        float  mDimensions[2];
+        float  mRotation;
+        float  mRotationSpeed;
+        float  mColour[4];
+    };
+
     struct _OgrePrivate EmittedParticle
     {
         uint32     handle;
@@ -40,6 +40,39 @@ namespace Ogre
 {
     OGRE_ASSUME_NONNULL_BEGIN
 
+    namespace GpuParticleAffectorType
+    {
+        /// Affectors ParticleGpuSimulation knows how to run.
+        /// Values must match ParticleGpuSimulation_piece_cs.any
+        enum GpuParticleAffectorType
+        {
+            /// params = force.xyz
+            LinearForceAdd,
+            /// params = force.xyz
+            LinearForceAverage,
+            /// params = colourAdj.xyzw, minColour.xyzw, maxColour.xyzw
+            ColourFader,
+            /// params = colourAdj1.xyzw, colourAdj2.xyzw, minColour.xyzw, maxColour.xyzw,
+            /// stateChangeVal
+            ColourFader2,
+            /// params = scaleAdj[6], timeAdj[6]
+            ScaleInterpolator,
+            /// No params
+            Rotation,
+            /// params = planeNormal.xyz, planeDistance, bounce
+            DeflectorPlane
+        };
+    }  // namespace GpuParticleAffectorType
+
+    /// Parameters of a ParticleAffector2 that can run in a compute shader. See ParticleGpuSimulation.
+    struct _OgreExport GpuParticleAffector
+    {
+        static constexpr size_t kMaxParams = 20u;
+
+        GpuParticleAffectorType::GpuParticleAffectorType type;
+        float                                            params[kMaxParams];
+    };
+
     /// Affectors are per ParticleSystemDef
     class _OgreExport ParticleAffector2 : public StringInterface
     {
@@ -69,6 +102,13 @@ namespace Ogre
         virtual void run( ParticleCpuData cpuData, size_t numParticles,
                           ArrayReal timeSinceLast ) const = 0;
 
+        /** Fills the parameters to perform the same work as run() in a compute shader.
+            See ParticleGpuSimulation.
+        @return
+            False if this affector can only run on the CPU (default).
+        */
+        virtual bool getGpuParams( GpuParticleAffector & /*outParams*/ ) const { return false; }
+
         virtual void _cloneFrom( const ParticleAffector2 *original ) = 0;
 
         /** Returns the name of the type of affector.
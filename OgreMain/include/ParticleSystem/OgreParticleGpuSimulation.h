@@ -0,0 +1,150 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2023 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef OgreParticleGpuSimulation_H
+#define OgreParticleGpuSimulation_H
+
+#include "OgrePrerequisites.h"
+
+#include "Compositor/OgreCompositorWorkspaceListener.h"
+#include "OgreResourceTransition.h"
+#include "ParticleSystem/OgreParticleAffector2.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    OGRE_ASSUME_NONNULL_BEGIN
+
+    class ParticleSystemDef;
+
+    /** Simulates ParticleSystemDefs with compute shaders instead of the CPU.
+    @remarks
+        Register it with CompositorManager2::addListener. Simulation happens in
+        allWorkspacesBeforeBeginUpdate, i.e. after SceneManager::updateSceneGraph and
+        before any pass gets executed. It must run once after every updateSceneGraph.
+    @par
+        The state of every particle lives in a UAV buffer that never leaves the GPU.
+        Emitters still run on the CPU (they are cheap and the number of particles emitted
+        per frame is small) as well as the particle handle bookkeeping, which only needs
+        to track the time to live. Newly emitted particles are streamed to the GPU
+        every frame. Everything else (affectors, movement and filling the buffer that
+        gets rendered) happens on the GPU.
+    @par
+        The particles are rendered exactly as before, thus the ParticleSystemDef's AABB
+        becomes infinite since the CPU no longer knows where the particles are.
+    @par
+        A ParticleSystemDef can only be GPU-simulated if all its affectors implement
+        ParticleAffector2::getGpuParams and the RenderSystem supports compute shaders.
+        Otherwise it keeps being simulated on the CPU.
+    @par
+        Requires the compute jobs "Compute/Algorithms/ParticleGpuSimulation/Spawn" and
+        "Compute/Algorithms/ParticleGpuSimulation/Simulate" from
+        Samples/Media/Compute/Algorithms/ParticleGpuSimulation
+    */
+    class _OgreExport ParticleGpuSimulation : public CompositorWorkspaceListener
+    {
+    protected:
+        struct SimulatedDef
+        {
+            ParticleSystemDef    *systemDef;
+            /// State of every particle. See ParticleGpuSimulation_piece_cs.any
+            UavBufferPacked      *stateBuffer;
+            /// Same contents as ParticleGpuData. Copied to dstGpuData after simulating.
+            UavBufferPacked      *gpuDataUav;
+            /// Replaces ParticleSystemDef::mGpuData while simulated
+            ReadOnlyBufferPacked *dstGpuData;
+            /// The original ParticleSystemDef::mGpuData, restored when removed
+            ReadOnlyBufferPacked *srcGpuData;
+        };
+
+        VaoManager                   *mVaoManager;
+        HlmsCompute *ogre_nullable    mHlmsCompute;
+        HlmsComputeJob *ogre_nullable mSpawnJob;
+        HlmsComputeJob *ogre_nullable mSimulateJob;
+
+        FastArray<SimulatedDef> mSystemDefs;
+
+        /// Here to avoid reallocations
+        FastArray<GpuParticleAffector> mAffectorParams;
+
+        ResourceTransitionArray mResourceTransitions;
+
+        void destroy( SimulatedDef &simulatedDef );
+
+        void dispatch( HlmsComputeJob *job, const uint32 jobParams[4], float timeSinceLast,
+                       uint32 numThreads );
+
+        void simulate( SimulatedDef &simulatedDef );
+
+    public:
+        /**
+        @param vaoManager
+        @param hlmsCompute
+            Can be null, in which case nothing can be added and everything stays on the CPU.
+        */
+        ParticleGpuSimulation( VaoManager *vaoManager, HlmsCompute *ogre_nullable hlmsCompute );
+        virtual ~ParticleGpuSimulation();
+
+        /// Returns true if all the affectors of the given definition can run on the GPU.
+        static bool canBeGpuSimulated( const ParticleSystemDef *systemDef );
+
+        /** Starts simulating the given definition on the GPU.
+        @remarks
+            The definition must have been initialized (see ParticleSystemDef::init) and must be
+            removed (see removeParticleSystemDef) before it gets destroyed.
+            Affectors can't be added or removed while it is being simulated.
+            Definitions that are ParticleSystemDef::isDepthSorted() stay on the CPU.
+        @return
+            False if it can't be simulated on the GPU, in which case it continues on the CPU.
+        */
+        bool addParticleSystemDef( ParticleSystemDef *systemDef );
+
+        /// Stops simulating the given definition on the GPU. Live particles continue on the CPU
+        /// from the state they had when they were emitted.
+        void removeParticleSystemDef( ParticleSystemDef *systemDef );
+
+        /// Removes all definitions.
+        void removeAllParticleSystemDefs();
+
+        size_t getNumParticleSystemDefs() const { return mSystemDefs.size(); }
+
+        /// Simulates all the definitions which were updated by ParticleSystemManager2
+        /// since the last call. Called automatically in allWorkspacesBeforeBeginUpdate.
+        void update();
+
+        /// CompositorWorkspaceListener override
+        void allWorkspacesBeforeBeginUpdate() override;
+    };
+
+    OGRE_ASSUME_NONNULL_END
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
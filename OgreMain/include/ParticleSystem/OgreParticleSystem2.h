@@ -120,7 +120,10 @@ namespace Ogre
     public:
         static constexpr uint32 InvalidHandle = 0xFFFFFFFF;
 
+        typedef RadixSort<std::vector<uint32>, uint32, uint16> ParticleRadixSort;
+
     protected:
+        friend class ParticleGpuSimulation;
         friend class ParticleSystemManager2;
 
         String mName;
@@ -131,6 +134,11 @@ namespace Ogre
         ConstBufferPacked *mGpuCommonData;
         /// Data for each individual particle set in an array
         ReadOnlyBufferPacked *mGpuData;
+        /// Region of mGpuData to bind. BillboardSets are rewritten every frame, thus
+        /// they sub-allocate it from VaoManager's read-only DynamicUploadRing instead
+        /// of owning a buffer. ParticleSystemDefs bind all of it.
+        size_t mGpuDataOffset;
+        size_t mGpuDataSizeBytes;
 
         Vector3 mCommonDirection;
         Vector3 mCommonUpVector;
@@ -176,8 +184,56 @@ namespace Ogre
 
         ParticleType::ParticleType mParticleType;
 
+        /// See ParticleGpuSimulation. When true, particles are emitted and killed on the CPU
+        /// but everything else (affectors, movement, filling mGpuData) happens on the GPU.
+        bool                        mGpuSimulated;
+        /// Set by ParticleSystemManager2 after each update, cleared by ParticleGpuSimulation.
+        bool                        mGpuSimulationPending;
+        /// Particle written at mGpuData[0] during the last update. Only valid if mGpuSimulated.
+        uint32                      mGpuFirstParticleSlot;
+        /// Only valid if mGpuSimulated. mGpuSpawns[i] is the initial state of mNewParticles[i].
+        FastArray<ParticleGpuSpawn> mGpuSpawns;
+
+        /// See isDepthSorted(). Distance to camera of each particle, in the same order as
+        /// mParticleGpuData. Negative if the particle is dead.
+        float *mSortDepths;
+        /// See isDepthSorted(). Indices to mParticleGpuData, sorted back to front.
+        std::vector<uint32> mSortedParticles;
+        ParticleRadixSort  *mRadixSorter;
+        /// See isDepthSorted(). Replaces ParticleSystemManager2's shared index buffer, and gets
+        /// rewritten every frame following mSortedParticles.
+        IndexBufferPacked *mSortedIndexBuffer;
+        void              *mSortedIndices;
+
+        /// See setInvisibleTickInterval().
+        /// ParticleSystem::mLastVisibleFrame is reused to store the last
+        /// ParticleSystemManager2::getCurrentFrame() in which any of our instances was visible.
+        uint32 mInvisibleTickInterval;
+        /// Consecutive updates skipped because none of our instances were visible.
+        uint32 mSkippedFrames;
+        /// Time to simulate in this frame's update. Accumulates while updates are being skipped.
+        /// Use this instead of ParticleSystemManager2::getTimeSinceLast().
+        Real mTimeSinceLast;
+        /// See setEmissionLodDistance().
+        Real mEmissionLodDistance;
+
         uint32 allocParticle();
 
+        /** Allocates up to numParticles particles with consecutive handles, in one go.
+            Use it instead of allocParticle() to emit many particles at once (e.g. bursts),
+            since their data will be contiguous in the SoA arrays.
+        @param numParticles
+            Number of particles wanted.
+        @param outFirstHandle[out]
+            Handle of the first allocated particle. The rest are outFirstHandle + 1,
+            outFirstHandle + 2, etc.
+        @return
+            Number of particles allocated. May be less than numParticles if the pool is
+            running out or the range wraps around; call again to get the rest.
+            0 if no particle could be allocated.
+        */
+        uint32 allocParticleRange( uint32 numParticles, uint32 &outFirstHandle );
+
         void deallocParticle( uint32 handle );
 
         /** Gets the particle handle based on cpuData's current advanced pointers and its idx
@@ -201,6 +257,10 @@ namespace Ogre
         /// in a limited quota pool.
         void sortByDistanceTo( Vector3 camPos );
 
+        /// Copies the initial state of mNewParticles[firstNewParticle + i] into mGpuSpawns.
+        /// Can be called from multiple threads as long as their ranges don't overlap.
+        void fillGpuSpawns( size_t firstNewParticle, size_t numParticles );
+
         void cloneTo( ParticleSystemDef *toClone );
 
     public:
@@ -236,6 +296,21 @@ namespace Ogre
 
         bool isInitialized() const;
 
+        /// Returns true if this definition is being simulated by a ParticleGpuSimulation.
+        bool isGpuSimulated() const { return mGpuSimulated; }
+
+        /** Returns true if particles are drawn back to front.
+        @remarks
+            Sorting is enabled with setSortingEnabled() (or 'sorted true' in scripts), which must be
+            called before init(). Particles of all instances are sorted together by their distance
+            to ParticleSystemManager2::getCameraPosition().
+        */
+        bool isDepthSorted() const { return mSortedIndexBuffer != 0; }
+
+        /// Indices of the particles in _getGpuDataBuffer() in the order they were last drawn.
+        /// Only valid if isDepthSorted().
+        const std::vector<uint32> &_getSortedParticles() const { return mSortedParticles; }
+
         const String getName() const { return mName; }
 
         void setParticleQuota( size_t quota ) override;
@@ -246,6 +321,36 @@ namespace Ogre
 
         ParticleRotationType::ParticleRotationType getRotationType() const;
 
+        /** Throttles the simulation of particle systems that were not visible in the previous frame.
+        @remarks
+            When none of the instances were visible, the whole definition is updated once every
+            numFrames frames (and immediately once any of them becomes visible again).
+            Individual instances that are not visible emit once every numFrames frames.
+
+            The skipped time is accumulated and simulated in one step, thus the same amount of
+            particles gets emitted as if it hadn't been throttled.
+
+            Visibility is determined by frustum culling each instance's local AABB (see
+            MovableObject::setLocalAabb), which is infinite by default (i.e. always visible),
+            against ParticleSystemManager2::setCullCamera().
+
+            Ignored by definitions simulated by ParticleGpuSimulation.
+        @param numFrames
+            Value in range [1; inf). 1 means no throttling. Default is 1.
+        */
+        void setInvisibleTickInterval( uint32 numFrames );
+
+        uint32 getInvisibleTickInterval() const { return mInvisibleTickInterval; }
+
+        /** Instances further than this distance from ParticleSystemManager2::getCameraPosition()
+            get their emission rate scaled down by distance / lodDistance.
+        @param lodDistance
+            Value in range [0; inf). 0 disables emission LOD. Default is 0.
+        */
+        void setEmissionLodDistance( Real lodDistance );
+
+        Real getEmissionLodDistance() const { return mEmissionLodDistance; }
+
         /// See setCommonDirection() and setCommonUpVector().
         /// Use this version if you have to often change both of these at the same time.
         void setCommonVectors( const Vector3 &commonDir, const Vector3 &commonUp );
@@ -414,6 +519,8 @@ namespace Ogre
 
         ConstBufferPacked    *_getGpuCommonBuffer() const { return mGpuCommonData; }
         ReadOnlyBufferPacked *_getGpuDataBuffer() const { return mGpuData; }
+        size_t                _getGpuDataOffset() const { return mGpuDataOffset; }
+        size_t                _getGpuDataSizeBytes() const { return mGpuDataSizeBytes; }
 
         bool getUseIdentityWorldMatrix() const override { return true; }
 
@@ -429,6 +536,7 @@ namespace Ogre
 
     class _OgreExport ParticleSystem2 : public MovableObject
     {
+        friend class ParticleSystemDef;
         friend class ParticleSystemManager2;
 
         const ParticleSystemDef *mCreator;
@@ -439,6 +547,14 @@ namespace Ogre
         /// mNewParticlesPerEmitter.size() == ParticleSystemDef::mEmitters.size()
         FastArray<size_t> mNewParticlesPerEmitter;
 
+        /// Last frame (see ParticleSystemManager2::getCurrentFrame()) this instance passed
+        /// frustum culling.
+        uint32 mLastVisibleFrame;
+        /// See ParticleSystemDef::setInvisibleTickInterval().
+        uint32 mSkippedFrames;
+        /// Emission time accumulated while skipping frames.
+        Real mTimeSinceLast;
+
     public:
         /// See MovableObject::mGlobalIndex.
         /// This one tracks our place in ParticleSystemDef::mParticleSystems
@@ -450,6 +566,10 @@ namespace Ogre
         const String &getMovableType() const override;
 
         const ParticleSystemDef *getParticleSystemDef() const { return mCreator; }
+
+        /// Returns the last ParticleSystemManager2::getCurrentFrame() in which this instance passed
+        /// frustum culling. See ParticleSystemDef::setInvisibleTickInterval().
+        uint32 getLastVisibleFrame() const { return mLastVisibleFrame; }
     };
 
     /// Object for creating ParticleSystem2 instances
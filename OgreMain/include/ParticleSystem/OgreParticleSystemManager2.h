@@ -68,15 +68,28 @@ namespace Ogre
 
         float mTimeSinceLast;  // For threaded update.
 
+        /// Incremented on every prepareForUpdate(). See getCurrentFrame().
+        uint32 mCurrentFrame;
+
         // There's one ParticleSystemManager2 owned by Root (the 'master') which holds all templates.
         // And one ParticleSystemManager2 per SceneManager that reference Root's.
         ParticleSystemManager2 *ogre_nullable mMaster;
         ObjectMemoryManager                  *mMemoryManager;
 
+        /// See setCullCamera().
+        const Camera *ogre_nullable mCullCamera;
+
         Vector3                        mCameraPos;
         FastArray<ParticleSystemDef *> mActiveParticlesLeftToSort;  // GUARDED_BY( mSortMutex )
         LightweightMutex               mSortMutex;
 
+        /// Active ParticleSystemDefs whose particles must be sorted in _updateParallel03().
+        FastArray<ParticleSystemDef *> mDepthSortedSystemDefs;
+
+        /// Subset of mActiveParticleSystemDefs that is simulated this frame.
+        /// See ParticleSystemDef::setInvisibleTickInterval().
+        FastArray<ParticleSystemDef *> mParticleSystemDefsToUpdate;
+
         void calculateHighestPossibleQuota( VaoManager *vaoManager );
         void createSharedIndexBuffers( VaoManager *vaoManager );
 
@@ -84,8 +97,26 @@ namespace Ogre
                                    ParticleGpuData *gpuData, const size_t numParticles,
                                    ParticleSystemDef *systemDef, ArrayAabb &inOutAabb );
 
-        inline void sortAndPrepare( ParticleSystemDef *systemDef, const Vector3 &camPos,
-                                    float timeSinceLast );
+        /// Like tickParticles(), but only updates the time to live, for particles simulated by
+        /// ParticleGpuSimulation.
+        inline void tickTimeToLive( size_t threadIdx, ArrayReal timeSinceLast, ParticleCpuData cpuData,
+                                    size_t numParticles, ParticleSystemDef *systemDef );
+
+        /// Writes the distance to camPos of each particle into outDepths.
+        /// Dead particles get a negative distance.
+        inline void calculateSortDepths( ParticleCpuData cpuData, float *outDepths, size_t numParticles,
+                                         const ArrayVector3 &camPos );
+
+        /// Radix sorts the particles of a definition back to front using the values from
+        /// calculateSortDepths(), and writes the result into its index buffer.
+        void sortParticles( ParticleSystemDef *systemDef );
+
+        inline void sortAndPrepare( ParticleSystemDef *systemDef, const Vector3 &camPos );
+
+        /// Frustum culls every instance of systemDef against the given planes, flagging those visible
+        /// with mCurrentFrame. Returns true if at least one of them is visible.
+        bool cullParticleSystems( ParticleSystemDef *systemDef, const Plane *frustumPlanes,
+                                  bool bInfiniteFarPlane );
 
         void updateSerialPos();
 
@@ -219,6 +250,28 @@ namespace Ogre
 
         const Vector3 &getCameraPosition() const { return mCameraPos; }
 
+        /** Sets the camera ParticleSystem2 instances are frustum culled against during update(),
+            to decide which ones must be throttled. See ParticleSystemDef::setInvisibleTickInterval().
+        @remarks
+            Only one camera per SceneManager is supported; use the main one. Shadow and other passes
+            don't affect visibility. Culling uses each instance's local AABB (see
+            MovableObject::setLocalAabb).
+
+            SceneManager::destroyCamera() unsets it.
+        @param camera
+            Camera to cull against. Null (default) treats all instances as visible.
+        */
+        void setCullCamera( const Camera *ogre_nullable camera ) { mCullCamera = camera; }
+
+        const Camera *ogre_nullable getCullCamera() const { return mCullCamera; }
+
+        /// Returns the timeSinceLast used by the last update that had something to simulate.
+        float getTimeSinceLast() const { return mTimeSinceLast; }
+
+        /// Returns the number of times prepareForUpdate() had something to simulate.
+        /// Used to track which ParticleSystem2 were visible in the previous frame.
+        uint32 getCurrentFrame() const { return mCurrentFrame; }
+
         /** The order of function calls is:
                 1. manager->prepareForUpdate( timeSinceLast ) (main thread)
                 2. manager->_prepareParallel() (from many threads)
@@ -266,6 +319,20 @@ namespace Ogre
         */
         void _updateParallel02( size_t threadIdx, size_t numThreads );
 
+        /// Returns true if _updateParallel03() must be called after _updateParallel02().
+        /// Only valid after prepareForUpdate().
+        bool _needsDepthSorting() const { return !mDepthSortedSystemDefs.empty(); }
+
+        /** See _updateParallel02().
+        @remarks
+            Only needs to be called if _needsDepthSorting() returns true.
+            This function sorts the particles of ParticleSystemDefs that are
+            ParticleSystemDef::isDepthSorted().
+            Each thread handles a whole ParticleSystemDef. (i.e. 2 threads won't concurrently
+            access the same ParticleSystemDef).
+        */
+        void _updateParallel03( size_t threadIdx, size_t numThreads );
+
         /// See prepareForUpdate()
         ///
         /// Must be called after prepareForUpdate() & _prepareParallel().
@@ -0,0 +1,216 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _Ogre_DynamicUploadRing_H_
+#define _Ogre_DynamicUploadRing_H_
+
+#include "OgrePrerequisites.h"
+
+#include "Vao/OgreBufferPacked.h"
+
+#include "ogrestd/vector.h"
+
+namespace Ogre
+{
+    /** Linear per-frame allocator for small, short lived GPU data (i.e. per-frame constants
+        or instance data written by ManualObject-like renderables).
+    @remarks
+        Creating one dynamic buffer per consumer means one map, one unmap and one fence
+        tracking per consumer and per frame. Instead, the ring owns a few big dynamic buffers
+        ("chunks") that get mapped once per frame, and hands out aligned sub-regions with a
+        bump pointer. There is no deallocation: everything allocated in a frame is implicitly
+        released when the frame ends, and is only overwritten once the GPU is done with it,
+        since chunks are regular dynamic buffers (see VaoManager::getDynamicBufferMultiplier).
+    @par
+        If a frame needs more memory than available, an extra chunk is created for that frame,
+        and at the end of the frame the chunks are replaced by ones twice as big (as long as
+        they don't exceed the maximum bindable size).
+    @par
+        Allocations are only valid until the end of the current frame. The returned buffer must
+        be bound with the returned offset, i.e.
+        @code
+            DynamicUploadRing::Allocation alloc = ring->allocate( sizeBytes );
+            memcpy( alloc.data, myData, sizeBytes );
+            *commandBuffer->addCommand<CbShaderBuffer>() =
+                CbShaderBuffer( VertexShader, slot, alloc.buffer, alloc.offset, sizeBytes );
+        @endcode
+    @par
+        ConstBufferPacked ignores the bind offset on all RenderSystems. Allocations from
+        the const ring are only usable by shaders that index into the whole chunk on their
+        own (like HlmsBufferManager does with drawId). This is why the Hlms pass buffers
+        don't use the ring yet.
+    @par
+        Data that must outlive the frame doesn't belong here either: ParticleSystemDef keeps
+        its own buffer because throttled systems (see ParticleSystemDef::setInvisibleTickInterval) aren't
+        rewritten every frame and GPU simulated ones replace it with their own; and
+        ManualObject's vertex & index buffers persist until the next update, while Vaos
+        can't bind a sub-range of a buffer.
+    @par
+        Use VaoManager::getDynamicUploadRing to retrieve the rings. Don't create them directly.
+    */
+    class _OgreExport DynamicUploadRing : public OgreAllocatedObj
+    {
+    public:
+        struct Allocation
+        {
+            /// ConstBufferPacked or ReadOnlyBufferPacked, depending on the ring
+            BufferPacked *buffer;
+            /// Offset in bytes to bind buffer with. Already aligned.
+            size_t offset;
+            /// Write-only pointer to the allocated region. Don't read from it.
+            void *data;
+
+            Allocation() : buffer( 0 ), offset( 0 ), data( 0 ) {}
+            Allocation( BufferPacked *_buffer, size_t _offset, void *_data ) :
+                buffer( _buffer ),
+                offset( _offset ),
+                data( _data )
+            {
+            }
+        };
+
+        struct Stats
+        {
+            /// Sum of the size of all chunks (for a single frame)
+            size_t capacityBytes;
+            size_t usedBytesLastFrame;
+            size_t peakUsedBytes;
+            size_t numAllocationsLastFrame;
+            size_t peakNumAllocations;
+            /// Number of times the chunks had to be grown because a frame didn't fit
+            size_t numGrowths;
+
+            Stats() :
+                capacityBytes( 0 ),
+                usedBytesLastFrame( 0 ),
+                peakUsedBytes( 0 ),
+                numAllocationsLastFrame( 0 ),
+                peakNumAllocations( 0 ),
+                numGrowths( 0 )
+            {
+            }
+        };
+
+    protected:
+        struct Chunk
+        {
+            BufferPacked *buffer;
+            /// Null if not mapped (or can't be written anymore this frame)
+            uint8 *mappedPtr;
+            size_t usedBytes;
+            /// True if the chunk was already mapped this frame. Buffers can't
+            /// be mapped twice in the same frame.
+            bool bMappedThisFrame;
+
+            Chunk( BufferPacked *_buffer ) :
+                buffer( _buffer ),
+                mappedPtr( 0 ),
+                usedBytes( 0 ),
+                bMappedThisFrame( false )
+            {
+            }
+        };
+
+        typedef vector<Chunk>::type ChunkVec;
+
+        ChunkVec mChunks;
+        size_t   mCurrentChunk;
+
+        VaoManager       *mVaoManager;
+        BufferPackedTypes mBufferPackedType;
+        BufferType        mBufferType;
+        uint32            mAlignment;
+        size_t            mChunkSizeBytes;
+        size_t            mMaxSizeBytes;
+
+        size_t mNumAllocationsThisFrame;
+        /// True if a chunk ran out of space in this frame
+        bool  mSpilledThisFrame;
+        Stats mStats;
+
+        BufferPacked *createChunkBuffer( size_t sizeBytes );
+        void          destroyChunkBuffer( BufferPacked *buffer );
+        void          destroyAllChunks();
+
+        /// Maps the chunk if it wasn't mapped this frame yet. Returns false if the chunk
+        /// can't be written to anymore in this frame.
+        bool mapChunk( Chunk &chunk );
+
+    public:
+        /**
+        @param bufferPackedType
+            Either BP_TYPE_CONST or BP_TYPE_READONLY.
+        @param chunkSizeBytes
+            Initial size of each chunk. Grows automatically if needed.
+        */
+        DynamicUploadRing( VaoManager *vaoManager, BufferPackedTypes bufferPackedType,
+                           size_t chunkSizeBytes );
+        /// Buffers are owned by VaoManager; they're not destroyed here.
+        ~DynamicUploadRing();
+
+        /** Sub-allocates sizeBytes from the current frame.
+        @remarks
+            The first allocation in a frame maps the chunk, which may stall if the GPU
+            hasn't finished with the frame that last used this region
+            (see VaoManager::waitForTailFrameToFinish).
+        @param sizeBytes
+            Size in bytes. Can't exceed the maximum bindable size of the buffer type.
+        @param alignment
+            Extra alignment requirement in bytes, i.e. structure stride. The offset is always
+            aligned to VaoManager's const or tex buffer alignment. Use 0 for none.
+        @return
+            The allocated region. Write to it before the commands using it get executed.
+        */
+        Allocation allocate( size_t sizeBytes, size_t alignment = 0u );
+
+        /** Makes all writes so far visible to the GPU. Called automatically before the
+            RenderQueue executes its commands.
+        @remarks
+            On RenderSystems without persistent mapping, chunks with allocations get unmapped
+            and further allocations in this frame will use a different chunk.
+        */
+        void flush();
+
+        /// Changes the size of chunks created from now on.
+        void   setChunkSize( size_t chunkSizeBytes );
+        size_t getChunkSize() const { return mChunkSizeBytes; }
+
+        BufferPackedTypes getBufferPackedType() const { return mBufferPackedType; }
+
+        const Stats &getStats() const { return mStats; }
+
+        /// Called by VaoManager at the end of each frame. Releases all allocations made
+        /// in the frame and updates the statistics.
+        void _endFrame();
+
+        /// Called by VaoManager when all buffers are about to be deleted.
+        void _notifyBuffersDeleted();
+    };
+}  // namespace Ogre
+
+#endif
@@ -0,0 +1,209 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _Ogre_TlsfAllocator_H_
+#define _Ogre_TlsfAllocator_H_
+
+#include "OgrePrerequisites.h"
+
+#include "ogrestd/unordered_map.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+     *  @{
+     */
+    /** \addtogroup RenderSystem
+     *  @{
+     */
+
+    /** Two-Level Segregated Fit suballocator.
+
+        Manages offsets inside a range [0; capacity) that lives somewhere else (e.g. a GPU
+        buffer). It never touches the memory it manages, therefore all bookkeeping is
+        stored on the side.
+
+        Allocating and deallocating are O(1): free blocks are binned into size classes
+        (a power of two, subdivided linearly into c_numSecondLevels bins) tracked by
+        bitmasks, and blocks are coalesced with their physical neighbours on release.
+
+        Alignment doesn't need to be a power of two (e.g. bytesPerElement = 12 is valid).
+        The bytes skipped to honour the alignment are returned to the allocator as
+        a free block instead of being tracked by the caller.
+    @remarks
+        Used by the VaoManager implementations to suballocate their buffer pools.
+    */
+    class _OgreExport TlsfAllocator
+    {
+    public:
+        struct Block
+        {
+            size_t offset;
+            size_t size;
+
+            Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
+        };
+        typedef vector<Block>::type BlockVec;
+
+        struct Stats
+        {
+            size_t capacity;
+            size_t freeBytes;
+            /// Size of the biggest allocation that is guaranteed to succeed (if alignment == 1)
+            size_t largestFreeBlock;
+            size_t numFreeBlocks;
+            size_t numUsedBlocks;
+
+            Stats();
+
+            /// Returns a value in range [0; 1]. 0 means all free memory is contiguous,
+            /// values close to 1 mean free memory is scattered into lots of small holes.
+            float getFragmentation() const;
+        };
+
+    protected:
+        static const uint32 c_invalidNode = 0xFFFFFFFFu;
+
+        static const uint32 c_secondLevelLog2 = 4u;
+        static const uint32 c_numSecondLevels = 1u << c_secondLevelLog2;
+        static const uint32 c_numFirstLevels = 64u - c_secondLevelLog2 + 1u;
+
+        struct Node
+        {
+            size_t offset;
+            size_t size;
+            /// Physical neighbours (i.e. sorted by offset)
+            uint32 prevPhys;
+            uint32 nextPhys;
+            /// Neighbours in the free list of the same size class. Only valid if isFree
+            uint32 prevFree;
+            uint32 nextFree;
+            bool   isFree;
+        };
+
+        typedef vector<Node>::type                  NodeVec;
+        typedef unordered_map<size_t, uint32>::type OffsetToNodeMap;
+
+        NodeVec              mNodes;
+        vector<uint32>::type mUnusedNodes;
+        /// Used blocks, indexed by their offset
+        OffsetToNodeMap mUsedNodes;
+
+        uint64 mFirstLevelBitmap;
+        uint32 mSecondLevelBitmap[c_numFirstLevels];
+        uint32 mFreeListHeads[c_numFirstLevels][c_numSecondLevels];
+
+        uint32 mFirstPhysNode;
+        size_t mCapacity;
+        size_t mFreeBytes;
+        size_t mNumFreeBlocks;
+
+        static void mapping( size_t size, uint32 &outFirstLevel, uint32 &outSecondLevel );
+
+        /// Returns the head of the first free list whose blocks are all >= sizeBytes.
+        /// c_invalidNode if there's none.
+        uint32 findSuitableNode( size_t sizeBytes ) const;
+
+        uint32 createNode( size_t offset, size_t size, uint32 prevPhys, uint32 nextPhys );
+        void   destroyNode( uint32 nodeIdx );
+
+        void insertFreeNode( uint32 nodeIdx );
+        void removeFreeNode( uint32 nodeIdx );
+
+        /// Merges nodeIdx's next physical neighbour into nodeIdx. The neighbour must be free
+        /// and already removed from its free list.
+        void absorbNextNode( uint32 nodeIdx );
+
+        /// Marks [offset; offset + sizeBytes) as used. It must lie inside nodeIdx, which must
+        /// be free and already removed from its free list. The bytes before & after it are
+        /// returned to the free lists.
+        void useNode( uint32 nodeIdx, size_t offset, size_t sizeBytes );
+
+    public:
+        TlsfAllocator();
+        explicit TlsfAllocator( size_t capacity );
+
+        /// Discards all allocations and starts over with the given capacity
+        void reset( size_t capacity );
+
+        /** Suballocates sizeBytes.
+        @param sizeBytes
+            Size in bytes to allocate. Must be > 0.
+        @param alignment
+            Returned offset will be a multiple of this value. Must be > 0.
+        @param outOffset [out]
+            Offset to the allocated region. Only valid if we returned true.
+        @return
+            False if there's no free region big enough.
+        */
+        bool allocate( size_t sizeBytes, size_t alignment, size_t &outOffset );
+
+        /** Suballocates exactly the region [offset; offset + sizeBytes). O(N).
+            For pools whose layout was decided beforehand, e.g. when the contents of several
+            buffers get merged into a single one. Release it with deallocate as usual.
+        @remarks
+            Throws if the region isn't free.
+        */
+        void allocateAt( size_t offset, size_t sizeBytes );
+
+        /** Releases a region returned by allocate.
+        @param offset
+            Offset returned by allocate
+        @param sizeBytes
+            Size passed to allocate. Used for validation only.
+        */
+        void deallocate( size_t offset, size_t sizeBytes );
+
+        size_t getCapacity() const { return mCapacity; }
+        size_t getFreeBytes() const { return mFreeBytes; }
+
+        /// Returns true if there are no allocations
+        bool isEmpty() const { return mUsedNodes.empty(); }
+
+        /// Returns the size of the biggest free block. O(N) in the worst case,
+        /// where N is the number of free blocks in the biggest size class in use.
+        size_t getLargestFreeBlock() const;
+
+        void getStats( Stats &outStats ) const;
+
+        /// Appends all used blocks, sorted by offset, into outBlocks.
+        /// Contiguous used blocks are merged together.
+        void getUsedBlocks( BlockVec &outBlocks ) const;
+    };
+
+    /** @} */
+    /** @} */
+
+}  // namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -44,6 +44,17 @@ namespace Ogre
 
     class _OgreExport VaoManager : public OgreAllocatedObj
     {
+    public:
+        /// Accumulated results of all defragmentPools calls. See getDefragmentationStats
+        struct DefragmentationStats
+        {
+            size_t bytesMoved;
+            size_t buffersMoved;
+            size_t poolsReleased;
+
+            DefragmentationStats() : bytesMoved( 0 ), buffersMoved( 0 ), poolsReleased( 0 ) {}
+        };
+
     protected:
         Timer *mTimer;
 
@@ -94,6 +105,21 @@ namespace Ogre
         size_t mReadOnlyBufferMaxSize;
         size_t mUavBufferMaxSize;
 
+        /// See setDefragmentationBudget
+        size_t mDefragmentationBudget;
+        float  mDefragmentationMaxPoolUsage;
+        /// True when buffers were destroyed since the last defragmentation pass
+        /// that found nothing to do. Avoids scanning all buffers every frame.
+        bool mDefragmentationDirty;
+        /// Derived classes set it to true if they implement relocateBufferImpl
+        bool mSupportsBufferRelocation;
+
+        DefragmentationStats mDefragmentationStats;
+
+        /// [0] = const buffers, [1] = read-only buffers. Created on demand.
+        /// See getDynamicUploadRing
+        DynamicUploadRing *mDynamicUploadRings[2];
+
         virtual VertexBufferPacked *createVertexBufferImpl(
             size_t numElements, uint32 bytesPerElement, BufferType bufferType, void *initialData,
             bool keepAsShadow, const VertexElement2Vec &vertexElements ) = 0;
@@ -167,6 +193,35 @@ namespace Ogre
         virtual void switchVboPoolIndexImpl( unsigned internalVboBufferType, size_t oldPoolIdx,
                                              size_t newPoolIdx, BufferPacked *buffer ) = 0;
 
+        /** Retrieves the pool the buffer lives in, using the same poolType and poolIdx
+            values reported by getMemoryPoolStats.
+        @return
+            False if the buffer can't be relocated (e.g. it isn't pooled or is dynamic).
+            The default implementation always returns false.
+        */
+        virtual bool getBufferPool( const BufferPacked *buffer, uint32 &outPoolType,
+                                    uint32 &outPoolIdx ) const;
+
+        /** Moves the contents of the buffer into another pool of the same type using a
+            GPU-side copy, and updates the buffer to point to its new location.
+        @remarks
+            Implementations must not create new pools; only existing pools other than
+            srcPoolIdx are valid destinations.
+            The old region may be released immediately, but it must not be handed out
+            again while the GPU may still be reading from it.
+        @return
+            False if no other pool had room for it. The buffer is left untouched.
+        */
+        virtual bool relocateBufferImpl( BufferPacked *buffer, uint32 poolType, uint32 srcPoolIdx );
+
+        /// Called after relocating one or more buffers referenced by the Vao, so the
+        /// API objects (and mVaoName / mRenderQueueId) can be updated.
+        virtual void refreshVertexArrayObjectImpl( VertexArrayObject *vao );
+
+        /// Dumps the statistics of the DynamicUploadRings to the log.
+        /// Meant to be called by getMemoryStats implementations.
+        void logDynamicUploadRingStats( Log *log ) const;
+
     public:
         VaoManager( const NameValuePairList *params );
         virtual ~VaoManager();
@@ -235,6 +290,30 @@ namespace Ogre
 
         typedef vector<MemoryStatsEntry>::type MemoryStatsEntryVec;
 
+        /// Fragmentation information about a single pool. See getMemoryPoolStats
+        struct _OgreExport MemoryPoolStats
+        {
+            /// Same as MemoryStatsEntry::poolType
+            uint32 poolType;
+            uint32 poolIdx;
+            size_t poolCapacity;
+            size_t freeBytes;
+            /// Biggest contiguous free region. A request bigger than this
+            /// will cause a new pool to be created.
+            size_t largestFreeBlock;
+            size_t numFreeBlocks;
+            bool   bPoolHasTextures;
+
+            MemoryPoolStats( uint32 _poolType, uint32 _poolIdx, size_t _poolCapacity,
+                             bool _bPoolHasTextures );
+
+            /// Returns a value in range [0; 1]. 0 means all free memory in the pool is
+            /// contiguous, values close to 1 mean it is scattered into lots of small holes.
+            float getFragmentation() const;
+        };
+
+        typedef vector<MemoryPoolStats>::type MemoryPoolStatsVec;
+
         /** Retrieves memory stats about our GPU pools being managed.
             The output in the Log will be csv data that resembles the following:
                 Pool Type                   Offset	Bytes       Pool Capacity
@@ -258,6 +337,7 @@ namespace Ogre
             Total free memory available for consumption.
         @param log
             Optional to dump all information to a CSV file. Nullptr to avoid dumping.
+            The usage of the DynamicUploadRings is dumped at the end.
         @param outIncludesTextures [out]
             When true, memory reports in outCapacityBytes & outFreeBytes include textures.
             See Tutorial_Memory on how to deal with this output.
@@ -271,9 +351,55 @@ namespace Ogre
                                      size_t &outFreeBytes, Log *log,
                                      bool &outIncludesTextures ) const = 0;
 
+        /** Retrieves fragmentation stats of each GPU pool being managed.
+            Complements getMemoryStats: it tells how scattered the free memory of each pool is.
+        @remarks
+            The default implementation derives them from getMemoryStats, and is thus as slow.
+            RenderSystems that track this information directly override it.
+        @param outStats [out]
+            One entry per pool. Previous contents are cleared.
+        */
+        virtual void getMemoryPoolStats( MemoryPoolStatsVec &outStats ) const;
+
         /// Frees GPU memory if there are empty, unused pools
         virtual void cleanupEmptyPools() = 0;
 
+        /** Enables incremental defragmentation of the pools, performed every frame in _update.
+            cleanupEmptyPools can only free pools that are completely empty; whereas
+            defragmentation moves live BT_IMMUTABLE and BT_DEFAULT vertex & index buffers
+            out of mostly empty pools into other pools so that they can be released.
+        @remarks
+            Only works if supportsBufferRelocation returns true, otherwise it's ignored.
+            Buffers from MultiSourceVertexBufferPool are never moved.
+            Vaos referencing moved buffers are patched automatically, but their
+            mVaoName & mRenderQueueId may change (see VertexArrayObject).
+        @param bytesPerFrame
+            Maximum number of bytes to move per frame. 0 to disable (default).
+            At least one buffer is moved per frame even if it is bigger than this budget.
+        @param maxPoolUsage
+            In range [0; 1]. Only pools whose used memory is below this ratio
+            of their capacity are considered for being emptied.
+        */
+        void   setDefragmentationBudget( size_t bytesPerFrame, float maxPoolUsage = 0.5f );
+        size_t getDefragmentationBudget() const { return mDefragmentationBudget; }
+        float  getDefragmentationMaxPoolUsage() const { return mDefragmentationMaxPoolUsage; }
+
+        /// Whether this RenderSystem is able to move buffers between pools.
+        /// See setDefragmentationBudget
+        bool supportsBufferRelocation() const { return mSupportsBufferRelocation; }
+
+        const DefragmentationStats &getDefragmentationStats() const { return mDefragmentationStats; }
+
+        /** Performs one defragmentation step. Called automatically from _update when a
+            budget was set via setDefragmentationBudget, but it can be called manually
+            (e.g. during a loading screen with a bigger budget).
+        @param maxBytes
+            Maximum number of bytes to move. At least one buffer is moved regardless.
+        @return
+            Number of bytes moved.
+        */
+        size_t defragmentPools( size_t maxBytes );
+
         /// Returns the size of a single vertex buffer source with the given declaration, in bytes
         static uint32 calculateVertexSize( const VertexElement2Vec &vertexElements );
 
@@ -491,6 +617,19 @@ namespace Ogre
         virtual AsyncTicketPtr createAsyncTicket( BufferPacked *creator, StagingBuffer *stagingBuffer,
                                                   size_t elementStart, size_t elementCount ) = 0;
 
+        /** Returns the shared per-frame allocator for small dynamic data. See DynamicUploadRing.
+        @remarks
+            Prefer this over creating one BT_DYNAMIC_* buffer per object when the data is
+            rewritten every frame: all objects then share one map per frame.
+        @param bufferPackedType
+            BP_TYPE_CONST or BP_TYPE_READONLY.
+        */
+        DynamicUploadRing *getDynamicUploadRing( BufferPackedTypes bufferPackedType );
+
+        /// Calls DynamicUploadRing::flush on all rings. Called by the RenderQueue
+        /// right before executing its commands.
+        void _flushDynamicUploadRings();
+
         virtual void _beginFrame() {}
         virtual void _update();
 
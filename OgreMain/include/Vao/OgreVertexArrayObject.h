@@ -53,6 +53,8 @@ namespace Ogre
         of this class, the internal values of mVaoName & mRenderQueueId may
         be changed automatically by the VaoManager as it performs maintenance
         and cleanups of these type of buffers (in practice only affects D3D11).
+        The same applies to BT_IMMUTABLE & BT_DEFAULT buffers when pool
+        defragmentation is enabled (see VaoManager::setDefragmentationBudget).
         Don't rely on the contents of these two variables if the Vao contains
     */
     struct _OgreExport VertexArrayObject : public OgreAllocatedObj
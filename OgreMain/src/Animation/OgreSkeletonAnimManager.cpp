@@ -110,6 +110,7 @@ namespace Ogre
         // remove a previous instance and the slot was reused. Otherwise something nasty happened.
         assert( it == skeletonsArray.end() || ( *it )->_getMemoryUniqueOffset() != newInstance );
 
+        newInstance->setAnimationLodPhase( static_cast<uint32>( skeletonsArray.size() ) );
         skeletonsArray.insert( it, newInstance );
 
 #if OGRE_DEBUG_MODE >= OGRE_DEBUG_HIGH
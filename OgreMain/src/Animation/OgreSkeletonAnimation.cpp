@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "Animation/OgreSkeletonAnimation.h"
 
 #include "Animation/OgreSkeletonAnimationDef.h"
+#include "Animation/OgreSkeletonDef.h"
 #include "Animation/OgreSkeletonInstance.h"
 
 #if defined( __GNUC__ ) && !defined( __clang__ )
@@ -52,7 +53,9 @@ namespace Ogre
         mLoop( true ),
         mEnabled( false ),
         mOwner( owner ),
-        mName( definition->mName )
+        mName( definition->mName ),
+        mLayer( 0u ),
+        mBlendMode( SkeletonBlendMode::Additive )
     {
         mLastKnownKeyFrames.reserve( definition->mTracks.size() );
 #ifndef NDEBUG
@@ -69,6 +72,15 @@ namespace Ogre
         ArrayReal *boneWeights = mBoneWeights.get();
         Real *boneWeightsScalar = reinterpret_cast<Real *>( mBoneWeights.get() );
 
+        if( mDefinition->isCompressed() )
+        {
+            const size_t numTracks = mDefinition->mTracks.size();
+            mCompressedCache = RawSimdUniquePtr<CompressedKfCache, MEMCATEGORY_ANIMATION>( numTracks );
+            CompressedKfCache *compressedCache = mCompressedCache.get();
+            for( size_t i = 0; i < numTracks; ++i )
+                compressedCache[i].mKeyFrameIdx[0] = compressedCache[i].mKeyFrameIdx[1] = ~0u;
+        }
+
         SkeletonTrackVec::const_iterator itor = mDefinition->mTracks.begin();
         SkeletonTrackVec::const_iterator endt = mDefinition->mTracks.end();
 
@@ -189,6 +201,29 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void SkeletonAnimation::setSubtreeBoneWeight( IdString boneName, Real weight )
+    {
+        const SkeletonDef *skeletonDef = mOwner->getDefinition();
+        const SkeletonDef::BoneDataVec &bones = skeletonDef->getBones();
+
+        size_t rootIdx = 0u;
+        while( rootIdx < bones.size() && IdString( bones[rootIdx].name ) != boneName )
+            ++rootIdx;
+
+        if( rootIdx == bones.size() )
+            return;
+
+        for( size_t i = 0u; i < bones.size(); ++i )
+        {
+            size_t boneIdx = i;
+            while( boneIdx != rootIdx && boneIdx != std::numeric_limits<size_t>::max() )
+                boneIdx = bones[boneIdx].parent;
+
+            if( boneIdx == rootIdx )
+                setBoneWeight( bones[i].name, weight );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     Real SkeletonAnimation::getBoneWeight( IdString boneName ) const
     {
         Real retVal = 0.0f;
@@ -307,20 +342,71 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
-    void SkeletonAnimation::_applyAnimation( const TransformArray &boneTransforms )
+    void SkeletonAnimation::setLayer( uint8 layer )
     {
-        SkeletonTrackVec::const_iterator itor = mDefinition->mTracks.begin();
-        SkeletonTrackVec::const_iterator endt = mDefinition->mTracks.end();
-
-        KnownKeyFramesVec::iterator itLastKnownKeyFrame = mLastKnownKeyFrames.begin();
+        if( mLayer != layer )
+        {
+            // Keep the active animations sorted by layer
+            if( mEnabled )
+                mOwner->_disableAnimation( this );
+            mLayer = layer;
+            if( mEnabled )
+                mOwner->_enableAnimation( this );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    struct SkeletonTrackBoneBlockIdxCmp
+    {
+        bool operator()( const SkeletonTrack &track, uint32 boneBlockIdx ) const
+        {
+            return track.getBoneBlockIdx() < boneBlockIdx;
+        }
+    };
+    //-----------------------------------------------------------------------------------
+    void SkeletonAnimation::_applyAnimation( const TransformArray &boneTransforms,
+                                             size_t numDepthLevels, size_t threadIdx,
+                                             size_t numThreads )
+    {
+        size_t firstLevel, lastLevel;
+        mOwner->_getOwnedDepthLevels( threadIdx, numThreads, firstLevel, lastLevel );
+        lastLevel = std::min( lastLevel, numDepthLevels );
+
+        if( firstLevel >= lastLevel )
+            return;
+
+        // Tracks are sorted by depth level (see getBoneBlockIdx), thus this thread's
+        // tracks are contiguous
+        const SkeletonTrackVec &tracks = mDefinition->mTracks;
+        SkeletonTrackVec::const_iterator itor =
+            std::lower_bound( tracks.begin(), tracks.end(), uint32( firstLevel << 24u ),
+                              SkeletonTrackBoneBlockIdxCmp() );
+        SkeletonTrackVec::const_iterator endt =
+            std::lower_bound( itor, tracks.end(), uint32( lastLevel << 24u ),
+                              SkeletonTrackBoneBlockIdxCmp() );
+
+        const ptrdiff_t firstTrack = itor - tracks.begin();
+        KnownKeyFramesVec::iterator itLastKnownKeyFrame = mLastKnownKeyFrames.begin() + firstTrack;
 
         ArrayReal simdWeight = Mathlib::SetAll( mWeight );
-        ArrayReal *RESTRICT_ALIAS boneWeights = mBoneWeights.get();
+        ArrayReal *RESTRICT_ALIAS boneWeights = mBoneWeights.get() + firstTrack;
+        CompressedKfCache *RESTRICT_ALIAS compressedCache =
+            mCompressedCache.get() ? mCompressedCache.get() + firstTrack : 0;
+
+        const SkeletonDef *skeletonDef = mOwner->getDefinition();
+        const SkeletonDef::DepthLevelInfoVec &depthLevelInfo = skeletonDef->getDepthLevelInfo();
+        KfTransform const *RESTRICT_ALIAS bindPose =
+            mBlendMode == SkeletonBlendMode::Override ? skeletonDef->getBindPose() : 0;
 
         while( itor != endt )
         {
-            itor->applyKeyFrameRigAt( *itLastKnownKeyFrame, mCurrentFrame, simdWeight, boneWeights,
-                                      boneTransforms );
+            const size_t depthLevel = itor->getBoneBlockIdx() >> 24u;
+            const size_t offset = itor->getBoneBlockIdx() & 0x00FFFFFFu;
+            itor->applyKeyFrameRigAt(
+                *itLastKnownKeyFrame, mCurrentFrame, simdWeight, boneWeights, boneTransforms,
+                bindPose ? bindPose + depthLevelInfo[depthLevel].firstBoneBlock + offset : 0,
+                compressedCache );
+            if( compressedCache )
+                ++compressedCache;
             ++itLastKnownKeyFrame;
             ++boneWeights;
             ++itor;
@@ -41,13 +41,156 @@ THE SOFTWARE.
 #include "OgreSkeleton.h"
 #include "OgreStringConverter.h"
 
+#include <limits>
+
 namespace Ogre
 {
+    namespace
+    {
+        /// Error introduced by the 15-bit smallest three encoding, in radians
+        const Real c_orientationQuantizationError = 1e-4f;
+
+        struct DecodedKeyFrame
+        {
+            Real       frame;
+            Vector3    position[ARRAY_PACKED_REALS];
+            Quaternion orientation[ARRAY_PACKED_REALS];
+            Vector3    scale[ARRAY_PACKED_REALS];
+        };
+        typedef vector<DecodedKeyFrame>::type DecodedKeyFrameVec;
+
+        struct TrackCompressionInfo
+        {
+            DecodedKeyFrameVec   keyFrames;
+            vector<size_t>::type keptKeyFrames;
+            Vector3              minPosition[ARRAY_PACKED_REALS];
+            Vector3              maxPosition[ARRAY_PACKED_REALS];
+            Vector3              minScale[ARRAY_PACKED_REALS];
+            Vector3              maxScale[ARRAY_PACKED_REALS];
+            uint32               animatedChannels;
+        };
+
+        size_t getNumChannels( uint32 animatedChannels )
+        {
+            return ( ( animatedChannels & SkeletonTrack::ChannelPosition ) ? 1u : 0u ) +
+                   ( ( animatedChannels & SkeletonTrack::ChannelOrientation ) ? 1u : 0u ) +
+                   ( ( animatedChannels & SkeletonTrack::ChannelScale ) ? 1u : 0u );
+        }
+
+        Real maxComponentError( const Vector3 &a, const Vector3 &b )
+        {
+            const Vector3 diff = a - b;
+            return std::max( std::max( Math::Abs( diff.x ), Math::Abs( diff.y ) ),
+                             Math::Abs( diff.z ) );
+        }
+
+        /// Angle between two unit quaternions. Unlike acos( dot ), it's accurate for small angles
+        Real orientationError( const Quaternion &a, const Quaternion &b )
+        {
+            const Quaternion diff = a.Dot( b ) < 0 ? a + b : a - b;
+            const Real halfChord = std::min( Math::Sqrt( diff.Norm() ) * 0.5f, Real( 1.0f ) );
+            return 4.0f * Math::ASin( halfChord ).valueRadians();
+        }
+
+        /// Returns true if every keyframe between first and last can be
+        /// reproduced by interpolating them, within the given tolerances.
+        bool canInterpolate( const DecodedKeyFrameVec &keyFrames, size_t first, size_t last,
+                             Real posTolerance, Real rotTolerance, Real scaleTolerance )
+        {
+            const DecodedKeyFrame &kf0 = keyFrames[first];
+            const DecodedKeyFrame &kf1 = keyFrames[last];
+            const Real invDistance = 1.0f / ( kf1.frame - kf0.frame );
+
+            for( size_t i = first + 1u; i < last; ++i )
+            {
+                const DecodedKeyFrame &keyFrame = keyFrames[i];
+                const Real fTimeW = ( keyFrame.frame - kf0.frame ) * invDistance;
+
+                for( size_t j = 0; j < ARRAY_PACKED_REALS; ++j )
+                {
+                    // Same interpolation SkeletonTrack::applyKeyFrameRigAt does
+                    const Vector3 vPos = Math::lerp( kf0.position[j], kf1.position[j], fTimeW );
+                    const Vector3 vScale = Math::lerp( kf0.scale[j], kf1.scale[j], fTimeW );
+                    const Quaternion qRot =
+                        Quaternion::nlerp( fTimeW, kf0.orientation[j], kf1.orientation[j], true );
+
+                    if( maxComponentError( vPos, keyFrame.position[j] ) > posTolerance ||
+                        maxComponentError( vScale, keyFrame.scale[j] ) > scaleTolerance ||
+                        orientationError( qRot, keyFrame.orientation[j] ) > rotTolerance )
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        void quantizeVector3s( const Vector3 *values, const Vector3 *minValues,
+                               const ArrayVector3 &step, uint16 *outData )
+        {
+            for( size_t j = 0; j < ARRAY_PACKED_REALS; ++j )
+            {
+                Vector3 vStep;
+                step.getAsVector3( vStep, j );
+                for( size_t c = 0; c < 3u; ++c )
+                {
+                    Real quantized = 0;
+                    if( vStep[c] > 0 )
+                        quantized = ( values[j][c] - minValues[j][c] ) / vStep[c] + 0.5f;
+                    outData[c * ARRAY_PACKED_REALS + j] =
+                        static_cast<uint16>( Math::Clamp<Real>( quantized, 0.0f, 65535.0f ) );
+                }
+            }
+        }
+
+        /// See CompressedKfTrack
+        void encodeSmallestThree( const Quaternion *orientations, uint16 *outData )
+        {
+            const Real c_invSqrt2 = 0.707106781f;
+
+            for( size_t j = 0; j < ARRAY_PACKED_REALS; ++j )
+            {
+                const Quaternion &qRot = orientations[j];
+                Real components[4] = { qRot.x, qRot.y, qRot.z, qRot.w };
+
+                uint16 largestIdx = 0;
+                for( uint16 c = 1u; c < 4u; ++c )
+                {
+                    if( Math::Abs( components[c] ) > Math::Abs( components[largestIdx] ) )
+                        largestIdx = c;
+                }
+
+                // q and -q are the same rotation. Make the dropped component positive
+                const Real sign = components[largestIdx] < 0 ? -1.0f : 1.0f;
+
+                size_t dstIdx = 0;
+                for( uint16 c = 0; c < 4u; ++c )
+                {
+                    if( c != largestIdx )
+                    {
+                        const Real quantized =
+                            ( components[c] * sign + c_invSqrt2 ) / ( 2.0f * c_invSqrt2 ) * 32767.0f +
+                            0.5f;
+                        outData[dstIdx * ARRAY_PACKED_REALS + j] =
+                            static_cast<uint16>( Math::Clamp<Real>( quantized, 0.0f, 32767.0f ) );
+                        ++dstIdx;
+                    }
+                }
+
+                outData[j] |= static_cast<uint16>( ( largestIdx & 0x01u ) << 15u );
+                outData[ARRAY_PACKED_REALS + j] |= static_cast<uint16>( ( largestIdx >> 1u ) << 15u );
+            }
+        }
+    }  // namespace
+    //-----------------------------------------------------------------------------------
     SkeletonAnimationDef::SkeletonAnimationDef() :
         mNumFrames( 0 ),
         mOriginalFrameRate( 25.0f ),
         mSkeletonDef( 0 ),
-        mKfTransformMemoryManager( 0 )
+        mKfTransformMemoryManager( 0 ),
+        mCompressedData( 0 ),
+        mCompressedDataBytes( 0 )
     {
     }
     //-----------------------------------------------------------------------------------
@@ -55,6 +198,12 @@ namespace Ogre
     {
         mTracks.clear();
 
+        if( mCompressedData )
+        {
+            OGRE_FREE_SIMD( mCompressedData, MEMCATEGORY_ANIMATION );
+            mCompressedData = 0;
+        }
+
         if( mKfTransformMemoryManager )
         {
             mKfTransformMemoryManager->destroy();
@@ -382,6 +531,240 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void SkeletonAnimationDef::compress( const CompressionSettings &settings )
+    {
+        if( mCompressedData || !mKfTransformMemoryManager )
+            return;
+
+        const size_t numTracks = mTracks.size();
+
+        vector<TrackCompressionInfo>::type trackInfos( numTracks );
+        size_t totalDataElements = 0;
+
+        // 1st pass: Decide which keyframes & channels to keep
+        for( size_t i = 0; i < numTracks; ++i )
+        {
+            const KeyFrameRigVec &keyFrames = mTracks[i].getKeyFrames();
+            TrackCompressionInfo &info = trackInfos[i];
+
+            info.keyFrames.resize( keyFrames.size() );
+            for( size_t k = 0; k < keyFrames.size(); ++k )
+            {
+                DecodedKeyFrame &decoded = info.keyFrames[k];
+                const KfTransform *boneTransform = keyFrames[k].mBoneTransform;
+                decoded.frame = keyFrames[k].mFrame;
+                for( size_t j = 0; j < ARRAY_PACKED_REALS; ++j )
+                {
+                    boneTransform->mPosition.getAsVector3( decoded.position[j], j );
+                    boneTransform->mOrientation.getAsQuaternion( decoded.orientation[j], j );
+                    boneTransform->mScale.getAsVector3( decoded.scale[j], j );
+                    // Keyframes created by build() may not be normalized
+                    decoded.orientation[j].normalise();
+                }
+            }
+
+            Real posRange = 0;
+            Real scaleRange = 0;
+            bool constantOrientation = true;
+            for( size_t j = 0; j < ARRAY_PACKED_REALS; ++j )
+            {
+                info.minPosition[j] = info.maxPosition[j] = info.keyFrames[0].position[j];
+                info.minScale[j] = info.maxScale[j] = info.keyFrames[0].scale[j];
+
+                for( size_t k = 1u; k < info.keyFrames.size(); ++k )
+                {
+                    const DecodedKeyFrame &decoded = info.keyFrames[k];
+                    info.minPosition[j].makeFloor( decoded.position[j] );
+                    info.maxPosition[j].makeCeil( decoded.position[j] );
+                    info.minScale[j].makeFloor( decoded.scale[j] );
+                    info.maxScale[j].makeCeil( decoded.scale[j] );
+                    constantOrientation &=
+                        orientationError( decoded.orientation[j],
+                                          info.keyFrames[0].orientation[j] ) <=
+                        settings.maxOrientationError;
+                }
+
+                posRange = std::max( posRange,
+                                     maxComponentError( info.maxPosition[j], info.minPosition[j] ) );
+                scaleRange =
+                    std::max( scaleRange, maxComponentError( info.maxScale[j], info.minScale[j] ) );
+            }
+
+            // Constant channels aren't affected by removing keyframes. The rest
+            // must leave room for the error introduced by quantization
+            const Real infinity = std::numeric_limits<Real>::max();
+            Real posTolerance = infinity;
+            Real rotTolerance = infinity;
+            Real scaleTolerance = infinity;
+
+            info.animatedChannels = 0u;
+            if( posRange > 2.0f * settings.maxPositionError )
+            {
+                info.animatedChannels |= SkeletonTrack::ChannelPosition;
+                posTolerance =
+                    std::max( settings.maxPositionError - posRange / 65535.0f * 0.5f, Real( 0 ) );
+            }
+            if( !constantOrientation )
+            {
+                info.animatedChannels |= SkeletonTrack::ChannelOrientation;
+                rotTolerance = std::max( settings.maxOrientationError - c_orientationQuantizationError,
+                                         Real( 0 ) );
+            }
+            if( scaleRange > 2.0f * settings.maxScaleError )
+            {
+                info.animatedChannels |= SkeletonTrack::ChannelScale;
+                scaleTolerance =
+                    std::max( settings.maxScaleError - scaleRange / 65535.0f * 0.5f, Real( 0 ) );
+            }
+
+            // Greedily drop every keyframe that can be interpolated from the last one we
+            // kept and the next one. All the keyframes dropped in between are rechecked.
+            const size_t numKeyFrames = info.keyFrames.size();
+            info.keptKeyFrames.push_back( 0u );
+            for( size_t k = 1u; k + 1u < numKeyFrames; ++k )
+            {
+                if( !canInterpolate( info.keyFrames, info.keptKeyFrames.back(), k + 1u,
+                                     posTolerance, rotTolerance, scaleTolerance ) )
+                {
+                    info.keptKeyFrames.push_back( k );
+                }
+            }
+            if( numKeyFrames > 1u )
+                info.keptKeyFrames.push_back( numKeyFrames - 1u );
+
+            const size_t numChannels = getNumChannels( info.animatedChannels );
+            totalDataElements += info.keptKeyFrames.size() * numChannels * 3u * ARRAY_PACKED_REALS;
+        }
+
+        mCompressedDataBytes =
+            numTracks * sizeof( CompressedKfTrack ) + totalDataElements * sizeof( uint16 );
+        mCompressedData = OGRE_MALLOC_SIMD( mCompressedDataBytes, MEMCATEGORY_ANIMATION );
+
+        CompressedKfTrack *headers = reinterpret_cast<CompressedKfTrack *>( mCompressedData );
+        uint16 *keyFrameData = reinterpret_cast<uint16 *>( headers + numTracks );
+
+        // 2nd pass: Quantize and replace the keyframes
+        for( size_t i = 0; i < numTracks; ++i )
+        {
+            const TrackCompressionInfo &info = trackInfos[i];
+            CompressedKfTrack *header = headers + i;
+
+            header->mPosMin = ArrayVector3::ZERO;
+            header->mPosStep = ArrayVector3::ZERO;
+            header->mScaleMin = ArrayVector3::UNIT_SCALE;
+            header->mScaleStep = ArrayVector3::ZERO;
+            header->mConstantOrientation = ArrayQuaternion::IDENTITY;
+
+            for( size_t j = 0; j < ARRAY_PACKED_REALS; ++j )
+            {
+                if( info.animatedChannels & SkeletonTrack::ChannelPosition )
+                {
+                    header->mPosMin.setFromVector3( info.minPosition[j], j );
+                    header->mPosStep.setFromVector3(
+                        ( info.maxPosition[j] - info.minPosition[j] ) / 65535.0f, j );
+                }
+                else
+                {
+                    header->mPosMin.setFromVector3(
+                        ( info.maxPosition[j] + info.minPosition[j] ) * 0.5f, j );
+                }
+
+                if( info.animatedChannels & SkeletonTrack::ChannelScale )
+                {
+                    header->mScaleMin.setFromVector3( info.minScale[j], j );
+                    header->mScaleStep.setFromVector3(
+                        ( info.maxScale[j] - info.minScale[j] ) / 65535.0f, j );
+                }
+                else
+                {
+                    header->mScaleMin.setFromVector3( ( info.maxScale[j] + info.minScale[j] ) * 0.5f,
+                                                      j );
+                }
+
+                header->mConstantOrientation.setFromQuaternion( info.keyFrames[0].orientation[j],
+                                                                j );
+            }
+
+            const size_t numChannels = getNumChannels( info.animatedChannels );
+            header->mKeyFrameData = keyFrameData;
+            header->mKeyFrameStride = static_cast<uint32>( numChannels * 3u * ARRAY_PACKED_REALS );
+            header->mAnimatedChannels = info.animatedChannels;
+
+            KeyFrameRigVec keyFrameRigs;
+            keyFrameRigs.reserve( info.keptKeyFrames.size() );
+
+            vector<size_t>::type::const_iterator itKept = info.keptKeyFrames.begin();
+            vector<size_t>::type::const_iterator enKept = info.keptKeyFrames.end();
+
+            while( itKept != enKept )
+            {
+                const DecodedKeyFrame &decoded = info.keyFrames[*itKept];
+
+                if( info.animatedChannels & SkeletonTrack::ChannelPosition )
+                {
+                    quantizeVector3s( decoded.position, info.minPosition, header->mPosStep,
+                                      keyFrameData );
+                    keyFrameData += 3u * ARRAY_PACKED_REALS;
+                }
+                if( info.animatedChannels & SkeletonTrack::ChannelOrientation )
+                {
+                    encodeSmallestThree( decoded.orientation, keyFrameData );
+                    keyFrameData += 3u * ARRAY_PACKED_REALS;
+                }
+                if( info.animatedChannels & SkeletonTrack::ChannelScale )
+                {
+                    quantizeVector3s( decoded.scale, info.minScale, header->mScaleStep,
+                                      keyFrameData );
+                    keyFrameData += 3u * ARRAY_PACKED_REALS;
+                }
+
+                KeyFrameRig keyFrameRig;
+                keyFrameRig.mFrame = decoded.frame;
+                keyFrameRig.mInvNextFrameDistance = 1.0f;
+                keyFrameRig.mBoneTransform = 0;
+                if( !keyFrameRigs.empty() )
+                {
+                    KeyFrameRig &prevKeyFrame = keyFrameRigs.back();
+                    prevKeyFrame.mInvNextFrameDistance = 1.0f / ( decoded.frame - prevKeyFrame.mFrame );
+                }
+                keyFrameRigs.push_back( keyFrameRig );
+
+                ++itKept;
+            }
+
+            mTracks[i]._getKeyFrames().swap( keyFrameRigs );
+            mTracks[i]._setCompressed( header );
+        }
+
+        mKfTransformMemoryManager->destroy();
+        delete mKfTransformMemoryManager;
+        mKfTransformMemoryManager = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonAnimationDef::getNumKeyFrames() const
+    {
+        size_t numKeyFrames = 0;
+        SkeletonTrackVec::const_iterator itor = mTracks.begin();
+        SkeletonTrackVec::const_iterator endt = mTracks.end();
+        while( itor != endt )
+        {
+            numKeyFrames += itor->getKeyFrames().size();
+            ++itor;
+        }
+        return numKeyFrames;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonAnimationDef::getKeyFrameMemoryUsage() const
+    {
+        const size_t numKeyFrames = getNumKeyFrames();
+        size_t retVal = numKeyFrames * sizeof( KeyFrameRig );
+        if( mCompressedData )
+            retVal += mCompressedDataBytes;
+        else
+            retVal += numKeyFrames * sizeof( KfTransform );
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
     void SkeletonAnimationDef::_dumpCsvTracks( String &outText ) const
     {
         const SkeletonDef::BoneDataVec &mBones = mSkeletonDef->getBones();
@@ -411,22 +794,20 @@ namespace Ogre
                     outText += boneDef.name;
                     outText += ",";
 
-                    KeyFrameRigVec::const_iterator itKeyFrames = keyFrames.begin();
-                    KeyFrameRigVec::const_iterator enKeyFrames = keyFrames.end();
-
-                    while( itKeyFrames != enKeyFrames )
+                    for( size_t k = 0; k < keyFrames.size(); ++k )
                     {
-                        outText += StringConverter::toString( itKeyFrames->mFrame );
+                        outText += StringConverter::toString( keyFrames[k].mFrame );
                         outText += ",";
 
-                        const KfTransform *RESTRICT_ALIAS boneTransform = itKeyFrames->mBoneTransform;
+                        KfTransform boneTransform;
+                        track.getKeyFrameTransform( k, boneTransform );
 
                         Vector3 vPos, vScale;
                         Quaternion qRot;
 
-                        boneTransform->mPosition.getAsVector3( vPos, i );
-                        boneTransform->mOrientation.getAsQuaternion( qRot, i );
-                        boneTransform->mScale.getAsVector3( vScale, i );
+                        boneTransform.mPosition.getAsVector3( vPos, i );
+                        boneTransform.mOrientation.getAsQuaternion( qRot, i );
+                        boneTransform.mScale.getAsVector3( vScale, i );
 
                         outText += StringConverter::toString( vPos.x ) + ",";
                         outText += StringConverter::toString( vPos.y ) + ",";
@@ -438,7 +819,6 @@ namespace Ogre
                         outText += StringConverter::toString( vScale.x ) + ",";
                         outText += StringConverter::toString( vScale.y ) + ",";
                         outText += StringConverter::toString( vScale.z ) + ",";
-                        ++itKeyFrames;
                     }
 
                     outText += "\n";
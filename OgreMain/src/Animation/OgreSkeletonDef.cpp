@@ -35,8 +35,10 @@ THE SOFTWARE.
 #include "Math/Array/OgreBoneMemoryManager.h"
 #include "Math/Array/OgreKfTransformArrayMemoryManager.h"
 #include "OgreId.h"
+#include "OgreLogManager.h"
 #include "OgreOldBone.h"
 #include "OgreSkeleton.h"
+#include "OgreStringConverter.h"
 
 namespace Ogre
 {
@@ -92,6 +94,14 @@ namespace Ogre
             mBonesPerDepth[currentDepthLevel].push_back( i );
         }
 
+        for( size_t i = 1u; i < mDepthLevelInfoVec.size(); ++i )
+        {
+            mDepthLevelInfoVec[i].firstBoneBlock =
+                mDepthLevelInfoVec[i - 1u].firstBoneBlock +
+                ( mDepthLevelInfoVec[i - 1u].numBonesInLevel - 1u + ARRAY_PACKED_REALS ) /
+                    ARRAY_PACKED_REALS;
+        }
+
         // Populate both mBoneToSlot and mSlotToBone
         mBoneToSlot.reserve( originalSkeleton->getNumBones() );
         for( size_t i = 0; i < originalSkeleton->getNumBones(); ++i )
@@ -341,4 +351,47 @@ namespace Ogre
 
         return numBlocks;
     }
+    //-----------------------------------------------------------------------------------
+    void SkeletonDef::compressAnimations( const SkeletonAnimationDef::CompressionSettings &errorBudget )
+    {
+        size_t numKeyFramesBefore = 0;
+        size_t numKeyFramesAfter = 0;
+        const size_t bytesBefore = getAnimationMemoryUsage();
+
+        SkeletonAnimationDefVec::iterator itor = mAnimationDefs.begin();
+        SkeletonAnimationDefVec::iterator endt = mAnimationDefs.end();
+
+        while( itor != endt )
+        {
+            numKeyFramesBefore += itor->getNumKeyFrames();
+            itor->compress( errorBudget );
+            numKeyFramesAfter += itor->getNumKeyFrames();
+            ++itor;
+        }
+
+        const size_t bytesAfter = getAnimationMemoryUsage();
+
+        LogManager::getSingleton().logMessage(
+            "Compressed animations of skeleton " + mName + ": " +
+            StringConverter::toString( numKeyFramesBefore ) + " -> " +
+            StringConverter::toString( numKeyFramesAfter ) + " keyframes, " +
+            StringConverter::toString( bytesBefore ) + " -> " +
+            StringConverter::toString( bytesAfter ) + " bytes" );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonDef::getAnimationMemoryUsage() const
+    {
+        size_t retVal = 0;
+
+        SkeletonAnimationDefVec::const_iterator itor = mAnimationDefs.begin();
+        SkeletonAnimationDefVec::const_iterator endt = mAnimationDefs.end();
+
+        while( itor != endt )
+        {
+            retVal += itor->getKeyFrameMemoryUsage();
+            ++itor;
+        }
+
+        return retVal;
+    }
 }  // namespace Ogre
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "Animation/OgreSkeletonDef.h"
 #include "Animation/OgreSkeletonManager.h"
 #include "OgreId.h"
+#include "OgreMovableObject.h"
 #include "OgreOldBone.h"
 #include "OgreSceneNode.h"
 #include "OgreSkeleton.h"
@@ -47,9 +48,16 @@ namespace Ogre
 {
     SkeletonInstance::SkeletonInstance( const SkeletonDef *skeletonDef,
                                         BoneMemoryManager *boneMemoryManager ) :
+        mNumManualBones( 0u ),
         mDefinition( skeletonDef ),
         mParentNode( 0 ),
-        mRefCount( 1 )
+        mRefCount( 1 ),
+        mNumAnimatedDepthLevels( std::numeric_limits<uint16>::max() ),
+        mAnimationLodPhase( 0 ),
+        mAnimationLodLevels( 0 ),
+        mAnimationLodSource( 0 ),
+        mPoseSource( 0 ),
+        mParallelAnimation( false )
     {
         mBones.resize( mDefinition->getBones().size(), Bone() );
 
@@ -238,31 +246,46 @@ namespace Ogre
         mBones.clear();
     }
     //-----------------------------------------------------------------------------------
-    void SkeletonInstance::update()
+    void SkeletonInstance::update() { _updateBoneBlocks( 0u, 1u ); }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::_updateBoneBlocks( size_t threadIdx, size_t numThreads )
     {
         if( !mActiveAnimations.empty() )
-            resetToPose();
+            resetToPose( mNumAnimatedDepthLevels, threadIdx, numThreads );
 
+        // Sorted by layer, see _enableAnimation
         ActiveAnimationsVec::iterator itor = mActiveAnimations.begin();
         ActiveAnimationsVec::iterator endt = mActiveAnimations.end();
 
         while( itor != endt )
         {
-            ( *itor )->_applyAnimation( mBoneStartTransforms );
+            ( *itor )->_applyAnimation( mBoneStartTransforms, mNumAnimatedDepthLevels, threadIdx,
+                                        numThreads );
             ++itor;
         }
     }
     //-----------------------------------------------------------------------------------
-    void SkeletonInstance::resetToPose()
+    void SkeletonInstance::resetToPose() { resetToPose( mBoneStartTransforms.size() ); }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::resetToPose( size_t numDepthLevels, size_t threadIdx, size_t numThreads )
     {
-        KfTransform const *RESTRICT_ALIAS bindPose = mDefinition->getBindPose();
-        ArrayReal const *RESTRICT_ALIAS manualBones = mManualBones.get();
+        size_t firstLevel, lastLevel;
+        _getOwnedDepthLevels( threadIdx, numThreads, firstLevel, lastLevel );
+        lastLevel = std::min( lastLevel, std::min( numDepthLevels, mBoneStartTransforms.size() ) );
+
+        if( firstLevel >= lastLevel )
+            return;
 
         SkeletonDef::DepthLevelInfoVec::const_iterator itDepthLevelInfo =
-            mDefinition->getDepthLevelInfo().begin();
+            mDefinition->getDepthLevelInfo().begin() + ptrdiff_t( firstLevel );
 
-        TransformArray::iterator itor = mBoneStartTransforms.begin();
-        TransformArray::iterator endt = mBoneStartTransforms.end();
+        KfTransform const *RESTRICT_ALIAS bindPose =
+            mDefinition->getBindPose() + itDepthLevelInfo->firstBoneBlock;
+        ArrayReal const *RESTRICT_ALIAS manualBones =
+            mManualBones.get() + itDepthLevelInfo->firstBoneBlock;
+
+        TransformArray::iterator itor = mBoneStartTransforms.begin() + ptrdiff_t( firstLevel );
+        TransformArray::iterator endt = mBoneStartTransforms.begin() + ptrdiff_t( lastLevel );
 
         while( itor != endt )
         {
@@ -290,6 +313,111 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void SkeletonInstance::_getOwnedDepthLevels( size_t threadIdx, size_t numThreads,
+                                                 size_t &outFirst, size_t &outLast ) const
+    {
+        const SkeletonDef::DepthLevelInfoVec &depthLevelInfo = mDefinition->getDepthLevelInfo();
+        const size_t numLevels = depthLevelInfo.size();
+
+        outFirst = 0u;
+        outLast = numThreads <= 1u ? numLevels : 0u;
+
+        if( numThreads <= 1u )
+            return;
+
+        // A level goes to the thread whose slice of the skeleton's bone blocks contains
+        // the level's midpoint. This keeps every thread's levels contiguous.
+        const size_t totalBlocks = mDefinition->getNumberOfBoneBlocks( numLevels );
+        size_t prefixBlocks = 0u;
+        for( size_t i = 0u; i < numLevels; ++i )
+        {
+            const size_t numBlocks =
+                ( depthLevelInfo[i].numBonesInLevel + ARRAY_PACKED_REALS - 1u ) / ARRAY_PACKED_REALS;
+            const size_t owner = std::min(
+                ( ( prefixBlocks * 2u + numBlocks ) * numThreads ) / ( totalBlocks * 2u ),
+                numThreads - 1u );
+            if( owner < threadIdx )
+                outFirst = i + 1u;
+            if( owner <= threadIdx )
+                outLast = i + 1u;
+            prefixBlocks += numBlocks;
+        }
+
+        outLast = std::max( outFirst, outLast );
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::setPoseSource( const SkeletonInstance *poseSource )
+    {
+        OGRE_ASSERT_LOW( ( !poseSource || ( poseSource != this && !poseSource->mPoseSource &&
+                                            poseSource->mDefinition == mDefinition ) ) &&
+                         "Invalid pose source" );
+        mPoseSource = poseSource;
+    }
+    //-----------------------------------------------------------------------------------
+    bool SkeletonInstance::_getPoseSourcePaletteTransform( Matrix4 &outPaletteToWorld ) const
+    {
+        if( !mPoseSource || mNumManualBones || !mCustomParentSceneNodes.empty() ||
+            !mPoseSource->mCustomParentSceneNodes.empty() || !mParentNode ||
+            !mPoseSource->mParentNode )
+        {
+            return false;
+        }
+
+        // Both palettes are nodeMat * ( derivedTransform * reverseBind ), with the same
+        // derivedTransform. See Bone::updateAllTransforms
+        outPaletteToWorld = mParentNode->_getFullTransform().concatenateAffine(
+            mPoseSource->mParentNode->_getFullTransform().inverseAffine() );
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::_copyPoseFromSource()
+    {
+        // Bone transforms are SoA. Both instances have the same number of bones per depth
+        // level, but they may start at different slots within their first SIMD block
+        Real const *RESTRICT_ALIAS manualBones = reinterpret_cast<const Real *>( mManualBones.get() );
+
+        SkeletonDef::DepthLevelInfoVec::const_iterator itDepthLevelInfo =
+            mDefinition->getDepthLevelInfo().begin();
+
+        TransformArray::const_iterator itSrc = mPoseSource->mBoneStartTransforms.begin();
+        TransformArray::iterator itor = mBoneStartTransforms.begin();
+        TransformArray::iterator endt = mBoneStartTransforms.end();
+
+        while( itor != endt )
+        {
+            const size_t numBonesInLevel = itDepthLevelInfo->numBonesInLevel;
+            for( size_t i = 0u; i < numBonesInLevel; ++i )
+            {
+                const size_t dstSlot = itor->mIndex + i;
+                if( manualBones[dstSlot] == 0.0f )
+                    continue;
+
+                const size_t srcSlot = itSrc->mIndex + i;
+                const size_t srcBlock = srcSlot / ARRAY_PACKED_REALS;
+                const size_t srcIdx = srcSlot % ARRAY_PACKED_REALS;
+                const size_t dstBlock = dstSlot / ARRAY_PACKED_REALS;
+                const size_t dstIdx = dstSlot % ARRAY_PACKED_REALS;
+
+                Vector3 vTmp;
+                Quaternion qTmp;
+                itSrc->mPosition[srcBlock].getAsVector3( vTmp, srcIdx );
+                itor->mPosition[dstBlock].setFromVector3( vTmp, dstIdx );
+                itSrc->mOrientation[srcBlock].getAsQuaternion( qTmp, srcIdx );
+                itor->mOrientation[dstBlock].setFromQuaternion( qTmp, dstIdx );
+                itSrc->mScale[srcBlock].getAsVector3( vTmp, srcIdx );
+                itor->mScale[dstBlock].setFromVector3( vTmp, dstIdx );
+            }
+
+            // See resetToPose, manualBones has one block per SIMD block of bones
+            manualBones += ( ( numBonesInLevel + ARRAY_PACKED_REALS - 1u ) / ARRAY_PACKED_REALS ) *
+                           ARRAY_PACKED_REALS;
+
+            ++itSrc;
+            ++itor;
+            ++itDepthLevelInfo;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void SkeletonInstance::setManualBone( Bone *bone, bool isManual )
     {
         assert( &mBones[bone->mGlobalIndex] == bone && "The bone doesn't belong to this instance!" );
@@ -309,6 +437,13 @@ namespace Ogre
                 "Offset incorrectly calculated. manualBones[diff] will overflow!" );
 
         Real *manualBones = reinterpret_cast<Real *>( mManualBones.get() );
+        if( ( manualBones[diff] == 0.0f ) != isManual )
+        {
+            if( isManual )
+                ++mNumManualBones;
+            else
+                --mNumManualBones;
+        }
         manualBones[diff] = isManual ? 0.0f : 1.0f;
     }
     //-----------------------------------------------------------------------------------
@@ -448,7 +583,12 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void SkeletonInstance::_enableAnimation( SkeletonAnimation *animation )
     {
-        mActiveAnimations.push_back( animation );
+        // Keep them sorted by layer. Within a layer, the last enabled goes last
+        ActiveAnimationsVec::iterator itor = mActiveAnimations.begin();
+        ActiveAnimationsVec::iterator endt = mActiveAnimations.end();
+        while( itor != endt && ( *itor )->getLayer() <= animation->getLayer() )
+            ++itor;
+        mActiveAnimations.insert( itor, animation );
     }
     //-----------------------------------------------------------------------------------
     void SkeletonInstance::_disableAnimation( SkeletonAnimation *animation )
@@ -456,7 +596,7 @@ namespace Ogre
         ActiveAnimationsVec::iterator it =
             std::find( mActiveAnimations.begin(), mActiveAnimations.end(), animation );
         if( it != mActiveAnimations.end() )
-            efficientVectorRemove( mActiveAnimations, it );
+            mActiveAnimations.erase( it );  // Preserve the order, see _enableAnimation
     }
     //-----------------------------------------------------------------------------------
     void SkeletonInstance::setParentNode( Node *parentNode )
@@ -578,6 +718,43 @@ namespace Ogre
     void SkeletonInstance::_decrementRefCount() { mRefCount--; }
     //-----------------------------------------------------------------------------------
     uint16 SkeletonInstance::_getRefCount() const { return mRefCount; }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::setAnimationLodLevels( const AnimationLodLevelVec *lodLevels )
+    {
+        mAnimationLodLevels = lodLevels;
+        mNumAnimatedDepthLevels = std::numeric_limits<uint16>::max();
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::setAnimationLodSource( const MovableObject *lodSource )
+    {
+        mAnimationLodSource = lodSource;
+        mNumAnimatedDepthLevels = std::numeric_limits<uint16>::max();
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::setAnimationLodPhase( uint32 phase ) { mAnimationLodPhase = phase; }
+    //-----------------------------------------------------------------------------------
+    bool SkeletonInstance::_updateAnimationLod( uint32 frameCount )
+    {
+        mNumAnimatedDepthLevels = std::numeric_limits<uint16>::max();
+
+        if( !mAnimationLodLevels || !mAnimationLodSource )
+            return true;
+
+        const Real lodValue = mAnimationLodSource->getLodValue();
+
+        const AnimationLodLevel *lodLevel = 0;
+        AnimationLodLevelVec::const_iterator itor = mAnimationLodLevels->begin();
+        AnimationLodLevelVec::const_iterator endt = mAnimationLodLevels->end();
+        while( itor != endt && itor->lodValue <= lodValue )
+            lodLevel = itor++;
+
+        if( !lodLevel )
+            return true;
+
+        assert( lodLevel->updateInterval >= 1u );
+        mNumAnimatedDepthLevels = lodLevel->numAnimatedDepthLevels;
+        return ( frameCount + mAnimationLodPhase ) % lodLevel->updateInterval == 0u;
+    }
 }  // namespace Ogre
 
 #if defined( __GNUC__ ) && !defined( __clang__ )
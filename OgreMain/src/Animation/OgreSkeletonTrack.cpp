@@ -37,13 +37,63 @@ THE SOFTWARE.
 
 namespace Ogre
 {
+    /// Converts 3 * ARRAY_PACKED_REALS quantized values (SoA) to floats
+    static inline void loadQuantized( const uint16 *RESTRICT_ALIAS src, uint16 mask,
+                                      ArrayVector3 &outValue )
+    {
+        outValue.mChunkBase[0] = Mathlib::LoadU16ToF32( src, mask );
+        outValue.mChunkBase[1] = Mathlib::LoadU16ToF32( src + ARRAY_PACKED_REALS, mask );
+        outValue.mChunkBase[2] = Mathlib::LoadU16ToF32( src + ARRAY_PACKED_REALS * 2u, mask );
+    }
+    //-----------------------------------------------------------------------------------
+    /// See CompressedKfTrack
+    static inline void decodeSmallestThree( const uint16 *RESTRICT_ALIAS src,
+                                            ArrayQuaternion &outOrientation )
+    {
+        const Real c_invSqrt2 = 0.707106781f;
+
+        ArrayVector3 abc;
+        loadQuantized( src, 0x7FFF, abc );
+        abc = abc * Mathlib::SetAll( 2.0f * c_invSqrt2 / 32767.0f ) +
+              ArrayVector3( Mathlib::SetAll( -c_invSqrt2 ), Mathlib::SetAll( -c_invSqrt2 ),
+                            Mathlib::SetAll( -c_invSqrt2 ) );
+
+        // The highest bit of a & b hold the index: largestIdx = bitA + bitB * 2
+        const ArrayReal largestIdx =
+            Mathlib::LoadU16ToF32( src, 0x8000 ) * Mathlib::SetAll( 1.0f / 32768.0f ) +
+            Mathlib::LoadU16ToF32( src + ARRAY_PACKED_REALS, 0x8000 ) *
+                Mathlib::SetAll( 2.0f / 32768.0f );
+
+        // Rebuild the largest component from the unit length. It's always >= 0.5,
+        // the clamp just protects against quantization errors
+        ArrayReal largest =
+            Mathlib::Max( Mathlib::ONE - abc.dotProduct( abc ), Mathlib::SetAll( 1e-6f ) );
+        largest = largest * Mathlib::InvSqrtNonZero4( largest );
+
+        const ArrayMaskR isX = Mathlib::CompareLess( largestIdx, Mathlib::SetAll( 0.5f ) );
+        const ArrayMaskR isXY = Mathlib::CompareLess( largestIdx, Mathlib::SetAll( 1.5f ) );
+        const ArrayMaskR isXYZ = Mathlib::CompareLess( largestIdx, Mathlib::SetAll( 2.5f ) );
+
+        const ArrayReal a = abc.mChunkBase[0];
+        const ArrayReal b = abc.mChunkBase[1];
+        const ArrayReal c = abc.mChunkBase[2];
+
+        // a, b & c are the components other than the largest, in x y z w order
+        const ArrayReal w = Mathlib::Cmov4( c, largest, isXYZ );
+        const ArrayReal x = Mathlib::Cmov4( largest, a, isX );
+        const ArrayReal y = Mathlib::Cmov4( a, Mathlib::Cmov4( largest, b, isXY ), isX );
+        const ArrayReal z = Mathlib::Cmov4( b, Mathlib::Cmov4( largest, c, isXYZ ), isXY );
+        outOrientation = ArrayQuaternion( w, x, y, z );
+    }
+    //-----------------------------------------------------------------------------------
     SkeletonTrack::SkeletonTrack( uint32 boneBlockIdx,
                                   KfTransformArrayMemoryManager *kfTransformMemoryManager ) :
         mKeyFrameRigs( 0 ),
         mNumFrames( 0 ),
         mBoneBlockIdx( boneBlockIdx ),
         mUsedSlots( 0 ),
-        mLocalMemoryManager( kfTransformMemoryManager )
+        mLocalMemoryManager( kfTransformMemoryManager ),
+        mCompressed( 0 )
     {
     }
     //-----------------------------------------------------------------------------------
@@ -90,6 +140,54 @@ namespace Ogre
         mUsedSlots = std::max( slot + 1, mUsedSlots );
     }
     //-----------------------------------------------------------------------------------
+    void SkeletonTrack::_setCompressed( const CompressedKfTrack *compressed )
+    {
+        mCompressed = compressed;
+        mLocalMemoryManager = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonTrack::decompressKeyFrame( size_t keyFrameIdx, KfTransform &outTransform ) const
+    {
+        const CompressedKfTrack *RESTRICT_ALIAS compressed = mCompressed;
+        const uint16 *RESTRICT_ALIAS src =
+            compressed->mKeyFrameData + keyFrameIdx * compressed->mKeyFrameStride;
+
+        outTransform.mPosition = compressed->mPosMin;
+        if( compressed->mAnimatedChannels & ChannelPosition )
+        {
+            ArrayVector3 quantized;
+            loadQuantized( src, 0xFFFF, quantized );
+            outTransform.mPosition += quantized * compressed->mPosStep;
+            src += ARRAY_PACKED_REALS * 3u;
+        }
+
+        if( compressed->mAnimatedChannels & ChannelOrientation )
+        {
+            decodeSmallestThree( src, outTransform.mOrientation );
+            src += ARRAY_PACKED_REALS * 3u;
+        }
+        else
+        {
+            outTransform.mOrientation = compressed->mConstantOrientation;
+        }
+
+        outTransform.mScale = compressed->mScaleMin;
+        if( compressed->mAnimatedChannels & ChannelScale )
+        {
+            ArrayVector3 quantized;
+            loadQuantized( src, 0xFFFF, quantized );
+            outTransform.mScale += quantized * compressed->mScaleStep;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonTrack::getKeyFrameTransform( size_t keyFrameIdx, KfTransform &outTransform ) const
+    {
+        if( mCompressed )
+            decompressKeyFrame( keyFrameIdx, outTransform );
+        else
+            outTransform = *mKeyFrameRigs[keyFrameIdx].mBoneTransform;
+    }
+    //-----------------------------------------------------------------------------------
     inline void SkeletonTrack::getKeyFrameRigAt( KeyFrameRigVec::const_iterator &inOutPrevFrame,
                                                  KeyFrameRigVec::const_iterator &outNextFrame,
                                                  Real frame ) const
@@ -112,10 +210,11 @@ namespace Ogre
         outNextFrame = nextFrame;
     }
     //-----------------------------------------------------------------------------------
-    void SkeletonTrack::applyKeyFrameRigAt( KeyFrameRigVec::const_iterator &inOutLastKnownKeyFrameRig,
-                                            float frame, ArrayReal animWeight,
-                                            const ArrayReal *RESTRICT_ALIAS perBoneWeights,
-                                            const TransformArray &boneTransforms ) const
+    void SkeletonTrack::applyKeyFrameRigAt(
+        KeyFrameRigVec::const_iterator &inOutLastKnownKeyFrameRig, float frame, ArrayReal animWeight,
+        const ArrayReal *RESTRICT_ALIAS perBoneWeights, const TransformArray &boneTransforms,
+        const KfTransform *RESTRICT_ALIAS bindPose,
+        CompressedKfCache *RESTRICT_ALIAS inOutCompressedCache ) const
     {
         KeyFrameRigVec::const_iterator prevFrame = inOutLastKnownKeyFrameRig;
         KeyFrameRigVec::const_iterator nextFrame;
@@ -131,8 +230,44 @@ namespace Ogre
         ArrayVector3 *RESTRICT_ALIAS finalScale = boneTransforms[level].mScale + offset;
         ArrayQuaternion *RESTRICT_ALIAS finalRot = boneTransforms[level].mOrientation + offset;
 
-        KfTransform *RESTRICT_ALIAS prevTransf = prevFrame->mBoneTransform;
-        KfTransform *RESTRICT_ALIAS nextTransf = nextFrame->mBoneTransform;
+        const KfTransform *RESTRICT_ALIAS prevTransf = prevFrame->mBoneTransform;
+        const KfTransform *RESTRICT_ALIAS nextTransf = nextFrame->mBoneTransform;
+
+        CompressedKfCache localCache;
+        if( mCompressed )
+        {
+            CompressedKfCache *RESTRICT_ALIAS cache = inOutCompressedCache;
+            if( !cache )
+            {
+                localCache.mKeyFrameIdx[0] = localCache.mKeyFrameIdx[1] = ~0u;
+                cache = &localCache;
+            }
+
+            const uint32 keyFrameIdx[2] = {
+                static_cast<uint32>( prevFrame - mKeyFrameRigs.begin() ),
+                static_cast<uint32>( nextFrame - mKeyFrameRigs.begin() )
+            };
+
+            if( cache->mKeyFrameIdx[0] != keyFrameIdx[0] || cache->mKeyFrameIdx[1] != keyFrameIdx[1] )
+            {
+                // Playing forward, the old next keyframe is usually the new previous one
+                if( cache->mKeyFrameIdx[1] == keyFrameIdx[0] )
+                    cache->mKeyFrames[0] = cache->mKeyFrames[1];
+                else
+                    decompressKeyFrame( keyFrameIdx[0], cache->mKeyFrames[0] );
+
+                if( keyFrameIdx[1] == keyFrameIdx[0] )
+                    cache->mKeyFrames[1] = cache->mKeyFrames[0];
+                else
+                    decompressKeyFrame( keyFrameIdx[1], cache->mKeyFrames[1] );
+
+                cache->mKeyFrameIdx[0] = keyFrameIdx[0];
+                cache->mKeyFrameIdx[1] = keyFrameIdx[1];
+            }
+
+            prevTransf = &cache->mKeyFrames[0];
+            nextTransf = &cache->mKeyFrames[1];
+        }
 
         ArrayVector3 interpPos, interpScale;
         ArrayQuaternion interpRot;
@@ -147,11 +282,23 @@ namespace Ogre
         // unanimated bones) with user's custom weights
         ArrayReal fW = ( *perBoneWeights ) * animWeight;
 
-        // When mixing, also interpolate rotation not using shortest path; as this is usually desired
-        *finalPos += interpPos * fW;
-        *finalScale *= Math::lerp( ArrayVector3::UNIT_SCALE, interpScale, fW );
-        *finalRot =
-            ( *finalRot ) * ArrayQuaternion::nlerpShortest( fW, ArrayQuaternion::IDENTITY, interpRot );
+        if( !bindPose )
+        {
+            // When mixing, also interpolate rotation not using shortest path; as this is usually desired
+            *finalPos += interpPos * fW;
+            *finalScale *= Math::lerp( ArrayVector3::UNIT_SCALE, interpScale, fW );
+            *finalRot = ( *finalRot ) *
+                        ArrayQuaternion::nlerpShortest( fW, ArrayQuaternion::IDENTITY, interpRot );
+        }
+        else
+        {
+            // Keyframes are relative to the binding pose. Blend from whatever the lower
+            // layers produced towards the absolute pose of this keyframe
+            *finalPos = Math::lerp( *finalPos, bindPose->mPosition + interpPos, fW );
+            *finalScale = Math::lerp( *finalScale, bindPose->mScale * interpScale, fW );
+            *finalRot = ArrayQuaternion::nlerpShortest( fW, *finalRot,
+                                                        bindPose->mOrientation * interpRot );
+        }
 
         inOutLastKnownKeyFrameRig = prevFrame;
     }
@@ -159,6 +306,7 @@ namespace Ogre
     void SkeletonTrack::_bakeUnusedSlots()
     {
         assert( mUsedSlots <= ARRAY_PACKED_REALS );
+        assert( !mCompressed );
 
         if( mUsedSlots <= ( ARRAY_PACKED_REALS >> 1 ) )
         {
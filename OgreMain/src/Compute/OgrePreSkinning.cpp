@@ -0,0 +1,511 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-present Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Compute/OgrePreSkinning.h"
+
+#include "Animation/OgreSkeletonInstance.h"
+#include "OgreHlmsCompute.h"
+#include "OgreHlmsComputeJob.h"
+#include "OgreItem.h"
+#include "OgreMeshManager2.h"
+#include "OgreProfiler.h"
+#include "OgreRenderSystem.h"
+#include "OgreSubItem.h"
+#include "OgreSubMesh2.h"
+#include "Vao/OgreReadOnlyBufferPacked.h"
+#include "Vao/OgreUavBufferPacked.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+namespace Ogre
+{
+    static const uint32 c_noAttribute = 0xFFFFFFFF;
+    //-------------------------------------------------------------------------
+    PreSkinning::PreSkinning( VaoManager *vaoManager, HlmsCompute *hlmsCompute ) :
+        mHlmsCompute( hlmsCompute ),
+        mVaoManager( vaoManager ),
+        mJob( 0 )
+    {
+    }
+    //-------------------------------------------------------------------------
+    PreSkinning::~PreSkinning() { removeAllItems(); }
+    //-------------------------------------------------------------------------
+    bool PreSkinning::fillVertexLayout( const VertexArrayObject *vao,
+                                        SkinnedVertexBuffer &skinnedBuffer )
+    {
+        const VertexElementSemantic semantics[5] = { VES_POSITION, VES_NORMAL, VES_TANGENT,
+                                                     VES_BLEND_INDICES, VES_BLEND_WEIGHTS };
+        uint32 offsets[5];
+        VertexElementType types[5];
+
+        size_t bufferIdx = std::numeric_limits<size_t>::max();
+
+        for( size_t i = 0u; i < 5u; ++i )
+        {
+            size_t index, offset;
+            const VertexElement2 *element = vao->findBySemantic( semantics[i], index, offset );
+            if( !element )
+            {
+                // Normals & tangents are optional
+                if( semantics[i] != VES_NORMAL && semantics[i] != VES_TANGENT )
+                    return false;
+                offsets[i] = c_noAttribute;
+                types[i] = VET_FLOAT3;
+                continue;
+            }
+
+            if( bufferIdx == std::numeric_limits<size_t>::max() )
+                bufferIdx = index;
+
+            if( index != bufferIdx || ( offset & 0x03u ) )
+                return false;
+
+            offsets[i] = static_cast<uint32>( offset >> 2u );
+            types[i] = element->mType;
+        }
+
+        for( size_t i = 0u; i < 3u; ++i )
+        {
+            if( types[i] != VET_FLOAT3 && types[i] != VET_FLOAT4 )
+                return false;
+        }
+
+        if( types[3] != VET_UBYTE4 )
+            return false;
+
+        uint32 numWeights = 0u;
+        uint32 weightsAreUnorm8 = 0u;
+        switch( types[4] )
+        {
+        case VET_FLOAT1:
+            numWeights = 1u;
+            break;
+        case VET_FLOAT2:
+            numWeights = 2u;
+            break;
+        case VET_FLOAT3:
+            numWeights = 3u;
+            break;
+        case VET_FLOAT4:
+            numWeights = 4u;
+            break;
+        case VET_UBYTE4_NORM:
+            numWeights = 4u;
+            weightsAreUnorm8 = 1u;
+            break;
+        default:
+            return false;
+        }
+
+        VertexBufferPacked *vertexBuffer = vao->getVertexBuffers()[bufferIdx];
+        if( vertexBuffer->getBytesPerElement() & 0x03u )
+            return false;
+
+        skinnedBuffer.srcVertexBuffer = vertexBuffer;
+        skinnedBuffer.vertexLayout[0] = static_cast<uint32>( vertexBuffer->getNumElements() );
+        skinnedBuffer.vertexLayout[1] = vertexBuffer->getBytesPerElement() >> 2u;
+        skinnedBuffer.vertexLayout[2] = numWeights | ( weightsAreUnorm8 << 8u );
+        skinnedBuffer.vertexLayout[3] = offsets[4];
+        skinnedBuffer.vertexLayout[4] = offsets[0];
+        skinnedBuffer.vertexLayout[5] = offsets[1];
+        skinnedBuffer.vertexLayout[6] = offsets[2];
+        skinnedBuffer.vertexLayout[7] = offsets[3];
+
+        return true;
+    }
+    //-------------------------------------------------------------------------
+    UavBufferPacked *PreSkinning::acquireSrcBuffer( VertexBufferPacked *srcVertexBuffer )
+    {
+        SharedSrcBufferMap::iterator itor = mSharedSrcBuffers.find( srcVertexBuffer );
+        if( itor == mSharedSrcBuffers.end() )
+        {
+            SharedSrcBuffer sharedBuffer;
+            sharedBuffer.uavBuffer = mVaoManager->createUavBuffer(
+                srcVertexBuffer->getTotalSizeBytes() >> 2u, sizeof( uint32 ), 0u, 0, false );
+            sharedBuffer.refCount = 0u;
+            srcVertexBuffer->copyTo( sharedBuffer.uavBuffer );
+            itor = mSharedSrcBuffers.insert( std::make_pair( srcVertexBuffer, sharedBuffer ) ).first;
+        }
+
+        ++itor->second.refCount;
+        return itor->second.uavBuffer;
+    }
+    //-------------------------------------------------------------------------
+    void PreSkinning::releaseSrcBuffer( VertexBufferPacked *srcVertexBuffer )
+    {
+        SharedSrcBufferMap::iterator itor = mSharedSrcBuffers.find( srcVertexBuffer );
+        OGRE_ASSERT_LOW( itor != mSharedSrcBuffers.end() );
+
+        --itor->second.refCount;
+        if( itor->second.refCount == 0u )
+        {
+            mVaoManager->destroyUavBuffer( itor->second.uavBuffer );
+            mSharedSrcBuffers.erase( itor );
+        }
+    }
+    //-------------------------------------------------------------------------
+    bool PreSkinning::addItem( Item *item )
+    {
+        if( !item->getSkeletonInstance() )
+            return false;
+
+        PreSkinnedItem preSkinnedItem;
+        preSkinnedItem.item = item;
+
+        const MeshManager *meshManager = MeshManager::getSingletonPtr();
+
+        const size_t numSubItems = item->getNumSubItems();
+        for( size_t i = 0u; i < numSubItems; ++i )
+        {
+            SubItem *subItem = item->getSubItem( i );
+            const VertexArrayObjectArray &srcVaos = subItem->getSubMesh()->mVao[VpNormal];
+
+            if( !subItem->hasSkeletonAnimation() || subItem->isPreSkinned() ||
+                subItem->getNumPoses() > 0u || srcVaos.empty() )
+            {
+                continue;
+            }
+
+            // All LODs must be supported. LODs often share the same vertex buffer.
+            const size_t firstBuffer = preSkinnedItem.buffers.size();
+            bool bSupported = true;
+
+            VertexArrayObjectArray::const_iterator itVao = srcVaos.begin();
+            VertexArrayObjectArray::const_iterator enVao = srcVaos.end();
+
+            while( itVao != enVao && bSupported )
+            {
+                // Vaos in shared buffers only own a range of their vertex buffer, but we skin
+                // and copy whole buffers.
+                SkinnedVertexBuffer skinnedBuffer;
+                bSupported = ( !meshManager || !meshManager->_isSharedVao( *itVao ) ) &&
+                             fillVertexLayout( *itVao, skinnedBuffer );
+
+                bool bAlreadyAdded = false;
+                for( size_t j = firstBuffer; j < preSkinnedItem.buffers.size(); ++j )
+                {
+                    if( preSkinnedItem.buffers[j].srcVertexBuffer == skinnedBuffer.srcVertexBuffer )
+                        bAlreadyAdded = true;
+                }
+
+                if( bSupported && !bAlreadyAdded )
+                {
+                    skinnedBuffer.blendIndexToBoneIndexMap = subItem->getBlendIndexToBoneIndexMap();
+                    preSkinnedItem.buffers.push_back( skinnedBuffer );
+                }
+                ++itVao;
+            }
+
+            if( !bSupported )
+            {
+                preSkinnedItem.buffers.resize( firstBuffer );
+                continue;
+            }
+
+            for( size_t j = firstBuffer; j < preSkinnedItem.buffers.size(); ++j )
+            {
+                SkinnedVertexBuffer &skinnedBuffer = preSkinnedItem.buffers[j];
+                VertexBufferPacked *srcVertexBuffer = skinnedBuffer.srcVertexBuffer;
+
+                skinnedBuffer.srcUavBuffer = acquireSrcBuffer( srcVertexBuffer );
+                skinnedBuffer.dstUavBuffer = mVaoManager->createUavBuffer(
+                    srcVertexBuffer->getTotalSizeBytes() >> 2u, sizeof( uint32 ), 0u, 0, false );
+                skinnedBuffer.dstVertexBuffer = mVaoManager->createVertexBuffer(
+                    srcVertexBuffer->getVertexElements(), srcVertexBuffer->getNumElements(),
+                    BT_DEFAULT, 0, false );
+
+                // Show the bind pose until the first update
+                srcVertexBuffer->copyTo( skinnedBuffer.dstVertexBuffer );
+            }
+
+            VertexArrayObjectArray vaos;
+            vaos.reserve( srcVaos.size() );
+
+            for( itVao = srcVaos.begin(); itVao != enVao; ++itVao )
+            {
+                const VertexArrayObject *srcVao = *itVao;
+
+                VertexBufferPackedVec vertexBuffers = srcVao->getVertexBuffers();
+                VertexBufferPackedVec::iterator itBuffer = vertexBuffers.begin();
+                VertexBufferPackedVec::iterator enBuffer = vertexBuffers.end();
+
+                while( itBuffer != enBuffer )
+                {
+                    for( size_t j = firstBuffer; j < preSkinnedItem.buffers.size(); ++j )
+                    {
+                        if( preSkinnedItem.buffers[j].srcVertexBuffer == *itBuffer )
+                            *itBuffer = preSkinnedItem.buffers[j].dstVertexBuffer;
+                    }
+                    ++itBuffer;
+                }
+
+                VertexArrayObject *vao = mVaoManager->createVertexArrayObject(
+                    vertexBuffers, srcVao->getIndexBuffer(), srcVao->getOperationType() );
+                vao->setPrimitiveRange( srcVao->getPrimitiveStart(), srcVao->getPrimitiveCount() );
+                vaos.push_back( vao );
+                preSkinnedItem.vaos.push_back( vao );
+            }
+
+            subItem->_setPreSkinnedVaos( vaos );
+            preSkinnedItem.subItems.push_back( subItem );
+        }
+
+        if( preSkinnedItem.subItems.empty() )
+            return false;
+
+        mItems.push_back( preSkinnedItem );
+        return true;
+    }
+    //-------------------------------------------------------------------------
+    void PreSkinning::destroy( PreSkinnedItem &preSkinnedItem )
+    {
+        FastArray<SubItem *>::const_iterator itSubItem = preSkinnedItem.subItems.begin();
+        FastArray<SubItem *>::const_iterator enSubItem = preSkinnedItem.subItems.end();
+
+        while( itSubItem != enSubItem )
+        {
+            ( *itSubItem )->_setPreSkinnedVaos( VertexArrayObjectArray() );
+            ++itSubItem;
+        }
+
+        VertexArrayObjectArray::const_iterator itVao = preSkinnedItem.vaos.begin();
+        VertexArrayObjectArray::const_iterator enVao = preSkinnedItem.vaos.end();
+
+        while( itVao != enVao )
+        {
+            mVaoManager->destroyVertexArrayObject( *itVao );
+            ++itVao;
+        }
+
+        SkinnedVertexBufferVec::const_iterator itBuffer = preSkinnedItem.buffers.begin();
+        SkinnedVertexBufferVec::const_iterator enBuffer = preSkinnedItem.buffers.end();
+
+        while( itBuffer != enBuffer )
+        {
+            mVaoManager->destroyVertexBuffer( itBuffer->dstVertexBuffer );
+            mVaoManager->destroyUavBuffer( itBuffer->dstUavBuffer );
+            releaseSrcBuffer( itBuffer->srcVertexBuffer );
+            ++itBuffer;
+        }
+
+        preSkinnedItem.subItems.clear();
+        preSkinnedItem.vaos.clear();
+        preSkinnedItem.buffers.clear();
+    }
+    //-------------------------------------------------------------------------
+    void PreSkinning::removeItem( Item *item )
+    {
+        PreSkinnedItemVec::iterator itor = mItems.begin();
+        PreSkinnedItemVec::iterator endt = mItems.end();
+
+        while( itor != endt && itor->item != item )
+            ++itor;
+
+        if( itor == endt )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "Item '" + item->getName() + "' is not being pre-skinned",
+                         "PreSkinning::removeItem" );
+        }
+
+        destroy( *itor );
+        efficientVectorRemove( mItems, itor );
+    }
+    //-------------------------------------------------------------------------
+    void PreSkinning::removeAllItems()
+    {
+        PreSkinnedItemVec::iterator itor = mItems.begin();
+        PreSkinnedItemVec::iterator endt = mItems.end();
+
+        while( itor != endt )
+        {
+            destroy( *itor );
+            ++itor;
+        }
+
+        mItems.clear();
+    }
+    //-------------------------------------------------------------------------
+    void PreSkinning::uploadBoneMatrices( PreSkinnedItem &preSkinnedItem )
+    {
+        const Item *item = preSkinnedItem.item;
+        const SkeletonInstance *skeleton = item->getSkeletonInstance();
+
+        // Bone transforms are in world space. We want the vertices in object space
+        // so they can be rendered like any other static geometry.
+        const Matrix4 invParentTransform = item->_getParentNodeFullTransform().inverseAffine();
+
+        DynamicUploadRing *uploadRing = mVaoManager->getDynamicUploadRing( BP_TYPE_READONLY );
+
+        SkinnedVertexBufferVec::iterator itor = preSkinnedItem.buffers.begin();
+        SkinnedVertexBufferVec::iterator endt = preSkinnedItem.buffers.end();
+
+        while( itor != endt )
+        {
+            const RenderableAnimated::IndexMap *indexMap = itor->blendIndexToBoneIndexMap;
+
+            itor->boneMatrices =
+                uploadRing->allocate( indexMap->size() * 12u * sizeof( float ), 4u * sizeof( float ) );
+
+            float *RESTRICT_ALIAS dstMatrices = reinterpret_cast<float *>( itor->boneMatrices.data );
+
+            RenderableAnimated::IndexMap::const_iterator itBone = indexMap->begin();
+            RenderableAnimated::IndexMap::const_iterator enBone = indexMap->end();
+
+            while( itBone != enBone )
+            {
+                OGRE_ALIGNED_DECL( Matrix4, boneTransform, OGRE_SIMD_ALIGNMENT );
+                skeleton->_getBoneFullTransform( *itBone ).store( &boneTransform );
+                boneTransform = invParentTransform.concatenateAffine( boneTransform );
+
+                for( size_t y = 0u; y < 3u; ++y )
+                {
+                    for( size_t x = 0u; x < 4u; ++x )
+                        *dstMatrices++ = static_cast<float>( boneTransform[y][x] );
+                }
+
+                ++itBone;
+            }
+
+            ++itor;
+        }
+    }
+    //-------------------------------------------------------------------------
+    void PreSkinning::dispatch( const SkinnedVertexBuffer &skinnedBuffer )
+    {
+        DescriptorSetUav::BufferSlot bufferSlot( DescriptorSetUav::BufferSlot::makeEmpty() );
+        bufferSlot.buffer = skinnedBuffer.srcUavBuffer;
+        bufferSlot.access = ResourceAccess::Read;
+        mJob->_setUavBuffer( 0, bufferSlot );
+        bufferSlot.buffer = skinnedBuffer.dstUavBuffer;
+        bufferSlot.access = ResourceAccess::Write;
+        mJob->_setUavBuffer( 1, bufferSlot );
+
+        OGRE_ASSERT_HIGH( dynamic_cast<ReadOnlyBufferPacked *>( skinnedBuffer.boneMatrices.buffer ) );
+        DescriptorSetTexture2::BufferSlot texBufSlot( DescriptorSetTexture2::BufferSlot::makeEmpty() );
+        texBufSlot.buffer = static_cast<ReadOnlyBufferPacked *>( skinnedBuffer.boneMatrices.buffer );
+        texBufSlot.offset = skinnedBuffer.boneMatrices.offset;
+        texBufSlot.sizeBytes = skinnedBuffer.blendIndexToBoneIndexMap->size() * 12u * sizeof( float );
+        mJob->setTexBuffer( 0, texBufSlot );
+
+        ShaderParams::Param paramLayout0;
+        paramLayout0.name = "vertexLayout0";
+        paramLayout0.setManualValue( &skinnedBuffer.vertexLayout[0], 4u );
+        ShaderParams::Param paramLayout1;
+        paramLayout1.name = "vertexLayout1";
+        paramLayout1.setManualValue( &skinnedBuffer.vertexLayout[4], 4u );
+
+        ShaderParams &shaderParams = mJob->getShaderParams( "default" );
+        shaderParams.mParams.clear();
+        shaderParams.mParams.push_back( paramLayout0 );
+        shaderParams.mParams.push_back( paramLayout1 );
+        shaderParams.setDirty();
+
+        const uint32 numVertices = skinnedBuffer.vertexLayout[0];
+        const uint32 threadsPerGroupX = mJob->getThreadsPerGroupX();
+        mJob->setNumThreadGroups( ( numVertices + threadsPerGroupX - 1u ) / threadsPerGroupX, 1u, 1u );
+
+        mJob->analyzeBarriers( mResourceTransitions );
+        mHlmsCompute->getRenderSystem()->executeResourceTransition( mResourceTransitions );
+        mHlmsCompute->dispatch( mJob, 0, 0 );
+    }
+    //-------------------------------------------------------------------------
+    void PreSkinning::update()
+    {
+        mItemsToSkin.clear();
+
+        PreSkinnedItemVec::iterator itor = mItems.begin();
+        PreSkinnedItemVec::iterator endt = mItems.end();
+
+        while( itor != endt )
+        {
+            if( itor->item->getVisible() && itor->item->isAttached() )
+                mItemsToSkin.push_back( &( *itor ) );
+            ++itor;
+        }
+
+        if( mItemsToSkin.empty() )
+            return;
+
+        if( !mJob )
+        {
+            mJob = mHlmsCompute->findComputeJobNoThrow( "Compute/Algorithms/PreSkinning" );
+
+            if( !mJob )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "To use PreSkinning, Ogre must be built with JSON support "
+                             "and you must include the resources bundled at "
+                             "Samples/Media/Compute/Algorithms/PreSkinning",
+                             "PreSkinning::update" );
+            }
+        }
+
+        OgreProfileGpuBegin( "PreSkinning" );
+
+        RenderSystem *renderSystem = mHlmsCompute->getRenderSystem();
+        renderSystem->endRenderPassDescriptor();
+
+        FastArray<PreSkinnedItem *>::const_iterator itItem = mItemsToSkin.begin();
+        FastArray<PreSkinnedItem *>::const_iterator enItem = mItemsToSkin.end();
+
+        while( itItem != enItem )
+            uploadBoneMatrices( **itItem++ );
+
+        // Compute dispatches execute immediately, unlike render queue commands
+        mVaoManager->getDynamicUploadRing( BP_TYPE_READONLY )->flush();
+
+        for( itItem = mItemsToSkin.begin(); itItem != enItem; ++itItem )
+        {
+            SkinnedVertexBufferVec::const_iterator itBuffer = ( *itItem )->buffers.begin();
+            SkinnedVertexBufferVec::const_iterator enBuffer = ( *itItem )->buffers.end();
+
+            while( itBuffer != enBuffer )
+                dispatch( *itBuffer++ );
+        }
+
+        // Compute shaders can't write to vertex buffers
+        for( itItem = mItemsToSkin.begin(); itItem != enItem; ++itItem )
+        {
+            SkinnedVertexBufferVec::const_iterator itBuffer = ( *itItem )->buffers.begin();
+            SkinnedVertexBufferVec::const_iterator enBuffer = ( *itItem )->buffers.end();
+
+            while( itBuffer != enBuffer )
+            {
+                itBuffer->dstUavBuffer->copyTo( itBuffer->dstVertexBuffer );
+                ++itBuffer;
+            }
+        }
+
+        OgreProfileGpuEnd( "PreSkinning" );
+    }
+    //-------------------------------------------------------------------------
+    void PreSkinning::allWorkspacesBeforeBeginUpdate() { update(); }
+}  // namespace Ogre
@@ -0,0 +1,370 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreAsyncTextureReadbackBatcher.h"
+
+#include "OgreAsyncTextureTicket.h"
+#include "OgreException.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "OgreProfiler.h"
+#include "OgreTextureGpu.h"
+#include "OgreTextureGpuManager.h"
+#include "Vao/OgreVaoManager.h"
+
+namespace Ogre
+{
+    AsyncTextureReadbackListener::~AsyncTextureReadbackListener() {}
+    //-----------------------------------------------------------------------------------
+    AsyncTextureReadbackBatcher::Stats::Stats() :
+        numInFlight( 0u ),
+        bytesInFlight( 0u ),
+        numCompleted( 0u ),
+        bytesCompleted( 0u ),
+        accumLatencyFrames( 0u ),
+        accumLatencyUs( 0u ),
+        maxLatencyFrames( 0u ),
+        maxLatencyUs( 0u ),
+        numTickets( 0u )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    float AsyncTextureReadbackBatcher::Stats::getAvgLatencyFrames() const
+    {
+        return numCompleted ? float( accumLatencyFrames ) / float( numCompleted ) : 0.0f;
+    }
+    //-----------------------------------------------------------------------------------
+    float AsyncTextureReadbackBatcher::Stats::getAvgLatencyMs() const
+    {
+        return numCompleted ? float( accumLatencyUs ) / ( float( numCompleted ) * 1000.0f ) : 0.0f;
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    AsyncTextureReadbackBatcher::AsyncTextureReadbackBatcher( TextureGpuManager *textureManager,
+                                                              DeliveryMode deliveryMode ) :
+        mTextureManager( textureManager ),
+        mVaoManager( textureManager->getVaoManager() ),
+        mDeliveryMode( deliveryMode )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    AsyncTextureReadbackBatcher::~AsyncTextureReadbackBatcher()
+    {
+        cancelAll();
+        freeUnusedTickets();
+    }
+    //-----------------------------------------------------------------------------------
+    AsyncTextureTicket *AsyncTextureReadbackBatcher::getTicket( uint32 width, uint32 height,
+                                                                uint32 depthOrSlices,
+                                                                TextureTypes::TextureTypes textureType,
+                                                                PixelFormatGpu pixelFormatFamily )
+    {
+        AsyncTextureTicketVec::iterator itor = mFreeTickets.begin();
+        AsyncTextureTicketVec::iterator endt = mFreeTickets.end();
+
+        while( itor != endt )
+        {
+            AsyncTextureTicket *ticket = *itor;
+            if( ticket->getWidth() == width && ticket->getHeight() == height &&
+                ticket->getDepthOrSlices() == depthOrSlices &&
+                ticket->getTextureType() == textureType &&
+                ticket->getPixelFormatFamily() == pixelFormatFamily )
+            {
+                efficientVectorRemove( mFreeTickets, itor );
+                return ticket;
+            }
+            ++itor;
+        }
+
+        ++mStats.numTickets;
+        return mTextureManager->createAsyncTextureTicket( width, height, depthOrSlices, textureType,
+                                                          pixelFormatFamily );
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadbackBatcher::download( TextureGpu *textureSrc, uint8 mipLevel,
+                                                AsyncTextureReadbackListener *listener,
+                                                void *userData, TextureBox *srcBox )
+    {
+        const TextureBox box = srcBox ? *srcBox : textureSrc->getEmptyBox( mipLevel );
+        const PixelFormatGpu pixelFormatFamily =
+            PixelFormatGpuUtils::getFamily( textureSrc->getPixelFormat() );
+
+        AsyncTextureTicket *ticket =
+            getTicket( box.width, box.height, box.getDepthOrSlices(), textureSrc->getTextureType(),
+                       pixelFormatFamily );
+
+        try
+        {
+            ticket->download( textureSrc, mipLevel, false, srcBox );
+        }
+        catch( Exception & )
+        {
+            mFreeTickets.push_back( ticket );
+            throw;
+        }
+
+        PendingDownload pending;
+        pending.ticket = ticket;
+        pending.texture = textureSrc;
+        pending.listener = listener;
+        pending.userData = userData;
+        pending.frameIssued = mVaoManager->getFrameCount();
+        pending.timeIssuedUs = mTimer.getMicroseconds();
+        pending.sizeBytes = PixelFormatGpuUtils::getSizeBytes(
+            box.width, box.height, box.depth, box.numSlices, pixelFormatFamily, 1u );
+        pending.mipLevel = mipLevel;
+        mPendingDownloads.push_back( pending );
+
+        ++mStats.numInFlight;
+        mStats.bytesInFlight += pending.sizeBytes;
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadbackBatcher::deliver( const PendingDownload &pending )
+    {
+        AsyncTextureTicket *ticket = pending.ticket;
+        const PixelFormatGpu pixelFormat = ticket->getPixelFormatFamily();
+        const uint32 numSlices = ticket->getNumSlices();
+
+        const bool bSingleMap = numSlices == 1u || ticket->canMapMoreThanOneSlice();
+
+        if( mDeliveryMode == Immediate && bSingleMap )
+        {
+            // Zero copy: hand over the mapped staging memory
+            const TextureBox srcBox = ticket->map( 0 );
+            pending.listener->readbackFinished( pending.texture, pending.mipLevel, srcBox, pixelFormat,
+                                                pending.userData );
+            ticket->unmap();
+        }
+        else
+        {
+            const uint32 bytesPerRow = ticket->getBytesPerRow();
+            const size_t bytesPerImage = ticket->getBytesPerImage();
+            const size_t sizeBytes = bytesPerImage * ticket->getDepthOrSlices();
+
+            TextureBox dstBox( ticket->getWidth(), ticket->getHeight(), ticket->getDepth(), numSlices,
+                               PixelFormatGpuUtils::getBytesPerPixel( pixelFormat ), bytesPerRow,
+                               bytesPerImage );
+            if( PixelFormatGpuUtils::isCompressed( pixelFormat ) )
+                dstBox.setCompressedPixelFormat( pixelFormat );
+
+            if( mDeliveryMode == Immediate )
+            {
+                mScratch.resize( sizeBytes );
+                dstBox.data = mScratch.data();
+            }
+            else
+            {
+                dstBox.data = OGRE_MALLOC_SIMD( sizeBytes, MEMCATEGORY_RESOURCE );
+            }
+
+            if( bSingleMap )
+            {
+                const TextureBox srcBox = ticket->map( 0 );
+                dstBox.copyFrom( srcBox );
+                ticket->unmap();
+            }
+            else
+            {
+                TextureBox dstSlice = dstBox;
+                for( uint32 i = 0; i < numSlices; ++i )
+                {
+                    const TextureBox srcBox = ticket->map( i );
+                    dstSlice.copyFrom( srcBox );
+                    dstSlice.data = dstSlice.at( 0, 0, 1u );
+                    --dstSlice.numSlices;
+                    ticket->unmap();
+                }
+            }
+
+            if( mDeliveryMode == Immediate )
+            {
+                pending.listener->readbackFinished( pending.texture, pending.mipLevel, dstBox,
+                                                    pixelFormat, pending.userData );
+            }
+            else
+            {
+                DeferredResult result;
+                result.texture = pending.texture;
+                result.listener = pending.listener;
+                result.userData = pending.userData;
+                result.box = dstBox;
+                result.pixelFormat = pixelFormat;
+                result.mipLevel = pending.mipLevel;
+
+                ScopedLock lock( mDeferredMutex );
+                mDeferredResults.push_back( result );
+            }
+        }
+
+        mFreeTickets.push_back( ticket );
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadbackBatcher::update( bool bWaitForAll )
+    {
+        if( mPendingDownloads.empty() )
+            return;
+
+        OgreProfileExhaustive( "AsyncTextureReadbackBatcher::update" );
+
+        const uint32 currentFrame = mVaoManager->getFrameCount();
+        const uint64 currentTimeUs = mTimer.getMicroseconds();
+
+        // Entries are sorted by frame. Only ask once per frame whether that frame is done
+        uint32 lastQueriedFrame = currentFrame;
+        bool bLastQueriedFrameDone = false;
+
+        // Listeners may call download(), which appends to mPendingDownloads
+        mPendingDownloadsTmp.swap( mPendingDownloads );
+
+        size_t numRemaining = 0u;
+        const size_t numPending = mPendingDownloadsTmp.size();
+        for( size_t i = 0u; i < numPending; ++i )
+        {
+            const PendingDownload &pending = mPendingDownloadsTmp[i];
+
+            bool bReady = bWaitForAll;
+            if( !bReady && pending.frameIssued != currentFrame )
+            {
+                // Querying during the issuing frame is pointless and, in some
+                // APIs, forces switching to accurate tracking.
+                if( pending.frameIssued != lastQueriedFrame )
+                {
+                    lastQueriedFrame = pending.frameIssued;
+                    bLastQueriedFrameDone = mVaoManager->isFrameFinished( pending.frameIssued );
+                }
+                // Transfers whose texture was still streaming didn't start with their frame
+                bReady = bLastQueriedFrameDone && pending.ticket->queryIsTransferDone();
+            }
+
+            if( bReady )
+            {
+                deliver( pending );
+
+                const uint32 latencyFrames = currentFrame - pending.frameIssued;
+                const uint64 latencyUs = currentTimeUs - pending.timeIssuedUs;
+                --mStats.numInFlight;
+                mStats.bytesInFlight -= pending.sizeBytes;
+                ++mStats.numCompleted;
+                mStats.bytesCompleted += pending.sizeBytes;
+                mStats.accumLatencyFrames += latencyFrames;
+                mStats.accumLatencyUs += latencyUs;
+                mStats.maxLatencyFrames = std::max( mStats.maxLatencyFrames, latencyFrames );
+                mStats.maxLatencyUs = std::max( mStats.maxLatencyUs, latencyUs );
+            }
+            else
+            {
+                mPendingDownloadsTmp[numRemaining++] = pending;
+            }
+        }
+
+        // Requests made by the listeners were issued last; keep them sorted by frame
+        mPendingDownloadsTmp.resize( numRemaining );
+        mPendingDownloadsTmp.insert( mPendingDownloadsTmp.end(), mPendingDownloads.begin(),
+                                     mPendingDownloads.end() );
+        mPendingDownloads.swap( mPendingDownloadsTmp );
+        mPendingDownloadsTmp.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadbackBatcher::dispatchDeferred()
+    {
+        {
+            ScopedLock lock( mDeferredMutex );
+            mDeferredResultsTmp.swap( mDeferredResults );
+        }
+
+        DeferredResultVec::const_iterator itor = mDeferredResultsTmp.begin();
+        DeferredResultVec::const_iterator endt = mDeferredResultsTmp.end();
+
+        while( itor != endt )
+        {
+            itor->listener->readbackFinished( itor->texture, itor->mipLevel, itor->box,
+                                              itor->pixelFormat, itor->userData );
+            OGRE_FREE_SIMD( itor->box.data, MEMCATEGORY_RESOURCE );
+            ++itor;
+        }
+
+        mDeferredResultsTmp.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadbackBatcher::cancelAll()
+    {
+        PendingDownloadVec::const_iterator itor = mPendingDownloads.begin();
+        PendingDownloadVec::const_iterator endt = mPendingDownloads.end();
+
+        while( itor != endt )
+        {
+            // Tickets can't abort a download. Destroy them rather than
+            // recycling them, so they can't deliver stale data later.
+            mTextureManager->destroyAsyncTextureTicket( itor->ticket );
+            --mStats.numTickets;
+            ++itor;
+        }
+
+        mPendingDownloads.clear();
+        mStats.numInFlight = 0u;
+        mStats.bytesInFlight = 0u;
+
+        ScopedLock lock( mDeferredMutex );
+        DeferredResultVec::const_iterator itDeferred = mDeferredResults.begin();
+        DeferredResultVec::const_iterator enDeferred = mDeferredResults.end();
+        while( itDeferred != enDeferred )
+        {
+            OGRE_FREE_SIMD( itDeferred->box.data, MEMCATEGORY_RESOURCE );
+            ++itDeferred;
+        }
+        mDeferredResults.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadbackBatcher::freeUnusedTickets()
+    {
+        AsyncTextureTicketVec::const_iterator itor = mFreeTickets.begin();
+        AsyncTextureTicketVec::const_iterator endt = mFreeTickets.end();
+
+        while( itor != endt )
+        {
+            mTextureManager->destroyAsyncTextureTicket( *itor );
+            ++itor;
+        }
+
+        mStats.numTickets -= mFreeTickets.size();
+        mFreeTickets.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadbackBatcher::resetStats()
+    {
+        const size_t numInFlight = mStats.numInFlight;
+        const size_t bytesInFlight = mStats.bytesInFlight;
+        const size_t numTickets = mStats.numTickets;
+        mStats = Stats();
+        mStats.numInFlight = numInFlight;
+        mStats.bytesInFlight = bytesInFlight;
+        mStats.numTickets = numTickets;
+    }
+}  // namespace Ogre
@@ -0,0 +1,675 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreBCnEncoder.h"
+
+#include "OgreException.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "OgreProfiler.h"
+#include "OgreTextureBox.h"
+#include "Threading/OgreThreads.h"
+
+#include <atomic>
+
+namespace Ogre
+{
+    namespace
+    {
+        /// Writes bits LSB first into a 128-bit block
+        struct BlockBitWriter
+        {
+            uint8 *RESTRICT_ALIAS data;
+            size_t bitOffset;
+
+            BlockBitWriter( uint8 *_data, size_t numBytes ) : data( _data ), bitOffset( 0u )
+            {
+                memset( data, 0, numBytes );
+            }
+
+            void write( uint32 value, size_t numBits )
+            {
+                for( size_t i = 0u; i < numBits; ++i )
+                {
+                    data[bitOffset >> 3u] |= static_cast<uint8>( ( ( value >> i ) & 0x01u )
+                                                                 << ( bitOffset & 0x07u ) );
+                    ++bitOffset;
+                }
+            }
+        };
+        //-------------------------------------------------------------------------------
+        inline uint32 sqDistance( const uint8 *a, const uint8 *b, size_t numChannels )
+        {
+            uint32 retVal = 0u;
+            for( size_t i = 0u; i < numChannels; ++i )
+            {
+                const int32 diff = int32( a[i] ) - int32( b[i] );
+                retVal += uint32( diff * diff );
+            }
+            return retVal;
+        }
+        //-------------------------------------------------------------------------------
+        /** Finds the principal axis of the given points (power iteration over the covariance
+            matrix) and outputs the points at both extremes of that axis.
+        @param texels
+            numTexels points of numChannels each (at 4 bytes stride)
+        */
+        void fitPrincipalAxis( const uint8 texels[16][4], size_t numChannels, float outMin[4],
+                               float outMax[4] )
+        {
+            float mean[4] = { 0, 0, 0, 0 };
+            for( size_t i = 0u; i < 16u; ++i )
+            {
+                for( size_t c = 0u; c < numChannels; ++c )
+                    mean[c] += texels[i][c];
+            }
+            for( size_t c = 0u; c < numChannels; ++c )
+                mean[c] *= 1.0f / 16.0f;
+
+            float cov[4][4];
+            memset( cov, 0, sizeof( cov ) );
+            for( size_t i = 0u; i < 16u; ++i )
+            {
+                float d[4];
+                for( size_t c = 0u; c < numChannels; ++c )
+                    d[c] = texels[i][c] - mean[c];
+                for( size_t c0 = 0u; c0 < numChannels; ++c0 )
+                {
+                    for( size_t c1 = c0; c1 < numChannels; ++c1 )
+                        cov[c0][c1] += d[c0] * d[c1];
+                }
+            }
+            for( size_t c0 = 0u; c0 < numChannels; ++c0 )
+            {
+                for( size_t c1 = 0u; c1 < c0; ++c1 )
+                    cov[c0][c1] = cov[c1][c0];
+            }
+
+            float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            for( int iteration = 0; iteration < 4; ++iteration )
+            {
+                float newAxis[4] = { 0, 0, 0, 0 };
+                float maxComponent = 0.0f;
+                for( size_t c0 = 0u; c0 < numChannels; ++c0 )
+                {
+                    for( size_t c1 = 0u; c1 < numChannels; ++c1 )
+                        newAxis[c0] += cov[c0][c1] * axis[c1];
+                    maxComponent = std::max( maxComponent, fabsf( newAxis[c0] ) );
+                }
+
+                if( maxComponent < 1e-6f )
+                    break;  // Flat block (or close to it). Keep last axis
+
+                for( size_t c = 0u; c < numChannels; ++c )
+                    axis[c] = newAxis[c] / maxComponent;
+            }
+
+            float minT = std::numeric_limits<float>::max();
+            float maxT = -std::numeric_limits<float>::max();
+            for( size_t i = 0u; i < 16u; ++i )
+            {
+                float t = 0.0f;
+                for( size_t c = 0u; c < numChannels; ++c )
+                    t += ( texels[i][c] - mean[c] ) * axis[c];
+                minT = std::min( minT, t );
+                maxT = std::max( maxT, t );
+            }
+
+            float axisSqLength = 0.0f;
+            for( size_t c = 0u; c < numChannels; ++c )
+                axisSqLength += axis[c] * axis[c];
+            if( axisSqLength > 0.0f )
+            {
+                minT /= axisSqLength;
+                maxT /= axisSqLength;
+            }
+
+            for( size_t c = 0u; c < numChannels; ++c )
+            {
+                outMin[c] = Math::Clamp( mean[c] + axis[c] * minT, 0.0f, 255.0f );
+                outMax[c] = Math::Clamp( mean[c] + axis[c] * maxT, 0.0f, 255.0f );
+            }
+        }
+        //-------------------------------------------------------------------------------
+        inline uint16 toRgb565( const float rgb[3] )
+        {
+            const uint32 r =
+                static_cast<uint32>( Math::Clamp( rgb[0], 0.0f, 255.0f ) * 31.0f / 255.0f + 0.5f );
+            const uint32 g =
+                static_cast<uint32>( Math::Clamp( rgb[1], 0.0f, 255.0f ) * 63.0f / 255.0f + 0.5f );
+            const uint32 b =
+                static_cast<uint32>( Math::Clamp( rgb[2], 0.0f, 255.0f ) * 31.0f / 255.0f + 0.5f );
+            return static_cast<uint16>( ( r << 11u ) | ( g << 5u ) | b );
+        }
+        //-------------------------------------------------------------------------------
+        inline void fromRgb565( uint16 value, uint8 outRgb[4] )
+        {
+            const uint32 r = ( value >> 11u ) & 0x1Fu;
+            const uint32 g = ( value >> 5u ) & 0x3Fu;
+            const uint32 b = value & 0x1Fu;
+            outRgb[0] = static_cast<uint8>( ( r << 3u ) | ( r >> 2u ) );
+            outRgb[1] = static_cast<uint8>( ( g << 2u ) | ( g >> 4u ) );
+            outRgb[2] = static_cast<uint8>( ( b << 3u ) | ( b >> 2u ) );
+            outRgb[3] = 255u;
+        }
+        //-------------------------------------------------------------------------------
+        /// Selects the best 2-bit indices for the given endpoints in 4-colour mode.
+        /// Returns the total squared error.
+        uint32 selectBC1Indices( const uint8 texels[16][4], uint16 c0, uint16 c1,
+                                 uint8 outIndices[16] )
+        {
+            uint8 palette[4][4];
+            fromRgb565( c0, palette[0] );
+            fromRgb565( c1, palette[1] );
+            for( size_t c = 0u; c < 3u; ++c )
+            {
+                palette[2][c] = static_cast<uint8>( ( 2u * palette[0][c] + palette[1][c] ) / 3u );
+                palette[3][c] = static_cast<uint8>( ( palette[0][c] + 2u * palette[1][c] ) / 3u );
+            }
+
+            uint32 totalError = 0u;
+            for( size_t i = 0u; i < 16u; ++i )
+            {
+                uint32 bestError = std::numeric_limits<uint32>::max();
+                for( uint8 j = 0u; j < 4u; ++j )
+                {
+                    const uint32 error = sqDistance( texels[i], palette[j], 3u );
+                    if( error < bestError )
+                    {
+                        bestError = error;
+                        outIndices[i] = j;
+                    }
+                }
+                totalError += bestError;
+            }
+            return totalError;
+        }
+        //-------------------------------------------------------------------------------
+        /// Least squares fit of both endpoints given the current indices.
+        /// Returns false if the system is degenerate.
+        bool refineBC1Endpoints( const uint8 texels[16][4], const uint8 indices[16], float outC0[3],
+                                 float outC1[3] )
+        {
+            static const float c_weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+            float aa = 0, ab = 0, bb = 0;
+            float ax[3] = { 0, 0, 0 };
+            float bx[3] = { 0, 0, 0 };
+            for( size_t i = 0u; i < 16u; ++i )
+            {
+                const float a = c_weights[indices[i]];
+                const float b = 1.0f - a;
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                for( size_t c = 0u; c < 3u; ++c )
+                {
+                    ax[c] += a * texels[i][c];
+                    bx[c] += b * texels[i][c];
+                }
+            }
+
+            const float det = aa * bb - ab * ab;
+            if( fabsf( det ) < 1e-6f )
+                return false;
+
+            const float invDet = 1.0f / det;
+            for( size_t c = 0u; c < 3u; ++c )
+            {
+                outC0[c] = ( ax[c] * bb - bx[c] * ab ) * invDet;
+                outC1[c] = ( bx[c] * aa - ax[c] * ab ) * invDet;
+            }
+            return true;
+        }
+        //-------------------------------------------------------------------------------
+        /// Encodes the 8 byte colour block used by BC1 & BC3. Always uses 4-colour mode.
+        void encodeBC1Colour( const uint8 texels[16][4], uint8 *RESTRICT_ALIAS outBlock )
+        {
+            float minColour[4], maxColour[4];
+            fitPrincipalAxis( texels, 3u, minColour, maxColour );
+
+            uint16 c0 = toRgb565( maxColour );
+            uint16 c1 = toRgb565( minColour );
+
+            uint8 indices[16];
+            uint32 error = selectBC1Indices( texels, c0, c1, indices );
+
+            float refinedC0[3], refinedC1[3];
+            if( c0 != c1 && refineBC1Endpoints( texels, indices, refinedC0, refinedC1 ) )
+            {
+                const uint16 newC0 = toRgb565( refinedC0 );
+                const uint16 newC1 = toRgb565( refinedC1 );
+                uint8 newIndices[16];
+                const uint32 newError = selectBC1Indices( texels, newC0, newC1, newIndices );
+                if( newError < error )
+                {
+                    c0 = newC0;
+                    c1 = newC1;
+                    error = newError;
+                    memcpy( indices, newIndices, sizeof( indices ) );
+                }
+            }
+
+            if( c0 < c1 )
+            {
+                // Swap to stay in 4-colour mode (c0 > c1): index 0 <-> 1, 2 <-> 3
+                std::swap( c0, c1 );
+                for( size_t i = 0u; i < 16u; ++i )
+                    indices[i] ^= 0x01u;
+            }
+            else if( c0 == c1 )
+            {
+                // Every texel decodes to c0
+                memset( indices, 0, sizeof( indices ) );
+            }
+
+            uint32 packedIndices = 0u;
+            for( size_t i = 0u; i < 16u; ++i )
+                packedIndices |= uint32( indices[i] ) << ( i * 2u );
+
+            outBlock[0] = static_cast<uint8>( c0 & 0xFFu );
+            outBlock[1] = static_cast<uint8>( c0 >> 8u );
+            outBlock[2] = static_cast<uint8>( c1 & 0xFFu );
+            outBlock[3] = static_cast<uint8>( c1 >> 8u );
+            outBlock[4] = static_cast<uint8>( packedIndices & 0xFFu );
+            outBlock[5] = static_cast<uint8>( ( packedIndices >> 8u ) & 0xFFu );
+            outBlock[6] = static_cast<uint8>( ( packedIndices >> 16u ) & 0xFFu );
+            outBlock[7] = static_cast<uint8>( packedIndices >> 24u );
+        }
+        //-------------------------------------------------------------------------------
+        /** Encodes the 8 byte single channel block used by BC3 (alpha), BC4 & BC5.
+            Always uses the 8-value mode (ep0 > ep1).
+        @param values
+            16 values to encode. Snorm values must already be in range [-127; 127].
+        */
+        template <typename T>
+        void encodeBC4Channel( const int32 values[16], uint8 *RESTRICT_ALIAS outBlock )
+        {
+            int32 minVal = values[0];
+            int32 maxVal = values[0];
+            for( size_t i = 1u; i < 16u; ++i )
+            {
+                minVal = std::min( minVal, values[i] );
+                maxVal = std::max( maxVal, values[i] );
+            }
+
+            outBlock[0] = static_cast<uint8>( static_cast<T>( maxVal ) );
+            outBlock[1] = static_cast<uint8>( static_cast<T>( minVal ) );
+
+            uint64 packedIndices = 0u;
+            if( maxVal != minVal )
+            {
+                int32 palette[8];
+                palette[0] = maxVal;
+                palette[1] = minVal;
+                for( int32 j = 1; j < 7; ++j )
+                    palette[j + 1] = ( ( 7 - j ) * maxVal + j * minVal ) / 7;
+
+                for( size_t i = 0u; i < 16u; ++i )
+                {
+                    uint32 bestIdx = 0u;
+                    int32 bestError = std::numeric_limits<int32>::max();
+                    for( uint32 j = 0u; j < 8u; ++j )
+                    {
+                        const int32 error = abs( values[i] - palette[j] );
+                        if( error < bestError )
+                        {
+                            bestError = error;
+                            bestIdx = j;
+                        }
+                    }
+                    packedIndices |= uint64( bestIdx ) << ( i * 3u );
+                }
+            }
+
+            for( size_t i = 0u; i < 6u; ++i )
+                outBlock[2u + i] = static_cast<uint8>( ( packedIndices >> ( i * 8u ) ) & 0xFFu );
+        }
+        //-------------------------------------------------------------------------------
+        void encodeBC1( const uint8 texels[16][4], uint8 *outBlock )
+        {
+            encodeBC1Colour( texels, outBlock );
+        }
+        //-------------------------------------------------------------------------------
+        void encodeBC3( const uint8 texels[16][4], uint8 *outBlock )
+        {
+            int32 alpha[16];
+            for( size_t i = 0u; i < 16u; ++i )
+                alpha[i] = texels[i][3];
+            encodeBC4Channel<uint8>( alpha, outBlock );
+            encodeBC1Colour( texels, outBlock + 8u );
+        }
+        //-------------------------------------------------------------------------------
+        template <typename T, size_t numChannels>
+        void encodeBC4or5( const uint8 texels[16][4], uint8 *outBlock )
+        {
+            for( size_t c = 0u; c < numChannels; ++c )
+            {
+                int32 values[16];
+                for( size_t i = 0u; i < 16u; ++i )
+                {
+                    // -128 & -127 both map to -1.0
+                    values[i] =
+                        std::max<int32>( static_cast<int32>( static_cast<T>( texels[i][c] ) ), -127 );
+                }
+                encodeBC4Channel<T>( values, outBlock + c * 8u );
+            }
+        }
+        //-------------------------------------------------------------------------------
+        /// Quantizes an 8-bit endpoint to 7 bits + shared p-bit, picking the p-bit with less error
+        void quantizeBC7Mode6Endpoint( const float endpoint[4], uint8 outEndpoint[4],
+                                       uint32 &outPBit )
+        {
+            float bestError = std::numeric_limits<float>::max();
+            for( uint32 pBit = 0u; pBit < 2u; ++pBit )
+            {
+                uint8 candidate[4];
+                float error = 0.0f;
+                for( size_t c = 0u; c < 4u; ++c )
+                {
+                    const float q = Math::Clamp( ( endpoint[c] - float( pBit ) ) * 0.5f + 0.5f, 0.0f,
+                                                 127.0f );
+                    candidate[c] = static_cast<uint8>( q );
+                    const float diff = float( ( candidate[c] << 1u ) | pBit ) - endpoint[c];
+                    error += diff * diff;
+                }
+                if( error < bestError )
+                {
+                    bestError = error;
+                    outPBit = pBit;
+                    memcpy( outEndpoint, candidate, sizeof( candidate ) );
+                }
+            }
+        }
+        //-------------------------------------------------------------------------------
+        void encodeBC7( const uint8 texels[16][4], uint8 *outBlock )
+        {
+            static const uint32 c_weights4[16] = { 0,  4,  9,  13, 17, 21, 26, 30,
+                                                   34, 38, 43, 47, 51, 55, 60, 64 };
+
+            float minColour[4], maxColour[4];
+            fitPrincipalAxis( texels, 4u, minColour, maxColour );
+
+            uint8 ep[2][4];
+            uint32 pBits[2];
+            quantizeBC7Mode6Endpoint( minColour, ep[0], pBits[0] );
+            quantizeBC7Mode6Endpoint( maxColour, ep[1], pBits[1] );
+
+            uint8 palette[16][4];
+            for( size_t c = 0u; c < 4u; ++c )
+            {
+                const uint32 e0 = uint32( ep[0][c] << 1u ) | pBits[0];
+                const uint32 e1 = uint32( ep[1][c] << 1u ) | pBits[1];
+                for( size_t j = 0u; j < 16u; ++j )
+                {
+                    const uint32 w = c_weights4[j];
+                    palette[j][c] = static_cast<uint8>( ( ( 64u - w ) * e0 + w * e1 + 32u ) >> 6u );
+                }
+            }
+
+            uint8 indices[16];
+            for( size_t i = 0u; i < 16u; ++i )
+            {
+                uint32 bestError = std::numeric_limits<uint32>::max();
+                for( uint8 j = 0u; j < 16u; ++j )
+                {
+                    const uint32 error = sqDistance( texels[i], palette[j], 4u );
+                    if( error < bestError )
+                    {
+                        bestError = error;
+                        indices[i] = j;
+                    }
+                }
+            }
+
+            // The MSB of the first index is implicitly 0
+            if( indices[0] & 0x08u )
+            {
+                for( size_t c = 0u; c < 4u; ++c )
+                    std::swap( ep[0][c], ep[1][c] );
+                std::swap( pBits[0], pBits[1] );
+                for( size_t i = 0u; i < 16u; ++i )
+                    indices[i] = static_cast<uint8>( 15u - indices[i] );
+            }
+
+            BlockBitWriter writer( outBlock, 16u );
+            writer.write( 1u << 6u, 7u );  // Mode 6
+            for( size_t c = 0u; c < 4u; ++c )
+            {
+                writer.write( ep[0][c], 7u );
+                writer.write( ep[1][c], 7u );
+            }
+            writer.write( pBits[0], 1u );
+            writer.write( pBits[1], 1u );
+            writer.write( indices[0], 3u );
+            for( size_t i = 1u; i < 16u; ++i )
+                writer.write( indices[i], 4u );
+        }
+        //-------------------------------------------------------------------------------
+        typedef void ( *block_encode_func_t )( const uint8 texels[16][4], uint8 *outBlock );
+        //-------------------------------------------------------------------------------
+        /// Shared by all the threads compressing the same image.
+        /// Each thread grabs one row of blocks at a time.
+        struct EncoderJobParams
+        {
+            TextureBox          srcBox;
+            TextureBox          dstBox;
+            block_encode_func_t encodeFunc;
+            size_t              blockSize;
+            uint32              numBlocksX;
+            uint32              numBlocksY;
+            uint32              numRows;
+            std::atomic<uint32> nextRow;
+        };
+        //-------------------------------------------------------------------------------
+        void encodeRows( EncoderJobParams &job )
+        {
+            const TextureBox &srcBox = job.srcBox;
+            const TextureBox &dst = job.dstBox;
+            const block_encode_func_t encodeFunc = job.encodeFunc;
+            const size_t blockSize = job.blockSize;
+            const uint32 numBlocksX = job.numBlocksX;
+            const uint32 numBlocksY = job.numBlocksY;
+            const size_t srcBytesPerPixel = srcBox.bytesPerPixel;
+            const uint32 maxX = srcBox.width - 1u;
+            const uint32 maxY = srcBox.height - 1u;
+
+            uint8 *dstBase = reinterpret_cast<uint8 *>( dst.data );
+
+            uint8 texels[16][4];
+            memset( texels, 0, sizeof( texels ) );
+
+            while( true )
+            {
+                const uint32 row = job.nextRow.fetch_add( 1u, std::memory_order_relaxed );
+                if( row >= job.numRows )
+                    break;
+
+                const uint32 z = row / numBlocksY;
+                const uint32 blockY = row % numBlocksY;
+
+                uint8 *dstPtr = dstBase + dst.bytesPerImage * ( dst.getZOrSlice() + z ) +
+                                dst.bytesPerRow * blockY;
+
+                for( uint32 blockX = 0; blockX < numBlocksX; ++blockX )
+                {
+                    // Gather the 4x4 block, replicating the edges for partial blocks
+                    for( uint32 y = 0; y < 4u; ++y )
+                    {
+                        const uint32 srcY = std::min( blockY * 4u + y, maxY );
+                        for( uint32 x = 0; x < 4u; ++x )
+                        {
+                            const uint32 srcX = std::min( blockX * 4u + x, maxX );
+                            const uint8 *srcPtr =
+                                reinterpret_cast<const uint8 *>( srcBox.at( srcX, srcY, z ) );
+                            for( size_t c = 0u; c < srcBytesPerPixel; ++c )
+                                texels[y * 4u + x][c] = srcPtr[c];
+                        }
+                    }
+
+                    encodeFunc( texels, dstPtr );
+                    dstPtr += blockSize;
+                }
+            }
+        }
+        //-------------------------------------------------------------------------------
+        unsigned long bcnEncoderThread( ThreadHandle *threadHandle )
+        {
+            EncoderJobParams &job =
+                *reinterpret_cast<EncoderJobParams *>( threadHandle->getUserParam() );
+            encodeRows( job );
+            return 0u;
+        }
+        THREAD_DECLARE( bcnEncoderThread );
+    }  // namespace
+    //-----------------------------------------------------------------------------------
+    PixelFormatGpu BCnEncoder::getEncodingSourceFormat( PixelFormatGpu dstFormat )
+    {
+        switch( PixelFormatGpuUtils::getEquivalentLinear( dstFormat ) )
+        {
+        case PFG_BC1_UNORM:
+        case PFG_BC3_UNORM:
+        case PFG_BC7_UNORM:
+            return PFG_RGBA8_UNORM;
+        case PFG_BC4_UNORM:
+            return PFG_R8_UNORM;
+        case PFG_BC4_SNORM:
+            return PFG_R8_SNORM;
+        case PFG_BC5_UNORM:
+            return PFG_RG8_UNORM;
+        case PFG_BC5_SNORM:
+            return PFG_RG8_SNORM;
+        default:
+            return PFG_UNKNOWN;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool BCnEncoder::isSupported( PixelFormatGpu srcFormat, PixelFormatGpu dstFormat )
+    {
+        const PixelFormatGpu encodingFormat = getEncodingSourceFormat( dstFormat );
+        if( encodingFormat == PFG_UNKNOWN )
+            return false;
+
+        const PixelFormatGpu srcLinear = PixelFormatGpuUtils::getEquivalentLinear( srcFormat );
+        if( encodingFormat == PFG_RGBA8_UNORM )
+        {
+            return srcLinear == PFG_RGBA8_UNORM || srcLinear == PFG_BGRA8_UNORM ||
+                   srcLinear == PFG_BGRX8_UNORM || srcLinear == PFG_RGB8_UNORM ||
+                   srcLinear == PFG_BGR8_UNORM;
+        }
+
+        return srcLinear == encodingFormat;
+    }
+    //-----------------------------------------------------------------------------------
+    void BCnEncoder::compress( const TextureBox &src, PixelFormatGpu srcFormat, TextureBox &dst,
+                               PixelFormatGpu dstFormat, uint32 numThreads )
+    {
+        OgreProfileExhaustive( "BCnEncoder::compress" );
+
+        if( !isSupported( srcFormat, dstFormat ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         String( "Cannot encode " ) + PixelFormatGpuUtils::toString( srcFormat ) +
+                             " into " + PixelFormatGpuUtils::toString( dstFormat ),
+                         "BCnEncoder::compress" );
+        }
+
+        const PixelFormatGpu encodingFormat = getEncodingSourceFormat( dstFormat );
+
+        block_encode_func_t encodeFunc = 0;
+        switch( PixelFormatGpuUtils::getEquivalentLinear( dstFormat ) )
+        {
+            // clang-format off
+        case PFG_BC1_UNORM: encodeFunc = encodeBC1; break;
+        case PFG_BC3_UNORM: encodeFunc = encodeBC3; break;
+        case PFG_BC7_UNORM: encodeFunc = encodeBC7; break;
+        case PFG_BC4_UNORM: encodeFunc = encodeBC4or5<uint8, 1u>; break;
+        case PFG_BC4_SNORM: encodeFunc = encodeBC4or5<int8, 1u>; break;
+        case PFG_BC5_UNORM: encodeFunc = encodeBC4or5<uint8, 2u>; break;
+        case PFG_BC5_SNORM: encodeFunc = encodeBC4or5<int8, 2u>; break;
+            // clang-format on
+        default:
+            break;
+        }
+
+        // Bring the source to the layout the encoder reads from.
+        // sRGB sources are treated as linear so their values are kept as-is.
+        TextureBox srcBox = src;
+        uint8 *tmpData = 0;
+        const PixelFormatGpu srcLinear = PixelFormatGpuUtils::getEquivalentLinear( srcFormat );
+        if( srcLinear != encodingFormat )
+        {
+            const uint32 bytesPerPixel = PixelFormatGpuUtils::getBytesPerPixel( encodingFormat );
+            srcBox = TextureBox( src.width, src.height, src.depth, src.numSlices, bytesPerPixel,
+                                 src.width * bytesPerPixel,
+                                 size_t( src.width ) * src.height * bytesPerPixel );
+            tmpData = reinterpret_cast<uint8 *>(
+                OGRE_MALLOC_SIMD( srcBox.getSizeBytes(), MEMCATEGORY_RESOURCE ) );
+            srcBox.data = tmpData;
+            PixelFormatGpuUtils::bulkPixelConversion( src, srcLinear, srcBox, encodingFormat );
+        }
+
+        EncoderJobParams job;
+        job.srcBox = srcBox;
+        job.dstBox = dst;
+        job.encodeFunc = encodeFunc;
+        job.blockSize = PixelFormatGpuUtils::getCompressedBlockSize( dstFormat );
+        job.numBlocksX = ( src.width + 3u ) / 4u;
+        job.numBlocksY = ( src.height + 3u ) / 4u;
+        job.numRows = job.numBlocksY * src.getDepthOrSlices();
+        job.nextRow.store( 0u, std::memory_order_relaxed );
+
+        // Not worth spawning threads for the smaller mipmaps
+        const size_t c_minBlocksPerThread = 4096u;
+        const size_t numBlocks = size_t( job.numRows ) * job.numBlocksX;
+        numThreads = static_cast<uint32>(
+            std::max<size_t>( std::min<size_t>( numThreads, numBlocks / c_minBlocksPerThread ), 1u ) );
+
+        if( numThreads > 1u )
+        {
+            // The calling thread does its share of the work too
+            ThreadHandleVec workerThreads;
+            workerThreads.reserve( numThreads - 1u );
+            for( size_t i = 0u; i < numThreads - 1u; ++i )
+            {
+                workerThreads.push_back(
+                    Threads::CreateThread( THREAD_GET( bcnEncoderThread ), i, &job ) );
+            }
+            encodeRows( job );
+            Threads::WaitForThreads( workerThreads );
+        }
+        else
+        {
+            encodeRows( job );
+        }
+
+        if( tmpData )
+            OGRE_FREE_SIMD( tmpData, MEMCATEGORY_RESOURCE );
+    }
+}  // namespace Ogre
@@ -29,6 +29,8 @@ THE SOFTWARE.
 
 #include "OgreBillboardSet.h"
 
+#include "Math/Array/OgreArrayVector3.h"
+#include "Math/Array/OgreArrayVector4.h"
 #include "OgreBillboard.h"
 #include "OgreCamera.h"
 #include "OgreException.h"
@@ -43,6 +45,7 @@ THE SOFTWARE.
 #include "OgreRoot.h"
 #include "OgreSceneNode.h"
 #include "OgreSphere.h"
+#include "Threading/OgreUniformScalableTask.h"
 #include "Vao/OgreVaoManager.h"
 
 #include <algorithm>
@@ -54,6 +57,9 @@ namespace Ogre
         // Init statics
         RadixSort<BillboardSet::ActiveBillboardList, Billboard *, float> BillboardSet::mRadixSorter;
 
+        /// Sets with fewer billboards than this per worker thread are generated by a single thread.
+        static const size_t c_minBillboardsPerThread = 1024u;
+
         //-----------------------------------------------------------------------
         BillboardSet::BillboardSet( IdType id, ObjectMemoryManager *objectMemoryManager,
                                     SceneManager *manager, unsigned int poolSize, bool externalData,
@@ -75,6 +81,7 @@ namespace Ogre
             mCommonDirection( Ogre::Vector3::UNIT_Z ),
             mCommonUpVector( Vector3::UNIT_Y ),
             mVaoManager( 0 ),
+            mColourType( VET_COLOUR_ABGR ),
             mPointRendering( false ),
             mBuffersCreated( false ),
             mPoolSize( poolSize ),
@@ -363,6 +370,8 @@ namespace Ogre
             mMainBuf = mMainBuffers[mVaoManager->waitForTailFrameToFinish()][mLastLockedBuffer];
             mVertexData->vertexBufferBinding->setBinding( 0, mMainBuf );
 
+            mColourType = mManager->getDestinationRenderSystem()->getColourVertexElementType();
+
             // Only calculate vertex offets et al if we're not point rendering
             if( !mPointRendering )
             {
@@ -548,10 +557,56 @@ namespace Ogre
                 }
 
                 beginBillboards( mActiveBillboards.size() );
-                ActiveBillboardList::iterator it;
-                for( it = mActiveBillboards.begin(); it != mActiveBillboards.end(); ++it )
+                if( canGenVerticesBatched() )
+                {
+                    const size_t numBillboards = std::min( mActiveBillboards.size(), mPoolSize );
+
+                    mBillboardsToGen.clear();
+                    mBillboardsToGen.reserve( numBillboards );
+                    ActiveBillboardList::const_iterator it = mActiveBillboards.begin();
+                    for( size_t i = 0u; i < numBillboards; ++i )
+                        mBillboardsToGen.push_back( *it++ );
+
+                    if( numBillboards >= c_minBillboardsPerThread * 2u &&
+                        mManager->getNumWorkerThreads() > 1u )
+                    {
+                        // Generates the vertices of large sets from all worker threads.
+                        // Local class, so it can call genVerticesBatch().
+                        struct GenVerticesJob : public UniformScalableTask
+                        {
+                            BillboardSet *billboardSet;
+                            void execute( size_t threadId, size_t numThreads ) override
+                            {
+                                const size_t numBillboards = billboardSet->mBillboardsToGen.size();
+                                const size_t billboardsPerThread =
+                                    ( numBillboards + numThreads - 1u ) / numThreads;
+                                const size_t toAdvance =
+                                    std::min( threadId * billboardsPerThread, numBillboards );
+                                const size_t numToProcess =
+                                    std::min( billboardsPerThread, numBillboards - toAdvance );
+
+                                billboardSet->genVerticesBatch( toAdvance, numToProcess );
+                            }
+                        };
+
+                        GenVerticesJob job;
+                        job.billboardSet = this;
+                        mManager->executeUserScalableTask( &job, true );
+                    }
+                    else
+                    {
+                        genVerticesBatch( 0u, numBillboards );
+                    }
+
+                    mNumVisibleBillboards = static_cast<unsigned short>( numBillboards );
+                }
+                else
                 {
-                    injectBillboard( *( *it ), lodCamera );
+                    ActiveBillboardList::iterator it;
+                    for( it = mActiveBillboards.begin(); it != mActiveBillboards.end(); ++it )
+                    {
+                        injectBillboard( *( *it ), lodCamera );
+                    }
                 }
                 endBillboards();
 
@@ -1097,8 +1152,7 @@ namespace Ogre
         //-----------------------------------------------------------------------
         void BillboardSet::genVertices( const Vector3 *const offsets, const Billboard &bb )
         {
-            RGBA colour;
-            Root::getSingleton().convertColourValue( bb.mColour, &colour );
+            const RGBA colour = VertexElement::convertColourValue( bb.mColour, mColourType );
             RGBA *pCol;
 
             // Texcoords
@@ -1335,6 +1389,120 @@ namespace Ogre
             }
         }
         //-----------------------------------------------------------------------
+        bool BillboardSet::canGenVerticesBatched() const
+        {
+            return !mPointRendering && !mCullIndividual &&  //
+                   mBillboardType != BBT_ORIENTED_SELF && mBillboardType != BBT_PERPENDICULAR_SELF &&
+                   !( mAccurateFacing && mBillboardType != BBT_PERPENDICULAR_COMMON ) &&
+                   ( mAllDefaultRotation || mRotationType == BBR_TEXCOORD );
+        }
+        //-----------------------------------------------------------------------
+        void BillboardSet::genVerticesBatch( const size_t firstBillboard, const size_t numBillboards )
+        {
+            // Position (3 floats), colour (1 RGBA) & texture coords (2 floats). See _createBuffers()
+            const size_t floatsPerVertex = 6u;
+
+            float *RESTRICT_ALIAS pVertices = mLockPtr + firstBillboard * 4u * floatsPerVertex;
+            const Billboard *const *billboards = mBillboardsToGen.data() + firstBillboard;
+
+            ArrayVector3 camX, camY;
+            camX.setAll( mCamX );
+            camY.setAll( mCamY );
+
+            for( size_t i = 0u; i < numBillboards; i += ARRAY_PACKED_REALS )
+            {
+                const size_t numInPack = std::min<size_t>( ARRAY_PACKED_REALS, numBillboards - i );
+
+                // Gather. Unused lanes repeat the last billboard.
+                ArrayVector3 position;
+                ArrayVector4 scales;
+                for( size_t j = 0u; j < ARRAY_PACKED_REALS; ++j )
+                {
+                    const Billboard *bb = billboards[i + std::min( j, numInPack - 1u )];
+                    const Real width = bb->mOwnDimensions ? bb->mWidth : mDefaultWidth;
+                    const Real height = bb->mOwnDimensions ? bb->mHeight : mDefaultHeight;
+                    position.setFromVector3( bb->mPosition, j );
+                    scales.setFromVector4( Vector4( mLeftOff * width, mRightOff * width,
+                                                    mTopOff * height, mBottomOff * height ),
+                                           j );
+                }
+
+                // Same operations (and order) as genVertOffsets() + genVertices()
+                const ArrayVector3 vLeftOff = camX * scales.mChunkBase[0];
+                const ArrayVector3 vRightOff = camX * scales.mChunkBase[1];
+                const ArrayVector3 vTopOff = camY * scales.mChunkBase[2];
+                const ArrayVector3 vBottomOff = camY * scales.mChunkBase[3];
+
+                ArrayVector3 corners[4];
+                corners[0] = ( vLeftOff + vTopOff ) + position;
+                corners[1] = ( vRightOff + vTopOff ) + position;
+                corners[2] = ( vLeftOff + vBottomOff ) + position;
+                corners[3] = ( vRightOff + vBottomOff ) + position;
+
+                // Scatter
+                for( size_t j = 0u; j < numInPack; ++j )
+                {
+                    const Billboard &bb = *billboards[i + j];
+
+                    const RGBA colour = VertexElement::convertColourValue( bb.mColour, mColourType );
+
+                    assert( bb.mUseTexcoordRect || bb.mTexcoordIndex < mTextureCoords.size() );
+                    const Ogre::FloatRect &r =
+                        bb.mUseTexcoordRect ? bb.mTexcoordRect : mTextureCoords[bb.mTexcoordIndex];
+
+                    float texCoords[4][2];
+                    if( mAllDefaultRotation || bb.mRotation == Radian( 0 ) )
+                    {
+                        texCoords[0][0] = r.left;
+                        texCoords[0][1] = r.top;
+                        texCoords[1][0] = r.right;
+                        texCoords[1][1] = r.top;
+                        texCoords[2][0] = r.left;
+                        texCoords[2][1] = r.bottom;
+                        texCoords[3][0] = r.right;
+                        texCoords[3][1] = r.bottom;
+                    }
+                    else
+                    {
+                        // BBR_TEXCOORD. See genVertices()
+                        const Real cos_rot( Math::Cos( bb.mRotation ) );
+                        const Real sin_rot( Math::Sin( bb.mRotation ) );
+
+                        float width = ( r.right - r.left ) / 2;
+                        float height = ( r.bottom - r.top ) / 2;
+                        float mid_u = r.left + width;
+                        float mid_v = r.top + height;
+
+                        float cos_rot_w = cos_rot * width;
+                        float cos_rot_h = cos_rot * height;
+                        float sin_rot_w = sin_rot * width;
+                        float sin_rot_h = sin_rot * height;
+
+                        texCoords[0][0] = mid_u - cos_rot_w + sin_rot_h;
+                        texCoords[0][1] = mid_v - sin_rot_w - cos_rot_h;
+                        texCoords[1][0] = mid_u + cos_rot_w + sin_rot_h;
+                        texCoords[1][1] = mid_v + sin_rot_w - cos_rot_h;
+                        texCoords[2][0] = mid_u - cos_rot_w - sin_rot_h;
+                        texCoords[2][1] = mid_v - sin_rot_w + cos_rot_h;
+                        texCoords[3][0] = mid_u + cos_rot_w - sin_rot_h;
+                        texCoords[3][1] = mid_v + sin_rot_w + cos_rot_h;
+                    }
+
+                    for( size_t k = 0u; k < 4u; ++k )
+                    {
+                        Vector3 pos;
+                        corners[k].getAsVector3( pos, j );
+                        *pVertices++ = pos.x;
+                        *pVertices++ = pos.y;
+                        *pVertices++ = pos.z;
+                        *static_cast<RGBA *>( static_cast<void *>( pVertices++ ) ) = colour;
+                        *pVertices++ = texCoords[k][0];
+                        *pVertices++ = texCoords[k][1];
+                    }
+                }
+            }
+        }
+        //-----------------------------------------------------------------------
         void BillboardSet::genVertOffsets( Real inleft, Real inright, Real intop, Real inbottom,
                                            Real width, Real height, const Vector3 &x, const Vector3 &y,
                                            Vector3 *pDestVec )
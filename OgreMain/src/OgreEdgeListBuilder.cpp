@@ -32,8 +32,10 @@ THE SOFTWARE.
 #include "OgreException.h"
 #include "OgreLogManager.h"
 #include "OgreOptimisedUtil.h"
+#include "OgreSceneManager.h"
 #include "OgreStringConverter.h"
 #include "OgreVertexIndexData.h"
+#include "Threading/OgreUniformScalableTask.h"
 
 namespace Ogre
 {
@@ -83,7 +85,297 @@ namespace Ogre
             }
         }
         //---------------------------------------------------------------------
-        EdgeListBuilder::EdgeListBuilder() : mEdgeData( 0 ) {}
+        /// Triangles a single thread must have before splitting the build is worth it
+        static const size_t c_minTrianglesPerThread = 16384u;
+        static const uint32 c_noPartner = ~0u;
+        //---------------------------------------------------------------------
+        static inline uint32 mixHash( uint32 h )
+        {
+            h ^= h >> 16u;
+            h *= 0x85ebca6bu;
+            h ^= h >> 13u;
+            h *= 0xc2b2ae35u;
+            h ^= h >> 16u;
+            return h;
+        }
+        //---------------------------------------------------------------------
+        /// Hashes a position by its exact bits. -0 and +0 compare equal, so they must hash equal.
+        static inline uint32 hashPosition( const Vector3 &v )
+        {
+            const Real xyz[3] = { v.x == Real( 0 ) ? Real( 0 ) : v.x, v.y == Real( 0 ) ? Real( 0 ) : v.y,
+                                  v.z == Real( 0 ) ? Real( 0 ) : v.z };
+            uint32 words[sizeof( xyz ) / sizeof( uint32 )];
+            memcpy( words, xyz, sizeof( xyz ) );
+
+            uint32 h = 0;
+            for( size_t i = 0; i < sizeof( words ) / sizeof( words[0] ); ++i )
+                h = mixHash( h ^ words[i] );
+            return h;
+        }
+        //---------------------------------------------------------------------
+        /// Hashes an edge regardless of its direction, so both sides end up in the same bucket
+        static inline uint32 hashEdge( uint32 sharedVertIndex0, uint32 sharedVertIndex1 )
+        {
+            const uint32 lo = std::min( sharedVertIndex0, sharedVertIndex1 );
+            const uint32 hi = std::max( sharedVertIndex0, sharedVertIndex1 );
+            return mixHash( lo * 0x9e3779b1u ^ hi );
+        }
+        //---------------------------------------------------------------------
+        /** Work shared by all threads of EdgeListBuilder::build.
+        @remarks
+            Every triangle corner and every half edge is owned by exactly one thread (chosen
+            by its hash) and each thread visits the items it owns in the same order a serial
+            build would. Thus the outcome doesn't depend on the number of threads, and the
+            calling thread merges the results in order.
+        */
+        struct EdgeListBuildJob : public UniformScalableTask
+        {
+            enum Phase
+            {
+                /// Reads indices & positions of the triangles of the current geometry
+                PhaseGatherCorners,
+                /// Finds the first corner sharing the position of each corner
+                PhaseWeldCorners,
+                /// Finds the earlier half edge (in the opposite direction) each half edge closes
+                PhaseConnectHalfEdges
+            };
+
+            Phase  phase;
+            size_t numThreads;
+
+            // Current geometry (PhaseGatherCorners)
+            const void   *indexData;
+            bool          idx32bit;
+            OperationType opType;
+            const uint8  *vertexData;
+            size_t        vertexSize;
+            size_t        positionOffset;
+            size_t        triStart;
+            size_t        triCount;
+
+            // Per triangle corner
+            vector<Vector3>::type cornerPositions;
+            vector<uint32>::type  cornerVertIndices;
+            vector<uint32>::type  cornerHashes;
+            vector<uint32>::type  firstCorners;
+
+            // Per half edge. Half edge i * 3 + j goes from corner j to ( j + 1 ) % 3 of triangle i
+            vector<uint32>::type halfEdgeSharedVertIndices;
+            vector<uint32>::type halfEdgeHashes;
+            vector<uint32>::type partners;
+            vector<uint32>::type nextPending;
+
+            uint32 readIndex( size_t i ) const
+            {
+                return idx32bit ? static_cast<const uint32 *>( indexData )[i]
+                                : static_cast<const uint16 *>( indexData )[i];
+            }
+
+            void gatherCorners( size_t threadIdx )
+            {
+                const size_t begin = triCount * threadIdx / numThreads;
+                const size_t end = triCount * ( threadIdx + 1u ) / numThreads;
+
+                for( size_t t = begin; t < end; ++t )
+                {
+                    uint32 index[3];
+                    if( opType == OT_TRIANGLE_LIST )
+                    {
+                        index[0] = readIndex( t * 3u + 0u );
+                        index[1] = readIndex( t * 3u + 1u );
+                        index[2] = readIndex( t * 3u + 2u );
+                    }
+                    else if( opType == OT_TRIANGLE_FAN )
+                    {
+                        // All the triangles share the first vertex
+                        index[0] = readIndex( 0u );
+                        index[1] = readIndex( t + 1u );
+                        index[2] = readIndex( t + 2u );
+                    }
+                    else
+                    {
+                        // Strips flip every odd triangle, to process all triangles
+                        // in _anti_ clockwise orientation
+                        index[0] = readIndex( t + ( t & 1u ) );
+                        index[1] = readIndex( t + 1u - ( t & 1u ) );
+                        index[2] = readIndex( t + 2u );
+                    }
+
+                    const size_t cornerStart = ( triStart + t ) * 3u;
+                    for( size_t i = 0; i < 3u; ++i )
+                    {
+                        const float *pFloat = reinterpret_cast<const float *>(
+                            vertexData + index[i] * vertexSize + positionOffset );
+                        const Vector3 pos( pFloat[0], pFloat[1], pFloat[2] );
+
+                        cornerPositions[cornerStart + i] = pos;
+                        cornerVertIndices[cornerStart + i] = index[i];
+                        cornerHashes[cornerStart + i] = hashPosition( pos );
+                    }
+                }
+            }
+
+            /// Returns the size of an open addressing hash table that can hold all the items
+            /// this thread owns, at no more than half occupancy. Also returns the mask to wrap it.
+            size_t calculateTableSize( const vector<uint32>::type &hashes, size_t threadIdx,
+                                       uint32 &outMask ) const
+            {
+                size_t numOwned = 0;
+                const size_t numItems = hashes.size();
+                for( size_t i = 0; i < numItems; ++i )
+                    numOwned += hashes[i] % numThreads == threadIdx ? 1u : 0u;
+
+                size_t tableSize = 16u;
+                while( tableSize < numOwned * 2u )
+                    tableSize <<= 1u;
+                outMask = static_cast<uint32>( tableSize - 1u );
+                return tableSize;
+            }
+
+            /// Threads own items by hash % numThreads, thus lower bits may be all the same
+            /// for a given thread. Slots must be chosen by mixing the high bits in.
+            static uint32 getFirstSlot( uint32 hash, uint32 mask )
+            {
+                return ( hash * 0x9e3779b1u ^ ( hash >> 16u ) ) & mask;
+            }
+
+            void weldCorners( size_t threadIdx )
+            {
+                // Because the algorithm doesn't care about manifold or not, we just identifying
+                // the common vertex by EXACT same position.
+                // Linear probing table with the first corner seen at each position.
+                uint32 mask;
+                vector<uint32>::type table( calculateTableSize( cornerHashes, threadIdx, mask ),
+                                            c_noPartner );
+
+                const size_t numCorners = cornerHashes.size();
+                for( size_t i = 0; i < numCorners; ++i )
+                {
+                    const uint32 hash = cornerHashes[i];
+                    if( hash % numThreads != threadIdx )
+                        continue;
+
+                    const Vector3 &pos = cornerPositions[i];
+                    uint32 slot = getFirstSlot( hash, mask );
+                    while( table[slot] != c_noPartner && !( cornerPositions[table[slot]] == pos ) )
+                        slot = ( slot + 1u ) & mask;
+
+                    if( table[slot] == c_noPartner )
+                        table[slot] = static_cast<uint32>( i );
+                    firstCorners[i] = table[slot];
+                }
+            }
+
+            void connectHalfEdges( size_t threadIdx )
+            {
+                // Half edges waiting for their opposite, keyed by their own direction. Many
+                // triangles may share an edge; they are connected first come, first served.
+                // Linear probing table; once a key is in, it stays even if its list empties.
+                // An edge can't start and end at the same vertex, so ~0 is never a valid key.
+                struct PendingList
+                {
+                    uint64 key;
+                    uint32 head;
+                    uint32 tail;
+                };
+                const uint64      c_emptyKey = ~static_cast<uint64>( 0u );
+                const PendingList emptyList = { c_emptyKey, c_noPartner, c_noPartner };
+
+                uint32 mask;
+                vector<PendingList>::type table( calculateTableSize( halfEdgeHashes, threadIdx, mask ),
+                                                 emptyList );
+
+                const size_t numHalfEdges = halfEdgeHashes.size();
+                for( size_t i = 0; i < numHalfEdges; ++i )
+                {
+                    const uint32 hash = halfEdgeHashes[i];
+                    if( hash % numThreads != threadIdx )
+                        continue;
+
+                    const uint64 v0 = halfEdgeSharedVertIndices[i * 2u + 0u];
+                    const uint64 v1 = halfEdgeSharedVertIndices[i * 2u + 1u];
+                    const uint64 key = ( v0 << 32u ) | v1;
+                    const uint64 reversedKey = ( v1 << 32u ) | v0;
+
+                    // Both directions have the same hash, hence they share the same probe sequence
+                    uint32 slot = getFirstSlot( hash, mask );
+                    uint32 ownSlot = c_noPartner;
+                    uint32 reversedSlot = c_noPartner;
+                    while( table[slot].key != c_emptyKey )
+                    {
+                        if( table[slot].key == key )
+                            ownSlot = slot;
+                        else if( table[slot].key == reversedKey )
+                            reversedSlot = slot;
+                        slot = ( slot + 1u ) & mask;
+                    }
+
+                    // Find the existing edge (should be reversed order) on shared vertices
+                    if( reversedSlot != c_noPartner && table[reversedSlot].head != c_noPartner )
+                    {
+                        PendingList &pending = table[reversedSlot];
+                        partners[i] = pending.head;
+                        // Remove it, so it never gets connected again
+                        pending.head = pending.head == pending.tail ? c_noPartner
+                                                                    : nextPending[pending.head];
+                    }
+                    else
+                    {
+                        const uint32 halfEdgeIdx = static_cast<uint32>( i );
+                        partners[i] = c_noPartner;
+                        nextPending[i] = c_noPartner;
+                        if( ownSlot == c_noPartner )
+                        {
+                            ownSlot = slot;
+                            table[ownSlot].key = key;
+                        }
+
+                        PendingList &pending = table[ownSlot];
+                        if( pending.head == c_noPartner )
+                            pending.head = halfEdgeIdx;
+                        else
+                            nextPending[pending.tail] = halfEdgeIdx;
+                        pending.tail = halfEdgeIdx;
+                    }
+                }
+            }
+
+            void executePhase( size_t threadIdx )
+            {
+                switch( phase )
+                {
+                case PhaseGatherCorners:
+                    gatherCorners( threadIdx );
+                    break;
+                case PhaseWeldCorners:
+                    weldCorners( threadIdx );
+                    break;
+                case PhaseConnectHalfEdges:
+                    connectHalfEdges( threadIdx );
+                    break;
+                }
+            }
+
+            /// Small workloads may use fewer threads than the SceneManager has
+            void execute( size_t threadIdx, size_t numWorkerThreads ) override
+            {
+                OGRE_ASSERT_LOW( numThreads <= numWorkerThreads );
+                if( threadIdx < numThreads )
+                    executePhase( threadIdx );
+            }
+
+            void run( Phase _phase, size_t _numThreads, SceneManager *sceneManager )
+            {
+                phase = _phase;
+                numThreads = _numThreads;
+                if( numThreads > 1u )
+                    sceneManager->executeUserScalableTask( this, true );
+                else
+                    executePhase( 0u );
+            }
+        };
+        //---------------------------------------------------------------------
+        EdgeListBuilder::EdgeListBuilder() : mEdgeData( 0 ), mSceneManager( 0 ) {}
         //---------------------------------------------------------------------
         EdgeListBuilder::~EdgeListBuilder() {}
         //---------------------------------------------------------------------
@@ -141,6 +433,11 @@ namespace Ogre
             Note that all edges 'belong' to the index set which originally caused them
             to be created, which also means that the 2 vertices on the edge are both referencing the
             vertex buffer which this index set uses.
+
+            The lookups are done with hash maps. Looking up positions and edges can be split
+            across threads because each thread owns a disjoint set of hashes, and merging
+            their findings in the original order gives exactly the same result as doing
+            everything in one go.
             */
 
             /*
@@ -186,226 +483,227 @@ namespace Ogre
                 mEdgeData->edgeGroups[vSet].triStart = 0;
                 mEdgeData->edgeGroups[vSet].triCount = 0;
             }
-
-            // Build triangles and edge list
-            GeometryList::const_iterator i, iend;
-            iend = mGeometryList.end();
-            for( i = mGeometryList.begin(); i != iend; ++i )
+            mVertices.clear();
+
+            // Count the triangles of every geometry
+            vector<size_t>::type geometryTriStarts;
+            geometryTriStarts.reserve( mGeometryList.size() + 1u );
+            size_t numRawTriangles = 0;
+            GeometryList::const_iterator itGeom, enGeom;
+            enGeom = mGeometryList.end();
+            for( itGeom = mGeometryList.begin(); itGeom != enGeom; ++itGeom )
             {
-                buildTrianglesEdges( *i );
+                geometryTriStarts.push_back( numRawTriangles );
+                const size_t indexCount = itGeom->indexData->indexCount;
+                if( itGeom->opType == OT_TRIANGLE_LIST )
+                    numRawTriangles += indexCount / 3u;
+                else if( indexCount >= 3u )
+                    numRawTriangles += indexCount - 2u;
             }
+            geometryTriStarts.push_back( numRawTriangles );
 
-            // Allocate memory for light facing calculate
-            mEdgeData->triangleLightFacings.resize( mEdgeData->triangles.size() );
-
-            // Record closed, ie the mesh is manifold
-            mEdgeData->isClosed = mEdgeMap.empty();
+            EdgeListBuildJob job;
+            job.cornerPositions.resize( numRawTriangles * 3u );
+            job.cornerVertIndices.resize( numRawTriangles * 3u );
+            job.cornerHashes.resize( numRawTriangles * 3u );
+            job.firstCorners.resize( numRawTriangles * 3u );
 
-            return mEdgeData;
-        }
-        //---------------------------------------------------------------------
-        void EdgeListBuilder::buildTrianglesEdges( const Geometry &geometry )
-        {
-            size_t indexSet = geometry.indexSet;
-            size_t vertexSet = geometry.vertexSet;
-            const IndexData *indexData = geometry.indexData;
-            OperationType opType = geometry.opType;
+            // Read the vertices of all triangles. Geometries are locked one at a time
+            // as they may share buffers.
+            for( size_t g = 0; g < mGeometryList.size(); ++g )
+            {
+                const Geometry &geometry = mGeometryList[g];
+                const IndexData *indexData = geometry.indexData;
 
-            size_t iterations;
+                job.triStart = geometryTriStarts[g];
+                job.triCount = geometryTriStarts[g + 1u] - job.triStart;
+                if( !job.triCount )
+                    continue;
 
-            switch( opType )
-            {
-            case OT_TRIANGLE_LIST:
-                iterations = indexData->indexCount / 3;
-                break;
-            case OT_TRIANGLE_FAN:
-            case OT_TRIANGLE_STRIP:
-                iterations = indexData->indexCount - 2;
-                break;
-            default:
-                return;  // Just in case
-            };
+                // locate position element & the buffer to go with it
+                const VertexData *vertexData = mVertexDataList[geometry.vertexSet];
+                const VertexElement *posElem =
+                    vertexData->vertexDeclaration->findElementBySemantic( VES_POSITION );
+                HardwareVertexBufferSharedPtr vbuf =
+                    vertexData->vertexBufferBinding->getBuffer( posElem->getSource() );
+                // lock the buffer for reading
+                HardwareBufferLockGuard vertexLock( vbuf, HardwareBuffer::HBL_READ_ONLY );
 
-            // The edge group now we are dealing with.
-            EdgeData::EdgeGroup &eg = mEdgeData->edgeGroups[vertexSet];
-
-            // locate position element & the buffer to go with it
-            const VertexData *vertexData = mVertexDataList[vertexSet];
-            const VertexElement *posElem =
-                vertexData->vertexDeclaration->findElementBySemantic( VES_POSITION );
-            HardwareVertexBufferSharedPtr vbuf =
-                vertexData->vertexBufferBinding->getBuffer( posElem->getSource() );
-            // lock the buffer for reading
-            HardwareBufferLockGuard vertexLock( vbuf, HardwareBuffer::HBL_READ_ONLY );
-            unsigned char *pBaseVertex = static_cast<unsigned char *>( vertexLock.pData );
-
-            // Get the indexes ready for reading
-            bool idx32bit = ( indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT );
-            HardwareBufferLockGuard indexLock( indexData->indexBuffer, HardwareBuffer::HBL_READ_ONLY );
-            unsigned short *p16Idx =
-                static_cast<unsigned short *>( indexLock.pData ) + indexData->indexStart;
-            unsigned int *p32Idx =
-                static_cast<unsigned int *>( indexLock.pData ) + indexData->indexStart;
-
-            // Iterate over all the groups of 3 indexes
-            unsigned int index[3];
-            // Get the triangle start, if we have more than one index set then this
-            // will not be zero
-            size_t triangleIndex = mEdgeData->triangles.size();
-            // If it's first time dealing with the edge group, setup triStart for it.
-            // Note that we are assume geometries sorted by vertex set.
-            if( !eg.triCount )
-            {
-                eg.triStart = triangleIndex;
+                // Get the indexes ready for reading
+                HardwareBufferLockGuard indexLock( indexData->indexBuffer,
+                                                   HardwareBuffer::HBL_READ_ONLY );
+                job.idx32bit = indexData->indexBuffer->getType() == HardwareIndexBuffer::IT_32BIT;
+                job.indexData = static_cast<const uint8 *>( indexLock.pData ) +
+                                indexData->indexStart * indexData->indexBuffer->getIndexSize();
+                job.opType = geometry.opType;
+                job.vertexData = static_cast<const uint8 *>( vertexLock.pData );
+                job.vertexSize = vbuf->getVertexSize();
+                job.positionOffset = posElem->getOffset();
+
+                job.run( EdgeListBuildJob::PhaseGatherCorners, calculateNumThreads( job.triCount ),
+                         mSceneManager );
             }
-            // Pre-reserve memory for less thrashing
-            mEdgeData->triangles.reserve( triangleIndex + iterations );
-            mEdgeData->triangleFaceNormals.reserve( triangleIndex + iterations );
-            for( size_t t = 0; t < iterations; ++t )
-            {
-                EdgeData::Triangle tri;
-                tri.indexSet = indexSet;
-                tri.vertexSet = vertexSet;
 
-                if( opType == OT_TRIANGLE_LIST || t == 0 )
+            job.run( EdgeListBuildJob::PhaseWeldCorners, calculateNumThreads( numRawTriangles ),
+                     mSceneManager );
+
+            // Assign common vertices in order of appearance, and keep the non-degenerate triangles
+            vector<uint32>::type sharedVertIndices;
+            sharedVertIndices.resize( numRawTriangles * 3u );
+            mEdgeData->triangles.reserve( numRawTriangles );
+            mEdgeData->triangleFaceNormals.reserve( numRawTriangles );
+            job.halfEdgeSharedVertIndices.reserve( numRawTriangles * 6u );
+            job.halfEdgeHashes.reserve( numRawTriangles * 3u );
+
+            for( size_t g = 0; g < mGeometryList.size(); ++g )
+            {
+                const Geometry &geometry = mGeometryList[g];
+                // The edge group now we are dealing with.
+                EdgeData::EdgeGroup &eg = mEdgeData->edgeGroups[geometry.vertexSet];
+
+                // Get the triangle start, if we have more than one index set then this
+                // will not be zero
+                size_t triangleIndex = mEdgeData->triangles.size();
+                // If it's first time dealing with the edge group, setup triStart for it.
+                // Note that we are assume geometries sorted by vertex set.
+                if( !eg.triCount )
+                    eg.triStart = triangleIndex;
+
+                const size_t rawTriEnd = geometryTriStarts[g + 1u];
+                for( size_t t = geometryTriStarts[g]; t < rawTriEnd; ++t )
                 {
-                    // Standard 3-index read for tri list or first tri in strip / fan
-                    if( idx32bit )
+                    EdgeData::Triangle tri;
+                    tri.indexSet = geometry.indexSet;
+                    tri.vertexSet = geometry.vertexSet;
+
+                    for( size_t i = 0; i < 3u; ++i )
                     {
-                        index[0] = p32Idx[0];
-                        index[1] = p32Idx[1];
-                        index[2] = p32Idx[2];
-                        p32Idx += 3;
+                        const size_t cornerIdx = t * 3u + i;
+                        const uint32 firstCorner = job.firstCorners[cornerIdx];
+                        if( firstCorner == cornerIdx )
+                        {
+                            // Not found, create new common vertex
+                            CommonVertex newCommon;
+                            newCommon.index = mVertices.size();
+                            newCommon.position = job.cornerPositions[cornerIdx];
+                            newCommon.vertexSet = geometry.vertexSet;
+                            newCommon.indexSet = geometry.indexSet;
+                            newCommon.originalIndex = job.cornerVertIndices[cornerIdx];
+                            mVertices.push_back( newCommon );
+                            sharedVertIndices[cornerIdx] = static_cast<uint32>( newCommon.index );
+                        }
+                        else
+                        {
+                            sharedVertIndices[cornerIdx] = sharedVertIndices[firstCorner];
+                        }
+
+                        tri.vertIndex[i] = job.cornerVertIndices[cornerIdx];
+                        tri.sharedVertIndex[i] = sharedVertIndices[cornerIdx];
                     }
-                    else
+
+                    // Ignore degenerate triangle
+                    if( tri.sharedVertIndex[0] != tri.sharedVertIndex[1] &&
+                        tri.sharedVertIndex[1] != tri.sharedVertIndex[2] &&
+                        tri.sharedVertIndex[2] != tri.sharedVertIndex[0] )
                     {
-                        index[0] = p16Idx[0];
-                        index[1] = p16Idx[1];
-                        index[2] = p16Idx[2];
-                        p16Idx += 3;
+                        // Calculate triangle normal (NB will require recalculation for
+                        // skeletally animated meshes)
+                        const Vector3 *v = &job.cornerPositions[t * 3u];
+                        mEdgeData->triangleFaceNormals.push_back(
+                            Math::calculateFaceNormalWithoutNormalize( v[0], v[1], v[2] ) );
+                        // Add triangle to list
+                        mEdgeData->triangles.push_back( tri );
+
+                        for( size_t i = 0; i < 3u; ++i )
+                        {
+                            const size_t next = ( i + 1u ) % 3u;
+                            const uint32 v0 = static_cast<uint32>( tri.sharedVertIndex[i] );
+                            const uint32 v1 = static_cast<uint32>( tri.sharedVertIndex[next] );
+                            job.halfEdgeSharedVertIndices.push_back( v0 );
+                            job.halfEdgeSharedVertIndices.push_back( v1 );
+                            job.halfEdgeHashes.push_back( hashEdge( v0, v1 ) );
+                        }
+                        ++triangleIndex;
                     }
                 }
-                else
-                {
-                    // Strips are formed from last 2 indexes plus the current one for
-                    // triangles after the first.
-                    // For fans, all the triangles share the first vertex, plus last
-                    // one index and the current one for triangles after the first.
-                    // We also make sure that all the triangles are process in the
-                    // _anti_ clockwise orientation
-                    index[( opType == OT_TRIANGLE_STRIP ) && ( t & 1 ) ? 0 : 1] = index[2];
-                    // Read for the last tri index
-                    if( idx32bit )
-                        index[2] = *p32Idx++;
-                    else
-                        index[2] = *p16Idx++;
-                }
-
-                Vector3 v[3];
-                for( size_t i = 0; i < 3; ++i )
-                {
-                    // Populate tri original vertex index
-                    tri.vertIndex[i] = index[i];
-
-                    // Retrieve the vertex position
-                    unsigned char *pVertex = pBaseVertex + ( index[i] * vbuf->getVertexSize() );
-                    float *pFloat;
-                    posElem->baseVertexPointerToElement( pVertex, &pFloat );
-                    v[i].x = *pFloat++;
-                    v[i].y = *pFloat++;
-                    v[i].z = *pFloat++;
-                    // find this vertex in the existing vertex map, or create it
-                    tri.sharedVertIndex[i] =
-                        findOrCreateCommonVertex( v[i], vertexSet, indexSet, index[i] );
-                }
 
-                // Ignore degenerate triangle
-                if( tri.sharedVertIndex[0] != tri.sharedVertIndex[1] &&
-                    tri.sharedVertIndex[1] != tri.sharedVertIndex[2] &&
-                    tri.sharedVertIndex[2] != tri.sharedVertIndex[0] )
-                {
-                    // Calculate triangle normal (NB will require recalculation for
-                    // skeletally animated meshes)
-                    mEdgeData->triangleFaceNormals.push_back(
-                        Math::calculateFaceNormalWithoutNormalize( v[0], v[1], v[2] ) );
-                    // Add triangle to list
-                    mEdgeData->triangles.push_back( tri );
-                    // Connect or create edges from common list
-                    connectOrCreateEdge( vertexSet, triangleIndex, tri.vertIndex[0], tri.vertIndex[1],
-                                         tri.sharedVertIndex[0], tri.sharedVertIndex[1] );
-                    connectOrCreateEdge( vertexSet, triangleIndex, tri.vertIndex[1], tri.vertIndex[2],
-                                         tri.sharedVertIndex[1], tri.sharedVertIndex[2] );
-                    connectOrCreateEdge( vertexSet, triangleIndex, tri.vertIndex[2], tri.vertIndex[0],
-                                         tri.sharedVertIndex[2], tri.sharedVertIndex[0] );
-                    ++triangleIndex;
-                }
+                // Update triCount for the edge group. Note that we are assume
+                // geometries sorted by vertex set.
+                eg.triCount = triangleIndex - eg.triStart;
             }
 
-            // Update triCount for the edge group. Note that we are assume
-            // geometries sorted by vertex set.
-            eg.triCount = triangleIndex - eg.triStart;
-        }
-        //---------------------------------------------------------------------
-        void EdgeListBuilder::connectOrCreateEdge( size_t vertexSet, size_t triangleIndex,
-                                                   size_t vertIndex0, size_t vertIndex1,
-                                                   size_t sharedVertIndex0, size_t sharedVertIndex1 )
-        {
-            // Find the existing edge (should be reversed order) on shared vertices
-            EdgeMap::iterator emi =
-                mEdgeMap.find( std::pair<size_t, size_t>( sharedVertIndex1, sharedVertIndex0 ) );
-            if( emi != mEdgeMap.end() )
+            // Connect or create edges from common list
+            const size_t numHalfEdges = job.halfEdgeHashes.size();
+            job.partners.resize( numHalfEdges );
+            job.nextPending.resize( numHalfEdges );
+            job.run( EdgeListBuildJob::PhaseConnectHalfEdges,
+                     calculateNumThreads( mEdgeData->triangles.size() ), mSceneManager );
+
+            // Create the edges in the order they were first seen.
+            // Reuse nextPending to store where each created edge went.
+            vector<uint32>::type &edgeIndices = job.nextPending;
+            vector<size_t>::type numEdgesPerGroup( mEdgeData->edgeGroups.size(), 0u );
+            for( size_t i = 0; i < numHalfEdges; ++i )
             {
-                // The edge already exist, connect it
-                EdgeData::Edge &e = mEdgeData->edgeGroups[emi->second.first].edges[emi->second.second];
-                // update with second side
-                e.triIndex[1] = triangleIndex;
-                e.degenerate = false;
-
-                // Remove from the edge map, so we never supplied to connect edge again
-                mEdgeMap.erase( emi );
+                if( job.partners[i] == c_noPartner )
+                    ++numEdgesPerGroup[mEdgeData->triangles[i / 3u].vertexSet];
             }
-            else
+            for( size_t i = 0; i < numEdgesPerGroup.size(); ++i )
+                mEdgeData->edgeGroups[i].edges.reserve( numEdgesPerGroup[i] );
+
+            size_t numOpenEdges = 0;
+            for( size_t i = 0; i < numHalfEdges; ++i )
             {
-                // Not found, create new edge
-                mEdgeMap.emplace( std::pair<size_t, size_t>( sharedVertIndex0, sharedVertIndex1 ),
-                                  std::pair<size_t, size_t>(
-                                      vertexSet, mEdgeData->edgeGroups[vertexSet].edges.size() ) );
-                EdgeData::Edge e;
-                e.degenerate = true;  // initialise as degenerate
-
-                // Set only first tri, the other will be completed in connect existing edge
-                e.triIndex[0] = triangleIndex;
-                e.triIndex[1] = static_cast<size_t>( ~0 );
-                e.sharedVertIndex[0] = sharedVertIndex0;
-                e.sharedVertIndex[1] = sharedVertIndex1;
-                e.vertIndex[0] = vertIndex0;
-                e.vertIndex[1] = vertIndex1;
-                mEdgeData->edgeGroups[vertexSet].edges.push_back( e );
+                const size_t triangleIndex = i / 3u;
+                const EdgeData::Triangle &tri = mEdgeData->triangles[triangleIndex];
+                const uint32 partner = job.partners[i];
+                if( partner != c_noPartner )
+                {
+                    // The edge already exist, connect it
+                    const size_t vertexSet = mEdgeData->triangles[partner / 3u].vertexSet;
+                    EdgeData::Edge &e = mEdgeData->edgeGroups[vertexSet].edges[edgeIndices[partner]];
+                    // update with second side
+                    e.triIndex[1] = triangleIndex;
+                    e.degenerate = false;
+                    --numOpenEdges;
+                }
+                else
+                {
+                    // Not found, create new edge
+                    EdgeData::EdgeList &edges = mEdgeData->edgeGroups[tri.vertexSet].edges;
+                    edgeIndices[i] = static_cast<uint32>( edges.size() );
+
+                    EdgeData::Edge e;
+                    e.degenerate = true;  // initialise as degenerate
+
+                    // Set only first tri, the other will be completed in connect existing edge
+                    e.triIndex[0] = triangleIndex;
+                    e.triIndex[1] = static_cast<size_t>( ~0 );
+                    e.sharedVertIndex[0] = tri.sharedVertIndex[i % 3u];
+                    e.sharedVertIndex[1] = tri.sharedVertIndex[( i + 1u ) % 3u];
+                    e.vertIndex[0] = tri.vertIndex[i % 3u];
+                    e.vertIndex[1] = tri.vertIndex[( i + 1u ) % 3u];
+                    edges.push_back( e );
+                    ++numOpenEdges;
+                }
             }
+
+            // Allocate memory for light facing calculate
+            mEdgeData->triangleLightFacings.resize( mEdgeData->triangles.size() );
+
+            // Record closed, ie the mesh is manifold
+            mEdgeData->isClosed = numOpenEdges == 0u;
+
+            return mEdgeData;
         }
         //---------------------------------------------------------------------
-        size_t EdgeListBuilder::findOrCreateCommonVertex( const Vector3 &vec, size_t vertexSet,
-                                                          size_t indexSet, size_t originalIndex )
+        size_t EdgeListBuilder::calculateNumThreads( size_t numTriangles ) const
         {
-            // Because the algorithm doesn't care about manifold or not, we just identifying
-            // the common vertex by EXACT same position.
-            // Hint: We can use quantize method for welding almost same position vertex fastest.
-            std::pair<CommonVertexMap::iterator, bool> inserted =
-                mCommonVertexMap.emplace( vec, mVertices.size() );
-            if( !inserted.second )
-            {
-                // Already existing, return old one
-                return inserted.first->second;
-            }
-            // Not found, insert
-            CommonVertex newCommon;
-            newCommon.index = mVertices.size();
-            newCommon.position = vec;
-            newCommon.vertexSet = vertexSet;
-            newCommon.indexSet = indexSet;
-            newCommon.originalIndex = originalIndex;
-            mVertices.push_back( newCommon );
-            return newCommon.index;
+            if( !mSceneManager )
+                return 1u;
+            const size_t numThreads =
+                std::min( mSceneManager->getNumWorkerThreads(), numTriangles / c_minTrianglesPerThread );
+            return std::max<size_t>( numThreads, 1u );
         }
         //---------------------------------------------------------------------
         //---------------------------------------------------------------------
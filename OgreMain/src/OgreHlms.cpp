@@ -94,6 +94,7 @@ namespace Ogre
     const IdString HlmsBaseProp::PoseNormals = IdString( "hlms_pose_normals" );
 
     const IdString HlmsBaseProp::Normal = IdString( "hlms_normal" );
+    const IdString HlmsBaseProp::OctahedralNormal = IdString( "hlms_octahedral_normal" );
     const IdString HlmsBaseProp::QTangent = IdString( "hlms_qtangent" );
     const IdString HlmsBaseProp::Tangent = IdString( "hlms_tangent" );
     const IdString HlmsBaseProp::Tangent4 = IdString( "hlms_tangent4" );
@@ -3016,6 +3017,8 @@ namespace Ogre
             if( v1::VertexElement::getTypeCount( type ) < 4 )
             {
                 setProperty( kNoTid, HlmsBaseProp::Normal, 1 );
+                if( v1::VertexElement::getTypeCount( type ) == 2 )
+                    setProperty( kNoTid, HlmsBaseProp::OctahedralNormal, 1 );
             }
             else
             {
@@ -3158,6 +3161,7 @@ namespace Ogre
 
         // For shadow casters, turn normals off. UVs & diffuse also off unless there's alpha testing.
         setProperty( kNoTid, HlmsBaseProp::Normal, 0 );
+        setProperty( kNoTid, HlmsBaseProp::OctahedralNormal, 0 );
         setProperty( kNoTid, HlmsBaseProp::QTangent, 0 );
         setProperty( kNoTid, HlmsBaseProp::AlphaBlend,
                      datablock->getBlendblock( true )->isAutoTransparent() );
@@ -67,10 +67,10 @@ namespace Ogre
     //-----------------------------------------------------------------------
     void Item::loadingComplete( Resource *res )
     {
-        if( res == mMesh.get() && mInitialised )
-        {
-            _initialise( true );
-        }
+        // When the mesh was still loading (e.g. MeshManager::loadAsync)
+        // we're not initialised yet, so do it now
+        if( res == mMesh.get() )
+            _initialise( mInitialised );
     }
     //-----------------------------------------------------------------------
     void Item::_initialise( bool forceReinitialise /*= false*/, bool bUseMeshMat /*= true */ )
@@ -105,6 +105,7 @@ namespace Ogre
         {
             const SkeletonDef *skeletonDef = mMesh->getSkeleton().get();
             mSkeletonInstance = mManager->createSkeletonInstance( skeletonDef );
+            mSkeletonInstance->setAnimationLodSource( this );
         }
 
         mLodMesh = mMesh->_getLodValueArray();
@@ -148,6 +149,8 @@ namespace Ogre
         assert( mManager || !mSkeletonInstance );
         if( mSkeletonInstance )
         {
+            if( mSkeletonInstance->getAnimationLodSource() == this )
+                mSkeletonInstance->setAnimationLodSource( 0 );
             mSkeletonInstance->_decrementRefCount();
             if( mSkeletonInstance->_getRefCount() == 0u )
                 mManager->destroySkeletonInstance( mSkeletonInstance );
@@ -255,6 +258,8 @@ namespace Ogre
 
         if( mSkeletonInstance )
         {
+            if( mSkeletonInstance->getAnimationLodSource() == this )
+                mSkeletonInstance->setAnimationLodSource( 0 );
             mSkeletonInstance->_decrementRefCount();
             if( mSkeletonInstance->_getRefCount() == 0u )
                 mManager->destroySkeletonInstance( mSkeletonInstance );
@@ -271,12 +276,15 @@ namespace Ogre
             assert( mSkeletonInstance->_getRefCount() > 1u &&
                     "This skeleton is Item is not sharing its skeleton!" );
 
+            if( mSkeletonInstance->getAnimationLodSource() == this )
+                mSkeletonInstance->setAnimationLodSource( 0 );
             mSkeletonInstance->_decrementRefCount();
             if( mSkeletonInstance->_getRefCount() == 0u )
                 mManager->destroySkeletonInstance( mSkeletonInstance );
 
             const SkeletonDef *skeletonDef = mMesh->getSkeleton().get();
             mSkeletonInstance = mManager->createSkeletonInstance( skeletonDef );
+            mSkeletonInstance->setAnimationLodSource( this );
         }
     }
     //-----------------------------------------------------------------------
@@ -290,6 +298,8 @@ namespace Ogre
         OGRE_ASSERT_LOW( !sharesSkeletonInstance() );
         if( mSkeletonInstance && !bEnable )
         {
+            if( mSkeletonInstance->getAnimationLodSource() == this )
+                mSkeletonInstance->setAnimationLodSource( 0 );
             mSkeletonInstance->_decrementRefCount();
             if( mSkeletonInstance->_getRefCount() == 0u )
                 mManager->destroySkeletonInstance( mSkeletonInstance );
@@ -314,6 +324,7 @@ namespace Ogre
         {
             const SkeletonDef *skeletonDef = mMesh->getSkeleton().get();
             mSkeletonInstance = mManager->createSkeletonInstance( skeletonDef );
+            mSkeletonInstance->setAnimationLodSource( this );
             for( SubItem &subitem : mSubItems )
             {
                 HlmsDatablock *oldDatablock = subitem.getDatablock();
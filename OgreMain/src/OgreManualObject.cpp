@@ -879,6 +879,7 @@ namespace Ogre
             if( !mEdgeList && mAnyIndexed )
             {
                 EdgeListBuilder eb;
+                eb.setSceneManager( mManager );
                 size_t vertexSet = 0;
                 bool anyBuilt = false;
                 for( SectionList::iterator i = mSectionList.begin(); i != mSectionList.end(); ++i )
@@ -183,6 +183,11 @@ namespace Ogre
 
         serializer.importMesh( data, this );
 
+        applyTimestampAsHash();
+    }
+    //-----------------------------------------------------------------------
+    void Mesh::applyTimestampAsHash()
+    {
         if( mHashForCaches[0] == 0u && mHashForCaches[1] == 0u && Mesh::msUseTimestampAsHash )
         {
             try
@@ -201,6 +206,76 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------
+    bool Mesh::_beginAsyncLoad()
+    {
+        if( mIsManual )
+            return false;
+
+        const LoadingState oldState = mLoadingState.get();
+        if( oldState != LOADSTATE_UNLOADED && oldState != LOADSTATE_PREPARED )
+            return false;
+        if( !mLoadingState.cas( oldState, LOADSTATE_LOADING ) )
+            return false;
+
+        if( mGroup == ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME )
+        {
+            try
+            {
+                changeGroupOwnership(
+                    ResourceGroupManager::getSingleton().findGroupContainingResource( mName ) );
+            }
+            catch( Exception & )
+            {
+                mLoadingState.set( oldState );
+                throw;
+            }
+        }
+
+        // Makes load() a no-op so that nobody blocks waiting for us
+        mIsBackgroundLoaded = true;
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    void Mesh::_parseAsyncLoad( MeshSerializer &serializer )
+    {
+        OgreProfileExhaustive( "Mesh2::_parseAsyncLoad" );
+
+        if( !mFreshFromDisk )
+            prepareImpl();
+
+        DataStreamPtr data( mFreshFromDisk );
+        mFreshFromDisk.reset();
+
+        serializer.importMeshDeferred( data, this );
+    }
+    //-----------------------------------------------------------------------
+    void Mesh::_finishAsyncLoad( MeshSerializer &serializer )
+    {
+        OgreProfileExhaustive( "Mesh2::_finishAsyncLoad" );
+
+        serializer.finishDeferredImport( this );
+        applyTimestampAsHash();
+        postLoadImpl();
+
+        mSize = calculateSize();
+        mIsBackgroundLoaded = false;
+        mLoadingState.set( LOADSTATE_LOADED );
+        _dirtyState();
+
+        if( mCreator )
+            mCreator->_notifyResourceLoaded( this );
+
+        _fireLoadingComplete( false );
+    }
+    //-----------------------------------------------------------------------
+    void Mesh::_abortAsyncLoad()
+    {
+        mFreshFromDisk.reset();
+        unloadImpl();
+        mIsBackgroundLoaded = false;
+        mLoadingState.set( LOADSTATE_UNLOADED );
+    }
+    //-----------------------------------------------------------------------
     void Mesh::unloadImpl()
     {
         OgreProfileExhaustive( "Mesh2::unloadImpl" );
@@ -491,6 +566,19 @@ namespace Ogre
     //---------------------------------------------------------------------
     void Mesh::importV1( v1::Mesh *mesh, bool halfPos, bool halfTexCoords, bool qTangents,
                          bool halfPose )
+    {
+        importV1Impl( mesh, halfPos, halfTexCoords, qTangents, halfPose, 0 );
+    }
+    //---------------------------------------------------------------------
+    void Mesh::importV1( v1::Mesh *mesh, const VertexQuantizationSettings &quantization,
+                         bool halfPose )
+    {
+        // QTangents are always used when the mesh has tangents.
+        importV1Impl( mesh, false, false, true, halfPose, &quantization );
+    }
+    //---------------------------------------------------------------------
+    void Mesh::importV1Impl( v1::Mesh *mesh, bool halfPos, bool halfTexCoords, bool qTangents,
+                             bool halfPose, const VertexQuantizationSettings *quantization )
     {
         OgreProfileExhaustive( "Mesh2::importV1" );
 
@@ -516,7 +604,7 @@ namespace Ogre
 
         try
         {
-            if( qTangents )
+            if( quantization ? quantization->generateTangents : qTangents )
             {
                 unsigned short sourceCoordSet;
                 unsigned short index;
@@ -533,7 +621,8 @@ namespace Ogre
         for( unsigned i = 0; i < mesh->getNumSubMeshes(); ++i )
         {
             SubMesh *subMesh = createSubMesh();
-            subMesh->importFromV1( mesh->getSubMesh( i ), halfPos, halfTexCoords, qTangents, halfPose );
+            subMesh->importFromV1( mesh->getSubMesh( i ), halfPos, halfTexCoords, qTangents, halfPose,
+                                   quantization );
         }
 
         mSubMeshNameMap = mesh->getSubMeshNameMap();
@@ -567,12 +656,57 @@ namespace Ogre
             submesh->arrangeEfficient( halfPos, halfTexCoords, qTangents );
     }
     //---------------------------------------------------------------------
+    void Mesh::arrangeEfficient( const VertexQuantizationSettings &quantization )
+    {
+        OgreProfileExhaustive( "Mesh2::arrangeEfficient" );
+
+        for( SubMesh *submesh : mSubMeshes )
+            submesh->arrangeEfficient( quantization );
+    }
+    //---------------------------------------------------------------------
     void Mesh::dearrangeToInefficient()
     {
         for( SubMesh *submesh : mSubMeshes )
             submesh->dearrangeToInefficient();
     }
     //---------------------------------------------------------------------
+    void Mesh::optimizeVertexCache( bool overdraw, bool vertexFetch, float overdrawThreshold )
+    {
+        OgreProfileExhaustive( "Mesh2::optimizeVertexCache" );
+
+        for( SubMesh *submesh : mSubMeshes )
+            submesh->optimizeVertexCache( overdraw, vertexFetch, overdrawThreshold );
+    }
+    //---------------------------------------------------------------------
+    void Mesh::buildMeshlets( uint32 maxVertices, uint32 maxTriangles )
+    {
+        OgreProfileExhaustive( "Mesh2::buildMeshlets" );
+
+        for( SubMesh *submesh : mSubMeshes )
+            submesh->buildMeshlets( maxVertices, maxTriangles );
+    }
+    //---------------------------------------------------------------------
+    bool Mesh::hasMeshlets() const
+    {
+        for( const SubMesh *submesh : mSubMeshes )
+        {
+            if( submesh->hasMeshlets() )
+                return true;
+        }
+
+        return false;
+    }
+    //---------------------------------------------------------------------
+    MeshOptimizer::VertexCacheStats Mesh::analyzeVertexCache( uint32 cacheSize ) const
+    {
+        MeshOptimizer::VertexCacheStats stats;
+
+        for( const SubMesh *submesh : mSubMeshes )
+            stats += submesh->analyzeVertexCache( cacheSize );
+
+        return stats;
+    }
+    //---------------------------------------------------------------------
     void Mesh::prepareForShadowMapping( bool forceSameBuffers )
     {
         OgreProfileExhaustive( "Mesh2::prepareForShadowMapping" );
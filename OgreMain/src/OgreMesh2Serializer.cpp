@@ -39,17 +39,29 @@ namespace Ogre
 {
     const unsigned short HEADER_CHUNK_ID = 0x1000;
     //---------------------------------------------------------------------
-    MeshSerializer::MeshSerializer( VaoManager *vaoManager ) : mListener( 0 )
+    MeshSerializer::MeshSerializer( VaoManager *vaoManager ) :
+        mListener( 0 ),
+        mImplV3( 0 ),
+        mDeferredImpl( 0 )
     {
         // Init implementations
         // String identifiers have not always been 100% unified with OGRE version
 
         // Note MUST be added in reverse order so latest is first in the list
 
-        mVersionData.push_back( OGRE_NEW MeshVersionData( MESH_VERSION_2_1, "[MeshSerializer_v2.1 R2]",
+        mVersionData.push_back( OGRE_NEW MeshVersionData( MESH_VERSION_2_1, "[MeshSerializer_v2.1 R3]",
                                                           OGRE_NEW MeshSerializerImpl( vaoManager ) ) );
 
+        // Opt-in; it's not the latest so that exports don't default to it
+        mImplV3 = OGRE_NEW MeshSerializerImpl_v3_0( vaoManager );
+        mVersionData.push_back(
+            OGRE_NEW MeshVersionData( MESH_VERSION_3_0, "[MeshSerializer_v3.0]", mImplV3 ) );
+
         // These formats will be removed on release
+        mVersionData.push_back(
+            OGRE_NEW MeshVersionData( MESH_VERSION_LEGACY, "[MeshSerializer_v2.1 R2]",
+                                      OGRE_NEW MeshSerializerImpl_v2_1_R2( vaoManager ) ) );
+
         mVersionData.push_back(
             OGRE_NEW MeshVersionData( MESH_VERSION_LEGACY, "[MeshSerializer_v2.1 R1]",
                                       OGRE_NEW MeshSerializerImpl_v2_1_R1( vaoManager ) ) );
@@ -133,7 +145,7 @@ namespace Ogre
         impl->exportMesh( pMesh, stream, endianMode );
     }
     //---------------------------------------------------------------------
-    void MeshSerializer::importMesh( DataStreamPtr &stream, Mesh *pDest )
+    MeshSerializerImpl *MeshSerializer::getImplForImport( DataStreamPtr &stream, Mesh *pDest )
     {
         determineEndianness( stream );
 
@@ -154,16 +166,13 @@ namespace Ogre
         stream->seek( 0 );
 
         // Find the implementation to use
-        MeshSerializerImpl *impl = 0;
-        for( MeshVersionDataList::iterator i = mVersionData.begin(); i != mVersionData.end(); ++i )
+        MeshVersionDataList::const_iterator itVersion = mVersionData.begin();
+        for( ; itVersion != mVersionData.end(); ++itVersion )
         {
-            if( ( *i )->versionString == ver )
-            {
-                impl = ( *i )->impl;
+            if( ( *itVersion )->versionString == ver )
                 break;
-            }
         }
-        if( !impl )
+        if( itVersion == mVersionData.end() )
         {
             OGRE_EXCEPT( Exception::ERR_INTERNAL_ERROR,
                          "Cannot find serializer implementation for "
@@ -172,10 +181,8 @@ namespace Ogre
                          "MeshSerializer::importMesh" );
         }
 
-        // Call implementation
-        impl->importMesh( stream, pDest, mListener );
         // Warn on old version of mesh
-        if( ver != mVersionData[0]->versionString )
+        if( ( *itVersion )->version == MESH_VERSION_LEGACY )
         {
             LogManager::getSingleton().logMessage(
                 "WARNING: " + pDest->getName() + " is an older format (" + ver +
@@ -183,10 +190,58 @@ namespace Ogre
                 LML_CRITICAL );
         }
 
+        return ( *itVersion )->impl;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializer::importMesh( DataStreamPtr &stream, Mesh *pDest )
+    {
+        MeshSerializerImpl *impl = getImplForImport( stream, pDest );
+
+        // Call implementation
+        impl->importMesh( stream, pDest, mListener );
+
         if( mListener )
             mListener->processMeshCompleted( pDest );
     }
     //---------------------------------------------------------------------
+    void MeshSerializer::importMeshDeferred( DataStreamPtr &stream, Mesh *pDest )
+    {
+        if( mDeferredImpl )
+        {
+            mDeferredImpl->discardDeferredImport();
+            mDeferredImpl = 0;
+        }
+
+        MeshSerializerImpl *impl = getImplForImport( stream, pDest );
+        impl->importMeshDeferred( stream, pDest, mListener );
+        mDeferredImpl = impl;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializer::finishDeferredImport( Mesh *pDest )
+    {
+        if( !mDeferredImpl )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "importMeshDeferred wasn't called or already finished for " +
+                             pDest->getName(),
+                         "MeshSerializer::finishDeferredImport" );
+        }
+
+        MeshSerializerImpl *impl = mDeferredImpl;
+        mDeferredImpl = 0;
+        impl->finishDeferredImport( pDest );
+
+        if( mListener )
+            mListener->processMeshCompleted( pDest );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializer::setCompressPayloads( bool bCompress )
+    {
+        mImplV3->setCompressPayloads( bCompress );
+    }
+    //---------------------------------------------------------------------
+    bool MeshSerializer::getCompressPayloads() const { return mImplV3->getCompressPayloads(); }
+    //---------------------------------------------------------------------
     void MeshSerializer::setListener( MeshSerializerListener *listener ) { mListener = listener; }
     //-------------------------------------------------------------------------
     MeshSerializerListener *MeshSerializer::getListener() { return mListener; }
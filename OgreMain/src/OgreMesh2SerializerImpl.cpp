@@ -41,6 +41,8 @@ THE SOFTWARE.
 #include "OgreMesh2.h"
 #include "OgreMesh2Serializer.h"
 #include "OgreMeshFileFormat.h"
+#include "OgreMeshManager2.h"
+#include "OgreMeshPayloadCodec.h"
 #include "OgreRoot.h"
 #include "OgreSubMesh2.h"
 #include "Vao/OgreAsyncTicket.h"
@@ -61,13 +63,15 @@ namespace Ogre
     /// stream overhead = ID + size
     const long MSTREAM_OVERHEAD_SIZE = sizeof( uint16 ) + sizeof( uint32 );
     //---------------------------------------------------------------------
-    MeshSerializerImpl::MeshSerializerImpl( VaoManager *vaoManager ) : mVaoManager( vaoManager )
+    MeshSerializerImpl::MeshSerializerImpl( VaoManager *vaoManager ) :
+        mVaoManager( vaoManager ),
+        mDeferGpuWork( false )
     {
         // Version number
-        mVersion = "[MeshSerializer_v2.1 R2]";
+        mVersion = "[MeshSerializer_v2.1 R3]";
     }
     //---------------------------------------------------------------------
-    MeshSerializerImpl::~MeshSerializerImpl() {}
+    MeshSerializerImpl::~MeshSerializerImpl() { discardDeferredImport(); }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::exportMesh( const Mesh *pMesh, DataStreamPtr stream, Endian endianMode )
     {
@@ -107,6 +111,17 @@ namespace Ogre
                              "before exporting.",
                              "MeshSerializerImpl::exportMesh" );
             }
+
+            // Its Vaos only reference a range of the shared buffers. Reading them as
+            // whole buffers would export every other mesh that lives in them
+            if( pMesh->getSubMesh( i )->_isUsingSharedBuffers() )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                             "Mesh " + pMesh->getName() +
+                                 " uses MeshManager's shared buffers and can't be exported. Load it "
+                                 "with MeshManager::setShareStaticBuffers disabled first.",
+                             "MeshSerializerImpl::exportMesh" );
+            }
         }
 
         writeFileHeader();
@@ -116,6 +131,7 @@ namespace Ogre
         pushInnerChunk( mStream );
         writeMesh( pMesh );
         popInnerChunk( mStream );
+        writePayloads();
         LogManager::getSingleton().logMessage( "Mesh data exported." );
 
         LogManager::getSingleton().logMessage( "MeshSerializer export successful." );
@@ -123,6 +139,109 @@ namespace Ogre
     //---------------------------------------------------------------------
     void MeshSerializerImpl::importMesh( DataStreamPtr &stream, Mesh *pMesh,
                                          MeshSerializerListener *listener )
+    {
+        importMeshChunks( stream, pMesh, listener );
+
+        if( !pMesh->hasValidShadowMappingVaos() )
+            pMesh->prepareForShadowMapping( false );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::importMeshDeferred( DataStreamPtr &stream, Mesh *pMesh,
+                                                 MeshSerializerListener *listener )
+    {
+        discardDeferredImport();
+
+        mDeferGpuWork = true;
+        try
+        {
+            importMeshChunks( stream, pMesh, listener );
+        }
+        catch( Exception & )
+        {
+            mDeferGpuWork = false;
+            discardDeferredImport();
+            throw;
+        }
+        mDeferGpuWork = false;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::finishDeferredImport( Mesh *pMesh )
+    {
+        PendingSubMeshVaoVec pendingVaos;
+        pendingVaos.swap( mPendingSubMeshVaos );
+
+        for( size_t i = 0u; i < pendingVaos.size(); ++i )
+        {
+            PendingSubMeshVao &pending = pendingVaos[i];
+            try
+            {
+                createSubMeshVao( pending.subMesh, pending.submeshLods, pending.casterPass );
+            }
+            catch( Exception & )
+            {
+                for( size_t j = i + 1u; j < pendingVaos.size(); ++j )
+                    freeSubMeshLods( pendingVaos[j].submeshLods );
+                mPendingSkeletonName.clear();
+                throw;
+            }
+
+            // Populate mBoneAssignments (needs the Vao, thus couldn't be done while parsing)
+            if( pending.casterPass == VpNormal )
+                pending.subMesh->_buildBoneAssignmentsFromVertexData();
+        }
+
+        if( !mPendingSkeletonName.empty() )
+        {
+            pMesh->setSkeletonName( mPendingSkeletonName );
+            mPendingSkeletonName.clear();
+        }
+
+        if( !pMesh->hasValidShadowMappingVaos() )
+            pMesh->prepareForShadowMapping( false );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::discardDeferredImport()
+    {
+        PendingSubMeshVaoVec::iterator itor = mPendingSubMeshVaos.begin();
+        PendingSubMeshVaoVec::iterator endt = mPendingSubMeshVaos.end();
+
+        while( itor != endt )
+        {
+            freeSubMeshLods( itor->submeshLods );
+            ++itor;
+        }
+
+        mPendingSubMeshVaos.clear();
+        mPendingSkeletonName.clear();
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::freeSubMeshLods( SubMeshLodVec &submeshLods )
+    {
+        SubMeshLodVec::iterator itor = submeshLods.begin();
+        SubMeshLodVec::iterator endt = submeshLods.end();
+
+        while( itor != endt )
+        {
+            Uint8Vec::iterator it = itor->vertexBuffers.begin();
+            Uint8Vec::iterator en = itor->vertexBuffers.end();
+
+            while( it != en )
+                OGRE_FREE_SIMD( *it++, MEMCATEGORY_GEOMETRY );
+
+            itor->vertexBuffers.clear();
+
+            if( itor->indexData )
+            {
+                OGRE_FREE_SIMD( itor->indexData, MEMCATEGORY_GEOMETRY );
+                itor->indexData = 0;
+            }
+
+            ++itor;
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::importMeshChunks( DataStreamPtr &stream, Mesh *pMesh,
+                                               MeshSerializerListener *listener )
     {
         // Determine endianness (must be the first thing we do!)
         determineEndianness( stream );
@@ -145,9 +264,6 @@ namespace Ogre
             }
         }
         popInnerChunk( stream );
-
-        if( !pMesh->hasValidShadowMappingVaos() )
-            pMesh->prepareForShadowMapping( false );
     }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::writeMesh( const Mesh *pMesh )
@@ -184,13 +300,17 @@ namespace Ogre
         }
 
         // Header
-        writeChunkHeader( M_MESH, calcMeshSize( pMesh, lodVertexTable ) );
+        const size_t meshChunkStart = mStream->tell();
+        const size_t meshChunkSize = calcMeshSize( pMesh, lodVertexTable );
+        writeChunkHeader( M_MESH, meshChunkSize );
         {
             writeString( pMesh->getLodStrategyName() );  // string strategyName;
 
             const uint8 numVaoPasses = pMesh->hasIndependentShadowMappingVaos() + 1;
             writeData( &numVaoPasses, 1, 1 );
 
+            writePayloadHeader( meshChunkStart + meshChunkSize );
+
             pushInnerChunk( mStream );
 
             // Write Submeshes
@@ -304,6 +424,43 @@ namespace Ogre
             for( uint8 lodLevel = 0; lodLevel < numLodLevels; ++lodLevel )
                 writeSubMeshLod( s->mVao[i][lodLevel], lodLevel, lodVertexTable[lodLevel] );
         }
+
+        if( s->hasMeshlets() )
+            writeSubMeshMeshlets( s );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeSubMeshMeshlets( const SubMesh *s )
+    {
+        pushInnerChunk( mStream );
+        writeChunkHeader( M_SUBMESH_MESHLETS, calcSubMeshMeshletsSize( s ) );
+
+        const uint8 numLodLevels = static_cast<uint8>( s->mVao[VpNormal].size() );
+        writeData( &numLodLevels, 1, 1 );
+
+        for( uint8 lodLevel = 0; lodLevel < numLodLevels; ++lodLevel )
+        {
+            const MeshOptimizer::MeshletVec &meshlets = s->getMeshlets( lodLevel );
+
+            const uint32 numMeshlets = static_cast<uint32>( meshlets.size() );
+            writeInts( &numMeshlets, 1 );
+
+            MeshOptimizer::MeshletVec::const_iterator itor = meshlets.begin();
+            MeshOptimizer::MeshletVec::const_iterator endt = meshlets.end();
+
+            while( itor != endt )
+            {
+                writeInts( &itor->indexStart, 1 );
+                writeInts( &itor->indexCount, 1 );
+                writeInts( &itor->vertexCount, 1 );
+                writeFloats( itor->center, 3 );
+                writeFloats( &itor->radius, 1 );
+                writeFloats( itor->coneAxis, 3 );
+                writeFloats( &itor->coneCutoff, 1 );
+                ++itor;
+            }
+        }
+
+        popInnerChunk( mStream );
     }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::writeSubMeshLod( const VertexArrayObject *vao, uint8 lodLevel,
@@ -391,22 +548,21 @@ namespace Ogre
             // uint16* faceVertexIndices ((indexCount)
             AsyncTicketPtr asyncTicket = indexBuffer->readRequest( 0, indexCount );
             const void *pIdx = asyncTicket->map();
-            if( idx32bit )
-            {
-                const uint32 *pIdx32 = static_cast<const uint32 *>( pIdx );
-                writeInts( pIdx32, indexCount );
-                addToHash( pIdx32, indexCount * sizeof( uint32 ) );
-            }
-            else
-            {
-                const uint16 *pIdx16 = static_cast<const uint16 *>( pIdx );
-                writeShorts( pIdx16, indexCount );
-                addToHash( pIdx16, indexCount * sizeof( uint16 ) );
-            }
+            writeIndexData( pIdx, indexCount, idx32bit );
+            addToHash( pIdx, indexBuffer->getTotalSizeBytes() );
             asyncTicket->unmap();
         }
     }
     //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeIndexData( const void *indexData, uint32 indexCount,
+                                             bool index32Bit )
+    {
+        if( index32Bit )
+            writeInts( static_cast<const uint32 *>( indexData ), indexCount );
+        else
+            writeShorts( static_cast<const uint16 *>( indexData ), indexCount );
+    }
+    //---------------------------------------------------------------------
     void MeshSerializerImpl::writeGeometry( const VertexBufferPackedVec &vertexData )
     {
         // Header
@@ -465,8 +621,8 @@ namespace Ogre
 
             for( uint8 i = 0; i < numSources; ++i )
             {
-                size_t size =
-                    MSTREAM_OVERHEAD_SIZE + ( sizeof( uint8 ) * 2 ) + vertexData[i]->getTotalSizeBytes();
+                size_t size = MSTREAM_OVERHEAD_SIZE + ( sizeof( uint8 ) * 2 ) +
+                              calcVertexBufferDataSize( vertexData[i] );
 
                 pushInnerChunk( mStream );
                 writeChunkHeader( M_SUBMESH_M_GEOMETRY_VERTEX_BUFFER, size );
@@ -485,25 +641,7 @@ namespace Ogre
 
                 addToHash( data, vertexData[i]->getTotalSizeBytes() );
 
-                if( mFlipEndian )
-                {
-                    // endian conversion
-                    // Copy data
-                    unsigned char *tempData = OGRE_ALLOC_T(
-                        unsigned char, vertexData[i]->getTotalSizeBytes(), MEMCATEGORY_GEOMETRY );
-                    memcpy( tempData, data, vertexData[i]->getTotalSizeBytes() );
-
-                    flipLittleEndian( tempData, vertexData[i] );
-
-                    writeData( tempData, vertexData[i]->getBytesPerElement(),
-                               vertexData[i]->getNumElements() );
-                    OGRE_FREE( tempData, MEMCATEGORY_GEOMETRY );
-                }
-                else
-                {
-                    writeData( data, vertexData[i]->getBytesPerElement(),
-                               vertexData[i]->getNumElements() );
-                }
+                writeVertexBufferData( data, vertexData[i] );
 
                 asyncTicket->unmap();
 
@@ -514,6 +652,34 @@ namespace Ogre
         popInnerChunk( mStream );
     }
     //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeVertexBufferData( const void *vertexData,
+                                                    const VertexBufferPacked *vertexBuffer )
+    {
+        if( mFlipEndian )
+        {
+            // endian conversion
+            // Copy data
+            unsigned char *tempData =
+                OGRE_ALLOC_T( unsigned char, vertexBuffer->getTotalSizeBytes(), MEMCATEGORY_GEOMETRY );
+            memcpy( tempData, vertexData, vertexBuffer->getTotalSizeBytes() );
+
+            flipLittleEndian( tempData, vertexBuffer->getNumElements(),
+                              vertexBuffer->getBytesPerElement(), vertexBuffer->getVertexElements() );
+
+            writeData( tempData, vertexBuffer->getBytesPerElement(), vertexBuffer->getNumElements() );
+            OGRE_FREE( tempData, MEMCATEGORY_GEOMETRY );
+        }
+        else
+        {
+            writeData( vertexData, vertexBuffer->getBytesPerElement(),
+                       vertexBuffer->getNumElements() );
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::writePayloadHeader( size_t meshChunkEnd ) {}
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::writePayloads() {}
+    //---------------------------------------------------------------------
     size_t MeshSerializerImpl::calcSubMeshNameTableSize( const Mesh *pMesh )
     {
         size_t size = MSTREAM_OVERHEAD_SIZE;
@@ -544,6 +710,8 @@ namespace Ogre
         // string strategyName
         size += calcStringSize( pMesh->getLodStrategyName() );
 
+        size += calcPayloadHeaderSize();
+
         // Submeshes
         for( unsigned i = 0; i < pMesh->getNumSubMeshes(); ++i )
         {
@@ -605,6 +773,29 @@ namespace Ogre
                     calcSubMeshLodSize( pSub->mVao[i][lodLevel], lodVertexTable[lodLevel] != lodLevel );
         }
 
+        if( pSub->hasMeshlets() )
+            size += calcSubMeshMeshletsSize( pSub );
+
+        return size;
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl::calcSubMeshMeshletsSize( const SubMesh *s )
+    {
+        size_t size = MSTREAM_OVERHEAD_SIZE;
+
+        // uint8 numLodLevels
+        size += sizeof( uint8 );
+
+        const uint8 numLodLevels = static_cast<uint8>( s->mVao[VpNormal].size() );
+        for( uint8 lodLevel = 0; lodLevel < numLodLevels; ++lodLevel )
+        {
+            // uint32 numMeshlets
+            size += sizeof( uint32 );
+            // uint32 indexStart, indexCount, vertexCount
+            // float center[3], radius, coneAxis[3], coneCutoff
+            size += ( sizeof( uint32 ) * 3u + sizeof( float ) * 8u ) * s->getMeshlets( lodLevel ).size();
+        }
+
         return size;
     }
     //---------------------------------------------------------------------
@@ -624,7 +815,7 @@ namespace Ogre
             // bool indexes32bit
             size += sizeof( bool );
 
-            size += indexBuffer->getTotalSizeBytes();
+            size += calcIndexDataSize( indexBuffer );
         }
 
         if( !skipVertexBuffer )
@@ -669,7 +860,7 @@ namespace Ogre
 
             while( itor != endt )
             {
-                size += ( *itor )->getTotalSizeBytes();
+                size += calcVertexBufferDataSize( *itor );
                 ++itor;
             }
         }
@@ -677,6 +868,18 @@ namespace Ogre
         return size;
     }
     //---------------------------------------------------------------------
+    size_t MeshSerializerImpl::calcIndexDataSize( const IndexBufferPacked *indexBuffer )
+    {
+        return indexBuffer->getTotalSizeBytes();
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl::calcVertexBufferDataSize( const VertexBufferPacked *vertexBuffer )
+    {
+        return vertexBuffer->getTotalSizeBytes();
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl::calcPayloadHeaderSize() { return 0u; }
+    //---------------------------------------------------------------------
     size_t MeshSerializerImpl::calcVertexDeclSize( const VertexBufferPackedVec &vertexData )
     {
         size_t size = MSTREAM_OVERHEAD_SIZE;
@@ -764,6 +967,8 @@ namespace Ogre
         readChar( stream, &numVaoPasses );
         assert( numVaoPasses == 1 || numVaoPasses == 2 );
 
+        readPayloadHeader( stream );
+
         // Find all substreams
         if( !stream->eof() )
         {
@@ -854,9 +1059,6 @@ namespace Ogre
         pushInnerChunk( stream );
         try
         {
-            SubMeshLodVec submeshLods;
-            submeshLods.reserve( numLodLevels );
-
             for( uint8 i = 0; i < numVaoPasses; ++i )
             {
                 for( uint8 j = 0; j < numLodLevels; ++j )
@@ -868,51 +1070,56 @@ namespace Ogre
                     OGRE_ASSERT_LOW( streamID == M_SUBMESH_LOD && !stream->eof() );
 
                     totalSubmeshLods.push_back( SubMeshLod() );
-                    const uint8 currentLod = static_cast<uint8>( submeshLods.size() );
-                    readSubMeshLod( stream, pMesh, &totalSubmeshLods.back(), currentLod );
-
-                    submeshLods.push_back( totalSubmeshLods.back() );
+                    readSubMeshLod( stream, pMesh, &totalSubmeshLods.back(), j );
                 }
+            }
 
-                createSubMeshVao( sm, submeshLods, i );
-                submeshLods.clear();
+            // M_SUBMESH_MESHLETS (optional)
+            // Must be read before creating the Vaos: submeshes with meshlets can't go
+            // to the shared buffers, as Meshlet::indexStart is relative to its own LOD
+            if( !stream->eof() )
+            {
+                const uint16 streamID = readChunk( stream );
+                if( streamID == M_SUBMESH_MESHLETS )
+                    readSubMeshMeshlets( stream, sm, numLodLevels );
+                else if( !stream->eof() )
+                    backpedalChunkHeader( stream );
             }
 
-            // Populate mBoneAssignments and mBlendIndexToBoneIndexMap;
-            size_t indexSource = 0;
-            size_t unusedVar = 0;
+            SubMeshLodVec submeshLods;
+            submeshLods.reserve( numLodLevels );
 
-            const VertexElement2 *indexElement =
-                sm->mVao[VpNormal][0]->findBySemantic( VES_BLEND_INDICES, indexSource, unusedVar );
-            if( indexElement )
+            for( uint8 i = 0; i < numVaoPasses; ++i )
             {
-                const uint8 *vertexData = totalSubmeshLods[0].vertexBuffers[indexSource];
-                sm->_buildBoneAssignmentsFromVertexData( vertexData );
+                submeshLods.assign( totalSubmeshLods.begin() + i * numLodLevels,
+                                    totalSubmeshLods.begin() + ( i + 1u ) * numLodLevels );
+                createSubMeshVao( sm, submeshLods, i );
+                submeshLods.clear();
             }
-        }
-        catch( Exception & )
-        {
-            SubMeshLodVec::iterator itor = totalSubmeshLods.begin();
-            SubMeshLodVec::iterator endt = totalSubmeshLods.end();
 
-            while( itor != endt )
+            // Populate mBoneAssignments and mBlendIndexToBoneIndexMap;
+            // (when deferred, it's done by finishDeferredImport)
+            if( !mDeferGpuWork )
             {
-                Uint8Vec::iterator it = itor->vertexBuffers.begin();
-                Uint8Vec::iterator en = itor->vertexBuffers.end();
-
-                while( it != en )
-                    OGRE_FREE_SIMD( *it++, MEMCATEGORY_GEOMETRY );
-
-                itor->vertexBuffers.clear();
+                size_t indexSource = 0;
+                size_t unusedVar = 0;
 
-                if( itor->indexData )
+                const VertexElement2 *indexElement = sm->mVao[VpNormal][0]->findBySemantic(
+                    VES_BLEND_INDICES, indexSource, unusedVar );
+                if( indexElement )
                 {
-                    OGRE_FREE_SIMD( itor->indexData, MEMCATEGORY_GEOMETRY );
-                    itor->indexData = 0;
+                    const uint8 *vertexData = totalSubmeshLods[0].vertexBuffers[indexSource];
+                    sm->_buildBoneAssignmentsFromVertexData( vertexData );
                 }
-
-                ++itor;
             }
+        }
+        catch( Exception & )
+        {
+            // The pending Vaos point to the same data we're about to free
+            while( !mPendingSubMeshVaos.empty() && mPendingSubMeshVaos.back().subMesh == sm )
+                mPendingSubMeshVaos.pop_back();
+
+            freeSubMeshLods( totalSubmeshLods );
 
             // TODO: Delete created mVaos. Don't erase the data from those vaos?
 
@@ -925,6 +1132,19 @@ namespace Ogre
     void MeshSerializerImpl::createSubMeshVao( SubMesh *sm, SubMeshLodVec &submeshLods,
                                                uint8 casterPass )
     {
+        if( mDeferGpuWork )
+        {
+            mPendingSubMeshVaos.push_back( PendingSubMeshVao() );
+            PendingSubMeshVao &pending = mPendingSubMeshVaos.back();
+            pending.subMesh = sm;
+            pending.submeshLods = submeshLods;
+            pending.casterPass = casterPass;
+            return;
+        }
+
+        if( createSharedSubMeshVao( sm, submeshLods, casterPass ) )
+            return;
+
         sm->mVao[casterPass].reserve( submeshLods.size() );
 
         VertexBufferPackedVec vertexBuffers;
@@ -1006,6 +1226,96 @@ namespace Ogre
         }
     }
     //---------------------------------------------------------------------
+    bool MeshSerializerImpl::createSharedSubMeshVao( SubMesh *sm, SubMeshLodVec &submeshLods,
+                                                     uint8 casterPass )
+    {
+        MeshManager *meshManager = MeshManager::getSingletonPtr();
+        const Mesh *mesh = sm->mParent;
+
+        // Meshlet::indexStart is relative to the index buffer of each LOD, not the shared one
+        if( !meshManager || !meshManager->getShareStaticBuffers() || submeshLods.empty() ||
+            sm->hasMeshlets() || Mesh::msOptimizeForShadowMapping ||
+            mesh->isVertexBufferShadowed() || mesh->isIndexBufferShadowed() ||
+            mesh->getVertexBufferDefaultType() > BT_DEFAULT ||
+            mesh->getIndexBufferDefaultType() > BT_DEFAULT )
+        {
+            return false;
+        }
+
+        // All LODs must fit in the same shared buffer
+        const SubMeshLod &firstLod = submeshLods[0];
+        uint32 numVertices = 0u;
+        uint32 numIndices = 0u;
+        for( size_t i = 0; i < submeshLods.size(); ++i )
+        {
+            const SubMeshLod &subMeshLod = submeshLods[i];
+            if( !subMeshLod.indexData || subMeshLod.operationType != OT_TRIANGLE_LIST ||
+                subMeshLod.index32Bit != firstLod.index32Bit )
+            {
+                return false;
+            }
+
+            if( subMeshLod.lodSource == i )
+            {
+                if( subMeshLod.vertexDeclarations.size() != 1u ||
+                    subMeshLod.vertexDeclarations[0] != firstLod.vertexDeclarations[0] )
+                {
+                    return false;
+                }
+
+                // Skinning (and PreSkinning) work on whole vertex buffers
+                VertexElement2Vec::const_iterator itElement = subMeshLod.vertexDeclarations[0].begin();
+                VertexElement2Vec::const_iterator enElement = subMeshLod.vertexDeclarations[0].end();
+                while( itElement != enElement && itElement->mSemantic != VES_BLEND_INDICES )
+                    ++itElement;
+                if( itElement != enElement )
+                    return false;
+                numVertices += subMeshLod.numVertices;
+            }
+
+            numIndices += subMeshLod.numIndices;
+        }
+
+        MeshManager::SharedGeometryBuffer *sharedBuffer = meshManager->_reserveSharedGeometry(
+            firstLod.vertexDeclarations[0], firstLod.index32Bit, numVertices, numIndices );
+
+        if( !sharedBuffer )
+            return false;
+
+        sm->mVao[casterPass].reserve( submeshLods.size() );
+
+        FastArray<uint32> baseVertices;
+        baseVertices.reserve( submeshLods.size() );
+
+        for( size_t i = 0; i < submeshLods.size(); ++i )
+        {
+            SubMeshLod &subMeshLod = submeshLods[i];
+
+            uint32 baseVertex;
+            if( subMeshLod.lodSource == i )
+            {
+                baseVertex = meshManager->_uploadSharedVertices(
+                    sharedBuffer, subMeshLod.vertexBuffers[0], subMeshLod.numVertices );
+                OGRE_FREE_SIMD( subMeshLod.vertexBuffers[0], MEMCATEGORY_GEOMETRY );
+                subMeshLod.vertexBuffers.erase( subMeshLod.vertexBuffers.begin() );
+            }
+            else
+            {
+                baseVertex = baseVertices[subMeshLod.lodSource];
+            }
+            baseVertices.push_back( baseVertex );
+
+            VertexArrayObject *vao = meshManager->_createSharedVao(
+                sharedBuffer, baseVertex, subMeshLod.indexData, subMeshLod.numIndices );
+            OGRE_FREE_SIMD( subMeshLod.indexData, MEMCATEGORY_GEOMETRY );
+            subMeshLod.indexData = 0;
+
+            sm->mVao[casterPass].push_back( vao );
+        }
+
+        return true;
+    }
+    //---------------------------------------------------------------------
     void MeshSerializerImpl::readSubMeshLod( DataStreamPtr &stream, Mesh *pMesh, SubMeshLod *subLod,
                                              uint8 currentLod )
     {
@@ -1080,22 +1390,22 @@ namespace Ogre
         {
             readBools( stream, &subLod->index32Bit, 1 );
 
-            if( subLod->index32Bit )
-            {
-                subLod->indexData =
-                    OGRE_MALLOC_SIMD( sizeof( uint32 ) * subLod->numIndices, MEMCATEGORY_GEOMETRY );
-                readInts( stream, reinterpret_cast<uint32 *>( subLod->indexData ), subLod->numIndices );
-            }
-            else
-            {
-                subLod->indexData =
-                    OGRE_MALLOC_SIMD( sizeof( uint16 ) * subLod->numIndices, MEMCATEGORY_GEOMETRY );
-                readShorts( stream, reinterpret_cast<uint16 *>( subLod->indexData ),
-                            subLod->numIndices );
-            }
+            const size_t bytesPerIndex = subLod->index32Bit ? sizeof( uint32 ) : sizeof( uint16 );
+            subLod->indexData =
+                OGRE_MALLOC_SIMD( bytesPerIndex * subLod->numIndices, MEMCATEGORY_GEOMETRY );
+            readIndexData( stream, subLod->indexData, subLod->numIndices, subLod->index32Bit );
         }
     }
     //---------------------------------------------------------------------
+    void MeshSerializerImpl::readIndexData( DataStreamPtr &stream, void *dst, uint32 indexCount,
+                                            bool index32Bit )
+    {
+        if( index32Bit )
+            readInts( stream, reinterpret_cast<uint32 *>( dst ), indexCount );
+        else
+            readShorts( stream, reinterpret_cast<uint16 *>( dst ), indexCount );
+    }
+    //---------------------------------------------------------------------
     void MeshSerializerImpl::readGeometry( DataStreamPtr &stream, SubMeshLod *subLod )
     {
         readInts( stream, &subLod->numVertices, 1 );
@@ -1191,12 +1501,20 @@ namespace Ogre
             sizeof( uint8 ) * bytesPerVertex * subLod->numVertices, MEMCATEGORY_GEOMETRY ) );
         subLod->vertexBuffers[source] = vertexData;
 
-        stream->read( vertexData, bytesPerVertex * subLod->numVertices );
+        readVertexBufferData( stream, vertexData, subLod->numVertices, bytesPerVertex );
 
         // Endian conversion
         flipLittleEndian( vertexData, subLod->numVertices, bytesPerVertex, vertexElements );
     }
     //---------------------------------------------------------------------
+    void MeshSerializerImpl::readVertexBufferData( DataStreamPtr &stream, uint8 *dst,
+                                                   size_t numVertices, size_t bytesPerVertex )
+    {
+        stream->read( dst, bytesPerVertex * numVertices );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readPayloadHeader( DataStreamPtr &stream ) {}
+    //---------------------------------------------------------------------
     void MeshSerializerImpl::readSubMeshLodOperation( DataStreamPtr &stream, SubMeshLod *subLod )
     {
         // uint16 operationType
@@ -1205,6 +1523,48 @@ namespace Ogre
         subLod->operationType = static_cast<OperationType>( opType );
     }
     //---------------------------------------------------------------------
+    void MeshSerializerImpl::readSubMeshMeshlets( DataStreamPtr &stream, SubMesh *sm,
+                                                  uint8 numSubMeshLodLevels )
+    {
+        uint8 numLodLevels = 0;
+        readChar( stream, &numLodLevels );
+
+        if( numLodLevels != numSubMeshLodLevels )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Number of meshlet LODs doesn't match the submesh's in " + stream->getName(),
+                         "MeshSerializerImpl::readSubMeshMeshlets" );
+        }
+
+        vector<MeshOptimizer::MeshletVec>::type meshlets( numLodLevels );
+
+        for( uint8 lodLevel = 0; lodLevel < numLodLevels; ++lodLevel )
+        {
+            uint32 numMeshlets = 0;
+            readInts( stream, &numMeshlets, 1 );
+
+            meshlets[lodLevel].resize( numMeshlets );
+
+            MeshOptimizer::MeshletVec::iterator itor = meshlets[lodLevel].begin();
+            MeshOptimizer::MeshletVec::iterator endt = meshlets[lodLevel].end();
+
+            while( itor != endt )
+            {
+                readInts( stream, &itor->indexStart, 1 );
+                readInts( stream, &itor->indexCount, 1 );
+                readInts( stream, &itor->vertexCount, 1 );
+                itor->padding = 0u;
+                readFloats( stream, itor->center, 3 );
+                readFloats( stream, &itor->radius, 1 );
+                readFloats( stream, itor->coneAxis, 3 );
+                readFloats( stream, &itor->coneCutoff, 1 );
+                ++itor;
+            }
+        }
+
+        sm->_setMeshlets( meshlets );
+    }
+    //---------------------------------------------------------------------
     void MeshSerializerImpl::writeSkeletonLink( const String &skelName )
     {
         writeChunkHeader( M_MESH_SKELETON_LINK, calcSkeletonLinkSize( skelName ) );
@@ -1220,7 +1580,11 @@ namespace Ogre
         if( listener )
             listener->processSkeletonName( pMesh, &skelName );
 
-        pMesh->setSkeletonName( skelName );
+        // Setting the name loads the skeleton
+        if( mDeferGpuWork )
+            mPendingSkeletonName = skelName;
+        else
+            pMesh->setSkeletonName( skelName );
     }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::readTextureLayer( DataStreamPtr &stream, Mesh *pMesh, MaterialPtr &pMat )
@@ -2295,8 +2659,277 @@ edgeData->triangleFaceNormals.begin(); for ( ; t != edgeData->triangles.end(); +
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    MeshSerializerImpl_v2_1_R1::MeshSerializerImpl_v2_1_R1( VaoManager *vaoManager ) :
+    const size_t MeshSerializerImpl_v3_0::PayloadAlignment = 4096u;
+    /// Alignment of each payload within the blob
+    static const size_t c_payloadInnerAlignment = 16u;
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v3_0::MeshSerializerImpl_v3_0( VaoManager *vaoManager ) :
+        MeshSerializerImpl( vaoManager ),
+        mCompressPayloads( true ),
+        mPayloadStart( 0 ),
+        mPayloadEnd( 0 )
+    {
+        // Version number
+        mVersion = "[MeshSerializer_v3.0]";
+    }
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v3_0::~MeshSerializerImpl_v3_0() {}
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_v3_0::setCompressPayloads( bool bCompress )
+    {
+        mCompressPayloads = bCompress;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_v3_0::writeIndexData( const void *indexData, uint32 indexCount,
+                                                  bool index32Bit )
+    {
+        const size_t bytesPerIndex = index32Bit ? sizeof( uint32 ) : sizeof( uint16 );
+        const size_t sizeBytes = bytesPerIndex * indexCount;
+
+        if( mFlipEndian )
+        {
+            void *tempData = OGRE_MALLOC_SIMD( sizeBytes, MEMCATEGORY_GEOMETRY );
+            FreeOnDestructor dataPtrContainer( tempData );
+            memcpy( tempData, indexData, sizeBytes );
+            flipToLittleEndian( tempData, bytesPerIndex, indexCount );
+            addPayload( tempData, sizeBytes, bytesPerIndex );
+        }
+        else
+        {
+            addPayload( indexData, sizeBytes, bytesPerIndex );
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_v3_0::writeVertexBufferData( const void               *vertexData,
+                                                         const VertexBufferPacked *vertexBuffer )
+    {
+        const size_t sizeBytes = vertexBuffer->getTotalSizeBytes();
+
+        if( mFlipEndian )
+        {
+            void *tempData = OGRE_MALLOC_SIMD( sizeBytes, MEMCATEGORY_GEOMETRY );
+            FreeOnDestructor dataPtrContainer( tempData );
+            memcpy( tempData, vertexData, sizeBytes );
+            flipLittleEndian( tempData, vertexBuffer->getNumElements(),
+                              vertexBuffer->getBytesPerElement(), vertexBuffer->getVertexElements() );
+            addPayload( tempData, sizeBytes, vertexBuffer->getBytesPerElement() );
+        }
+        else
+        {
+            addPayload( vertexData, sizeBytes, vertexBuffer->getBytesPerElement() );
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_v3_0::writePayloadHeader( size_t meshChunkEnd )
+    {
+        // Leave room for at least one (zeroed) chunk header after M_MESH so readers
+        // stop parsing chunks there.
+        mPayloadStart = alignToNextMultiple<size_t>( meshChunkEnd + MSTREAM_OVERHEAD_SIZE,
+                                                     PayloadAlignment );
+        mPayloadData.clear();
+
+        if( mPayloadStart > std::numeric_limits<uint32>::max() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Mesh is too big for the v3.0 format",
+                         "MeshSerializerImpl_v3_0::writePayloadHeader" );
+        }
+
+        const uint32 payloadStart = static_cast<uint32>( mPayloadStart );
+        writeInts( &payloadStart, 1 );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_v3_0::writePayloads()
+    {
+        const size_t currentPos = mStream->tell();
+        if( currentPos + MSTREAM_OVERHEAD_SIZE > mPayloadStart )
+        {
+            OGRE_EXCEPT( Exception::ERR_INTERNAL_ERROR,
+                         "M_MESH chunk is bigger than calculated. Payloads would overlap it",
+                         "MeshSerializerImpl_v3_0::writePayloads" );
+        }
+
+        const uint8 zeroes[256] = {};
+        size_t paddingLeft = mPayloadStart - currentPos;
+        while( paddingLeft )
+        {
+            const size_t bytesToWrite = std::min( paddingLeft, sizeof( zeroes ) );
+            writeData( zeroes, 1u, bytesToWrite );
+            paddingLeft -= bytesToWrite;
+        }
+
+        if( !mPayloadData.empty() )
+            writeData( &mPayloadData[0], 1u, mPayloadData.size() );
+
+        mPayloadData.clear();
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl_v3_0::calcIndexDataSize( const IndexBufferPacked *indexBuffer )
+    {
+        // uint8 codec, uint32 offset, uint32 storedSize
+        return sizeof( uint8 ) + sizeof( uint32 ) * 2u;
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl_v3_0::calcVertexBufferDataSize( const VertexBufferPacked *vertexBuffer )
+    {
+        // uint8 codec, uint32 offset, uint32 storedSize
+        return sizeof( uint8 ) + sizeof( uint32 ) * 2u;
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl_v3_0::calcPayloadHeaderSize()
+    {
+        // uint32 payloadStart
+        return sizeof( uint32 );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_v3_0::addPayload( const void *data, size_t sizeBytes, size_t stride )
+    {
+        const size_t offset = alignToNextMultiple( mPayloadData.size(), c_payloadInnerAlignment );
+
+        uint8 codec = PayloadRaw;
+        size_t storedSize = 0u;
+
+        if( mCompressPayloads && sizeBytes > 0u )
+        {
+            // Only keep the compressed version if it's smaller
+            mPayloadData.resize( offset + sizeBytes );
+            storedSize =
+                MeshPayloadCodec::compress( data, sizeBytes, stride, &mPayloadData[offset], sizeBytes );
+            if( storedSize )
+                codec = PayloadCompressed;
+        }
+
+        if( codec == PayloadRaw )
+        {
+            storedSize = sizeBytes;
+            mPayloadData.resize( offset + sizeBytes );
+            if( sizeBytes )
+                memcpy( &mPayloadData[offset], data, sizeBytes );
+        }
+        else
+        {
+            mPayloadData.resize( offset + storedSize );
+        }
+
+        if( mPayloadData.size() > std::numeric_limits<uint32>::max() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Mesh is too big for the v3.0 format",
+                         "MeshSerializerImpl_v3_0::addPayload" );
+        }
+
+        const uint32 offsetAndSize[2] = { static_cast<uint32>( offset ),
+                                          static_cast<uint32>( storedSize ) };
+        writeData( &codec, 1, 1 );
+        writeInts( offsetAndSize, 2u );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_v3_0::readMesh( DataStreamPtr &stream, Mesh *pMesh,
+                                            MeshSerializerListener *listener )
+    {
+        MeshSerializerImpl::readMesh( stream, pMesh, listener );
+
+        // Skip the payloads; there are no more chunks
+        stream->seek( mPayloadEnd );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_v3_0::readIndexData( DataStreamPtr &stream, void *dst, uint32 indexCount,
+                                                 bool index32Bit )
+    {
+        const size_t bytesPerIndex = index32Bit ? sizeof( uint32 ) : sizeof( uint16 );
+        readPayload( stream, dst, bytesPerIndex * indexCount, bytesPerIndex );
+        flipFromLittleEndian( dst, bytesPerIndex, indexCount );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_v3_0::readVertexBufferData( DataStreamPtr &stream, uint8 *dst,
+                                                        size_t numVertices, size_t bytesPerVertex )
+    {
+        readPayload( stream, dst, bytesPerVertex * numVertices, bytesPerVertex );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_v3_0::readPayloadHeader( DataStreamPtr &stream )
+    {
+        uint32 payloadStart = 0;
+        readInts( stream, &payloadStart, 1 );
+        mPayloadStart = payloadStart;
+        mPayloadEnd = payloadStart;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl_v3_0::readPayload( DataStreamPtr &stream, void *dst, size_t sizeBytes,
+                                               size_t stride )
+    {
+        uint8 codec = PayloadRaw;
+        readChar( stream, &codec );
+        uint32 offsetAndSize[2];
+        readInts( stream, offsetAndSize, 2u );
+
+        const size_t payloadPos = mPayloadStart + offsetAndSize[0];
+        const size_t storedSize = offsetAndSize[1];
+
+        if( codec > PayloadCompressed || ( codec == PayloadRaw && storedSize != sizeBytes ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INTERNAL_ERROR,
+                         "Invalid buffer payload descriptor in " + stream->getName(),
+                         "MeshSerializerImpl_v3_0::readPayload" );
+        }
+
+        bool bSuccess = true;
+
+        MemoryDataStream *memStream = dynamic_cast<MemoryDataStream *>( stream.get() );
+        if( memStream && payloadPos + storedSize <= memStream->size() )
+        {
+            // Work directly on the memory, avoid a copy
+            const uint8 *srcData = memStream->getPtr() + payloadPos;
+            if( codec == PayloadRaw )
+                memcpy( dst, srcData, sizeBytes );
+            else
+                bSuccess = MeshPayloadCodec::decompress( srcData, storedSize, stride, dst, sizeBytes );
+        }
+        else
+        {
+            const size_t returnPos = stream->tell();
+            stream->seek( payloadPos );
+
+            if( codec == PayloadRaw )
+            {
+                bSuccess = stream->read( dst, sizeBytes ) == sizeBytes;
+            }
+            else
+            {
+                void *compressedData = OGRE_MALLOC_SIMD( storedSize, MEMCATEGORY_GEOMETRY );
+                FreeOnDestructor dataPtrContainer( compressedData );
+                bSuccess = stream->read( compressedData, storedSize ) == storedSize &&
+                           MeshPayloadCodec::decompress( compressedData, storedSize, stride, dst,
+                                                         sizeBytes );
+            }
+
+            stream->seek( returnPos );
+        }
+
+        if( !bSuccess )
+        {
+            OGRE_EXCEPT( Exception::ERR_INTERNAL_ERROR,
+                         "Buffer payload is truncated or corrupt in " + stream->getName(),
+                         "MeshSerializerImpl_v3_0::readPayload" );
+        }
+
+        mPayloadEnd = std::max( mPayloadEnd, payloadPos + storedSize );
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v2_1_R2::MeshSerializerImpl_v2_1_R2( VaoManager *vaoManager ) :
         MeshSerializerImpl( vaoManager )
+    {
+        // Version number
+        mVersion = "[MeshSerializer_v2.1 R2]";
+    }
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v2_1_R2::~MeshSerializerImpl_v2_1_R2() {}
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v2_1_R1::MeshSerializerImpl_v2_1_R1( VaoManager *vaoManager ) :
+        MeshSerializerImpl_v2_1_R2( vaoManager )
     {
         // Version number
         mVersion = "[MeshSerializer_v2.1 R1]";
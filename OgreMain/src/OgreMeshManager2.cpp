@@ -30,17 +30,30 @@ THE SOFTWARE.
 #include "OgreMeshManager2.h"
 
 #include "OgreException.h"
+#include "OgreLogManager.h"
 #include "OgreMatrix4.h"
 #include "OgreMesh2.h"
+#include "OgreMesh2Serializer.h"
 #include "OgreMeshManager.h"
 #include "OgrePatchMesh.h"
 #include "OgrePrefabFactory.h"
+#include "OgreProfiler.h"
 #include "OgreSubMesh2.h"
+#include "Vao/OgreIndexBufferPacked.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
 
 namespace Ogre
 {
     template <>
     MeshManager *Singleton<MeshManager>::msSingleton = 0;
+
+    unsigned long updateMeshAsyncLoadWorkerThread( ThreadHandle *threadHandle );
+    THREAD_DECLARE( updateMeshAsyncLoadWorkerThread );
+
+    /// Capacity of each shared vertex buffer. Matches what 16-bit indices can address.
+    static const uint32 c_sharedBufferMaxVertices = 65536u;
+    static const uint32 c_sharedBufferMaxIndices = c_sharedBufferMaxVertices * 3u;
     //-----------------------------------------------------------------------
     MeshManager *MeshManager::getSingletonPtr() { return msSingleton; }
     MeshManager &MeshManager::getSingleton()
@@ -49,7 +62,13 @@ namespace Ogre
         return ( *msSingleton );
     }
     //-----------------------------------------------------------------------
-    MeshManager::MeshManager() : mVaoManager( 0 ), mBoundsPaddingFactor( Real( 0.01 ) )
+    MeshManager::MeshManager() :
+        mVaoManager( 0 ),
+        mBoundsPaddingFactor( Real( 0.01 ) ),
+        mNumPendingAsyncLoads( 0u ),
+        mShuttingDown( false ),
+        mShareStaticBuffers( false ),
+        mSharedBuffersMaxVertices( 4096u )
     {
         mLoadOrder = 300.0f;
         mResourceType = "Mesh2";
@@ -59,6 +78,16 @@ namespace Ogre
     //-----------------------------------------------------------------------
     MeshManager::~MeshManager()
     {
+        shutdown();
+
+        // Meshes still using them were never unloaded. The VaoManager owns the buffers
+        SharedGeometryBufferVec::const_iterator itor = mSharedGeometryBuffers.begin();
+        SharedGeometryBufferVec::const_iterator endt = mSharedGeometryBuffers.end();
+        while( itor != endt )
+            OGRE_DELETE_T( *itor++, SharedGeometryBuffer, MEMCATEGORY_GEOMETRY );
+        mSharedGeometryBuffers.clear();
+        mSharedVaos.clear();
+
         ResourceGroupManager::getSingleton()._unregisterResourceManager( mResourceType );
     }
     //-----------------------------------------------------------------------
@@ -112,6 +141,329 @@ namespace Ogre
         return pMesh;
     }
     //-----------------------------------------------------------------------
+    MeshPtr MeshManager::loadAsync( const String &filename, const String &groupName,
+                                    Resource::Listener *listener, BufferType vertexBufferType,
+                                    BufferType indexBufferType, bool vertexBufferShadowed,
+                                    bool indexBufferShadowed )
+    {
+        MeshPtr pMesh = std::static_pointer_cast<Mesh>(
+            createOrRetrieve( filename, groupName, false, 0, 0, vertexBufferType, indexBufferType,
+                              vertexBufferShadowed, indexBufferShadowed )
+                .first );
+
+        if( listener )
+            pMesh->addListener( listener );
+
+        if( !mShuttingDown && pMesh->_beginAsyncLoad() )
+        {
+            AsyncLoadRequest request;
+            request.mesh = pMesh;
+            request.serializer = OGRE_NEW MeshSerializer( mVaoManager );
+
+            mAsyncLoadMutex.lock();
+            mAsyncLoadRequests.push_back( request );
+            mAsyncLoadMutex.unlock();
+
+            ++mNumPendingAsyncLoads;
+
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+            if( !mAsyncLoadWorkerThread )
+            {
+                mAsyncLoadWorkerThread =
+                    Threads::CreateThread( THREAD_GET( updateMeshAsyncLoadWorkerThread ), 0, this );
+            }
+            mAsyncLoadWorkerEvent.wake();
+#endif
+        }
+        else if( !pMesh->isLoading() )
+        {
+            // Manual or already loaded
+            const bool wasLoaded = pMesh->isLoaded();
+            pMesh->load();
+            if( wasLoaded && listener )
+                listener->loadingComplete( pMesh.get() );
+        }
+
+        return pMesh;
+    }
+    //-----------------------------------------------------------------------
+    unsigned long updateMeshAsyncLoadWorkerThread( ThreadHandle *threadHandle )
+    {
+        Threads::SetThreadName( threadHandle, "MeshAsyncLoad" );
+
+        MeshManager *meshManager = reinterpret_cast<MeshManager *>( threadHandle->getUserParam() );
+        return meshManager->_updateAsyncLoadWorkerThread( threadHandle );
+    }
+    //-----------------------------------------------------------------------
+    unsigned long MeshManager::_updateAsyncLoadWorkerThread( ThreadHandle * )
+    {
+        while( !mShuttingDown )
+        {
+            mAsyncLoadWorkerEvent.wait();
+            processAsyncLoadRequests();
+        }
+
+        return 0;
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::processAsyncLoadRequests()
+    {
+        AsyncLoadRequestVec requests;
+
+        mAsyncLoadMutex.lock();
+        requests.swap( mAsyncLoadRequests );
+        mAsyncLoadMutex.unlock();
+
+        AsyncLoadRequestVec::iterator itor = requests.begin();
+        AsyncLoadRequestVec::iterator endt = requests.end();
+
+        while( itor != endt && !mShuttingDown )
+        {
+            try
+            {
+                itor->mesh->_parseAsyncLoad( *itor->serializer );
+            }
+            catch( Exception &e )
+            {
+                itor->errorDescription = e.getFullDescription();
+            }
+
+            // Hand over each mesh as soon as it's ready
+            mAsyncLoadMutex.lock();
+            mAsyncLoadResults.push_back( *itor );
+            mAsyncLoadMutex.unlock();
+            mAsyncLoadResultsEvent.wake();
+
+            ++itor;
+        }
+
+        if( itor != endt )
+        {
+            // Shutting down. Leave the rest for shutdown() to abort
+            mAsyncLoadMutex.lock();
+            mAsyncLoadRequests.insert( mAsyncLoadRequests.end(), itor, endt );
+            mAsyncLoadMutex.unlock();
+        }
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::_update()
+    {
+#if OGRE_PLATFORM == OGRE_PLATFORM_EMSCRIPTEN
+        processAsyncLoadRequests();
+#endif
+
+        if( !mNumPendingAsyncLoads )
+            return;
+
+        OgreProfileExhaustive( "MeshManager::_update" );
+
+        AsyncLoadRequestVec results;
+
+        mAsyncLoadMutex.lock();
+        results.swap( mAsyncLoadResults );
+        mAsyncLoadMutex.unlock();
+
+        AsyncLoadRequestVec::iterator itor = results.begin();
+        AsyncLoadRequestVec::iterator endt = results.end();
+
+        while( itor != endt )
+        {
+            --mNumPendingAsyncLoads;
+
+            if( itor->errorDescription.empty() )
+            {
+                try
+                {
+                    itor->mesh->_finishAsyncLoad( *itor->serializer );
+                }
+                catch( Exception &e )
+                {
+                    itor->errorDescription = e.getFullDescription();
+                }
+            }
+
+            if( !itor->errorDescription.empty() )
+            {
+                LogManager::getSingleton().logMessage( "Asynchronous loading of Mesh " +
+                                                           itor->mesh->getName() +
+                                                           " failed: " + itor->errorDescription,
+                                                       LML_CRITICAL );
+                itor->mesh->_abortAsyncLoad();
+            }
+
+            OGRE_DELETE itor->serializer;
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::waitForAsyncLoads()
+    {
+        _update();
+        while( mNumPendingAsyncLoads )
+        {
+            mAsyncLoadResultsEvent.wait();
+            _update();
+        }
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::shutdown()
+    {
+        if( mShuttingDown )
+            return;
+
+        mShuttingDown = true;
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        if( mAsyncLoadWorkerThread )
+        {
+            mAsyncLoadWorkerEvent.wake();
+            Threads::WaitForThreads( 1u, &mAsyncLoadWorkerThread );
+            mAsyncLoadWorkerThread = ThreadHandlePtr();
+        }
+#endif
+
+        // The worker is gone, no need to lock
+        mAsyncLoadResults.insert( mAsyncLoadResults.end(), mAsyncLoadRequests.begin(),
+                                  mAsyncLoadRequests.end() );
+        mAsyncLoadRequests.clear();
+
+        AsyncLoadRequestVec::iterator itor = mAsyncLoadResults.begin();
+        AsyncLoadRequestVec::iterator endt = mAsyncLoadResults.end();
+
+        while( itor != endt )
+        {
+            itor->mesh->_abortAsyncLoad();
+            OGRE_DELETE itor->serializer;
+            ++itor;
+        }
+
+        mAsyncLoadResults.clear();
+        mNumPendingAsyncLoads = 0u;
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::setShareStaticBuffers( bool bShare, uint32 maxVerticesPerSubMesh )
+    {
+        mShareStaticBuffers = bShare;
+        mSharedBuffersMaxVertices = std::min( maxVerticesPerSubMesh, c_sharedBufferMaxVertices );
+    }
+    //-----------------------------------------------------------------------
+    MeshManager::SharedGeometryBuffer *MeshManager::_reserveSharedGeometry(
+        const VertexElement2Vec &vertexElements, bool index32Bit, uint32 numVertices,
+        uint32 numIndices )
+    {
+        if( numVertices > mSharedBuffersMaxVertices || numIndices > c_sharedBufferMaxIndices )
+            return 0;
+
+        const IndexBufferPacked::IndexType indexType =
+            index32Bit ? IndexBufferPacked::IT_32BIT : IndexBufferPacked::IT_16BIT;
+
+        SharedGeometryBufferVec::const_iterator itor = mSharedGeometryBuffers.begin();
+        SharedGeometryBufferVec::const_iterator endt = mSharedGeometryBuffers.end();
+
+        while( itor != endt )
+        {
+            SharedGeometryBuffer *sharedBuffer = *itor;
+            if( sharedBuffer->indexBuffer->getIndexType() == indexType &&
+                sharedBuffer->vertexBuffer->getVertexElements() == vertexElements &&
+                sharedBuffer->usedVertices + numVertices <= c_sharedBufferMaxVertices &&
+                sharedBuffer->usedIndices + numIndices <= c_sharedBufferMaxIndices )
+            {
+                return sharedBuffer;
+            }
+            ++itor;
+        }
+
+        SharedGeometryBuffer *sharedBuffer =
+            OGRE_NEW_T( SharedGeometryBuffer, MEMCATEGORY_GEOMETRY )();
+        // BT_DEFAULT rather than BT_IMMUTABLE since meshes get uploaded one by one
+        sharedBuffer->vertexBuffer = mVaoManager->createVertexBuffer(
+            vertexElements, c_sharedBufferMaxVertices, BT_DEFAULT, 0, false );
+        sharedBuffer->indexBuffer = mVaoManager->createIndexBuffer(
+            indexType, c_sharedBufferMaxIndices, BT_DEFAULT, 0, false );
+        sharedBuffer->usedVertices = 0u;
+        sharedBuffer->usedIndices = 0u;
+        sharedBuffer->numVaos = 0u;
+        mSharedGeometryBuffers.push_back( sharedBuffer );
+
+        return sharedBuffer;
+    }
+    //-----------------------------------------------------------------------
+    uint32 MeshManager::_uploadSharedVertices( SharedGeometryBuffer *sharedBuffer,
+                                               const void *vertexData, uint32 numVertices )
+    {
+        const uint32 baseVertex = sharedBuffer->usedVertices;
+        sharedBuffer->vertexBuffer->upload( vertexData, baseVertex, numVertices );
+        sharedBuffer->usedVertices += numVertices;
+        return baseVertex;
+    }
+    //-----------------------------------------------------------------------
+    VertexArrayObject *MeshManager::_createSharedVao( SharedGeometryBuffer *sharedBuffer,
+                                                      uint32 baseVertex, void *indexData,
+                                                      uint32 numIndices )
+    {
+        // Every mesh in the buffer shares the same baseVertex in the draw call,
+        // so the indices must point to their vertices within the shared buffer.
+        if( baseVertex )
+        {
+            if( sharedBuffer->indexBuffer->getIndexType() == IndexBufferPacked::IT_16BIT )
+            {
+                uint16 *indices = reinterpret_cast<uint16 *>( indexData );
+                for( uint32 i = 0u; i < numIndices; ++i )
+                    indices[i] = static_cast<uint16>( indices[i] + baseVertex );
+            }
+            else
+            {
+                uint32 *indices = reinterpret_cast<uint32 *>( indexData );
+                for( uint32 i = 0u; i < numIndices; ++i )
+                    indices[i] += baseVertex;
+            }
+        }
+
+        const uint32 firstIndex = sharedBuffer->usedIndices;
+        sharedBuffer->indexBuffer->upload( indexData, firstIndex, numIndices );
+        sharedBuffer->usedIndices += numIndices;
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( sharedBuffer->vertexBuffer );
+        VertexArrayObject *vao = mVaoManager->createVertexArrayObject(
+            vertexBuffers, sharedBuffer->indexBuffer, OT_TRIANGLE_LIST );
+        vao->setPrimitiveRange( firstIndex, numIndices );
+
+        ++sharedBuffer->numVaos;
+        mSharedVaos[vao] = sharedBuffer;
+
+        return vao;
+    }
+    //-----------------------------------------------------------------------
+    bool MeshManager::_destroySharedVao( VertexArrayObject *vao )
+    {
+        SharedVaoMap::iterator itVao = mSharedVaos.find( vao );
+        if( itVao == mSharedVaos.end() )
+            return false;
+
+        SharedGeometryBuffer *sharedBuffer = itVao->second;
+        mSharedVaos.erase( itVao );
+
+        mVaoManager->destroyVertexArrayObject( vao );
+
+        if( --sharedBuffer->numVaos == 0u )
+        {
+            mVaoManager->destroyVertexBuffer( sharedBuffer->vertexBuffer );
+            mVaoManager->destroyIndexBuffer( sharedBuffer->indexBuffer );
+
+            SharedGeometryBufferVec::iterator itor = std::find(
+                mSharedGeometryBuffers.begin(), mSharedGeometryBuffers.end(), sharedBuffer );
+            efficientVectorRemove( mSharedGeometryBuffers, itor );
+            OGRE_DELETE_T( sharedBuffer, SharedGeometryBuffer, MEMCATEGORY_GEOMETRY );
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------
+    bool MeshManager::_isSharedVao( const VertexArrayObject *vao ) const
+    {
+        return mSharedVaos.find( const_cast<VertexArrayObject *>( vao ) ) != mSharedVaos.end();
+    }
+    //-----------------------------------------------------------------------
     MeshPtr MeshManager::create( const String &name, const String &group, bool isManual,
                                  ManualResourceLoader *loader, const NameValuePairList *createParams )
     {
@@ -0,0 +1,752 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreMeshOptimizer.h"
+
+#include "OgrePlane.h"
+#include "OgreProfiler.h"
+#include "OgreVector3.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Ogre
+{
+    namespace
+    {
+        /// Size of the LRU cache simulated by Forsyth's algorithm
+        const uint32 c_forsythCacheSize = 32u;
+        /// Precomputed valence scores; higher valences are computed on the fly
+        const uint32 c_forsythMaxValence = 32u;
+        const float c_forsythCacheDecayPower = 1.5f;
+        const float c_forsythLastTriScore = 0.75f;
+        const float c_forsythValenceBoostScale = 2.0f;
+        const float c_forsythValenceBoostPower = 0.5f;
+
+        /// Size of the FIFO cache used to find cluster boundaries for optimizeOverdraw
+        const uint32 c_overdrawCacheSize = 16u;
+
+        const uint32 c_invalidTriangle = 0xFFFFFFFFu;
+
+        struct ForsythScores
+        {
+            /// Last entry is for vertices not in the cache
+            float cache[c_forsythCacheSize + 1u];
+            float valence[c_forsythMaxValence + 1u];
+
+            ForsythScores()
+            {
+                for( uint32 i = 0u; i < c_forsythCacheSize; ++i )
+                {
+                    if( i < 3u )
+                    {
+                        // Vertices of the last triangle get a fixed score, to avoid
+                        // favouring them so much that we emit the same triangle twice.
+                        cache[i] = c_forsythLastTriScore;
+                    }
+                    else
+                    {
+                        const float scaler = 1.0f / float( c_forsythCacheSize - 3u );
+                        cache[i] = std::pow( 1.0f - float( i - 3u ) * scaler, c_forsythCacheDecayPower );
+                    }
+                }
+                cache[c_forsythCacheSize] = 0.0f;
+
+                valence[0] = 0.0f;
+                for( uint32 i = 1u; i <= c_forsythMaxValence; ++i )
+                    valence[i] = getValenceScore( i );
+            }
+
+            static float getValenceScore( uint32 remainingValence )
+            {
+                return c_forsythValenceBoostScale *
+                       std::pow( float( remainingValence ), -c_forsythValenceBoostPower );
+            }
+
+            float getScore( uint32 cachePos, uint32 remainingValence ) const
+            {
+                // No triangles left to emit: vertex is worthless
+                if( remainingValence == 0u )
+                    return -1.0f;
+
+                const float valenceScore = remainingValence <= c_forsythMaxValence
+                                               ? valence[remainingValence]
+                                               : getValenceScore( remainingValence );
+                return cache[std::min( cachePos, c_forsythCacheSize )] + valenceScore;
+            }
+        };
+
+        /// Simulates a FIFO cache using timestamps. Returns the number of misses
+        inline uint32 updateFifoCache( const uint32 *triIndices, uint32 cacheSize, uint32 *timestamps,
+                                       uint32 &currentTimestamp )
+        {
+            uint32 misses = 0u;
+            for( size_t i = 0u; i < 3u; ++i )
+            {
+                const uint32 idx = triIndices[i];
+                if( currentTimestamp - timestamps[idx] > cacheSize )
+                {
+                    timestamps[idx] = currentTimestamp++;
+                    ++misses;
+                }
+            }
+            return misses;
+        }
+
+        /// Builds the list of triangles that use each vertex. The triangles of vertex i
+        /// are in adjacency[offsets[i]] to adjacency[offsets[i+1]] (exclusive)
+        void buildTriangleAdjacency( const uint32 *indices, size_t numIndices, size_t numVertices,
+                                     vector<uint32>::type &outValences,
+                                     vector<uint32>::type &outOffsets,
+                                     vector<uint32>::type &outAdjacency )
+        {
+            outValences.clear();
+            outValences.resize( numVertices, 0u );
+            for( size_t i = 0u; i < numIndices; ++i )
+            {
+                OGRE_ASSERT_LOW( indices[i] < numVertices );
+                ++outValences[indices[i]];
+            }
+
+            outOffsets.resize( numVertices + 1u );
+            outOffsets[0] = 0u;
+            for( size_t i = 0u; i < numVertices; ++i )
+                outOffsets[i + 1u] = outOffsets[i] + outValences[i];
+
+            outAdjacency.resize( numIndices );
+            vector<uint32>::type fillCount( outOffsets.begin(), outOffsets.end() - 1 );
+            for( size_t i = 0u; i < numIndices; ++i )
+                outAdjacency[fillCount[indices[i]]++] = static_cast<uint32>( i / 3u );
+        }
+
+        struct OverdrawCluster
+        {
+            size_t triStart;
+            size_t triEnd;
+            float sortKey;
+        };
+
+        bool orderClustersBySortKey( const OverdrawCluster &a, const OverdrawCluster &b )
+        {
+            return a.sortKey > b.sortKey;
+        }
+
+        inline Vector3 getPosition( const float *positions, size_t positionStride, uint32 idx )
+        {
+            const float *pos = reinterpret_cast<const float *>(
+                reinterpret_cast<const uint8 *>( positions ) + idx * positionStride );
+            return Vector3( pos[0], pos[1], pos[2] );
+        }
+
+        void computeMeshletBounds( MeshOptimizer::Meshlet &meshlet, const uint32 *indices,
+                                   const float *positions, size_t positionStride )
+        {
+            Vector3 vMin( std::numeric_limits<Real>::max() );
+            Vector3 vMax( -std::numeric_limits<Real>::max() );
+
+            for( size_t i = 0u; i < meshlet.indexCount; ++i )
+            {
+                const Vector3 pos = getPosition( positions, positionStride, indices[i] );
+                vMin.makeFloor( pos );
+                vMax.makeCeil( pos );
+            }
+
+            const Vector3 center = ( vMin + vMax ) * Real( 0.5 );
+            Real radiusSq = 0;
+            for( size_t i = 0u; i < meshlet.indexCount; ++i )
+            {
+                const Vector3 pos = getPosition( positions, positionStride, indices[i] );
+                radiusSq = std::max( radiusSq, center.squaredDistance( pos ) );
+            }
+
+            vector<Vector3>::type normals;
+            normals.reserve( meshlet.indexCount / 3u );
+            Vector3 coneAxis( Vector3::ZERO );
+            for( size_t i = 0u; i < meshlet.indexCount; i += 3u )
+            {
+                const Vector3 p0 = getPosition( positions, positionStride, indices[i + 0u] );
+                const Vector3 p1 = getPosition( positions, positionStride, indices[i + 1u] );
+                const Vector3 p2 = getPosition( positions, positionStride, indices[i + 2u] );
+
+                Vector3 normal = ( p1 - p0 ).crossProduct( p2 - p0 );
+                if( normal.normalise() > Real( 0 ) )  // Ignore degenerate triangles
+                {
+                    normals.push_back( normal );
+                    coneAxis += normal;
+                }
+            }
+
+            Real minDot = -1;
+            if( coneAxis.normalise() > Real( 0 ) )
+            {
+                minDot = 1;
+                vector<Vector3>::type::const_iterator itor = normals.begin();
+                vector<Vector3>::type::const_iterator endt = normals.end();
+                while( itor != endt )
+                    minDot = std::min( minDot, coneAxis.dotProduct( *itor++ ) );
+            }
+
+            for( size_t i = 0u; i < 3u; ++i )
+            {
+                meshlet.center[i] = static_cast<float>( center[i] );
+                meshlet.coneAxis[i] = static_cast<float>( coneAxis[i] );
+            }
+            meshlet.radius = static_cast<float>( std::sqrt( radiusSq ) );
+
+            // The cone spans more than a hemisphere: it can never be backface culled.
+            // Otherwise coneCutoff = sin( angle ), where cos( angle ) = minDot.
+            meshlet.coneCutoff =
+                minDot <= Real( 0 ) ? 1.0f
+                                    : static_cast<float>( std::sqrt( Real( 1 ) - minDot * minDot ) );
+        }
+    }  // namespace
+
+    MeshOptimizer::VertexCacheStats::VertexCacheStats() :
+        numTriangles( 0 ),
+        numVertices( 0 ),
+        numCacheMisses( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    float MeshOptimizer::VertexCacheStats::getAcmr() const
+    {
+        return numTriangles ? float( numCacheMisses ) / float( numTriangles ) : 0.0f;
+    }
+    //-----------------------------------------------------------------------------------
+    float MeshOptimizer::VertexCacheStats::getAtvr() const
+    {
+        return numVertices ? float( numCacheMisses ) / float( numVertices ) : 0.0f;
+    }
+    //-----------------------------------------------------------------------------------
+    MeshOptimizer::VertexCacheStats &MeshOptimizer::VertexCacheStats::operator+=(
+        const VertexCacheStats &other )
+    {
+        numTriangles += other.numTriangles;
+        numVertices += other.numVertices;
+        numCacheMisses += other.numCacheMisses;
+        return *this;
+    }
+    //-----------------------------------------------------------------------------------
+    MeshOptimizer::VertexCacheStats MeshOptimizer::analyzeVertexCache( const uint32 *indices,
+                                                                       size_t numIndices,
+                                                                       size_t numVertices,
+                                                                       uint32 cacheSize )
+    {
+        OGRE_ASSERT_LOW( numIndices % 3u == 0u );
+
+        VertexCacheStats stats;
+        stats.numTriangles = numIndices / 3u;
+
+        vector<uint32>::type timestamps( numVertices, 0u );
+        uint32 currentTimestamp = cacheSize + 1u;
+
+        for( size_t i = 0u; i < numIndices; i += 3u )
+        {
+            stats.numCacheMisses +=
+                updateFifoCache( indices + i, cacheSize, &timestamps[0], currentTimestamp );
+        }
+
+        for( size_t i = 0u; i < numVertices; ++i )
+            stats.numVertices += timestamps[i] != 0u ? 1u : 0u;
+
+        return stats;
+    }
+    //-----------------------------------------------------------------------------------
+    void MeshOptimizer::optimizeVertexCache( uint32 *outIndices, const uint32 *inIndices,
+                                             size_t numIndices, size_t numVertices )
+    {
+        OgreProfileExhaustive( "MeshOptimizer::optimizeVertexCache" );
+
+        OGRE_ASSERT_LOW( numIndices % 3u == 0u );
+        OGRE_ASSERT_LOW( outIndices != inIndices );
+
+        const size_t numTriangles = numIndices / 3u;
+        if( numTriangles == 0u )
+            return;
+
+        const ForsythScores scores;
+
+        vector<uint32>::type remainingValence;
+        vector<uint32>::type adjacencyOffsets;
+        vector<uint32>::type adjacency;
+        buildTriangleAdjacency( inIndices, numIndices, numVertices, remainingValence, adjacencyOffsets,
+                                adjacency );
+
+        vector<uint32>::type cachePos( numVertices, c_forsythCacheSize );
+        vector<float>::type vertexScores( numVertices );
+        for( size_t i = 0u; i < numVertices; ++i )
+            vertexScores[i] = scores.getScore( c_forsythCacheSize, remainingValence[i] );
+
+        vector<uint8>::type emitted( numTriangles, 0u );
+
+        uint32 bestTriangle = 0u;
+        float bestScore = -1.0f;
+        for( size_t i = 0u; i < numTriangles; ++i )
+        {
+            const uint32 *triIndices = inIndices + i * 3u;
+            const float score = vertexScores[triIndices[0]] + vertexScores[triIndices[1]] +
+                                vertexScores[triIndices[2]];
+            if( score > bestScore )
+            {
+                bestScore = score;
+                bestTriangle = static_cast<uint32>( i );
+            }
+        }
+
+        // +3 because the emitted triangle temporarily pushes entries out of the cache
+        uint32 cache[c_forsythCacheSize + 3u];
+        uint32 newCache[c_forsythCacheSize + 3u];
+        size_t cacheEntries = 0u;
+        size_t nextCandidate = 0u;
+
+        for( size_t outTri = 0u; outTri < numTriangles; ++outTri )
+        {
+            if( bestTriangle == c_invalidTriangle )
+            {
+                // Nothing in the cache is connected to unemitted triangles. Pick the next
+                // unemitted one in the original order. This is amortized O(numTriangles).
+                while( emitted[nextCandidate] )
+                    ++nextCandidate;
+                bestTriangle = static_cast<uint32>( nextCandidate );
+            }
+
+            const uint32 *triIndices = inIndices + bestTriangle * 3u;
+            emitted[bestTriangle] = 1u;
+            outIndices[outTri * 3u + 0u] = triIndices[0];
+            outIndices[outTri * 3u + 1u] = triIndices[1];
+            outIndices[outTri * 3u + 2u] = triIndices[2];
+
+            // Move the triangle's vertices to the front of the LRU cache
+            size_t newCacheEntries = 0u;
+            for( size_t i = 0u; i < 3u; ++i )
+            {
+                newCache[newCacheEntries++] = triIndices[i];
+                --remainingValence[triIndices[i]];
+            }
+            for( size_t i = 0u; i < cacheEntries; ++i )
+            {
+                const uint32 vertexIdx = cache[i];
+                if( vertexIdx != triIndices[0] && vertexIdx != triIndices[1] &&
+                    vertexIdx != triIndices[2] )
+                {
+                    newCache[newCacheEntries++] = vertexIdx;
+                }
+            }
+
+            // Update the scores of the vertices whose position changed (including
+            // those that just got pushed out of the cache)
+            for( size_t i = 0u; i < newCacheEntries; ++i )
+            {
+                const uint32 vertexIdx = newCache[i];
+                cachePos[vertexIdx] = i < c_forsythCacheSize ? static_cast<uint32>( i )  //
+                                                             : c_forsythCacheSize;
+                vertexScores[vertexIdx] =
+                    scores.getScore( cachePos[vertexIdx], remainingValence[vertexIdx] );
+            }
+
+            // Update the triangles touched by those vertices and find the new best one
+            bestTriangle = c_invalidTriangle;
+            bestScore = -1.0f;
+            for( size_t i = 0u; i < newCacheEntries; ++i )
+            {
+                const uint32 vertexIdx = newCache[i];
+                const uint32 adjEnd = adjacencyOffsets[vertexIdx + 1u];
+                for( uint32 j = adjacencyOffsets[vertexIdx]; j < adjEnd; ++j )
+                {
+                    const uint32 triIdx = adjacency[j];
+                    if( !emitted[triIdx] )
+                    {
+                        const uint32 *adjTriIndices = inIndices + triIdx * 3u;
+                        const float score = vertexScores[adjTriIndices[0]] +
+                                            vertexScores[adjTriIndices[1]] +
+                                            vertexScores[adjTriIndices[2]];
+                        if( score > bestScore )
+                        {
+                            bestScore = score;
+                            bestTriangle = triIdx;
+                        }
+                    }
+                }
+            }
+
+            cacheEntries = std::min<size_t>( newCacheEntries, c_forsythCacheSize );
+            memcpy( cache, newCache, cacheEntries * sizeof( uint32 ) );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    size_t MeshOptimizer::optimizeOverdraw( uint32 *outIndices, const uint32 *inIndices,
+                                            size_t numIndices, const float *positions,
+                                            size_t positionStride, size_t numVertices,
+                                            float threshold )
+    {
+        OgreProfileExhaustive( "MeshOptimizer::optimizeOverdraw" );
+
+        OGRE_ASSERT_LOW( numIndices % 3u == 0u );
+        OGRE_ASSERT_LOW( outIndices != inIndices );
+
+        const size_t numTriangles = numIndices / 3u;
+        if( numTriangles == 0u )
+            return 0u;
+
+        vector<uint32>::type timestamps( numVertices, 0u );
+        uint32 currentTimestamp = c_overdrawCacheSize + 1u;
+
+        // Hard boundaries: triangles where all 3 vertices miss the cache. Splitting here
+        // doesn't change the ACMR because the cache was effectively flushed.
+        vector<size_t>::type hardBoundaries;
+        hardBoundaries.push_back( 0u );
+        for( size_t i = 0u; i < numTriangles; ++i )
+        {
+            const uint32 misses = updateFifoCache( inIndices + i * 3u, c_overdrawCacheSize,
+                                                   &timestamps[0], currentTimestamp );
+            if( misses == 3u && i != 0u )
+                hardBoundaries.push_back( i );
+        }
+        hardBoundaries.push_back( numTriangles );
+
+        // Soft boundaries: split hard clusters further, but only where the ACMR of everything
+        // emitted so far (including the misses caused by flushing the cache at previous
+        // splits) stays within threshold * ACMR of the hard cluster. Each split has to be
+        // paid for by the triangles before it, so ACMR can't drift above the threshold.
+        vector<OverdrawCluster>::type clusters;
+        for( size_t i = 0u; i < hardBoundaries.size() - 1u; ++i )
+        {
+            const size_t clusterStart = hardBoundaries[i];
+            const size_t clusterEnd = hardBoundaries[i + 1u];
+
+            OverdrawCluster cluster;
+            cluster.triStart = clusterStart;
+            cluster.sortKey = 0.0f;
+
+            if( threshold > 1.0f )
+            {
+                currentTimestamp += c_overdrawCacheSize + 1u;  // Flush the cache
+                size_t clusterMisses = 0u;
+                for( size_t j = clusterStart; j < clusterEnd; ++j )
+                {
+                    clusterMisses += updateFifoCache( inIndices + j * 3u, c_overdrawCacheSize,
+                                                      &timestamps[0], currentTimestamp );
+                }
+
+                const float acmrThreshold =
+                    threshold * float( clusterMisses ) / float( clusterEnd - clusterStart );
+
+                currentTimestamp += c_overdrawCacheSize + 1u;
+                size_t misses = 0u;
+                for( size_t j = clusterStart; j < clusterEnd - 1u; ++j )
+                {
+                    misses += updateFifoCache( inIndices + j * 3u, c_overdrawCacheSize,
+                                               &timestamps[0], currentTimestamp );
+                    // The flush makes the next triangle miss all 3 vertices. Account for
+                    // them now, so the split only happens if we can afford it.
+                    if( float( misses + 3u ) <= acmrThreshold * float( j + 2u - clusterStart ) )
+                    {
+                        cluster.triEnd = j + 1u;
+                        clusters.push_back( cluster );
+                        cluster.triStart = j + 1u;
+                        currentTimestamp += c_overdrawCacheSize + 1u;
+                    }
+                }
+            }
+
+            cluster.triEnd = clusterEnd;
+            clusters.push_back( cluster );
+        }
+
+        // Calculate the area weighted centroid & normal of each cluster.
+        vector<Vector3>::type clusterCentroids( clusters.size(), Vector3::ZERO );
+        vector<Vector3>::type clusterNormals( clusters.size(), Vector3::ZERO );
+        Vector3 meshCentroid( Vector3::ZERO );
+        Real meshArea = 0;
+
+        for( size_t i = 0u; i < clusters.size(); ++i )
+        {
+            Real clusterArea = 0;
+            for( size_t j = clusters[i].triStart; j < clusters[i].triEnd; ++j )
+            {
+                const uint32 *triIndices = inIndices + j * 3u;
+                const Vector3 p0 = getPosition( positions, positionStride, triIndices[0] );
+                const Vector3 p1 = getPosition( positions, positionStride, triIndices[1] );
+                const Vector3 p2 = getPosition( positions, positionStride, triIndices[2] );
+
+                const Vector3 normal = ( p1 - p0 ).crossProduct( p2 - p0 );
+                const Real area = normal.length();
+
+                clusterCentroids[i] += ( p0 + p1 + p2 ) * ( area / Real( 3.0 ) );
+                clusterNormals[i] += normal;
+                clusterArea += area;
+            }
+
+            meshCentroid += clusterCentroids[i];
+            meshArea += clusterArea;
+
+            if( clusterArea > Real( 0 ) )
+                clusterCentroids[i] /= clusterArea;
+            clusterNormals[i].normalise();
+        }
+
+        if( meshArea > Real( 0 ) )
+            meshCentroid /= meshArea;
+
+        // Clusters facing away from the centroid are more likely to occlude
+        // the rest of the mesh, thus they should be rendered first.
+        for( size_t i = 0u; i < clusters.size(); ++i )
+        {
+            const Vector3 centroidDir = clusterCentroids[i] - meshCentroid;
+            clusters[i].sortKey = static_cast<float>( centroidDir.dotProduct( clusterNormals[i] ) );
+        }
+
+        std::stable_sort( clusters.begin(), clusters.end(), orderClustersBySortKey );
+
+        uint32 *outIndicesStart = outIndices;
+        vector<OverdrawCluster>::type::const_iterator itor = clusters.begin();
+        vector<OverdrawCluster>::type::const_iterator endt = clusters.end();
+
+        while( itor != endt )
+        {
+            const size_t numClusterIndices = ( itor->triEnd - itor->triStart ) * 3u;
+            memcpy( outIndices, inIndices + itor->triStart * 3u, numClusterIndices * sizeof( uint32 ) );
+            outIndices += numClusterIndices;
+            ++itor;
+        }
+
+        OGRE_ASSERT_LOW( size_t( outIndices - outIndicesStart ) == numIndices );
+        (void)outIndicesStart;
+
+        return clusters.size();
+    }
+    //-----------------------------------------------------------------------------------
+    void MeshOptimizer::buildMeshlets( uint32 *outIndices, MeshletVec &outMeshlets,
+                                       const uint32 *inIndices, size_t numIndices,
+                                       const float *positions, size_t positionStride,
+                                       size_t numVertices, uint32 maxVertices, uint32 maxTriangles )
+    {
+        OgreProfileExhaustive( "MeshOptimizer::buildMeshlets" );
+
+        OGRE_ASSERT_LOW( numIndices % 3u == 0u );
+        OGRE_ASSERT_LOW( outIndices != inIndices );
+        OGRE_ASSERT_LOW( maxVertices >= 3u && maxTriangles >= 1u );
+
+        const size_t numTriangles = numIndices / 3u;
+
+        vector<uint32>::type valences;
+        vector<uint32>::type adjacencyOffsets;
+        vector<uint32>::type adjacency;
+        buildTriangleAdjacency( inIndices, numIndices, numVertices, valences, adjacencyOffsets,
+                                adjacency );
+
+        vector<uint8>::type emitted( numTriangles, 0u );
+        // Index of the meshlet the vertex was last added to
+        vector<uint32>::type vertexMeshlet( numVertices, c_invalidTriangle );
+        vector<uint32>::type meshletVertices;
+        meshletVertices.reserve( maxVertices );
+
+        size_t nextCandidate = 0u;
+        size_t outTri = 0u;
+
+        while( outTri < numTriangles )
+        {
+            const uint32 meshletIdx = static_cast<uint32>( outMeshlets.size() );
+
+            Meshlet meshlet;
+            memset( &meshlet, 0, sizeof( meshlet ) );
+            meshlet.indexStart = static_cast<uint32>( outTri * 3u );
+            meshletVertices.clear();
+
+            while( meshlet.indexCount < maxTriangles * 3u )
+            {
+                // Grow through the triangle that adds the fewest new vertices
+                uint32 bestTriangle = c_invalidTriangle;
+                uint32 bestSharedVertices = 0u;
+
+                vector<uint32>::type::const_iterator itVertex = meshletVertices.begin();
+                vector<uint32>::type::const_iterator enVertex = meshletVertices.end();
+                while( itVertex != enVertex && bestSharedVertices < 3u )
+                {
+                    const uint32 adjEnd = adjacencyOffsets[*itVertex + 1u];
+                    for( uint32 j = adjacencyOffsets[*itVertex]; j < adjEnd; ++j )
+                    {
+                        const uint32 triIdx = adjacency[j];
+                        if( emitted[triIdx] )
+                            continue;
+
+                        const uint32 *triIndices = inIndices + triIdx * 3u;
+                        uint32 sharedVertices = 0u;
+                        for( size_t k = 0u; k < 3u; ++k )
+                            sharedVertices += vertexMeshlet[triIndices[k]] == meshletIdx ? 1u : 0u;
+
+                        if( sharedVertices > bestSharedVertices &&
+                            meshletVertices.size() + 3u - sharedVertices <= maxVertices )
+                        {
+                            bestSharedVertices = sharedVertices;
+                            bestTriangle = triIdx;
+                        }
+                    }
+                    ++itVertex;
+                }
+
+                if( bestTriangle == c_invalidTriangle )
+                {
+                    // Nothing connected. Continue with the next triangle in the original order
+                    // (which should be close by if optimizeVertexCache was used) if it fits.
+                    while( nextCandidate < numTriangles && emitted[nextCandidate] )
+                        ++nextCandidate;
+
+                    if( nextCandidate == numTriangles )
+                        break;
+
+                    const uint32 *triIndices = inIndices + nextCandidate * 3u;
+                    uint32 newVertices = 0u;
+                    for( size_t k = 0u; k < 3u; ++k )
+                        newVertices += vertexMeshlet[triIndices[k]] == meshletIdx ? 0u : 1u;
+
+                    if( meshletVertices.size() + newVertices > maxVertices )
+                        break;
+
+                    bestTriangle = static_cast<uint32>( nextCandidate );
+                }
+
+                const uint32 *triIndices = inIndices + bestTriangle * 3u;
+                emitted[bestTriangle] = 1u;
+                for( size_t k = 0u; k < 3u; ++k )
+                {
+                    outIndices[outTri * 3u + k] = triIndices[k];
+                    if( vertexMeshlet[triIndices[k]] != meshletIdx )
+                    {
+                        vertexMeshlet[triIndices[k]] = meshletIdx;
+                        meshletVertices.push_back( triIndices[k] );
+                    }
+                }
+                ++outTri;
+                meshlet.indexCount += 3u;
+            }
+
+            OGRE_ASSERT_LOW( meshlet.indexCount > 0u );
+
+            meshlet.vertexCount = static_cast<uint32>( meshletVertices.size() );
+            computeMeshletBounds( meshlet, outIndices + meshlet.indexStart, positions, positionStride );
+            outMeshlets.push_back( meshlet );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    size_t MeshOptimizer::cullMeshlets( uint32 *outVisibleMeshlets, const Meshlet *meshlets,
+                                        size_t numMeshlets, const Vector3 &cameraPos,
+                                        const Plane *planes, size_t numPlanes )
+    {
+        size_t numVisible = 0u;
+
+        for( size_t i = 0u; i < numMeshlets; ++i )
+        {
+            const Meshlet &meshlet = meshlets[i];
+            const Vector3 center( meshlet.center[0], meshlet.center[1], meshlet.center[2] );
+
+            bool isVisible = true;
+            for( size_t j = 0u; j < numPlanes && isVisible; ++j )
+                isVisible = planes[j].getDistance( center ) >= -meshlet.radius;
+
+            if( isVisible && meshlet.coneCutoff < 1.0f )
+            {
+                const Vector3 coneAxis( meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2] );
+                const Vector3 camToCenter = center - cameraPos;
+                isVisible = camToCenter.dotProduct( coneAxis ) <
+                            meshlet.coneCutoff * camToCenter.length() + meshlet.radius;
+            }
+
+            if( isVisible )
+                outVisibleMeshlets[numVisible++] = static_cast<uint32>( i );
+        }
+
+        return numVisible;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t MeshOptimizer::compactMeshletIndices( uint32 *outIndices, const uint32 *indices,
+                                                 const Meshlet *meshlets,
+                                                 const uint32 *visibleMeshlets,
+                                                 size_t numVisibleMeshlets )
+    {
+        size_t numIndices = 0u;
+        for( size_t i = 0u; i < numVisibleMeshlets; ++i )
+        {
+            const Meshlet &meshlet = meshlets[visibleMeshlets[i]];
+            memcpy( outIndices + numIndices, indices + meshlet.indexStart,
+                    meshlet.indexCount * sizeof( uint32 ) );
+            numIndices += meshlet.indexCount;
+        }
+        return numIndices;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t MeshOptimizer::optimizeVertexFetchRemap( uint32 *outRemap, const uint32 *indices,
+                                                    size_t numIndices, size_t numVertices )
+    {
+        const uint32 c_unassigned = 0xFFFFFFFFu;
+
+        for( size_t i = 0u; i < numVertices; ++i )
+            outRemap[i] = c_unassigned;
+
+        uint32 nextVertex = 0u;
+        for( size_t i = 0u; i < numIndices; ++i )
+        {
+            OGRE_ASSERT_LOW( indices[i] < numVertices );
+            if( outRemap[indices[i]] == c_unassigned )
+                outRemap[indices[i]] = nextVertex++;
+        }
+
+        const size_t numReferencedVertices = nextVertex;
+
+        // Keep unreferenced vertices (e.g. used by other LODs or by no one) at the end
+        for( size_t i = 0u; i < numVertices; ++i )
+        {
+            if( outRemap[i] == c_unassigned )
+                outRemap[i] = nextVertex++;
+        }
+
+        return numReferencedVertices;
+    }
+    //-----------------------------------------------------------------------------------
+    void MeshOptimizer::remapIndices( uint32 *indices, size_t numIndices, const uint32 *remap )
+    {
+        for( size_t i = 0u; i < numIndices; ++i )
+            indices[i] = remap[indices[i]];
+    }
+    //-----------------------------------------------------------------------------------
+    void MeshOptimizer::remapVertices( void *dst, const void *src, size_t numVertices,
+                                       size_t bytesPerVertex, const uint32 *remap )
+    {
+        OGRE_ASSERT_LOW( dst != src );
+
+        uint8 *dstBytes = reinterpret_cast<uint8 *>( dst );
+        const uint8 *srcBytes = reinterpret_cast<const uint8 *>( src );
+        for( size_t i = 0u; i < numVertices; ++i )
+        {
+            memcpy( dstBytes + remap[i] * bytesPerVertex, srcBytes + i * bytesPerVertex,
+                    bytesPerVertex );
+        }
+    }
+}  // namespace Ogre
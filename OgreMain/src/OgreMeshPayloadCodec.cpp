@@ -0,0 +1,330 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+
+#include "OgreStableHeaders.h"
+
+#include "OgreMeshPayloadCodec.h"
+
+#include "OgreProfiler.h"
+#include "Vao/OgreBufferPacked.h"
+
+#include "ogrestd/vector.h"
+
+namespace Ogre
+{
+    namespace
+    {
+        const size_t c_minMatch = 4u;
+        const size_t c_maxOffset = 65535u;
+        const uint32 c_hashLog = 14u;
+
+        inline uint32 read32( const uint8 *ptr )
+        {
+            uint32 value;
+            memcpy( &value, ptr, sizeof( value ) );
+            return value;
+        }
+
+        inline uint32 hashSequence( uint32 sequence )
+        {
+            return ( sequence * 2654435761u ) >> ( 32u - c_hashLog );
+        }
+
+        /// Returns the number of bytes writeLength will use
+        inline size_t calcLengthSize( size_t length ) { return length / 255u + 1u; }
+
+        inline void writeLength( uint8 *&op, size_t length )
+        {
+            while( length >= 255u )
+            {
+                *op++ = 255u;
+                length -= 255u;
+            }
+            *op++ = static_cast<uint8>( length );
+        }
+
+        inline bool readLength( const uint8 *&ip, const uint8 *iend, size_t &inOutLength )
+        {
+            uint8 value;
+            do
+            {
+                if( ip >= iend )
+                    return false;
+                value = *ip++;
+                inOutLength += value;
+            } while( value == 255u );
+            return true;
+        }
+
+        /// Emits literals followed by a match. matchLength = 0 means there is no match
+        /// (last sequence). Returns false if it doesn't fit.
+        bool emitSequence( uint8 *&op, const uint8 *oend, const uint8 *literals, size_t numLiterals,
+                           size_t offset, size_t matchLength )
+        {
+            size_t neededBytes = 1u + numLiterals;
+            if( numLiterals >= 15u )
+                neededBytes += calcLengthSize( numLiterals - 15u );
+            if( matchLength )
+            {
+                neededBytes += 2u;
+                if( matchLength - c_minMatch >= 15u )
+                    neededBytes += calcLengthSize( matchLength - c_minMatch - 15u );
+            }
+
+            if( static_cast<size_t>( oend - op ) < neededBytes )
+                return false;
+
+            uint8 *token = op++;
+            uint8 tokenValue;
+
+            if( numLiterals >= 15u )
+            {
+                tokenValue = 15u << 4u;
+                writeLength( op, numLiterals - 15u );
+            }
+            else
+            {
+                tokenValue = static_cast<uint8>( numLiterals << 4u );
+            }
+
+            memcpy( op, literals, numLiterals );
+            op += numLiterals;
+
+            if( matchLength )
+            {
+                *op++ = static_cast<uint8>( offset & 0xFF );
+                *op++ = static_cast<uint8>( offset >> 8u );
+
+                const size_t extraLength = matchLength - c_minMatch;
+                if( extraLength >= 15u )
+                {
+                    tokenValue |= 15u;
+                    writeLength( op, extraLength - 15u );
+                }
+                else
+                {
+                    tokenValue |= static_cast<uint8>( extraLength );
+                }
+            }
+
+            *token = tokenValue;
+            return true;
+        }
+
+        /// Splits the data in byte planes and delta encodes each plane.
+        void filterBytePlanes( const uint8 *src, size_t size, size_t stride, uint8 *dst )
+        {
+            const size_t numElements = size / stride;
+            for( size_t b = 0u; b < stride; ++b )
+            {
+                uint8 *plane = dst + b * numElements;
+                uint8 prevValue = 0u;
+                for( size_t i = 0u; i < numElements; ++i )
+                {
+                    const uint8 value = src[i * stride + b];
+                    plane[i] = static_cast<uint8>( value - prevValue );
+                    prevValue = value;
+                }
+            }
+        }
+
+        /// Reverts filterBytePlanes
+        void unfilterBytePlanes( const uint8 *src, size_t size, size_t stride, uint8 *dst )
+        {
+            const size_t numElements = size / stride;
+            for( size_t b = 0u; b < stride; ++b )
+            {
+                const uint8 *plane = src + b * numElements;
+                uint8 value = 0u;
+                for( size_t i = 0u; i < numElements; ++i )
+                {
+                    value = static_cast<uint8>( value + plane[i] );
+                    dst[i * stride + b] = value;
+                }
+            }
+        }
+
+        inline size_t sanitizeStride( size_t srcSize, size_t stride )
+        {
+            return ( stride == 0u || srcSize % stride != 0u ) ? 1u : stride;
+        }
+    }  // namespace
+    //-------------------------------------------------------------------------
+    size_t MeshPayloadCodec::compressBound( size_t srcSize )
+    {
+        return 1u + srcSize + calcLengthSize( srcSize );
+    }
+    //-------------------------------------------------------------------------
+    size_t MeshPayloadCodec::compress( const void *src, size_t srcSize, size_t stride, void *dst,
+                                       size_t dstCapacity )
+    {
+        OgreProfileExhaustive( "MeshPayloadCodec::compress" );
+
+        stride = sanitizeStride( srcSize, stride );
+
+        uint8 *filtered =
+            reinterpret_cast<uint8 *>( OGRE_MALLOC_SIMD( srcSize + 1u, MEMCATEGORY_GEOMETRY ) );
+        FreeOnDestructor filteredPtrContainer( filtered );
+        filterBytePlanes( reinterpret_cast<const uint8 *>( src ), srcSize, stride, filtered );
+
+        vector<uint32>::type hashTable( 1u << c_hashLog, 0u );
+
+        const uint8 *ip = filtered;
+        const uint8 *anchor = filtered;
+        const uint8 *iend = filtered + srcSize;
+
+        uint8 *op = reinterpret_cast<uint8 *>( dst );
+        const uint8 *oend = op + dstCapacity;
+
+        while( static_cast<size_t>( iend - ip ) >= c_minMatch )
+        {
+            const uint32 sequence = read32( ip );
+            uint32 &hashEntry = hashTable[hashSequence( sequence )];
+
+            // Entries are stored + 1 so that 0 means empty
+            const size_t refPos = hashEntry;
+            hashEntry = static_cast<uint32>( ip - filtered ) + 1u;
+
+            if( refPos )
+            {
+                const uint8 *ref = filtered + refPos - 1u;
+                const size_t offset = static_cast<size_t>( ip - ref );
+                if( offset <= c_maxOffset && read32( ref ) == sequence )
+                {
+                    const uint8 *matchEnd = ip + c_minMatch;
+                    const uint8 *refEnd = ref + c_minMatch;
+                    while( matchEnd < iend && *matchEnd == *refEnd )
+                    {
+                        ++matchEnd;
+                        ++refEnd;
+                    }
+
+                    if( !emitSequence( op, oend, anchor, static_cast<size_t>( ip - anchor ), offset,
+                                       static_cast<size_t>( matchEnd - ip ) ) )
+                    {
+                        return 0u;
+                    }
+
+                    ip = matchEnd;
+                    anchor = ip;
+                    continue;
+                }
+            }
+
+            ++ip;
+        }
+
+        // Last literals
+        if( !emitSequence( op, oend, anchor, static_cast<size_t>( iend - anchor ), 0u, 0u ) )
+            return 0u;
+
+        return static_cast<size_t>( op - reinterpret_cast<uint8 *>( dst ) );
+    }
+    //-------------------------------------------------------------------------
+    bool MeshPayloadCodec::decompress( const void *src, size_t srcSize, size_t stride, void *dst,
+                                       size_t dstSize )
+    {
+        OgreProfileExhaustive( "MeshPayloadCodec::decompress" );
+
+        stride = sanitizeStride( dstSize, stride );
+
+        uint8 *filtered =
+            reinterpret_cast<uint8 *>( OGRE_MALLOC_SIMD( dstSize + 1u, MEMCATEGORY_GEOMETRY ) );
+        FreeOnDestructor filteredPtrContainer( filtered );
+
+        const uint8 *ip = reinterpret_cast<const uint8 *>( src );
+        const uint8 *iend = ip + srcSize;
+
+        uint8 *op = filtered;
+        const uint8 *oend = filtered + dstSize;
+
+        while( true )
+        {
+            if( ip >= iend )
+                return false;
+
+            const uint8 token = *ip++;
+
+            size_t numLiterals = token >> 4u;
+            if( numLiterals == 15u && !readLength( ip, iend, numLiterals ) )
+                return false;
+
+            if( numLiterals > static_cast<size_t>( iend - ip ) ||
+                numLiterals > static_cast<size_t>( oend - op ) )
+            {
+                return false;
+            }
+
+            memcpy( op, ip, numLiterals );
+            ip += numLiterals;
+            op += numLiterals;
+
+            if( ip == iend )
+                break;  // Last sequence has no match
+
+            if( iend - ip < 2 )
+                return false;
+
+            const size_t offset = static_cast<size_t>( ip[0] ) | ( static_cast<size_t>( ip[1] ) << 8u );
+            ip += 2u;
+
+            if( offset == 0u || offset > static_cast<size_t>( op - filtered ) )
+                return false;
+
+            size_t matchLength = token & 0x0Fu;
+            if( matchLength == 15u && !readLength( ip, iend, matchLength ) )
+                return false;
+            matchLength += c_minMatch;
+
+            if( matchLength > static_cast<size_t>( oend - op ) )
+                return false;
+
+            const uint8 *match = op - offset;
+            if( offset >= matchLength )
+            {
+                memcpy( op, match, matchLength );
+                op += matchLength;
+            }
+            else
+            {
+                // Overlapping copy (i.e. repeating pattern)
+                const uint8 *matchEnd = op + matchLength;
+                while( op != matchEnd )
+                    *op++ = *match++;
+            }
+        }
+
+        if( op != oend )
+            return false;
+
+        unfilterBytePlanes( filtered, dstSize, stride, reinterpret_cast<uint8 *>( dst ) );
+
+        return true;
+    }
+}  // namespace Ogre
@@ -67,6 +67,7 @@ namespace Ogre
         mManager( manager ),
         mLodMesh( &c_DefaultLodMesh ),
         mCurrentMeshLod( 0 ),
+        mLodValue( 0 ),
         mMinPixelSize( 0 ),
         mListener( 0 ),
         mSkeletonInstance( 0 ),
@@ -91,6 +92,7 @@ namespace Ogre
         mManager( 0 ),
         mLodMesh( &c_DefaultLodMesh ),
         mCurrentMeshLod( 0 ),
+        mLodValue( 0 ),
         mMinPixelSize( 0 ),
         mListener( 0 ),
         mSkeletonInstance( 0 ),
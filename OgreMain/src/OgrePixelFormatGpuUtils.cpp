@@ -38,6 +38,8 @@ THE SOFTWARE.
 #include "OgreProfiler.h"
 #include "OgreTextureBox.h"
 
+#include "Math/Array/OgreArrayConfig.h"
+
 namespace Ogre
 {
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC && OGRE_COMP_VER < 1800
@@ -1236,6 +1238,125 @@ namespace Ogre
 #endif
     }
     //-----------------------------------------------------------------------------------
+    namespace
+    {
+        typedef void ( *rg_gather_func_t )( const uint8 *src, float *dst, size_t width,
+                                            size_t bytesPerPixel );
+
+        /// Reads R & G of each pixel as floats, exactly like unpackColour would
+        void gatherRGFloat( const uint8 *src, float *dst, size_t width, size_t bytesPerPixel )
+        {
+            while( width-- )
+            {
+                memcpy( dst, src, sizeof( float ) * 2u );
+                src += bytesPerPixel;
+                dst += 2u;
+            }
+        }
+        void gatherRGHalf( const uint8 *src, float *dst, size_t width, size_t bytesPerPixel )
+        {
+            while( width-- )
+            {
+                uint16 rg[2];
+                memcpy( rg, src, sizeof( rg ) );
+                dst[0] = Bitwise::halfToFloat( rg[0] );
+                dst[1] = Bitwise::halfToFloat( rg[1] );
+                src += bytesPerPixel;
+                dst += 2u;
+            }
+        }
+        void gatherRGUnorm16( const uint8 *src, float *dst, size_t width, size_t bytesPerPixel )
+        {
+            while( width-- )
+            {
+                uint16 rg[2];
+                memcpy( rg, src, sizeof( rg ) );
+                dst[0] = static_cast<float>( rg[0] ) / 65535.0f;
+                dst[1] = static_cast<float>( rg[1] ) / 65535.0f;
+                src += bytesPerPixel;
+                dst += 2u;
+            }
+        }
+        void gatherRGSnorm16( const uint8 *src, float *dst, size_t width, size_t bytesPerPixel )
+        {
+            while( width-- )
+            {
+                int16 rg[2];
+                memcpy( rg, src, sizeof( rg ) );
+                dst[0] = std::max( static_cast<float>( rg[0] ) / 32767.0f, -1.0f );
+                dst[1] = std::max( static_cast<float>( rg[1] ) / 32767.0f, -1.0f );
+                src += bytesPerPixel;
+                dst += 2u;
+            }
+        }
+
+        /// Returns the function that can read R & G directly from srcFormat, or a null
+        /// pointer if srcFormat must go through unpackColour
+        rg_gather_func_t getRGGatherFunc( PixelFormatGpu srcFormat )
+        {
+            const uint32 flags = PixelFormatGpuUtils::getFlags( srcFormat );
+            switch( PixelFormatGpuUtils::getPixelLayout( srcFormat ) )
+            {
+            case PixelFormatGpuUtils::PFL_RGBA32:
+            case PixelFormatGpuUtils::PFL_RGB32:
+            case PixelFormatGpuUtils::PFL_RG32:
+                if( flags == PixelFormatGpuUtils::PFF_FLOAT )
+                    return gatherRGFloat;
+                break;
+            case PixelFormatGpuUtils::PFL_RGBA16:
+            case PixelFormatGpuUtils::PFL_RGB16:
+            case PixelFormatGpuUtils::PFL_RG16:
+                if( flags == PixelFormatGpuUtils::PFF_HALF )
+                    return gatherRGHalf;
+                if( flags == PixelFormatGpuUtils::PFF_NORMALIZED )
+                    return gatherRGUnorm16;
+                if( flags == ( PixelFormatGpuUtils::PFF_NORMALIZED | PixelFormatGpuUtils::PFF_SIGNED ) )
+                    return gatherRGSnorm16;
+                break;
+            default:
+                break;
+            }
+            return 0;
+        }
+
+        /// Does Bitwise::floatToSnorm8( src[i] * multPart - addPart ) for every value
+        void convFloatToNormalMapSnorm8( const float *RESTRICT_ALIAS src, int8 *RESTRICT_ALIAS dst,
+                                         size_t numValues, float multPart, float addPart )
+        {
+#if OGRE_CPU == OGRE_CPU_X86 && OGRE_USE_SIMD == 1
+            const __m128 vMult = _mm_set1_ps( multPart );
+            const __m128 vAdd = _mm_set1_ps( addPart );
+            const __m128 vScale = _mm_set1_ps( 127.0f );
+            const __m128 vMin = _mm_set1_ps( -128.0f );
+            const __m128 vHalf = _mm_set1_ps( 0.5f );
+            const __m128 vSign = _mm_castsi128_ps( _mm_set1_epi32( (int)0x80000000 ) );
+            while( numValues >= 8u )
+            {
+                __m128 v0 = _mm_sub_ps( _mm_mul_ps( _mm_loadu_ps( src ), vMult ), vAdd );
+                __m128 v1 = _mm_sub_ps( _mm_mul_ps( _mm_loadu_ps( src + 4u ), vMult ), vAdd );
+                // v >= 0 ? v * 127 + 0.5 : v * 127 - 0.5
+                const __m128 round0 =
+                    _mm_or_ps( vHalf, _mm_and_ps( _mm_cmplt_ps( v0, _mm_setzero_ps() ), vSign ) );
+                const __m128 round1 =
+                    _mm_or_ps( vHalf, _mm_and_ps( _mm_cmplt_ps( v1, _mm_setzero_ps() ), vSign ) );
+                v0 = _mm_add_ps( _mm_mul_ps( v0, vScale ), round0 );
+                v1 = _mm_add_ps( _mm_mul_ps( v1, vScale ), round1 );
+                // Same operand order as Math::Clamp
+                v0 = _mm_max_ps( vMin, _mm_min_ps( vScale, v0 ) );
+                v1 = _mm_max_ps( vMin, _mm_min_ps( vScale, v1 ) );
+                const __m128i i16 =
+                    _mm_packs_epi32( _mm_cvttps_epi32( v0 ), _mm_cvttps_epi32( v1 ) );
+                _mm_storel_epi64( reinterpret_cast<__m128i *>( dst ), _mm_packs_epi16( i16, i16 ) );
+                src += 8u;
+                dst += 8u;
+                numValues -= 8u;
+            }
+#endif
+            while( numValues-- )
+                *dst++ = Bitwise::floatToSnorm8( *src++ * multPart - addPart );
+        }
+    }  // namespace
+    //-----------------------------------------------------------------------------------
     void PixelFormatGpuUtils::convertForNormalMapping( TextureBox src, PixelFormatGpu srcFormat,
                                                        TextureBox dst, PixelFormatGpu dstFormat )
     {
@@ -1262,6 +1383,33 @@ namespace Ogre
             addPart = 0.0f;
         }
 
+        const rg_gather_func_t gatherFunc = getRGGatherFunc( srcFormat );
+        if( gatherFunc )
+        {
+            // Read R & G in batches as floats, then convert them all at once
+            const size_t c_batchSize = 256u;
+            float rg[c_batchSize * 2u];
+            for( size_t z = 0; z < src.getDepthOrSlices(); ++z )
+            {
+                for( size_t y = 0; y < src.height; ++y )
+                {
+                    const uint8 *srcPtr =
+                        reinterpret_cast<const uint8 *>( src.atFromOffsettedOrigin( 0, y, z ) );
+                    int8 *dstPtr = reinterpret_cast<int8 *>( dst.atFromOffsettedOrigin( 0, y, z ) );
+
+                    for( size_t x = 0; x < src.width; x += c_batchSize )
+                    {
+                        const size_t batchSize = std::min( src.width - x, c_batchSize );
+                        gatherFunc( srcPtr, rg, batchSize, src.bytesPerPixel );
+                        convFloatToNormalMapSnorm8( rg, dstPtr, batchSize * 2u, multPart, addPart );
+                        srcPtr += batchSize * src.bytesPerPixel;
+                        dstPtr += batchSize * 2u;
+                    }
+                }
+            }
+            return;
+        }
+
         float rgba[4];
         for( size_t z = 0; z < src.getDepthOrSlices(); ++z )
         {
@@ -1302,6 +1450,66 @@ namespace Ogre
         void convCopy2Bpx( uint8 *src, uint8 *dst, size_t width ) { memcpy( dst, src, 2 * width ); }
         void convCopy1Bpx( uint8 *src, uint8 *dst, size_t width ) { memcpy( dst, src, 1 * width ); }
 
+        /** Converts the first two channels of 8-bit RGBA (or BGRA if bSwapRB) pixels into
+            RG8 while flipping the sign bit, which is both the UNORM -> SNORM and the
+            SNORM -> UNORM conversion (+/- 128).
+            Advances src & dst and returns the number of pixels that were converted;
+            the caller must convert the remaining ones.
+        */
+        template <bool bSwapRB>
+        size_t convRGBAtoRG_flipSign( uint8 *&src, uint8 *&dst, size_t width )
+        {
+#if OGRE_CPU == OGRE_CPU_X86 && OGRE_USE_SIMD == 1
+            const __m128i signBits = _mm_set1_epi8( (char)0x80 );
+            const __m128i maskR = _mm_set1_epi32( 0xFF );
+            const __m128i maskG = _mm_set1_epi32( 0xFF00 );
+            size_t numConverted = 0u;
+            while( width - numConverted >= 8u )
+            {
+                __m128i px0 = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src ) );
+                __m128i px1 = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src + 16u ) );
+                if( bSwapRB )
+                {
+                    px0 = _mm_or_si128( _mm_and_si128( _mm_srli_epi32( px0, 16 ), maskR ),
+                                        _mm_and_si128( px0, maskG ) );
+                    px1 = _mm_or_si128( _mm_and_si128( _mm_srli_epi32( px1, 16 ), maskR ),
+                                        _mm_and_si128( px1, maskG ) );
+                }
+                // Sign extend the RG pair so that packing doesn't saturate
+                px0 = _mm_srai_epi32( _mm_slli_epi32( px0, 16 ), 16 );
+                px1 = _mm_srai_epi32( _mm_slli_epi32( px1, 16 ), 16 );
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( dst ),
+                                  _mm_xor_si128( _mm_packs_epi32( px0, px1 ), signBits ) );
+                src += 32u;
+                dst += 16u;
+                numConverted += 8u;
+            }
+            return numConverted;
+#else
+            return 0u;
+#endif
+        }
+
+        /// See convRGBAtoRG_flipSign, but for RG8 sources
+        size_t convRGtoRG_flipSign( uint8 *&src, uint8 *&dst, size_t width )
+        {
+#if OGRE_CPU == OGRE_CPU_X86 && OGRE_USE_SIMD == 1
+            const __m128i signBits = _mm_set1_epi8( (char)0x80 );
+            size_t numConverted = 0u;
+            while( width - numConverted >= 8u )
+            {
+                const __m128i px = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src ) );
+                _mm_storeu_si128( reinterpret_cast<__m128i *>( dst ), _mm_xor_si128( px, signBits ) );
+                src += 16u;
+                dst += 16u;
+                numConverted += 8u;
+            }
+            return numConverted;
+#else
+            return 0u;
+#endif
+        }
+
         // clang-format off
         void convRGBA32toRGB32(uint8* _src, uint8* _dst, size_t width) {
             uint32* src = (uint32*)_src; uint32* dst = (uint32*)_dst;
@@ -1343,6 +1551,18 @@ namespace Ogre
         }
 
         void convRGBAtoBGRA(uint8* src, uint8* dst, size_t width) {
+#if OGRE_CPU == OGRE_CPU_X86 && OGRE_USE_SIMD == 1
+            // Swap bytes 0 & 2 of each 32-bit pixel, 4 pixels at a time
+            const __m128i maskGA = _mm_set1_epi32( (int)0xFF00FF00 );
+            while (width >= 4u) {
+                const __m128i px = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) );
+                const __m128i rb = _mm_andnot_si128( maskGA, px );
+                const __m128i br = _mm_or_si128( _mm_slli_epi32( rb, 16 ), _mm_srli_epi32( rb, 16 ) );
+                _mm_storeu_si128( reinterpret_cast<__m128i*>( dst ),
+                                  _mm_or_si128( _mm_and_si128( maskGA, px ), br ) );
+                src += 16; dst += 16; width -= 4u;
+            }
+#endif
             while (width--)
             { dst[0] = src[2]; dst[1] = src[1]; dst[2] = src[0]; dst[3] = src[3]; src += 4; dst += 4; }
         }
@@ -1356,9 +1576,11 @@ namespace Ogre
             while (width--) { dst[0] = src[0]; dst[1] = src[1]; src += 4; dst += 2; }
         }
         void convRGBAtoRG_u2s(uint8* src, uint8* dst, size_t width) {
+            width -= convRGBAtoRG_flipSign<false>( src, dst, width );
             while (width--) { dst[0] = src[0] - 128; dst[1] = src[1] - 128; src += 4; dst += 2; }
         }
         void convRGBAtoRG_s2u(uint8* src, uint8* dst, size_t width) {
+            width -= convRGBAtoRG_flipSign<false>( src, dst, width );
             while (width--) { dst[0] = src[0] + 128; dst[1] = src[1] + 128; src += 4; dst += 2; }
         }
         void convRGBAtoR(uint8* src, uint8* dst, size_t width) {
@@ -1369,9 +1591,11 @@ namespace Ogre
             while (width--) { dst[0] = src[2]; dst[1] = src[1]; src += 4; dst += 2; }
         }
         void convBGRAtoRG_u2s(uint8* src, uint8* dst, size_t width) {
+            width -= convRGBAtoRG_flipSign<true>( src, dst, width );
             while (width--) { dst[0] = src[2] - 128; dst[1] = src[1] - 128; src += 4; dst += 2; }
         }
         void convBGRAtoRG_s2u(uint8* src, uint8* dst, size_t width) {
+            width -= convRGBAtoRG_flipSign<true>( src, dst, width );
             while (width--) { dst[0] = src[2] + 128; dst[1] = src[1] + 128; src += 4; dst += 2; }
         }
         void convBGRAtoR(uint8* src, uint8* dst, size_t width) {
@@ -1431,15 +1655,167 @@ namespace Ogre
             while (width--) { dst[0] = 0u; dst[1] = src[1]; dst[2] = src[0]; src += 2; dst += 3; }
         }
         void convRGtoRG_u2s(uint8* src, uint8* dst, size_t width) {
+            width -= convRGtoRG_flipSign( src, dst, width );
             while (width--) { dst[0] = src[0] - 128; dst[1] = src[1] - 128; src += 2; dst += 2; }
         }
         void convRGtoRG_s2u(uint8* src, uint8* dst, size_t width) {
+            width -= convRGtoRG_flipSign( src, dst, width );
             while (width--) { dst[0] = src[0] + 128; dst[1] = src[1] + 128; src += 2; dst += 2; }
         }
         void convRGtoR(uint8* src, uint8* dst, size_t width) {
             while (width--) { dst[0] = src[0]; src += 2; dst += 1; }
         }
         // clang-format on
+
+        row_conversion_func_t getCopyRowConversionFunc( size_t bytesPerPixel )
+        {
+            switch( bytesPerPixel )
+            {
+                // clang-format off
+            case 1: return convCopy1Bpx;
+            case 2: return convCopy2Bpx;
+            case 3: return convCopy3Bpx;
+            case 4: return convCopy4Bpx;
+            case 6: return convCopy6Bpx;
+            case 8: return convCopy8Bpx;
+            case 12: return convCopy12Bpx;
+            case 16: return convCopy16Bpx;
+                // clang-format on
+            }
+            return 0;
+        }
+
+        /// Converts a row of half floats with numComponents each to 32-bit floats
+        template <size_t numComponents>
+        void convHalfToFloat( uint8 *_src, uint8 *_dst, size_t width )
+        {
+            const uint16 *RESTRICT_ALIAS src = reinterpret_cast<const uint16 *>( _src );
+            uint32 *RESTRICT_ALIAS dst = reinterpret_cast<uint32 *>( _dst );
+            size_t numValues = width * numComponents;
+#if OGRE_CPU == OGRE_CPU_X86 && OGRE_USE_SIMD == 1
+            // Bit-exact with Bitwise::halfToFloatI (including denormals, Inf & NaN) as long
+            // as DAZ is not enabled: denormals are renormalized by multiplying by 2^112.
+            const __m128i maskNoSign = _mm_set1_epi32( 0x7FFF );
+            const __m128 magic = _mm_castsi128_ps( _mm_set1_epi32( ( 254 - 15 ) << 23 ) );
+            const __m128i wasInfNan = _mm_set1_epi32( 0x7BFF );
+            const __m128i expInfNan = _mm_set1_epi32( 255 << 23 );
+            while( numValues >= 4u )
+            {
+                const __m128i h = _mm_unpacklo_epi16(
+                    _mm_loadl_epi64( reinterpret_cast<const __m128i *>( src ) ), _mm_setzero_si128() );
+                const __m128i expMant = _mm_and_si128( maskNoSign, h );
+                const __m128i justSign = _mm_xor_si128( h, expMant );
+                const __m128 scaled =
+                    _mm_mul_ps( _mm_castsi128_ps( _mm_slli_epi32( expMant, 13 ) ), magic );
+                const __m128i infNanExp =
+                    _mm_and_si128( _mm_cmpgt_epi32( expMant, wasInfNan ), expInfNan );
+                const __m128i signInfNan = _mm_or_si128( _mm_slli_epi32( justSign, 16 ), infNanExp );
+                _mm_storeu_ps( reinterpret_cast<float *>( dst ),
+                               _mm_or_ps( scaled, _mm_castsi128_ps( signInfNan ) ) );
+                src += 4u;
+                dst += 4u;
+                numValues -= 4u;
+            }
+#endif
+            while( numValues-- )
+                *dst++ = Bitwise::halfToFloatI( *src++ );
+        }
+
+        /// Converts a row of 32-bit floats with numComponents each to half floats
+        template <size_t numComponents>
+        void convFloatToHalf( uint8 *_src, uint8 *_dst, size_t width )
+        {
+            const uint32 *RESTRICT_ALIAS src = reinterpret_cast<const uint32 *>( _src );
+            uint16 *RESTRICT_ALIAS dst = reinterpret_cast<uint16 *>( _dst );
+            size_t numValues = width * numComponents;
+#if OGRE_CPU == OGRE_CPU_X86 && OGRE_USE_SIMD == 1
+            // Bit-exact with Bitwise::floatToHalfI (which truncates). Denormal halves are
+            // calculated as trunc( |f| * 2^24 ), which is exact because |f| is never a
+            // float denormal in that range, so the variable shift isn't needed.
+            const __m128i maskNoSign = _mm_set1_epi32( 0x7FFFFFFF );
+            const __m128i maskSign = _mm_set1_epi32( 0x8000 );
+            const __m128i maskMant = _mm_set1_epi32( 0x007FFFFF );
+            const __m128i rebias = _mm_set1_epi32( ( 127 - 15 ) << 10 );
+            const __m128 denormScale = _mm_castsi128_ps( _mm_set1_epi32( ( 127 + 24 ) << 23 ) );
+            const __m128i expDenorm = _mm_set1_epi32( 127 - 15 + 1 );
+            const __m128i expZero = _mm_set1_epi32( 127 - 15 - 10 );
+            const __m128i expOverflow = _mm_set1_epi32( 127 + 15 );
+            const __m128i infExp = _mm_set1_epi32( 0x7C00 );
+            const __m128i floatInf = _mm_set1_epi32( 0x7F800000 );
+            const __m128i one = _mm_set1_epi32( 1 );
+            while( numValues >= 4u )
+            {
+                const __m128i f = _mm_loadu_si128( reinterpret_cast<const __m128i *>( src ) );
+                const __m128i absF = _mm_and_si128( f, maskNoSign );
+                const __m128i exp8 = _mm_srli_epi32( absF, 23 );
+                const __m128i sign = _mm_and_si128( _mm_srli_epi32( f, 16 ), maskSign );
+
+                const __m128i normal = _mm_sub_epi32( _mm_srli_epi32( absF, 13 ), rebias );
+                const __m128i denorm =
+                    _mm_cvttps_epi32( _mm_mul_ps( _mm_castsi128_ps( absF ), denormScale ) );
+
+                // Inf & NaN. NaNs keep their top mantissa bits, but must not become Inf
+                const __m128i mant = _mm_srli_epi32( _mm_and_si128( f, maskMant ), 13 );
+                const __m128i nanBits =
+                    _mm_and_si128( _mm_cmpgt_epi32( absF, floatInf ),
+                                   _mm_or_si128( mant, _mm_and_si128( _mm_cmpeq_epi32(
+                                                                          mant, _mm_setzero_si128() ),
+                                                                      one ) ) );
+
+                const __m128i isDenorm = _mm_cmplt_epi32( exp8, expDenorm );
+                const __m128i isOverflow = _mm_cmpgt_epi32( exp8, expOverflow );
+                __m128i h = _mm_or_si128( _mm_and_si128( isDenorm, denorm ),
+                                          _mm_andnot_si128( isDenorm, normal ) );
+                h = _mm_or_si128( _mm_and_si128( isOverflow, _mm_or_si128( infExp, nanBits ) ),
+                                  _mm_andnot_si128( isOverflow, h ) );
+                // Values that are too small flush to zero, dropping the sign
+                h = _mm_andnot_si128( _mm_cmplt_epi32( exp8, expZero ), _mm_or_si128( h, sign ) );
+
+                // Sign extend from 16 bits so that packing doesn't saturate
+                h = _mm_srai_epi32( _mm_slli_epi32( h, 16 ), 16 );
+                _mm_storel_epi64( reinterpret_cast<__m128i *>( dst ), _mm_packs_epi32( h, h ) );
+                src += 4u;
+                dst += 4u;
+                numValues -= 4u;
+            }
+#endif
+            while( numValues-- )
+                *dst++ = Bitwise::floatToHalfI( *src++ );
+        }
+
+        /// 8-bit linear <-> sRGB lookup tables. They're generated with the same math
+        /// used by packColour & unpackColour, thus the results are identical.
+        struct SRgbLut
+        {
+            uint8 fromSRgb[256];
+            uint8 toSRgb[256];
+
+            SRgbLut()
+            {
+                for( size_t i = 0u; i < 256u; ++i )
+                {
+                    const float val = static_cast<float>( i ) / 255.0f;
+                    fromSRgb[i] = static_cast<uint8>(
+                        roundf( Math::saturate( PixelFormatGpuUtils::fromSRGB( val ) ) * 255.0f ) );
+                    toSRgb[i] = static_cast<uint8>(
+                        roundf( Math::saturate( PixelFormatGpuUtils::toSRGB( val ) ) * 255.0f ) );
+                }
+            }
+        };
+        const SRgbLut c_sRgbLut;
+
+        /// Remaps in place the first numChannels of every pixel through the given LUT.
+        /// Remaining channels (i.e. alpha) are left untouched.
+        void applyRowLut( uint8 *RESTRICT_ALIAS dst, size_t width, size_t bytesPerPixel,
+                          size_t numChannels, const uint8 *RESTRICT_ALIAS lut )
+        {
+            for( size_t x = 0u; x < width; ++x )
+            {
+                for( size_t i = 0u; i < numChannels; ++i )
+                    dst[i] = lut[dst[i]];
+                dst += bytesPerPixel;
+            }
+        }
     }  // namespace
     //-----------------------------------------------------------------------------------
     void PixelFormatGpuUtils::bulkPixelConversion( const TextureBox &src, PixelFormatGpu srcFormat,
@@ -1473,30 +1849,30 @@ namespace Ogre
         const size_t height = src.height;
         const size_t depthOrSlices = src.getDepthOrSlices();
 
+        const uint32 srcFlags = getFlags( srcFormat );
+        const uint32 dstFlags = getFlags( dstFormat );
+
+        // Linear <-> sRGB conversion of 8-bit formats: they're converted as typeless
+        // and then colour channels get remapped through a LUT.
+        const bool bOnlyColourSpaceDiffers = ( srcFlags ^ dstFlags ) == PFF_SRGB &&
+                                             ( srcFlags | dstFlags ) == ( PFF_NORMALIZED | PFF_SRGB );
+
         // Is there a optimized row conversion?
         row_conversion_func_t rowConversionFunc = 0;
+        const uint8 *rowLut = 0;
         assert( PFL_COUNT <= 16 );  // adjust PFL_PAIR definition if assertion failed
 #define PFL_PAIR( a, b ) ( ( a << 4 ) | b )
         if( srcFormat == dstFormat )
         {
-            switch( srcBytesPerPixel )
-            {
-                // clang-format off
-            case 1: rowConversionFunc = convCopy1Bpx; break;
-            case 2: rowConversionFunc = convCopy2Bpx; break;
-            case 3: rowConversionFunc = convCopy3Bpx; break;
-            case 4: rowConversionFunc = convCopy4Bpx; break;
-            case 6: rowConversionFunc = convCopy6Bpx; break;
-            case 8: rowConversionFunc = convCopy8Bpx; break;
-            case 12: rowConversionFunc = convCopy12Bpx; break;
-            case 16: rowConversionFunc = convCopy16Bpx; break;
-                // clang-format on
-            }
+            rowConversionFunc = getCopyRowConversionFunc( srcBytesPerPixel );
         }
-        else if( getFlags( srcFormat ) == getFlags( dstFormat ) )  // semantic match, copy as typeless
+        else if( srcFlags == dstFlags ||  // semantic match, copy as typeless
+                 bOnlyColourSpaceDiffers )
         {
             PixelFormatLayout srcLayout = getPixelLayout( srcFormat );
             PixelFormatLayout dstLayout = getPixelLayout( dstFormat );
+            if( bOnlyColourSpaceDiffers && srcLayout == dstLayout )
+                rowConversionFunc = getCopyRowConversionFunc( srcBytesPerPixel );
             switch( PFL_PAIR( srcLayout, dstLayout ) )
             {
                 // clang-format off
@@ -1542,7 +1918,7 @@ namespace Ogre
             case PFL_PAIR( PFL_BGR8, PFL_RGBA8 ): rowConversionFunc = convRGBtoBGRA; break;
             case PFL_PAIR( PFL_BGR8, PFL_BGRA8 ): rowConversionFunc = convRGBtoRGBA; break;
             case PFL_PAIR( PFL_BGR8, PFL_BGRX8 ): rowConversionFunc = convRGBtoRGBA; break;
-            case PFL_PAIR( PFL_BGR8, PFL_RGB8 ): rowConversionFunc = convRGBAtoBGR; break;
+            case PFL_PAIR( PFL_BGR8, PFL_RGB8 ): rowConversionFunc = convRGBtoBGR; break;
             case PFL_PAIR( PFL_BGR8, PFL_RG8 ): rowConversionFunc = convBGRtoRG; break;
             case PFL_PAIR( PFL_BGR8, PFL_R8 ): rowConversionFunc = convBGRtoR; break;
 
@@ -1551,9 +1927,37 @@ namespace Ogre
             case PFL_PAIR( PFL_RG8, PFL_R8 ): rowConversionFunc = convRGtoR; break;
                 // clang-format on
             }
+
+            if( bOnlyColourSpaceDiffers && rowConversionFunc )
+                rowLut = isSRgb( srcFormat ) ? c_sRgbLut.fromSRgb : c_sRgbLut.toSRgb;
+        }
+        else if( srcFlags == PFF_HALF && dstFlags == PFF_FLOAT )
+        {
+            PixelFormatLayout srcLayout = getPixelLayout( srcFormat );
+            PixelFormatLayout dstLayout = getPixelLayout( dstFormat );
+            switch( PFL_PAIR( srcLayout, dstLayout ) )
+            {
+                // clang-format off
+            case PFL_PAIR( PFL_RGBA16, PFL_RGBA32 ): rowConversionFunc = convHalfToFloat<4u>; break;
+            case PFL_PAIR( PFL_RG16, PFL_RG32 ): rowConversionFunc = convHalfToFloat<2u>; break;
+            case PFL_PAIR( PFL_R16, PFL_R32 ): rowConversionFunc = convHalfToFloat<1u>; break;
+                // clang-format on
+            }
+        }
+        else if( srcFlags == PFF_FLOAT && dstFlags == PFF_HALF )
+        {
+            PixelFormatLayout srcLayout = getPixelLayout( srcFormat );
+            PixelFormatLayout dstLayout = getPixelLayout( dstFormat );
+            switch( PFL_PAIR( srcLayout, dstLayout ) )
+            {
+                // clang-format off
+            case PFL_PAIR( PFL_RGBA32, PFL_RGBA16 ): rowConversionFunc = convFloatToHalf<4u>; break;
+            case PFL_PAIR( PFL_RG32, PFL_RG16 ): rowConversionFunc = convFloatToHalf<2u>; break;
+            case PFL_PAIR( PFL_R32, PFL_R16 ): rowConversionFunc = convFloatToHalf<1u>; break;
+                // clang-format on
+            }
         }
-        else if( getFlags( srcFormat ) == PFF_NORMALIZED &&
-                 getFlags( dstFormat ) == ( PFF_NORMALIZED | PFF_SIGNED ) )
+        else if( srcFlags == PFF_NORMALIZED && dstFlags == ( PFF_NORMALIZED | PFF_SIGNED ) )
         {
             PixelFormatLayout srcLayout = getPixelLayout( srcFormat );
             PixelFormatLayout dstLayout = getPixelLayout( dstFormat );
@@ -1569,8 +1973,7 @@ namespace Ogre
                 // clang-format on
             }
         }
-        else if( getFlags( srcFormat ) == ( PFF_NORMALIZED | PFF_SIGNED ) &&
-                 getFlags( dstFormat ) == PFF_NORMALIZED )
+        else if( srcFlags == ( PFF_NORMALIZED | PFF_SIGNED ) && dstFlags == PFF_NORMALIZED )
         {
             PixelFormatLayout srcLayout = getPixelLayout( srcFormat );
             PixelFormatLayout dstLayout = getPixelLayout( dstFormat );
@@ -1590,6 +1993,7 @@ namespace Ogre
 
         if( rowConversionFunc )
         {
+            const size_t numLutChannels = std::min<size_t>( getNumberOfComponents( dstFormat ), 3u );
             for( size_t z = 0; z < depthOrSlices; ++z )
             {
                 for( size_t y = 0; y < height; ++y )
@@ -1598,6 +2002,8 @@ namespace Ogre
                     uint8 *srcPtr = srcData + src.bytesPerImage * z + src.bytesPerRow * y;
                     uint8 *dstPtr = dstData + dst.bytesPerImage * z + dst.bytesPerRow * dest_y;
                     rowConversionFunc( srcPtr, dstPtr, width );
+                    if( rowLut )
+                        applyRowLut( dstPtr, width, dstBytesPerPixel, numLutChannels, rowLut );
                 }
             }
             return;
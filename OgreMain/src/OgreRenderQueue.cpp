@@ -506,6 +506,9 @@ namespace Ogre
         if( parallelCompileQueue )
             mParallelHlmsCompileQueue.stopAndWait( mSceneManager );
 
+        // Data written to the DynamicUploadRings must be visible before the commands execute
+        mVaoManager->_flushDynamicUploadRings();
+
         OgreProfileEndGroup( "Command Preparation", OGREPROF_RENDERING );
 
         OgreProfileBeginGroup( "Command Execution", OGREPROF_RENDERING );
@@ -739,8 +742,9 @@ namespace Ogre
                                 (uint32)particleCommonBuffer->getTotalSizeBytes() );
             ReadOnlyBufferPacked *particleDataBuffer = systemDef->_getGpuDataBuffer();
             *mCommandBuffer->addCommand<CbShaderBuffer>() =
-                CbShaderBuffer( VertexShader, particleSystemSlot[hlmsType][1], particleDataBuffer, 0,
-                                (uint32)particleDataBuffer->getTotalSizeBytes() );
+                CbShaderBuffer( VertexShader, particleSystemSlot[hlmsType][1], particleDataBuffer,
+                                (uint32)systemDef->_getGpuDataOffset(),
+                                (uint32)systemDef->_getGpuDataSizeBytes() );
 
             // We always break the commands (because we re-bind particleDataBuffer for every draw)
             {
@@ -1169,6 +1169,7 @@ namespace Ogre
         mWorkQueue->shutdown();
         if( mActiveRenderer && mActiveRenderer->getTextureGpuManager() )
             mActiveRenderer->getTextureGpuManager()->shutdown();
+        mMeshManager->shutdown();
 
         OGRE_DELETE mCompositorManager2;
         mCompositorManager2 = 0;
@@ -1574,6 +1575,9 @@ namespace Ogre
     //-----------------------------------------------------------------------
     bool Root::_updateAllRenderTargets()
     {
+        // Upload the meshes that finished loading in the background
+        mMeshManager->_update();
+
         // update all targets but don't swap buffers
         // mActiveRenderer->_updateAllRenderTargets(false);
         mCompositorManager2->_update();
@@ -1600,6 +1604,9 @@ namespace Ogre
     //---------------------------------------------------------------------
     bool Root::_updateAllRenderTargets( FrameEvent &evt )
     {
+        // Upload the meshes that finished loading in the background
+        mMeshManager->_update();
+
         // update all targets but don't swap buffers
         mCompositorManager2->_update();
         // give client app opportunity to use queued GPU time
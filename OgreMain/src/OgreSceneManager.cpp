@@ -116,6 +116,7 @@ namespace Ogre
     //-----------------------------------------------------------------------
     SceneManager::SceneManager( const String &name, size_t numWorkerThreads ) :
         IdObject( Id::generateNewId<SceneManager>() ),
+        mAnimationLodFrame( 0 ),
         mNumDecals( 0 ),
         mNumCubemapProbes( 0 ),
         mStaticMinDepthLevelDirty( 0 ),
@@ -212,6 +213,8 @@ namespace Ogre
 
         mGlobalLightListPerThread.resize( mNumWorkerThreads );
         mBuildLightListRequestPerThread.resize( mNumWorkerThreads );
+        mPendingDeferredAnimationsPerThread.resize( mNumWorkerThreads, 0u );
+        mParallelAnimationsPerThread.resize( mNumWorkerThreads );
         mVisibleObjects.resize( mNumWorkerThreads );
         mTmpVisibleObjects.resize( mNumWorkerThreads );
 
@@ -409,6 +412,9 @@ namespace Ogre
                 efficientVectorRemove( mCubeMapCameras, it );
         }
 
+        if( mParticleSystemManager2->getCullCamera() == cam )
+            mParticleSystemManager2->setCullCamera( 0 );
+
         IdString camName( cam->getName() );
 
         // Find in list
@@ -1732,6 +1738,8 @@ namespace Ogre
             mWorkerThreadsBarrier->sync();  // Fire threads.
             mWorkerThreadsBarrier->sync();  // Wait them to complete stage 01.
             mWorkerThreadsBarrier->sync();  // Wait them to complete stage 02.
+            if( mParticleSystemManager2->_needsDepthSorting() )
+                mWorkerThreadsBarrier->sync();  // Wait them to complete stage 03.
         }
     }
     //-----------------------------------------------------------------------
@@ -1810,6 +1818,92 @@ namespace Ogre
     //-----------------------------------------------------------------------
     void SceneManager::updateAllAnimationsThread( size_t threadIdx )
     {
+        FastArray<SkeletonInstance *> &parallelAnimations = mParallelAnimationsPerThread[threadIdx];
+        parallelAnimations.clear();
+
+        SkeletonAnimManagerVec::const_iterator it = mSkeletonAnimManagerCulledList.begin();
+        SkeletonAnimManagerVec::const_iterator en = mSkeletonAnimManagerCulledList.end();
+
+        while( it != en )
+        {
+            SkeletonAnimManager::BySkeletonDefList::iterator itByDef = ( *it )->bySkeletonDefs.begin();
+            SkeletonAnimManager::BySkeletonDefList::iterator enByDef = ( *it )->bySkeletonDefs.end();
+
+            while( itByDef != enByDef )
+            {
+                FastArray<SkeletonInstance *>::iterator itor =
+                    itByDef->skeletons.begin() + itByDef->threadStarts[threadIdx];
+                FastArray<SkeletonInstance *>::iterator endt =
+                    itByDef->skeletons.begin() + itByDef->threadStarts[threadIdx + 1];
+                bool hasDeferred = false;
+                while( itor != endt )
+                {
+                    // Instances with a pose source copy it once all sources got animated,
+                    // and instances with parallel animation get animated by all threads
+                    // (updateAllDeferredAnimationsThread). Distant skeletons may skip
+                    // animating this frame, but their bones must still follow the parent
+                    // node (updateAnimationTransforms)
+                    SkeletonInstance *skeleton = *itor;
+                    if( skeleton->getPoseSource() )
+                        hasDeferred = true;
+                    else
+                    {
+                        if( skeleton->getParallelAnimation() )
+                            hasDeferred = true;
+
+                        if( skeleton->_updateAnimationLod( mAnimationLodFrame ) )
+                        {
+                            if( skeleton->getParallelAnimation() )
+                                parallelAnimations.push_back( skeleton );
+                            else
+                                skeleton->update();
+                        }
+                    }
+                    ++itor;
+                }
+
+                if( hasDeferred )
+                    mPendingDeferredAnimationsPerThread[threadIdx] = 1u;
+                else if( !itByDef->skeletons.empty() )
+                    updateAnimationTransforms( *itByDef, threadIdx );
+
+                ++itByDef;
+            }
+
+            ++it;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void SceneManager::updateAllDeferredAnimationsThread( size_t threadIdx )
+    {
+        vector<FastArray<SkeletonInstance *> >::type::const_iterator itThread =
+            mParallelAnimationsPerThread.begin();
+        vector<FastArray<SkeletonInstance *> >::type::const_iterator enThread =
+            mParallelAnimationsPerThread.end();
+
+        while( itThread != enThread )
+        {
+            FastArray<SkeletonInstance *>::const_iterator itor = itThread->begin();
+            FastArray<SkeletonInstance *>::const_iterator endt = itThread->end();
+
+            while( itor != endt )
+            {
+                ( *itor )->_updateBoneBlocks( threadIdx, mNumWorkerThreads );
+                ++itor;
+            }
+
+            ++itThread;
+        }
+
+        // Pose sources and bones' parents must be fully animated before we continue
+        if( !mForceMainThread )
+            mWorkerThreadsBarrier->sync();
+
+        if( !mPendingDeferredAnimationsPerThread[threadIdx] )
+            return;
+
+        mPendingDeferredAnimationsPerThread[threadIdx] = 0u;
+
         SkeletonAnimManagerVec::const_iterator it = mSkeletonAnimManagerCulledList.begin();
         SkeletonAnimManagerVec::const_iterator en = mSkeletonAnimManagerCulledList.end();
 
@@ -1824,13 +1918,22 @@ namespace Ogre
                     itByDef->skeletons.begin() + itByDef->threadStarts[threadIdx];
                 FastArray<SkeletonInstance *>::iterator endt =
                     itByDef->skeletons.begin() + itByDef->threadStarts[threadIdx + 1];
+
+                bool hasDeferred = false;
                 while( itor != endt )
                 {
-                    ( *itor )->update();
+                    if( ( *itor )->getPoseSource() )
+                    {
+                        ( *itor )->_copyPoseFromSource();
+                        hasDeferred = true;
+                    }
+                    else if( ( *itor )->getParallelAnimation() )
+                        hasDeferred = true;
                     ++itor;
                 }
 
-                if( !itByDef->skeletons.empty() )
+                // The rest of the instances were already updated in updateAllAnimationsThread
+                if( hasDeferred )
                     updateAnimationTransforms( *itByDef, threadIdx );
 
                 ++itByDef;
@@ -1893,8 +1996,28 @@ namespace Ogre
     //-----------------------------------------------------------------------
     void SceneManager::updateAllAnimations()
     {
+        ++mAnimationLodFrame;
         mRequestType = UPDATE_ALL_ANIMATIONS;
         fireWorkerThreadsAndWait();
+
+        FastArray<uint8>::const_iterator itor = mPendingDeferredAnimationsPerThread.begin();
+        FastArray<uint8>::const_iterator endt = mPendingDeferredAnimationsPerThread.end();
+        while( itor != endt && !*itor )
+            ++itor;
+
+        if( itor != endt )
+        {
+            mRequestType = UPDATE_ALL_DEFERRED_ANIMATIONS;
+
+            if( mForceMainThread )
+                updateWorkerThreadImpl( 0 );
+            else
+            {
+                mWorkerThreadsBarrier->sync();  // Fire threads.
+                mWorkerThreadsBarrier->sync();  // Wait them to complete the parallel skeletons.
+                mWorkerThreadsBarrier->sync();  // Wait them to complete the transforms.
+            }
+        }
     }
     //-----------------------------------------------------------------------
     void SceneManager::updateAllTransformsThread( const UpdateTransformRequest &request,
@@ -4745,6 +4868,9 @@ namespace Ogre
             if( mPrepareParticleFx )
                 mParticleSystemManager2->_prepareParallel();
             break;
+        case UPDATE_ALL_DEFERRED_ANIMATIONS:
+            updateAllDeferredAnimationsThread( threadIdx );
+            break;
         case UPDATE_ALL_TRANSFORMS:
             updateAllTransformsThread( mUpdateTransformRequest, threadIdx );
             break;
@@ -4780,6 +4906,12 @@ namespace Ogre
             if( !mForceMainThread )
                 mWorkerThreadsBarrier->sync();
             mParticleSystemManager2->_updateParallel02( threadIdx, mNumWorkerThreads );
+            if( mParticleSystemManager2->_needsDepthSorting() )
+            {
+                if( !mForceMainThread )
+                    mWorkerThreadsBarrier->sync();
+                mParticleSystemManager2->_updateParallel03( threadIdx, mNumWorkerThreads );
+            }
             break;
         case USER_UNIFORM_SCALABLE_TASK:
             mUserTask->execute( threadIdx, mNumWorkerThreads );
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "OgreSubItem.h"
 
 #include "OgreException.h"
+#include "OgreHlms.h"
 #include "OgreHlmsDatablock.h"
 #include "OgreItem.h"
 #include "OgreLogManager.h"
@@ -42,7 +43,8 @@ namespace Ogre
     SubItem::SubItem( Item *parent, SubMesh *subMeshBasis ) :
         RenderableAnimated(),
         mParentItem( parent ),
-        mSubMesh( subMeshBasis )
+        mSubMesh( subMeshBasis ),
+        mPreSkinned( false )
     {
         // mMaterialPtr = MaterialManager::getSingleton().getByName(mMaterialName,
         // subMeshBasis->parent->getGroup());
@@ -77,7 +79,8 @@ namespace Ogre
     //-----------------------------------------------------------------------------
     void SubItem::_setHlmsHashes( uint32 hash, uint32 casterHash )
     {
-        if( mHlmsDatablock->getAlphaTest() != CMPF_ALWAYS_PASS )
+        // When pre-skinned, shadow casters always use the pre-skinned Vaos
+        if( !mPreSkinned && mHlmsDatablock->getAlphaTest() != CMPF_ALWAYS_PASS )
         {
             if( mVaoPerLod[VpShadow].empty() || mVaoPerLod[VpShadow][0] != mSubMesh->mVao[VpNormal][0] )
             {
@@ -85,7 +88,7 @@ namespace Ogre
                 mVaoPerLod[VpShadow] = mSubMesh->mVao[VpNormal];
             }
         }
-        else
+        else if( !mPreSkinned )
         {
             if( mVaoPerLod[VpShadow].empty() || mVaoPerLod[VpShadow][0] != mSubMesh->mVao[VpShadow][0] )
             {
@@ -97,6 +100,33 @@ namespace Ogre
         Renderable::_setHlmsHashes( hash, casterHash );
     }
     //-----------------------------------------------------------------------
+    void SubItem::_setPreSkinnedVaos( const VertexArrayObjectArray &vaos )
+    {
+        mPreSkinned = !vaos.empty();
+
+        if( mPreSkinned )
+        {
+            mVaoPerLod[VpNormal] = vaos;
+            mVaoPerLod[VpShadow] = vaos;
+            mHasSkeletonAnimation = false;
+            mBlendIndexToBoneIndexMap = 0;
+        }
+        else
+        {
+            mVaoPerLod[VpNormal] = mSubMesh->mVao[VpNormal];
+            mVaoPerLod[VpShadow] = mSubMesh->mVao[VpShadow];
+            setupSkeleton();
+        }
+
+        // Whether we have skeletal animation is part of the hash
+        if( mHlmsDatablock )
+        {
+            uint32 hash, casterHash;
+            mHlmsDatablock->getCreator()->calculateHashFor( this, hash, casterHash );
+            _setHlmsHashes( hash, casterHash );
+        }
+    }
+    //-----------------------------------------------------------------------
     const LightList &SubItem::getLights() const { return mParentItem->queryLights(); }
     //-----------------------------------------------------------------------------
     void SubItem::getRenderOperation( v1::RenderOperation &op, bool casterPass )
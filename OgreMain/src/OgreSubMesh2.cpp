@@ -35,6 +35,8 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #include "OgreMesh.h"
 #include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreProfiler.h"
 #include "OgreStringConverter.h"
 #include "OgreSubMesh.h"
 #include "OgreVertexShadowMapHelper.h"
@@ -50,7 +52,8 @@ namespace Ogre
         mNumPoses( 0 ),
         mPoseHalfPrecision( false ),
         mPoseNormals( false ),
-        mPoseTexBuffer( 0 )
+        mPoseTexBuffer( 0 ),
+        mMeshletBuffer( 0 )
     {
     }
     //-----------------------------------------------------------------------
@@ -61,6 +64,8 @@ namespace Ogre
 
         if( mPoseTexBuffer )
             mParent->mVaoManager->destroyTexBuffer( mPoseTexBuffer );
+
+        clearMeshlets();
     }
     //-----------------------------------------------------------------------
     void SubMesh::addBoneAssignment( const VertexBoneAssignment &vertBoneAssign )
@@ -365,6 +370,14 @@ namespace Ogre
 
         VertexBufferPacked *vertexBuffer = mVao[VpNormal][0]->getVertexBuffers()[indexSource];
 
+        if( vertexBuffer->getShadowCopy() )
+        {
+            // Avoid a GPU readback
+            _buildBoneAssignmentsFromVertexData(
+                static_cast<const uint8 *>( vertexBuffer->getShadowCopy() ) );
+            return;
+        }
+
         AsyncTicketPtr asyncTicket = vertexBuffer->readRequest( 0, vertexBuffer->getNumElements() );
         const uint8 *vertexData = static_cast<const uint8 *>( asyncTicket->map() );
         _buildBoneAssignmentsFromVertexData( vertexData );
@@ -475,6 +488,7 @@ namespace Ogre
 
         newSub->mBoneAssignments = mBoneAssignments;
         newSub->mBoneAssignmentsOutOfDate = mBoneAssignmentsOutOfDate;
+        newSub->mMeshlets = mMeshlets;
 
         const uint8 numVaoPasses = mParent->hasIndependentShadowMappingVaos() + 1;
         for( uint8 i = 0; i < numVaoPasses; ++i )
@@ -501,7 +515,7 @@ namespace Ogre
     }
     //---------------------------------------------------------------------
     void SubMesh::importFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords, bool qTangents,
-                                bool halfPose )
+                                bool halfPose, const VertexQuantizationSettings *quantization )
     {
         mMaterialName = subMesh->getMaterialName();
 
@@ -526,7 +540,7 @@ namespace Ogre
         mBlendIndexToBoneIndexMap = subMesh->blendIndexToBoneIndexMap;
         mBoneAssignmentsOutOfDate = false;
 
-        importBuffersFromV1( subMesh, halfPos, halfTexCoords, qTangents, halfPose, 0 );
+        importBuffersFromV1( subMesh, halfPos, halfTexCoords, qTangents, halfPose, 0, quantization );
 
         assert( subMesh->parent->hasValidShadowMappingBuffers() );
 
@@ -535,7 +549,8 @@ namespace Ogre
             subMesh->indexData[VpNormal] != subMesh->indexData[VpShadow] )
         {
             // Use the special version already built for v1
-            importBuffersFromV1( subMesh, halfPos, halfTexCoords, qTangents, halfPose, 1 );
+            importBuffersFromV1( subMesh, halfPos, halfTexCoords, qTangents, halfPose, 1,
+                                 quantization );
         }
         else
         {
@@ -545,11 +560,12 @@ namespace Ogre
     }
     //---------------------------------------------------------------------
     void SubMesh::importBuffersFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords,
-                                       bool qTangents, bool halfPose, size_t vaoPassIdx )
+                                       bool qTangents, bool halfPose, size_t vaoPassIdx,
+                                       const VertexQuantizationSettings *quantization )
     {
         VertexElement2Vec vertexElements;
-        char *data =
-            _arrangeEfficient( subMesh, halfPos, halfTexCoords, qTangents, &vertexElements, vaoPassIdx );
+        char *data = _arrangeEfficient( subMesh, halfPos, halfTexCoords, qTangents, &vertexElements,
+                                        vaoPassIdx, quantization );
 
         // Wrap the ptrs around these, because the VaoManager's call
         // can throw thus causing a leak if we don't free them.
@@ -806,6 +822,26 @@ namespace Ogre
     //---------------------------------------------------------------------
     void SubMesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents )
     {
+        arrangeEfficientImpl( halfPos, halfTexCoords, qTangents, 0 );
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::arrangeEfficient( const VertexQuantizationSettings &quantization )
+    {
+        // QTangents are always used when the submesh has tangents.
+        arrangeEfficientImpl( false, false, true, &quantization );
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::arrangeEfficientImpl( bool halfPos, bool halfTexCoords, bool qTangents,
+                                        const VertexQuantizationSettings *quantization )
+    {
+        if( _isUsingSharedBuffers() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "Mesh " + mParent->getName() +
+                             " uses MeshManager's shared buffers, its vertex format can't be changed",
+                         "SubMesh::arrangeEfficient" );
+        }
+
         uint8 numVaoPasses = mParent->hasIndependentShadowMappingVaos() + 1;
 
         for( uint8 vaoPassIdx = 0; vaoPassIdx < numVaoPasses; ++vaoPassIdx )
@@ -819,7 +855,8 @@ namespace Ogre
             while( itor != endt )
             {
                 newVaos.push_back( arrangeEfficient( halfPos, halfTexCoords, qTangents, *itor,
-                                                     sharedBuffers, mParent->mVaoManager ) );
+                                                     sharedBuffers, mParent->mVaoManager,
+                                                     quantization ) );
                 ++itor;
             }
 
@@ -837,7 +874,8 @@ namespace Ogre
     VertexArrayObject *SubMesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
                                                   VertexArrayObject *vao,
                                                   SharedVertexBufferMap &sharedBuffers,
-                                                  VaoManager *vaoManager )
+                                                  VaoManager *vaoManager,
+                                                  const VertexQuantizationSettings *quantization )
     {
         const VertexBufferPackedVec &vertexBuffers = vao->getVertexBuffers();
         VertexBufferPacked *newVertexBuffer = 0;
@@ -924,6 +962,12 @@ namespace Ogre
                 }
             }
 
+            if( quantization )
+            {
+                _quantizeVertexElements( srcData, vertexBuffers[0]->getNumElements(), *quantization,
+                                         vertexElements );
+            }
+
             char *data =
                 _arrangeEfficient( srcData, vertexElements, vertexBuffers[0]->getNumElements() );
             FreeOnDestructor dataPtrContainer( data );
@@ -952,6 +996,51 @@ namespace Ogre
                                                     vao->getOperationType() );
     }
     //---------------------------------------------------------------------
+    /// Max rounding error when storing a value of magnitude absValue as 16-bit half.
+    static float halfRoundingError( float absValue )
+    {
+        if( absValue <= 0.0f )
+            return 0.0f;
+        // Half has 10 explicit mantissa bits. For absValue in [2^e; 2^(e+1)) the
+        // spacing is 2^(e-10) thus the max error is half of it.
+        int exponent;
+        std::frexp( absValue, &exponent );
+        return std::ldexp( 1.0f, exponent - 12 );
+    }
+    //---------------------------------------------------------------------
+    /// See "A Survey of Efficient Representations for Independent Unit Vectors"
+    /// Cigolle et al. 2014. Must match octahedronDecode in the Hlms.
+    static void octahedronEncode( Vector3 n, int16 outData[2] )
+    {
+        const Real sumAbs = Math::Abs( n.x ) + Math::Abs( n.y ) + Math::Abs( n.z );
+        if( sumAbs > Real( 0.0 ) )
+            n /= sumAbs;
+        else
+            n = Vector3::UNIT_Z;
+
+        Real x = n.x;
+        Real y = n.y;
+        if( n.z < Real( 0.0 ) )
+        {
+            x = ( Real( 1.0 ) - Math::Abs( n.y ) ) * ( n.x >= Real( 0.0 ) ? Real( 1.0 ) : Real( -1.0 ) );
+            y = ( Real( 1.0 ) - Math::Abs( n.x ) ) * ( n.y >= Real( 0.0 ) ? Real( 1.0 ) : Real( -1.0 ) );
+        }
+
+        outData[0] = Bitwise::floatToSnorm16( x );
+        outData[1] = Bitwise::floatToSnorm16( y );
+    }
+    //---------------------------------------------------------------------
+    static Vector3 octahedronDecode( const int16 data[2] )
+    {
+        Vector3 n( Bitwise::snorm16ToFloat( data[0] ), Bitwise::snorm16ToFloat( data[1] ), 0 );
+        n.z = Real( 1.0 ) - Math::Abs( n.x ) - Math::Abs( n.y );
+        const Real t = std::max( -n.z, Real( 0.0 ) );
+        n.x += n.x >= Real( 0.0 ) ? -t : t;
+        n.y += n.y >= Real( 0.0 ) ? -t : t;
+        n.normalise();
+        return n;
+    }
+    //---------------------------------------------------------------------
     bool sortVertexElementsBySemantic2( const VertexElement2 &l, const VertexElement2 &r )
     {
         return l.mSemantic < r.mSemantic;
@@ -966,7 +1055,8 @@ namespace Ogre
 
     char *SubMesh::_arrangeEfficient( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords,
                                       bool qTangents, VertexElement2Vec *outVertexElements,
-                                      size_t vaoPassIdx )
+                                      size_t vaoPassIdx,
+                                      const VertexQuantizationSettings *quantization )
     {
         typedef FastArray<v1::VertexElement> VertexElementArray;
 
@@ -1088,6 +1178,12 @@ namespace Ogre
             ++itor;
         }
 
+        if( quantization )
+        {
+            _quantizeVertexElements( sourceData, vertexData->vertexCount, *quantization,
+                                     vertexElements );
+        }
+
         // Perform actual transfer
         char *retVal = _arrangeEfficient( sourceData, vertexElements,
                                           static_cast<uint32>( vertexData->vertexCount ) );
@@ -1102,6 +1198,119 @@ namespace Ogre
         return retVal;
     }
     //---------------------------------------------------------------------
+    void SubMesh::_quantizeVertexElements( const SourceDataArray &srcData, size_t vertexCount,
+                                           const VertexQuantizationSettings &settings,
+                                           VertexElement2Vec &inOutVertexElements )
+    {
+        OgreProfileExhaustive( "SubMesh::_quantizeVertexElements" );
+
+        const size_t numElements = std::min( inOutVertexElements.size(), srcData.size() );
+
+        // Keep the whole tangent frame in the same precision. A mesh with tangents
+        // should be using QTangents (which were already converted and are skipped below).
+        bool hasTangentFrame = false;
+        for( size_t i = 0u; i < inOutVertexElements.size(); ++i )
+        {
+            if( inOutVertexElements[i].mSemantic == VES_TANGENT ||
+                inOutVertexElements[i].mSemantic == VES_BINORMAL )
+            {
+                hasTangentFrame = true;
+            }
+        }
+
+        for( size_t i = 0u; i < numElements; ++i )
+        {
+            VertexElement2 &element = inOutVertexElements[i];
+            const SourceData &src = srcData[i];
+
+            // Already converted (e.g. QTangents) or not in floating point
+            if( element.mSemantic != src.element.mSemantic || element.mType != src.element.mType ||
+                v1::VertexElement::getBaseType( src.element.mType ) != VET_FLOAT1 )
+            {
+                continue;
+            }
+
+            const size_t typeCount = v1::VertexElement::getTypeCount( src.element.mType );
+
+            if( element.mSemantic == VES_NORMAL )
+            {
+                if( typeCount == 3u && settings.octahedralNormals && !hasTangentFrame )
+                    element.mType = VET_SHORT2_SNORM;
+                continue;
+            }
+
+            // Avoid converting 1 Float ==> 2 Half.
+            if( typeCount == 1u || vertexCount == 0u ||
+                ( element.mSemantic != VES_POSITION && element.mSemantic != VES_TEXTURE_COORDINATES ) )
+            {
+                continue;
+            }
+
+            // Analyze the range of the data.
+            const size_t numComponents = element.mSemantic == VES_POSITION ? 3u : typeCount;
+            float minValue[4] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                                  std::numeric_limits<float>::max(),
+                                  std::numeric_limits<float>::max() };
+            float maxValue[4] = { -std::numeric_limits<float>::max(),
+                                  -std::numeric_limits<float>::max(),
+                                  -std::numeric_limits<float>::max(),
+                                  -std::numeric_limits<float>::max() };
+
+            char const *srcPtr = src.data;
+            for( size_t j = 0u; j < vertexCount; ++j )
+            {
+                float values[4];
+                memcpy( values, srcPtr, numComponents * sizeof( float ) );
+                for( size_t k = 0u; k < numComponents; ++k )
+                {
+                    minValue[k] = std::min( minValue[k], values[k] );
+                    maxValue[k] = std::max( maxValue[k], values[k] );
+                }
+                srcPtr += src.bytesPerVertex;
+            }
+
+            float overallMin = std::numeric_limits<float>::max();
+            float overallMax = -std::numeric_limits<float>::max();
+            float maxExtent = 0.0f;
+            for( size_t k = 0u; k < numComponents; ++k )
+            {
+                overallMin = std::min( overallMin, minValue[k] );
+                overallMax = std::max( overallMax, maxValue[k] );
+                maxExtent = std::max( maxExtent, maxValue[k] - minValue[k] );
+            }
+
+            const float maxAbs = std::max( Math::Abs( overallMin ), Math::Abs( overallMax ) );
+            // 65504 is the largest finite half
+            const bool fitsHalf = maxAbs <= 65504.0f;
+
+            if( element.mSemantic == VES_POSITION )
+            {
+                if( fitsHalf &&
+                    halfRoundingError( maxAbs ) <= settings.positionPrecision * maxExtent )
+                {
+                    element.mType = VET_HALF4;
+                }
+            }
+            else
+            {
+                if( typeCount == 2u && overallMin >= 0.0f && overallMax <= 1.0f &&
+                    0.5f / 65535.0f <= settings.texCoordTolerance )
+                {
+                    element.mType = VET_USHORT2_NORM;
+                }
+                else if( typeCount == 2u && overallMin >= -1.0f && overallMax <= 1.0f &&
+                         0.5f / 32767.0f <= settings.texCoordTolerance )
+                {
+                    element.mType = VET_SHORT2_SNORM;
+                }
+                else if( fitsHalf && halfRoundingError( maxAbs ) <= settings.texCoordTolerance )
+                {
+                    element.mType = v1::VertexElement::multiplyTypeCount( VET_HALF2, typeCount );
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
     char *SubMesh::_arrangeEfficient( SourceDataArray srcData, const VertexElement2Vec &vertexElements,
                                       size_t vertexCount )
     {
@@ -1282,6 +1491,39 @@ namespace Ogre
                     for( size_t j = 0; j < v1::VertexElement::getTypeCount( vElement.mType ); ++j )
                         dstData16[j] = Bitwise::floatToHalf( fpData[j] );
                 }
+                else if( vElement.mSemantic == VES_NORMAL && vElement.mType == VET_SHORT2_SNORM &&
+                         itSrc->element.mType == VET_FLOAT3 )
+                {
+                    // Octahedral normals
+                    float normal[3];
+                    memcpy( normal, itSrc->data, sizeof( float ) * 3u );
+
+                    int16 *dstData16 = reinterpret_cast<int16 *>( dstData + acumOffset );
+                    octahedronEncode( Vector3( normal[0], normal[1], normal[2] ), dstData16 );
+                }
+                else if( ( vElement.mType == VET_USHORT2_NORM || vElement.mType == VET_SHORT2_SNORM ) &&
+                         itSrc->element.mType == VET_FLOAT2 )
+                {
+                    // Convert float to 16-bit normalized
+                    float fpData[2];
+                    memcpy( fpData, itSrc->data, sizeof( float ) * 2u );
+
+                    if( vElement.mType == VET_USHORT2_NORM )
+                    {
+                        uint16 *dstData16 = reinterpret_cast<uint16 *>( dstData + acumOffset );
+                        for( size_t j = 0; j < 2u; ++j )
+                        {
+                            dstData16[j] = static_cast<uint16>(
+                                Math::saturate( fpData[j] ) * 65535.0f + 0.5f );
+                        }
+                    }
+                    else
+                    {
+                        int16 *dstData16 = reinterpret_cast<int16 *>( dstData + acumOffset );
+                        for( size_t j = 0; j < 2u; ++j )
+                            dstData16[j] = Bitwise::floatToSnorm16( fpData[j] );
+                    }
+                }
                 else
                 {
                     // Raw. Transfer as is.
@@ -1305,6 +1547,14 @@ namespace Ogre
     //---------------------------------------------------------------------
     void SubMesh::dearrangeToInefficient()
     {
+        if( _isUsingSharedBuffers() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "Mesh " + mParent->getName() +
+                             " uses MeshManager's shared buffers, its vertex format can't be changed",
+                         "SubMesh::dearrangeToInefficient" );
+        }
+
         const uint8 numVaoPasses = mParent->hasIndependentShadowMappingVaos() + 1;
 
         for( uint8 vaoPassIdx = 0; vaoPassIdx < numVaoPasses; ++vaoPassIdx )
@@ -1413,6 +1663,17 @@ namespace Ogre
                 newVertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
                 newVertexElements.push_back( VertexElement2( VET_FLOAT4, VES_TANGENT ) );
             }
+            else if( element.mSemantic == VES_NORMAL && element.mType == VET_SHORT2_SNORM )
+            {
+                // Dealing with octahedral normals.
+                newVertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+            }
+            else if( element.mSemantic == VES_TEXTURE_COORDINATES &&
+                     ( element.mType == VET_USHORT2_NORM || element.mType == VET_SHORT2_SNORM ) )
+            {
+                // Convert from 16-bit normalized to float
+                newVertexElements.push_back( VertexElement2( VET_FLOAT2, element.mSemantic ) );
+            }
             else
             {
                 // Send through
@@ -1479,6 +1740,44 @@ namespace Ogre
 
                     dstData += 7 * sizeof( float );
                 }
+                else if( itElements->mSemantic == VES_NORMAL && itElements->mType == VET_SHORT2_SNORM )
+                {
+                    // Dealing with octahedral normals.
+                    int16 octData[2];
+                    memcpy( octData, srcData, sizeof( octData ) );
+                    const Vector3 vNormal = octahedronDecode( octData );
+
+                    float *dstDataF32 = reinterpret_cast<float *>( dstData );
+                    dstDataF32[0] = vNormal.x;
+                    dstDataF32[1] = vNormal.y;
+                    dstDataF32[2] = vNormal.z;
+
+                    dstData += 3 * sizeof( float );
+                }
+                else if( itElements->mSemantic == VES_TEXTURE_COORDINATES &&
+                         itElements->mType == VET_USHORT2_NORM )
+                {
+                    uint16 normData[2];
+                    memcpy( normData, srcData, sizeof( normData ) );
+
+                    float *dstDataF32 = reinterpret_cast<float *>( dstData );
+                    dstDataF32[0] = normData[0] / 65535.0f;
+                    dstDataF32[1] = normData[1] / 65535.0f;
+
+                    dstData += 2 * sizeof( float );
+                }
+                else if( itElements->mSemantic == VES_TEXTURE_COORDINATES &&
+                         itElements->mType == VET_SHORT2_SNORM )
+                {
+                    int16 normData[2];
+                    memcpy( normData, srcData, sizeof( normData ) );
+
+                    float *dstDataF32 = reinterpret_cast<float *>( dstData );
+                    dstDataF32[0] = Bitwise::snorm16ToFloat( normData[0] );
+                    dstDataF32[1] = Bitwise::snorm16ToFloat( normData[1] );
+
+                    dstData += 2 * sizeof( float );
+                }
                 else
                 {
                     // Raw. Transfer as is.
@@ -1502,12 +1801,21 @@ namespace Ogre
         typedef set<VertexBufferPacked *>::type VertexBufferPackedSet;
         VertexBufferPackedSet destroyedBuffers;
 
+        MeshManager *meshManager = MeshManager::getSingletonPtr();
+
         VertexArrayObjectArray::const_iterator itor = vaos.begin();
         VertexArrayObjectArray::const_iterator endt = vaos.end();
         while( itor != endt )
         {
             VertexArrayObject *vao = *itor;
 
+            // Buffers shared with other meshes are released by the MeshManager
+            if( meshManager && meshManager->_destroySharedVao( vao ) )
+            {
+                ++itor;
+                continue;
+            }
+
             const VertexBufferPackedVec &vertexBuffers = vao->getVertexBuffers();
             VertexBufferPackedVec::const_iterator itBuffers = vertexBuffers.begin();
             VertexBufferPackedVec::const_iterator enBuffers = vertexBuffers.end();
@@ -1557,4 +1865,526 @@ namespace Ogre
             VertexShadowMapHelper::useSameVaos( mParent->mVaoManager, mVao[VpNormal], mVao[VpShadow] );
         }
     }
+    //---------------------------------------------------------------------
+    bool SubMesh::_isUsingSharedBuffers() const
+    {
+        const MeshManager *meshManager = MeshManager::getSingletonPtr();
+        if( !meshManager )
+            return false;
+
+        // All LODs are shared (or not) together
+        return !mVao[VpNormal].empty() && meshManager->_isSharedVao( mVao[VpNormal][0] );
+    }
+    //---------------------------------------------------------------------
+    bool SubMesh::readTriangleListIndices( const VertexArrayObject *vao,
+                                           vector<uint32>::type &outIndices )
+    {
+        IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+
+        if( !indexBuffer || vao->getOperationType() != OT_TRIANGLE_LIST ||
+            vao->getPrimitiveStart() != 0u ||
+            vao->getPrimitiveCount() != indexBuffer->getNumElements() ||
+            indexBuffer->getNumElements() == 0u || indexBuffer->getNumElements() % 3u != 0u )
+        {
+            return false;
+        }
+
+        const size_t numIndices = indexBuffer->getNumElements();
+        outIndices.resize( numIndices );
+
+        AsyncTicketPtr asyncTicket = indexBuffer->readRequest( 0, numIndices );
+        const void *indexData = asyncTicket->map();
+
+        if( indexBuffer->getIndexType() == IndexBufferPacked::IT_16BIT )
+        {
+            const uint16 *indices16 = reinterpret_cast<const uint16 *>( indexData );
+            for( size_t i = 0; i < numIndices; ++i )
+                outIndices[i] = indices16[i];
+        }
+        else
+        {
+            memcpy( &outIndices[0], indexData, numIndices * sizeof( uint32 ) );
+        }
+
+        asyncTicket->unmap();
+
+        return true;
+    }
+    //---------------------------------------------------------------------
+    bool SubMesh::readPositions( VertexArrayObject *vao, vector<float>::type &outPositions )
+    {
+        size_t bufferIdx, offset;
+        const VertexElement2 *posElement = vao->findBySemantic( VES_POSITION, bufferIdx, offset );
+
+        if( !posElement ||
+            ( posElement->mType != VET_FLOAT3 && posElement->mType != VET_FLOAT4 &&
+              posElement->mType != VET_HALF4 ) )
+        {
+            return false;
+        }
+
+        VertexArrayObject::ReadRequestsVec readRequests;
+        readRequests.push_back( VertexArrayObject::ReadRequests( VES_POSITION ) );
+        vao->readRequests( readRequests );
+        vao->mapAsyncTickets( readRequests );
+
+        const VertexArrayObject::ReadRequests &request = readRequests[0];
+        const size_t numVertices = request.vertexBuffer->getNumElements();
+        const size_t bytesPerVertex = request.vertexBuffer->getBytesPerElement();
+        outPositions.resize( numVertices * 3u );
+
+        for( size_t i = 0; i < numVertices; ++i )
+        {
+            if( request.type == VET_HALF4 )
+            {
+                const uint16 *srcPos =
+                    reinterpret_cast<const uint16 *>( request.data + i * bytesPerVertex );
+                for( size_t j = 0; j < 3u; ++j )
+                    outPositions[i * 3u + j] = Bitwise::halfToFloat( srcPos[j] );
+            }
+            else
+            {
+                const float *srcPos =
+                    reinterpret_cast<const float *>( request.data + i * bytesPerVertex );
+                for( size_t j = 0; j < 3u; ++j )
+                    outPositions[i * 3u + j] = srcPos[j];
+            }
+        }
+
+        vao->unmapAsyncTickets( readRequests );
+
+        return true;
+    }
+    //---------------------------------------------------------------------
+    IndexBufferPacked *SubMesh::createIndexBufferLike( const IndexBufferPacked *srcIndexBuffer,
+                                                       const vector<uint32>::type &indices,
+                                                       VaoManager *vaoManager )
+    {
+        const size_t numIndices = indices.size();
+        const IndexBufferPacked::IndexType indexType = srcIndexBuffer->getIndexType();
+
+        void *indexData = OGRE_MALLOC_SIMD( numIndices * srcIndexBuffer->getBytesPerElement(),
+                                            MEMCATEGORY_GEOMETRY );
+        FreeOnDestructor dataPtrContainer( indexData );
+
+        if( indexType == IndexBufferPacked::IT_16BIT )
+        {
+            uint16 *indices16 = reinterpret_cast<uint16 *>( indexData );
+            for( size_t i = 0; i < numIndices; ++i )
+                indices16[i] = static_cast<uint16>( indices[i] );
+        }
+        else
+        {
+            memcpy( indexData, &indices[0], numIndices * sizeof( uint32 ) );
+        }
+
+        const bool keepAsShadow = srcIndexBuffer->getShadowCopy() != 0;
+        IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+            indexType, numIndices, srcIndexBuffer->getBufferType(), indexData, keepAsShadow );
+
+        if( keepAsShadow )  // Don't free the pointer ourselves
+            dataPtrContainer.ptr = 0;
+
+        return indexBuffer;
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::restoreShadowMappingVaos( bool hadShadowVaos, bool independentShadowVaos )
+    {
+        if( independentShadowVaos )
+        {
+            VertexShadowMapHelper::optimizeForShadowMapping( mParent->mVaoManager, mVao[VpNormal],
+                                                             mVao[VpShadow] );
+        }
+        else if( hadShadowVaos )
+        {
+            VertexShadowMapHelper::useSameVaos( mParent->mVaoManager, mVao[VpNormal],
+                                                mVao[VpShadow] );
+        }
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::buildMeshlets( uint32 maxVertices, uint32 maxTriangles )
+    {
+        OgreProfileExhaustive( "SubMesh2::buildMeshlets" );
+
+        clearMeshlets();
+
+        if( mVao[VpNormal].empty() )
+            return;
+
+        VaoManager *vaoManager = mParent->mVaoManager;
+
+        const bool hadShadowVaos = !mVao[VpShadow].empty();
+        const bool independentShadowVaos = hadShadowVaos && mVao[VpNormal][0] != mVao[VpShadow][0];
+
+        const size_t numVaos = mVao[VpNormal].size();
+
+        vector<MeshOptimizer::MeshletVec>::type meshlets( numVaos );
+        vector<vector<uint32>::type>::type lodIndices( numVaos );
+
+        {
+            vector<float>::type positions;
+            VertexBufferPacked *positionsOwner = 0;
+            vector<uint32>::type indices;
+
+            for( size_t lodIdx = 0; lodIdx < numVaos; ++lodIdx )
+            {
+                VertexArrayObject *vao = mVao[VpNormal][lodIdx];
+
+                if( !readTriangleListIndices( vao, indices ) )
+                    continue;
+
+                if( positionsOwner != vao->getVertexBuffers()[0] )
+                {
+                    positionsOwner = vao->getVertexBuffers()[0];
+                    if( !readPositions( vao, positions ) )
+                        positions.clear();
+                }
+
+                if( positions.empty() )
+                    continue;
+
+                lodIndices[lodIdx].resize( indices.size() );
+                MeshOptimizer::buildMeshlets( &lodIndices[lodIdx][0], meshlets[lodIdx], &indices[0],
+                                              indices.size(), &positions[0], sizeof( float ) * 3u,
+                                              positionsOwner->getNumElements(), maxVertices,
+                                              maxTriangles );
+            }
+        }
+
+        // Shared shadow Vaos would become dangling; independent ones
+        // must be regenerated from the new index buffers.
+        destroyShadowMappingVaos();
+
+        for( size_t lodIdx = 0; lodIdx < numVaos; ++lodIdx )
+        {
+            if( meshlets[lodIdx].empty() )
+                continue;
+
+            VertexArrayObject *vao = mVao[VpNormal][lodIdx];
+            IndexBufferPacked *indexBuffer =
+                createIndexBufferLike( vao->getIndexBuffer(), lodIndices[lodIdx], vaoManager );
+
+            mVao[VpNormal][lodIdx] = vaoManager->createVertexArrayObject(
+                vao->getVertexBuffers(), indexBuffer, vao->getOperationType() );
+
+            vaoManager->destroyIndexBuffer( vao->getIndexBuffer() );
+            vaoManager->destroyVertexArrayObject( vao );
+        }
+
+        restoreShadowMappingVaos( hadShadowVaos, independentShadowVaos );
+
+        _setMeshlets( meshlets );
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::clearMeshlets()
+    {
+        if( mMeshletBuffer )
+        {
+            mParent->mVaoManager->destroyReadOnlyBuffer( mMeshletBuffer );
+            mMeshletBuffer = 0;
+        }
+
+        mMeshlets.clear();
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::_setMeshlets( vector<MeshOptimizer::MeshletVec>::type &meshlets )
+    {
+        clearMeshlets();
+
+        bool anyMeshlet = false;
+        vector<MeshOptimizer::MeshletVec>::type::const_iterator itor = meshlets.begin();
+        vector<MeshOptimizer::MeshletVec>::type::const_iterator endt = meshlets.end();
+        while( itor != endt && !anyMeshlet )
+            anyMeshlet = !( itor++ )->empty();
+
+        if( anyMeshlet )
+            mMeshlets.swap( meshlets );
+    }
+    //---------------------------------------------------------------------
+    const MeshOptimizer::MeshletVec &SubMesh::getMeshlets( size_t lodIdx ) const
+    {
+        static const MeshOptimizer::MeshletVec c_emptyMeshlets;
+        return lodIdx < mMeshlets.size() ? mMeshlets[lodIdx] : c_emptyMeshlets;
+    }
+    //---------------------------------------------------------------------
+    uint32 SubMesh::getMeshletBufferOffset( size_t lodIdx ) const
+    {
+        size_t offset = 0u;
+        for( size_t i = 0u; i < lodIdx && i < mMeshlets.size(); ++i )
+            offset += mMeshlets[i].size();
+        return static_cast<uint32>( offset );
+    }
+    //---------------------------------------------------------------------
+    ReadOnlyBufferPacked *SubMesh::getMeshletBuffer()
+    {
+        if( !mMeshletBuffer && !mMeshlets.empty() )
+        {
+            const size_t numMeshlets = getMeshletBufferOffset( mMeshlets.size() );
+            const size_t sizeBytes = numMeshlets * sizeof( MeshOptimizer::Meshlet );
+
+            MeshOptimizer::Meshlet *meshletData = reinterpret_cast<MeshOptimizer::Meshlet *>(
+                OGRE_MALLOC_SIMD( sizeBytes, MEMCATEGORY_GEOMETRY ) );
+            FreeOnDestructor dataPtrContainer( meshletData );
+
+            MeshOptimizer::Meshlet *dstMeshlet = meshletData;
+            vector<MeshOptimizer::MeshletVec>::type::const_iterator itor = mMeshlets.begin();
+            vector<MeshOptimizer::MeshletVec>::type::const_iterator endt = mMeshlets.end();
+            while( itor != endt )
+            {
+                if( !itor->empty() )
+                {
+                    memcpy( dstMeshlet, &( *itor )[0], itor->size() * sizeof( MeshOptimizer::Meshlet ) );
+                    dstMeshlet += itor->size();
+                }
+                ++itor;
+            }
+
+            mMeshletBuffer = mParent->mVaoManager->createReadOnlyBuffer(
+                PFG_RGBA32_UINT, sizeBytes, BT_IMMUTABLE, meshletData, false );
+        }
+
+        return mMeshletBuffer;
+    }
+    //---------------------------------------------------------------------
+    MeshOptimizer::VertexCacheStats SubMesh::analyzeVertexCache( uint32 cacheSize ) const
+    {
+        MeshOptimizer::VertexCacheStats stats;
+
+        vector<uint32>::type indices;
+        if( !mVao[VpNormal].empty() && readTriangleListIndices( mVao[VpNormal][0], indices ) )
+        {
+            const size_t numVertices = mVao[VpNormal][0]->getVertexBuffers()[0]->getNumElements();
+            stats = MeshOptimizer::analyzeVertexCache( &indices[0], indices.size(), numVertices,
+                                                       cacheSize );
+        }
+
+        return stats;
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::optimizeVertexCache( bool overdraw, bool vertexFetch, float overdrawThreshold )
+    {
+        OgreProfileExhaustive( "SubMesh2::optimizeVertexCache" );
+
+        if( mVao[VpNormal].empty() )
+            return;
+
+        // Triangles are about to be reordered, meshlets would no longer match them.
+        clearMeshlets();
+
+        VaoManager *vaoManager = mParent->mVaoManager;
+
+        const bool hadShadowVaos = !mVao[VpShadow].empty();
+        const bool independentShadowVaos = hadShadowVaos && mVao[VpNormal][0] != mVao[VpShadow][0];
+
+        // Pose animation references vertices by their index.
+        if( mNumPoses > 0u )
+            vertexFetch = false;
+
+        const size_t numVaos = mVao[VpNormal].size();
+
+        vector<vector<uint32>::type>::type lodIndices( numVaos );
+        vector<bool>::type optimizedLods( numVaos, false );
+
+        // LODs normally share the same vertex buffers. Vertices can only be reordered if
+        // every Vao sharing them can have its indices remapped.
+        typedef map<VertexBufferPacked *, bool>::type CanRemapMap;
+        CanRemapMap canRemapVertices;
+
+        for( size_t lodIdx = 0; lodIdx < numVaos; ++lodIdx )
+        {
+            VertexArrayObject *vao = mVao[VpNormal][lodIdx];
+            optimizedLods[lodIdx] = readTriangleListIndices( vao, lodIndices[lodIdx] );
+
+            VertexBufferPacked *vertexBuffer = vao->getVertexBuffers()[0];
+            CanRemapMap::iterator itRemap = canRemapVertices.find( vertexBuffer );
+            if( itRemap == canRemapVertices.end() )
+                canRemapVertices[vertexBuffer] = vertexFetch && optimizedLods[lodIdx];
+            else
+                itRemap->second &= optimizedLods[lodIdx];
+        }
+
+        // Reorder the triangles of every LOD
+        {
+            vector<float>::type positions;
+            VertexBufferPacked *positionsOwner = 0;
+            vector<uint32>::type tmpIndices;
+
+            for( size_t lodIdx = 0; lodIdx < numVaos; ++lodIdx )
+            {
+                if( !optimizedLods[lodIdx] )
+                    continue;
+
+                VertexArrayObject *vao = mVao[VpNormal][lodIdx];
+                vector<uint32>::type &indices = lodIndices[lodIdx];
+                const size_t numVertices = vao->getVertexBuffers()[0]->getNumElements();
+
+                tmpIndices.resize( indices.size() );
+                MeshOptimizer::optimizeVertexCache( &tmpIndices[0], &indices[0], indices.size(),
+                                                    numVertices );
+
+                bool hasPositions = false;
+                if( overdraw )
+                {
+                    if( positionsOwner != vao->getVertexBuffers()[0] )
+                    {
+                        positionsOwner = vao->getVertexBuffers()[0];
+                        if( !readPositions( vao, positions ) )
+                            positions.clear();
+                    }
+                    hasPositions = !positions.empty();
+                }
+
+                if( hasPositions )
+                {
+                    MeshOptimizer::optimizeOverdraw( &indices[0], &tmpIndices[0], indices.size(),
+                                                     &positions[0], sizeof( float ) * 3u, numVertices,
+                                                     overdrawThreshold );
+                }
+                else
+                {
+                    indices.swap( tmpIndices );
+                }
+            }
+        }
+
+        // Reorder the vertices in order of first use. Start with the highest LOD
+        // so that it gets the best locality.
+        typedef map<VertexBufferPacked *, VertexBufferPacked *>::type VertexBufferMap;
+        VertexBufferMap newVertexBuffers;
+
+        CanRemapMap::const_iterator itRemap = canRemapVertices.begin();
+        CanRemapMap::const_iterator enRemap = canRemapVertices.end();
+
+        while( itRemap != enRemap )
+        {
+            if( itRemap->second )
+            {
+                vector<uint32>::type allIndices;
+                VertexArrayObject *firstVao = 0;
+                for( size_t lodIdx = 0; lodIdx < numVaos; ++lodIdx )
+                {
+                    VertexArrayObject *vao = mVao[VpNormal][lodIdx];
+                    if( vao->getVertexBuffers()[0] == itRemap->first )
+                    {
+                        if( !firstVao )
+                            firstVao = vao;
+                        allIndices.insert( allIndices.end(), lodIndices[lodIdx].begin(),
+                                           lodIndices[lodIdx].end() );
+                    }
+                }
+
+                const size_t numVertices = itRemap->first->getNumElements();
+                vector<uint32>::type remap( numVertices );
+                if( numVertices > 0u )
+                {
+                    MeshOptimizer::optimizeVertexFetchRemap(
+                        &remap[0], allIndices.empty() ? 0 : &allIndices[0], allIndices.size(),
+                        numVertices );
+                }
+
+                for( size_t lodIdx = 0; lodIdx < numVaos; ++lodIdx )
+                {
+                    if( mVao[VpNormal][lodIdx]->getVertexBuffers()[0] == itRemap->first &&
+                        !lodIndices[lodIdx].empty() )
+                    {
+                        MeshOptimizer::remapIndices( &lodIndices[lodIdx][0], lodIndices[lodIdx].size(),
+                                                     &remap[0] );
+                    }
+                }
+
+                const VertexBufferPackedVec &vertexBuffers = firstVao->getVertexBuffers();
+                VertexBufferPackedVec::const_iterator itBuffers = vertexBuffers.begin();
+                VertexBufferPackedVec::const_iterator enBuffers = vertexBuffers.end();
+
+                while( itBuffers != enBuffers )
+                {
+                    VertexBufferPacked *vertexBuffer = *itBuffers;
+                    const size_t bytesPerVertex = vertexBuffer->getBytesPerElement();
+
+                    uint8 *vertexData = reinterpret_cast<uint8 *>(
+                        OGRE_MALLOC_SIMD( numVertices * bytesPerVertex, MEMCATEGORY_GEOMETRY ) );
+                    FreeOnDestructor dataPtrContainer( vertexData );
+
+                    AsyncTicketPtr asyncTicket = vertexBuffer->readRequest( 0, numVertices );
+                    MeshOptimizer::remapVertices( vertexData, asyncTicket->map(), numVertices,
+                                                  bytesPerVertex, &remap[0] );
+                    asyncTicket->unmap();
+
+                    const bool keepAsShadow = vertexBuffer->getShadowCopy() != 0;
+                    newVertexBuffers[vertexBuffer] = vaoManager->createVertexBuffer(
+                        vertexBuffer->getVertexElements(), numVertices, vertexBuffer->getBufferType(),
+                        vertexData, keepAsShadow );
+
+                    if( keepAsShadow )  // Don't free the pointer ourselves
+                        dataPtrContainer.ptr = 0;
+
+                    ++itBuffers;
+                }
+
+                // Bone assignments of the highest LOD must follow its vertices.
+                if( firstVao == mVao[VpNormal][0] && !mBoneAssignments.empty() )
+                {
+                    VertexBoneAssignmentVec::iterator itAssignment = mBoneAssignments.begin();
+                    VertexBoneAssignmentVec::iterator enAssignment = mBoneAssignments.end();
+                    while( itAssignment != enAssignment )
+                    {
+                        itAssignment->vertexIndex = remap[itAssignment->vertexIndex];
+                        ++itAssignment;
+                    }
+
+                    std::sort( mBoneAssignments.begin(), mBoneAssignments.end() );
+                }
+            }
+
+            ++itRemap;
+        }
+
+        // Shared shadow Vaos would become dangling; independent ones
+        // must be regenerated from the new buffers.
+        destroyShadowMappingVaos();
+
+        VertexArrayObjectArray newVaos;
+        newVaos.reserve( numVaos );
+
+        for( size_t lodIdx = 0; lodIdx < numVaos; ++lodIdx )
+        {
+            VertexArrayObject *vao = mVao[VpNormal][lodIdx];
+
+            VertexBufferPackedVec vertexBuffers = vao->getVertexBuffers();
+            VertexBufferPackedVec::iterator itBuffers = vertexBuffers.begin();
+            VertexBufferPackedVec::iterator enBuffers = vertexBuffers.end();
+
+            while( itBuffers != enBuffers )
+            {
+                VertexBufferMap::const_iterator itNewBuffer = newVertexBuffers.find( *itBuffers );
+                if( itNewBuffer != newVertexBuffers.end() )
+                    *itBuffers = itNewBuffer->second;
+                ++itBuffers;
+            }
+
+            IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+
+            if( optimizedLods[lodIdx] )
+            {
+                indexBuffer = createIndexBufferLike( indexBuffer, lodIndices[lodIdx], vaoManager );
+                vaoManager->destroyIndexBuffer( vao->getIndexBuffer() );
+            }
+
+            newVaos.push_back( vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                                    vao->getOperationType() ) );
+            vaoManager->destroyVertexArrayObject( vao );
+        }
+
+        VertexBufferMap::const_iterator itOldBuffer = newVertexBuffers.begin();
+        VertexBufferMap::const_iterator enOldBuffer = newVertexBuffers.end();
+        while( itOldBuffer != enOldBuffer )
+        {
+            vaoManager->destroyVertexBuffer( itOldBuffer->first );
+            ++itOldBuffer;
+        }
+
+        mVao[VpNormal].swap( newVaos );
+
+        restoreShadowMappingVaos( hadShadowVaos, independentShadowVaos );
+    }
 }  // namespace Ogre
@@ -32,6 +32,8 @@ THE SOFTWARE.
 #include "OgreException.h"
 #include "OgreHardwareBufferManager.h"
 #include "OgreLogManager.h"
+#include "OgreSceneManager.h"
+#include "Threading/OgreUniformScalableTask.h"
 
 #include <sstream>
 
@@ -39,12 +41,178 @@ namespace Ogre
 {
     namespace v1
     {
+        //---------------------------------------------------------------------
+        /// Faces or vertices a single thread must have before splitting the work is worth it
+        static const size_t c_minItemsPerThread = 8192u;
+        //---------------------------------------------------------------------
+        /** Work of TangentSpaceCalc::build that can be split across threads.
+        @remarks
+            Each thread handles a contiguous range of faces (or vertices) and only reads from
+            TangentSpaceCalc::mVertexArray (or only writes to the vertices in its range).
+        */
+        struct TangentSpaceCalcJob : public UniformScalableTask
+        {
+            enum Phase
+            {
+                /// Computes the tangent space of every face in the current index set
+                PhaseCalculateFaces,
+                /// Normalises & orthogonalises the tangent space of every vertex
+                PhaseNormaliseVertices
+            };
+
+            struct Face
+            {
+                size_t  localVertInd[3];
+                Vector3 tsU;
+                Vector3 tsV;
+                Vector3 norm;
+                Real    angleWeights[3];
+                int     parity;
+            };
+
+            TangentSpaceCalc *tsc;
+            Phase             phase;
+            size_t            numThreads;
+
+            // Current index set (PhaseCalculateFaces)
+            const void   *indexData;
+            bool          idx32bit;
+            OperationType opType;
+
+            vector<Face>::type faces;
+
+            TangentSpaceCalcJob( TangentSpaceCalc *_tsc ) :
+                tsc( _tsc ),
+                phase( PhaseCalculateFaces ),
+                numThreads( 1u ),
+                indexData( 0 ),
+                idx32bit( false ),
+                opType( OT_TRIANGLE_LIST )
+            {
+            }
+
+            size_t readIndex( size_t i ) const
+            {
+                return idx32bit ? static_cast<const uint32 *>( indexData )[i]
+                                : static_cast<const uint16 *>( indexData )[i];
+            }
+
+            void calculateFaces( size_t threadIdx )
+            {
+                const size_t faceCount = faces.size();
+                const size_t begin = faceCount * threadIdx / numThreads;
+                const size_t end = faceCount * ( threadIdx + 1u ) / numThreads;
+
+                for( size_t f = begin; f < end; ++f )
+                {
+                    Face &face = faces[f];
+                    size_t *localVertInd = face.localVertInd;
+
+                    if( opType == OT_TRIANGLE_LIST )
+                    {
+                        localVertInd[0] = readIndex( f * 3u + 0u );
+                        localVertInd[1] = readIndex( f * 3u + 1u );
+                        localVertInd[2] = readIndex( f * 3u + 2u );
+                    }
+                    else if( opType == OT_TRIANGLE_FAN )
+                    {
+                        // Element 0 always remains the same
+                        localVertInd[0] = readIndex( 0u );
+                        localVertInd[1] = readIndex( f + 1u );
+                        localVertInd[2] = readIndex( f + 2u );
+                    }
+                    else
+                    {
+                        // Invert the ordering on odd numbered triangles, we interpret
+                        // front as anticlockwise all the time but strips alternate
+                        const size_t invertOrdering = f & 0x1u;
+                        localVertInd[0] = readIndex( f );
+                        localVertInd[1] = readIndex( f + 1u + invertOrdering );
+                        localVertInd[2] = readIndex( f + 2u - invertOrdering );
+                    }
+
+                    //   Calculate tangent & binormal per triangle
+                    //   Note these are not normalised, are weighted by UV area
+                    tsc->calculateFaceTangentSpace( localVertInd, face.tsU, face.tsV, face.norm );
+
+                    // Invalid UV space triangles are skipped later
+                    if( face.tsU.isZeroLength() || face.tsV.isZeroLength() )
+                        continue;
+
+                    face.parity = tsc->calculateParity( face.tsU, face.tsV, face.norm );
+                    // We want to re-weight these by the angle the face makes with the vertex
+                    // in order to obtain tessellation-independent results
+                    for( size_t v = 0; v < 3u; ++v )
+                    {
+                        face.angleWeights[v] = tsc->calculateAngleWeight(
+                            localVertInd[v], localVertInd[( v + 1u ) % 3u],
+                            localVertInd[( v + 2u ) % 3u] );
+                    }
+                }
+            }
+
+            void normaliseVertices( size_t threadIdx )
+            {
+                TangentSpaceCalc::VertexInfoArray &vertexArray = tsc->mVertexArray;
+                const size_t vertexCount = vertexArray.size();
+                const size_t begin = vertexCount * threadIdx / numThreads;
+                const size_t end = vertexCount * ( threadIdx + 1u ) / numThreads;
+
+                for( size_t i = begin; i < end; ++i )
+                {
+                    TangentSpaceCalc::VertexInfo &v = vertexArray[i];
+
+                    v.tangent.normalise();
+                    v.binormal.normalise();
+
+                    // Orthogonalise with the vertex normal since it's currently
+                    // orthogonal with the face normals, but will be close to ortho
+                    // Apply Gram-Schmidt orthogonalise
+                    Vector3 temp = v.tangent;
+                    v.tangent = temp - ( v.norm * v.norm.dotProduct( temp ) );
+
+                    temp = v.binormal;
+                    v.binormal = temp - ( v.norm * v.norm.dotProduct( temp ) );
+
+                    // renormalize
+                    v.tangent.normalise();
+                    v.binormal.normalise();
+                }
+            }
+
+            void executePhase( size_t threadIdx )
+            {
+                if( phase == PhaseCalculateFaces )
+                    calculateFaces( threadIdx );
+                else
+                    normaliseVertices( threadIdx );
+            }
+
+            /// Small workloads may use fewer threads than the SceneManager has
+            void execute( size_t threadIdx, size_t numWorkerThreads ) override
+            {
+                OGRE_ASSERT_LOW( numThreads <= numWorkerThreads );
+                if( threadIdx < numThreads )
+                    executePhase( threadIdx );
+            }
+
+            void run( Phase _phase, size_t _numThreads )
+            {
+                phase = _phase;
+                numThreads = _numThreads;
+                if( numThreads > 1u )
+                    tsc->mSceneManager->executeUserScalableTask( this, true );
+                else
+                    executePhase( 0u );
+            }
+        };
         //---------------------------------------------------------------------
         TangentSpaceCalc::TangentSpaceCalc() :
             mVData( 0 ),
             mSplitMirrored( false ),
             mSplitRotated( false ),
-            mStoreParityInW( false )
+            mStoreParityInW( false ),
+            mSceneManager( 0 )
         {
         }
         //---------------------------------------------------------------------
@@ -206,26 +374,9 @@ namespace Ogre
         {
             // Just run through our complete (possibly augmented) list of vertices
             // Normalise the tangents & binormals
-            for( VertexInfoArray::iterator i = mVertexArray.begin(); i != mVertexArray.end(); ++i )
-            {
-                VertexInfo &v = *i;
-
-                v.tangent.normalise();
-                v.binormal.normalise();
-
-                // Orthogonalise with the vertex normal since it's currently
-                // orthogonal with the face normals, but will be close to ortho
-                // Apply Gram-Schmidt orthogonalise
-                Vector3 temp = v.tangent;
-                v.tangent = temp - ( v.norm * v.norm.dotProduct( temp ) );
-
-                temp = v.binormal;
-                v.binormal = temp - ( v.norm * v.norm.dotProduct( temp ) );
-
-                // renormalize
-                v.tangent.normalise();
-                v.binormal.normalise();
-            }
+            TangentSpaceCalcJob job( this );
+            job.run( TangentSpaceCalcJob::PhaseNormaliseVertices,
+                     calculateNumThreads( mVertexArray.size() ) );
         }
         //---------------------------------------------------------------------
         void TangentSpaceCalc::processFaces( Result &result )
@@ -241,6 +392,8 @@ namespace Ogre
                 }
             }
 
+            TangentSpaceCalcJob job( this );
+
             for( size_t i = 0; i < mIDataList.size(); ++i )
             {
                 IndexData *i_in = mIDataList[i];
@@ -248,96 +401,50 @@ namespace Ogre
 
                 // Read data from buffers
                 HardwareIndexBufferSharedPtr ibuf = i_in->indexBuffer;
-                bool idx32bit = ibuf->getType() == HardwareIndexBuffer::IT_32BIT;
                 HardwareBufferLockGuard ibufLock( ibuf, HardwareBuffer::HBL_READ_ONLY );
-                uint16 *p16 = static_cast<uint16 *>( ibufLock.pData ) + i_in->indexStart;
-                uint32 *p32 = static_cast<uint32 *>( ibufLock.pData ) + i_in->indexStart;
-
-                // current triangle
-                size_t vertInd[3] = { 0, 0, 0 };
-                // loop through all faces to calculate the tangents and normals
-                size_t faceCount =
-                    opType == OT_TRIANGLE_LIST ? i_in->indexCount / 3 : i_in->indexCount - 2;
+                job.idx32bit = ibuf->getType() == HardwareIndexBuffer::IT_32BIT;
+                job.indexData = static_cast<const uint8 *>( ibufLock.pData ) +
+                                i_in->indexStart * ibuf->getIndexSize();
+                job.opType = opType;
+
+                size_t faceCount = 0;
+                if( opType == OT_TRIANGLE_LIST )
+                    faceCount = i_in->indexCount / 3u;
+                else if( i_in->indexCount >= 3u )
+                    faceCount = i_in->indexCount - 2u;
+
+                // Calculate the tangent space of all faces at once
+                job.faces.resize( faceCount );
+                job.run( TangentSpaceCalcJob::PhaseCalculateFaces, calculateNumThreads( faceCount ) );
+
+                // Then add their contributions in order, since vertex splits depend on
+                // what was accumulated so far
                 for( size_t f = 0; f < faceCount; ++f )
                 {
-                    bool invertOrdering = false;
-                    // Read 1 or 3 indexes depending on type
-                    if( f == 0 || opType == OT_TRIANGLE_LIST )
-                    {
-                        vertInd[0] = idx32bit ? *p32++ : *p16++;
-                        vertInd[1] = idx32bit ? *p32++ : *p16++;
-                        vertInd[2] = idx32bit ? *p32++ : *p16++;
-                    }
-                    else if( opType == OT_TRIANGLE_FAN )
-                    {
-                        // Element 0 always remains the same
-                        // Element 2 becomes element 1
-                        vertInd[1] = vertInd[2];
-                        // read new into element 2
-                        vertInd[2] = idx32bit ? *p32++ : *p16++;
-                    }
-                    else if( opType == OT_TRIANGLE_STRIP )
-                    {
-                        // Shunt everything down one, but also invert the ordering on
-                        // odd numbered triangles (== even numbered i's)
-                        // we interpret front as anticlockwise all the time but strips alternate
-                        if( f & 0x1 )
-                        {
-                            // odd tris (index starts at 3, 5, 7)
-                            invertOrdering = true;
-                        }
-                        vertInd[0] = vertInd[1];
-                        vertInd[1] = vertInd[2];
-                        vertInd[2] = idx32bit ? *p32++ : *p16++;
-                    }
-
-                    // deal with strip inversion of winding
-                    size_t localVertInd[3];
-                    localVertInd[0] = vertInd[0];
-                    if( invertOrdering )
-                    {
-                        localVertInd[1] = vertInd[2];
-                        localVertInd[2] = vertInd[1];
-                    }
-                    else
-                    {
-                        localVertInd[1] = vertInd[1];
-                        localVertInd[2] = vertInd[2];
-                    }
-
-                    // For each triangle
-                    //   Calculate tangent & binormal per triangle
-                    //   Note these are not normalised, are weighted by UV area
-                    Vector3 faceTsU, faceTsV, faceNorm;
-                    calculateFaceTangentSpace( localVertInd, faceTsU, faceTsV, faceNorm );
+                    const TangentSpaceCalcJob::Face &face = job.faces[f];
 
                     // Skip invalid UV space triangles
-                    if( faceTsU.isZeroLength() || faceTsV.isZeroLength() )
+                    if( face.tsU.isZeroLength() || face.tsV.isZeroLength() )
                         continue;
 
-                    addFaceTangentSpaceToVertices( i, f, localVertInd, faceTsU, faceTsV, faceNorm,
-                                                   result );
+                    addFaceTangentSpaceToVertices( i, f, face.localVertInd, face.tsU, face.tsV,
+                                                   face.norm, face.parity, face.angleWeights, result );
                 }
             }
         }
         //---------------------------------------------------------------------
-        void TangentSpaceCalc::addFaceTangentSpaceToVertices( size_t indexSet, size_t faceIndex,
-                                                              size_t *localVertInd,
-                                                              const Vector3 &faceTsU,
-                                                              const Vector3 &faceTsV,
-                                                              const Vector3 &faceNorm, Result &result )
+        void TangentSpaceCalc::addFaceTangentSpaceToVertices(
+            size_t indexSet, size_t faceIndex, const size_t *localVertInd, const Vector3 &faceTsU,
+            const Vector3 &faceTsV, const Vector3 &faceNorm, int faceParity, const Real *angleWeights,
+            Result &result )
         {
-            // Calculate parity for this triangle
-            int faceParity = calculateParity( faceTsU, faceTsV, faceNorm );
             // Now add these to each vertex referenced by the face
             for( int v = 0; v < 3; ++v )
             {
                 // index 0 is vertex we're calculating, 1 and 2 are the others
 
-                // We want to re-weight these by the angle the face makes with the vertex
-                // in order to obtain tessellation-independent results
-                Real angleWeight = calculateAngleWeight( localVertInd[v], localVertInd[( v + 1 ) % 3],
-                                                         localVertInd[( v + 2 ) % 3] );
+                // Re-weighted by the angle the face makes with the vertex
+                const Real angleWeight = angleWeights[v];
 
                 VertexInfo *vertex = &( mVertexArray[localVertInd[v]] );
 
@@ -504,6 +611,15 @@ namespace Ogre
             return diff0.angleBetween( diff1 ).valueRadians();
         }
         //---------------------------------------------------------------------
+        size_t TangentSpaceCalc::calculateNumThreads( size_t numItems ) const
+        {
+            if( !mSceneManager )
+                return 1u;
+            const size_t numThreads =
+                std::min( mSceneManager->getNumWorkerThreads(), numItems / c_minItemsPerThread );
+            return std::max<size_t>( numThreads, 1u );
+        }
+        //---------------------------------------------------------------------
         void TangentSpaceCalc::populateVertexArray( unsigned short sourceTexCoordSet )
         {
             // Just pull data out into more friendly structures
@@ -30,8 +30,10 @@ THE SOFTWARE.
 
 #include "OgreTextureFilters.h"
 
+#include "OgreBCnEncoder.h"
 #include "OgreImage2.h"
 #include "OgrePixelFormatGpuUtils.h"
+#include "OgrePlatformInformation.h"
 #include "OgreProfiler.h"
 #include "OgreTextureBox.h"
 #include "OgreTextureGpuManager.h"
@@ -101,11 +103,21 @@ namespace Ogre
                 filtersVec.push_back( OGRE_NEW TextureFilter::PremultiplyAlpha() );
             }
 
+            PixelFormatGpu compressedFormat = finalPixelFormat;
+            if( filters & TextureFilter::TypeCompressBCn )
+            {
+                compressedFormat = CompressBCn::getDestinationFormat(
+                    filters, finalPixelFormat, image, texture->getTextureManager() );
+            }
+
             // Add mipmap generation as one of the last steps
             if( filters & TextureFilter::TypeGenerateDefaultMipmaps )
             {
-                const uint8 mipmapGen =
+                uint8 mipmapGen =
                     selectMipmapGen( filters, image, finalPixelFormat, texture->getTextureManager() );
+                // Mipmaps must be generated before compressing, which rules out HW mipmaps
+                if( compressedFormat != finalPixelFormat )
+                    mipmapGen = DefaultMipmapGen::SwMode;
                 // If the user wants Mipmaps when loading OnStorage -> OnSystemRam
                 // then he should either explicitly ask only for SW filters, or
                 // load the texture to Resident first, then download to OnSystemRam.
@@ -115,6 +127,10 @@ namespace Ogre
                     filtersVec.push_back( OGRE_NEW TextureFilter::GenerateSwMipmaps() );
             }
 
+            // Compression must always be last
+            if( compressedFormat != finalPixelFormat )
+                filtersVec.push_back( OGRE_NEW TextureFilter::CompressBCn( compressedFormat ) );
+
             filtersVec.swap( outFilters );
         }
         //-----------------------------------------------------------------------------------
@@ -142,11 +158,20 @@ namespace Ogre
             if( filters & TextureFilter::TypeLeaveChannelR )
                 inOutPixelFormat = LeaveChannelR::getDestinationFormat( inOutPixelFormat );
 
+            PixelFormatGpu compressedFormat = inOutPixelFormat;
+            if( filters & TextureFilter::TypeCompressBCn )
+            {
+                compressedFormat = CompressBCn::getDestinationFormat( filters, inOutPixelFormat, image,
+                                                                      textureGpuManager );
+            }
+
             // Add mipmap generation as one of the last steps
             if( filters & TextureFilter::TypeGenerateDefaultMipmaps )
             {
-                const uint8 mipmapGen =
+                uint8 mipmapGen =
                     selectMipmapGen( filters, image, inOutPixelFormat, textureGpuManager );
+                if( compressedFormat != inOutPixelFormat )
+                    mipmapGen = DefaultMipmapGen::SwMode;
 
                 const bool canDoMipmaps =
                     ( mipmapGen == DefaultMipmapGen::HwMode &&
@@ -163,6 +188,8 @@ namespace Ogre
                         image.getWidth(), image.getHeight(), image.getDepth() );
                 }
             }
+
+            inOutPixelFormat = compressedFormat;
         }
         //-----------------------------------------------------------------------------------
         uint32 GenerateSwMipmaps::getFilter( const Image2 &image )
@@ -493,5 +520,107 @@ namespace Ogre
                 }
             }
         }
+        //-----------------------------------------------------------------------------------
+        PixelFormatGpu CompressBCn::getDestinationFormat( uint32 filters, PixelFormatGpu srcFormat,
+                                                          const Image2 &image,
+                                                          const TextureGpuManager *textureManager )
+        {
+            const TextureTypes::TextureTypes textureType = image.getTextureType();
+            if( textureType == TextureTypes::Type1D || textureType == TextureTypes::Type3D ||
+                ( image.getWidth() & 0x03u ) || ( image.getHeight() & 0x03u ) )
+            {
+                return srcFormat;
+            }
+
+            const bool useBC7 = ( filters & TextureFilter::TypeCompressBC7 ) != 0u;
+
+            PixelFormatGpu dstFormat = PFG_UNKNOWN;
+            switch( PixelFormatGpuUtils::getEquivalentLinear( srcFormat ) )
+            {
+            case PFG_RGBA8_UNORM:
+            case PFG_BGRA8_UNORM:
+                dstFormat = useBC7 ? PFG_BC7_UNORM : PFG_BC3_UNORM;
+                break;
+            case PFG_BGRX8_UNORM:
+            case PFG_RGB8_UNORM:
+            case PFG_BGR8_UNORM:
+                dstFormat = useBC7 ? PFG_BC7_UNORM : PFG_BC1_UNORM;
+                break;
+            case PFG_R8_UNORM:
+                dstFormat = PFG_BC4_UNORM;
+                break;
+            case PFG_R8_SNORM:
+                dstFormat = PFG_BC4_SNORM;
+                break;
+            case PFG_RG8_UNORM:
+                dstFormat = PFG_BC5_UNORM;
+                break;
+            case PFG_RG8_SNORM:
+                dstFormat = PFG_BC5_SNORM;
+                break;
+            default:
+                return srcFormat;
+            }
+
+            if( PixelFormatGpuUtils::isSRgb( srcFormat ) )
+                dstFormat = PixelFormatGpuUtils::getEquivalentSRGB( dstFormat );
+
+            if( !textureManager->checkSupport( dstFormat, textureType, 0 ) )
+                return srcFormat;
+
+            return dstFormat;
+        }
+        //-----------------------------------------------------------------------------------
+        void CompressBCn::_executeStreaming( Image2 &image, TextureGpu *texture )
+        {
+            OgreProfileExhaustive( "CompressBCn::_executeStreaming" );
+
+            const PixelFormatGpu srcFormat = image.getPixelFormat();
+
+            // Cubemaps may be loaded as 6 separate images, all of them must agree
+            if( !BCnEncoder::isSupported( srcFormat, mDstFormat ) ||
+                ( image.getWidth() & 0x03u ) || ( image.getHeight() & 0x03u ) )
+            {
+                return;
+            }
+
+            const uint8 numMipmaps = image.getNumMipmaps();
+
+            const size_t dstSizeBytes =
+                PixelFormatGpuUtils::calculateSizeBytes( image.getWidth(),      //
+                                                         image.getHeight(),     //
+                                                         image.getDepth(),      //
+                                                         image.getNumSlices(),  //
+                                                         mDstFormat,            //
+                                                         numMipmaps,            //
+                                                         4u );
+
+            void *data = OGRE_MALLOC_SIMD( dstSizeBytes, MEMCATEGORY_RESOURCE );
+
+            Image2 dstImage;
+            dstImage.loadDynamicImage( data, image.getWidth(), image.getHeight(),
+                                       image.getDepthOrSlices(), image.getTextureType(), mDstFormat,
+                                       false, numMipmaps );
+
+            // Encoding is slow enough to be worth spreading across all cores,
+            // even though we're already running on a worker thread
+            const uint32 numThreads = PlatformInformation::getNumLogicalCores();
+
+            for( uint8 mip = 0; mip < numMipmaps; ++mip )
+            {
+                TextureBox srcBox = image.getData( mip );
+                TextureBox dstBox = dstImage.getData( mip );
+                BCnEncoder::compress( srcBox, srcFormat, dstBox, mDstFormat, numThreads );
+            }
+
+            image.loadDynamicImage( data, image.getWidth(), image.getHeight(), image.getDepthOrSlices(),
+                                    image.getTextureType(), mDstFormat, true, numMipmaps );
+
+            PixelFormatGpu finalFormat = mDstFormat;
+            if( texture->prefersLoadingFromFileAsSRGB() )
+                finalFormat = PixelFormatGpuUtils::getEquivalentSRGB( finalFormat );
+            if( texture->getPixelFormat() != finalFormat )
+                texture->setPixelFormat( finalFormat );
+        }
     }  // namespace TextureFilter
 }  // namespace Ogre
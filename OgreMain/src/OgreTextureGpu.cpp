@@ -64,6 +64,7 @@ namespace Ogre
         mTextureType( initialType ),
         mPixelFormat( PFG_UNKNOWN ),
         mTextureFlags( textureFlags ),
+        mAutomaticBatchingApplied( false ),
         mPoolId( 0 ),
         mSysRamCopy( 0 ),
         mTextureManager( textureManager ),
@@ -459,6 +460,14 @@ namespace Ogre
                 notifyAllListenersTextureChanged( TextureGpuListener::FsaaSettingAlteredByApi, 0 );
         }
 
+        if( !( mTextureFlags & TextureFlags::NoAutomaticBatching ) &&
+            mTextureManager->_shouldApplyAutomaticBatching( this ) )
+        {
+            // Small texture: let it share a pool with other textures (see
+            // TextureGpuManager::setAutomaticBatchingMaxResolution)
+            mAutomaticBatchingApplied = true;
+        }
+
         if( !hasAutomaticBatching() )
         {
             // At this point we should have all valid settings (pixel format, width, height)
@@ -588,6 +597,8 @@ namespace Ogre
         if( allowResidencyChange )
         {
             mResidencyStatus = newResidency;
+            if( mResidencyStatus != GpuResidency::Resident )
+                mAutomaticBatchingApplied = false;
             // Decrement mPendingResidencyChanges and prevent underflow
             mPendingResidencyChanges = std::max( mPendingResidencyChanges, 1u ) - 1u;
             notifyAllListenersTextureChanged( listenerReason );
@@ -642,6 +653,7 @@ namespace Ogre
 
             mSysRamCopy = sysRamPtr;
             mResidencyStatus = GpuResidency::OnSystemRam;
+            mAutomaticBatchingApplied = false;
 
             listenerReason = TextureGpuListener::LostResidency;
         }
@@ -766,7 +778,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     bool TextureGpu::hasAutomaticBatching() const
     {
-        return ( mTextureFlags & TextureFlags::AutomaticBatching ) != 0;
+        return ( mTextureFlags & TextureFlags::AutomaticBatching ) != 0 || mAutomaticBatchingApplied;
     }
     //-----------------------------------------------------------------------------------
     bool TextureGpu::isTexture() const { return ( mTextureFlags & TextureFlags::NotTexture ) == 0; }
@@ -47,6 +47,7 @@ THE SOFTWARE.
 #include "OgreResourceGroupManager.h"
 #include "OgreStagingTexture.h"
 #include "OgreString.h"
+#include "OgreStringConverter.h"
 #include "OgreTextureFilters.h"
 #include "OgreTextureGpu.h"
 #include "OgreTextureGpuManagerListener.h"
@@ -56,11 +57,11 @@ THE SOFTWARE.
 #include "Threading/OgreThreads.h"
 #include "Vao/OgreVaoManager.h"
 
+#include "Hash/MurmurHash3.h"
+
 #include <fstream>
 
 #if !OGRE_NO_JSON
-#    include "OgreStringConverter.h"
-#
 #    if defined( __GNUC__ ) && !defined( __clang__ )
 #        pragma GCC diagnostic push
 #        pragma GCC diagnostic ignored "-Wclass-memaccess"
@@ -90,6 +91,10 @@ namespace Ogre
     static const int c_mainThread = 0;
     static const int c_workerThread = 1;
 
+    /// Bump this value whenever a TextureFilter changes its output,
+    /// so that old entries in the filtered texture cache are ignored.
+    static const uint32 c_filteredCacheVersion = 2u;
+
     static DefaultTextureGpuManagerListener sDefaultTextureGpuManagerListener;
 
     unsigned long updateStreamingWorkerThread( ThreadHandle *threadHandle );
@@ -119,6 +124,8 @@ namespace Ogre
 #else
         mStagingTextureMaxBudgetBytes( 128u * 1024u * 1024u ),
 #endif
+        mFilteredCacheTmpCounter( 0u ),
+        mAutomaticBatchingMaxResolution( 0u ),
         mDelayListenerCalls( false ),
         mIgnoreScheduledTasks( false ),
 #ifdef OGRE_PROFILING_TEXTURES
@@ -1441,6 +1448,35 @@ namespace Ogre
         mTryLockMutexFailureLimit = tryLockFailureLimit;
     }
     //-----------------------------------------------------------------------------------
+    void TextureGpuManager::setFilteredTextureCacheFolder( const String &folder )
+    {
+        mFilteredCacheFolder = folder;
+        if( !mFilteredCacheFolder.empty() && *mFilteredCacheFolder.rbegin() != '/' &&
+            *mFilteredCacheFolder.rbegin() != '\\' )
+        {
+            mFilteredCacheFolder += '/';
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::setAutomaticBatchingMaxResolution( uint32 maxResolution )
+    {
+        mAutomaticBatchingMaxResolution = maxResolution;
+    }
+    //-----------------------------------------------------------------------------------
+    bool TextureGpuManager::_shouldApplyAutomaticBatching( const TextureGpu *texture ) const
+    {
+        if( mAutomaticBatchingMaxResolution == 0u )
+            return false;
+
+        return !texture->hasAutomaticBatching() && texture->isTexture() &&
+               !texture->isRenderToTexture() && !texture->isUav() && !texture->isManualTexture() &&
+               !texture->isPoolOwner() && !texture->isRenderWindowSpecific() &&
+               !texture->isMultisample() && texture->getTextureType() == TextureTypes::Type2D &&
+               texture->getDepthOrSlices() == 1u &&
+               texture->getWidth() <= mAutomaticBatchingMaxResolution &&
+               texture->getHeight() <= mAutomaticBatchingMaxResolution;
+    }
+    //-----------------------------------------------------------------------------------
     void TextureGpuManager::setProfileLoadingTime( bool bProfile )
     {
 #ifdef OGRE_PROFILING_TEXTURES
@@ -2769,7 +2805,10 @@ namespace Ogre
 
                     try
                     {
-                        img->load2( data, loadRequest.name );
+                        loadRequest.loadedFromFilteredCache = loadFromFilteredCache(
+                            data, loadRequest, *img, loadRequest.filteredCachePath );
+                        if( !loadRequest.loadedFromFilteredCache )
+                            img->load2( data, loadRequest.name );
                     }
                     catch( Exception & )
                     {
@@ -2818,6 +2857,189 @@ namespace Ogre
         return 0;
     }
     //-----------------------------------------------------------------------------------
+    bool TextureGpuManager::loadFromFilteredCache( DataStreamPtr &inOutData,
+                                                   const LoadRequest &loadRequest, Image2 &outImage,
+                                                   String &outFilteredCachePath ) const
+    {
+        if( mFilteredCacheFolder.empty() || !inOutData )
+            return false;
+
+        // No point in caching what is already in its final form
+        const size_t extPos = loadRequest.name.find_last_of( '.' );
+        if( extPos != String::npos &&
+            StringUtil::match( loadRequest.name.substr( extPos + 1u ), "oitd", false ) )
+        {
+            return false;
+        }
+
+        OgreProfileExhaustive( "TextureGpuManager::loadFromFilteredCache" );
+
+        // We need the whole file in memory to hash it. Keep it so it can be decoded on miss.
+        MemoryDataStreamPtr memStream( OGRE_NEW MemoryDataStream( loadRequest.name, inOutData ) );
+        inOutData = memStream;
+
+        String path =
+            _getFilteredCachePath( memStream->getPtr(), memStream->size(), loadRequest.filters,
+                                   loadRequest.texture->prefersLoadingFromFileAsSRGB() );
+
+        std::ifstream *ifs = OGRE_NEW_T( std::ifstream, MEMCATEGORY_GENERAL );
+        ifs->open( path.c_str(), std::ios_base::binary | std::ios_base::in );
+        if( ifs->is_open() )
+        {
+            try
+            {
+                DataStreamPtr cachedData( OGRE_NEW FileStreamDataStream( path, ifs, true ) );
+                outImage.load2( cachedData, path );
+                return true;
+            }
+            catch( Exception &e )
+            {
+                // Corrupt or from an incompatible version. Overwrite it
+                LogManager::getSingleton().logMessage(
+                    "[WARNING] Ignoring filtered texture cache entry " + path + " for " +
+                    loadRequest.name + ": " + e.getDescription() );
+            }
+        }
+        else
+        {
+            OGRE_DELETE_T( ifs, basic_ifstream, MEMCATEGORY_GENERAL );
+        }
+
+        outFilteredCachePath.swap( path );
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 TextureGpuManager::getFilteredCacheCapabilities() const
+    {
+        // Formats CompressBCn may output. It leaves the image untouched if they're not supported
+        static const PixelFormatGpu c_compressedFormats[] = {
+            PFG_BC1_UNORM, PFG_BC1_UNORM_SRGB, PFG_BC3_UNORM, PFG_BC3_UNORM_SRGB, PFG_BC4_UNORM,
+            PFG_BC4_SNORM, PFG_BC5_UNORM,      PFG_BC5_SNORM, PFG_BC7_UNORM,      PFG_BC7_UNORM_SRGB
+        };
+        // Common formats GenerateDefaultMipmaps may choose HW or SW mipmaps for
+        static const PixelFormatGpu c_mipmappedFormats[] = {
+            PFG_RGBA8_UNORM, PFG_RGBA8_UNORM_SRGB, PFG_BGRA8_UNORM, PFG_BGRA8_UNORM_SRGB,
+            PFG_R8_UNORM,    PFG_RG8_UNORM,        PFG_RGBA16_FLOAT
+        };
+
+        uint32 retVal = 0u;
+        uint32 bit = 0u;
+        for( size_t i = 0u; i < sizeof( c_compressedFormats ) / sizeof( c_compressedFormats[0] ); ++i )
+        {
+            if( checkSupport( c_compressedFormats[i], TextureTypes::Type2D, 0u ) )
+                retVal |= 1u << bit;
+            ++bit;
+        }
+        for( size_t i = 0u; i < sizeof( c_mipmappedFormats ) / sizeof( c_mipmappedFormats[0] ); ++i )
+        {
+            if( checkSupport( c_mipmappedFormats[i], TextureTypes::Type2D,
+                              TextureFlags::AllowAutomipmaps ) )
+            {
+                retVal |= 1u << bit;
+            }
+            ++bit;
+            if( checkSupport( c_mipmappedFormats[i], TextureTypes::TypeCube,
+                              TextureFlags::AllowAutomipmaps ) )
+            {
+                retVal |= 1u << bit;
+            }
+            ++bit;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    String TextureGpuManager::_getFilteredCachePath( const void *fileData, size_t sizeBytes,
+                                                     uint32 filters, bool sRGB ) const
+    {
+        if( mFilteredCacheFolder.empty() )
+            return BLANKSTRING;
+
+        // MurmurHash3 takes an int length. Bigger files get hashed in chunks,
+        // then the hashes of the chunks get hashed together
+        const size_t c_maxChunkBytes = size_t( 1u ) << 30u;
+
+        uint64 hash[2];
+        if( sizeBytes <= c_maxChunkBytes )
+        {
+            MurmurHash3_x64_128( fileData, static_cast<int>( sizeBytes ), c_filteredCacheVersion,
+                                 hash );
+        }
+        else
+        {
+            const uint8 *chunkData = reinterpret_cast<const uint8 *>( fileData );
+            vector<uint64>::type chunkHashes;
+            chunkHashes.reserve( ( sizeBytes / c_maxChunkBytes + 1u ) * 2u );
+            for( size_t offset = 0u; offset < sizeBytes; offset += c_maxChunkBytes )
+            {
+                const size_t chunkBytes = std::min( sizeBytes - offset, c_maxChunkBytes );
+                MurmurHash3_x64_128( chunkData + offset, static_cast<int>( chunkBytes ),
+                                     c_filteredCacheVersion, hash );
+                chunkHashes.push_back( hash[0] );
+                chunkHashes.push_back( hash[1] );
+            }
+            MurmurHash3_x64_128( &chunkHashes[0],
+                                 static_cast<int>( chunkHashes.size() * sizeof( uint64 ) ),
+                                 c_filteredCacheVersion, hash );
+        }
+
+        uint32 settings = 0u;
+        if( sRGB )
+            settings |= 1u << 0u;
+        settings |= static_cast<uint32>( mDefaultMipmapGen ) << 1u;
+        settings |= static_cast<uint32>( mDefaultMipmapGenCubemaps ) << 3u;
+
+        // An entry generated on one device may not be valid for another (e.g. it
+        // couldn't compress to BCn, or it relied on HW mipmaps which can't be cached)
+        const uint64 values[5] = { hash[0], hash[1], filters, settings,
+                                   getFilteredCacheCapabilities() };
+        const char *hexDigits = "0123456789abcdef";
+
+        String path = mFilteredCacheFolder;
+        path.reserve( path.size() + sizeof( values ) * 2u + sizeof( ".oitd" ) );
+        for( size_t i = 0u; i < 5u; ++i )
+        {
+            const size_t numNibbles = i < 2u ? 16u : 8u;
+            for( size_t j = numNibbles; j--; )
+                path.push_back( hexDigits[( values[i] >> ( j * 4u ) ) & 0x0Fu] );
+        }
+        path += ".oitd";
+        return path;
+    }
+    //-----------------------------------------------------------------------------------
+    String TextureGpuManager::_getFilteredCacheTmpPath( const String &filteredCachePath )
+    {
+        const uint32 tmpId = mFilteredCacheTmpCounter.fetch_add( 1u, std::memory_order_relaxed );
+        return filteredCachePath + "." + StringConverter::toString( tmpId ) + ".tmp.oitd";
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::saveToFilteredCache( const String &filteredCachePath, const String &name,
+                                                 Image2 &image )
+    {
+        if( filteredCachePath.empty() )
+            return;
+
+        OgreProfileExhaustive( "TextureGpuManager::saveToFilteredCache" );
+
+        // Write to a temporary file first, so that an interrupted
+        // write can't leave a truncated entry in the cache. Each job gets its own file
+        // as two worker threads may be filtering the same file at the same time
+        const String tmpPath = _getFilteredCacheTmpPath( filteredCachePath );
+        try
+        {
+            image.save( tmpPath, 0u, image.getNumMipmaps() );
+            std::remove( filteredCachePath.c_str() );
+            if( std::rename( tmpPath.c_str(), filteredCachePath.c_str() ) != 0 )
+                std::remove( tmpPath.c_str() );
+        }
+        catch( Exception &e )
+        {
+            LogManager::getSingleton().logMessage( "[WARNING] Could not save " + name +
+                                                   " to filtered texture cache: " +
+                                                   e.getDescription() );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void TextureGpuManager::processLoadRequest( ObjCmdBuffer *commandBuffer, ThreadData &workerData,
                                                 const LoadRequest &loadRequest )
     {
@@ -2890,6 +3112,10 @@ namespace Ogre
         Image2 imgStack;
         Image2 *img = loadRequest.image;
 
+        // See setFilteredTextureCacheFolder
+        bool loadedFromFilteredCache = loadRequest.loadedFromFilteredCache;
+        String filteredCachePath = loadRequest.filteredCachePath;
+
 #ifdef OGRE_PROFILING_TEXTURES
         Timer profilingTimer;
 #endif
@@ -2897,15 +3123,24 @@ namespace Ogre
         if( !img )
         {
             img = &imgStack;
+            loadedFromFilteredCache = false;
+            filteredCachePath.clear();
             if( !wasRescheduled )
             {
                 try
                 {
                     if( data )
-                        img->load2( data, loadRequest.name );
+                    {
+                        loadedFromFilteredCache =
+                            loadFromFilteredCache( data, loadRequest, *img, filteredCachePath );
+                        if( !loadedFromFilteredCache )
+                            img->load2( data, loadRequest.name );
+                    }
                 }
                 catch( Exception &e )
                 {
+                    filteredCachePath.clear();
+
                     // Log the exception
                     LogManager::getSingleton().logMessage( e.getFullDescription() );
                     // Tell the main thread this happened
@@ -2936,6 +3171,13 @@ namespace Ogre
             }
         }
 
+        // Images from the filtered cache already went through all filters, except
+        // the mipmap ones (which are no-ops if the image already has mipmaps)
+        const uint32 filterTypes =
+            loadedFromFilteredCache
+                ? ( loadRequest.filters & TextureFilter::TypeGenerateDefaultMipmaps )
+                : loadRequest.filters;
+
         if( ( loadRequest.sliceOrDepth == std::numeric_limits<uint32>::max() ||
               loadRequest.sliceOrDepth == 0 ) &&
             loadRequest.texture->getResidencyStatus() != GpuResidency::OnStorage )
@@ -2945,7 +3187,7 @@ namespace Ogre
             if( loadRequest.texture->prefersLoadingFromFileAsSRGB() )
                 pixelFormat = PixelFormatGpuUtils::getEquivalentSRGB( pixelFormat );
             TextureFilter::FilterBase::simulateFiltersForCacheConsistency(
-                loadRequest.filters, *img, this, numMipmaps, pixelFormat );
+                filterTypes, *img, this, numMipmaps, pixelFormat );
 
             // Check the metadata cache was not out of date
             if( loadRequest.texture->getWidth() != img->getWidth() ||
@@ -2976,8 +3218,8 @@ namespace Ogre
         if( !wasRescheduled )
         {
             FilterBaseArray filters;
-            TextureFilter::FilterBase::createFilters( loadRequest.filters, filters, loadRequest.texture,
-                                                      *img, loadRequest.toSysRam );
+            TextureFilter::FilterBase::createFilters( filterTypes, filters, loadRequest.texture, *img,
+                                                      loadRequest.toSysRam );
 
             if( loadRequest.sliceOrDepth == std::numeric_limits<uint32>::max() ||
                 loadRequest.sliceOrDepth == 0 )
@@ -3010,6 +3252,8 @@ namespace Ogre
                     ++itFilters;
                 }
 
+                saveToFilteredCache( filteredCachePath, loadRequest.name, *img );
+
                 const bool needsMultipleImages =
                     img->getTextureType() != loadRequest.texture->getTextureType() &&
                     loadRequest.texture->getTextureType() != TextureTypes::Type1D;
@@ -3096,6 +3340,8 @@ namespace Ogre
                     ++itFilters;
                 }
 
+                saveToFilteredCache( filteredCachePath, loadRequest.name, *img );
+
                 if( loadRequest.toSysRam || loadRequest.texture->getGpuPageOutStrategy() ==
                                                 GpuPageOutStrategy::AlwaysKeepSystemRamCopy )
                 {
@@ -30,6 +30,7 @@ THE SOFTWARE.
 
 #include "ParticleSystem/OgreEmitter2.h"
 
+#include "Math/Array/OgreArrayQuaternion.h"
 #include "OgreException.h"
 
 using namespace Ogre;
@@ -38,12 +39,108 @@ EmitterDefData::EmitterDefData() : ParticleEmitter( nullptr ), mDimensions( 1.0f
 {
 }
 //-----------------------------------------------------------------------------
-uint32 EmitterDefData::genEmissionCount( Real timeSinceLast, EmitterInstanceData &instanceData ) const
+size_t EmitterDefData::getNextPackSize( const EmittedParticle *newHandles, const size_t numParticles )
+{
+    OGRE_ASSERT_LOW( numParticles > 0u );
+
+    const uint32 firstHandle = newHandles[0].handle;
+    const size_t maxPackSize = std::min<size_t>(
+        ARRAY_PACKED_REALS - firstHandle % ARRAY_PACKED_REALS, numParticles );
+
+    size_t packSize = 1u;
+    while( packSize < maxPackSize && newHandles[packSize].handle == firstHandle + packSize )
+        ++packSize;
+
+    if( packSize == maxPackSize )
+        return packSize;  // Consecutive. Either an aligned pack or the head of a range.
+
+    // Scattered handles (e.g. refilling a full pool). They can't be written whole anyway.
+    return std::min<size_t>( ARRAY_PACKED_REALS, numParticles );
+}
+//-----------------------------------------------------------------------------
+bool EmitterDefData::initEmittedParticlesPack( const ParticleCpuData &cpuData,
+                                               const EmittedParticle *newHandles,
+                                               const Vector3 *localPos, const size_t numParticles )
+{
+    OGRE_ASSERT_LOW( numParticles > 0u && numParticles <= ARRAY_PACKED_REALS );
+
+    Vector3 directions[ARRAY_PACKED_REALS];
+    ColourValue colours[ARRAY_PACKED_REALS];
+    Real timeToLive[ARRAY_PACKED_REALS];
+    for( size_t i = 0u; i < numParticles; ++i )
+    {
+        this->genEmissionDirection( localPos[i], directions[i] );
+        this->genEmissionVelocity( directions[i] );
+        this->genEmissionColour( colours[i] );
+        timeToLive[i] = this->genEmissionTTL();
+    }
+
+    // Gather. Unused lanes repeat the last particle.
+    ArrayVector3 instancePos, arrayLocalPos, arrayDirection;
+    ArrayQuaternion instanceRot;
+    ArrayVector4 colour;
+    for( size_t i = 0u; i < ARRAY_PACKED_REALS; ++i )
+    {
+        const size_t srcIdx = std::min( i, numParticles - 1u );
+        instancePos.setFromVector3( newHandles[srcIdx].pos, i );
+        instanceRot.setFromQuaternion( newHandles[srcIdx].rot, i );
+        arrayLocalPos.setFromVector3( localPos[srcIdx], i );
+        arrayDirection.setFromVector3( directions[srcIdx], i );
+        colour.setFromVector4( Vector4( colours[srcIdx].ptr() ), i );
+    }
+
+    const ArrayVector3 position = instancePos + instanceRot * arrayLocalPos;
+    const ArrayVector3 direction = instanceRot * arrayDirection;
+
+    const uint32 firstHandle = newHandles[0].handle;
+    bool bWholePack = numParticles == ARRAY_PACKED_REALS && firstHandle % ARRAY_PACKED_REALS == 0u;
+    for( size_t i = 1u; i < numParticles && bWholePack; ++i )
+        bWholePack = newHandles[i].handle == firstHandle + i;
+
+    if( bWholePack )
+    {
+        const size_t j = firstHandle / ARRAY_PACKED_REALS;
+        cpuData.mPosition[j] = position;
+        cpuData.mDirection[j] = direction;
+        cpuData.mDimensions[j].setAll( mDimensions );
+        cpuData.mRotation[j] = ArrayRadian( ARRAY_REAL_ZERO );
+        cpuData.mColour[j] = colour;
+    }
+
+    // Scatter
+    for( size_t i = 0u; i < numParticles; ++i )
+    {
+        const size_t h = newHandles[i].handle;
+
+        if( !bWholePack )
+        {
+            const size_t j = h / ARRAY_PACKED_REALS;
+            const size_t idx = h % ARRAY_PACKED_REALS;
+
+            Vector3 value;
+            position.getAsVector3( value, i );
+            cpuData.mPosition[j].setFromVector3( value, idx );
+            direction.getAsVector3( value, i );
+            cpuData.mDirection[j].setFromVector3( value, idx );
+            cpuData.mDimensions[j].setFromVector2( mDimensions, idx );
+            reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mRotation )[h] = 0.0f;
+            cpuData.mColour[j].setFromVector4( Vector4( colours[i].ptr() ), idx );
+        }
+
+        reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTimeToLive )[h] =
+            reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTotalTimeToLive )[h] = timeToLive[i];
+    }
+
+    return bWholePack;
+}
+//-----------------------------------------------------------------------------
+uint32 EmitterDefData::genEmissionCount( Real timeSinceLast, EmitterInstanceData &instanceData,
+                                         Real emissionRateScale ) const
 {
     if( instanceData.mEnabled )
     {
         // Keep fractions, otherwise a high frame rate will result in zero emissions!
-        instanceData.mRemainder += mEmissionRate * timeSinceLast;
+        instanceData.mRemainder += mEmissionRate * emissionRateScale * timeSinceLast;
         const uint32 intRequest = (uint32)instanceData.mRemainder;
         instanceData.mRemainder -= (Real)intRequest;
 
@@ -0,0 +1,344 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2023 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "ParticleSystem/OgreParticleGpuSimulation.h"
+
+#include "OgreHlmsCompute.h"
+#include "OgreHlmsComputeJob.h"
+#include "OgreProfiler.h"
+#include "OgreRenderSystem.h"
+#include "ParticleSystem/OgreParticleSystem2.h"
+#include "ParticleSystem/OgreParticleSystemManager2.h"
+#include "Vao/OgreDynamicUploadRing.h"
+#include "Vao/OgreReadOnlyBufferPacked.h"
+#include "Vao/OgreUavBufferPacked.h"
+#include "Vao/OgreVaoManager.h"
+
+using namespace Ogre;
+
+/// Number of float4 per particle in SimulatedDef::stateBuffer
+static constexpr uint32 kStateFloat4PerParticle = 4u;
+/// Number of float4 per affector uploaded to the simulate job (type + params)
+static constexpr uint32 kFloat4PerAffector = 1u + GpuParticleAffector::kMaxParams / 4u;
+
+static_assert( GpuParticleAffector::kMaxParams % 4u == 0u, "Params must be uploaded as float4" );
+static_assert( sizeof( ParticleGpuSpawn ) == ( kStateFloat4PerParticle + 1u ) * 4u * sizeof( float ),
+               "ParticleGpuSpawn must match ParticleGpuSimulation_piece_cs.any" );
+
+ParticleGpuSimulation::ParticleGpuSimulation( VaoManager *vaoManager, HlmsCompute *hlmsCompute ) :
+    mVaoManager( vaoManager ),
+    mHlmsCompute( hlmsCompute ),
+    mSpawnJob( 0 ),
+    mSimulateJob( 0 )
+{
+}
+//-----------------------------------------------------------------------------
+ParticleGpuSimulation::~ParticleGpuSimulation() { removeAllParticleSystemDefs(); }
+//-----------------------------------------------------------------------------
+bool ParticleGpuSimulation::canBeGpuSimulated( const ParticleSystemDef *systemDef )
+{
+    GpuParticleAffector gpuAffector;
+    for( const ParticleAffector2 *affector : systemDef->getAffectors() )
+    {
+        if( !affector->getGpuParams( gpuAffector ) )
+            return false;
+    }
+    return true;
+}
+//-----------------------------------------------------------------------------
+bool ParticleGpuSimulation::addParticleSystemDef( ParticleSystemDef *systemDef )
+{
+    // Depth sorting needs the particles' positions on the CPU.
+    if( !mHlmsCompute || systemDef->mGpuSimulated || systemDef->mIsBillboardSet ||
+        systemDef->isDepthSorted() || !systemDef->isInitialized() || !canBeGpuSimulated( systemDef ) )
+    {
+        return false;
+    }
+
+    const RenderSystemCapabilities *caps = mHlmsCompute->getRenderSystem()->getCapabilities();
+    if( !caps->hasCapability( RSC_COMPUTE_PROGRAM ) )
+        return false;
+
+    const uint32 quota = systemDef->getQuota();
+
+    // Start from the current state so that live particles don't disappear.
+    // Unused slots have a time to live <= 0, thus are considered dead.
+    FastArray<float> initialState;
+    initialState.resizePOD( quota * kStateFloat4PerParticle * 4u );
+
+    const ParticleCpuData cpuData = systemDef->getParticleCpuData();
+    const Real *RESTRICT_ALIAS rotations = reinterpret_cast<const Real *>( cpuData.mRotation );
+    const Real *RESTRICT_ALIAS rotationSpeeds = reinterpret_cast<const Real *>( cpuData.mRotationSpeed );
+    const Real *RESTRICT_ALIAS timeToLive = reinterpret_cast<const Real *>( cpuData.mTimeToLive );
+    const Real *RESTRICT_ALIAS totalTimeToLive =
+        reinterpret_cast<const Real *>( cpuData.mTotalTimeToLive );
+
+    for( uint32 h = 0u; h < quota; ++h )
+    {
+        const size_t j = h / ARRAY_PACKED_REALS;
+        const size_t idx = h % ARRAY_PACKED_REALS;
+
+        Vector3 position, direction;
+        Vector2 dimensions;
+        Vector4 colour;
+        cpuData.mPosition[j].getAsVector3( position, idx );
+        cpuData.mDirection[j].getAsVector3( direction, idx );
+        cpuData.mDimensions[j].getAsVector2( dimensions, idx );
+        cpuData.mColour[j].getAsVector4( colour, idx );
+
+        float *RESTRICT_ALIAS state = initialState.begin() + h * kStateFloat4PerParticle * 4u;
+        for( size_t k = 0u; k < 3u; ++k )
+        {
+            state[k] = static_cast<float>( position[k] );
+            state[k + 4u] = static_cast<float>( direction[k] );
+        }
+        state[3] = static_cast<float>( timeToLive[h] );
+        state[7] = static_cast<float>( totalTimeToLive[h] );
+        state[8] = static_cast<float>( dimensions.x );
+        state[9] = static_cast<float>( dimensions.y );
+        state[10] = static_cast<float>( rotations[h] );
+        state[11] = static_cast<float>( rotationSpeeds[h] );
+        for( size_t k = 0u; k < 4u; ++k )
+            state[k + 12u] = static_cast<float>( colour[k] );
+    }
+
+    SimulatedDef simulatedDef;
+    simulatedDef.systemDef = systemDef;
+    simulatedDef.stateBuffer = mVaoManager->createUavBuffer(
+        quota * kStateFloat4PerParticle, 4u * sizeof( float ), 0u, initialState.begin(), false );
+    simulatedDef.gpuDataUav =
+        mVaoManager->createUavBuffer( quota, sizeof( ParticleGpuData ), 0u, 0, false );
+    simulatedDef.dstGpuData = mVaoManager->createReadOnlyBuffer(
+        PFG_RGBA32_UINT, sizeof( ParticleGpuData ) * quota, BT_DEFAULT, 0, false );
+    simulatedDef.srcGpuData = systemDef->mGpuData;
+
+    systemDef->mGpuData = simulatedDef.dstGpuData;
+    systemDef->mGpuSimulated = true;
+    systemDef->mGpuSimulationPending = false;
+    systemDef->mGpuSpawns.clear();
+
+    mSystemDefs.push_back( simulatedDef );
+    return true;
+}
+//-----------------------------------------------------------------------------
+void ParticleGpuSimulation::destroy( SimulatedDef &simulatedDef )
+{
+    ParticleSystemDef *systemDef = simulatedDef.systemDef;
+    systemDef->mGpuData = simulatedDef.srcGpuData;
+    systemDef->mGpuSimulated = false;
+    systemDef->mGpuSimulationPending = false;
+    systemDef->mGpuSpawns.clear();
+
+    mVaoManager->destroyReadOnlyBuffer( simulatedDef.dstGpuData );
+    mVaoManager->destroyUavBuffer( simulatedDef.gpuDataUav );
+    mVaoManager->destroyUavBuffer( simulatedDef.stateBuffer );
+}
+//-----------------------------------------------------------------------------
+void ParticleGpuSimulation::removeParticleSystemDef( ParticleSystemDef *systemDef )
+{
+    FastArray<SimulatedDef>::iterator itor = mSystemDefs.begin();
+    FastArray<SimulatedDef>::iterator endt = mSystemDefs.end();
+
+    while( itor != endt && itor->systemDef != systemDef )
+        ++itor;
+
+    if( itor == endt )
+    {
+        OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                     "ParticleSystemDef '" + systemDef->getName() + "' is not being GPU simulated",
+                     "ParticleGpuSimulation::removeParticleSystemDef" );
+    }
+
+    destroy( *itor );
+    efficientVectorRemove( mSystemDefs, itor );
+}
+//-----------------------------------------------------------------------------
+void ParticleGpuSimulation::removeAllParticleSystemDefs()
+{
+    for( SimulatedDef &simulatedDef : mSystemDefs )
+        destroy( simulatedDef );
+    mSystemDefs.clear();
+}
+//-----------------------------------------------------------------------------
+void ParticleGpuSimulation::dispatch( HlmsComputeJob *job, const uint32 jobParams[4],
+                                      const float timeSinceLast, const uint32 numThreads )
+{
+    ShaderParams::Param paramJob;
+    paramJob.name = "jobParams";
+    paramJob.setManualValue( jobParams, 4u );
+    ShaderParams::Param paramTime;
+    paramTime.name = "timeSinceLast";
+    paramTime.setManualValue( timeSinceLast );
+
+    ShaderParams &shaderParams = job->getShaderParams( "default" );
+    shaderParams.mParams.clear();
+    shaderParams.mParams.push_back( paramJob );
+    shaderParams.mParams.push_back( paramTime );
+    shaderParams.setDirty();
+
+    const uint32 threadsPerGroupX = job->getThreadsPerGroupX();
+    job->setNumThreadGroups( ( numThreads + threadsPerGroupX - 1u ) / threadsPerGroupX, 1u, 1u );
+
+    job->analyzeBarriers( mResourceTransitions );
+    mHlmsCompute->getRenderSystem()->executeResourceTransition( mResourceTransitions );
+    mHlmsCompute->dispatch( job, 0, 0 );
+}
+//-----------------------------------------------------------------------------
+void ParticleGpuSimulation::simulate( SimulatedDef &simulatedDef )
+{
+    ParticleSystemDef *systemDef = simulatedDef.systemDef;
+    const uint32 quota = systemDef->getQuota();
+    const float timeSinceLast = systemDef->mParticleSystemManager->getTimeSinceLast();
+
+    DynamicUploadRing *uploadRing = mVaoManager->getDynamicUploadRing( BP_TYPE_READONLY );
+
+    DescriptorSetUav::BufferSlot bufferSlot( DescriptorSetUav::BufferSlot::makeEmpty() );
+    DescriptorSetTexture2::BufferSlot texBufSlot( DescriptorSetTexture2::BufferSlot::makeEmpty() );
+
+    // Scatter the newly emitted particles into their slots
+    const size_t numSpawns = systemDef->mGpuSpawns.size();
+    if( numSpawns > 0u )
+    {
+        const size_t spawnBytes = numSpawns * sizeof( ParticleGpuSpawn );
+        const DynamicUploadRing::Allocation spawns =
+            uploadRing->allocate( spawnBytes, 4u * sizeof( float ) );
+        memcpy( spawns.data, systemDef->mGpuSpawns.begin(), spawnBytes );
+        uploadRing->flush();
+
+        bufferSlot.buffer = simulatedDef.stateBuffer;
+        bufferSlot.access = ResourceAccess::Write;
+        mSpawnJob->_setUavBuffer( 0, bufferSlot );
+
+        OGRE_ASSERT_HIGH( dynamic_cast<ReadOnlyBufferPacked *>( spawns.buffer ) );
+        texBufSlot.buffer = static_cast<ReadOnlyBufferPacked *>( spawns.buffer );
+        texBufSlot.offset = spawns.offset;
+        texBufSlot.sizeBytes = spawnBytes;
+        mSpawnJob->setTexBuffer( 0, texBufSlot );
+
+        const uint32 jobParams[4] = { static_cast<uint32>( numSpawns ), 0u, 0u, quota };
+        dispatch( mSpawnJob, jobParams, timeSinceLast, static_cast<uint32>( numSpawns ) );
+    }
+
+    // Affector settings may change at any time, thus they're uploaded every frame
+    mAffectorParams.clear();
+    for( const ParticleAffector2 *affector : systemDef->getAffectors() )
+    {
+        mAffectorParams.push_back( GpuParticleAffector() );
+        GpuParticleAffector &gpuAffector = mAffectorParams.back();
+        memset( &gpuAffector, 0, sizeof( gpuAffector ) );
+        const bool bSupported = affector->getGpuParams( gpuAffector );
+        OGRE_ASSERT_LOW( bSupported && "Affector added after addParticleSystemDef" );
+        (void)bSupported;
+    }
+
+    // The tex buffer can't be empty
+    const size_t affectorBytes =
+        std::max<size_t>( mAffectorParams.size(), 1u ) * kFloat4PerAffector * 4u * sizeof( float );
+    const DynamicUploadRing::Allocation affectors =
+        uploadRing->allocate( affectorBytes, 4u * sizeof( float ) );
+    {
+        uint32 *RESTRICT_ALIAS dstParams = reinterpret_cast<uint32 *>( affectors.data );
+        for( const GpuParticleAffector &gpuAffector : mAffectorParams )
+        {
+            *dstParams++ = static_cast<uint32>( gpuAffector.type );
+            *dstParams++ = 0u;
+            *dstParams++ = 0u;
+            *dstParams++ = 0u;
+            memcpy( dstParams, gpuAffector.params, sizeof( gpuAffector.params ) );
+            dstParams += GpuParticleAffector::kMaxParams;
+        }
+    }
+    uploadRing->flush();
+
+    bufferSlot.buffer = simulatedDef.stateBuffer;
+    bufferSlot.access = ResourceAccess::ReadWrite;
+    mSimulateJob->_setUavBuffer( 0, bufferSlot );
+    bufferSlot.buffer = simulatedDef.gpuDataUav;
+    bufferSlot.access = ResourceAccess::Write;
+    mSimulateJob->_setUavBuffer( 1, bufferSlot );
+
+    OGRE_ASSERT_HIGH( dynamic_cast<ReadOnlyBufferPacked *>( affectors.buffer ) );
+    texBufSlot.buffer = static_cast<ReadOnlyBufferPacked *>( affectors.buffer );
+    texBufSlot.offset = affectors.offset;
+    texBufSlot.sizeBytes = affectorBytes;
+    mSimulateJob->setTexBuffer( 0, texBufSlot );
+
+    const uint32 jobParams[4] = { quota, systemDef->mGpuFirstParticleSlot,
+                                  static_cast<uint32>( mAffectorParams.size() ), quota };
+    dispatch( mSimulateJob, jobParams, timeSinceLast, quota );
+
+    // Compute shaders can't write to ReadOnlyBufferPacked
+    simulatedDef.gpuDataUav->copyTo( simulatedDef.dstGpuData );
+
+    systemDef->mGpuSimulationPending = false;
+}
+//-----------------------------------------------------------------------------
+void ParticleGpuSimulation::update()
+{
+    bool bAnyPending = false;
+    for( const SimulatedDef &simulatedDef : mSystemDefs )
+        bAnyPending |= simulatedDef.systemDef->mGpuSimulationPending;
+
+    if( !bAnyPending )
+        return;
+
+    if( !mSpawnJob )
+    {
+        mSpawnJob =
+            mHlmsCompute->findComputeJobNoThrow( "Compute/Algorithms/ParticleGpuSimulation/Spawn" );
+        mSimulateJob =
+            mHlmsCompute->findComputeJobNoThrow( "Compute/Algorithms/ParticleGpuSimulation/Simulate" );
+
+        if( !mSpawnJob || !mSimulateJob )
+        {
+            mSpawnJob = 0;
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "To use ParticleGpuSimulation, Ogre must be built with JSON support "
+                         "and you must include the resources bundled at "
+                         "Samples/Media/Compute/Algorithms/ParticleGpuSimulation",
+                         "ParticleGpuSimulation::update" );
+        }
+    }
+
+    OgreProfileGpuBegin( "ParticleGpuSimulation" );
+
+    RenderSystem *renderSystem = mHlmsCompute->getRenderSystem();
+    renderSystem->endRenderPassDescriptor();
+
+    for( SimulatedDef &simulatedDef : mSystemDefs )
+    {
+        if( simulatedDef.systemDef->mGpuSimulationPending )
+            simulate( simulatedDef );
+    }
+
+    OgreProfileGpuEnd( "ParticleGpuSimulation" );
+}
+//-----------------------------------------------------------------------------
+void ParticleGpuSimulation::allWorkspacesBeforeBeginUpdate() { update(); }
@@ -40,6 +40,7 @@ THE SOFTWARE.
 #include "ParticleSystem/OgreParticleAffector2.h"
 #include "ParticleSystem/OgreParticleSystemManager2.h"
 #include "Vao/OgreConstBufferPacked.h"
+#include "Vao/OgreIndexBufferPacked.h"
 #include "Vao/OgreReadOnlyBufferPacked.h"
 #include "Vao/OgreVaoManager.h"
 
@@ -78,6 +79,8 @@ ParticleSystemDef::ParticleSystemDef( IdType id, ObjectMemoryManager *objectMemo
     mParticleSystemManager( particleSystemManager ),
     mGpuCommonData( 0 ),
     mGpuData( 0 ),
+    mGpuDataOffset( 0u ),
+    mGpuDataSizeBytes( 0u ),
     mCommonDirection( Ogre::Vector3::UNIT_Z ),
     mCommonUpVector( Vector3::UNIT_Y ),
     mParticleGpuData( 0 ),
@@ -86,7 +89,18 @@ ParticleSystemDef::ParticleSystemDef( IdType id, ObjectMemoryManager *objectMemo
     mParticleQuotaFull( false ),
     mIsBillboardSet( bIsBillboardSet ),
     mRotationType( ParticleRotationType::None ),
-    mParticleType( ParticleType::Point )
+    mParticleType( ParticleType::Point ),
+    mGpuSimulated( false ),
+    mGpuSimulationPending( false ),
+    mGpuFirstParticleSlot( 0u ),
+    mSortDepths( 0 ),
+    mRadixSorter( 0 ),
+    mSortedIndexBuffer( 0 ),
+    mSortedIndices( 0 ),
+    mInvisibleTickInterval( 1u ),
+    mSkippedFrames( 0u ),
+    mTimeSinceLast( 0 ),
+    mEmissionLodDistance( 0 )
 {
     memset( &mParticleCpuData, 0, sizeof( mParticleCpuData ) );
     if( manager )
@@ -236,12 +250,34 @@ void ParticleSystemDef::init( VaoManager *vaoManager )
     mGpuCommonData =
         vaoManager->createConstBuffer( sizeof( GpuParticleCommon ), BT_DEFAULT, &particleCommon, false );
 
-    mGpuData = vaoManager->createReadOnlyBuffer(
-        PFG_RGBA32_UINT, sizeof( ParticleGpuData ) * numParticles, BT_DYNAMIC_PERSISTENT, 0, false );
+    // BillboardSets get mGpuData every frame. See ParticleSystemManager2::updateSerialPre
+    if( !mIsBillboardSet )
+    {
+        mGpuData = vaoManager->createReadOnlyBuffer( PFG_RGBA32_UINT,
+                                                     sizeof( ParticleGpuData ) * numParticles,
+                                                     BT_DYNAMIC_PERSISTENT, 0, false );
+        mGpuDataOffset = 0u;
+        mGpuDataSizeBytes = mGpuData->getTotalSizeBytes();
+    }
+
+    IndexBufferPacked *indexBuffer = 0;
+    if( mSorted && !mIsBillboardSet )
+    {
+        // The draw order changes every frame, thus we can't use the shared index buffer.
+        mSortedIndexBuffer = vaoManager->createIndexBuffer(
+            numParticles * 4u <= std::numeric_limits<uint16>::max() + 1u ? IT_16BIT : IT_32BIT,
+            numParticles * 6u, BT_DYNAMIC_PERSISTENT, 0, false );
+        mSortDepths = reinterpret_cast<float *>(
+            OGRE_MALLOC_SIMD( numParticles * sizeof( float ), MEMCATEGORY_GEOMETRY ) );
+        mSortedParticles.reserve( numParticles );
+        mRadixSorter = new ParticleRadixSort();
+        indexBuffer = mSortedIndexBuffer;
+    }
+    else
+        indexBuffer = mParticleSystemManager->_getSharedIndexBuffer( numParticles, vaoManager );
 
-    mVaoPerLod[VpNormal].push_back( vaoManager->createVertexArrayObject(
-        {}, mParticleSystemManager->_getSharedIndexBuffer( numParticles, vaoManager ),
-        OT_TRIANGLE_LIST ) );
+    mVaoPerLod[VpNormal].push_back(
+        vaoManager->createVertexArrayObject( {}, indexBuffer, OT_TRIANGLE_LIST ) );
     mVaoPerLod[VpShadow] = mVaoPerLod[VpNormal];
 
     HlmsManager *hlmsManager = Root::getSingleton().getHlmsManager();
@@ -278,16 +314,49 @@ void ParticleSystemDef::_destroy( VaoManager *vaoManager )
 
         mParticleCpuData.mPosition = 0;
 
-        if( mGpuData->getMappingState() != MS_UNMAPPED )
+        if( mIsBillboardSet )
+        {
+            // Owned by VaoManager's DynamicUploadRing
+            mGpuData = 0;
+            mParticleGpuData = 0;
+        }
+        else if( mGpuData->getMappingState() != MS_UNMAPPED )
         {
             mGpuData->unmap( UO_UNMAP_ALL );
             mParticleGpuData = 0;
         }
 
+        if( mSortedIndexBuffer )
+        {
+            OGRE_FREE_SIMD( mSortDepths, MEMCATEGORY_GEOMETRY );
+            mSortDepths = 0;
+            delete mRadixSorter;
+            mRadixSorter = 0;
+            mSortedParticles.clear();
+
+            if( mSortedIndexBuffer->getMappingState() != MS_UNMAPPED )
+            {
+                mSortedIndexBuffer->unmap( UO_UNMAP_ALL );
+                mSortedIndices = 0;
+            }
+
+            if( vaoManager )
+            {
+                vaoManager->destroyVertexArrayObject( mVaoPerLod[VpNormal].back() );
+                mVaoPerLod[VpNormal].clear();
+                mVaoPerLod[VpShadow].clear();
+                vaoManager->destroyIndexBuffer( mSortedIndexBuffer );
+                mSortedIndexBuffer = 0;
+            }
+        }
+
         if( vaoManager )
         {
-            vaoManager->destroyReadOnlyBuffer( mGpuData );
-            mGpuData = 0;
+            if( mGpuData )
+            {
+                vaoManager->destroyReadOnlyBuffer( mGpuData );
+                mGpuData = 0;
+            }
 
             vaoManager->destroyConstBuffer( mGpuCommonData );
             mGpuCommonData = 0;
@@ -337,6 +406,16 @@ ParticleRotationType::ParticleRotationType ParticleSystemDef::getRotationType()
     return mRotationType;
 }
 //-----------------------------------------------------------------------------
+void ParticleSystemDef::setInvisibleTickInterval( uint32 numFrames )
+{
+    mInvisibleTickInterval = std::max( numFrames, 1u );
+}
+//-----------------------------------------------------------------------------
+void ParticleSystemDef::setEmissionLodDistance( Real lodDistance )
+{
+    mEmissionLodDistance = std::max( lodDistance, Real( 0 ) );
+}
+//-----------------------------------------------------------------------------
 void ParticleSystemDef::setCommonVectors( const Vector3 &commonDir, const Vector3 &commonUp )
 {
     mCommonDirection = commonDir;
@@ -420,6 +499,8 @@ ParticleSystem2 *ParticleSystemDef::_createParticleSystem( ObjectMemoryManager *
 
     ParticleSystem2 *retVal =
         new ParticleSystem2( Id::generateNewId<MovableObject>(), objectMemoryManager, mManager, this );
+    // Newly created instances are assumed visible until proven otherwise.
+    retVal->mLastVisibleFrame = mParticleSystemManager->getCurrentFrame();
     retVal->mParentDefGlobalIdx = mParticleSystems.size();
     mParticleSystems.push_back( retVal );
     mActiveParticleSystems.push_back( retVal );
@@ -501,6 +582,7 @@ uint32 ParticleSystemDef::allocParticle()
                 return InvalidHandle;
             }
 
+            mActiveParticles.set( newIdx );
             return static_cast<uint32>( newIdx );
         }
         else
@@ -527,6 +609,7 @@ uint32 ParticleSystemDef::allocParticle()
                 }
             }
 
+            mActiveParticles.set( newIdx );
             return static_cast<uint32>( newIdx );
         }
     }
@@ -547,6 +630,41 @@ uint32 ParticleSystemDef::allocParticle()
     }
 }
 //-----------------------------------------------------------------------------
+uint32 ParticleSystemDef::allocParticleRange( uint32 numParticles, uint32 &outFirstHandle )
+{
+    OGRE_ASSERT_MEDIUM( mLastParticleIdx >= mFirstParticleIdx );
+
+    if( numParticles == 0u )
+        return 0u;
+
+    const uint32 quota = getQuota();
+    const uint32 distance = mLastParticleIdx - mFirstParticleIdx;
+
+    if( distance == quota )
+    {
+        // Hard case. Free slots are scattered, get them one by one.
+        outFirstHandle = allocParticle();
+        return outFirstHandle != InvalidHandle ? 1u : 0u;
+    }
+
+    // Easy case. Everything in [mLastParticleIdx; mFirstParticleIdx + quota) is free, but we
+    // can't go past the end of the pool (the next call will continue from the start).
+    const uint32 newIdx = mLastParticleIdx % quota;
+    const uint32 numAllocated = std::min( std::min( numParticles, quota - distance ), quota - newIdx );
+
+    for( uint32 i = 0u; i < numAllocated; ++i )
+    {
+        OGRE_ASSERT_MEDIUM( !mActiveParticles.test( newIdx + i ) );
+        mActiveParticles.set( newIdx + i );
+    }
+    mLastParticleIdx += numAllocated;
+
+    OGRE_ASSERT_MEDIUM( mLastParticleIdx < quota * 2u );
+
+    outFirstHandle = newIdx;
+    return numAllocated;
+}
+//-----------------------------------------------------------------------------
 void ParticleSystemDef::deallocParticle( uint32 handle )
 {
     const uint32 quota = getQuota();
@@ -637,6 +755,51 @@ void ParticleSystemDef::sortByDistanceTo( const Vector3 camPos )
                             SortParticlesByDistanceToCamera( camPos ) );
 }
 //-----------------------------------------------------------------------------
+void ParticleSystemDef::fillGpuSpawns( const size_t firstNewParticle, const size_t numParticles )
+{
+    OGRE_ASSERT_LOW( !mIsBillboardSet );
+
+    const Real *RESTRICT_ALIAS rotations = reinterpret_cast<const Real *>( mParticleCpuData.mRotation );
+    const Real *RESTRICT_ALIAS rotationSpeeds =
+        reinterpret_cast<const Real *>( mParticleCpuData.mRotationSpeed );
+    const Real *RESTRICT_ALIAS timeToLive =
+        reinterpret_cast<const Real *>( mParticleCpuData.mTimeToLive );
+    const Real *RESTRICT_ALIAS totalTimeToLive =
+        reinterpret_cast<const Real *>( mParticleCpuData.mTotalTimeToLive );
+
+    for( size_t i = firstNewParticle; i < firstNewParticle + numParticles; ++i )
+    {
+        const uint32 h = mNewParticles[i].handle;
+        const size_t j = h / ARRAY_PACKED_REALS;
+        const size_t idx = h % ARRAY_PACKED_REALS;
+
+        Vector3 position, direction;
+        Vector2 dimensions;
+        Vector4 colour;
+        mParticleCpuData.mPosition[j].getAsVector3( position, idx );
+        mParticleCpuData.mDirection[j].getAsVector3( direction, idx );
+        mParticleCpuData.mDimensions[j].getAsVector2( dimensions, idx );
+        mParticleCpuData.mColour[j].getAsVector4( colour, idx );
+
+        ParticleGpuSpawn &spawn = mGpuSpawns[i];
+        spawn.mHandle = h;
+        spawn.mPadding[0] = spawn.mPadding[1] = spawn.mPadding[2] = 0u;
+        for( size_t k = 0u; k < 3u; ++k )
+        {
+            spawn.mPosition[k] = static_cast<float>( position[k] );
+            spawn.mDirection[k] = static_cast<float>( direction[k] );
+        }
+        spawn.mTimeToLive = static_cast<float>( timeToLive[h] );
+        spawn.mTotalTimeToLive = static_cast<float>( totalTimeToLive[h] );
+        spawn.mDimensions[0] = static_cast<float>( dimensions.x );
+        spawn.mDimensions[1] = static_cast<float>( dimensions.y );
+        spawn.mRotation = static_cast<float>( rotations[h] );
+        spawn.mRotationSpeed = static_cast<float>( rotationSpeeds[h] );
+        for( size_t k = 0u; k < 4u; ++k )
+            spawn.mColour[k] = static_cast<float>( colour[k] );
+    }
+}
+//-----------------------------------------------------------------------------
 void ParticleSystemDef::cloneTo( ParticleSystemDef *toClone )
 {
     toClone->ParticleSystem::_cloneFrom( this );
@@ -645,6 +808,8 @@ void ParticleSystemDef::cloneTo( ParticleSystemDef *toClone )
     toClone->mCommonUpVector = this->mCommonUpVector;
     toClone->mRotationType = this->mRotationType;
     toClone->mParticleType = this->mParticleType;
+    toClone->mInvisibleTickInterval = this->mInvisibleTickInterval;
+    toClone->mEmissionLodDistance = this->mEmissionLodDistance;
     toClone->setParticleQuota( this->getQuota() );
 
     toClone->mEmitters.reserve( this->mEmitters.size() );
@@ -708,6 +873,9 @@ ParticleSystem2::ParticleSystem2( IdType id, ObjectMemoryManager *objectMemoryMa
                                   SceneManager *manager, const ParticleSystemDef *creator ) :
     MovableObject( id, objectMemoryManager, manager, 110u ),
     mCreator( creator ),
+    mLastVisibleFrame( 0u ),
+    mSkippedFrames( 0u ),
+    mTimeSinceLast( 0 ),
     mParentDefGlobalIdx( std::numeric_limits<size_t>::max() )
 {
     const size_t numEmitters = creator->getNumEmitters();
@@ -32,6 +32,7 @@ THE SOFTWARE.
 
 #include "Math/Array/OgreArrayConfig.h"
 #include "Math/Array/OgreBooleanMask.h"
+#include "OgreCamera.h"
 #include "OgreRenderQueue.h"
 #include "OgreSceneManager.h"
 #include "ParticleSystem/OgreBillboardSet2.h"
@@ -39,6 +40,7 @@ THE SOFTWARE.
 #include "ParticleSystem/OgreParticle2.h"
 #include "ParticleSystem/OgreParticleAffector2.h"
 #include "ParticleSystem/OgreParticleSystem2.h"
+#include "Vao/OgreDynamicUploadRing.h"
 #include "Vao/OgreIndexBufferPacked.h"
 #include "Vao/OgreReadOnlyBufferPacked.h"
 #include "Vao/OgreVaoManager.h"
@@ -57,7 +59,9 @@ ParticleSystemManager2::ParticleSystemManager2( SceneManager *sceneManager,
     mHighestPossibleQuota16( 0u ),
     mHighestPossibleQuota32( 0u ),
     mTimeSinceLast( 0 ),
+    mCurrentFrame( 0u ),
     mMaster( master ),
+    mCullCamera( 0 ),
     mCameraPos( Vector3::ZERO )
 {
     if( sceneManager )
@@ -203,8 +207,119 @@ void ParticleSystemManager2::tickParticles( const size_t threadIdx, const ArrayR
     inOutAabb = aabb;
 }
 //-----------------------------------------------------------------------------
-void ParticleSystemManager2::sortAndPrepare( ParticleSystemDef *systemDef, const Vector3 &camPos,
-                                             const float timeSinceLast )
+void ParticleSystemManager2::tickTimeToLive( const size_t threadIdx, const ArrayReal timeSinceLast,
+                                             ParticleCpuData cpuData, const size_t numParticles,
+                                             ParticleSystemDef *systemDef )
+{
+    for( size_t i = 0u; i < numParticles; i += ARRAY_PACKED_REALS )
+    {
+        const ArrayMaskR wasDead = Mathlib::CompareLessEqual( *cpuData.mTimeToLive, ARRAY_REAL_ZERO );
+        *cpuData.mTimeToLive = Mathlib::Max( *cpuData.mTimeToLive - timeSinceLast, ARRAY_REAL_ZERO );
+        const ArrayMaskR isDead = Mathlib::CompareLessEqual( *cpuData.mTimeToLive, ARRAY_REAL_ZERO );
+
+        const uint32 scalarJustDied =
+            BooleanMask4::getScalarMask( isDead ) & ~BooleanMask4::getScalarMask( wasDead );
+
+        for( size_t j = 0; j < ARRAY_PACKED_REALS; ++j )
+        {
+            if( IS_BIT_SET( j, scalarJustDied ) )
+                systemDef->mParticlesToKill[threadIdx].push_back( systemDef->getHandle( cpuData, j ) );
+        }
+
+        cpuData.advancePack();
+    }
+}
+//-----------------------------------------------------------------------------
+void ParticleSystemManager2::calculateSortDepths( ParticleCpuData cpuData, float *outDepths,
+                                                  const size_t numParticles,
+                                                  const ArrayVector3 &camPos )
+{
+    const ArrayReal deadDepth = Mathlib::SetAll( -1.0f );
+
+    ArrayReal *RESTRICT_ALIAS depths = reinterpret_cast<ArrayReal *>( outDepths );
+    for( size_t i = 0u; i < numParticles; i += ARRAY_PACKED_REALS )
+    {
+        const ArrayMaskR isDead = Mathlib::CompareLessEqual( *cpuData.mTimeToLive, ARRAY_REAL_ZERO );
+        *depths = Mathlib::CmovRobust( deadDepth, cpuData.mPosition->distance( camPos ), isDead );
+        ++depths;
+        cpuData.advancePack();
+    }
+}
+//-----------------------------------------------------------------------------
+struct QuantizedDepthFunctor
+{
+    const float *RESTRICT_ALIAS depths;
+    float                       maxDepth;
+    float                       depthToKey;
+
+    // Farthest particles get the lowest keys so they're drawn first.
+    uint16 operator()( const uint32 idx ) const
+    {
+        return static_cast<uint16>( ( maxDepth - depths[idx] ) * depthToKey );
+    }
+};
+//-----------------------------------------------------------------------------
+void ParticleSystemManager2::sortParticles( ParticleSystemDef *systemDef )
+{
+    // Only [0; getParticlesToRenderTighter()) is rendered. See sortAndPrepare().
+    const size_t numParticles = systemDef->getParticlesToRenderTighter();
+    const float *RESTRICT_ALIAS depths = systemDef->mSortDepths;
+
+    std::vector<uint32> &sortedParticles = systemDef->mSortedParticles;
+    sortedParticles.clear();
+
+    float maxDepth = 0.0f;
+    for( size_t i = 0u; i < numParticles; ++i )
+    {
+        if( depths[i] >= 0.0f )
+        {
+            sortedParticles.push_back( static_cast<uint32>( i ) );
+            maxDepth = std::max( maxDepth, depths[i] );
+        }
+    }
+
+    // Quantize the depth to 16 bits so that the radix sort only needs 2 passes.
+    const QuantizedDepthFunctor functor = { depths, maxDepth,
+                                            maxDepth > 0.0f ? 65535.0f / maxDepth : 0.0f };
+    systemDef->mRadixSorter->sort( sortedParticles, functor );
+
+    const size_t numSortedParticles = sortedParticles.size();
+    if( systemDef->mSortedIndexBuffer->getIndexType() == IT_16BIT )
+    {
+        uint16 *RESTRICT_ALIAS indices = reinterpret_cast<uint16 *>( systemDef->mSortedIndices );
+        for( size_t i = 0u; i < numSortedParticles; ++i )
+        {
+            // Same vertex order as the shared index buffers. See createSharedIndexBuffers().
+            const uint16 k = static_cast<uint16>( sortedParticles[i] * 4u );
+            indices[i * 6u + 0u] = static_cast<uint16>( k + 0u );
+            indices[i * 6u + 1u] = static_cast<uint16>( k + 1u );
+            indices[i * 6u + 2u] = static_cast<uint16>( k + 2u );
+            indices[i * 6u + 3u] = static_cast<uint16>( k + 1u );
+            indices[i * 6u + 4u] = static_cast<uint16>( k + 3u );
+            indices[i * 6u + 5u] = static_cast<uint16>( k + 2u );
+        }
+    }
+    else
+    {
+        uint32 *RESTRICT_ALIAS indices = reinterpret_cast<uint32 *>( systemDef->mSortedIndices );
+        for( size_t i = 0u; i < numSortedParticles; ++i )
+        {
+            const uint32 k = sortedParticles[i] * 4u;
+            indices[i * 6u + 0u] = k + 0u;
+            indices[i * 6u + 1u] = k + 1u;
+            indices[i * 6u + 2u] = k + 2u;
+            indices[i * 6u + 3u] = k + 1u;
+            indices[i * 6u + 4u] = k + 3u;
+            indices[i * 6u + 5u] = k + 2u;
+        }
+    }
+
+    // Dead particles were left out, thus we may render less than what sortAndPrepare() asked.
+    systemDef->mVaoPerLod[0].back()->setPrimitiveRange(
+        0u, static_cast<uint32>( numSortedParticles * 6u ) );
+}
+//-----------------------------------------------------------------------------
+void ParticleSystemManager2::sortAndPrepare( ParticleSystemDef *systemDef, const Vector3 &camPos )
 {
     systemDef->sortByDistanceTo( camPos );
 
@@ -212,51 +327,86 @@ void ParticleSystemManager2::sortAndPrepare( ParticleSystemDef *systemDef, const
     const size_t numEmitters = systemDef->mEmitters.size();
     systemDef->mNewParticles.clear();
 
+    const float timeSinceLast = systemDef->mTimeSinceLast;
+    const Real emissionLodDistance = systemDef->mEmissionLodDistance;
+    // If no instance was visible we're already catching up (see prepareForUpdate), thus
+    // instances must emit all they skipped.
+    const bool bThrottleInstances = systemDef->mInvisibleTickInterval > 1u &&
+                                    systemDef->mLastVisibleFrame + 1u >= mCurrentFrame;
+
     for( ParticleSystem2 *system : systemDef->mActiveParticleSystems )
     {
+        const Node *instanceNode = system->getParentNode();
+        const Vector3 instancePos = instanceNode->_getDerivedPosition();
+        const Quaternion instanceRot = instanceNode->_getDerivedOrientation();
+
+        system->mTimeSinceLast += timeSinceLast;
+
+        // Instances that weren't visible emit less often, but with all the time they skipped.
+        if( bThrottleInstances && system->mLastVisibleFrame + 1u < mCurrentFrame &&
+            ++system->mSkippedFrames < systemDef->mInvisibleTickInterval )
+        {
+            for( size_t i = 0u; i < numEmitters; ++i )
+                system->mNewParticlesPerEmitter[i] = 0u;
+            continue;
+        }
+
+        const float emissionTime = system->mTimeSinceLast;
+        system->mTimeSinceLast = 0.0f;
+        system->mSkippedFrames = 0u;
+
+        Real emissionRateScale = 1.0f;
+        if( emissionLodDistance > Real( 0 ) )
+        {
+            const Real distance = instancePos.distance( camPos );
+            if( distance > emissionLodDistance )
+                emissionRateScale = emissionLodDistance / distance;
+        }
+
         for( size_t i = 0u; i < numEmitters; ++i )
         {
             const uint32 numRequestedParticles = systemDef->mEmitters[i]->genEmissionCount(
-                timeSinceLast, system->mEmitterInstanceData[i] );
-            system->mNewParticlesPerEmitter[i] = numRequestedParticles;
-
-            const Node *instanceNode = system->getParentNode();
-            const Vector3 instancePos = instanceNode->_getDerivedPosition();
-            const Quaternion instanceRot = instanceNode->_getDerivedOrientation();
+                emissionTime, system->mEmitterInstanceData[i], emissionRateScale );
 
-            for( uint32 j = 0u; j < numRequestedParticles; ++j )
+            // Allocate in ranges, so that bursts end up contiguous in memory and
+            // EmitterDefData::initEmittedParticles can write whole SIMD packs.
+            uint32 numEmitted = 0u;
+            while( numEmitted < numRequestedParticles )
             {
-                const uint32 handle = systemDef->allocParticle();
-                if( handle != ParticleSystemDef::InvalidHandle )
-                {
-                    systemDef->mNewParticles.push_back( { handle, instancePos, instanceRot } );
-                }
-                else
+                uint32 firstHandle;
+                const uint32 numAllocated = systemDef->allocParticleRange(
+                    numRequestedParticles - numEmitted, firstHandle );
+                if( numAllocated == 0u )
                 {
                     // The pool run out of particles.
                     // It won't be handling more while in _prepareParallel()
-                    system->mNewParticlesPerEmitter[i] = j;
                     break;
                 }
+
+                for( uint32 j = 0u; j < numAllocated; ++j )
+                {
+                    systemDef->mNewParticles.push_back(
+                        { firstHandle + j, instancePos, instanceRot } );
+                }
+                numEmitted += numAllocated;
             }
+            system->mNewParticlesPerEmitter[i] = numEmitted;
         }
-
-        systemDef->mVaoPerLod[0].back()->setPrimitiveRange(
-            0u, static_cast<uint32>( systemDef->getParticlesToRenderTighter() * 6u ) );
     }
+
+    systemDef->mVaoPerLod[0].back()->setPrimitiveRange(
+        0u, static_cast<uint32>( systemDef->getParticlesToRenderTighter() * 6u ) );
+
+    if( systemDef->mGpuSimulated )
+        systemDef->mGpuSpawns.resizePOD( systemDef->mNewParticles.size() );
 }
 //-----------------------------------------------------------------------------
 void ParticleSystemManager2::updateSerialPos()
 {
     for( BillboardSet *billboardSet : mBillboardSets )
     {
-        if( billboardSet->mParticleGpuData )
-        {
-            const size_t numParticlesToFlush = billboardSet->getNumSimdActiveParticles();
-            billboardSet->mGpuData->unmap( UO_KEEP_PERSISTENT, 0u,
-                                           sizeof( ParticleGpuData ) * numParticlesToFlush );
-            billboardSet->mParticleGpuData = 0;
-        }
+        // The DynamicUploadRing flushes mGpuData before rendering
+        billboardSet->mParticleGpuData = 0;
 
         Aabb aabb = Aabb::BOX_NULL;
         for( const Aabb &threadAabb : billboardSet->mAabb )
@@ -273,8 +423,10 @@ void ParticleSystemManager2::updateSerialPos()
         *billboardSet->_getObjectData().mWorldAabb = *billboardSet->_getObjectData().mLocalAabb;
     }
 
-    for( ParticleSystemDef *systemDef : mActiveParticleSystemDefs )
+    for( ParticleSystemDef *systemDef : mParticleSystemDefsToUpdate )
     {
+        systemDef->mTimeSinceLast = 0.0f;
+
         // Do this now, because getNumSimdActiveParticles() is about to change.
         if( systemDef->mParticleGpuData )
         {
@@ -284,6 +436,22 @@ void ParticleSystemManager2::updateSerialPos()
             systemDef->mParticleGpuData = 0;
         }
 
+        if( systemDef->mSortedIndices )
+        {
+            systemDef->mSortedIndexBuffer->unmap( UO_KEEP_PERSISTENT, 0u,
+                                                  systemDef->mSortedParticles.size() * 6u );
+            systemDef->mSortedIndices = 0;
+        }
+
+        if( systemDef->mGpuSimulated )
+        {
+            // Same reason. ParticleGpuSimulation must write mGpuData in the same order
+            // tickParticles() would have, which is what the VAO's primitive range expects.
+            systemDef->mGpuFirstParticleSlot =
+                static_cast<uint32>( systemDef->getActiveParticlesPackOffset() * ARRAY_PACKED_REALS );
+            systemDef->mGpuSimulationPending = true;
+        }
+
         for( FastArray<uint32> &threadParticlesToKill : systemDef->mParticlesToKill )
         {
             for( const uint32 handle : threadParticlesToKill )
@@ -309,13 +477,12 @@ void ParticleSystemManager2::updateSerialPos()
 //-----------------------------------------------------------------------------
 void ParticleSystemManager2::_prepareParallel()
 {
-    if( mActiveParticleSystemDefs.empty() )
+    if( mParticleSystemDefsToUpdate.empty() )
         return;
 
     ParticleSystemDef *systemDef = 0;
 
     const Vector3 camPos = mCameraPos;
-    const float timeSinceLast = mTimeSinceLast;
 
     bool bStillHasWork = true;
     while( bStillHasWork )
@@ -332,13 +499,13 @@ void ParticleSystemManager2::_prepareParallel()
         mSortMutex.unlock();
 
         if( bStillHasWork )
-            sortAndPrepare( systemDef, camPos, timeSinceLast );
+            sortAndPrepare( systemDef, camPos );
     }
 }
 //-----------------------------------------------------------------------------
 void ParticleSystemManager2::_updateParallel01( const size_t threadIdx, const size_t numThreads )
 {
-    for( ParticleSystemDef *systemDef : mActiveParticleSystemDefs )
+    for( ParticleSystemDef *systemDef : mParticleSystemDefsToUpdate )
     {
         const size_t numEmitters = systemDef->mEmitters.size();
 
@@ -353,13 +520,26 @@ void ParticleSystemManager2::_updateParallel01( const size_t threadIdx, const si
             {
                 const size_t newParticlesPerEmitter = system->mNewParticlesPerEmitter[i];
 
-                const size_t particlesPerThread =
-                    ( newParticlesPerEmitter + numThreads - 1u ) / numThreads;
+                // Split at handles multiple of ARRAY_PACKED_REALS so that contiguous ranges
+                // are written in whole packs. Thread 0 also takes the unaligned head.
+                const size_t firstHandle =
+                    newParticlesPerEmitter ? systemDef->mNewParticles[currOffset].handle : 0u;
+                const size_t unalignedHead = std::min(
+                    ( ARRAY_PACKED_REALS - firstHandle % ARRAY_PACKED_REALS ) % ARRAY_PACKED_REALS,
+                    newParticlesPerEmitter );
+                const size_t particlesPerThread = alignToNextMultiple<size_t>(
+                    ( newParticlesPerEmitter - unalignedHead + numThreads - 1u ) / numThreads,
+                    ARRAY_PACKED_REALS );
 
                 const size_t toAdvance =
-                    std::min( threadIdx * particlesPerThread, newParticlesPerEmitter );
+                    threadIdx == 0u
+                        ? 0u
+                        : std::min( unalignedHead + threadIdx * particlesPerThread,
+                                    newParticlesPerEmitter );
                 const size_t numParticlesToProcess =
-                    std::min( particlesPerThread, newParticlesPerEmitter - toAdvance );
+                    std::min( unalignedHead + ( threadIdx + 1u ) * particlesPerThread,
+                              newParticlesPerEmitter ) -
+                    toAdvance;
 
                 systemDef->mEmitters[i]->initEmittedParticles(
                     cpuData, systemDef->mNewParticles.begin() + currOffset + toAdvance,
@@ -372,6 +552,9 @@ void ParticleSystemManager2::_updateParallel01( const size_t threadIdx, const si
                         numParticlesToProcess );
                 }
 
+                if( systemDef->mGpuSimulated )
+                    systemDef->fillGpuSpawns( currOffset + toAdvance, numParticlesToProcess );
+
                 // We've processed numParticlesToProcess but we need to skip newParticlesPerEmitter
                 // because the gap "newParticlesPerEmitter - numParticlesToProcess" is being
                 // processed by other threads.
@@ -386,10 +569,13 @@ void ParticleSystemManager2::_updateParallel01( const size_t threadIdx, const si
 //-----------------------------------------------------------------------------
 void ParticleSystemManager2::_updateParallel02( const size_t threadIdx, const size_t numThreads )
 {
-    const ArrayReal timeSinceLast = Mathlib::SetAll( mTimeSinceLast );
+    ArrayVector3 camPos;
+    camPos.setAll( mCameraPos );
 
-    for( ParticleSystemDef *systemDef : mActiveParticleSystemDefs )
+    for( ParticleSystemDef *systemDef : mParticleSystemDefsToUpdate )
     {
+        const ArrayReal timeSinceLast = Mathlib::SetAll( systemDef->mTimeSinceLast );
+
         // We split particle systems.
         ParticleCpuData cpuData = systemDef->getParticleCpuData();
 
@@ -460,13 +646,27 @@ void ParticleSystemManager2::_updateParallel02( const size_t threadIdx, const si
             OGRE_ASSERT_MEDIUM( threadAdvance <= quota || numParticlesToProcess == 0u );
             cpuData.advancePack( threadAdvance / ARRAY_PACKED_REALS );
 
-            ParticleGpuData *gpuData = systemDef->mParticleGpuData + gpuAdvance;
+            if( systemDef->mGpuSimulated )
+            {
+                // ParticleGpuSimulation does the rest. The AABB stays null (i.e. infinite).
+                tickTimeToLive( threadIdx, timeSinceLast, cpuData, numParticlesToProcess, systemDef );
+            }
+            else
+            {
+                ParticleGpuData *gpuData = systemDef->mParticleGpuData + gpuAdvance;
 
-            for( const ParticleAffector2 *affector : systemDef->mAffectors )
-                affector->run( cpuData, numParticlesToProcess, timeSinceLast );
+                for( const ParticleAffector2 *affector : systemDef->mAffectors )
+                    affector->run( cpuData, numParticlesToProcess, timeSinceLast );
 
-            tickParticles( threadIdx, timeSinceLast, cpuData, gpuData, numParticlesToProcess, systemDef,
-                           aabb );
+                tickParticles( threadIdx, timeSinceLast, cpuData, gpuData, numParticlesToProcess,
+                               systemDef, aabb );
+
+                if( systemDef->mSortDepths )
+                {
+                    calculateSortDepths( cpuData, systemDef->mSortDepths + gpuAdvance,
+                                         numParticlesToProcess, camPos );
+                }
+            }
 
             gpuAdvance += numParticlesToProcess;
             totalThreadNumParticlesToProcess = particleExcess;
@@ -565,6 +765,17 @@ void ParticleSystemManager2::_updateParallel02( const size_t threadIdx, const si
     }
 }
 //-----------------------------------------------------------------------------
+void ParticleSystemManager2::_updateParallel03( const size_t threadIdx, const size_t numThreads )
+{
+    const size_t numSystemDefs = mDepthSortedSystemDefs.size();
+    const size_t systemDefsPerThread = ( numSystemDefs + numThreads - 1u ) / numThreads;
+    const size_t toAdvance = std::min( threadIdx * systemDefsPerThread, numSystemDefs );
+    const size_t numSystemDefsToProcess = std::min( systemDefsPerThread, numSystemDefs - toAdvance );
+
+    for( size_t i = toAdvance; i < toAdvance + numSystemDefsToProcess; ++i )
+        sortParticles( mDepthSortedSystemDefs[i] );
+}
+//-----------------------------------------------------------------------------
 void ParticleSystemManager2::addEmitterFactory( ParticleEmitterDefDataFactory *factory )
 {
     const auto insertionResult = sEmitterDefFactories.insert( { factory->getName(), factory } );
@@ -741,6 +952,48 @@ void ParticleSystemManager2::destroyAllBillboardSets()
     mBillboardSets.clear();
 }
 //-----------------------------------------------------------------------------
+bool ParticleSystemManager2::cullParticleSystems( ParticleSystemDef *systemDef,
+                                                  const Plane       *frustumPlanes,
+                                                  const bool         bInfiniteFarPlane )
+{
+    bool bAnyVisible = false;
+    for( ParticleSystem2 *system : systemDef->mParticleSystems )
+    {
+        if( !system->getVisible() )
+            continue;
+
+        Aabb aabb = system->getLocalAabb();
+        bool bVisible = true;
+        if( aabb != Aabb::BOX_INFINITE )
+        {
+            aabb.transformAffine( system->getParentNode()->_getFullTransform() );
+            for( size_t i = 0u; i < 6u && bVisible; ++i )
+            {
+                // Skip the far plane if it's at infinity.
+                if( i == FRUSTUM_PLANE_FAR && bInfiniteFarPlane )
+                    continue;
+
+                if( frustumPlanes[i].getSide( aabb.mCenter, aabb.mHalfSize ) ==
+                    Plane::NEGATIVE_SIDE )
+                {
+                    bVisible = false;
+                }
+            }
+        }
+
+        if( bVisible )
+        {
+            system->mLastVisibleFrame = mCurrentFrame;
+            bAnyVisible = true;
+        }
+    }
+
+    if( bAnyVisible )
+        systemDef->mLastVisibleFrame = mCurrentFrame;
+
+    return bAnyVisible;
+}
+//-----------------------------------------------------------------------------
 void ParticleSystemManager2::_addToRenderQueue( size_t threadIdx, size_t numThreads,
                                                 RenderQueue *renderQueue, uint8 renderQueueId,
                                                 uint32 visibilityMask, bool includeNonCasters ) const
@@ -944,23 +1197,69 @@ IndexBufferPacked *ParticleSystemManager2::_getSharedIndexBuffer( size_t maxQuot
 void ParticleSystemManager2::prepareForUpdate( const Real timeSinceLast )
 {
     mActiveParticlesLeftToSort.clear();
+    mDepthSortedSystemDefs.clear();
+    mParticleSystemDefsToUpdate.clear();
     if( mActiveParticleSystemDefs.empty() && mBillboardSets.empty() )
         return;
 
+    ++mCurrentFrame;
     mTimeSinceLast = timeSinceLast;
-    mActiveParticlesLeftToSort.appendPOD( mActiveParticleSystemDefs.begin(),
-                                          mActiveParticleSystemDefs.end() );
 
     for( ParticleSystemDef *systemDef : mActiveParticleSystemDefs )
     {
+        systemDef->mTimeSinceLast += timeSinceLast;
+
+        // Definitions with no instance visible in the last frame get updated less often,
+        // catching up with the time they skipped. ParticleGpuSimulation can't skip frames.
+        if( systemDef->mInvisibleTickInterval > 1u && !systemDef->mGpuSimulated &&
+            systemDef->mLastVisibleFrame + 1u < mCurrentFrame &&
+            ++systemDef->mSkippedFrames < systemDef->mInvisibleTickInterval )
+        {
+            continue;
+        }
+
+        systemDef->mSkippedFrames = 0u;
+        mParticleSystemDefsToUpdate.push_back( systemDef );
+    }
+
+    mActiveParticlesLeftToSort.appendPOD( mParticleSystemDefsToUpdate.begin(),
+                                          mParticleSystemDefsToUpdate.end() );
+
+    for( ParticleSystemDef *systemDef : mParticleSystemDefsToUpdate )
+    {
+        // mGpuData is filled by ParticleGpuSimulation
+        if( systemDef->mGpuSimulated )
+            continue;
+
         systemDef->mParticleGpuData = reinterpret_cast<ParticleGpuData *>(
             systemDef->mGpuData->map( 0u, systemDef->mGpuData->getNumElements() ) );
+
+        if( systemDef->mSortedIndexBuffer )
+        {
+            systemDef->mSortedIndices = systemDef->mSortedIndexBuffer->map(
+                0u, systemDef->mSortedIndexBuffer->getNumElements() );
+            mDepthSortedSystemDefs.push_back( systemDef );
+        }
     }
 
-    for( BillboardSet *billboardSet : mBillboardSets )
+    if( !mBillboardSets.empty() )
     {
-        billboardSet->mParticleGpuData = reinterpret_cast<ParticleGpuData *>(
-            billboardSet->mGpuData->map( 0u, billboardSet->mGpuData->getNumElements() ) );
+        // All billboards are rewritten every frame, so sub-allocate them from the ring
+        // rather than mapping one buffer per set
+        DynamicUploadRing *uploadRing =
+            mSceneManager->getDestinationRenderSystem()->getVaoManager()->getDynamicUploadRing(
+                BP_TYPE_READONLY );
+        for( BillboardSet *billboardSet : mBillboardSets )
+        {
+            const size_t sizeBytes =
+                sizeof( ParticleGpuData ) *
+                std::max<size_t>( billboardSet->getNumSimdActiveParticles(), ARRAY_PACKED_REALS );
+            const DynamicUploadRing::Allocation alloc = uploadRing->allocate( sizeBytes );
+            billboardSet->mGpuData = static_cast<ReadOnlyBufferPacked *>( alloc.buffer );
+            billboardSet->mGpuDataOffset = alloc.offset;
+            billboardSet->mGpuDataSizeBytes = sizeBytes;
+            billboardSet->mParticleGpuData = reinterpret_cast<ParticleGpuData *>( alloc.data );
+        }
     }
 }
 //-----------------------------------------------------------------------------
@@ -969,12 +1268,34 @@ void ParticleSystemManager2::update()
     if( mActiveParticleSystemDefs.empty() && mBillboardSets.empty() )
         return;
 
+    if( mCullCamera )
+    {
+        // Nodes are up to date by now. The result is used by next frame's prepareForUpdate().
+        const Plane *frustumPlanes = mCullCamera->getFrustumPlanes();
+        const bool bInfiniteFarPlane = mCullCamera->getFarClipDistance() == 0;
+        for( ParticleSystemDef *systemDef : mActiveParticleSystemDefs )
+            cullParticleSystems( systemDef, frustumPlanes, bInfiniteFarPlane );
+    }
+    else
+    {
+        for( ParticleSystemDef *systemDef : mActiveParticleSystemDefs )
+        {
+            systemDef->mLastVisibleFrame = mCurrentFrame;
+            for( ParticleSystem2 *system : systemDef->mParticleSystems )
+                system->mLastVisibleFrame = mCurrentFrame;
+        }
+    }
+
     mSceneManager->_fireParticleSystemManager2Update();
     updateSerialPos();
 }
 //-----------------------------------------------------------------------------
 void ParticleSystemManager2::_addParticleSystemDefAsActive( ParticleSystemDef *def )
 {
+    // Newly active definitions are assumed visible until proven otherwise.
+    def->mLastVisibleFrame = mCurrentFrame;
+    def->mSkippedFrames = 0u;
+    def->mTimeSinceLast = 0.0f;
     def->mGlobalIndex = mActiveParticleSystemDefs.size();
     mActiveParticleSystemDefs.push_back( def );
 }
@@ -0,0 +1,263 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Vao/OgreDynamicUploadRing.h"
+
+#include "OgreException.h"
+#include "OgreMath.h"
+#include "OgreStringConverter.h"
+#include "Vao/OgreConstBufferPacked.h"
+#include "Vao/OgreReadOnlyBufferPacked.h"
+#include "Vao/OgreVaoManager.h"
+
+namespace Ogre
+{
+    DynamicUploadRing::DynamicUploadRing( VaoManager *vaoManager, BufferPackedTypes bufferPackedType,
+                                          size_t chunkSizeBytes ) :
+        mCurrentChunk( 0 ),
+        mVaoManager( vaoManager ),
+        mBufferPackedType( bufferPackedType ),
+        mBufferType( vaoManager->supportsPersistentMapping() ? BT_DYNAMIC_PERSISTENT_COHERENT
+                                                             : BT_DYNAMIC_DEFAULT ),
+        mAlignment( 0 ),
+        mChunkSizeBytes( 0 ),
+        mMaxSizeBytes( 0 ),
+        mNumAllocationsThisFrame( 0 ),
+        mSpilledThisFrame( false )
+    {
+        OGRE_ASSERT_LOW( ( bufferPackedType == BP_TYPE_CONST || bufferPackedType == BP_TYPE_READONLY ) &&
+                         "Only const & read-only buffers are supported" );
+
+        if( bufferPackedType == BP_TYPE_CONST )
+        {
+            mAlignment = vaoManager->getConstBufferAlignment();
+            mMaxSizeBytes = vaoManager->getConstBufferMaxSize();
+        }
+        else
+        {
+            mAlignment = vaoManager->readOnlyIsTexBuffer() ? vaoManager->getTexBufferAlignment()
+                                                           : vaoManager->getUavBufferAlignment();
+            // Chunks are PFG_RGBA32_UINT
+            mAlignment = static_cast<uint32>( Math::lcm( mAlignment, 16u ) );
+            mMaxSizeBytes = vaoManager->getReadOnlyBufferMaxSize();
+        }
+
+        mMaxSizeBytes = alignToPreviousMult( mMaxSizeBytes, mAlignment );
+
+        setChunkSize( chunkSizeBytes );
+    }
+    //-----------------------------------------------------------------------------------
+    DynamicUploadRing::~DynamicUploadRing()
+    {
+        OGRE_ASSERT_LOW( mChunks.empty() &&
+                         "VaoManager::deleteAllBuffers should've called _notifyBuffersDeleted" );
+    }
+    //-----------------------------------------------------------------------------------
+    BufferPacked *DynamicUploadRing::createChunkBuffer( size_t sizeBytes )
+    {
+        BufferPacked *retVal;
+        if( mBufferPackedType == BP_TYPE_CONST )
+            retVal = mVaoManager->createConstBuffer( sizeBytes, mBufferType, 0, false );
+        else
+        {
+            retVal =
+                mVaoManager->createReadOnlyBuffer( PFG_RGBA32_UINT, sizeBytes, mBufferType, 0, false );
+        }
+
+        OGRE_ASSERT_LOW( retVal->getBytesPerElement() == 1u );
+        mStats.capacityBytes += retVal->getTotalSizeBytes();
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicUploadRing::destroyChunkBuffer( BufferPacked *buffer )
+    {
+        mStats.capacityBytes -= buffer->getTotalSizeBytes();
+
+        if( buffer->getMappingState() != MS_UNMAPPED )
+            buffer->unmap( UO_UNMAP_ALL );
+
+        if( mBufferPackedType == BP_TYPE_CONST )
+            mVaoManager->destroyConstBuffer( static_cast<ConstBufferPacked *>( buffer ) );
+        else
+            mVaoManager->destroyReadOnlyBuffer( static_cast<ReadOnlyBufferPacked *>( buffer ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicUploadRing::destroyAllChunks()
+    {
+        ChunkVec::const_iterator itor = mChunks.begin();
+        ChunkVec::const_iterator endt = mChunks.end();
+
+        while( itor != endt )
+        {
+            destroyChunkBuffer( itor->buffer );
+            ++itor;
+        }
+
+        mChunks.clear();
+        mCurrentChunk = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    bool DynamicUploadRing::mapChunk( Chunk &chunk )
+    {
+        if( !chunk.bMappedThisFrame )
+        {
+            chunk.mappedPtr =
+                reinterpret_cast<uint8 *>( chunk.buffer->map( 0u, chunk.buffer->getNumElements() ) );
+            chunk.bMappedThisFrame = true;
+        }
+
+        return chunk.mappedPtr != 0;
+    }
+    //-----------------------------------------------------------------------------------
+    DynamicUploadRing::Allocation DynamicUploadRing::allocate( size_t sizeBytes, size_t alignment )
+    {
+        OGRE_ASSERT_LOW( sizeBytes > 0u );
+
+        if( sizeBytes > mMaxSizeBytes )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Requested " + StringConverter::toString( sizeBytes ) +
+                             " bytes, but the maximum is " + StringConverter::toString( mMaxSizeBytes ),
+                         "DynamicUploadRing::allocate" );
+        }
+
+        alignment = alignment ? Math::lcm( mAlignment, alignment ) : mAlignment;
+
+        while( mCurrentChunk < mChunks.size() )
+        {
+            Chunk &chunk = mChunks[mCurrentChunk];
+            if( mapChunk( chunk ) )
+            {
+                const size_t offset = alignToNextMultiple( chunk.usedBytes, alignment );
+                if( offset + sizeBytes <= chunk.buffer->getTotalSizeBytes() )
+                {
+                    chunk.usedBytes = offset + sizeBytes;
+                    ++mNumAllocationsThisFrame;
+                    return Allocation( chunk.buffer, offset, chunk.mappedPtr + offset );
+                }
+
+                // Out of space (rather than closed by a flush)
+                mSpilledThisFrame = true;
+            }
+            ++mCurrentChunk;
+        }
+
+        // Nothing left for this frame. Add a new chunk; chunks will be
+        // grown at the end of the frame if we ran out of space
+        const size_t chunkSize =
+            std::max( mChunkSizeBytes, alignToNextMultiple<size_t>( sizeBytes, mAlignment ) );
+        mChunks.push_back( Chunk( createChunkBuffer( chunkSize ) ) );
+
+        Chunk &chunk = mChunks.back();
+        mapChunk( chunk );
+        chunk.usedBytes = sizeBytes;
+        ++mNumAllocationsThisFrame;
+        return Allocation( chunk.buffer, 0u, chunk.mappedPtr );
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicUploadRing::flush()
+    {
+        ChunkVec::iterator itor = mChunks.begin();
+        ChunkVec::iterator endt = mChunks.end();
+
+        while( itor != endt )
+        {
+            if( itor->buffer->isCurrentlyMapped() )
+            {
+                itor->buffer->unmap( UO_KEEP_PERSISTENT );
+                // Coherent persistent mappings remain writable. Otherwise
+                // this chunk can't be used again until the next frame.
+                if( mBufferType != BT_DYNAMIC_PERSISTENT_COHERENT )
+                    itor->mappedPtr = 0;
+            }
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicUploadRing::setChunkSize( size_t chunkSizeBytes )
+    {
+        chunkSizeBytes = alignToNextMultiple<size_t>( std::max<size_t>( chunkSizeBytes, 1u ), mAlignment );
+        mChunkSizeBytes = std::min( chunkSizeBytes, mMaxSizeBytes );
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicUploadRing::_endFrame()
+    {
+        flush();
+
+        size_t usedBytes = 0;
+
+        ChunkVec::iterator itor = mChunks.begin();
+        ChunkVec::iterator endt = mChunks.end();
+
+        while( itor != endt )
+        {
+            usedBytes += itor->usedBytes;
+            itor->usedBytes = 0;
+            itor->mappedPtr = 0;
+            itor->bMappedThisFrame = false;
+            ++itor;
+        }
+
+        mStats.usedBytesLastFrame = usedBytes;
+        mStats.peakUsedBytes = std::max( mStats.peakUsedBytes, usedBytes );
+        mStats.numAllocationsLastFrame = mNumAllocationsThisFrame;
+        mStats.peakNumAllocations = std::max( mStats.peakNumAllocations, mNumAllocationsThisFrame );
+
+        if( mSpilledThisFrame && mChunkSizeBytes < mMaxSizeBytes )
+        {
+            // Replace all chunks with bigger ones. Destruction is delayed by
+            // VaoManager until the GPU is done with them.
+            destroyAllChunks();
+            setChunkSize( mChunkSizeBytes * 2u );
+            ++mStats.numGrowths;
+        }
+
+        mCurrentChunk = 0;
+        mNumAllocationsThisFrame = 0;
+        mSpilledThisFrame = false;
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicUploadRing::_notifyBuffersDeleted()
+    {
+        ChunkVec::const_iterator itor = mChunks.begin();
+        ChunkVec::const_iterator endt = mChunks.end();
+
+        while( itor != endt )
+        {
+            if( itor->buffer->getMappingState() != MS_UNMAPPED )
+                itor->buffer->unmap( UO_UNMAP_ALL );
+            ++itor;
+        }
+
+        mChunks.clear();
+        mCurrentChunk = 0;
+        mStats.capacityBytes = 0;
+    }
+}  // namespace Ogre
@@ -0,0 +1,413 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-Next
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Vao/OgreTlsfAllocator.h"
+
+#include "OgreBitwise.h"
+#include "OgreException.h"
+#include "OgreStringConverter.h"
+
+namespace Ogre
+{
+    TlsfAllocator::Stats::Stats() :
+        capacity( 0 ),
+        freeBytes( 0 ),
+        largestFreeBlock( 0 ),
+        numFreeBlocks( 0 ),
+        numUsedBlocks( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    float TlsfAllocator::Stats::getFragmentation() const
+    {
+        if( freeBytes == 0u )
+            return 0.0f;
+        return 1.0f - float( largestFreeBlock ) / float( freeBytes );
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    TlsfAllocator::TlsfAllocator() { reset( 0u ); }
+    //-----------------------------------------------------------------------------------
+    TlsfAllocator::TlsfAllocator( size_t capacity ) { reset( capacity ); }
+    //-----------------------------------------------------------------------------------
+    void TlsfAllocator::reset( size_t capacity )
+    {
+        mNodes.clear();
+        mUnusedNodes.clear();
+        mUsedNodes.clear();
+
+        mFirstLevelBitmap = 0u;
+        memset( mSecondLevelBitmap, 0, sizeof( mSecondLevelBitmap ) );
+        memset( mFreeListHeads, 0xFF, sizeof( mFreeListHeads ) );
+
+        mFirstPhysNode = c_invalidNode;
+        mCapacity = capacity;
+        mFreeBytes = 0u;
+        mNumFreeBlocks = 0u;
+
+        if( capacity > 0u )
+        {
+            mFirstPhysNode = createNode( 0u, capacity, c_invalidNode, c_invalidNode );
+            insertFreeNode( mFirstPhysNode );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfAllocator::mapping( size_t size, uint32 &outFirstLevel, uint32 &outSecondLevel )
+    {
+        if( size < c_numSecondLevels )
+        {
+            // Small blocks get their own exact bins
+            outFirstLevel = 0u;
+            outSecondLevel = static_cast<uint32>( size );
+        }
+        else
+        {
+            const uint32 msb = 63u - Bitwise::clz64( size );
+            outFirstLevel = msb - c_secondLevelLog2 + 1u;
+            outSecondLevel =
+                static_cast<uint32>( size >> ( msb - c_secondLevelLog2 ) ) - c_numSecondLevels;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 TlsfAllocator::findSuitableNode( size_t sizeBytes ) const
+    {
+        // Round up to the next size class, so that any block in it is big enough
+        if( sizeBytes >= c_numSecondLevels )
+        {
+            const uint32 msb = 63u - Bitwise::clz64( sizeBytes );
+            const size_t roundUp = ( size_t( 1u ) << ( msb - c_secondLevelLog2 ) ) - 1u;
+            if( sizeBytes > std::numeric_limits<size_t>::max() - roundUp )
+                return c_invalidNode;
+            sizeBytes += roundUp;
+        }
+
+        uint32 firstLevel, secondLevel;
+        mapping( sizeBytes, firstLevel, secondLevel );
+
+        uint32 secondLevelMap = mSecondLevelBitmap[firstLevel] & ( ~0u << secondLevel );
+        if( !secondLevelMap )
+        {
+            if( firstLevel + 1u >= c_numFirstLevels )
+                return c_invalidNode;
+
+            const uint64 firstLevelMap = mFirstLevelBitmap & ( ~uint64( 0u ) << ( firstLevel + 1u ) );
+            if( !firstLevelMap )
+                return c_invalidNode;
+
+            firstLevel = Bitwise::ctz64( firstLevelMap );
+            secondLevelMap = mSecondLevelBitmap[firstLevel];
+        }
+
+        secondLevel = Bitwise::ctz32( secondLevelMap );
+        return mFreeListHeads[firstLevel][secondLevel];
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 TlsfAllocator::createNode( size_t offset, size_t size, uint32 prevPhys, uint32 nextPhys )
+    {
+        uint32 nodeIdx;
+        if( !mUnusedNodes.empty() )
+        {
+            nodeIdx = mUnusedNodes.back();
+            mUnusedNodes.pop_back();
+        }
+        else
+        {
+            nodeIdx = static_cast<uint32>( mNodes.size() );
+            mNodes.push_back( Node() );
+        }
+
+        Node &node = mNodes[nodeIdx];
+        node.offset = offset;
+        node.size = size;
+        node.prevPhys = prevPhys;
+        node.nextPhys = nextPhys;
+        node.prevFree = c_invalidNode;
+        node.nextFree = c_invalidNode;
+        node.isFree = false;
+
+        if( prevPhys != c_invalidNode )
+            mNodes[prevPhys].nextPhys = nodeIdx;
+        else
+            mFirstPhysNode = nodeIdx;
+        if( nextPhys != c_invalidNode )
+            mNodes[nextPhys].prevPhys = nodeIdx;
+
+        return nodeIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfAllocator::destroyNode( uint32 nodeIdx )
+    {
+        const Node &node = mNodes[nodeIdx];
+
+        if( node.prevPhys != c_invalidNode )
+            mNodes[node.prevPhys].nextPhys = node.nextPhys;
+        else
+            mFirstPhysNode = node.nextPhys;
+        if( node.nextPhys != c_invalidNode )
+            mNodes[node.nextPhys].prevPhys = node.prevPhys;
+
+        mUnusedNodes.push_back( nodeIdx );
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfAllocator::insertFreeNode( uint32 nodeIdx )
+    {
+        Node &node = mNodes[nodeIdx];
+
+        uint32 firstLevel, secondLevel;
+        mapping( node.size, firstLevel, secondLevel );
+
+        const uint32 head = mFreeListHeads[firstLevel][secondLevel];
+        node.isFree = true;
+        node.prevFree = c_invalidNode;
+        node.nextFree = head;
+        if( head != c_invalidNode )
+            mNodes[head].prevFree = nodeIdx;
+        mFreeListHeads[firstLevel][secondLevel] = nodeIdx;
+
+        mFirstLevelBitmap |= uint64( 1u ) << firstLevel;
+        mSecondLevelBitmap[firstLevel] |= 1u << secondLevel;
+
+        mFreeBytes += node.size;
+        ++mNumFreeBlocks;
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfAllocator::removeFreeNode( uint32 nodeIdx )
+    {
+        Node &node = mNodes[nodeIdx];
+        OGRE_ASSERT_MEDIUM( node.isFree );
+
+        if( node.prevFree != c_invalidNode )
+            mNodes[node.prevFree].nextFree = node.nextFree;
+        if( node.nextFree != c_invalidNode )
+            mNodes[node.nextFree].prevFree = node.prevFree;
+
+        uint32 firstLevel, secondLevel;
+        mapping( node.size, firstLevel, secondLevel );
+
+        if( mFreeListHeads[firstLevel][secondLevel] == nodeIdx )
+        {
+            mFreeListHeads[firstLevel][secondLevel] = node.nextFree;
+            if( node.nextFree == c_invalidNode )
+            {
+                mSecondLevelBitmap[firstLevel] &= ~( 1u << secondLevel );
+                if( !mSecondLevelBitmap[firstLevel] )
+                    mFirstLevelBitmap &= ~( uint64( 1u ) << firstLevel );
+            }
+        }
+
+        node.isFree = false;
+        node.prevFree = c_invalidNode;
+        node.nextFree = c_invalidNode;
+
+        mFreeBytes -= node.size;
+        --mNumFreeBlocks;
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfAllocator::absorbNextNode( uint32 nodeIdx )
+    {
+        const uint32 nextIdx = mNodes[nodeIdx].nextPhys;
+        OGRE_ASSERT_MEDIUM( nextIdx != c_invalidNode && !mNodes[nextIdx].isFree );
+        mNodes[nodeIdx].size += mNodes[nextIdx].size;
+        destroyNode( nextIdx );
+    }
+    //-----------------------------------------------------------------------------------
+    bool TlsfAllocator::allocate( size_t sizeBytes, size_t alignment, size_t &outOffset )
+    {
+        OGRE_ASSERT_LOW( sizeBytes > 0u && alignment > 0u );
+
+        // Try first with the exact size, since most of the time the offset is already
+        // aligned. If not, ask for a block big enough to hold the worst case padding.
+        uint32 nodeIdx = findSuitableNode( sizeBytes );
+        size_t alignedOffset = 0u;
+        if( nodeIdx != c_invalidNode )
+        {
+            const Node &node = mNodes[nodeIdx];
+            alignedOffset = ( ( node.offset + alignment - 1u ) / alignment ) * alignment;
+            if( alignedOffset - node.offset + sizeBytes > node.size )
+                nodeIdx = c_invalidNode;
+        }
+
+        if( nodeIdx == c_invalidNode && alignment > 1u )
+        {
+            nodeIdx = findSuitableNode( sizeBytes + alignment - 1u );
+            if( nodeIdx != c_invalidNode )
+            {
+                const Node &node = mNodes[nodeIdx];
+                alignedOffset = ( ( node.offset + alignment - 1u ) / alignment ) * alignment;
+            }
+        }
+
+        if( nodeIdx == c_invalidNode )
+            return false;
+
+        removeFreeNode( nodeIdx );
+        useNode( nodeIdx, alignedOffset, sizeBytes );
+        outOffset = alignedOffset;
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfAllocator::useNode( uint32 nodeIdx, size_t offset, size_t sizeBytes )
+    {
+        const size_t padding = offset - mNodes[nodeIdx].offset;
+        if( padding > 0u )
+        {
+            // Give the padding back as a free block. Its previous physical
+            // neighbour can't be free, because free blocks are always coalesced.
+            const uint32 paddingIdx = createNode( mNodes[nodeIdx].offset, padding,
+                                                  mNodes[nodeIdx].prevPhys, nodeIdx );
+            insertFreeNode( paddingIdx );
+
+            Node &node = mNodes[nodeIdx];
+            node.offset += padding;
+            node.size -= padding;
+        }
+
+        if( mNodes[nodeIdx].size > sizeBytes )
+        {
+            // Return the remainder to the free lists
+            const Node &node = mNodes[nodeIdx];
+            const uint32 remainderIdx = createNode( node.offset + sizeBytes, node.size - sizeBytes,
+                                                    nodeIdx, node.nextPhys );
+            mNodes[nodeIdx].size = sizeBytes;
+            insertFreeNode( remainderIdx );
+        }
+
+        mUsedNodes[offset] = nodeIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfAllocator::allocateAt( size_t offset, size_t sizeBytes )
+    {
+        OGRE_ASSERT_LOW( sizeBytes > 0u );
+
+        uint32 nodeIdx = mFirstPhysNode;
+        while( nodeIdx != c_invalidNode &&
+               mNodes[nodeIdx].offset + mNodes[nodeIdx].size <= offset )
+        {
+            nodeIdx = mNodes[nodeIdx].nextPhys;
+        }
+
+        if( nodeIdx == c_invalidNode || !mNodes[nodeIdx].isFree ||
+            offset + sizeBytes > mNodes[nodeIdx].offset + mNodes[nodeIdx].size )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Range at offset " + StringConverter::toString( offset ) + " of " +
+                             StringConverter::toString( sizeBytes ) + " bytes is not free.",
+                         "TlsfAllocator::allocateAt" );
+        }
+
+        removeFreeNode( nodeIdx );
+        useNode( nodeIdx, offset, sizeBytes );
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfAllocator::deallocate( size_t offset, size_t sizeBytes )
+    {
+        OffsetToNodeMap::iterator itor = mUsedNodes.find( offset );
+        if( itor == mUsedNodes.end() )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "Deallocating offset " + StringConverter::toString( offset ) +
+                             " which was never allocated or was already released.",
+                         "TlsfAllocator::deallocate" );
+        }
+
+        uint32 nodeIdx = itor->second;
+        mUsedNodes.erase( itor );
+
+        OGRE_ASSERT_LOW( mNodes[nodeIdx].size == sizeBytes &&
+                         "sizeBytes doesn't match the value passed to allocate" );
+        (void)sizeBytes;
+
+        // Coalesce with free physical neighbours
+        const uint32 nextIdx = mNodes[nodeIdx].nextPhys;
+        if( nextIdx != c_invalidNode && mNodes[nextIdx].isFree )
+        {
+            removeFreeNode( nextIdx );
+            absorbNextNode( nodeIdx );
+        }
+
+        const uint32 prevIdx = mNodes[nodeIdx].prevPhys;
+        if( prevIdx != c_invalidNode && mNodes[prevIdx].isFree )
+        {
+            removeFreeNode( prevIdx );
+            absorbNextNode( prevIdx );
+            nodeIdx = prevIdx;
+        }
+
+        insertFreeNode( nodeIdx );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t TlsfAllocator::getLargestFreeBlock() const
+    {
+        if( !mFirstLevelBitmap )
+            return 0u;
+
+        const uint32 firstLevel = 63u - Bitwise::clz64( mFirstLevelBitmap );
+        const uint32 secondLevel = 31u - Bitwise::clz32( mSecondLevelBitmap[firstLevel] );
+
+        size_t largest = 0u;
+        uint32 nodeIdx = mFreeListHeads[firstLevel][secondLevel];
+        while( nodeIdx != c_invalidNode )
+        {
+            largest = std::max( largest, mNodes[nodeIdx].size );
+            nodeIdx = mNodes[nodeIdx].nextFree;
+        }
+
+        return largest;
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfAllocator::getStats( Stats &outStats ) const
+    {
+        outStats.capacity = mCapacity;
+        outStats.freeBytes = mFreeBytes;
+        outStats.largestFreeBlock = getLargestFreeBlock();
+        outStats.numFreeBlocks = mNumFreeBlocks;
+        outStats.numUsedBlocks = mUsedNodes.size();
+    }
+    //-----------------------------------------------------------------------------------
+    void TlsfAllocator::getUsedBlocks( BlockVec &outBlocks ) const
+    {
+        bool bLastWasUsed = false;
+        uint32 nodeIdx = mFirstPhysNode;
+        while( nodeIdx != c_invalidNode )
+        {
+            const Node &node = mNodes[nodeIdx];
+            if( !node.isFree )
+            {
+                if( bLastWasUsed )
+                    outBlocks.back().size += node.size;
+                else
+                    outBlocks.push_back( Block( node.offset, node.size ) );
+            }
+            bLastWasUsed = !node.isFree;
+            nodeIdx = node.nextPhys;
+        }
+    }
+}  // namespace Ogre
@@ -32,10 +32,13 @@ THE SOFTWARE.
 
 #include "OgreCommon.h"
 #include "OgreLogManager.h"
+#include "OgreMath.h"
+#include "OgreProfiler.h"
 #include "OgreRoot.h"
 #include "OgreStringConverter.h"
 #include "OgreTimer.h"
 #include "Vao/OgreConstBufferPacked.h"
+#include "Vao/OgreDynamicUploadRing.h"
 #include "Vao/OgreIndirectBufferPacked.h"
 #include "Vao/OgreReadOnlyBufferPacked.h"
 #include "Vao/OgreStagingBuffer.h"
@@ -45,6 +48,9 @@ THE SOFTWARE.
 
 namespace Ogre
 {
+    /// Initial size of each DynamicUploadRing chunk. They grow on demand.
+    static const size_t c_dynamicUploadRingChunkSize = 1u * 1024u * 1024u;
+    //-----------------------------------------------------------------------------------
     VaoManager::VaoManager( const NameValuePairList *params ) :
         mTimer( 0 ),
         mDefaultStagingBufferUnfencedTime( 300000 - 1000 ),  // 4 minutes, 59 seconds
@@ -66,8 +72,15 @@ namespace Ogre
             64 * 1024 *
             1024 ),  // Minimum guaranteed by GL. Intel HD Graphics 3000-5000/Iris provide 64M only
         mReadOnlyBufferMaxSize( 64 * 1024 * 1024 ),
-        mUavBufferMaxSize( 16 * 1024 * 1024 )  // Minimum guaranteed by GL.
+        mUavBufferMaxSize( 16 * 1024 * 1024 ),  // Minimum guaranteed by GL.
+        mDefragmentationBudget( 0u ),
+        mDefragmentationMaxPoolUsage( 0.5f ),
+        mDefragmentationDirty( false ),
+        mSupportsBufferRelocation( false )
     {
+        mDynamicUploadRings[0] = 0;
+        mDynamicUploadRings[1] = 0;
+
         mTimer = OGRE_NEW Timer();
 
         if( params )
@@ -86,6 +99,12 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     VaoManager::~VaoManager()
     {
+        for( size_t i = 0; i < 2u; ++i )
+        {
+            OGRE_DELETE mDynamicUploadRings[i];
+            mDynamicUploadRings[i] = 0;
+        }
+
         deleteStagingBuffers();
 
         OGRE_DELETE mTimer;
@@ -122,6 +141,315 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    VaoManager::MemoryPoolStats::MemoryPoolStats( uint32 _poolType, uint32 _poolIdx,
+                                                  size_t _poolCapacity, bool _bPoolHasTextures ) :
+        poolType( _poolType ),
+        poolIdx( _poolIdx ),
+        poolCapacity( _poolCapacity ),
+        freeBytes( 0 ),
+        largestFreeBlock( 0 ),
+        numFreeBlocks( 0 ),
+        bPoolHasTextures( _bPoolHasTextures )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    float VaoManager::MemoryPoolStats::getFragmentation() const
+    {
+        if( freeBytes == 0u )
+            return 0.0f;
+        return 1.0f - float( largestFreeBlock ) / float( freeBytes );
+    }
+    //-----------------------------------------------------------------------------------
+    struct MemoryStatsEntryCmp
+    {
+        bool operator()( const VaoManager::MemoryStatsEntry &a,
+                         const VaoManager::MemoryStatsEntry &b ) const
+        {
+            const uint64 poolA = a.getCombinedPoolIdx();
+            const uint64 poolB = b.getCombinedPoolIdx();
+            if( poolA != poolB )
+                return poolA < poolB;
+            return a.offset < b.offset;
+        }
+    };
+    //-----------------------------------------------------------------------------------
+    static void addFreeRegion( VaoManager::MemoryPoolStats &poolStats, size_t sizeBytes )
+    {
+        if( sizeBytes > 0u )
+        {
+            poolStats.freeBytes += sizeBytes;
+            poolStats.largestFreeBlock = std::max( poolStats.largestFreeBlock, sizeBytes );
+            ++poolStats.numFreeBlocks;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::getMemoryPoolStats( MemoryPoolStatsVec &outStats ) const
+    {
+        outStats.clear();
+
+        MemoryStatsEntryVec entries;
+        size_t capacityBytes, freeBytes;
+        bool bIncludesTextures;
+        getMemoryStats( entries, capacityBytes, freeBytes, 0, bIncludesTextures );
+
+        std::sort( entries.begin(), entries.end(), MemoryStatsEntryCmp() );
+
+        // Free regions are the gaps between used blocks
+        size_t nextFreeOffset = 0u;
+        MemoryStatsEntryVec::const_iterator itor = entries.begin();
+        MemoryStatsEntryVec::const_iterator endt = entries.end();
+
+        while( itor != endt )
+        {
+            if( outStats.empty() || outStats.back().poolType != itor->poolType ||
+                outStats.back().poolIdx != itor->poolIdx )
+            {
+                if( !outStats.empty() )
+                {
+                    MemoryPoolStats &prevPool = outStats.back();
+                    addFreeRegion( prevPool, prevPool.poolCapacity - nextFreeOffset );
+                }
+
+                outStats.push_back( MemoryPoolStats( itor->poolType, itor->poolIdx,
+                                                     itor->poolCapacity, itor->bPoolHasTextures ) );
+                nextFreeOffset = 0u;
+            }
+
+            addFreeRegion( outStats.back(), itor->offset - nextFreeOffset );
+            nextFreeOffset = itor->offset + itor->sizeBytes;
+            ++itor;
+        }
+
+        if( !outStats.empty() )
+        {
+            MemoryPoolStats &prevPool = outStats.back();
+            addFreeRegion( prevPool, prevPool.poolCapacity - nextFreeOffset );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool VaoManager::getBufferPool( const BufferPacked *buffer, uint32 &outPoolType,
+                                    uint32 &outPoolIdx ) const
+    {
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
+    bool VaoManager::relocateBufferImpl( BufferPacked *buffer, uint32 poolType, uint32 srcPoolIdx )
+    {
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::refreshVertexArrayObjectImpl( VertexArrayObject *vao ) {}
+    //-----------------------------------------------------------------------------------
+    void VaoManager::setDefragmentationBudget( size_t bytesPerFrame, float maxPoolUsage )
+    {
+        mDefragmentationBudget = bytesPerFrame;
+        mDefragmentationMaxPoolUsage = Math::saturate( maxPoolUsage );
+        mDefragmentationDirty = true;
+    }
+    //-----------------------------------------------------------------------------------
+    struct RelocatableBuffer
+    {
+        BufferPacked *buffer;
+        uint32 poolType;
+        uint32 poolIdx;
+
+        RelocatableBuffer( BufferPacked *_buffer, uint32 _poolType, uint32 _poolIdx ) :
+            buffer( _buffer ),
+            poolType( _poolType ),
+            poolIdx( _poolIdx )
+        {
+        }
+
+        /// Groups by pool, biggest buffers first
+        bool operator<( const RelocatableBuffer &other ) const
+        {
+            if( this->poolType != other.poolType )
+                return this->poolType < other.poolType;
+            if( this->poolIdx != other.poolIdx )
+                return this->poolIdx < other.poolIdx;
+            return this->buffer->getTotalSizeBytes() > other.buffer->getTotalSizeBytes();
+        }
+    };
+    typedef vector<RelocatableBuffer>::type RelocatableBufferVec;
+    //-----------------------------------------------------------------------------------
+    size_t VaoManager::defragmentPools( size_t maxBytes )
+    {
+        if( !mSupportsBufferRelocation || !mDefragmentationDirty )
+            return 0u;
+
+        OgreProfileExhaustive( "VaoManager::defragmentPools" );
+
+        RelocatableBufferVec candidates;
+
+        const BufferPackedTypes relocatableTypes[2] = { BP_TYPE_VERTEX, BP_TYPE_INDEX };
+        for( size_t i = 0u; i < 2u; ++i )
+        {
+            BufferPackedSet::const_iterator itor = mBuffers[relocatableTypes[i]].begin();
+            BufferPackedSet::const_iterator endt = mBuffers[relocatableTypes[i]].end();
+
+            while( itor != endt )
+            {
+                BufferPacked *buffer = *itor;
+                bool bRelocatable = buffer->getBufferType() < BT_DYNAMIC_DEFAULT;
+#ifdef _OGRE_MULTISOURCE_VBO
+                if( relocatableTypes[i] == BP_TYPE_VERTEX &&
+                    static_cast<VertexBufferPacked *>( buffer )->getMultiSourcePool() )
+                {
+                    bRelocatable = false;
+                }
+#endif
+                uint32 poolType, poolIdx;
+                if( bRelocatable && getBufferPool( buffer, poolType, poolIdx ) )
+                    candidates.push_back( RelocatableBuffer( buffer, poolType, poolIdx ) );
+                ++itor;
+            }
+        }
+
+        std::sort( candidates.begin(), candidates.end() );
+
+        MemoryPoolStatsVec poolStats;
+        getMemoryPoolStats( poolStats );
+
+        // Pick the pool that is cheapest to empty, as long as the rest
+        // of the pools of the same type have enough room for its contents.
+        RelocatableBufferVec::const_iterator srcBegin = candidates.end();
+        RelocatableBufferVec::const_iterator srcEnd = candidates.end();
+        size_t srcUsedBytes = std::numeric_limits<size_t>::max();
+
+        RelocatableBufferVec::const_iterator itor = candidates.begin();
+        RelocatableBufferVec::const_iterator endt = candidates.end();
+
+        while( itor != endt )
+        {
+            const uint32 poolType = itor->poolType;
+            const uint32 poolIdx = itor->poolIdx;
+
+            size_t movableBytes = 0u;
+            RelocatableBufferVec::const_iterator runEnd = itor;
+            while( runEnd != endt && runEnd->poolType == poolType && runEnd->poolIdx == poolIdx )
+            {
+                movableBytes += runEnd->buffer->getTotalSizeBytes();
+                ++runEnd;
+            }
+
+            size_t usedBytes = 0u;
+            size_t freeBytesElsewhere = 0u;
+            bool bEligible = false;
+
+            MemoryPoolStatsVec::const_iterator itStats = poolStats.begin();
+            MemoryPoolStatsVec::const_iterator enStats = poolStats.end();
+
+            while( itStats != enStats )
+            {
+                if( itStats->poolType == poolType )
+                {
+                    if( itStats->poolIdx == poolIdx )
+                    {
+                        usedBytes = itStats->poolCapacity - itStats->freeBytes;
+                        bEligible = !itStats->bPoolHasTextures &&
+                                    (float)usedBytes <= (float)itStats->poolCapacity *
+                                                            mDefragmentationMaxPoolUsage;
+                    }
+                    else if( !itStats->bPoolHasTextures )
+                    {
+                        freeBytesElsewhere += itStats->freeBytes;
+                    }
+                }
+                ++itStats;
+            }
+
+            if( bEligible && usedBytes < srcUsedBytes && freeBytesElsewhere >= movableBytes )
+            {
+                srcBegin = itor;
+                srcEnd = runEnd;
+                srcUsedBytes = usedBytes;
+            }
+
+            itor = runEnd;
+        }
+
+        if( srcBegin == srcEnd )
+        {
+            // Nothing to do until more buffers get destroyed
+            mDefragmentationDirty = false;
+            return 0u;
+        }
+
+        size_t bytesMoved = 0u;
+        bool bPoolDrained = true;
+        BufferPackedVec movedBuffers;
+
+        itor = srcBegin;
+        while( itor != srcEnd && bPoolDrained )
+        {
+            const size_t sizeBytes = itor->buffer->getTotalSizeBytes();
+            if( bytesMoved && bytesMoved + sizeBytes > maxBytes )
+            {
+                bPoolDrained = false;
+            }
+            else if( !relocateBufferImpl( itor->buffer, itor->poolType, itor->poolIdx ) )
+            {
+                // Other pools are too fragmented to take it. Don't retry every frame.
+                bPoolDrained = false;
+                if( !bytesMoved )
+                    mDefragmentationDirty = false;
+            }
+            else
+            {
+                bytesMoved += sizeBytes;
+                movedBuffers.push_back( itor->buffer );
+                ++itor;
+            }
+        }
+
+        if( !movedBuffers.empty() )
+        {
+            std::sort( movedBuffers.begin(), movedBuffers.end() );
+
+            VertexArrayObjectSet::const_iterator itVao = mVertexArrayObjects.begin();
+            VertexArrayObjectSet::const_iterator enVao = mVertexArrayObjects.end();
+
+            while( itVao != enVao )
+            {
+                VertexArrayObject *vao = *itVao;
+
+                bool bAffected = vao->getIndexBuffer() &&
+                                 std::binary_search( movedBuffers.begin(), movedBuffers.end(),
+                                                     vao->getIndexBuffer() );
+
+                VertexBufferPackedVec::const_iterator itBuf = vao->getVertexBuffers().begin();
+                VertexBufferPackedVec::const_iterator enBuf = vao->getVertexBuffers().end();
+
+                while( itBuf != enBuf && !bAffected )
+                {
+                    bAffected =
+                        std::binary_search( movedBuffers.begin(), movedBuffers.end(), *itBuf );
+                    ++itBuf;
+                }
+
+                if( bAffected )
+                    refreshVertexArrayObjectImpl( vao );
+
+                ++itVao;
+            }
+
+            mDefragmentationStats.bytesMoved += bytesMoved;
+            mDefragmentationStats.buffersMoved += movedBuffers.size();
+        }
+
+        if( bPoolDrained )
+        {
+            // Relocating never creates pools, so poolStats.size() is still valid
+            const size_t numPools = poolStats.size();
+            cleanupEmptyPools();
+            getMemoryPoolStats( poolStats );
+            if( poolStats.size() < numPools )
+                mDefragmentationStats.poolsReleased += numPools - poolStats.size();
+        }
+
+        return bytesMoved;
+    }
+    //-----------------------------------------------------------------------------------
     uint32 VaoManager::calculateVertexSize( const VertexElement2Vec &vertexElements )
     {
         VertexElement2Vec::const_iterator itor = vertexElements.begin();
@@ -183,6 +511,7 @@ namespace Ogre
         {
             destroyVertexBufferImpl( vertexBuffer );
             OGRE_DELETE vertexBuffer;
+            mDefragmentationDirty = true;
         }
 
         mBuffers[BP_TYPE_VERTEX].erase( itor );
@@ -222,6 +551,7 @@ namespace Ogre
         {
             destroyIndexBufferImpl( indexBuffer );
             OGRE_DELETE *itor;
+            mDefragmentationDirty = true;
         }
 
         mBuffers[BP_TYPE_INDEX].erase( itor );
@@ -487,6 +817,12 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void VaoManager::deleteAllBuffers()
     {
+        for( size_t i = 0; i < 2u; ++i )
+        {
+            if( mDynamicUploadRings[i] )
+                mDynamicUploadRings[i]->_notifyBuffersDeleted();
+        }
+
         for( int i = 0; i < NUM_BUFFER_PACKED_TYPES; ++i )
         {
             BufferPackedSet::const_iterator itor = mBuffers[i].begin();
@@ -675,8 +1011,71 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    DynamicUploadRing *VaoManager::getDynamicUploadRing( BufferPackedTypes bufferPackedType )
+    {
+        if( bufferPackedType != BP_TYPE_CONST && bufferPackedType != BP_TYPE_READONLY )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Only BP_TYPE_CONST and BP_TYPE_READONLY are supported",
+                         "VaoManager::getDynamicUploadRing" );
+        }
+
+        const size_t idx = bufferPackedType == BP_TYPE_CONST ? 0u : 1u;
+        if( !mDynamicUploadRings[idx] )
+        {
+            mDynamicUploadRings[idx] =
+                OGRE_NEW DynamicUploadRing( this, bufferPackedType, c_dynamicUploadRingChunkSize );
+        }
+
+        return mDynamicUploadRings[idx];
+    }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::_flushDynamicUploadRings()
+    {
+        for( size_t i = 0; i < 2u; ++i )
+        {
+            if( mDynamicUploadRings[i] )
+                mDynamicUploadRings[i]->flush();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::logDynamicUploadRingStats( Log *log ) const
+    {
+        const char *ringNames[2] = { "DYNAMIC_UPLOAD_RING_CONST", "DYNAMIC_UPLOAD_RING_READONLY" };
+
+        log->logMessage(
+            "Ring Type;Capacity;Used Bytes Last Frame;Peak Used Bytes;"
+            "Allocations Last Frame;Peak Allocations;Growths",
+            LML_CRITICAL );
+
+        for( size_t i = 0; i < 2u; ++i )
+        {
+            if( !mDynamicUploadRings[i] )
+                continue;
+
+            const DynamicUploadRing::Stats &stats = mDynamicUploadRings[i]->getStats();
+            log->logMessage( String( ringNames[i] ) + ";" +
+                                 StringConverter::toString( stats.capacityBytes ) + ";" +
+                                 StringConverter::toString( stats.usedBytesLastFrame ) + ";" +
+                                 StringConverter::toString( stats.peakUsedBytes ) + ";" +
+                                 StringConverter::toString( stats.numAllocationsLastFrame ) + ";" +
+                                 StringConverter::toString( stats.peakNumAllocations ) + ";" +
+                                 StringConverter::toString( stats.numGrowths ),
+                             LML_CRITICAL );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void VaoManager::_update()
     {
+        for( size_t i = 0; i < 2u; ++i )
+        {
+            if( mDynamicUploadRings[i] )
+                mDynamicUploadRings[i]->_endFrame();
+        }
+
+        if( mDefragmentationBudget )
+            defragmentPools( mDefragmentationBudget );
+
         Root::getSingleton()._renderingFrameEnded();
         ++mFrameCount;
     }
@@ -90,6 +90,8 @@ namespace Ogre
 
         void run( ParticleCpuData cpuData, size_t numParticles, ArrayReal timeSinceLast ) const override;
 
+        bool getGpuParams( GpuParticleAffector &outParams ) const override;
+
         /// Sets the plane point of the deflector plane.
         void setPlanePoint( const Vector3 &pos );
 
@@ -82,6 +82,8 @@ namespace Ogre
 
         void run( ParticleCpuData cpuData, size_t numParticles, ArrayReal timeSinceLast ) const override;
 
+        bool getGpuParams( GpuParticleAffector &outParams ) const override;
+
         void setScaleAdjust( size_t index, Real scale );
         Real getScaleAdjust( size_t index ) const;
 
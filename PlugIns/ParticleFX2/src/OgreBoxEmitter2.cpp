@@ -42,42 +42,30 @@ void BoxEmitter2::initEmittedParticles( ParticleCpuData cpuData, const EmittedPa
                                         const size_t numParticles )
 {
     const Vector3 position = mPosition;
-    const Vector2 dimensions = mDimensions;
     const Vector3 xRange = mXRange;
     const Vector3 yRange = mYRange;
     const Vector3 zRange = mZRange;
 
-    for( size_t i = 0u; i < numParticles; ++i )
-    {
-        const size_t h = newHandles[i].handle;
-        const size_t j = h / ARRAY_PACKED_REALS;
-        const size_t idx = h % ARRAY_PACKED_REALS;
-
-        Vector3 xOff, yOff, zOff;
+    Vector3 localPos[ARRAY_PACKED_REALS];
 
-        xOff = Math::SymmetricRandom() * xRange;
-        yOff = Math::SymmetricRandom() * yRange;
-        zOff = Math::SymmetricRandom() * zRange;
-
-        const Vector3 localPos = position + xOff + yOff + zOff;
-        cpuData.mPosition[j].setFromVector3( newHandles[i].pos + newHandles[i].rot * localPos, idx );
-        reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mRotation )[h] = 0.0f;
+    size_t i = 0u;
+    while( i < numParticles )
+    {
+        const size_t numInPack = getNextPackSize( newHandles + i, numParticles - i );
 
-        Vector3 direction;
-        this->genEmissionDirection( localPos, direction );
-        this->genEmissionVelocity( direction );
-        direction = newHandles[i].rot * direction;
-        cpuData.mDirection[j].setFromVector3( direction, idx );
+        for( size_t k = 0u; k < numInPack; ++k )
+        {
+            Vector3 xOff, yOff, zOff;
 
-        cpuData.mDimensions[j].setFromVector2( dimensions, idx );
+            xOff = Math::SymmetricRandom() * xRange;
+            yOff = Math::SymmetricRandom() * yRange;
+            zOff = Math::SymmetricRandom() * zRange;
 
-        Ogre::ColourValue colour;
-        this->genEmissionColour( colour );
-        cpuData.mColour[j].setFromVector4( Vector4( colour.ptr() ), idx );
+            localPos[k] = position + xOff + yOff + zOff;
+        }
 
-        reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTimeToLive )[h] =
-            reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTotalTimeToLive )[h] =
-                this->genEmissionTTL();
+        initEmittedParticlesPack( cpuData, newHandles + i, localPos, numInPack );
+        i += numInPack;
     }
 }
 //-----------------------------------------------------------------------------------
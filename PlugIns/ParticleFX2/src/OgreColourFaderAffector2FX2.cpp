@@ -154,6 +154,20 @@ void ColourFaderAffector2FX2::run( ParticleCpuData cpuData, const size_t numPart
     }
 }
 //-----------------------------------------------------------------------------
+bool ColourFaderAffector2FX2::getGpuParams( GpuParticleAffector &outParams ) const
+{
+    outParams.type = GpuParticleAffectorType::ColourFader2;
+    for( size_t i = 0u; i < 4u; ++i )
+    {
+        outParams.params[i + 0u] = static_cast<float>( mColourAdj1[i] );
+        outParams.params[i + 4u] = static_cast<float>( mColourAdj2[i] );
+        outParams.params[i + 8u] = static_cast<float>( mMinColour[i] );
+        outParams.params[i + 12u] = static_cast<float>( mMaxColour[i] );
+    }
+    outParams.params[16] = static_cast<float>( mStateChangeVal );
+    return true;
+}
+//-----------------------------------------------------------------------------
 void ColourFaderAffector2FX2::setMaxColour( const Vector4 &rgba )
 {
     mMaxColour = rgba;
@@ -97,6 +97,18 @@ void ColourFaderAffectorFX2::run( ParticleCpuData cpuData, const size_t numParti
     }
 }
 //-----------------------------------------------------------------------------
+bool ColourFaderAffectorFX2::getGpuParams( GpuParticleAffector &outParams ) const
+{
+    outParams.type = GpuParticleAffectorType::ColourFader;
+    for( size_t i = 0u; i < 4u; ++i )
+    {
+        outParams.params[i + 0u] = static_cast<float>( mColourAdj[i] );
+        outParams.params[i + 4u] = static_cast<float>( mMinColour[i] );
+        outParams.params[i + 8u] = static_cast<float>( mMaxColour[i] );
+    }
+    return true;
+}
+//-----------------------------------------------------------------------------
 void ColourFaderAffectorFX2::setMaxColour( const Vector4 &rgba )
 {
     mMaxColour = rgba;
@@ -42,65 +42,53 @@ void CylinderEmitter2::initEmittedParticles( ParticleCpuData cpuData, const Emit
                                              const size_t numParticles )
 {
     const Vector3 position = mPosition;
-    const Vector2 dimensions = mDimensions;
     const Vector3 xRange = mXRange;
     const Vector3 yRange = mYRange;
     const Vector3 zRange = mZRange;
 
-    for( size_t i = 0u; i < numParticles; ++i )
+    Vector3 localPos[ARRAY_PACKED_REALS];
+
+    size_t i = 0u;
+    while( i < numParticles )
     {
-        const size_t h = newHandles[i].handle;
-        const size_t j = h / ARRAY_PACKED_REALS;
-        const size_t idx = h % ARRAY_PACKED_REALS;
+        const size_t numInPack = getNextPackSize( newHandles + i, numParticles - i );
 
-        Real x, y, z;
+        for( size_t k = 0u; k < numInPack; ++k )
+        {
+            Real x, y, z;
 
-        // First we create a random point inside a bounding cylinder with a
-        // radius and height of 1 (this is easy to do). The distance of the
-        // point from 0,0,0 must be <= 1 (== 1 means on the surface and we
-        // count this as inside, too).
+            // First we create a random point inside a bounding cylinder with a
+            // radius and height of 1 (this is easy to do). The distance of the
+            // point from 0,0,0 must be <= 1 (== 1 means on the surface and we
+            // count this as inside, too).
 
-        while( true )
-        {
-            /* ClearSpace not yet implemeted
-
-            */
-            // three random values for one random point in 3D space
-            x = Math::SymmetricRandom();
-            y = Math::SymmetricRandom();
-            z = Math::SymmetricRandom();
-
-            // the distance of x,y from 0,0 is sqrt(x*x+y*y), but
-            // as usual we can omit the sqrt(), since sqrt(1) == 1 and we
-            // use the 1 as boundary. z is not taken into account, since
-            // all values in the z-direction are inside the cylinder:
-            if( x * x + y * y <= 1 )
+            while( true )
             {
-                break;  // found one valid point inside
+                /* ClearSpace not yet implemeted
+
+                */
+                // three random values for one random point in 3D space
+                x = Math::SymmetricRandom();
+                y = Math::SymmetricRandom();
+                z = Math::SymmetricRandom();
+
+                // the distance of x,y from 0,0 is sqrt(x*x+y*y), but
+                // as usual we can omit the sqrt(), since sqrt(1) == 1 and we
+                // use the 1 as boundary. z is not taken into account, since
+                // all values in the z-direction are inside the cylinder:
+                if( x * x + y * y <= 1 )
+                {
+                    break;  // found one valid point inside
+                }
             }
-        }
 
-        // scale the found point to the cylinder's size and move it
-        // relatively to the center of the emitter point
-        const Vector3 localPos = position + x * xRange + y * yRange + z * zRange;
-        cpuData.mPosition[j].setFromVector3( newHandles[i].pos + newHandles[i].rot * localPos, idx );
-        reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mRotation )[h] = 0.0f;
-
-        Vector3 direction;
-        this->genEmissionDirection( localPos, direction );
-        this->genEmissionVelocity( direction );
-        direction = newHandles[i].rot * direction;
-        cpuData.mDirection[j].setFromVector3( direction, idx );
-
-        cpuData.mDimensions[j].setFromVector2( dimensions, idx );
-
-        Ogre::ColourValue colour;
-        this->genEmissionColour( colour );
-        cpuData.mColour[j].setFromVector4( Vector4( colour.ptr() ), idx );
+            // scale the found point to the cylinder's size and move it
+            // relatively to the center of the emitter point
+            localPos[k] = position + x * xRange + y * yRange + z * zRange;
+        }
 
-        reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTimeToLive )[h] =
-            reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTotalTimeToLive )[h] =
-                this->genEmissionTTL();
+        initEmittedParticlesPack( cpuData, newHandles + i, localPos, numInPack );
+        i += numInPack;
     }
 }
 //-----------------------------------------------------------------------------------
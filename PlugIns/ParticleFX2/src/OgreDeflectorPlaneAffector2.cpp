@@ -124,6 +124,18 @@ void DeflectorPlaneAffector2::run( ParticleCpuData cpuData, const size_t numPart
     }
 }
 //-----------------------------------------------------------------------------
+bool DeflectorPlaneAffector2::getGpuParams( GpuParticleAffector &outParams ) const
+{
+    outParams.type = GpuParticleAffectorType::DeflectorPlane;
+    outParams.params[0] = static_cast<float>( mPlaneNormal.x );
+    outParams.params[1] = static_cast<float>( mPlaneNormal.y );
+    outParams.params[2] = static_cast<float>( mPlaneNormal.z );
+    outParams.params[3] = static_cast<float>( -mPlaneNormal.dotProduct( mPlanePoint ) /
+                                              Math::Sqrt( mPlaneNormal.dotProduct( mPlaneNormal ) ) );
+    outParams.params[4] = static_cast<float>( mBounce );
+    return true;
+}
+//-----------------------------------------------------------------------------
 void DeflectorPlaneAffector2::setPlanePoint( const Vector3 &pos )
 {
     mPlanePoint = pos;
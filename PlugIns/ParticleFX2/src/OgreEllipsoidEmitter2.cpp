@@ -49,62 +49,50 @@ void EllipsoidEmitter2::initEmittedParticles( ParticleCpuData cpuData, const Emi
                                               const size_t numParticles )
 {
     const Vector3 position = mPosition;
-    const Vector2 dimensions = mDimensions;
     const Vector3 xRange = mXRange;
     const Vector3 yRange = mYRange;
     const Vector3 zRange = mZRange;
 
-    for( size_t i = 0u; i < numParticles; ++i )
-    {
-        const size_t h = newHandles[i].handle;
-        const size_t j = h / ARRAY_PACKED_REALS;
-        const size_t idx = h % ARRAY_PACKED_REALS;
-
-        Real x, y, z;
+    Vector3 localPos[ARRAY_PACKED_REALS];
 
-        // First we create a random point inside a bounding sphere with a
-        // radius of 1 (this is easy to do). The distance of the point from
-        // 0,0,0 must be <= 1 (== 1 means on the surface and we count this as
-        // inside, too).
+    size_t i = 0u;
+    while( i < numParticles )
+    {
+        const size_t numInPack = getNextPackSize( newHandles + i, numParticles - i );
 
-        while( true )
+        for( size_t k = 0u; k < numInPack; ++k )
         {
-            // three random values for one random point in 3D space
+            Real x, y, z;
 
-            x = Math::SymmetricRandom();
-            y = Math::SymmetricRandom();
-            z = Math::SymmetricRandom();
+            // First we create a random point inside a bounding sphere with a
+            // radius of 1 (this is easy to do). The distance of the point from
+            // 0,0,0 must be <= 1 (== 1 means on the surface and we count this as
+            // inside, too).
 
-            // the distance of x,y,z from 0,0,0 is sqrt(x*x+y*y+z*z), but
-            // as usual we can omit the sqrt(), since sqrt(1) == 1 and we
-            // use the 1 as boundary:
-            if( x * x + y * y + z * z <= 1 )
+            while( true )
             {
-                break;  // found one valid point inside
+                // three random values for one random point in 3D space
+
+                x = Math::SymmetricRandom();
+                y = Math::SymmetricRandom();
+                z = Math::SymmetricRandom();
+
+                // the distance of x,y,z from 0,0,0 is sqrt(x*x+y*y+z*z), but
+                // as usual we can omit the sqrt(), since sqrt(1) == 1 and we
+                // use the 1 as boundary:
+                if( x * x + y * y + z * z <= 1 )
+                {
+                    break;  // found one valid point inside
+                }
             }
-        }
 
-        // scale the found point to the ellipsoid's size and move it
-        // relatively to the center of the emitter point
-        const Vector3 localPos = position + x * xRange + y * yRange + z * zRange;
-        cpuData.mPosition[j].setFromVector3( newHandles[i].pos + newHandles[i].rot * localPos, idx );
-        reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mRotation )[h] = 0.0f;
-
-        Vector3 direction;
-        this->genEmissionDirection( localPos, direction );
-        this->genEmissionVelocity( direction );
-        direction = newHandles[i].rot * direction;
-        cpuData.mDirection[j].setFromVector3( direction, idx );
-
-        cpuData.mDimensions[j].setFromVector2( dimensions, idx );
-
-        Ogre::ColourValue colour;
-        this->genEmissionColour( colour );
-        cpuData.mColour[j].setFromVector4( Vector4( colour.ptr() ), idx );
+            // scale the found point to the ellipsoid's size and move it
+            // relatively to the center of the emitter point
+            localPos[k] = position + x * xRange + y * yRange + z * zRange;
+        }
 
-        reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTimeToLive )[h] =
-            reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTotalTimeToLive )[h] =
-                this->genEmissionTTL();
+        initEmittedParticlesPack( cpuData, newHandles + i, localPos, numInPack );
+        i += numInPack;
     }
 }
 //-----------------------------------------------------------------------------------
@@ -78,61 +78,49 @@ void HollowEllipsoidEmitter2::initEmittedParticles( ParticleCpuData cpuData,
                                                     const size_t numParticles )
 {
     const Vector3 position = mPosition;
-    const Vector2 dimensions = mDimensions;
     const Vector3 xRange = mXRange;
     const Vector3 yRange = mYRange;
     const Vector3 zRange = mZRange;
 
-    for( size_t i = 0u; i < numParticles; ++i )
+    Vector3 localPos[ARRAY_PACKED_REALS];
+
+    size_t i = 0u;
+    while( i < numParticles )
     {
-        const size_t h = newHandles[i].handle;
-        const size_t j = h / ARRAY_PACKED_REALS;
-        const size_t idx = h % ARRAY_PACKED_REALS;
-
-        // create two random angles alpha and beta
-        // with these two angles, we are able to select any point on an
-        // ellipsoid's surface
-        Radian alpha( Math::RangeRandom( 0, Math::TWO_PI ) );
-        Radian beta( Math::RangeRandom( 0, Math::PI ) );
-
-        Real a, b, c, x, y, z;
-        // create three random radius values that are bigger than the inner
-        // size, but smaller/equal than/to the outer size 1.0 (inner size is
-        // between 0 and 1)
-        a = Math::RangeRandom( mInnerSize.x, 1.0 );
-        b = Math::RangeRandom( mInnerSize.y, 1.0 );
-        c = Math::RangeRandom( mInnerSize.z, 1.0 );
-
-        // with a,b,c we have defined a random ellipsoid between the inner
-        // ellipsoid and the outer sphere (radius 1.0)
-        // with alpha and beta we select on point on this random ellipsoid
-        // and calculate the 3D coordinates of this point
-        Real sinbeta( Math::Sin( beta ) );
-        x = a * Math::Cos( alpha ) * sinbeta;
-        y = b * Math::Sin( alpha ) * sinbeta;
-        z = c * Math::Cos( beta );
-
-        // scale the found point to the ellipsoid's size and move it
-        // relatively to the center of the emitter point
-        const Vector3 localPos = position + x * xRange + y * yRange + z * zRange;
-        cpuData.mPosition[j].setFromVector3( newHandles[i].pos + newHandles[i].rot * localPos, idx );
-        reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mRotation )[h] = 0.0f;
-
-        Vector3 direction;
-        this->genEmissionDirection( localPos, direction );
-        this->genEmissionVelocity( direction );
-        direction = newHandles[i].rot * direction;
-        cpuData.mDirection[j].setFromVector3( direction, idx );
-
-        cpuData.mDimensions[j].setFromVector2( dimensions, idx );
-
-        Ogre::ColourValue colour;
-        this->genEmissionColour( colour );
-        cpuData.mColour[j].setFromVector4( Vector4( colour.ptr() ), idx );
-
-        reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTimeToLive )[h] =
-            reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTotalTimeToLive )[h] =
-                this->genEmissionTTL();
+        const size_t numInPack = getNextPackSize( newHandles + i, numParticles - i );
+
+        for( size_t k = 0u; k < numInPack; ++k )
+        {
+            // create two random angles alpha and beta
+            // with these two angles, we are able to select any point on an
+            // ellipsoid's surface
+            Radian alpha( Math::RangeRandom( 0, Math::TWO_PI ) );
+            Radian beta( Math::RangeRandom( 0, Math::PI ) );
+
+            Real a, b, c, x, y, z;
+            // create three random radius values that are bigger than the inner
+            // size, but smaller/equal than/to the outer size 1.0 (inner size is
+            // between 0 and 1)
+            a = Math::RangeRandom( mInnerSize.x, 1.0 );
+            b = Math::RangeRandom( mInnerSize.y, 1.0 );
+            c = Math::RangeRandom( mInnerSize.z, 1.0 );
+
+            // with a,b,c we have defined a random ellipsoid between the inner
+            // ellipsoid and the outer sphere (radius 1.0)
+            // with alpha and beta we select on point on this random ellipsoid
+            // and calculate the 3D coordinates of this point
+            Real sinbeta( Math::Sin( beta ) );
+            x = a * Math::Cos( alpha ) * sinbeta;
+            y = b * Math::Sin( alpha ) * sinbeta;
+            z = c * Math::Cos( beta );
+
+            // scale the found point to the ellipsoid's size and move it
+            // relatively to the center of the emitter point
+            localPos[k] = position + x * xRange + y * yRange + z * zRange;
+        }
+
+        initEmittedParticlesPack( cpuData, newHandles + i, localPos, numInPack );
+        i += numInPack;
     }
 }
 //-----------------------------------------------------------------------------
@@ -80,6 +80,16 @@ void LinearForceAffector2::run( ParticleCpuData cpuData, const size_t numParticl
     }
 }
 //-----------------------------------------------------------------------------
+bool LinearForceAffector2::getGpuParams( GpuParticleAffector &outParams ) const
+{
+    outParams.type = mForceApplication == FA_ADD ? GpuParticleAffectorType::LinearForceAdd
+                                                 : GpuParticleAffectorType::LinearForceAverage;
+    outParams.params[0] = static_cast<float>( mForceVector.x );
+    outParams.params[1] = static_cast<float>( mForceVector.y );
+    outParams.params[2] = static_cast<float>( mForceVector.z );
+    return true;
+}
+//-----------------------------------------------------------------------------
 void LinearForceAffector2::setForceVector( const Vector3 &force )
 {
     mForceVector = force;
@@ -45,33 +45,17 @@ void PointEmitter2::initEmittedParticles( ParticleCpuData cpuData, const Emitted
                                           const size_t numParticles )
 {
     const Vector3 position = mPosition;
-    const Vector2 dimensions = mDimensions;
 
-    for( size_t i = 0u; i < numParticles; ++i )
-    {
-        const size_t h = newHandles[i].handle;
-        const size_t j = h / ARRAY_PACKED_REALS;
-        const size_t idx = h % ARRAY_PACKED_REALS;
-
-        const Vector3 localPos = position;
-        cpuData.mPosition[j].setFromVector3( newHandles[i].pos + newHandles[i].rot * localPos, idx );
-        reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mRotation )[h] = 0.0f;
-
-        Vector3 direction;
-        this->genEmissionDirection( localPos, direction );
-        this->genEmissionVelocity( direction );
-        direction = newHandles[i].rot * direction;
-        cpuData.mDirection[j].setFromVector3( direction, idx );
+    Vector3 localPos[ARRAY_PACKED_REALS];
+    for( size_t k = 0u; k < ARRAY_PACKED_REALS; ++k )
+        localPos[k] = position;
 
-        cpuData.mDimensions[j].setFromVector2( dimensions, idx );
-
-        Ogre::ColourValue colour;
-        this->genEmissionColour( colour );
-        cpuData.mColour[j].setFromVector4( Vector4( colour.ptr() ), idx );
-
-        reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTimeToLive )[h] =
-            reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTotalTimeToLive )[h] =
-                this->genEmissionTTL();
+    size_t i = 0u;
+    while( i < numParticles )
+    {
+        const size_t numInPack = getNextPackSize( newHandles + i, numParticles - i );
+        initEmittedParticlesPack( cpuData, newHandles + i, localPos, numInPack );
+        i += numInPack;
     }
 }
 //-----------------------------------------------------------------------------
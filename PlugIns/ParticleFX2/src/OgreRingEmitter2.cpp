@@ -64,55 +64,43 @@ void RingEmitter2::initEmittedParticles( ParticleCpuData cpuData, const EmittedP
                                          const size_t numParticles )
 {
     const Vector3 position = mPosition;
-    const Vector2 dimensions = mDimensions;
     const Vector3 xRange = mXRange;
     const Vector3 yRange = mYRange;
     const Vector3 zRange = mZRange;
 
-    for( size_t i = 0u; i < numParticles; ++i )
+    Vector3 localPos[ARRAY_PACKED_REALS];
+
+    size_t i = 0u;
+    while( i < numParticles )
     {
-        const size_t h = newHandles[i].handle;
-        const size_t j = h / ARRAY_PACKED_REALS;
-        const size_t idx = h % ARRAY_PACKED_REALS;
-
-        Real a, b, x, y, z;
-        // create a random angle from 0 .. PI*2
-        Radian alpha( Math::RangeRandom( 0, Math::TWO_PI ) );
-
-        // create two random radius values that are bigger than the inner size
-        a = Math::RangeRandom( mInnerSizex, 1.0 );
-        b = Math::RangeRandom( mInnerSizey, 1.0 );
-
-        // with a and b we have defined a random ellipse inside the inner
-        // ellipse and the outer circle (radius 1.0)
-        // with alpha, and a and b we select a random point on this ellipse
-        // and calculate it's coordinates
-        x = a * Math::Sin( alpha );
-        y = b * Math::Cos( alpha );
-        // the height is simple -1 to 1
-        z = Math::SymmetricRandom();
-
-        // scale the found point to the ring's size and move it
-        // relatively to the center of the emitter point
-        const Vector3 localPos = position + x * xRange + y * yRange + z * zRange;
-        cpuData.mPosition[j].setFromVector3( newHandles[i].pos + newHandles[i].rot * localPos, idx );
-        reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mRotation )[h] = 0.0f;
-
-        Vector3 direction;
-        this->genEmissionDirection( localPos, direction );
-        this->genEmissionVelocity( direction );
-        direction = newHandles[i].rot * direction;
-        cpuData.mDirection[j].setFromVector3( direction, idx );
-
-        cpuData.mDimensions[j].setFromVector2( dimensions, idx );
-
-        Ogre::ColourValue colour;
-        this->genEmissionColour( colour );
-        cpuData.mColour[j].setFromVector4( Vector4( colour.ptr() ), idx );
-
-        reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTimeToLive )[h] =
-            reinterpret_cast<Real * RESTRICT_ALIAS>( cpuData.mTotalTimeToLive )[h] =
-                this->genEmissionTTL();
+        const size_t numInPack = getNextPackSize( newHandles + i, numParticles - i );
+
+        for( size_t k = 0u; k < numInPack; ++k )
+        {
+            Real a, b, x, y, z;
+            // create a random angle from 0 .. PI*2
+            Radian alpha( Math::RangeRandom( 0, Math::TWO_PI ) );
+
+            // create two random radius values that are bigger than the inner size
+            a = Math::RangeRandom( mInnerSizex, 1.0 );
+            b = Math::RangeRandom( mInnerSizey, 1.0 );
+
+            // with a and b we have defined a random ellipse inside the inner
+            // ellipse and the outer circle (radius 1.0)
+            // with alpha, and a and b we select a random point on this ellipse
+            // and calculate it's coordinates
+            x = a * Math::Sin( alpha );
+            y = b * Math::Cos( alpha );
+            // the height is simple -1 to 1
+            z = Math::SymmetricRandom();
+
+            // scale the found point to the ring's size and move it
+            // relatively to the center of the emitter point
+            localPos[k] = position + x * xRange + y * yRange + z * zRange;
+        }
+
+        initEmittedParticlesPack( cpuData, newHandles + i, localPos, numInPack );
+        i += numInPack;
     }
 }
 //-----------------------------------------------------------------------------
@@ -109,6 +109,12 @@ void RotationAffector2::run( ParticleCpuData cpuData, const size_t numParticles,
     }
 }
 //-----------------------------------------------------------------------------
+bool RotationAffector2::getGpuParams( GpuParticleAffector &outParams ) const
+{
+    outParams.type = GpuParticleAffectorType::Rotation;
+    return true;
+}
+//-----------------------------------------------------------------------------
 const Radian &RotationAffector2::getRotationSpeedRangeStart() const
 {
     return mRotationSpeedRangeStart;
@@ -97,6 +97,17 @@ void ScaleInterpolatorAffector2::run( ParticleCpuData cpuData, const size_t numP
     }
 }
 //-----------------------------------------------------------------------------
+bool ScaleInterpolatorAffector2::getGpuParams( GpuParticleAffector &outParams ) const
+{
+    outParams.type = GpuParticleAffectorType::ScaleInterpolator;
+    for( size_t i = 0u; i < MAX_STAGES; ++i )
+    {
+        outParams.params[i] = static_cast<float>( Mathlib::Get0( mScaleAdj[i] ) );
+        outParams.params[i + MAX_STAGES] = static_cast<float>( Mathlib::Get0( mTimeAdj[i] ) );
+    }
+    return true;
+}
+//-----------------------------------------------------------------------------
 void ScaleInterpolatorAffector2::setScaleAdjust( size_t index, Real scale )
 {
     mScaleAdj[index] = Mathlib::SetAll( scale );
@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include "OgreD3D11Prerequisites.h"
 
+#include "Vao/OgreTlsfAllocator.h"
 #include "Vao/OgreVaoManager.h"
 
 namespace Ogre
@@ -53,34 +54,7 @@ namespace Ogre
 
             Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
         };
-        struct StrideChanger
-        {
-            size_t offsetAfterPadding;
-            size_t paddedBytes;
-
-            StrideChanger() : offsetAfterPadding( 0 ), paddedBytes( 0 ) {}
-            StrideChanger( size_t _offsetAfterPadding, size_t _paddedBytes ) :
-                offsetAfterPadding( _offsetAfterPadding ),
-                paddedBytes( _paddedBytes )
-            {
-            }
-
-            bool operator()( const StrideChanger &left, size_t right ) const
-            {
-                return left.offsetAfterPadding < right;
-            }
-            bool operator()( size_t left, const StrideChanger &right ) const
-            {
-                return left < right.offsetAfterPadding;
-            }
-            bool operator()( const StrideChanger &left, const StrideChanger &right ) const
-            {
-                return left.offsetAfterPadding < right.offsetAfterPadding;
-            }
-        };
-
-        typedef vector<Block>::type         BlockVec;
-        typedef vector<StrideChanger>::type StrideChangerVec;
+        typedef vector<Block>::type BlockVec;
 
     protected:
         struct Vbo
@@ -89,8 +63,7 @@ namespace Ogre
             size_t               sizeBytes;
             D3D11DynamicBuffer  *dynamicBuffer;  // Null for non BT_DYNAMIC_* BOs.
 
-            BlockVec         freeBlocks;
-            StrideChangerVec strideChangers;
+            TlsfAllocator allocator;
         };
 
         struct Vao
@@ -286,6 +259,8 @@ namespace Ogre
         void getMemoryStats( MemoryStatsEntryVec &outStats, size_t &outCapacityBytes,
                              size_t &outFreeBytes, Log *log, bool &outIncludesTextures ) const override;
 
+        void getMemoryPoolStats( MemoryPoolStatsVec &outStats ) const override;
+
         void cleanupEmptyPools() override;
 
         D3D11RenderSystem *getD3D11RenderSystem() const { return mD3D11RenderSystem; }
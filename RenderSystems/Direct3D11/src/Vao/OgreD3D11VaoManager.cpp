@@ -300,6 +300,8 @@ namespace Ogre
         if( log )
             log->logMessage( "Pool Type;Offset;Size Bytes;Pool Idx;Pool Capacity", LML_CRITICAL );
 
+        TlsfAllocator::BlockVec usedBlocks;
+
         for( uint32 idx0 = 0; idx0 < NumInternalBufferTypes; ++idx0 )
         {
             for( uint32 idx1 = 0; idx1 < BT_DYNAMIC_DEFAULT + 1; ++idx1 )
@@ -313,56 +315,26 @@ namespace Ogre
                     const size_t poolIdx = static_cast<size_t>( itor - mVbos[idx0][idx1].begin() );
                     capacityBytes += vbo.sizeBytes;
 
-                    Block usedBlock( 0, 0 );
+                    freeBytes += vbo.allocator.getFreeBytes();
+
+                    usedBlocks.clear();
+                    vbo.allocator.getUsedBlocks( usedBlocks );
 
-                    BlockVec freeBlocks = vbo.freeBlocks;
-                    while( !freeBlocks.empty() )
+                    TlsfAllocator::BlockVec::const_iterator itBlock = usedBlocks.begin();
+                    TlsfAllocator::BlockVec::const_iterator enBlock = usedBlocks.end();
+
+                    while( itBlock != enBlock )
                     {
-                        // Find the free block that comes next
-                        BlockVec::iterator nextBlock;
-                        {
-                            BlockVec::iterator itBlock = freeBlocks.begin();
-                            BlockVec::iterator enBlock = freeBlocks.end();
-
-                            nextBlock = itBlock;
-
-                            while( itBlock != enBlock )
-                            {
-                                if( itBlock->offset < nextBlock->offset )
-                                    nextBlock = itBlock;
-                                ++itBlock;
-                            }
-                        }
-
-                        freeBytes += nextBlock->size;
-                        usedBlock.size = nextBlock->offset - usedBlock.offset;
-
-                        // usedBlock.size could be 0 if:
-                        //  1. All of memory is free
-                        //  2. There's two contiguous free blocks, which should not happen
-                        //     due to mergeContiguousBlocks
-                        if( usedBlock.size > 0u )
-                        {
-                            getMemoryStats( usedBlock, idx0, idx1, poolIdx, vbo.sizeBytes, text,
-                                            statsVec, log );
-                        }
-
-                        usedBlock.offset += usedBlock.size;
-                        usedBlock.size = 0;
-                        efficientVectorRemove( freeBlocks, nextBlock );
+                        getMemoryStats( Block( itBlock->offset, itBlock->size ), idx0, idx1, poolIdx,
+                                        vbo.sizeBytes, text, statsVec, log );
+                        ++itBlock;
                     }
 
-                    if( usedBlock.size > 0u || ( usedBlock.offset == 0 && usedBlock.size == 0 ) )
+                    // Keep reporting entirely free pools
+                    if( usedBlocks.empty() )
                     {
-                        if( vbo.freeBlocks.empty() )
-                        {
-                            // Deal with edge case when we're 100% full
-                            OGRE_ASSERT_LOW( usedBlock.offset == 0 && usedBlock.size == 0 );
-                            usedBlock.offset = 0u;
-                            usedBlock.size = vbo.sizeBytes;
-                        }
-                        getMemoryStats( usedBlock, idx0, idx1, poolIdx, vbo.sizeBytes, text, statsVec,
-                                        log );
+                        getMemoryStats( Block( 0, 0 ), idx0, idx1, poolIdx, vbo.sizeBytes, text,
+                                        statsVec, log );
                     }
 
                     ++itor;
@@ -374,6 +346,62 @@ namespace Ogre
         outFreeBytes = freeBytes;
         outIncludesTextures = false;
         statsVec.swap( outStats );
+
+        if( log )
+        {
+            log->logMessage( "Pool Type;Pool Idx;Free Bytes;Largest Free Block;Free Blocks;"
+                             "Fragmentation",
+                             LML_CRITICAL );
+
+            MemoryPoolStatsVec poolStats;
+            getMemoryPoolStats( poolStats );
+
+            MemoryPoolStatsVec::const_iterator itor = poolStats.begin();
+            MemoryPoolStatsVec::const_iterator endt = poolStats.end();
+
+            while( itor != endt )
+            {
+                text.clear();
+                text.a( c_vboTypes[itor->poolType >> 16u][itor->poolType & 0xFFFF], ";",
+                        itor->poolIdx, ";", (uint64)itor->freeBytes, ";" );
+                text.a( (uint64)itor->largestFreeBlock, ";", (uint64)itor->numFreeBlocks, ";",
+                        LwString::Float( itor->getFragmentation(), 3 ) );
+                log->logMessage( text.c_str(), LML_CRITICAL );
+                ++itor;
+            }
+
+            logDynamicUploadRingStats( log );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void D3D11VaoManager::getMemoryPoolStats( MemoryPoolStatsVec &outStats ) const
+    {
+        outStats.clear();
+
+        for( uint32 idx0 = 0; idx0 < NumInternalBufferTypes; ++idx0 )
+        {
+            for( uint32 idx1 = 0; idx1 < BT_DYNAMIC_DEFAULT + 1; ++idx1 )
+            {
+                VboVec::const_iterator itor = mVbos[idx0][idx1].begin();
+                VboVec::const_iterator endt = mVbos[idx0][idx1].end();
+
+                while( itor != endt )
+                {
+                    TlsfAllocator::Stats allocStats;
+                    itor->allocator.getStats( allocStats );
+
+                    MemoryPoolStats poolStats( ( idx0 << 16u ) | ( idx1 & 0xFFFF ),
+                                               uint32( itor - mVbos[idx0][idx1].begin() ),
+                                               itor->sizeBytes, false );
+                    poolStats.freeBytes = allocStats.freeBytes;
+                    poolStats.largestFreeBlock = allocStats.largestFreeBlock;
+                    poolStats.numFreeBlocks = allocStats.numFreeBlocks;
+                    outStats.push_back( poolStats );
+
+                    ++itor;
+                }
+            }
+        }
     }
     //-----------------------------------------------------------------------------------
     void D3D11VaoManager::switchVboPoolIndexImpl( unsigned internalVboBufferType, size_t oldPoolIdx,
@@ -419,7 +447,7 @@ namespace Ogre
                 while( itor != end )
                 {
                     Vbo &vbo = *itor;
-                    if( vbo.freeBlocks.size() == 1u && vbo.sizeBytes == vbo.freeBlocks.back().size )
+                    if( vbo.allocator.isEmpty() )
                     {
                         vbo.vboName.Reset();
                         delete vbo.dynamicBuffer;
@@ -459,49 +487,23 @@ namespace Ogre
             sizeBytes *= mDynamicBufferMultiplier;
         }
 
-        VboVec::const_iterator itor = mVbos[internalType][bufferType].begin();
-        VboVec::const_iterator end = mVbos[internalType][bufferType].end();
+        VboVec::iterator itor = mVbos[internalType][bufferType].begin();
+        VboVec::iterator end = mVbos[internalType][bufferType].end();
 
-        // Find a suitable VBO that can hold the requested size. We prefer those free
-        // blocks that have a matching stride (the current offset is a multiple of
-        // bytesPerElement) in order to minimize the amount of memory padding.
+        // Find a suitable VBO that can hold the requested size.
         size_t bestVboIdx = std::numeric_limits<size_t>::max();
-        ptrdiff_t bestBlockIdx = -1;
-        bool foundMatchingStride = false;
+        size_t bufferOffset = 0;
 
-        while( itor != end && !foundMatchingStride )
+        while( itor != end && bestVboIdx == std::numeric_limits<size_t>::max() )
         {
-            BlockVec::const_iterator blockIt = itor->freeBlocks.begin();
-            BlockVec::const_iterator blockEn = itor->freeBlocks.end();
-
-            while( blockIt != blockEn && !foundMatchingStride )
-            {
-                const Block &block = *blockIt;
-
-                // Round to next multiple of alignment
-                size_t newOffset = ( ( block.offset + alignment - 1 ) / alignment ) * alignment;
-                size_t padding = newOffset - block.offset;
-
-                if( sizeBytes + padding <= block.size )
-                {
-                    bestVboIdx = static_cast<size_t>( itor - mVbos[internalType][bufferType].begin() );
-                    bestBlockIdx = blockIt - itor->freeBlocks.begin();
-
-                    if( newOffset == block.offset )
-                        foundMatchingStride = true;
-                }
-
-                ++blockIt;
-            }
-
+            if( itor->allocator.allocate( sizeBytes, alignment, bufferOffset ) )
+                bestVboIdx = static_cast<size_t>( itor - mVbos[internalType][bufferType].begin() );
             ++itor;
         }
 
-        if( bestBlockIdx == -1 )
+        if( bestVboIdx == std::numeric_limits<size_t>::max() )
         {
             bestVboIdx = mVbos[internalType][bufferType].size();
-            bestBlockIdx = 0;
-            foundMatchingStride = true;
 
             Vbo newVbo;
 
@@ -544,9 +546,14 @@ namespace Ogre
             }
 
             newVbo.sizeBytes = poolSize;
-            newVbo.freeBlocks.push_back( Block( 0, poolSize ) );
+            newVbo.allocator.reset( poolSize );
             newVbo.dynamicBuffer = 0;
 
+            // A brand new pool always starts at offset 0, which satisfies any alignment.
+            // allocate() may reject an exact fit since it rounds up to the next size class
+            newVbo.allocator.allocateAt( 0u, sizeBytes );
+            bufferOffset = 0u;
+
             if( bufferType >= BT_DYNAMIC_DEFAULT )
             {
                 newVbo.dynamicBuffer =
@@ -556,32 +563,11 @@ namespace Ogre
             mVbos[internalType][bufferType].push_back( newVbo );
         }
 
-        Vbo &bestVbo = mVbos[internalType][bufferType][bestVboIdx];
-        Block &bestBlock = bestVbo.freeBlocks[static_cast<size_t>( bestBlockIdx )];
-
-        size_t newOffset = ( ( bestBlock.offset + alignment - 1 ) / alignment ) * alignment;
-        size_t padding = newOffset - bestBlock.offset;
-        // Shrink our records about available data.
-        bestBlock.size -= sizeBytes + padding;
-        bestBlock.offset = newOffset + sizeBytes;
-
-        if( !foundMatchingStride )
-        {
-            // This is a stride changer, record as such.
-            StrideChangerVec::iterator itStride =
-                std::lower_bound( bestVbo.strideChangers.begin(), bestVbo.strideChangers.end(),
-                                  newOffset, StrideChanger() );
-            bestVbo.strideChangers.insert( itStride, StrideChanger( newOffset, padding ) );
-        }
-
-        if( bestBlock.size == 0 )
-            bestVbo.freeBlocks.erase( bestVbo.freeBlocks.begin() + bestBlockIdx );
-
         // To trace allocations in VS you can add conditional breakpoint with following action:
         // allocateVbo[{(int)internalType}][{(int)bufferType}][{bestVboIdx}] => bufferOffset =
-        // {newOffset}, sizeBytes = {sizeBytes}+{padding} at $CALLSTACK
+        // {bufferOffset}, sizeBytes = {sizeBytes} at $CALLSTACK
         outVboIdx = bestVboIdx;
-        outBufferOffset = newOffset;
+        outBufferOffset = bufferOffset;
     }
     //-----------------------------------------------------------------------------------
     void D3D11VaoManager::deallocateVbo( size_t vboIdx, size_t bufferOffset, size_t sizeBytes,
@@ -594,22 +580,9 @@ namespace Ogre
         }
 
         Vbo &vbo = mVbos[internalType][bufferType][vboIdx];
-        StrideChangerVec::iterator itStride = std::lower_bound(
-            vbo.strideChangers.begin(), vbo.strideChangers.end(), bufferOffset, StrideChanger() );
-
-        if( itStride != vbo.strideChangers.end() && itStride->offsetAfterPadding == bufferOffset )
-        {
-            bufferOffset -= itStride->paddedBytes;
-            sizeBytes += itStride->paddedBytes;
-
-            vbo.strideChangers.erase( itStride );
-        }
-
-        // See if we're contiguous to a free block and make that block grow.
-        vbo.freeBlocks.push_back( Block( bufferOffset, sizeBytes ) );
-        mergeContiguousBlocks( vbo.freeBlocks.end() - 1, vbo.freeBlocks );
+        vbo.allocator.deallocate( bufferOffset, sizeBytes );
 
-        if( vbo.freeBlocks.back().size == vbo.sizeBytes && bufferType == BT_IMMUTABLE )
+        if( vbo.allocator.isEmpty() && bufferType == BT_IMMUTABLE )
         {
             // Immutable buffer is empty. It can't be filled again. Release the GPU memory.
             // The vbo is not removed from mVbos since that would alter the index of other
@@ -663,7 +636,6 @@ namespace Ogre
         }
 
         inOutVbo.sizeBytes = poolSize;
-        inOutVbo.freeBlocks.clear();  // No free blocks
         inOutVbo.dynamicBuffer = 0;
 
         mVbos[internalType][BT_IMMUTABLE].push_back( inOutVbo );
@@ -870,6 +842,8 @@ namespace Ogre
                     reinterpret_cast<uint8 *>( OGRE_MALLOC_SIMD( totalBytes, MEMCATEGORY_GEOMETRY ) );
                 size_t dstOffset = 0;
 
+                newVbo.allocator.reset( totalBytes );
+
                 // Merge the binary data as a contiguous array
                 itor = start;
                 while( itor != end )
@@ -877,19 +851,12 @@ namespace Ogre
                     D3D11BufferInterface *bufferInterface =
                         static_cast<D3D11BufferInterface *>( ( *itor )->getBufferInterface() );
 
-                    const size_t dstOffsetBeforeAlignment = dstOffset;
                     dstOffset =
                         alignToNextMultiple<size_t>( dstOffset, ( *itor )->getBytesPerElement() );
 
-                    if( dstOffsetBeforeAlignment != dstOffset )
-                    {
-                        // This is a stride changer, record as such.
-                        StrideChangerVec::iterator itStride =
-                            std::lower_bound( newVbo.strideChangers.begin(), newVbo.strideChangers.end(),
-                                              dstOffset, StrideChanger() );
-                        const size_t padding = dstOffset - dstOffsetBeforeAlignment;
-                        newVbo.strideChangers.insert( itStride, StrideChanger( dstOffset, padding ) );
-                    }
+                    // The padding in between stays free in the allocator. The pool is
+                    // immutable so it never gets handed out again.
+                    newVbo.allocator.allocateAt( dstOffset, ( *itor )->getTotalSizeBytes() );
 
                     memcpy( mergedData + dstOffset, bufferInterface->_getInitialData(),
                             ( *itor )->getTotalSizeBytes() );
@@ -68,6 +68,10 @@ namespace Ogre
 
         void _setVboPoolIndex( size_t newVboPool ) { mVboPoolIdx = newVboPool; }
 
+        /// Points the buffer to a new location after its contents were moved by
+        /// GL3PlusVaoManager::relocateBufferImpl. Not valid for dynamic buffers.
+        void _relocate( size_t vboPoolIdx, GLuint vboName, size_t internalBufferStartBytes );
+
         /// Only use this function for the first upload
         void _firstUpload( void *data, size_t elementStart, size_t elementCount );
 
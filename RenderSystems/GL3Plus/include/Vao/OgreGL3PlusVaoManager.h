@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgreGL3PlusPrerequisites.h"
 
 #include "OgrePixelFormatGpu.h"
+#include "Vao/OgreTlsfAllocator.h"
 #include "Vao/OgreVaoManager.h"
 
 namespace Ogre
@@ -56,34 +57,7 @@ namespace Ogre
 
             Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
         };
-        struct StrideChanger
-        {
-            size_t offsetAfterPadding;
-            size_t paddedBytes;
-
-            StrideChanger() : offsetAfterPadding( 0 ), paddedBytes( 0 ) {}
-            StrideChanger( size_t _offsetAfterPadding, size_t _paddedBytes ) :
-                offsetAfterPadding( _offsetAfterPadding ),
-                paddedBytes( _paddedBytes )
-            {
-            }
-
-            bool operator()( const StrideChanger &left, size_t right ) const
-            {
-                return left.offsetAfterPadding < right;
-            }
-            bool operator()( size_t left, const StrideChanger &right ) const
-            {
-                return left < right.offsetAfterPadding;
-            }
-            bool operator()( const StrideChanger &left, const StrideChanger &right ) const
-            {
-                return left.offsetAfterPadding < right.offsetAfterPadding;
-            }
-        };
-
-        typedef vector<Block>::type         BlockVec;
-        typedef vector<StrideChanger>::type StrideChangerVec;
+        typedef vector<Block>::type BlockVec;
 
     protected:
         struct Vbo
@@ -92,8 +66,7 @@ namespace Ogre
             size_t                sizeBytes;
             GL3PlusDynamicBuffer *dynamicBuffer;  // Null for CPU_INACCESSIBLE BOs.
 
-            BlockVec         freeBlocks;
-            StrideChangerVec strideChangers;
+            TlsfAllocator allocator;
         };
 
         struct Vao
@@ -238,6 +211,15 @@ namespace Ogre
 
         GLuint createVao( const Vao &vaoRef );
 
+        /// Finds an existing GL VAO matching the given parameters, or creates a new one.
+        /// Increases the refCount of the returned entry.
+        VaoVec::iterator findOrCreateVao( const VertexBufferPackedVec &vertexBuffers,
+                                          IndexBufferPacked *indexBuffer, OperationType opType );
+        /// Decreases the refCount of the GL VAO, destroying it if it reaches 0
+        void releaseVao( GLuint vaoName );
+
+        static uint32 generateRenderQueueId( GLuint vaoName, uint32 uniqueVaoId );
+
         VertexArrayObject *createVertexArrayObjectImpl( const VertexBufferPackedVec &vertexBuffers,
                                                         IndexBufferPacked           *indexBuffer,
                                                         OperationType                opType ) override;
@@ -253,6 +235,11 @@ namespace Ogre
         void switchVboPoolIndexImpl( unsigned internalVboBufferType, size_t oldPoolIdx,
                                      size_t newPoolIdx, BufferPacked *buffer ) override;
 
+        bool getBufferPool( const BufferPacked *buffer, uint32 &outPoolType,
+                            uint32 &outPoolIdx ) const override;
+        bool relocateBufferImpl( BufferPacked *buffer, uint32 poolType, uint32 srcPoolIdx ) override;
+        void refreshVertexArrayObjectImpl( VertexArrayObject *vao ) override;
+
     public:
         GL3PlusVaoManager( bool supportsArbBufferStorage, bool emulateTexBuffers,
                            bool supportsIndirectBuffers, bool _supportsBaseInstance, bool supportsSsbo,
@@ -262,6 +249,8 @@ namespace Ogre
         void getMemoryStats( MemoryStatsEntryVec &outStats, size_t &outCapacityBytes,
                              size_t &outFreeBytes, Log *log, bool &outIncludesTextures ) const override;
 
+        void getMemoryPoolStats( MemoryPoolStatsVec &outStats ) const override;
+
         void cleanupEmptyPools() override;
 
         /// Binds the Draw ID to the currently bound vertex array object.
@@ -73,6 +73,13 @@ namespace Ogre
                 break;
             }
         }
+
+        /// The GL VAO changed because its buffers were relocated by the GL3PlusVaoManager
+        void _updateVaoName( GLuint vaoName, uint32 renderQueueId )
+        {
+            mVaoName = vaoName;
+            mRenderQueueId = renderQueueId;
+        }
     };
 }  // namespace Ogre
 
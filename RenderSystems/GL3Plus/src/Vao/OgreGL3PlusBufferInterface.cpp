@@ -59,6 +59,19 @@ namespace Ogre
         mBuffer->mBufferType = originalBufferType;
     }
     //-----------------------------------------------------------------------------------
+    void GL3PlusBufferInterface::_relocate( size_t vboPoolIdx, GLuint vboName,
+                                            size_t internalBufferStartBytes )
+    {
+        OGRE_ASSERT_LOW( mBuffer->mBufferType < BT_DYNAMIC_DEFAULT && !mDynamicBuffer &&
+                         "Dynamic buffers can't be relocated!" );
+        OGRE_ASSERT_LOW( internalBufferStartBytes % mBuffer->mBytesPerElement == 0u );
+
+        mVboPoolIdx = vboPoolIdx;
+        mVboName = vboName;
+        mBuffer->mInternalBufferStart = internalBufferStartBytes / mBuffer->mBytesPerElement;
+        mBuffer->mFinalBufferStart = mBuffer->mInternalBufferStart;
+    }
+    //-----------------------------------------------------------------------------------
     void *RESTRICT_ALIAS_RETURN GL3PlusBufferInterface::map( size_t elementStart, size_t elementCount,
                                                              MappingState prevMappingState,
                                                              bool bAdvanceFrame )
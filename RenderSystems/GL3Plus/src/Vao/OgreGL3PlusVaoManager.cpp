@@ -58,6 +58,9 @@ namespace Ogre
     extern const GLuint64 kOneSecondInNanoSeconds;
     const GLuint64 kOneSecondInNanoSeconds = 1000000000;
 
+    /// Number of bits from the GL VAO name that go into the RenderQueue ID
+    static const int c_bitsVaoGl = 5;
+
     const GLuint GL3PlusVaoManager::VERTEX_ATTRIBUTE_INDEX[VES_COUNT] = {
         0,  // VES_POSITION - 1
         3,  // VES_BLEND_WEIGHTS - 1
@@ -104,6 +107,8 @@ namespace Ogre
             mDefaultPoolSize[i] = 4 * 1024 * 1024;
         mDefaultPoolSize[CPU_ACCESSIBLE_PERSISTENT] = 16 * 1024 * 1024;
 
+        mSupportsBufferRelocation = true;
+
         if( params )
         {
             for( size_t i = 0; i < MAX_VBO_FLAG; ++i )
@@ -283,6 +288,8 @@ namespace Ogre
         if( log )
             log->logMessage( "Pool Type;Offset;Size Bytes;Pool Idx;Pool Capacity", LML_CRITICAL );
 
+        TlsfAllocator::BlockVec usedBlocks;
+
         for( unsigned vboIdx = 0; vboIdx < MAX_VBO_FLAG; ++vboIdx )
         {
             VboVec::const_iterator itor = mVbos[vboIdx].begin();
@@ -294,64 +301,86 @@ namespace Ogre
                 const size_t poolIdx = static_cast<size_t>( itor - mVbos[vboIdx].begin() );
                 capacityBytes += vbo.sizeBytes;
 
-                Block usedBlock( 0, 0 );
-
-                BlockVec freeBlocks = vbo.freeBlocks;
-                while( !freeBlocks.empty() )
-                {
-                    // Find the free block that comes next
-                    BlockVec::iterator nextBlock;
-                    {
-                        BlockVec::iterator itBlock = freeBlocks.begin();
-                        BlockVec::iterator enBlock = freeBlocks.end();
-
-                        nextBlock = itBlock;
+                freeBytes += vbo.allocator.getFreeBytes();
 
-                        while( itBlock != enBlock )
-                        {
-                            if( itBlock->offset < nextBlock->offset )
-                                nextBlock = itBlock;
-                            ++itBlock;
-                        }
-                    }
+                usedBlocks.clear();
+                vbo.allocator.getUsedBlocks( usedBlocks );
 
-                    freeBytes += nextBlock->size;
-                    usedBlock.size = nextBlock->offset - usedBlock.offset;
+                TlsfAllocator::BlockVec::const_iterator itBlock = usedBlocks.begin();
+                TlsfAllocator::BlockVec::const_iterator enBlock = usedBlocks.end();
 
-                    // usedBlock.size could be 0 if:
-                    //  1. All of memory is free
-                    //  2. There's two contiguous free blocks, which should not happen
-                    //     due to mergeContiguousBlocks
-                    if( usedBlock.size > 0u )
-                    {
-                        getMemoryStats( usedBlock, vboIdx, poolIdx, vbo.sizeBytes, text, statsVec, log );
-                    }
-
-                    usedBlock.offset += usedBlock.size;
-                    usedBlock.size = 0;
-                    efficientVectorRemove( freeBlocks, nextBlock );
-                }
-
-                if( usedBlock.size > 0u || ( usedBlock.offset == 0 && usedBlock.size == 0 ) )
+                while( itBlock != enBlock )
                 {
-                    if( vbo.freeBlocks.empty() )
-                    {
-                        // Deal with edge case when we're 100% full
-                        OGRE_ASSERT_LOW( usedBlock.offset == 0 && usedBlock.size == 0 );
-                        usedBlock.offset = 0u;
-                        usedBlock.size = vbo.sizeBytes;
-                    }
-                    getMemoryStats( usedBlock, vboIdx, poolIdx, vbo.sizeBytes, text, statsVec, log );
+                    getMemoryStats( Block( itBlock->offset, itBlock->size ), vboIdx, poolIdx,
+                                    vbo.sizeBytes, text, statsVec, log );
+                    ++itBlock;
                 }
 
+                // Keep reporting entirely free pools
+                if( usedBlocks.empty() )
+                    getMemoryStats( Block( 0, 0 ), vboIdx, poolIdx, vbo.sizeBytes, text, statsVec, log );
+
                 ++itor;
             }
         }
 
+        if( log )
+            logDynamicUploadRingStats( log );
+
         outCapacityBytes = capacityBytes;
         outFreeBytes = freeBytes;
         outIncludesTextures = false;
         statsVec.swap( outStats );
+
+        if( log )
+        {
+            log->logMessage( "Pool Type;Pool Idx;Free Bytes;Largest Free Block;Free Blocks;"
+                             "Fragmentation",
+                             LML_CRITICAL );
+
+            MemoryPoolStatsVec poolStats;
+            getMemoryPoolStats( poolStats );
+
+            MemoryPoolStatsVec::const_iterator itor = poolStats.begin();
+            MemoryPoolStatsVec::const_iterator endt = poolStats.end();
+
+            while( itor != endt )
+            {
+                text.clear();
+                text.a( c_vboTypes[itor->poolType], ";", itor->poolIdx, ";",
+                        (uint64)itor->freeBytes, ";" );
+                text.a( (uint64)itor->largestFreeBlock, ";", (uint64)itor->numFreeBlocks, ";",
+                        LwString::Float( itor->getFragmentation(), 3 ) );
+                log->logMessage( text.c_str(), LML_CRITICAL );
+                ++itor;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GL3PlusVaoManager::getMemoryPoolStats( MemoryPoolStatsVec &outStats ) const
+    {
+        outStats.clear();
+
+        for( unsigned vboIdx = 0; vboIdx < MAX_VBO_FLAG; ++vboIdx )
+        {
+            VboVec::const_iterator itor = mVbos[vboIdx].begin();
+            VboVec::const_iterator endt = mVbos[vboIdx].end();
+
+            while( itor != endt )
+            {
+                TlsfAllocator::Stats allocStats;
+                itor->allocator.getStats( allocStats );
+
+                MemoryPoolStats poolStats( vboIdx, uint32( itor - mVbos[vboIdx].begin() ),
+                                           itor->sizeBytes, false );
+                poolStats.freeBytes = allocStats.freeBytes;
+                poolStats.largestFreeBlock = allocStats.largestFreeBlock;
+                poolStats.numFreeBlocks = allocStats.numFreeBlocks;
+                outStats.push_back( poolStats );
+
+                ++itor;
+            }
+        }
     }
     //-----------------------------------------------------------------------------------
     void GL3PlusVaoManager::switchVboPoolIndexImpl( unsigned internalVboBufferType, size_t oldPoolIdx,
@@ -370,6 +399,88 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    bool GL3PlusVaoManager::getBufferPool( const BufferPacked *buffer, uint32 &outPoolType,
+                                           uint32 &outPoolIdx ) const
+    {
+        // mDrawId is bound to every VAO behind the scenes; it must stay put
+        if( buffer == mDrawId || buffer->getBufferType() >= BT_DYNAMIC_DEFAULT )
+            return false;
+
+        GL3PlusBufferInterface *bufferInterface =
+            static_cast<GL3PlusBufferInterface *>( buffer->getBufferInterface() );
+        outPoolType = bufferTypeToVboFlag( buffer->getBufferType() );
+        outPoolIdx = static_cast<uint32>( bufferInterface->getVboPoolIndex() );
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    bool GL3PlusVaoManager::relocateBufferImpl( BufferPacked *buffer, uint32 poolType,
+                                                uint32 srcPoolIdx )
+    {
+        OGRE_ASSERT_LOW( poolType == CPU_INACCESSIBLE );
+
+        VboVec &vbos = mVbos[poolType];
+
+        // Try the fullest pools first, so the emptiest ones are the next to be released
+        typedef std::pair<size_t, size_t> FreeBytesAndPoolIdx;
+        vector<FreeBytesAndPoolIdx>::type dstPools;
+        dstPools.reserve( vbos.size() );
+        for( size_t i = 0u; i < vbos.size(); ++i )
+        {
+            if( i != srcPoolIdx )
+                dstPools.push_back( FreeBytesAndPoolIdx( vbos[i].allocator.getFreeBytes(), i ) );
+        }
+        std::sort( dstPools.begin(), dstPools.end() );
+
+        const size_t sizeBytes = buffer->_getInternalTotalSizeBytes();
+        const size_t srcOffset = buffer->_getInternalBufferStart() * buffer->getBytesPerElement();
+
+        vector<FreeBytesAndPoolIdx>::type::const_iterator itor = dstPools.begin();
+        vector<FreeBytesAndPoolIdx>::type::const_iterator endt = dstPools.end();
+
+        while( itor != endt )
+        {
+            const size_t dstPoolIdx = itor->second;
+            size_t dstOffset;
+            if( vbos[dstPoolIdx].allocator.allocate( sizeBytes, buffer->getBytesPerElement(),
+                                                     dstOffset ) )
+            {
+                OCGE( glBindBuffer( GL_COPY_READ_BUFFER, vbos[srcPoolIdx].vboName ) );
+                OCGE( glBindBuffer( GL_COPY_WRITE_BUFFER, vbos[dstPoolIdx].vboName ) );
+                OCGE( glCopyBufferSubData( GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                           static_cast<GLintptr>( srcOffset ),
+                                           static_cast<GLintptr>( dstOffset ),
+                                           static_cast<GLsizeiptr>( sizeBytes ) ) );
+
+                // GL serializes commands: anything still reading from the old region
+                // was issued before the copy, and anything that gets to reuse it comes after.
+                vbos[srcPoolIdx].allocator.deallocate( srcOffset, sizeBytes );
+
+                GL3PlusBufferInterface *bufferInterface =
+                    static_cast<GL3PlusBufferInterface *>( buffer->getBufferInterface() );
+                bufferInterface->_relocate( dstPoolIdx, vbos[dstPoolIdx].vboName, dstOffset );
+                return true;
+            }
+            ++itor;
+        }
+
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
+    void GL3PlusVaoManager::refreshVertexArrayObjectImpl( VertexArrayObject *vao )
+    {
+        GL3PlusVertexArrayObject *glVao = static_cast<GL3PlusVertexArrayObject *>( vao );
+
+        // Acquire the new one before releasing the old one, in case they're the same
+        VaoVec::const_iterator itor = findOrCreateVao( vao->getVertexBuffers(),
+                                                       vao->getIndexBuffer(), vao->getOperationType() );
+        const GLuint newVaoName = itor->vaoName;
+        releaseVao( glVao->getVaoName() );
+
+        const uint32 maskVao = OGRE_RQ_MAKE_MASK( RqBits::MeshBits - c_bitsVaoGl );
+        glVao->_updateVaoName( newVaoName, generateRenderQueueId(
+                                               newVaoName, glVao->getRenderQueueId() & maskVao ) );
+    }
+    //-----------------------------------------------------------------------------------
     void GL3PlusVaoManager::cleanupEmptyPools()
     {
         FastArray<GLuint> bufferNames;
@@ -382,7 +493,7 @@ namespace Ogre
             while( itor != end )
             {
                 Vbo &vbo = *itor;
-                if( vbo.freeBlocks.size() == 1u && vbo.sizeBytes == vbo.freeBlocks.back().size )
+                if( vbo.allocator.isEmpty() )
                 {
 #if OGRE_DEBUG_MODE >= OGRE_DEBUG_LOW
                     VaoVec::const_iterator itVao = mVaos.begin();
@@ -445,49 +556,23 @@ namespace Ogre
         if( bufferType >= BT_DYNAMIC_DEFAULT )
             sizeBytes *= mDynamicBufferMultiplier;
 
-        VboVec::const_iterator itor = mVbos[vboFlag].begin();
-        VboVec::const_iterator end = mVbos[vboFlag].end();
+        VboVec::iterator itor = mVbos[vboFlag].begin();
+        VboVec::iterator end = mVbos[vboFlag].end();
 
-        // Find a suitable VBO that can hold the requested size. We prefer those free
-        // blocks that have a matching stride (the current offset is a multiple of
-        // bytesPerElement) in order to minimize the amount of memory padding.
+        // Find a suitable VBO that can hold the requested size.
         size_t bestVboIdx = std::numeric_limits<size_t>::max();
-        ptrdiff_t bestBlockIdx = -1;
-        bool foundMatchingStride = false;
+        size_t bufferOffset = 0;
 
-        while( itor != end && !foundMatchingStride )
+        while( itor != end && bestVboIdx == std::numeric_limits<size_t>::max() )
         {
-            BlockVec::const_iterator blockIt = itor->freeBlocks.begin();
-            BlockVec::const_iterator blockEn = itor->freeBlocks.end();
-
-            while( blockIt != blockEn && !foundMatchingStride )
-            {
-                const Block &block = *blockIt;
-
-                // Round to next multiple of alignment
-                size_t newOffset = ( ( block.offset + alignment - 1 ) / alignment ) * alignment;
-                size_t padding = newOffset - block.offset;
-
-                if( sizeBytes + padding <= block.size )
-                {
-                    bestVboIdx = static_cast<size_t>( itor - mVbos[vboFlag].begin() );
-                    bestBlockIdx = blockIt - itor->freeBlocks.begin();
-
-                    if( newOffset == block.offset )
-                        foundMatchingStride = true;
-                }
-
-                ++blockIt;
-            }
-
+            if( itor->allocator.allocate( sizeBytes, alignment, bufferOffset ) )
+                bestVboIdx = static_cast<size_t>( itor - mVbos[vboFlag].begin() );
             ++itor;
         }
 
-        if( bestBlockIdx == -1 )
+        if( bestVboIdx == std::numeric_limits<size_t>::max() )
         {
             bestVboIdx = mVbos[vboFlag].size();
-            bestBlockIdx = 0;
-            foundMatchingStride = true;
 
             Vbo newVbo;
 
@@ -550,9 +635,14 @@ namespace Ogre
             OCGE( glBindBuffer( GL_ARRAY_BUFFER, 0 ) );
 
             newVbo.sizeBytes = poolSize;
-            newVbo.freeBlocks.push_back( Block( 0, poolSize ) );
+            newVbo.allocator.reset( poolSize );
             newVbo.dynamicBuffer = 0;
 
+            // A brand new pool always starts at offset 0, which satisfies any alignment.
+            // allocate() may reject an exact fit since it rounds up to the next size class
+            newVbo.allocator.allocateAt( 0u, sizeBytes );
+            bufferOffset = 0u;
+
             if( vboFlag != CPU_INACCESSIBLE )
             {
                 newVbo.dynamicBuffer = new GL3PlusDynamicBuffer(
@@ -562,29 +652,8 @@ namespace Ogre
             mVbos[vboFlag].push_back( newVbo );
         }
 
-        Vbo &bestVbo = mVbos[vboFlag][bestVboIdx];
-        Block &bestBlock = bestVbo.freeBlocks[static_cast<size_t>( bestBlockIdx )];
-
-        size_t newOffset = ( ( bestBlock.offset + alignment - 1 ) / alignment ) * alignment;
-        size_t padding = newOffset - bestBlock.offset;
-        // Shrink our records about available data.
-        bestBlock.size -= sizeBytes + padding;
-        bestBlock.offset = newOffset + sizeBytes;
-
-        if( !foundMatchingStride )
-        {
-            // This is a stride changer, record as such.
-            StrideChangerVec::iterator itStride =
-                std::lower_bound( bestVbo.strideChangers.begin(), bestVbo.strideChangers.end(),
-                                  newOffset, StrideChanger() );
-            bestVbo.strideChangers.insert( itStride, StrideChanger( newOffset, padding ) );
-        }
-
-        if( bestBlock.size == 0 )
-            bestVbo.freeBlocks.erase( bestVbo.freeBlocks.begin() + bestBlockIdx );
-
         outVboIdx = bestVboIdx;
-        outBufferOffset = newOffset;
+        outBufferOffset = bufferOffset;
     }
     //-----------------------------------------------------------------------------------
     void GL3PlusVaoManager::deallocateVbo( size_t vboIdx, size_t bufferOffset, size_t sizeBytes,
@@ -596,20 +665,7 @@ namespace Ogre
             sizeBytes *= mDynamicBufferMultiplier;
 
         Vbo &vbo = mVbos[vboFlag][vboIdx];
-        StrideChangerVec::iterator itStride = std::lower_bound(
-            vbo.strideChangers.begin(), vbo.strideChangers.end(), bufferOffset, StrideChanger() );
-
-        if( itStride != vbo.strideChangers.end() && itStride->offsetAfterPadding == bufferOffset )
-        {
-            bufferOffset -= itStride->paddedBytes;
-            sizeBytes += itStride->paddedBytes;
-
-            vbo.strideChangers.erase( itStride );
-        }
-
-        // See if we're contiguous to a free block and make that block grow.
-        vbo.freeBlocks.push_back( Block( bufferOffset, sizeBytes ) );
-        mergeContiguousBlocks( vbo.freeBlocks.end() - 1, vbo.freeBlocks );
+        vbo.allocator.deallocate( bufferOffset, sizeBytes );
     }
     //-----------------------------------------------------------------------------------
     void GL3PlusVaoManager::mergeContiguousBlocks( BlockVec::iterator blockToMerge, BlockVec &blocks )
@@ -1170,7 +1226,7 @@ namespace Ogre
         OCGE( glBindBuffer( GL_ARRAY_BUFFER, 0 ) );
     }
     //-----------------------------------------------------------------------------------
-    VertexArrayObject *GL3PlusVaoManager::createVertexArrayObjectImpl(
+    GL3PlusVaoManager::VaoVec::iterator GL3PlusVaoManager::findOrCreateVao(
         const VertexBufferPackedVec &vertexBuffers, IndexBufferPacked *indexBuffer,
         OperationType opType )
     {
@@ -1248,6 +1304,34 @@ namespace Ogre
             itor = mVaos.begin() + static_cast<ptrdiff_t>( mVaos.size() - 1u );
         }
 
+        ++itor->refCount;
+
+        return itor;
+    }
+    //-----------------------------------------------------------------------------------
+    void GL3PlusVaoManager::releaseVao( GLuint vaoName )
+    {
+        VaoVec::iterator itor = mVaos.begin();
+        VaoVec::iterator end = mVaos.end();
+
+        while( itor != end && itor->vaoName != vaoName )
+            ++itor;
+
+        if( itor != end )
+        {
+            --itor->refCount;
+
+            if( !itor->refCount )
+            {
+                OCGE( glDeleteVertexArrays( 1, &vaoName ) );
+
+                efficientVectorRemove( mVaos, itor );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 GL3PlusVaoManager::generateRenderQueueId( GLuint vaoName, uint32 uniqueVaoId )
+    {
         // Mix mNumGeneratedVaos with the GL Vao for better sorting purposes:
         //  If we only use the GL's vao, the RQ will sort Meshes with
         //  multiple submeshes mixed with other meshes.
@@ -1265,20 +1349,25 @@ namespace Ogre
         //      4. Mesh B - SubMesh 0
         //      5. Mesh A - SubMesh 0
         //  Thus thrashing the cache unnecessarily.
-        const int bitsVaoGl = 5;
-        const uint32 maskVaoGl = OGRE_RQ_MAKE_MASK( bitsVaoGl );
-        const uint32 maskVao = OGRE_RQ_MAKE_MASK( RqBits::MeshBits - bitsVaoGl );
+        const uint32 maskVaoGl = OGRE_RQ_MAKE_MASK( c_bitsVaoGl );
+        const uint32 maskVao = OGRE_RQ_MAKE_MASK( RqBits::MeshBits - c_bitsVaoGl );
+
+        const uint32 shiftVaoGl = static_cast<uint32>( RqBits::MeshBits - c_bitsVaoGl );
 
-        const uint32 shiftVaoGl = static_cast<uint32>( RqBits::MeshBits - bitsVaoGl );
+        return ( ( vaoName & maskVaoGl ) << shiftVaoGl ) | ( uniqueVaoId & maskVao );
+    }
+    //-----------------------------------------------------------------------------------
+    VertexArrayObject *GL3PlusVaoManager::createVertexArrayObjectImpl(
+        const VertexBufferPackedVec &vertexBuffers, IndexBufferPacked *indexBuffer,
+        OperationType opType )
+    {
+        VaoVec::iterator itor = findOrCreateVao( vertexBuffers, indexBuffer, opType );
 
-        uint32 renderQueueId =
-            ( ( itor->vaoName & maskVaoGl ) << shiftVaoGl ) | ( mNumGeneratedVaos & maskVao );
+        const uint32 renderQueueId = generateRenderQueueId( itor->vaoName, mNumGeneratedVaos );
 
         GL3PlusVertexArrayObject *retVal = OGRE_NEW GL3PlusVertexArrayObject(
             itor->vaoName, renderQueueId, vertexBuffers, indexBuffer, opType );
 
-        ++itor->refCount;
-
         return retVal;
     }
     //-----------------------------------------------------------------------------------
@@ -1286,24 +1375,7 @@ namespace Ogre
     {
         GL3PlusVertexArrayObject *glVao = static_cast<GL3PlusVertexArrayObject *>( vao );
 
-        VaoVec::iterator itor = mVaos.begin();
-        VaoVec::iterator end = mVaos.end();
-
-        while( itor != end && itor->vaoName != glVao->getVaoName() )
-            ++itor;
-
-        if( itor != end )
-        {
-            --itor->refCount;
-
-            if( !itor->refCount )
-            {
-                GLuint vaoName = glVao->getVaoName();
-                OCGE( glDeleteVertexArrays( 1, &vaoName ) );
-
-                efficientVectorRemove( mVaos, itor );
-            }
-        }
+        releaseVao( glVao->getVaoName() );
 
         // We delete it here because this class has no virtual destructor on purpose
         OGRE_DELETE glVao;
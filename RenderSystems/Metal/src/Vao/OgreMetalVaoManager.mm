@@ -410,6 +410,9 @@ namespace Ogre
             }
         }
 
+        if( log )
+            logDynamicUploadRingStats( log );
+
         outCapacityBytes = capacityBytes;
         outFreeBytes = freeBytes;
         outIncludesTextures = false;
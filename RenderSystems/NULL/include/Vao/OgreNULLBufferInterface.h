@@ -45,14 +45,28 @@ namespace Ogre
         void  *mMappedPtr;
 
         uint8 *mNullDataPtr;
+        /// False when mNullDataPtr points to a pool owned by the NULLVaoManager
+        bool mOwnsNullDataPtr;
 
         size_t advanceFrame( bool bAdvanceFrame );
 
     public:
-        NULLBufferInterface( size_t vboPoolIdx );
+        /**
+        @param poolDataPtr
+            When not null, the buffer lives in a pool of the NULLVaoManager starting at this
+            address (indexed by the buffer's internal start), rather than in its own allocation.
+        */
+        NULLBufferInterface( size_t vboPoolIdx, uint8 *poolDataPtr = 0 );
         ~NULLBufferInterface() override;
 
         size_t getVboPoolIndex() { return mVboPoolIdx; }
+        bool   isPooled() const { return !mOwnsNullDataPtr; }
+
+        void _setVboPoolIndex( size_t newVboPool ) { mVboPoolIdx = newVboPool; }
+
+        /// Points the buffer to a new location after its contents were moved by
+        /// NULLVaoManager::relocateBufferImpl. Only valid for pooled buffers.
+        void _relocate( size_t vboPoolIdx, uint8 *poolDataPtr, size_t internalBufferStartBytes );
 
         uint8 *getNullDataPtr() { return mNullDataPtr; }
 
@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include "OgreNULLPrerequisites.h"
 
+#include "Vao/OgreTlsfAllocator.h"
 #include "Vao/OgreVaoManager.h"
 
 namespace Ogre
@@ -55,42 +56,19 @@ namespace Ogre
 
             Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
         };
-        struct StrideChanger
-        {
-            size_t offsetAfterPadding;
-            size_t paddedBytes;
-
-            StrideChanger() : offsetAfterPadding( 0 ), paddedBytes( 0 ) {}
-            StrideChanger( size_t _offsetAfterPadding, size_t _paddedBytes ) :
-                offsetAfterPadding( _offsetAfterPadding ),
-                paddedBytes( _paddedBytes )
-            {
-            }
-
-            bool operator()( const StrideChanger &left, size_t right ) const
-            {
-                return left.offsetAfterPadding < right;
-            }
-            bool operator()( size_t left, const StrideChanger &right ) const
-            {
-                return left < right.offsetAfterPadding;
-            }
-            bool operator()( const StrideChanger &left, const StrideChanger &right ) const
-            {
-                return left.offsetAfterPadding < right.offsetAfterPadding;
-            }
-        };
-
-        typedef vector<Block>::type         BlockVec;
-        typedef vector<StrideChanger>::type StrideChangerVec;
+        /// Still used by NULLMultiSourceVertexBufferPool
+        typedef vector<Block>::type BlockVec;
 
     protected:
+        /// Only BT_IMMUTABLE & BT_DEFAULT vertex and index buffers are pooled, so that
+        /// pool management (e.g. defragmentation) can be tested without a GPU.
+        /// The rest of the buffers own their memory.
         struct Vbo
         {
             size_t sizeBytes;
+            uint8 *data;
 
-            BlockVec         freeBlocks;
-            StrideChangerVec strideChangers;
+            TlsfAllocator allocator;
         };
 
         struct Vao
@@ -126,11 +104,25 @@ namespace Ogre
         typedef vector<Vao>::type VaoVec;
 
         VboVec mVbos[MAX_VBO_FLAG];
+        /// 0 means no pooling: each buffer owns its allocation, which is freed along with
+        /// the buffer. That's how NULL always worked. See VaoManager::CPU_INACCESSIBLE
+        size_t mDefaultPoolSize;
 
         VaoVec mVaos;
 
         VertexBufferPacked *mDrawId;
 
+        /// See GL3PlusVaoManager::allocateVbo. Only for CPU_INACCESSIBLE pools.
+        void allocateVbo( size_t sizeBytes, size_t alignment, size_t &outVboIdx,
+                          size_t &outBufferOffset );
+        void deallocateVbo( size_t vboIdx, size_t bufferOffset, size_t sizeBytes );
+
+        /// Creates the buffer interface for a vertex or index buffer,
+        /// placing it in a pool if the buffer type allows it.
+        NULLBufferInterface *createBufferInterface( size_t sizeBytes, uint32 bytesPerElement,
+                                                    BufferType bufferType, size_t &outBufferOffset );
+        void destroyBufferInterface( BufferPacked *buffer );
+
     protected:
         VertexBufferPacked *createVertexBufferImpl( size_t numElements, uint32 bytesPerElement,
                                                     BufferType bufferType, void *initialData,
@@ -185,13 +177,20 @@ namespace Ogre
         void switchVboPoolIndexImpl( unsigned internalVboBufferType, size_t oldPoolIdx,
                                      size_t newPoolIdx, BufferPacked *buffer ) override;
 
+        bool getBufferPool( const BufferPacked *buffer, uint32 &outPoolType,
+                            uint32 &outPoolIdx ) const override;
+        bool relocateBufferImpl( BufferPacked *buffer, uint32 poolType, uint32 srcPoolIdx ) override;
+        void refreshVertexArrayObjectImpl( VertexArrayObject *vao ) override;
+
     public:
-        NULLVaoManager();
+        NULLVaoManager( const NameValuePairList *params );
         ~NULLVaoManager() override;
 
         void getMemoryStats( MemoryStatsEntryVec &outStats, size_t &outCapacityBytes,
                              size_t &outFreeBytes, Log *log, bool &outIncludesTextures ) const override;
 
+        void getMemoryPoolStats( MemoryPoolStatsVec &outStats ) const override;
+
         void cleanupEmptyPools() override;
 
         bool supportsArbBufferStorage() const { return false; }
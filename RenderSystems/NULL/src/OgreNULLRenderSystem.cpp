@@ -141,7 +141,7 @@ namespace Ogre
             mCurrentCapabilities = mRealCapabilities;
 
             mHardwareBufferManager = new v1::DefaultHardwareBufferManager();
-            mVaoManager = OGRE_NEW NULLVaoManager();
+            mVaoManager = OGRE_NEW NULLVaoManager( miscParams );
             mTextureGpuManager = OGRE_NEW NULLTextureGpuManager( mVaoManager, this );
 
             mInitialized = true;
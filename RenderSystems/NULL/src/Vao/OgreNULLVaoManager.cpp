@@ -45,7 +45,10 @@ THE SOFTWARE.
 
 namespace Ogre
 {
-    NULLVaoManager::NULLVaoManager() : VaoManager( 0 ), mDrawId( 0 )
+    NULLVaoManager::NULLVaoManager( const NameValuePairList *params ) :
+        VaoManager( params ),
+        mDefaultPoolSize( 0u ),
+        mDrawId( 0 )
     {
         mConstBufferAlignment = 256;
         mTexBufferAlignment = 256;
@@ -58,6 +61,19 @@ namespace Ogre
 
         mDynamicBufferMultiplier = 1;
 
+        if( params )
+        {
+            NameValuePairList::const_iterator itor = params->find( "VaoManager::CPU_INACCESSIBLE" );
+            if( itor != params->end() )
+            {
+                mDefaultPoolSize = StringConverter::parseUnsignedInt(
+                    itor->second, (unsigned int)mDefaultPoolSize );
+            }
+        }
+
+        // Only pooled buffers can be relocated
+        mSupportsBufferRelocation = mDefaultPoolSize != 0u;
+
         VertexElement2Vec vertexElements;
         vertexElements.push_back( VertexElement2( VET_UINT1, VES_COUNT ) );
         uint32 *drawIdPtr =
@@ -71,18 +87,195 @@ namespace Ogre
     {
         destroyAllVertexArrayObjects();
         deleteAllBuffers();
+
+        VboVec::const_iterator itor = mVbos[CPU_INACCESSIBLE].begin();
+        VboVec::const_iterator endt = mVbos[CPU_INACCESSIBLE].end();
+
+        while( itor != endt )
+        {
+            OGRE_FREE_SIMD( itor->data, MEMCATEGORY_RENDERSYS );
+            ++itor;
+        }
     }
     //-----------------------------------------------------------------------------------
     void NULLVaoManager::getMemoryStats( MemoryStatsEntryVec &outStats, size_t &outCapacityBytes,
                                          size_t &outFreeBytes, Log *log,
                                          bool &outIncludesTextures ) const
     {
-        outCapacityBytes = 0;
-        outFreeBytes = 0;
+        size_t capacityBytes = 0;
+        size_t freeBytes = 0;
+        MemoryStatsEntryVec statsVec;
+        statsVec.swap( outStats );
+
+        if( log )
+            log->logMessage( "Pool Type;Offset;Size Bytes;Pool Idx;Pool Capacity", LML_CRITICAL );
+
+        TlsfAllocator::BlockVec usedBlocks;
+
+        VboVec::const_iterator itor = mVbos[CPU_INACCESSIBLE].begin();
+        VboVec::const_iterator endt = mVbos[CPU_INACCESSIBLE].end();
+
+        while( itor != endt )
+        {
+            const Vbo &vbo = *itor;
+            const uint32 poolIdx = static_cast<uint32>( itor - mVbos[CPU_INACCESSIBLE].begin() );
+            capacityBytes += vbo.sizeBytes;
+            freeBytes += vbo.allocator.getFreeBytes();
+
+            usedBlocks.clear();
+            vbo.allocator.getUsedBlocks( usedBlocks );
+
+            // Keep reporting entirely free pools
+            if( usedBlocks.empty() )
+                usedBlocks.push_back( TlsfAllocator::Block( 0, 0 ) );
+
+            TlsfAllocator::BlockVec::const_iterator itBlock = usedBlocks.begin();
+            TlsfAllocator::BlockVec::const_iterator enBlock = usedBlocks.end();
+
+            while( itBlock != enBlock )
+            {
+                if( log )
+                {
+                    log->logMessage( "CPU_INACCESSIBLE;" +
+                                         StringConverter::toString( itBlock->offset ) + ";" +
+                                         StringConverter::toString( itBlock->size ) + ";" +
+                                         StringConverter::toString( poolIdx ) + ";" +
+                                         StringConverter::toString( vbo.sizeBytes ),
+                                     LML_CRITICAL );
+                }
+
+                statsVec.push_back( MemoryStatsEntry( CPU_INACCESSIBLE, poolIdx, itBlock->offset,
+                                                      itBlock->size, vbo.sizeBytes, false ) );
+                ++itBlock;
+            }
+
+            ++itor;
+        }
+
+        if( log )
+            logDynamicUploadRingStats( log );
+
+        outCapacityBytes = capacityBytes;
+        outFreeBytes = freeBytes;
         outIncludesTextures = false;
+        statsVec.swap( outStats );
+    }
+    //-----------------------------------------------------------------------------------
+    void NULLVaoManager::getMemoryPoolStats( MemoryPoolStatsVec &outStats ) const
+    {
+        outStats.clear();
+
+        VboVec::const_iterator itor = mVbos[CPU_INACCESSIBLE].begin();
+        VboVec::const_iterator endt = mVbos[CPU_INACCESSIBLE].end();
+
+        while( itor != endt )
+        {
+            TlsfAllocator::Stats allocStats;
+            itor->allocator.getStats( allocStats );
+
+            MemoryPoolStats poolStats(
+                CPU_INACCESSIBLE, uint32( itor - mVbos[CPU_INACCESSIBLE].begin() ), itor->sizeBytes,
+                false );
+            poolStats.freeBytes = allocStats.freeBytes;
+            poolStats.largestFreeBlock = allocStats.largestFreeBlock;
+            poolStats.numFreeBlocks = allocStats.numFreeBlocks;
+            outStats.push_back( poolStats );
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void NULLVaoManager::cleanupEmptyPools()
+    {
+        VboVec &vbos = mVbos[CPU_INACCESSIBLE];
+
+        VboVec::iterator itor = vbos.begin();
+        VboVec::iterator endt = vbos.end();
+
+        while( itor != endt )
+        {
+            if( itor->allocator.isEmpty() )
+            {
+                OGRE_FREE_SIMD( itor->data, MEMCATEGORY_RENDERSYS );
+                itor->data = 0;
+
+                // There's (unrelated) live buffers whose vboIdx will now point out of bounds.
+                // We need to update them so they don't crash deallocateVbo later.
+                switchVboPoolIndex( CPU_INACCESSIBLE, (size_t)( vbos.size() - 1u ),
+                                    (size_t)( itor - vbos.begin() ) );
+
+                itor = efficientVectorRemove( vbos, itor );
+                endt = vbos.end();
+            }
+            else
+            {
+                ++itor;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void NULLVaoManager::allocateVbo( size_t sizeBytes, size_t alignment, size_t &outVboIdx,
+                                      size_t &outBufferOffset )
+    {
+        VboVec &vbos = mVbos[CPU_INACCESSIBLE];
+
+        for( size_t i = 0u; i < vbos.size(); ++i )
+        {
+            if( vbos[i].allocator.allocate( sizeBytes, alignment, outBufferOffset ) )
+            {
+                outVboIdx = i;
+                return;
+            }
+        }
+
+        // Couldn't find a pool with enough room. Create a new one.
+        Vbo newVbo;
+        newVbo.sizeBytes = std::max( mDefaultPoolSize, sizeBytes );
+        newVbo.data = reinterpret_cast<uint8 *>(
+            OGRE_MALLOC_SIMD( newVbo.sizeBytes, MEMCATEGORY_RENDERSYS ) );
+        newVbo.allocator.reset( newVbo.sizeBytes );
+        // A brand new pool always starts at offset 0, which satisfies any alignment.
+        // allocate() may reject an exact fit since it rounds up to the next size class
+        newVbo.allocator.allocateAt( 0u, sizeBytes );
+        outBufferOffset = 0u;
+        vbos.push_back( newVbo );
+
+        outVboIdx = vbos.size() - 1u;
+    }
+    //-----------------------------------------------------------------------------------
+    void NULLVaoManager::deallocateVbo( size_t vboIdx, size_t bufferOffset, size_t sizeBytes )
+    {
+        mVbos[CPU_INACCESSIBLE][vboIdx].allocator.deallocate( bufferOffset, sizeBytes );
+    }
+    //-----------------------------------------------------------------------------------
+    NULLBufferInterface *NULLVaoManager::createBufferInterface( size_t sizeBytes,
+                                                                uint32 bytesPerElement,
+                                                                BufferType bufferType,
+                                                                size_t &outBufferOffset )
+    {
+        outBufferOffset = 0u;
+
+        // Without pooling, each buffer gets (and frees) its own allocation
+        if( bufferType >= BT_DYNAMIC_DEFAULT || !mDefaultPoolSize )
+            return new NULLBufferInterface( 0 );
+
+        size_t vboIdx;
+        allocateVbo( sizeBytes, bytesPerElement, vboIdx, outBufferOffset );
+        return new NULLBufferInterface( vboIdx, mVbos[CPU_INACCESSIBLE][vboIdx].data );
     }
     //-----------------------------------------------------------------------------------
-    void NULLVaoManager::cleanupEmptyPools() {}
+    void NULLVaoManager::destroyBufferInterface( BufferPacked *buffer )
+    {
+        NULLBufferInterface *bufferInterface =
+            static_cast<NULLBufferInterface *>( buffer->getBufferInterface() );
+
+        if( bufferInterface->isPooled() )
+        {
+            deallocateVbo( bufferInterface->getVboPoolIndex(),
+                           buffer->_getInternalBufferStart() * buffer->getBytesPerElement(),
+                           buffer->_getInternalTotalSizeBytes() );
+        }
+    }
     //-----------------------------------------------------------------------------------
     VertexBufferPacked *NULLVaoManager::createVertexBufferImpl( size_t numElements,
                                                                 uint32 bytesPerElement,
@@ -90,10 +283,12 @@ namespace Ogre
                                                                 bool keepAsShadow,
                                                                 const VertexElement2Vec &vElements )
     {
-        NULLBufferInterface *bufferInterface = new NULLBufferInterface( 0 );
+        size_t bufferOffset;
+        NULLBufferInterface *bufferInterface = createBufferInterface(
+            numElements * bytesPerElement, bytesPerElement, bufferType, bufferOffset );
         VertexBufferPacked *retVal =
-            OGRE_NEW VertexBufferPacked( 0, numElements, bytesPerElement, 0, bufferType, initialData,
-                                         keepAsShadow, this, bufferInterface, vElements );
+            OGRE_NEW VertexBufferPacked( bufferOffset, numElements, bytesPerElement, 0, bufferType,
+                                         initialData, keepAsShadow, this, bufferInterface, vElements );
 
         if( initialData )
             bufferInterface->_firstUpload( initialData, 0, numElements );
@@ -101,7 +296,10 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
-    void NULLVaoManager::destroyVertexBufferImpl( VertexBufferPacked *vertexBuffer ) {}
+    void NULLVaoManager::destroyVertexBufferImpl( VertexBufferPacked *vertexBuffer )
+    {
+        destroyBufferInterface( vertexBuffer );
+    }
     //-----------------------------------------------------------------------------------
 #ifdef _OGRE_MULTISOURCE_VBO
     MultiSourceVertexBufferPool *NULLVaoManager::createMultiSourceVertexBufferPoolImpl(
@@ -117,10 +315,12 @@ namespace Ogre
                                                               BufferType bufferType, void *initialData,
                                                               bool keepAsShadow )
     {
-        NULLBufferInterface *bufferInterface = new NULLBufferInterface( 0 );
+        size_t bufferOffset;
+        NULLBufferInterface *bufferInterface = createBufferInterface(
+            numElements * bytesPerElement, bytesPerElement, bufferType, bufferOffset );
         IndexBufferPacked *retVal =
-            OGRE_NEW IndexBufferPacked( 0, numElements, bytesPerElement, 0, bufferType, initialData,
-                                        keepAsShadow, this, bufferInterface );
+            OGRE_NEW IndexBufferPacked( bufferOffset, numElements, bytesPerElement, 0, bufferType,
+                                        initialData, keepAsShadow, this, bufferInterface );
 
         if( initialData )
             bufferInterface->_firstUpload( initialData, 0, numElements );
@@ -128,7 +328,10 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
-    void NULLVaoManager::destroyIndexBufferImpl( IndexBufferPacked *indexBuffer ) {}
+    void NULLVaoManager::destroyIndexBufferImpl( IndexBufferPacked *indexBuffer )
+    {
+        destroyBufferInterface( indexBuffer );
+    }
     //-----------------------------------------------------------------------------------
     ConstBufferPacked *NULLVaoManager::createConstBufferImpl( size_t sizeBytes, BufferType bufferType,
                                                               void *initialData, bool keepAsShadow )
@@ -409,5 +612,81 @@ namespace Ogre
     void NULLVaoManager::switchVboPoolIndexImpl( unsigned internalVboBufferType, size_t oldPoolIdx,
                                                  size_t newPoolIdx, BufferPacked *buffer )
     {
+        if( buffer->getBufferPackedType() != BP_TYPE_VERTEX &&
+            buffer->getBufferPackedType() != BP_TYPE_INDEX )
+        {
+            return;
+        }
+
+        NULLBufferInterface *bufferInterface =
+            static_cast<NULLBufferInterface *>( buffer->getBufferInterface() );
+        if( bufferInterface->isPooled() && bufferInterface->getVboPoolIndex() == oldPoolIdx )
+            bufferInterface->_setVboPoolIndex( newPoolIdx );
+    }
+    //-----------------------------------------------------------------------------------
+    bool NULLVaoManager::getBufferPool( const BufferPacked *buffer, uint32 &outPoolType,
+                                        uint32 &outPoolIdx ) const
+    {
+        NULLBufferInterface *bufferInterface =
+            static_cast<NULLBufferInterface *>( buffer->getBufferInterface() );
+
+        if( buffer == mDrawId || !bufferInterface->isPooled() )
+            return false;
+
+        outPoolType = CPU_INACCESSIBLE;
+        outPoolIdx = static_cast<uint32>( bufferInterface->getVboPoolIndex() );
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    bool NULLVaoManager::relocateBufferImpl( BufferPacked *buffer, uint32 poolType,
+                                             uint32 srcPoolIdx )
+    {
+        OGRE_ASSERT_LOW( poolType == CPU_INACCESSIBLE );
+
+        VboVec &vbos = mVbos[CPU_INACCESSIBLE];
+
+        const size_t sizeBytes = buffer->_getInternalTotalSizeBytes();
+        const size_t srcOffset = buffer->_getInternalBufferStart() * buffer->getBytesPerElement();
+
+        // Same policy as GL3PlusVaoManager: try the fullest pools first
+        typedef std::pair<size_t, size_t> FreeBytesAndPoolIdx;
+        vector<FreeBytesAndPoolIdx>::type dstPools;
+        dstPools.reserve( vbos.size() );
+        for( size_t i = 0u; i < vbos.size(); ++i )
+        {
+            if( i != srcPoolIdx )
+                dstPools.push_back( FreeBytesAndPoolIdx( vbos[i].allocator.getFreeBytes(), i ) );
+        }
+        std::sort( dstPools.begin(), dstPools.end() );
+
+        vector<FreeBytesAndPoolIdx>::type::const_iterator itor = dstPools.begin();
+        vector<FreeBytesAndPoolIdx>::type::const_iterator endt = dstPools.end();
+
+        while( itor != endt )
+        {
+            const size_t dstPoolIdx = itor->second;
+            size_t dstOffset;
+            if( vbos[dstPoolIdx].allocator.allocate( sizeBytes, buffer->getBytesPerElement(),
+                                                     dstOffset ) )
+            {
+                memcpy( vbos[dstPoolIdx].data + dstOffset, vbos[srcPoolIdx].data + srcOffset,
+                        sizeBytes );
+                vbos[srcPoolIdx].allocator.deallocate( srcOffset, sizeBytes );
+
+                NULLBufferInterface *bufferInterface =
+                    static_cast<NULLBufferInterface *>( buffer->getBufferInterface() );
+                bufferInterface->_relocate( dstPoolIdx, vbos[dstPoolIdx].data, dstOffset );
+                return true;
+            }
+            ++itor;
+        }
+
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
+    void NULLVaoManager::refreshVertexArrayObjectImpl( VertexArrayObject *vao )
+    {
+        // There are no API objects to patch. The Vao keeps its name
+        // since NULL Vaos aren't tied to the pools their buffers live in.
     }
 }  // namespace Ogre
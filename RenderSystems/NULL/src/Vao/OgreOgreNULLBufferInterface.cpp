@@ -33,16 +33,17 @@ THE SOFTWARE.
 
 namespace Ogre
 {
-    NULLBufferInterface::NULLBufferInterface( size_t vboPoolIdx ) :
+    NULLBufferInterface::NULLBufferInterface( size_t vboPoolIdx, uint8 *poolDataPtr ) :
         mVboPoolIdx( vboPoolIdx ),
         mMappedPtr( 0 ),
-        mNullDataPtr( 0 )
+        mNullDataPtr( poolDataPtr ),
+        mOwnsNullDataPtr( poolDataPtr == 0 )
     {
     }
     //-----------------------------------------------------------------------------------
     NULLBufferInterface::~NULLBufferInterface()
     {
-        if( mNullDataPtr )
+        if( mNullDataPtr && mOwnsNullDataPtr )
         {
             OGRE_FREE_SIMD( mNullDataPtr, MEMCATEGORY_RENDERSYS );
             mNullDataPtr = 0;
@@ -63,6 +64,18 @@ namespace Ogre
         mBuffer->mBufferType = originalBufferType;
     }
     //-----------------------------------------------------------------------------------
+    void NULLBufferInterface::_relocate( size_t vboPoolIdx, uint8 *poolDataPtr,
+                                         size_t internalBufferStartBytes )
+    {
+        OGRE_ASSERT_LOW( !mOwnsNullDataPtr && "Only pooled buffers can be relocated!" );
+        OGRE_ASSERT_LOW( internalBufferStartBytes % mBuffer->mBytesPerElement == 0u );
+
+        mVboPoolIdx = vboPoolIdx;
+        mNullDataPtr = poolDataPtr;
+        mBuffer->mInternalBufferStart = internalBufferStartBytes / mBuffer->mBytesPerElement;
+        mBuffer->mFinalBufferStart = mBuffer->mInternalBufferStart;
+    }
+    //-----------------------------------------------------------------------------------
     void *RESTRICT_ALIAS_RETURN NULLBufferInterface::map( size_t elementStart, size_t elementCount,
                                                           MappingState prevMappingState,
                                                           bool bAdvanceFrame )
@@ -173,8 +186,11 @@ namespace Ogre
     {
         BufferInterface::_notifyBuffer( buffer );
 
-        mNullDataPtr = reinterpret_cast<uint8 *>(
-            OGRE_MALLOC_SIMD( mBuffer->getTotalSizeBytes(), MEMCATEGORY_RENDERSYS ) );
+        if( mOwnsNullDataPtr )
+        {
+            mNullDataPtr = reinterpret_cast<uint8 *>(
+                OGRE_MALLOC_SIMD( mBuffer->getTotalSizeBytes(), MEMCATEGORY_RENDERSYS ) );
+        }
     }
     //-----------------------------------------------------------------------------------
     void NULLBufferInterface::copyTo( BufferInterface *dstBuffer, size_t dstOffsetBytes,
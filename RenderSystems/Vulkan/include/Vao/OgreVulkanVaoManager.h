@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include "OgreVulkanPrerequisites.h"
 
+#include "Vao/OgreTlsfAllocator.h"
 #include "Vao/OgreVaoManager.h"
 #include "ogrestd/set.h"
 
@@ -80,32 +81,6 @@ namespace Ogre
 
             Block( size_t _offset, size_t _size ) : offset( _offset ), size( _size ) {}
         };
-        struct StrideChanger
-        {
-            size_t offsetAfterPadding;
-            size_t paddedBytes;
-
-            StrideChanger() : offsetAfterPadding( 0 ), paddedBytes( 0 ) {}
-            StrideChanger( size_t _offsetAfterPadding, size_t _paddedBytes ) :
-                offsetAfterPadding( _offsetAfterPadding ),
-                paddedBytes( _paddedBytes )
-            {
-            }
-
-            bool operator()( const StrideChanger &left, size_t right ) const
-            {
-                return left.offsetAfterPadding < right;
-            }
-            bool operator()( size_t left, const StrideChanger &right ) const
-            {
-                return left < right.offsetAfterPadding;
-            }
-            bool operator()( const StrideChanger &left, const StrideChanger &right ) const
-            {
-                return left.offsetAfterPadding < right.offsetAfterPadding;
-            }
-        };
-
         struct DirtyBlock
         {
             uint32 frameIdx;
@@ -126,7 +101,6 @@ namespace Ogre
         };
 
         typedef vector<Block>::type BlockVec;
-        typedef vector<StrideChanger>::type StrideChangerVec;
         typedef FastArray<DirtyBlock> DirtyBlockArray;
 
     protected:
@@ -141,14 +115,10 @@ namespace Ogre
             uint32              emptyFrame;
             VulkanDynamicBuffer *dynamicBuffer; //Null for CPU_INACCESSIBLE BOs.
 
-            BlockVec            freeBlocks;
-            StrideChangerVec    strideChangers;
+            TlsfAllocator       allocator;
             // clang-format on
 
-            bool isEmpty() const
-            {
-                return this->freeBlocks.size() == 1u && this->freeBlocks.back().size == this->sizeBytes;
-            }
+            bool isEmpty() const { return this->isAllocated() && this->allocator.isEmpty(); }
 
             bool isAllocated() const { return this->vboName != VK_NULL_HANDLE; }
         };
@@ -517,6 +487,8 @@ namespace Ogre
         void getMemoryStats( MemoryStatsEntryVec &outStats, size_t &outCapacityBytes,
                              size_t &outFreeBytes, Log *log, bool &outIncludesTextures ) const override;
 
+        void getMemoryPoolStats( MemoryPoolStatsVec &outStats ) const override;
+
         void cleanupEmptyPools() override;
 
         bool supportsCoherentMapping() const;
@@ -337,6 +337,8 @@ namespace Ogre
         if( log )
             log->logMessage( "Pool Type;Offset;Size Bytes;Pool Idx;Pool Capacity", LML_CRITICAL );
 
+        TlsfAllocator::BlockVec usedBlocks;
+
         for( unsigned vboIdx = 0; vboIdx < MAX_VBO_FLAG; ++vboIdx )
         {
             VboVec::const_iterator itor = mVbos[vboIdx].begin();
@@ -348,66 +350,89 @@ namespace Ogre
                 const size_t poolIdx = static_cast<size_t>( itor - mVbos[vboIdx].begin() );
                 capacityBytes += vbo.sizeBytes;
 
-                Block usedBlock( 0, 0 );
+                freeBytes += vbo.allocator.getFreeBytes();
+
+                usedBlocks.clear();
+                vbo.allocator.getUsedBlocks( usedBlocks );
+
+                TlsfAllocator::BlockVec::const_iterator itBlock = usedBlocks.begin();
+                TlsfAllocator::BlockVec::const_iterator enBlock = usedBlocks.end();
 
-                BlockVec freeBlocks = vbo.freeBlocks;
-                while( !freeBlocks.empty() )
+                while( itBlock != enBlock )
                 {
-                    // Find the free block that comes next
-                    BlockVec::iterator nextBlock;
-                    {
-                        BlockVec::iterator itBlock = freeBlocks.begin();
-                        BlockVec::iterator enBlock = freeBlocks.end();
+                    getMemoryStats( Block( itBlock->offset, itBlock->size ), vboIdx, poolIdx,
+                                    vbo.sizeBytes, text, statsVec, log );
+                    ++itBlock;
+                }
 
-                        nextBlock = itBlock;
+                // Keep reporting entirely free pools
+                if( usedBlocks.empty() )
+                    getMemoryStats( Block( 0, 0 ), vboIdx, poolIdx, vbo.sizeBytes, text, statsVec, log );
 
-                        while( itBlock != enBlock )
-                        {
-                            if( itBlock->offset < nextBlock->offset )
-                                nextBlock = itBlock;
-                            ++itBlock;
-                        }
-                    }
+                ++itor;
+            }
+        }
 
-                    freeBytes += nextBlock->size;
-                    usedBlock.size = nextBlock->offset - usedBlock.offset;
+        outCapacityBytes = capacityBytes;
+        outFreeBytes = freeBytes;
+        outIncludesTextures = true;
+        statsVec.swap( outStats );
 
-                    OGRE_ASSERT_LOW( usedBlock.size <= vbo.sizeBytes );
-                    OGRE_ASSERT_LOW( usedBlock.offset + usedBlock.size <= vbo.sizeBytes );
+        if( log )
+        {
+            log->logMessage( "Pool Type;Pool Idx;Free Bytes;Largest Free Block;Free Blocks;"
+                             "Fragmentation",
+                             LML_CRITICAL );
 
-                    // usedBlock.size could be 0 if:
-                    //  1. All of memory is free
-                    //  2. There's two contiguous free blocks, which should not happen
-                    //     due to mergeContiguousBlocks
-                    if( usedBlock.size > 0u )
-                    {
-                        getMemoryStats( usedBlock, vboIdx, poolIdx, vbo.sizeBytes, text, statsVec, log );
-                    }
+            MemoryPoolStatsVec poolStats;
+            getMemoryPoolStats( poolStats );
 
-                    usedBlock.offset += usedBlock.size;
-                    usedBlock.size = 0;
-                    efficientVectorRemove( freeBlocks, nextBlock );
-                }
+            MemoryPoolStatsVec::const_iterator itor = poolStats.begin();
+            MemoryPoolStatsVec::const_iterator endt = poolStats.end();
+
+            while( itor != endt )
+            {
+                text.clear();
+                text.a( c_vboTypes[itor->poolType], ";", itor->poolIdx, ";",
+                        (uint64)itor->freeBytes, ";" );
+                text.a( (uint64)itor->largestFreeBlock, ";", (uint64)itor->numFreeBlocks, ";",
+                        LwString::Float( itor->getFragmentation(), 3 ) );
+                log->logMessage( text.c_str(), LML_CRITICAL );
+                ++itor;
+            }
+
+            logDynamicUploadRingStats( log );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void VulkanVaoManager::getMemoryPoolStats( MemoryPoolStatsVec &outStats ) const
+    {
+        outStats.clear();
+
+        for( unsigned vboIdx = 0; vboIdx < MAX_VBO_FLAG; ++vboIdx )
+        {
+            VboVec::const_iterator itor = mVbos[vboIdx].begin();
+            VboVec::const_iterator endt = mVbos[vboIdx].end();
 
-                if( usedBlock.size > 0u || ( usedBlock.offset == 0 && usedBlock.size == 0 ) )
+            while( itor != endt )
+            {
+                // Unallocated pools are only placeholders waiting to be reused
+                if( itor->isAllocated() )
                 {
-                    if( vbo.freeBlocks.empty() )
-                    {
-                        OGRE_ASSERT_LOW( usedBlock.offset == 0 && usedBlock.size == 0 );
-                        usedBlock.offset = 0u;
-                        usedBlock.size = vbo.sizeBytes;
-                    }
-                    getMemoryStats( usedBlock, vboIdx, poolIdx, vbo.sizeBytes, text, statsVec, log );
+                    TlsfAllocator::Stats allocStats;
+                    itor->allocator.getStats( allocStats );
+
+                    MemoryPoolStats poolStats( vboIdx, uint32( itor - mVbos[vboIdx].begin() ),
+                                               itor->sizeBytes, vboIdx == TEXTURES_OPTIMAL );
+                    poolStats.freeBytes = allocStats.freeBytes;
+                    poolStats.largestFreeBlock = allocStats.largestFreeBlock;
+                    poolStats.numFreeBlocks = allocStats.numFreeBlocks;
+                    outStats.push_back( poolStats );
                 }
 
                 ++itor;
             }
         }
-
-        outCapacityBytes = capacityBytes;
-        outFreeBytes = freeBytes;
-        outIncludesTextures = true;
-        statsVec.swap( outStats );
     }
     //-----------------------------------------------------------------------------------
     void VulkanVaoManager::deallocateEmptyVbos( const bool bDeviceStall )
@@ -444,7 +469,7 @@ namespace Ogre
                 delete vbo.dynamicBuffer;
                 vbo.dynamicBuffer = 0;
 
-                vbo.freeBlocks.clear();
+                vbo.allocator.reset( 0u );
                 vbo.emptyFrame = mFrameCount;
 
                 mUnallocatedVbos[itor->vboFlag].push_back( itor->vboIdx );
@@ -582,7 +607,7 @@ namespace Ogre
             while( itor != endt )
             {
                 Vbo &vbo = *itor;
-                if( vbo.freeBlocks.size() == 1u && vbo.sizeBytes == vbo.freeBlocks.back().size )
+                if( vbo.isEmpty() )
                 {
                     VaoVec::iterator itVao = mVaos.begin();
                     VaoVec::iterator enVao = mVaos.end();
@@ -952,59 +977,44 @@ namespace Ogre
 
         VboVec &vboVec = mVbos[vboFlag];
 
-        VboVec::const_iterator itor = vboVec.begin();
-        VboVec::const_iterator endt = vboVec.end();
+        VboVec::iterator itor = vboVec.begin();
+        VboVec::iterator endt = vboVec.end();
 
-        // clang-format off
-        // Find a suitable VBO that can hold the requested size. We prefer those free
-        // blocks that have a matching stride (the current offset is a multiple of
-        // bytesPerElement) in order to minimize the amount of memory padding.
-        size_t bestVboIdx   = std::numeric_limits<size_t>::max();
-        ptrdiff_t bestBlockIdx = -1;
-        bool foundMatchingStride = false;
-        // clang-format on
+        // Find a suitable VBO that can hold the requested size.
+        size_t bestVboIdx = std::numeric_limits<size_t>::max();
+        size_t bufferOffset = 0;
 
-        while( itor != endt && !foundMatchingStride )
+        while( itor != endt && bestVboIdx == std::numeric_limits<size_t>::max() )
         {
             // First check the allocation can be done inside this Vbo
             if( ( 1u << itor->vkMemoryTypeIdx ) & textureMemTypeBits )
             {
-                BlockVec::const_iterator blockIt = itor->freeBlocks.begin();
-                BlockVec::const_iterator blockEn = itor->freeBlocks.end();
+                // Must be checked before allocating, as it won't be empty afterwards
+                const bool wasEmpty = itor->isEmpty();
 
-                while( blockIt != blockEn && !foundMatchingStride )
+                if( itor->allocator.allocate( sizeBytes, alignment, bufferOffset ) )
                 {
-                    const Block &block = *blockIt;
-
-                    // Round to next multiple of alignment
-                    size_t newOffset = ( ( block.offset + alignment - 1 ) / alignment ) * alignment;
-                    size_t padding = newOffset - block.offset;
+                    bestVboIdx = static_cast<size_t>( itor - vboVec.begin() );
 
-                    if( sizeBytes + padding <= block.size )
+                    if( wasEmpty )
                     {
-                        // clang-format off
-                        bestVboIdx      = static_cast<size_t>( itor - vboVec.begin());
-                        bestBlockIdx    = blockIt - itor->freeBlocks.begin();
-                        // clang-format on
-
-                        if( newOffset == block.offset )
-                            foundMatchingStride = true;
+                        // The block will no longer be empty, hence no unschedule from destruction
+                        VboIndex vboIndex;
+                        vboIndex.vboFlag = vboFlag;
+                        vboIndex.vboIdx = static_cast<uint32>( bestVboIdx );
+                        OGRE_ASSERT_HIGH( mEmptyVboPools.find( vboIndex ) != mEmptyVboPools.end() &&
+                                          "If the Vbo pool was empty, it should be in mEmptyVboPools" );
+                        mEmptyVboPools.erase( vboIndex );
                     }
-
-                    ++blockIt;
                 }
             }
 
             ++itor;
         }
 
-        if( bestBlockIdx == -1 )
+        if( bestVboIdx == std::numeric_limits<size_t>::max() )
         {
-            // clang-format off
-            bestVboIdx      = vboVec.size();
-            bestBlockIdx    = 0;
-            foundMatchingStride = true;
-            // clang-format on
+            bestVboIdx = vboVec.size();
 
             Vbo newVbo;
 
@@ -1140,9 +1150,14 @@ namespace Ogre
             }
 
             newVbo.sizeBytes = usablePoolSize;
-            newVbo.freeBlocks.push_back( Block( 0, usablePoolSize ) );
+            newVbo.allocator.reset( usablePoolSize );
             newVbo.dynamicBuffer = 0;
 
+            // A brand new pool always starts at offset 0, which satisfies any alignment.
+            // allocate() may reject an exact fit since it rounds up to the next size class
+            newVbo.allocator.allocateAt( 0u, sizeBytes );
+            bufferOffset = 0u;
+
             if( vboFlag != CPU_INACCESSIBLE )
             {
                 const bool isCoherent = isVboFlagCoherent( vboFlag );
@@ -1162,51 +1177,10 @@ namespace Ogre
                 vboVec.push_back( newVbo );
             }
         }
-        else
-        {
-            Vbo &bestVbo = vboVec[bestVboIdx];
-            if( bestVbo.isEmpty() )
-            {
-                OGRE_ASSERT_HIGH( bestVbo.isAllocated() );
-
-                // The block will no longer be empty, hence no unschedule from destruction
-                VboIndex vboIndex;
-                vboIndex.vboFlag = vboFlag;
-                vboIndex.vboIdx = static_cast<uint32>( bestVboIdx );
-                OGRE_ASSERT_HIGH( mEmptyVboPools.find( vboIndex ) != mEmptyVboPools.end() &&
-                                  "If the Vbo pool was empty, it should be in mEmptyVboPools" );
-                mEmptyVboPools.erase( vboIndex );
-            }
-        }
-
-        // clang-format off
-        Vbo &bestVbo        = vboVec[bestVboIdx];
-        Block &bestBlock    = bestVbo.freeBlocks[static_cast<size_t>(bestBlockIdx)];
-        // clang-format on
-
-        size_t newOffset = ( ( bestBlock.offset + alignment - 1 ) / alignment ) * alignment;
-        size_t padding = newOffset - bestBlock.offset;
-        // clang-format off
-        // Shrink our records about available data.
-        bestBlock.size   -= sizeBytes + padding;
-        bestBlock.offset = newOffset + sizeBytes;
-        // clang-format on
-
-        if( !foundMatchingStride )
-        {
-            // This is a stride changer, record as such.
-            StrideChangerVec::iterator itStride = std::lower_bound( bestVbo.strideChangers.begin(),
-                                                                    bestVbo.strideChangers.end(),  //
-                                                                    newOffset, StrideChanger() );
-            bestVbo.strideChangers.insert( itStride, StrideChanger( newOffset, padding ) );
-        }
-
-        if( bestBlock.size == 0u )
-            bestVbo.freeBlocks.erase( bestVbo.freeBlocks.begin() + bestBlockIdx );
 
         // clang-format off
         outVboIdx       = bestVboIdx;
-        outBufferOffset = newOffset;
+        outBufferOffset = bufferOffset;
         // clang-format on
     }
     //-----------------------------------------------------------------------------------
@@ -1246,29 +1220,12 @@ namespace Ogre
         }
 
         Vbo &vbo = mVbos[vboFlag][vboIdx];
-        StrideChangerVec::iterator itStride =
-            std::lower_bound( vbo.strideChangers.begin(), vbo.strideChangers.end(),  //
-                              bufferOffset, StrideChanger() );
-
-        if( itStride != vbo.strideChangers.end() && itStride->offsetAfterPadding == bufferOffset )
-        {
-            // clang-format off
-            bufferOffset    -= itStride->paddedBytes;
-            sizeBytes       += itStride->paddedBytes;
-            // clang-format on
-
-            vbo.strideChangers.erase( itStride );
-        }
-
-        // See if we're contiguous to a free block and make that block grow.
-        vbo.freeBlocks.push_back( Block( bufferOffset, sizeBytes ) );
-        mergeContiguousBlocks( vbo.freeBlocks.end() - 1u, vbo.freeBlocks );
+        vbo.allocator.deallocate( bufferOffset, sizeBytes );
 
         if( vbo.isEmpty() )
         {
             // This pool is empty. Schedule for removal
             // We may reuse their memory if more memory is requested before they're actually removed.
-            OGRE_ASSERT_LOW( vbo.strideChangers.empty() );
             vbo.emptyFrame = mFrameCount;
             VboIndex vboIndex;
             vboIndex.vboFlag = vboFlag;
@@ -26,6 +26,13 @@ namespace Demo
         {
             mAlwaysAskForConfig = false;
         }
+
+        void initMiscParamsListener( Ogre::NameValuePairList &params ) override
+        {
+            // The NULL RenderSystem doesn't pool buffers by default.
+            // testVaoDefragmentation needs them pooled.
+            params["VaoManager::CPU_INACCESSIBLE"] = "16777216";
+        }
     };
 
     void MainEntryPoints::createSystems( GameState **outGraphicsGameState,
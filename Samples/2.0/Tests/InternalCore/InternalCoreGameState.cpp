@@ -3,13 +3,3168 @@
 
 #include "GraphicsSystem.h"
 
+#include "OgreAnimation.h"
+#include "OgreAnimationTrack.h"
+#include "OgreAsyncTextureReadbackBatcher.h"
+#include "OgreBCnEncoder.h"
+#include "OgreBillboard.h"
+#include "OgreBillboardSet.h"
+#include "OgreBitwise.h"
+#include "OgreCamera.h"
+#include "OgreEdgeListBuilder.h"
+#include "OgreException.h"
+#include "OgreHardwareBufferManager.h"
+#include "OgreHardwareIndexBuffer.h"
+#include "OgreHardwareVertexBuffer.h"
+#include "OgreHlmsManager.h"
+#include "OgreImage2.h"
+#include "OgreItem.h"
+#include "OgreLogManager.h"
+#include "OgreMesh.h"
+#include "OgreMesh2.h"
+#include "OgreMesh2Serializer.h"
+#include "OgreMeshManager.h"
+#include "OgreMeshManager2.h"
+#include "OgreMeshOptimizer.h"
+#include "OgreOldBone.h"
+#include "OgreOldSkeletonManager.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "OgrePlane.h"
+#include "OgreRenderQueue.h"
+#include "OgreRenderSystemCapabilities.h"
+#include "OgreRenderSystem.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreSkeleton.h"
+#include "OgreString.h"
+#include "OgreSubItem.h"
+#include "OgreSubMesh.h"
+#include "OgreSubMesh2.h"
+#include "OgreTextureBox.h"
+#include "OgreTextureFilters.h"
+#include "OgreTextureGpuManager.h"
+#include "OgreTimer.h"
+
+#include "Animation/OgreBone.h"
+#include "Animation/OgreSkeletonAnimation.h"
+#include "Animation/OgreSkeletonDef.h"
+#include "Animation/OgreSkeletonInstance.h"
+#include "Compute/OgrePreSkinning.h"
 #include "Math/Array/OgreArrayVector3.h"
+#include "ParticleSystem/OgreBillboard2.h"
+#include "ParticleSystem/OgreBillboardSet2.h"
+#include "ParticleSystem/OgreEmitter2.h"
+#include "ParticleSystem/OgreParticleAffector2.h"
+#include "ParticleSystem/OgreParticleGpuSimulation.h"
+#include "ParticleSystem/OgreParticleSystem2.h"
+#include "ParticleSystem/OgreParticleSystemManager2.h"
+#include "Vao/OgreAsyncTicket.h"
+#include "Vao/OgreDynamicUploadRing.h"
+#include "Vao/OgreIndexBufferPacked.h"
+#include "Vao/OgreReadOnlyBufferPacked.h"
+#include "Vao/OgreTlsfAllocator.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+using namespace Demo;
+
+/// Like OGRE_ASSERT, but also active in Release builds so the tests can't pass vacuously.
+#define INTERNAL_CORE_CHECK( condition ) \
+    do \
+    { \
+        if( !( condition ) ) \
+            OGRE_EXCEPT( Ogre::Exception::ERR_RT_ASSERTION_FAILED, #condition, __FUNCTION__ ); \
+    } while( 0 )
+
+namespace
+{
+    /// Reference conversion: unpack & pack every pixel through float.
+    void naiveBulkPixelConversion( const Ogre::TextureBox &src, Ogre::PixelFormatGpu srcFormat,
+                                   Ogre::TextureBox &dst, Ogre::PixelFormatGpu dstFormat )
+    {
+        using namespace Ogre;
+
+        float rgba[4];
+        for( uint32 y = 0; y < src.height; ++y )
+        {
+            const uint8 *srcPtr = reinterpret_cast<const uint8 *>( src.at( 0, y, 0 ) );
+            uint8 *dstPtr = reinterpret_cast<uint8 *>( dst.at( 0, y, 0 ) );
+            for( uint32 x = 0; x < src.width; ++x )
+            {
+                PixelFormatGpuUtils::unpackColour( rgba, srcFormat, srcPtr );
+                PixelFormatGpuUtils::packColour( rgba, dstFormat, dstPtr );
+                srcPtr += src.bytesPerPixel;
+                dstPtr += dst.bytesPerPixel;
+            }
+        }
+    }
+
+    /// Reference decoder for the colour block of BC1 & BC3 (BC3 always uses 4-colour mode).
+    void decodeBC1Colour( const Ogre::uint8 *block, bool alwaysFourColours,
+                          Ogre::uint8 outTexels[16][4] )
+    {
+        using namespace Ogre;
+
+        const uint32 colours[2] = { uint32( block[0] ) | ( uint32( block[1] ) << 8u ),
+                                    uint32( block[2] ) | ( uint32( block[3] ) << 8u ) };
+
+        int32 palette[4][4];
+        for( size_t i = 0u; i < 2u; ++i )
+        {
+            const uint32 r = ( colours[i] >> 11u ) & 0x1Fu;
+            const uint32 g = ( colours[i] >> 5u ) & 0x3Fu;
+            const uint32 b = colours[i] & 0x1Fu;
+            palette[i][0] = int32( ( r << 3u ) | ( r >> 2u ) );
+            palette[i][1] = int32( ( g << 2u ) | ( g >> 4u ) );
+            palette[i][2] = int32( ( b << 3u ) | ( b >> 2u ) );
+            palette[i][3] = 255;
+        }
+
+        const bool fourColours = alwaysFourColours || colours[0] > colours[1];
+        for( size_t c = 0u; c < 4u; ++c )
+        {
+            if( fourColours )
+            {
+                palette[2][c] = ( 2 * palette[0][c] + palette[1][c] ) / 3;
+                palette[3][c] = ( palette[0][c] + 2 * palette[1][c] ) / 3;
+            }
+            else
+            {
+                palette[2][c] = ( palette[0][c] + palette[1][c] ) / 2;
+                palette[3][c] = 0;
+            }
+        }
+
+        const uint32 indices = uint32( block[4] ) | ( uint32( block[5] ) << 8u ) |
+                               ( uint32( block[6] ) << 16u ) | ( uint32( block[7] ) << 24u );
+        for( size_t i = 0u; i < 16u; ++i )
+        {
+            const uint32 idx = ( indices >> ( i * 2u ) ) & 0x03u;
+            for( size_t c = 0u; c < 4u; ++c )
+                outTexels[i][c] = static_cast<uint8>( palette[idx][c] );
+        }
+    }
+
+    /// Reference decoder for the unorm single channel blocks of BC3 (alpha), BC4 & BC5.
+    void decodeBC4Channel( const Ogre::uint8 *block, size_t channel, Ogre::uint8 outTexels[16][4] )
+    {
+        using namespace Ogre;
+
+        int32 palette[8];
+        palette[0] = block[0];
+        palette[1] = block[1];
+        if( palette[0] > palette[1] )
+        {
+            for( int32 j = 1; j < 7; ++j )
+                palette[j + 1] = ( ( 7 - j ) * palette[0] + j * palette[1] ) / 7;
+        }
+        else
+        {
+            for( int32 j = 1; j < 5; ++j )
+                palette[j + 1] = ( ( 5 - j ) * palette[0] + j * palette[1] ) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        uint64 indices = 0u;
+        for( size_t i = 0u; i < 6u; ++i )
+            indices |= uint64( block[2u + i] ) << ( i * 8u );
+        for( size_t i = 0u; i < 16u; ++i )
+            outTexels[i][channel] = static_cast<uint8>( palette[( indices >> ( i * 3u ) ) & 0x07u] );
+    }
+
+    /// Reference decoder for BC7 mode 6 blocks (the only mode BCnEncoder outputs).
+    void decodeBC7Mode6( const Ogre::uint8 *block, Ogre::uint8 outTexels[16][4] )
+    {
+        using namespace Ogre;
+
+        static const uint32 c_weights4[16] = { 0,  4,  9,  13, 17, 21, 26, 30,
+                                               34, 38, 43, 47, 51, 55, 60, 64 };
+
+        size_t bitOffset = 0u;
+        auto readBits = [&]( size_t numBits )
+        {
+            uint32 value = 0u;
+            for( size_t i = 0u; i < numBits; ++i )
+            {
+                value |= uint32( ( block[bitOffset >> 3u] >> ( bitOffset & 0x07u ) ) & 0x01u ) << i;
+                ++bitOffset;
+            }
+            return value;
+        };
+
+        INTERNAL_CORE_CHECK( readBits( 7u ) == ( 1u << 6u ) );
+
+        uint32 endpoints[2][4];
+        for( size_t c = 0u; c < 4u; ++c )
+        {
+            endpoints[0][c] = readBits( 7u ) << 1u;
+            endpoints[1][c] = readBits( 7u ) << 1u;
+        }
+        for( size_t i = 0u; i < 2u; ++i )
+        {
+            const uint32 pBit = readBits( 1u );
+            for( size_t c = 0u; c < 4u; ++c )
+                endpoints[i][c] |= pBit;
+        }
+
+        for( size_t i = 0u; i < 16u; ++i )
+        {
+            const uint32 w = c_weights4[readBits( i == 0u ? 3u : 4u )];
+            for( size_t c = 0u; c < 4u; ++c )
+            {
+                outTexels[i][c] = static_cast<uint8>(
+                    ( ( 64u - w ) * endpoints[0][c] + w * endpoints[1][c] + 32u ) >> 6u );
+            }
+        }
+    }
+
+    const Ogre::uint16 c_quadIndexData[6] = { 0u, 1u, 2u, 0u, 2u, 3u };
+
+    /// Vertices of a 2x2 quad on the XZ plane, at the given height.
+    void getQuadVertexData( float height, float outVertexData[4][3] )
+    {
+        for( size_t i = 0u; i < 4u; ++i )
+        {
+            outVertexData[i][0] = ( i == 0u || i == 3u ) ? -1.0f : 1.0f;
+            outVertexData[i][1] = height;
+            outVertexData[i][2] = i < 2u ? -1.0f : 1.0f;
+        }
+    }
+
+    /// Manual mesh with a single quad made of getQuadVertexData() & c_quadIndexData.
+    Ogre::MeshPtr createQuadMesh( Ogre::VaoManager *vaoManager, const Ogre::String &name,
+                                  float height )
+    {
+        using namespace Ogre;
+
+        float vertexData[4][3];
+        getQuadVertexData( height, vertexData );
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( vaoManager->createVertexBuffer( vertexElements, 4u, BT_IMMUTABLE,
+                                                                 &vertexData[0][0], false ) );
+        IndexBufferPacked *indexBuffer =
+            vaoManager->createIndexBuffer( IndexBufferPacked::IT_16BIT, 6u, BT_IMMUTABLE,
+                                           const_cast<uint16 *>( c_quadIndexData ), false );
+
+        MeshPtr mesh = MeshManager::getSingleton().createManual(
+            name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+        SubMesh *subMesh = mesh->createSubMesh();
+        subMesh->mVao[VpNormal].push_back(
+            vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer, OT_TRIANGLE_LIST ) );
+        subMesh->mVao[VpShadow].push_back( subMesh->mVao[VpNormal][0] );
+        mesh->_setBounds( Aabb( Vector3( 0.0f, height, 0.0f ), Vector3( 1.0f, 0.0f, 1.0f ) ), false );
+        mesh->_setBoundingSphereRadius( Vector3( 1.0f, height, 1.0f ).length() );
+        return mesh;
+    }
+
+    /// Root bone with one child. "Up" moves both along Y and "Side" along X, 10 units in
+    /// 10 seconds.
+    Ogre::v1::SkeletonPtr createTwoBoneSkeleton( const Ogre::String &name )
+    {
+        using namespace Ogre;
+
+        v1::SkeletonPtr oldSkeleton = v1::OldSkeletonManager::getSingleton().create(
+            name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, true );
+        oldSkeleton->createBone( "Root", 0u )->addChild( oldSkeleton->createBone( "Child", 1u ) );
+        oldSkeleton->setBindingPose();
+        const char *animNames[2] = { "Up", "Side" };
+        for( size_t i = 0u; i < 2u; ++i )
+        {
+            v1::Animation *animation = oldSkeleton->createAnimation( animNames[i], 10.0f );
+            for( unsigned short j = 0u; j < 2u; ++j )
+            {
+                v1::OldNodeAnimationTrack *track = animation->createOldNodeTrack( j );
+                track->createNodeKeyFrame( 0.0f )->setTranslate( Vector3::ZERO );
+                track->createNodeKeyFrame( 10.0f )->setTranslate(
+                    i == 0u ? Vector3( 0.0f, 10.0f, 0.0f ) : Vector3( 10.0f, 0.0f, 0.0f ) );
+            }
+        }
+        return oldSkeleton;
+    }
+
+    /// Emitter placing each particle at mLocalPositionFunc( handle ) in emitter space. Unless
+    /// the test says otherwise, particles don't move and live for 100 seconds.
+    /// It records which handles it emitted, and how many were written as whole SIMD packs.
+    class TestEmitter final : public Ogre::EmitterDefData
+    {
+    public:
+        typedef Ogre::Vector3 ( *LocalPositionFunc )( Ogre::uint32 handle );
+
+    private:
+        Ogre::String      mType;
+        LocalPositionFunc mLocalPositionFunc;
+
+    public:
+        std::mutex             mMutex;
+        std::set<Ogre::uint32> mEmittedHandles;
+        size_t                 mNumDuplicatedHandles;
+        size_t                 mNumWholePacks;
+
+        TestEmitter( const Ogre::String &type, LocalPositionFunc localPositionFunc ) :
+            mType( type ),
+            mLocalPositionFunc( localPositionFunc ),
+            mNumDuplicatedHandles( 0u ),
+            mNumWholePacks( 0u )
+        {
+            setParticleVelocity( 0.0f );
+            setTimeToLive( 100.0f );
+        }
+
+        void initEmittedParticles( Ogre::ParticleCpuData cpuData,
+                                   const Ogre::EmittedParticle *newHandles,
+                                   size_t numParticles ) override
+        {
+            using namespace Ogre;
+
+            {
+                std::lock_guard<std::mutex> lock( mMutex );
+                for( size_t i = 0u; i < numParticles; ++i )
+                {
+                    if( !mEmittedHandles.insert( newHandles[i].handle ).second )
+                        ++mNumDuplicatedHandles;
+                }
+            }
+
+            size_t i = 0u;
+            while( i < numParticles )
+            {
+                const size_t numInPack = getNextPackSize( newHandles + i, numParticles - i );
+                Vector3 localPos[ARRAY_PACKED_REALS];
+                for( size_t k = 0u; k < numInPack; ++k )
+                    localPos[k] = mLocalPositionFunc( newHandles[i + k].handle );
+
+                if( initEmittedParticlesPack( cpuData, newHandles + i, localPos, numInPack ) )
+                {
+                    std::lock_guard<std::mutex> lock( mMutex );
+                    ++mNumWholePacks;
+                }
+                i += numInPack;
+            }
+        }
+
+        const Ogre::String &getType() const override { return mType; }
+    };
+
+    /// Registers itself with ParticleSystemManager2 for as long as it lives.
+    class TestEmitterFactory final : public Ogre::ParticleEmitterDefDataFactory
+    {
+        Ogre::String                   mName;
+        TestEmitter::LocalPositionFunc mLocalPositionFunc;
+
+    public:
+        TestEmitter *mLastCreated;
+
+        TestEmitterFactory( const Ogre::String &name,
+                            TestEmitter::LocalPositionFunc localPositionFunc ) :
+            mName( name ),
+            mLocalPositionFunc( localPositionFunc ),
+            mLastCreated( 0 )
+        {
+            Ogre::ParticleSystemManager2::addEmitterFactory( this );
+        }
+        ~TestEmitterFactory() override { Ogre::ParticleSystemManager2::removeEmitterFactory( this ); }
+
+        const Ogre::String &getName() const override { return mName; }
+
+        Ogre::EmitterDefData *createEmitter() override
+        {
+            return mLastCreated = new TestEmitter( mName, mLocalPositionFunc );
+        }
+    };
+}  // namespace
+
+InternalCoreGameState::InternalCoreGameState( const Ogre::String &helpDescription ) :
+    TutorialGameState( helpDescription )
+{
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testBulkPixelConversion()
+{
+    using namespace Ogre;
+
+    struct FormatPair
+    {
+        PixelFormatGpu srcFormat;
+        PixelFormatGpu dstFormat;
+    };
+
+    const FormatPair formatPairs[] = {
+        { PFG_RGBA8_UNORM, PFG_BGRA8_UNORM },           //
+        { PFG_BGRA8_UNORM, PFG_RGBA8_UNORM },           //
+        { PFG_RGB8_UNORM, PFG_RGBA8_UNORM },            //
+        { PFG_RGB8_UNORM, PFG_BGRA8_UNORM },            //
+        { PFG_BGR8_UNORM, PFG_RGBA8_UNORM },            //
+        { PFG_RGBA8_UNORM, PFG_RGB8_UNORM },            //
+        { PFG_RGBA8_UNORM_SRGB, PFG_RGBA8_UNORM },      //
+        { PFG_RGBA8_UNORM, PFG_RGBA8_UNORM_SRGB },      //
+        { PFG_BGRA8_UNORM_SRGB, PFG_RGBA8_UNORM },      //
+        { PFG_RGBA8_UNORM, PFG_BGRA8_UNORM_SRGB },      //
+        { PFG_RGB8_UNORM_SRGB, PFG_RGBA8_UNORM },       //
+        { PFG_RGBA16_FLOAT, PFG_RGBA32_FLOAT },         //
+        { PFG_RGBA32_FLOAT, PFG_RGBA16_FLOAT },         //
+        { PFG_RG16_FLOAT, PFG_RG32_FLOAT },             //
+        { PFG_RG32_FLOAT, PFG_RG16_FLOAT },             //
+        { PFG_R16_FLOAT, PFG_R32_FLOAT },               //
+        { PFG_R32_FLOAT, PFG_R16_FLOAT },               //
+        { PFG_RGBA8_UNORM, PFG_R8_UNORM },              //
+        { PFG_R8_UNORM, PFG_RGBA8_UNORM },              //
+        { PFG_BGRA8_UNORM, PFG_R8_UNORM },              //
+        { PFG_R8_UNORM, PFG_BGRA8_UNORM },              //
+        { PFG_RGB8_UNORM, PFG_BGR8_UNORM },             //
+        { PFG_BGR8_UNORM, PFG_RGB8_UNORM },             //
+        { PFG_RGB8_UNORM, PFG_BGRA8_UNORM },            //
+        { PFG_BGRA8_UNORM, PFG_RGB8_UNORM },            //
+        { PFG_R8_UNORM, PFG_R16_UNORM },                //
+        { PFG_R16_UNORM, PFG_R8_UNORM },
+    };
+
+    const uint32 width = 512u;
+    const uint32 height = 512u;
+    const size_t maxBytes = width * height * 16u;
+
+    uint8 *srcData = reinterpret_cast<uint8 *>( OGRE_MALLOC_SIMD( maxBytes, MEMCATEGORY_GENERAL ) );
+    uint8 *fastData = reinterpret_cast<uint8 *>( OGRE_MALLOC_SIMD( maxBytes, MEMCATEGORY_GENERAL ) );
+    uint8 *refData = reinterpret_cast<uint8 *>( OGRE_MALLOC_SIMD( maxBytes, MEMCATEGORY_GENERAL ) );
+
+    // Reproducible pseudo-random data
+    uint32 seed = 12345u;
+    for( size_t i = 0u; i < maxBytes; ++i )
+    {
+        seed = seed * 1664525u + 1013904223u;
+        srcData[i] = static_cast<uint8>( seed >> 24u );
+    }
+
+    Timer timer;
+    const size_t numPairs = sizeof( formatPairs ) / sizeof( formatPairs[0] );
+    for( size_t i = 0u; i < numPairs; ++i )
+    {
+        const PixelFormatGpu srcFormat = formatPairs[i].srcFormat;
+        const PixelFormatGpu dstFormat = formatPairs[i].dstFormat;
+
+        const uint32 srcBpp = PixelFormatGpuUtils::getBytesPerPixel( srcFormat );
+        const uint32 dstBpp = PixelFormatGpuUtils::getBytesPerPixel( dstFormat );
+
+        TextureBox srcBox( width, height, 1u, 1u, srcBpp, width * srcBpp, width * height * srcBpp );
+        TextureBox fastBox( width, height, 1u, 1u, dstBpp, width * dstBpp, width * height * dstBpp );
+        TextureBox refBox( fastBox );
+        srcBox.data = srcData;
+        fastBox.data = fastData;
+        refBox.data = refData;
+
+        timer.reset();
+        PixelFormatGpuUtils::bulkPixelConversion( srcBox, srcFormat, fastBox, dstFormat );
+        const uint64 fastUs = timer.getMicroseconds();
+
+        timer.reset();
+        naiveBulkPixelConversion( srcBox, srcFormat, refBox, dstFormat );
+        const uint64 refUs = timer.getMicroseconds();
+
+        INTERNAL_CORE_CHECK( memcmp( fastData, refData, fastBox.getSizeBytes() ) == 0 );
+
+        LogManager::getSingleton().logMessage(
+            "bulkPixelConversion " + String( PixelFormatGpuUtils::toString( srcFormat ) ) + " -> " +
+            PixelFormatGpuUtils::toString( dstFormat ) + ": " + StringConverter::toString( fastUs ) +
+            "us (brute force: " + StringConverter::toString( refUs ) + "us)" );
+    }
+
+    OGRE_FREE_SIMD( srcData, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( fastData, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( refData, MEMCATEGORY_GENERAL );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testNormalMapConversion()
+{
+    using namespace Ogre;
+
+    const PixelFormatGpu srcFormats[] = {
+        PFG_RGBA8_UNORM,  PFG_BGRA8_UNORM,  PFG_RGB8_UNORM,   PFG_RG8_UNORM,   PFG_RGBA8_SNORM,
+        PFG_RG8_SNORM,    PFG_RGBA16_UNORM, PFG_RG16_UNORM,   PFG_RGBA16_SNORM, PFG_RG16_SNORM,
+        PFG_RGBA16_FLOAT, PFG_RG16_FLOAT,   PFG_RGBA32_FLOAT, PFG_RGB32_FLOAT, PFG_RG32_FLOAT,
+        PFG_R10G10B10A2_UNORM,
+    };
+    const PixelFormatGpu dstFormats[] = { PFG_RG8_SNORM, PFG_RG8_UNORM };
+
+    const uint32 width = 509u;  // Not a multiple of the SIMD width
+    const uint32 height = 512u;
+    const size_t maxBytes = width * height * 16u;
+
+    uint8 *srcData = reinterpret_cast<uint8 *>( OGRE_MALLOC_SIMD( maxBytes, MEMCATEGORY_GENERAL ) );
+    uint8 *fastData = reinterpret_cast<uint8 *>( OGRE_MALLOC_SIMD( maxBytes, MEMCATEGORY_GENERAL ) );
+    uint8 *refData = reinterpret_cast<uint8 *>( OGRE_MALLOC_SIMD( maxBytes, MEMCATEGORY_GENERAL ) );
+
+    Timer timer;
+    const size_t numSrcFormats = sizeof( srcFormats ) / sizeof( srcFormats[0] );
+    for( size_t i = 0u; i < numSrcFormats; ++i )
+    {
+        const PixelFormatGpu srcFormat = srcFormats[i];
+        const uint32 srcBpp = PixelFormatGpuUtils::getBytesPerPixel( srcFormat );
+        TextureBox srcBox( width, height, 1u, 1u, srcBpp, width * srcBpp, width * height * srcBpp );
+        srcBox.data = srcData;
+
+        // Reproducible pseudo-random data slightly outside the [0; 1] range.
+        // Packing it keeps float formats free of NaNs.
+        uint32 seed = 12345u;
+        for( uint32 y = 0; y < height; ++y )
+        {
+            uint8 *srcPtr = reinterpret_cast<uint8 *>( srcBox.at( 0, y, 0 ) );
+            for( uint32 x = 0; x < width; ++x )
+            {
+                float rgba[4];
+                for( size_t c = 0u; c < 4u; ++c )
+                {
+                    seed = seed * 1664525u + 1013904223u;
+                    rgba[c] = float( seed >> 8u ) / float( 1u << 24u ) * 1.5f - 0.25f;
+                }
+                PixelFormatGpuUtils::packColour( rgba, srcFormat, srcPtr );
+                srcPtr += srcBpp;
+            }
+        }
+
+        const PixelFormatGpuUtils::PixelFormatLayout srcLayout =
+            PixelFormatGpuUtils::getPixelLayout( srcFormat );
+        const bool b8bit = srcLayout == PixelFormatGpuUtils::PFL_RGBA8 ||
+                           srcLayout == PixelFormatGpuUtils::PFL_BGRA8 ||
+                           srcLayout == PixelFormatGpuUtils::PFL_RGB8 ||
+                           srcLayout == PixelFormatGpuUtils::PFL_RG8;
+        const size_t rOffset = srcLayout == PixelFormatGpuUtils::PFL_BGRA8 ? 2u : 0u;
+
+        for( size_t j = 0u; j < 2u; ++j )
+        {
+            const PixelFormatGpu dstFormat = dstFormats[j];
+            TextureBox fastBox( width, height, 1u, 1u, 2u, width * 2u, width * height * 2u );
+            TextureBox refBox( fastBox );
+            fastBox.data = fastData;
+            refBox.data = refData;
+
+            timer.reset();
+            PixelFormatGpuUtils::convertForNormalMapping( srcBox, srcFormat, fastBox, dstFormat );
+            const uint64 fastUs = timer.getMicroseconds();
+
+            // Reference: 8-bit formats only swap the sign (if it differs), everything
+            // else goes per pixel through float (i.e. rgba * 2 - 1 into RG8_SNORM)
+            const float multPart = dstFormat == PFG_RG8_UNORM ? 1.0f : 2.0f;
+            const float addPart = dstFormat == PFG_RG8_UNORM ? 0.0f : 1.0f;
+            const uint8 signFlip =
+                PixelFormatGpuUtils::isSigned( srcFormat ) != PixelFormatGpuUtils::isSigned( dstFormat )
+                    ? 0x80u
+                    : 0u;
+
+            timer.reset();
+            for( uint32 y = 0; y < height; ++y )
+            {
+                const uint8 *srcPtr = reinterpret_cast<const uint8 *>( srcBox.at( 0, y, 0 ) );
+                uint8 *dstPtr = reinterpret_cast<uint8 *>( refBox.at( 0, y, 0 ) );
+                for( uint32 x = 0; x < width; ++x )
+                {
+                    if( b8bit )
+                    {
+                        dstPtr[0] = srcPtr[rOffset] ^ signFlip;
+                        dstPtr[1] = srcPtr[1] ^ signFlip;
+                    }
+                    else
+                    {
+                        float rgba[4];
+                        PixelFormatGpuUtils::unpackColour( rgba, srcFormat, srcPtr );
+                        const int8 rg[2] = { Bitwise::floatToSnorm8( rgba[0] * multPart - addPart ),
+                                             Bitwise::floatToSnorm8( rgba[1] * multPart - addPart ) };
+                        memcpy( dstPtr, rg, sizeof( rg ) );
+                    }
+                    srcPtr += srcBpp;
+                    dstPtr += 2u;
+                }
+            }
+            const uint64 refUs = timer.getMicroseconds();
+
+            INTERNAL_CORE_CHECK( memcmp( fastData, refData, fastBox.getSizeBytes() ) == 0 );
+
+            LogManager::getSingleton().logMessage(
+                "convertForNormalMapping " + String( PixelFormatGpuUtils::toString( srcFormat ) ) +
+                " -> " + PixelFormatGpuUtils::toString( dstFormat ) + ": " +
+                StringConverter::toString( fastUs ) +
+                "us (per pixel: " + StringConverter::toString( refUs ) + "us)" );
+        }
+    }
+
+    OGRE_FREE_SIMD( srcData, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( fastData, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( refData, MEMCATEGORY_GENERAL );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testBCnEncoder()
+{
+    using namespace Ogre;
+
+    struct EncoderCase
+    {
+        PixelFormatGpu srcFormat;
+        PixelFormatGpu dstFormat;
+        size_t numChannels;
+        float minPsnr;
+    };
+
+    const EncoderCase encoderCases[] = {
+        { PFG_RGBA8_UNORM, PFG_BC1_UNORM, 3u, 32.0f },  //
+        { PFG_RGBA8_UNORM, PFG_BC3_UNORM, 4u, 32.0f },  //
+        { PFG_R8_UNORM, PFG_BC4_UNORM, 1u, 38.0f },     //
+        { PFG_RG8_UNORM, PFG_BC5_UNORM, 2u, 38.0f },    //
+        { PFG_RGBA8_UNORM, PFG_BC7_UNORM, 4u, 34.0f },
+    };
+
+    // Big enough for BCnEncoder to actually spread the work across threads
+    const uint32 width = 512u;
+    const uint32 height = 512u;
+
+    Timer timer;
+    const size_t numCases = sizeof( encoderCases ) / sizeof( encoderCases[0] );
+    for( size_t i = 0u; i < numCases; ++i )
+    {
+        const EncoderCase &encoderCase = encoderCases[i];
+
+        Image2 srcImage;
+        srcImage.createEmptyImage( width, height, 1u, TextureTypes::Type2D, encoderCase.srcFormat );
+        const TextureBox srcBox = srcImage.getData( 0u );
+
+        // Smooth gradients with a bit of noise, like most albedo & normal maps
+        uint32 seed = 12345u;
+        for( uint32 y = 0u; y < height; ++y )
+        {
+            for( uint32 x = 0u; x < width; ++x )
+            {
+                uint8 *texel = reinterpret_cast<uint8 *>( srcBox.at( x, y, 0u ) );
+                for( size_t c = 0u; c < srcBox.bytesPerPixel; ++c )
+                {
+                    const float phase = float( x ) * ( 0.02f + 0.01f * float( c ) ) +
+                                        float( y ) * ( 0.03f - 0.005f * float( c ) );
+                    const float wave = 0.5f + 0.5f * std::sin( phase );
+                    seed = seed * 1664525u + 1013904223u;
+                    const int32 noise = int32( seed >> 29u ) - 4;
+                    texel[c] = static_cast<uint8>(
+                        Math::Clamp<int32>( int32( wave * 255.0f ) + noise, 0, 255 ) );
+                }
+            }
+        }
+
+        Image2 singleThreaded;
+        Image2 multiThreaded;
+        singleThreaded.createEmptyImage( width, height, 1u, TextureTypes::Type2D,
+                                         encoderCase.dstFormat );
+        multiThreaded.createEmptyImage( width, height, 1u, TextureTypes::Type2D,
+                                        encoderCase.dstFormat );
+        TextureBox singleThreadedBox = singleThreaded.getData( 0u );
+        TextureBox multiThreadedBox = multiThreaded.getData( 0u );
+
+        timer.reset();
+        BCnEncoder::compress( srcBox, encoderCase.srcFormat, singleThreadedBox,
+                              encoderCase.dstFormat, 1u );
+        const uint64 singleThreadedUs = timer.getMicroseconds();
+        timer.reset();
+        BCnEncoder::compress( srcBox, encoderCase.srcFormat, multiThreadedBox,
+                              encoderCase.dstFormat, 4u );
+        const uint64 multiThreadedUs = timer.getMicroseconds();
+
+        // Splitting the work must not change the output
+        INTERNAL_CORE_CHECK( memcmp( singleThreadedBox.data, multiThreadedBox.data,
+                                     singleThreadedBox.getSizeBytes() ) == 0 );
+
+        double sqError = 0.0;
+        for( uint32 y = 0u; y < height; y += 4u )
+        {
+            for( uint32 x = 0u; x < width; x += 4u )
+            {
+                const uint8 *block = reinterpret_cast<const uint8 *>( multiThreadedBox.at( x, y, 0u ) );
+
+                uint8 decoded[16][4];
+                memset( decoded, 0, sizeof( decoded ) );
+                switch( encoderCase.dstFormat )
+                {
+                case PFG_BC1_UNORM:
+                    decodeBC1Colour( block, false, decoded );
+                    break;
+                case PFG_BC3_UNORM:
+                    decodeBC1Colour( block + 8u, true, decoded );
+                    decodeBC4Channel( block, 3u, decoded );
+                    break;
+                case PFG_BC4_UNORM:
+                    decodeBC4Channel( block, 0u, decoded );
+                    break;
+                case PFG_BC5_UNORM:
+                    decodeBC4Channel( block, 0u, decoded );
+                    decodeBC4Channel( block + 8u, 1u, decoded );
+                    break;
+                default:
+                    decodeBC7Mode6( block, decoded );
+                    break;
+                }
+
+                for( uint32 j = 0u; j < 16u; ++j )
+                {
+                    const uint8 *texel = reinterpret_cast<const uint8 *>(
+                        srcBox.at( x + ( j & 0x03u ), y + ( j >> 2u ), 0u ) );
+                    for( size_t c = 0u; c < encoderCase.numChannels; ++c )
+                    {
+                        const double diff = double( texel[c] ) - double( decoded[j][c] );
+                        sqError += diff * diff;
+                    }
+                }
+            }
+        }
+
+        const double mse = sqError / double( size_t( width ) * height * encoderCase.numChannels );
+        const float psnr = static_cast<float>( 10.0 * std::log10( 255.0 * 255.0 / mse ) );
+
+        LogManager::getSingleton().logMessage(
+            "BCnEncoder " + String( PixelFormatGpuUtils::toString( encoderCase.dstFormat ) ) +
+            ": PSNR " + StringConverter::toString( psnr ) + "dB, " +
+            StringConverter::toString( singleThreadedUs ) + "us (4 threads: " +
+            StringConverter::toString( multiThreadedUs ) + "us)" );
+
+        INTERNAL_CORE_CHECK( psnr >= encoderCase.minPsnr );
+    }
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testFilteredTextureCache()
+{
+    using namespace Ogre;
+
+    Root *root = mGraphicsSystem->getRoot();
+    TextureGpuManager *textureManager = root->getRenderSystem()->getTextureGpuManager();
+
+    const String oldFolder = textureManager->getFilteredTextureCacheFolder();
+    const DefaultMipmapGen::DefaultMipmapGen oldMipmapGen =
+        textureManager->getDefaultMipmapGeneration();
+    const DefaultMipmapGen::DefaultMipmapGen oldMipmapGenCubemaps =
+        textureManager->getDefaultMipmapGenerationCubemaps();
+
+    const uint8 fileData[] = { 'N', 'o', 't', ' ', 'a', 'n', ' ', 'i', 'm', 'a', 'g', 'e' };
+    const uint32 filters = TextureFilter::TypeGenerateDefaultMipmaps | TextureFilter::TypeCompressBCn;
+
+    textureManager->setFilteredTextureCacheFolder( BLANKSTRING );
+    INTERNAL_CORE_CHECK(
+        textureManager->_getFilteredCachePath( fileData, sizeof( fileData ), filters, false )
+            .empty() );
+
+    textureManager->setFilteredTextureCacheFolder( "FilteredCacheTest" );
+    textureManager->setDefaultMipmapGeneration( DefaultMipmapGen::HwMode, DefaultMipmapGen::SwMode );
+
+    const String path =
+        textureManager->_getFilteredCachePath( fileData, sizeof( fileData ), filters, false );
+    INTERNAL_CORE_CHECK( StringUtil::startsWith( path, "FilteredCacheTest/", false ) );
+    INTERNAL_CORE_CHECK( StringUtil::endsWith( path, ".oitd", false ) );
+    INTERNAL_CORE_CHECK( path == textureManager->_getFilteredCachePath( fileData, sizeof( fileData ),
+                                                                        filters, false ) );
+
+    // Every input that changes the filters' output must change the key
+    std::set<String> paths;
+    paths.insert( path );
+    paths.insert(
+        textureManager->_getFilteredCachePath( fileData, sizeof( fileData ) - 1u, filters, false ) );
+    paths.insert( textureManager->_getFilteredCachePath(
+        fileData, sizeof( fileData ), filters | TextureFilter::TypeCompressBC7, false ) );
+    paths.insert(
+        textureManager->_getFilteredCachePath( fileData, sizeof( fileData ), filters, true ) );
+    textureManager->setDefaultMipmapGeneration( DefaultMipmapGen::SwMode, DefaultMipmapGen::SwMode );
+    paths.insert(
+        textureManager->_getFilteredCachePath( fileData, sizeof( fileData ), filters, false ) );
+    textureManager->setDefaultMipmapGeneration( DefaultMipmapGen::HwMode, DefaultMipmapGen::HwMode );
+    paths.insert(
+        textureManager->_getFilteredCachePath( fileData, sizeof( fileData ), filters, false ) );
+    INTERNAL_CORE_CHECK( paths.size() == 6u );
+
+    textureManager->setDefaultMipmapGeneration( DefaultMipmapGen::HwMode, DefaultMipmapGen::SwMode );
+    INTERNAL_CORE_CHECK( path == textureManager->_getFilteredCachePath( fileData, sizeof( fileData ),
+                                                                        filters, false ) );
+
+    // Concurrent jobs saving the same entry must not share their temporary file
+    std::set<String> tmpPaths;
+    for( size_t i = 0u; i < 16u; ++i )
+    {
+        const String tmpPath = textureManager->_getFilteredCacheTmpPath( path );
+        INTERNAL_CORE_CHECK( tmpPath != path );
+        INTERNAL_CORE_CHECK( StringUtil::startsWith( tmpPath, path, false ) );
+        tmpPaths.insert( tmpPath );
+    }
+    INTERNAL_CORE_CHECK( tmpPaths.size() == 16u );
+
+    textureManager->setDefaultMipmapGeneration( oldMipmapGen, oldMipmapGenCubemaps );
+    textureManager->setFilteredTextureCacheFolder( oldFolder );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testAsyncTextureReadbackBatcher()
+{
+    using namespace Ogre;
+
+    // Requests the next readback from inside the callback, like a continuous capture would.
+    struct ChainedReadbackListener final : public AsyncTextureReadbackListener
+    {
+        AsyncTextureReadbackBatcher *batcher;
+        size_t numDelivered;
+        size_t numToRequest;
+
+        void readbackFinished( TextureGpu *texture, uint8 mipLevel, const TextureBox &box,
+                               PixelFormatGpu, void * ) override
+        {
+            INTERNAL_CORE_CHECK( box.width == texture->getWidth() );
+            ++numDelivered;
+            if( numToRequest > 0u )
+            {
+                --numToRequest;
+                batcher->download( texture, mipLevel, this );
+            }
+        }
+    };
+
+    TextureGpuManager *textureManager =
+        mGraphicsSystem->getRoot()->getRenderSystem()->getTextureGpuManager();
+
+    TextureGpu *texture = textureManager->createTexture(
+        "testAsyncTextureReadbackBatcher", GpuPageOutStrategy::Discard, TextureFlags::ManualTexture,
+        TextureTypes::Type2D );
+    texture->setResolution( 16u, 16u );
+    texture->setPixelFormat( PFG_RGBA8_UNORM );
+    texture->scheduleTransitionTo( GpuResidency::Resident );
+
+    {
+        AsyncTextureReadbackBatcher batcher( textureManager, AsyncTextureReadbackBatcher::Immediate );
+
+        ChainedReadbackListener listener;
+        listener.batcher = &batcher;
+        listener.numDelivered = 0u;
+        listener.numToRequest = 3u;
+
+        batcher.download( texture, 0u, &listener );
+        batcher.download( texture, 0u, &listener );
+
+        // Requests made by the listener are delivered by the next update()
+        const size_t expectedDelivered[3] = { 2u, 4u, 5u };
+        const size_t expectedInFlight[3] = { 2u, 1u, 0u };
+        for( size_t i = 0u; i < 3u; ++i )
+        {
+            batcher.update( true );
+            INTERNAL_CORE_CHECK( listener.numDelivered == expectedDelivered[i] );
+            INTERNAL_CORE_CHECK( batcher.getStats().numInFlight == expectedInFlight[i] );
+        }
+        INTERNAL_CORE_CHECK( batcher.getStats().numCompleted == 5u );
+    }
+
+    textureManager->destroyTexture( texture );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testAutomaticBatching()
+{
+    using namespace Ogre;
+
+    TextureGpuManager *textureManager =
+        mGraphicsSystem->getRoot()->getRenderSystem()->getTextureGpuManager();
+
+    const uint32 oldMaxResolution = textureManager->getAutomaticBatchingMaxResolution();
+    textureManager->setAutomaticBatchingMaxResolution( 64u );
+
+    TextureGpu *texture = textureManager->createTexture(
+        "testAutomaticBatching", GpuPageOutStrategy::Discard, 0u, TextureTypes::Type2D );
+    texture->setResolution( 32u, 32u );
+    texture->setPixelFormat( PFG_RGBA8_UNORM );
+    INTERNAL_CORE_CHECK( !texture->hasAutomaticBatching() );
+
+    // Batched while Resident, without touching the user's flags
+    texture->_transitionTo( GpuResidency::Resident, 0 );
+    INTERNAL_CORE_CHECK( texture->hasAutomaticBatching() );
+    INTERNAL_CORE_CHECK( !( texture->getTextureFlags() & TextureFlags::AutomaticBatching ) );
+
+    texture->_transitionTo( GpuResidency::OnStorage, 0 );
+    INTERNAL_CORE_CHECK( !texture->hasAutomaticBatching() );
+    INTERNAL_CORE_CHECK( texture->getTextureFlags() == 0u );
+
+    // The policy is applied again, to the texture's current settings
+    texture->setResolution( 128u, 128u );
+    texture->_transitionTo( GpuResidency::Resident, 0 );
+    INTERNAL_CORE_CHECK( !texture->hasAutomaticBatching() );
+    texture->_transitionTo( GpuResidency::OnStorage, 0 );
+
+    textureManager->destroyTexture( texture );
+    textureManager->setAutomaticBatchingMaxResolution( oldMaxResolution );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testTlsfAllocator()
+{
+    using namespace Ogre;
+
+    const size_t capacity = 16u * 1024u * 1024u;
+    const size_t alignments[] = { 1u, 2u, 4u, 12u, 16u, 36u, 256u };
+
+    TlsfAllocator allocator( capacity );
+    typedef std::map<size_t, size_t> AllocationMap;
+    AllocationMap allocations;
+    vector<size_t>::type offsets;
+
+    srand( 101 );
+
+    for( size_t i = 0u; i < 100000u; ++i )
+    {
+        if( offsets.empty() || ( rand() % 100 ) < 55 )
+        {
+            const size_t sizeBytes = 1u + size_t( rand() % ( ( rand() % 10 ) == 0 ? 65536 : 2048 ) );
+            const size_t alignment = alignments[size_t( rand() ) % ( sizeof( alignments ) /
+                                                                   sizeof( alignments[0] ) )];
+            size_t offset;
+            if( allocator.allocate( sizeBytes, alignment, offset ) )
+            {
+                INTERNAL_CORE_CHECK( offset % alignment == 0u );
+                INTERNAL_CORE_CHECK( offset + sizeBytes <= capacity );
+
+                AllocationMap::const_iterator itor = allocations.lower_bound( offset );
+                INTERNAL_CORE_CHECK( itor == allocations.end() || itor->first >= offset + sizeBytes );
+                if( itor != allocations.begin() )
+                {
+                    --itor;
+                    INTERNAL_CORE_CHECK( itor->first + itor->second <= offset );
+                }
+
+                allocations[offset] = sizeBytes;
+                offsets.push_back( offset );
+            }
+        }
+        else
+        {
+            const size_t idx = size_t( rand() ) % offsets.size();
+            allocator.deallocate( offsets[idx], allocations[offsets[idx]] );
+            allocations.erase( offsets[idx] );
+            offsets[idx] = offsets.back();
+            offsets.pop_back();
+        }
+    }
+
+    size_t usedBytes = 0u;
+    for( AllocationMap::const_iterator itor = allocations.begin(); itor != allocations.end(); ++itor )
+        usedBytes += itor->second;
+    INTERNAL_CORE_CHECK( allocator.getFreeBytes() + usedBytes == capacity );
+
+    TlsfAllocator::Stats stats;
+    allocator.getStats( stats );
+    LogManager::getSingleton().logMessage(
+        "TlsfAllocator: " + StringConverter::toString( stats.numUsedBlocks ) + " used blocks, " +
+        StringConverter::toString( stats.numFreeBlocks ) + " free blocks. Fragmentation: " +
+        StringConverter::toString( stats.getFragmentation() ) );
+
+    for( AllocationMap::const_iterator itor = allocations.begin(); itor != allocations.end(); ++itor )
+        allocator.deallocate( itor->first, itor->second );
+
+    allocator.getStats( stats );
+    INTERNAL_CORE_CHECK( allocator.isEmpty() );
+    INTERNAL_CORE_CHECK( stats.numFreeBlocks == 1u && stats.largestFreeBlock == capacity );
+
+    // Fixed layout, packed back to back with padding in between (like D3D11 immutable pools).
+    // allocate() can't be relied on for this: the last block is an exact fit
+    const size_t layout[][2] = { { 0u, 1000u }, { 1008u, 3000u }, { 4008u, 36u }, { 4044u, 1000u } };
+    allocator.reset( 5044u );
+    for( size_t i = 0u; i < sizeof( layout ) / sizeof( layout[0] ); ++i )
+        allocator.allocateAt( layout[i][0], layout[i][1] );
+    allocator.getStats( stats );
+    INTERNAL_CORE_CHECK( stats.freeBytes == 8u && stats.numFreeBlocks == 1u );
+    for( size_t i = 0u; i < sizeof( layout ) / sizeof( layout[0] ); ++i )
+        allocator.deallocate( layout[i][0], layout[i][1] );
+    INTERNAL_CORE_CHECK( allocator.isEmpty() && allocator.getFreeBytes() == 5044u );
+
+    // A pool sized exactly to its first request (i.e. bigger than the default pool size)
+    allocator.reset( 5044u );
+    allocator.allocateAt( 0u, 5044u );
+    INTERNAL_CORE_CHECK( !allocator.isEmpty() && allocator.getLargestFreeBlock() == 0u );
+    allocator.deallocate( 0u, 5044u );
+    INTERNAL_CORE_CHECK( allocator.isEmpty() );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testVaoPoolGrowth()
+{
+    using namespace Ogre;
+
+    VaoManager *vaoManager = mGraphicsSystem->getRoot()->getRenderSystem()->getVaoManager();
+
+    // No RenderSystem uses default pools bigger than 64MB. The first three buffers
+    // overflow the first pool, and the last one is bigger than a whole default pool
+    const uint32 numVertices[4] = { 1536u * 1024u, 1536u * 1024u, 1536u * 1024u, 5120u * 1024u };
+    const size_t numBuffers = sizeof( numVertices ) / sizeof( numVertices[0] );
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back( VertexElement2( VET_UINT4, VES_POSITION ) );
+
+    VertexBufferPacked *vertexBuffers[numBuffers];
+    for( size_t i = 0u; i < numBuffers; ++i )
+    {
+        uint32 *data = reinterpret_cast<uint32 *>(
+            OGRE_MALLOC_SIMD( numVertices[i] * 4u * sizeof( uint32 ), MEMCATEGORY_GEOMETRY ) );
+        for( uint32 j = 0u; j < numVertices[i] * 4u; ++j )
+            data[j] = uint32( i ) * 0x10000000u + j;
+        vertexBuffers[i] = vaoManager->createVertexBuffer( vertexElements, numVertices[i],
+                                                           BT_IMMUTABLE, data, false );
+        OGRE_FREE_SIMD( data, MEMCATEGORY_GEOMETRY );
+    }
+
+    VaoManager::MemoryPoolStatsVec poolStats;
+    vaoManager->getMemoryPoolStats( poolStats );
+    // RenderSystems that don't pool buffers (e.g. NULL by default) report no pools
+    INTERNAL_CORE_CHECK( poolStats.empty() || poolStats.size() >= 2u );
+
+    for( size_t i = 0u; i < numBuffers; ++i )
+    {
+        AsyncTicketPtr asyncTicket = vertexBuffers[i]->readRequest( 0, numVertices[i] );
+        const uint32 *readData = reinterpret_cast<const uint32 *>( asyncTicket->map() );
+        for( uint32 j = 0u; j < numVertices[i] * 4u; ++j )
+            INTERNAL_CORE_CHECK( readData[j] == uint32( i ) * 0x10000000u + j );
+        asyncTicket->unmap();
+
+        vaoManager->destroyVertexBuffer( vertexBuffers[i] );
+    }
+
+    vaoManager->cleanupEmptyPools();
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testVaoDefragmentation()
+{
+    using namespace Ogre;
+
+    VaoManager *vaoManager = mGraphicsSystem->getRoot()->getRenderSystem()->getVaoManager();
+    if( !vaoManager->supportsBufferRelocation() )
+    {
+        LogManager::getSingleton().logMessage(
+            "testVaoDefragmentation skipped: RenderSystem doesn't support buffer relocation" );
+        return;
+    }
+
+    // 4MB per buffer; enough to span several pools in every RenderSystem
+    const uint32 numVertices = 256u * 1024u;
+    const size_t numBuffers = 40u;
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back( VertexElement2( VET_UINT4, VES_POSITION ) );
+
+    VertexBufferPackedVec vertexBuffers;
+    vertexBuffers.reserve( numBuffers );
+
+    uint32 *data = reinterpret_cast<uint32 *>(
+        OGRE_MALLOC_SIMD( numVertices * 4u * sizeof( uint32 ), MEMCATEGORY_GEOMETRY ) );
+    for( size_t i = 0u; i < numBuffers; ++i )
+    {
+        for( uint32 j = 0u; j < numVertices * 4u; ++j )
+            data[j] = uint32( i * numVertices * 4u + j );
+        vertexBuffers.push_back( vaoManager->createVertexBuffer( vertexElements, numVertices,
+                                                                 BT_IMMUTABLE, data, false ) );
+    }
+    OGRE_FREE_SIMD( data, MEMCATEGORY_GEOMETRY );
+
+    // Leave every pool half empty
+    vector<size_t>::type survivors;
+    for( size_t i = 0u; i < numBuffers; ++i )
+    {
+        if( i & 0x01u )
+        {
+            vaoManager->destroyVertexBuffer( vertexBuffers[i] );
+            vertexBuffers[i] = 0;
+        }
+        else
+        {
+            survivors.push_back( i );
+        }
+    }
+
+    vector<VertexArrayObject *>::type vaos;
+    for( size_t i = 0u; i < survivors.size(); ++i )
+    {
+        VertexBufferPackedVec vaoBuffers( 1u, vertexBuffers[survivors[i]] );
+        vaos.push_back( vaoManager->createVertexArrayObject( vaoBuffers, 0, OT_TRIANGLE_LIST ) );
+    }
+
+    VaoManager::MemoryPoolStatsVec poolStats;
+    vaoManager->getMemoryPoolStats( poolStats );
+    const size_t numPoolsBefore = poolStats.size();
+    const VaoManager::DefragmentationStats statsBefore = vaoManager->getDefragmentationStats();
+
+    while( vaoManager->defragmentPools( std::numeric_limits<size_t>::max() ) )
+    {
+    }
+
+    const VaoManager::DefragmentationStats &statsAfter = vaoManager->getDefragmentationStats();
+    vaoManager->getMemoryPoolStats( poolStats );
+
+    INTERNAL_CORE_CHECK( statsAfter.buffersMoved > statsBefore.buffersMoved );
+    INTERNAL_CORE_CHECK( statsAfter.poolsReleased > statsBefore.poolsReleased );
+    INTERNAL_CORE_CHECK( poolStats.size() < numPoolsBefore );
+
+    LogManager::getSingleton().logMessage(
+        "testVaoDefragmentation moved " +
+        StringConverter::toString( statsAfter.buffersMoved - statsBefore.buffersMoved ) +
+        " buffers, released " +
+        StringConverter::toString( statsAfter.poolsReleased - statsBefore.poolsReleased ) +
+        " pools" );
+
+    for( size_t i = 0u; i < survivors.size(); ++i )
+    {
+        VertexBufferPacked *vertexBuffer = vertexBuffers[survivors[i]];
+        INTERNAL_CORE_CHECK( vaos[i]->getBaseVertexBuffer() == vertexBuffer );
+
+        AsyncTicketPtr asyncTicket = vertexBuffer->readRequest( 0, numVertices );
+        const uint32 *readData = reinterpret_cast<const uint32 *>( asyncTicket->map() );
+        for( uint32 j = 0u; j < numVertices * 4u; ++j )
+            INTERNAL_CORE_CHECK( readData[j] == uint32( survivors[i] * numVertices * 4u + j ) );
+        asyncTicket->unmap();
+
+        vaoManager->destroyVertexArrayObject( vaos[i] );
+        vaoManager->destroyVertexBuffer( vertexBuffer );
+    }
+
+    vaoManager->cleanupEmptyPools();
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testMeshOptimizer()
+{
+    using namespace Ogre;
+
+    const uint32 gridSize = 64u;
+    const uint32 numVertices = ( gridSize + 1u ) * ( gridSize + 1u );
+
+    vector<float>::type positions;
+    positions.reserve( numVertices * 3u );
+    for( uint32 y = 0u; y <= gridSize; ++y )
+    {
+        for( uint32 x = 0u; x <= gridSize; ++x )
+        {
+            positions.push_back( float( x ) );
+            positions.push_back( float( y ) );
+            positions.push_back( std::sin( float( x ) * 0.3f ) * 3.0f );
+        }
+    }
+
+    typedef std::array<uint32, 3u> Triangle;
+    vector<Triangle>::type triangles;
+    for( uint32 y = 0u; y < gridSize; ++y )
+    {
+        for( uint32 x = 0u; x < gridSize; ++x )
+        {
+            const uint32 v0 = y * ( gridSize + 1u ) + x;
+            const uint32 v2 = v0 + gridSize + 1u;
+            triangles.push_back( { v0, v0 + 1u, v2 } );
+            triangles.push_back( { v0 + 1u, v2 + 1u, v2 } );
+        }
+    }
+
+    // Shuffle the triangles so the original order is cache-hostile
+    srand( 101 );
+    for( size_t i = triangles.size() - 1u; i > 0u; --i )
+        std::swap( triangles[i], triangles[size_t( rand() ) % ( i + 1u )] );
+
+    vector<uint32>::type indices;
+    for( size_t i = 0u; i < triangles.size(); ++i )
+        indices.insert( indices.end(), triangles[i].begin(), triangles[i].end() );
+
+    const size_t numIndices = indices.size();
+    const MeshOptimizer::VertexCacheStats before =
+        MeshOptimizer::analyzeVertexCache( &indices[0], numIndices, numVertices );
+
+    vector<uint32>::type cacheOptimized( numIndices );
+    MeshOptimizer::optimizeVertexCache( &cacheOptimized[0], &indices[0], numIndices, numVertices );
+    const MeshOptimizer::VertexCacheStats afterCache =
+        MeshOptimizer::analyzeVertexCache( &cacheOptimized[0], numIndices, numVertices );
+
+    vector<uint32>::type overdrawOptimized( numIndices );
+    MeshOptimizer::optimizeOverdraw( &overdrawOptimized[0], &cacheOptimized[0], numIndices,
+                                     &positions[0], sizeof( float ) * 3u, numVertices, 1.05f );
+    const MeshOptimizer::VertexCacheStats afterOverdraw =
+        MeshOptimizer::analyzeVertexCache( &overdrawOptimized[0], numIndices, numVertices );
+
+    vector<uint32>::type remap( numVertices );
+    const size_t numReferenced = MeshOptimizer::optimizeVertexFetchRemap(
+        &remap[0], &overdrawOptimized[0], numIndices, numVertices );
+    INTERNAL_CORE_CHECK( numReferenced == numVertices );
+
+    vector<uint32>::type fetchOptimized( overdrawOptimized );
+    MeshOptimizer::remapIndices( &fetchOptimized[0], numIndices, &remap[0] );
+    const MeshOptimizer::VertexCacheStats afterFetch =
+        MeshOptimizer::analyzeVertexCache( &fetchOptimized[0], numIndices, numVertices );
+
+    INTERNAL_CORE_CHECK( before.numVertices == numVertices );
+    INTERNAL_CORE_CHECK( afterCache.getAcmr() < 1.0f );
+    INTERNAL_CORE_CHECK( afterCache.getAcmr() < before.getAcmr() * 0.5f );
+    INTERNAL_CORE_CHECK( afterOverdraw.getAcmr() <= afterCache.getAcmr() * 1.05f + 1e-6f );
+    INTERNAL_CORE_CHECK( afterFetch.numCacheMisses == afterOverdraw.numCacheMisses );
+
+    // Every original triangle must still be there, with the same winding
+    // (rotations of the 3 indices are allowed).
+    vector<Triangle>::type original( triangles );
+    vector<Triangle>::type optimized;
+    vector<uint32>::type inverseRemap( numVertices );
+    for( uint32 i = 0u; i < numVertices; ++i )
+        inverseRemap[remap[i]] = i;
+    for( size_t i = 0u; i < numIndices; i += 3u )
+    {
+        optimized.push_back( { inverseRemap[fetchOptimized[i + 0u]],
+                               inverseRemap[fetchOptimized[i + 1u]],
+                               inverseRemap[fetchOptimized[i + 2u]] } );
+    }
+
+    for( size_t i = 0u; i < original.size(); ++i )
+    {
+        std::rotate( original[i].begin(),
+                     std::min_element( original[i].begin(), original[i].end() ), original[i].end() );
+        std::rotate( optimized[i].begin(),
+                     std::min_element( optimized[i].begin(), optimized[i].end() ),
+                     optimized[i].end() );
+    }
+    std::sort( original.begin(), original.end() );
+    std::sort( optimized.begin(), optimized.end() );
+    INTERNAL_CORE_CHECK( original == optimized );
+
+    LogManager::getSingleton().logMessage(
+        "MeshOptimizer ACMR: " + StringConverter::toString( before.getAcmr() ) + " -> " +
+        StringConverter::toString( afterCache.getAcmr() ) + " (cache) -> " +
+        StringConverter::toString( afterOverdraw.getAcmr() ) + " (overdraw)" );
+
+    // A real mesh. Soft boundaries must not chop it into tiny clusters, nor exceed
+    // the ACMR threshold.
+    {
+        v1::MeshPtr v1Mesh = v1::MeshManager::getSingleton().load(
+            "athene.mesh", ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME,
+            v1::HardwareBuffer::HBU_STATIC, v1::HardwareBuffer::HBU_STATIC );
+        const v1::SubMesh *subMesh = v1Mesh->getSubMesh( 0u );
+        const v1::VertexData *vertexData = subMesh->useSharedVertices
+                                               ? v1Mesh->sharedVertexData[VpNormal]
+                                               : subMesh->vertexData[VpNormal];
+        const v1::IndexData *indexData = subMesh->indexData[VpNormal];
+
+        const v1::VertexElement *posElem =
+            vertexData->vertexDeclaration->findElementBySemantic( VES_POSITION );
+        const v1::HardwareVertexBufferSharedPtr vertexBuffer =
+            vertexData->vertexBufferBinding->getBuffer( posElem->getSource() );
+
+        vector<float>::type meshPositions( vertexData->vertexCount * 3u );
+        {
+            v1::HardwareBufferLockGuard vertexLock( vertexBuffer, v1::HardwareBuffer::HBL_READ_ONLY );
+            const uint8 *vertex = static_cast<const uint8 *>( vertexLock.pData ) +
+                                  vertexData->vertexStart * vertexBuffer->getVertexSize();
+            for( size_t i = 0u; i < vertexData->vertexCount; ++i )
+            {
+                float *pos;
+                posElem->baseVertexPointerToElement( const_cast<uint8 *>( vertex ), &pos );
+                memcpy( &meshPositions[i * 3u], pos, sizeof( float ) * 3u );
+                vertex += vertexBuffer->getVertexSize();
+            }
+        }
+
+        vector<uint32>::type meshIndices( indexData->indexCount );
+        {
+            const v1::HardwareIndexBufferSharedPtr &indexBuffer = indexData->indexBuffer;
+            v1::HardwareBufferLockGuard indexLock( indexBuffer, v1::HardwareBuffer::HBL_READ_ONLY );
+            for( size_t i = 0u; i < indexData->indexCount; ++i )
+            {
+                const size_t idx = indexData->indexStart + i;
+                if( indexBuffer->getType() == v1::HardwareIndexBuffer::IT_32BIT )
+                    meshIndices[i] = static_cast<const uint32 *>( indexLock.pData )[idx];
+                else
+                    meshIndices[i] = static_cast<const uint16 *>( indexLock.pData )[idx];
+            }
+        }
+
+        const size_t meshNumIndices = meshIndices.size();
+        const size_t meshNumVertices = vertexData->vertexCount;
+
+        vector<uint32>::type meshCacheOptimized( meshNumIndices );
+        MeshOptimizer::optimizeVertexCache( &meshCacheOptimized[0], &meshIndices[0], meshNumIndices,
+                                            meshNumVertices );
+        const MeshOptimizer::VertexCacheStats meshAfterCache = MeshOptimizer::analyzeVertexCache(
+            &meshCacheOptimized[0], meshNumIndices, meshNumVertices );
+
+        vector<uint32>::type meshOverdrawOptimized( meshNumIndices );
+        const size_t numHardClusters = MeshOptimizer::optimizeOverdraw(
+            &meshOverdrawOptimized[0], &meshCacheOptimized[0], meshNumIndices, &meshPositions[0],
+            sizeof( float ) * 3u, meshNumVertices, 1.0f );
+        const size_t numClusters = MeshOptimizer::optimizeOverdraw(
+            &meshOverdrawOptimized[0], &meshCacheOptimized[0], meshNumIndices, &meshPositions[0],
+            sizeof( float ) * 3u, meshNumVertices, 1.05f );
+        const MeshOptimizer::VertexCacheStats meshAfterOverdraw = MeshOptimizer::analyzeVertexCache(
+            &meshOverdrawOptimized[0], meshNumIndices, meshNumVertices );
+
+        const size_t meshNumTriangles = meshNumIndices / 3u;
+        INTERNAL_CORE_CHECK( numClusters > numHardClusters );
+        // Splits must be paid by the triangles before them: each one costs up to 3 misses
+        // and the budget is 5% of the mesh's misses.
+        INTERNAL_CORE_CHECK( numClusters - numHardClusters <=
+                             size_t( float( meshAfterCache.numCacheMisses ) * 0.05f / 3.0f ) + 1u );
+        // athene has many seams (hard clusters); soft splits on top must stay rare.
+        INTERNAL_CORE_CHECK( ( numClusters - numHardClusters ) * 32u <= meshNumTriangles );
+        INTERNAL_CORE_CHECK( meshAfterOverdraw.getAcmr() <= meshAfterCache.getAcmr() * 1.05f + 1e-6f );
+
+        LogManager::getSingleton().logMessage(
+            "MeshOptimizer athene.mesh: " + StringConverter::toString( meshNumTriangles ) +
+            " triangles, " + StringConverter::toString( numHardClusters ) + " hard clusters, " +
+            StringConverter::toString( numClusters ) + " clusters. ACMR " +
+            StringConverter::toString( meshAfterCache.getAcmr() ) + " -> " +
+            StringConverter::toString( meshAfterOverdraw.getAcmr() ) );
+
+        v1::MeshManager::getSingleton().remove( v1Mesh );
+    }
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testMeshlets()
+{
+    using namespace Ogre;
+
+    // Flat grid on the XY plane, facing +Z
+    const uint32 gridSize = 64u;
+    const uint32 numVertices = ( gridSize + 1u ) * ( gridSize + 1u );
+
+    vector<float>::type positions;
+    positions.reserve( numVertices * 3u );
+    for( uint32 y = 0u; y <= gridSize; ++y )
+    {
+        for( uint32 x = 0u; x <= gridSize; ++x )
+        {
+            positions.push_back( float( x ) );
+            positions.push_back( float( y ) );
+            positions.push_back( 0.0f );
+        }
+    }
+
+    vector<uint32>::type indices;
+    for( uint32 y = 0u; y < gridSize; ++y )
+    {
+        for( uint32 x = 0u; x < gridSize; ++x )
+        {
+            const uint32 v0 = y * ( gridSize + 1u ) + x;
+            const uint32 v2 = v0 + gridSize + 1u;
+            const uint32 quad[6] = { v0, v0 + 1u, v2, v0 + 1u, v2 + 1u, v2 };
+            indices.insert( indices.end(), quad, quad + 6u );
+        }
+    }
+
+    const size_t numIndices = indices.size();
+    vector<uint32>::type cacheOptimized( numIndices );
+    MeshOptimizer::optimizeVertexCache( &cacheOptimized[0], &indices[0], numIndices, numVertices );
+
+    const uint32 maxVertices = 64u;
+    const uint32 maxTriangles = 124u;
+    vector<uint32>::type meshletIndices( numIndices );
+    MeshOptimizer::MeshletVec meshlets;
+    MeshOptimizer::buildMeshlets( &meshletIndices[0], meshlets, &cacheOptimized[0], numIndices,
+                                  &positions[0], sizeof( float ) * 3u, numVertices, maxVertices,
+                                  maxTriangles );
+    INTERNAL_CORE_CHECK( meshlets.size() > 1u );
+
+    // Meshlets must be contiguous, cover every index and respect the limits
+    uint32 nextIndexStart = 0u;
+    for( size_t i = 0u; i < meshlets.size(); ++i )
+    {
+        INTERNAL_CORE_CHECK( meshlets[i].indexStart == nextIndexStart );
+        INTERNAL_CORE_CHECK( meshlets[i].indexCount > 0u && meshlets[i].indexCount % 3u == 0u );
+        INTERNAL_CORE_CHECK( meshlets[i].indexCount / 3u <= maxTriangles );
+        INTERNAL_CORE_CHECK( meshlets[i].vertexCount <= maxVertices );
+        INTERNAL_CORE_CHECK( meshlets[i].coneCutoff < 1.0f );
+        nextIndexStart += meshlets[i].indexCount;
+    }
+    INTERNAL_CORE_CHECK( nextIndexStart == numIndices );
+
+    {
+        vector<uint32>::type sortedA( cacheOptimized ), sortedB( meshletIndices );
+        std::sort( sortedA.begin(), sortedA.end() );
+        std::sort( sortedB.begin(), sortedB.end() );
+        INTERNAL_CORE_CHECK( sortedA == sortedB );
+    }
+
+    vector<uint32>::type visible( meshlets.size() );
+
+    // Seen from behind, every meshlet is backfacing
+    size_t numVisible = MeshOptimizer::cullMeshlets( &visible[0], &meshlets[0], meshlets.size(),
+                                                     Vector3( 32.0f, 32.0f, -10.0f ), 0, 0u );
+    INTERNAL_CORE_CHECK( numVisible == 0u );
+
+    numVisible = MeshOptimizer::cullMeshlets( &visible[0], &meshlets[0], meshlets.size(),
+                                              Vector3( 32.0f, 32.0f, 10.0f ), 0, 0u );
+    INTERNAL_CORE_CHECK( numVisible == meshlets.size() );
+
+    // Only keep x >= 32
+    const Plane plane( Vector3::UNIT_X, 32.0f );
+    numVisible = MeshOptimizer::cullMeshlets( &visible[0], &meshlets[0], meshlets.size(),
+                                              Vector3( 32.0f, 32.0f, 10.0f ), &plane, 1u );
+    INTERNAL_CORE_CHECK( numVisible > 0u && numVisible < meshlets.size() );
+
+    size_t expectedIndices = 0u;
+    for( size_t i = 0u; i < numVisible; ++i )
+    {
+        const MeshOptimizer::Meshlet &meshlet = meshlets[visible[i]];
+        INTERNAL_CORE_CHECK( meshlet.center[0] + meshlet.radius >= 32.0f );
+        expectedIndices += meshlet.indexCount;
+    }
+
+    vector<uint32>::type compacted( numIndices );
+    const size_t numCompacted = MeshOptimizer::compactMeshletIndices(
+        &compacted[0], &meshletIndices[0], &meshlets[0], &visible[0], numVisible );
+    INTERNAL_CORE_CHECK( numCompacted == expectedIndices );
+    const MeshOptimizer::Meshlet &firstVisible = meshlets[visible[0]];
+    INTERNAL_CORE_CHECK( std::equal( compacted.begin(), compacted.begin() + firstVisible.indexCount,
+                                     meshletIndices.begin() + firstVisible.indexStart ) );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testVertexQuantization()
+{
+    using namespace Ogre;
+
+    struct Vertex
+    {
+        float pos[3];
+        float normal[3];
+        float uv0[2];  // In [0; 1]
+        float uv1[2];  // In [-1; 1]
+        float uv2[2];  // Tiled, needs full precision
+    };
+
+    const size_t numVertices = 256u;
+
+    for( int farAway = 0; farAway < 2; ++farAway )
+    {
+        vector<Vertex>::type vertices( numVertices );
+        for( size_t i = 0u; i < numVertices; ++i )
+        {
+            const float angle = float( i ) * 0.1f;
+            Vector3 normal( std::cos( angle ), std::sin( angle * 0.7f ), std::sin( angle ) - 0.5f );
+            normal.normalise();
+
+            Vertex &v = vertices[i];
+            // A far away unit-sized object needs 32-bit positions
+            v.pos[0] = normal.x + ( farAway ? 10000.0f : 0.0f );
+            v.pos[1] = normal.y;
+            v.pos[2] = normal.z;
+            v.normal[0] = normal.x;
+            v.normal[1] = normal.y;
+            v.normal[2] = normal.z;
+            v.uv0[0] = float( i ) / float( numVertices - 1u );
+            v.uv0[1] = 1.0f - v.uv0[0];
+            v.uv1[0] = normal.x;
+            v.uv1[1] = normal.y;
+            v.uv2[0] = v.uv0[0] * 8.0f + 1.0f / 1024.0f;
+            v.uv2[1] = 0.5f;
+        }
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+
+        SubMesh::SourceDataArray srcData;
+        {
+            const char *base = reinterpret_cast<const char *>( &vertices[0] );
+            size_t offset = 0u;
+            for( size_t i = 0u; i < vertexElements.size(); ++i )
+            {
+                srcData.push_back( SubMesh::SourceData( base + offset, sizeof( Vertex ),
+                                                        vertexElements[i] ) );
+                offset += v1::VertexElement::getTypeSize( vertexElements[i].mType );
+            }
+        }
+
+        VertexElement2Vec quantized( vertexElements );
+        SubMesh::_quantizeVertexElements( srcData, numVertices, VertexQuantizationSettings(),
+                                          quantized );
+
+        INTERNAL_CORE_CHECK( quantized[0].mType == ( farAway ? VET_FLOAT3 : VET_HALF4 ) );
+        INTERNAL_CORE_CHECK( quantized[1].mType == VET_SHORT2_SNORM );
+        INTERNAL_CORE_CHECK( quantized[2].mType == VET_USHORT2_NORM );
+        INTERNAL_CORE_CHECK( quantized[3].mType == VET_SHORT2_SNORM );
+        INTERNAL_CORE_CHECK( quantized[4].mType == VET_FLOAT2 );
+
+        // Float tangents (i.e. not QTangents) keep the normal in float too
+        {
+            VertexElement2Vec withTangents( vertexElements );
+            withTangents.push_back( VertexElement2( VET_FLOAT3, VES_TANGENT ) );
+            SubMesh::SourceDataArray tangentSrcData( srcData );
+            tangentSrcData.push_back( SubMesh::SourceData( srcData[1].data, sizeof( Vertex ),
+                                                           withTangents.back() ) );
+            SubMesh::_quantizeVertexElements( tangentSrcData, numVertices,
+                                              VertexQuantizationSettings(), withTangents );
+            INTERNAL_CORE_CHECK( withTangents[1].mType == VET_FLOAT3 );
+            INTERNAL_CORE_CHECK( withTangents[2].mType == VET_USHORT2_NORM );
+        }
+        if( !farAway )
+        {
+            INTERNAL_CORE_CHECK( VaoManager::calculateVertexSize( quantized ) * 10u <
+                                 VaoManager::calculateVertexSize( vertexElements ) * 6u );
+        }
+
+        // Round trip. Half positions are padded to 4 components, and come back as FLOAT4
+        char *packed = SubMesh::_arrangeEfficient( srcData, quantized, numVertices );
+        VertexElement2Vec unpackedElements;
+        char *unpacked =
+            SubMesh::_dearrangeEfficient( packed, numVertices, quantized, &unpackedElements );
+        OGRE_FREE_SIMD( packed, MEMCATEGORY_GEOMETRY );
+
+        VertexElement2Vec expectedElements( vertexElements );
+        if( !farAway )
+            expectedElements[0].mType = VET_FLOAT4;
+        INTERNAL_CORE_CHECK( unpackedElements == expectedElements );
+
+        const size_t posPadding = farAway ? 0u : 1u;
+        const size_t unpackedStride = VaoManager::calculateVertexSize( unpackedElements );
+        for( size_t i = 0u; i < numVertices; ++i )
+        {
+            const Vertex &a = vertices[i];
+            const float *b = reinterpret_cast<const float *>( unpacked + i * unpackedStride );
+            for( size_t j = 0u; j < 3u; ++j )
+            {
+                INTERNAL_CORE_CHECK( std::abs( a.pos[j] - b[j] ) <= 2.0f / 2048.0f );
+                INTERNAL_CORE_CHECK( std::abs( a.normal[j] - b[3u + posPadding + j] ) <= 1e-3f );
+            }
+            const float *bUv = b + 6u + posPadding;
+            for( size_t j = 0u; j < 2u; ++j )
+            {
+                INTERNAL_CORE_CHECK( std::abs( a.uv0[j] - bUv[j] ) <= 1e-4f );
+                INTERNAL_CORE_CHECK( std::abs( a.uv1[j] - bUv[2u + j] ) <= 1e-4f );
+                INTERNAL_CORE_CHECK( a.uv2[j] == bUv[4u + j] );
+            }
+        }
+
+        OGRE_FREE_SIMD( unpacked, MEMCATEGORY_GEOMETRY );
+    }
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testMeshSerializerV3()
+{
+    using namespace Ogre;
+
+    VaoManager *vaoManager = mGraphicsSystem->getRoot()->getRenderSystem()->getVaoManager();
+
+    // Wavy grid, so the data isn't trivially compressible
+    const uint16 gridSize = 64u;
+    const uint32 numVertices = ( gridSize + 1u ) * ( gridSize + 1u );
+    const uint32 numIndices = gridSize * gridSize * 6u;
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+    vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+    vertexElements.push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+
+    float *vertexData = reinterpret_cast<float *>(
+        OGRE_MALLOC_SIMD( numVertices * 8u * sizeof( float ), MEMCATEGORY_GEOMETRY ) );
+    float *vertex = vertexData;
+    for( uint16 y = 0u; y <= gridSize; ++y )
+    {
+        for( uint16 x = 0u; x <= gridSize; ++x )
+        {
+            const Vector3 normal = Vector3( std::sin( x * 0.1f ), 1.0f, std::cos( y * 0.1f ) )
+                                       .normalisedCopy();
+            *vertex++ = float( x );
+            *vertex++ = std::sin( x * 0.1f ) * std::cos( y * 0.1f );
+            *vertex++ = float( y );
+            *vertex++ = normal.x;
+            *vertex++ = normal.y;
+            *vertex++ = normal.z;
+            *vertex++ = float( x ) / float( gridSize );
+            *vertex++ = float( y ) / float( gridSize );
+        }
+    }
+
+    uint16 *indexData = reinterpret_cast<uint16 *>(
+        OGRE_MALLOC_SIMD( numIndices * sizeof( uint16 ), MEMCATEGORY_GEOMETRY ) );
+    uint16 *index = indexData;
+    for( uint16 y = 0u; y < gridSize; ++y )
+    {
+        for( uint16 x = 0u; x < gridSize; ++x )
+        {
+            const uint16 v0 = uint16( y * ( gridSize + 1u ) + x );
+            const uint16 v2 = uint16( v0 + gridSize + 1u );
+            const uint16 quad[6] = { v0, uint16( v0 + 1u ), v2, uint16( v0 + 1u ), uint16( v2 + 1u ),
+                                     v2 };
+            memcpy( index, quad, sizeof( quad ) );
+            index += 6u;
+        }
+    }
+
+    MeshPtr mesh = MeshManager::getSingleton().createManual(
+        "testMeshSerializerV3", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+    {
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( vaoManager->createVertexBuffer( vertexElements, numVertices,
+                                                                 BT_IMMUTABLE, vertexData, false ) );
+        IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+            IndexBufferPacked::IT_16BIT, numIndices, BT_IMMUTABLE, indexData, false );
+        VertexArrayObject *vao =
+            vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer, OT_TRIANGLE_LIST );
+
+        SubMesh *subMesh = mesh->createSubMesh();
+        subMesh->mVao[VpNormal].push_back( vao );
+        subMesh->mVao[VpShadow].push_back( vao );
+
+        mesh->_setBounds( Aabb( Vector3( gridSize, 0.0f, gridSize ) * 0.5f,
+                                Vector3( gridSize, 1.0f, gridSize ) * 0.5f ),
+                          false );
+        mesh->_setBoundingSphereRadius( gridSize );
+    }
+
+    MeshSerializer meshSerializer( vaoManager );
+
+    const size_t rawDataSize = numVertices * 8u * sizeof( float ) + numIndices * sizeof( uint16 );
+    size_t exportedSizes[3];
+
+    for( size_t i = 0u; i < 3u; ++i )
+    {
+        const MeshVersion version = i == 0u ? MESH_VERSION_2_1 : MESH_VERSION_3_0;
+        meshSerializer.setCompressPayloads( i == 2u );
+
+        DataStreamPtr stream( OGRE_NEW MemoryDataStream( rawDataSize * 2u + 64u * 1024u ) );
+        meshSerializer.exportMesh( mesh.get(), stream, version );
+        exportedSizes[i] = stream->tell();
+
+        // Page aligned payloads
+        if( i == 1u )
+            INTERNAL_CORE_CHECK( ( exportedSizes[i] - rawDataSize ) % 4096u == 0u );
+
+        DataStreamPtr readStream( OGRE_NEW MemoryDataStream(
+            static_cast<MemoryDataStream *>( stream.get() )->getPtr(), exportedSizes[i], false,
+            true ) );
+
+        MeshPtr loadedMesh = MeshManager::getSingleton().createManual(
+            "testMeshSerializerV3_loaded", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+        meshSerializer.importMesh( readStream, loadedMesh.get() );
+        INTERNAL_CORE_CHECK( readStream->eof() );
+
+        INTERNAL_CORE_CHECK( loadedMesh->getNumSubMeshes() == 1u );
+        const VertexArrayObject *vao = loadedMesh->getSubMesh( 0 )->mVao[VpNormal][0];
+        INTERNAL_CORE_CHECK( vao->getVertexBuffers().size() == 1u );
+
+        VertexBufferPacked *vertexBuffer = vao->getVertexBuffers()[0];
+        INTERNAL_CORE_CHECK( vertexBuffer->getVertexElements() == vertexElements );
+        INTERNAL_CORE_CHECK( vertexBuffer->getNumElements() == numVertices );
+
+        AsyncTicketPtr asyncTicket = vertexBuffer->readRequest( 0, numVertices );
+        INTERNAL_CORE_CHECK(
+            memcmp( asyncTicket->map(), vertexData, vertexBuffer->getTotalSizeBytes() ) == 0 );
+        asyncTicket->unmap();
+
+        IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+        INTERNAL_CORE_CHECK( indexBuffer->getIndexType() == IndexBufferPacked::IT_16BIT );
+        INTERNAL_CORE_CHECK( indexBuffer->getNumElements() == numIndices );
+
+        asyncTicket = indexBuffer->readRequest( 0, numIndices );
+        INTERNAL_CORE_CHECK(
+            memcmp( asyncTicket->map(), indexData, indexBuffer->getTotalSizeBytes() ) == 0 );
+        asyncTicket->unmap();
+
+        MeshManager::getSingleton().remove( loadedMesh );
+    }
+
+    INTERNAL_CORE_CHECK( exportedSizes[2] < exportedSizes[1] );
+
+    LogManager::getSingleton().logMessage(
+        "testMeshSerializerV3 sizes: v2.1 = " + StringConverter::toString( exportedSizes[0] ) +
+        " bytes; v3.0 = " + StringConverter::toString( exportedSizes[1] ) +
+        " bytes; v3.0 compressed = " + StringConverter::toString( exportedSizes[2] ) + " bytes" );
+
+    MeshManager::getSingleton().remove( mesh );
+    OGRE_FREE_SIMD( vertexData, MEMCATEGORY_GEOMETRY );
+    OGRE_FREE_SIMD( indexData, MEMCATEGORY_GEOMETRY );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testAsyncMeshLoading()
+{
+    using namespace Ogre;
+
+    struct LoadingCompleteCounter final : public Resource::Listener
+    {
+        size_t count;
+        LoadingCompleteCounter() : count( 0u ) {}
+        void loadingComplete( Resource * ) override { ++count; }
+    };
+
+    VaoManager *vaoManager = mGraphicsSystem->getRoot()->getRenderSystem()->getVaoManager();
+    MeshManager &meshManager = MeshManager::getSingleton();
+
+    const String folder = mGraphicsSystem->getWriteAccessFolder();
+    const String groupName = "testAsyncMeshLoading";
+    const String meshName = "testAsyncMeshLoading.mesh";
+
+    float vertexData[4][3];
+    getQuadVertexData( 0.0f, vertexData );
+
+    {
+        MeshPtr mesh = createQuadMesh( vaoManager, "testAsyncMeshLoading_src", 0.0f );
+        MeshSerializer meshSerializer( vaoManager );
+        meshSerializer.exportMesh( mesh.get(), folder + meshName, MESH_VERSION_3_0 );
+        meshManager.remove( mesh );
+    }
+
+    ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+    resourceGroupManager.addResourceLocation( folder, "FileSystem", groupName );
+
+    LoadingCompleteCounter listener;
+    MeshPtr mesh = meshManager.loadAsync( meshName, groupName, &listener );
+    MeshPtr missingMesh = meshManager.loadAsync( "testAsyncMeshLoading_missing.mesh", groupName );
+
+    // Nothing can finish until MeshManager::_update gets called
+    INTERNAL_CORE_CHECK( !mesh->isLoaded() && listener.count == 0u );
+    INTERNAL_CORE_CHECK( meshManager.getNumPendingAsyncLoads() == 2u );
+
+    SceneManager *sceneManager = mGraphicsSystem->getSceneManager();
+    Item *item = sceneManager->createItem( mesh );
+    INTERNAL_CORE_CHECK( item->getNumSubItems() == 0u );
+
+    meshManager.waitForAsyncLoads();
+
+    INTERNAL_CORE_CHECK( meshManager.getNumPendingAsyncLoads() == 0u );
+    INTERNAL_CORE_CHECK( mesh->isLoaded() && listener.count == 1u );
+    INTERNAL_CORE_CHECK( !missingMesh->isLoaded() && !missingMesh->isLoading() );
+    INTERNAL_CORE_CHECK( item->getNumSubItems() == 1u );
+
+    const VertexArrayObject *vao = mesh->getSubMesh( 0 )->mVao[VpNormal][0];
+    VertexBufferPacked *vertexBuffer = vao->getVertexBuffers()[0];
+    INTERNAL_CORE_CHECK( vertexBuffer->getNumElements() == 4u );
+    AsyncTicketPtr asyncTicket = vertexBuffer->readRequest( 0, 4u );
+    INTERNAL_CORE_CHECK( memcmp( asyncTicket->map(), vertexData, sizeof( vertexData ) ) == 0 );
+    asyncTicket->unmap();
+
+    IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+    asyncTicket = indexBuffer->readRequest( 0, 6u );
+    INTERNAL_CORE_CHECK( memcmp( asyncTicket->map(), c_quadIndexData, sizeof( c_quadIndexData ) ) == 0 );
+    asyncTicket->unmap();
+
+    // Already loaded meshes call the listener right away
+    meshManager.loadAsync( meshName, groupName, &listener );
+    INTERNAL_CORE_CHECK( listener.count == 2u && meshManager.getNumPendingAsyncLoads() == 0u );
+
+    sceneManager->destroyItem( item );
+    mesh->removeListener( &listener );
+    meshManager.remove( mesh );
+    meshManager.remove( missingMesh );
+    resourceGroupManager.destroyResourceGroup( groupName );
+    std::remove( ( folder + meshName ).c_str() );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testEdgeListBuilderThreads()
+{
+    using namespace Ogre;
+
+    // A torus with duplicated vertices along its seams, so that vertices have to be welded
+    // to close it. Big enough to be split across threads.
+    const size_t rings = 512u;
+    const size_t sides = 256u;
+    const size_t numVertices = ( rings + 1u ) * ( sides + 1u );
+    const size_t numIndices = rings * sides * 6u;
+
+    v1::HardwareBufferManager &hwBufferManager = v1::HardwareBufferManager::getSingleton();
+
+    v1::VertexData vertexData( &hwBufferManager );
+    vertexData.vertexCount = numVertices;
+    vertexData.vertexDeclaration->addElement( 0, 0, VET_FLOAT3, VES_POSITION );
+    v1::HardwareVertexBufferSharedPtr vertexBuffer = hwBufferManager.createVertexBuffer(
+        sizeof( float ) * 3u, numVertices, v1::HardwareBuffer::HBU_STATIC, true );
+    vertexData.vertexBufferBinding->setBinding( 0, vertexBuffer );
+    float *vertices = static_cast<float *>( vertexBuffer->lock( v1::HardwareBuffer::HBL_DISCARD ) );
+    for( size_t r = 0u; r <= rings; ++r )
+    {
+        // Wrap around exactly, so that seam positions are bit-identical
+        const Real u = Math::TWO_PI * Real( r % rings ) / Real( rings );
+        for( size_t s = 0u; s <= sides; ++s )
+        {
+            const Real v = Math::TWO_PI * Real( s % sides ) / Real( sides );
+            *vertices++ = float( ( 100.0f + 25.0f * Math::Cos( v ) ) * Math::Cos( u ) );
+            *vertices++ = float( 25.0f * Math::Sin( v ) );
+            *vertices++ = float( ( 100.0f + 25.0f * Math::Cos( v ) ) * Math::Sin( u ) );
+        }
+    }
+    vertexBuffer->unlock();
+
+    v1::IndexData indexData;
+    indexData.indexCount = numIndices;
+    indexData.indexBuffer = hwBufferManager.createIndexBuffer(
+        v1::HardwareIndexBuffer::IT_32BIT, numIndices, v1::HardwareBuffer::HBU_STATIC, true );
+    uint32 *indices =
+        static_cast<uint32 *>( indexData.indexBuffer->lock( v1::HardwareBuffer::HBL_DISCARD ) );
+    for( size_t r = 0u; r < rings; ++r )
+    {
+        for( size_t s = 0u; s < sides; ++s )
+        {
+            const uint32 a = static_cast<uint32>( r * ( sides + 1u ) + s );
+            const uint32 b = static_cast<uint32>( ( r + 1u ) * ( sides + 1u ) + s );
+            *indices++ = a;
+            *indices++ = a + 1u;
+            *indices++ = b;
+            *indices++ = b;
+            *indices++ = a + 1u;
+            *indices++ = b + 1u;
+        }
+    }
+    indexData.indexBuffer->unlock();
+
+    Root *root = mGraphicsSystem->getRoot();
+    SceneManager *sceneManager =
+        root->createSceneManager( ST_GENERIC, 4u, "testEdgeListBuilderThreads" );
+
+    v1::EdgeData *edgeData[2];
+    uint64 elapsedUs[2];
+    Timer timer;
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        v1::EdgeListBuilder edgeBuilder;
+        edgeBuilder.setSceneManager( i == 1u ? sceneManager : 0 );
+        edgeBuilder.addVertexData( &vertexData );
+        edgeBuilder.addIndexData( &indexData );
+        timer.reset();
+        edgeData[i] = edgeBuilder.build();
+        elapsedUs[i] = timer.getMicroseconds();
+    }
+
+    root->destroySceneManager( sceneManager );
+
+    LogManager::getSingleton().logMessage(
+        "EdgeListBuilder with " + StringConverter::toString( rings * sides * 2u ) +
+        " triangles: " + StringConverter::toString( elapsedUs[0] ) + "us (4 threads: " +
+        StringConverter::toString( elapsedUs[1] ) + "us)" );
+
+    // Seams must be welded
+    INTERNAL_CORE_CHECK( edgeData[0]->isClosed );
+    INTERNAL_CORE_CHECK( edgeData[0]->triangles.size() == rings * sides * 2u );
+    INTERNAL_CORE_CHECK( edgeData[0]->edgeGroups[0].edges.size() == rings * sides * 3u );
+
+    // Same result regardless of the number of threads
+    INTERNAL_CORE_CHECK( edgeData[1]->isClosed == edgeData[0]->isClosed );
+    INTERNAL_CORE_CHECK( edgeData[1]->triangles.size() == edgeData[0]->triangles.size() );
+    bool trianglesMatch = true;
+    for( size_t t = 0u; t < edgeData[0]->triangles.size(); ++t )
+    {
+        const v1::EdgeData::Triangle &t0 = edgeData[0]->triangles[t];
+        const v1::EdgeData::Triangle &t1 = edgeData[1]->triangles[t];
+        for( size_t j = 0u; j < 3u; ++j )
+        {
+            trianglesMatch &= t0.vertIndex[j] == t1.vertIndex[j] &&
+                              t0.sharedVertIndex[j] == t1.sharedVertIndex[j];
+        }
+        trianglesMatch &= edgeData[0]->triangleFaceNormals[t] == edgeData[1]->triangleFaceNormals[t];
+    }
+    INTERNAL_CORE_CHECK( trianglesMatch );
+
+    const v1::EdgeData::EdgeList &edges0 = edgeData[0]->edgeGroups[0].edges;
+    const v1::EdgeData::EdgeList &edges1 = edgeData[1]->edgeGroups[0].edges;
+    INTERNAL_CORE_CHECK( edges0.size() == edges1.size() );
+    bool edgesMatch = true;
+    for( size_t e = 0u; e < edges0.size(); ++e )
+    {
+        for( size_t j = 0u; j < 2u; ++j )
+        {
+            edgesMatch &= edges0[e].triIndex[j] == edges1[e].triIndex[j] &&
+                          edges0[e].vertIndex[j] == edges1[e].vertIndex[j] &&
+                          edges0[e].sharedVertIndex[j] == edges1[e].sharedVertIndex[j];
+        }
+        edgesMatch &= edges0[e].degenerate == edges1[e].degenerate;
+    }
+    INTERNAL_CORE_CHECK( edgesMatch );
+
+    OGRE_DELETE edgeData[0];
+    OGRE_DELETE edgeData[1];
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testSharedStaticMeshBuffers()
+{
+    using namespace Ogre;
+
+    VaoManager *vaoManager = mGraphicsSystem->getRoot()->getRenderSystem()->getVaoManager();
+    MeshManager &meshManager = MeshManager::getSingleton();
+
+    const String folder = mGraphicsSystem->getWriteAccessFolder();
+    const String groupName = "testSharedStaticMeshBuffers";
+
+    // Two quads at different heights
+    const float heights[2] = { 0.0f, 5.0f };
+
+    String meshNames[4];
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        MeshPtr mesh = createQuadMesh( vaoManager, "testSharedStaticMeshBuffers_src", heights[i] );
+        meshNames[i] = "testSharedStaticMeshBuffers" + StringConverter::toString( i ) + ".mesh";
+        MeshSerializer meshSerializer( vaoManager );
+        meshSerializer.exportMesh( mesh.get(), folder + meshNames[i] );
+        meshManager.remove( mesh );
+    }
+
+    // A skinned quad. Skinning works on whole vertex buffers, thus it can't be shared
+    {
+        struct SkinnedVertex
+        {
+            float pos[3];
+            uint8 blendIndices[4];
+            float blendWeight;
+        };
+        float quadVertexData[4][3];
+        getQuadVertexData( 0.0f, quadVertexData );
+        SkinnedVertex vertexData[4];
+        for( size_t i = 0u; i < 4u; ++i )
+        {
+            memcpy( vertexData[i].pos, quadVertexData[i], sizeof( vertexData[i].pos ) );
+            memset( vertexData[i].blendIndices, 0, sizeof( vertexData[i].blendIndices ) );
+            vertexData[i].blendWeight = 1.0f;
+        }
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+        vertexElements.push_back( VertexElement2( VET_UBYTE4, VES_BLEND_INDICES ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT1, VES_BLEND_WEIGHTS ) );
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( vaoManager->createVertexBuffer( vertexElements, 4u, BT_IMMUTABLE,
+                                                                 vertexData, false ) );
+        IndexBufferPacked *indexBuffer =
+            vaoManager->createIndexBuffer( IndexBufferPacked::IT_16BIT, 6u, BT_IMMUTABLE,
+                                           const_cast<uint16 *>( c_quadIndexData ), false );
+
+        MeshPtr mesh = meshManager.createManual( "testSharedStaticMeshBuffers_src",
+                                                 ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+        SubMesh *subMesh = mesh->createSubMesh();
+        subMesh->mVao[VpNormal].push_back(
+            vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer, OT_TRIANGLE_LIST ) );
+        subMesh->mVao[VpShadow].push_back( subMesh->mVao[VpNormal][0] );
+        subMesh->mBlendIndexToBoneIndexMap.push_back( 0u );
+        mesh->_setBounds( Aabb( Vector3::ZERO, Vector3( 1.0f, 0.0f, 1.0f ) ), false );
+        mesh->_setBoundingSphereRadius( 1.5f );
+
+        meshNames[2] = "testSharedStaticMeshBuffers2.mesh";
+        MeshSerializer meshSerializer( vaoManager );
+        meshSerializer.exportMesh( mesh.get(), folder + meshNames[2] );
+        meshManager.remove( mesh );
+    }
+
+    // A quad with meshlets. Meshlet::indexStart is relative to its own index buffer
+    {
+        MeshPtr mesh = createQuadMesh( vaoManager, "testSharedStaticMeshBuffers_src", 0.0f );
+        mesh->buildMeshlets();
+        meshNames[3] = "testSharedStaticMeshBuffers3.mesh";
+        MeshSerializer meshSerializer( vaoManager );
+        meshSerializer.exportMesh( mesh.get(), folder + meshNames[3] );
+        meshManager.remove( mesh );
+    }
+
+    ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+    resourceGroupManager.addResourceLocation( folder, "FileSystem", groupName );
+
+    const size_t numSharedBuffersBefore = meshManager.getNumSharedGeometryBuffers();
+    meshManager.setShareStaticBuffers( true );
+
+    MeshPtr meshes[2];
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        meshes[i] =
+            meshManager.load( meshNames[i], groupName, BT_IMMUTABLE, BT_IMMUTABLE, false, false );
+    }
+
+    INTERNAL_CORE_CHECK( meshManager.getNumSharedGeometryBuffers() == numSharedBuffersBefore + 1u );
+
+    const VertexArrayObject *vaos[2] = { meshes[0]->getSubMesh( 0 )->mVao[VpNormal][0],
+                                         meshes[1]->getSubMesh( 0 )->mVao[VpNormal][0] };
+    // Same buffers & format means the RenderSystem gives them the same Vao name
+    INTERNAL_CORE_CHECK( meshManager._isSharedVao( vaos[0] ) && meshManager._isSharedVao( vaos[1] ) );
+    INTERNAL_CORE_CHECK( vaos[0] != vaos[1] );
+    INTERNAL_CORE_CHECK( vaos[0]->getVertexBuffers()[0] == vaos[1]->getVertexBuffers()[0] );
+    INTERNAL_CORE_CHECK( vaos[0]->getIndexBuffer() == vaos[1]->getIndexBuffer() );
+    INTERNAL_CORE_CHECK( vaos[1]->getPrimitiveStart() == vaos[0]->getPrimitiveStart() + 6u );
+    INTERNAL_CORE_CHECK( vaos[1]->getPrimitiveCount() == 6u );
+
+    // The second quad's indices point to its own vertices in the shared buffer
+    const uint32 firstIndex = vaos[1]->getPrimitiveStart();
+    AsyncTicketPtr asyncTicket = vaos[1]->getIndexBuffer()->readRequest( firstIndex, 6u );
+    const uint16 *indices = reinterpret_cast<const uint16 *>( asyncTicket->map() );
+    const uint32 baseVertex = indices[0];
+    for( size_t i = 0u; i < 6u; ++i )
+        INTERNAL_CORE_CHECK( indices[i] == c_quadIndexData[i] + baseVertex );
+    asyncTicket->unmap();
+
+    asyncTicket = vaos[1]->getVertexBuffers()[0]->readRequest( baseVertex, 4u );
+    float vertexData[4][3];
+    getQuadVertexData( heights[1], vertexData );
+    INTERNAL_CORE_CHECK( memcmp( asyncTicket->map(), vertexData, sizeof( vertexData ) ) == 0 );
+    asyncTicket->unmap();
+
+    // Shared submeshes can't be modified nor exported
+    SubMesh *sharedSubMesh = meshes[0]->getSubMesh( 0 );
+    INTERNAL_CORE_CHECK( sharedSubMesh->_isUsingSharedBuffers() );
+    size_t numExceptions = 0u;
+    try
+    {
+        sharedSubMesh->arrangeEfficient( VertexQuantizationSettings() );
+    }
+    catch( Exception & )
+    {
+        ++numExceptions;
+    }
+    try
+    {
+        sharedSubMesh->dearrangeToInefficient();
+    }
+    catch( Exception & )
+    {
+        ++numExceptions;
+    }
+    try
+    {
+        MeshSerializer meshSerializer( vaoManager );
+        meshSerializer.exportMesh( meshes[0].get(), folder + "testSharedStaticMeshBuffers_x.mesh" );
+    }
+    catch( Exception & )
+    {
+        ++numExceptions;
+    }
+    std::remove( ( folder + "testSharedStaticMeshBuffers_x.mesh" ).c_str() );
+    INTERNAL_CORE_CHECK( numExceptions == 3u );
+    INTERNAL_CORE_CHECK( sharedSubMesh->mVao[VpNormal][0] == vaos[0] );
+
+    // Shadowed meshes keep their own buffers
+    meshManager.remove( meshes[1] );
+    meshes[1] = meshManager.load( meshNames[1], groupName, BT_IMMUTABLE, BT_IMMUTABLE, true, true );
+    INTERNAL_CORE_CHECK( meshes[1]->getSubMesh( 0 )->mVao[VpNormal][0]->getVertexBuffers()[0] !=
+                         vaos[0]->getVertexBuffers()[0] );
+
+    MeshPtr skinnedMesh =
+        meshManager.load( meshNames[2], groupName, BT_IMMUTABLE, BT_IMMUTABLE, false, false );
+    INTERNAL_CORE_CHECK( !meshManager._isSharedVao( skinnedMesh->getSubMesh( 0 )->mVao[VpNormal][0] ) );
+    INTERNAL_CORE_CHECK( meshManager.getNumSharedGeometryBuffers() == numSharedBuffersBefore + 1u );
+    meshManager.remove( skinnedMesh );
+    std::remove( ( folder + meshNames[2] ).c_str() );
+
+    MeshPtr meshletMesh =
+        meshManager.load( meshNames[3], groupName, BT_IMMUTABLE, BT_IMMUTABLE, false, false );
+    INTERNAL_CORE_CHECK( !meshManager._isSharedVao( meshletMesh->getSubMesh( 0 )->mVao[VpNormal][0] ) );
+    INTERNAL_CORE_CHECK( meshletMesh->getSubMesh( 0 )->hasMeshlets() );
+    INTERNAL_CORE_CHECK( meshletMesh->getSubMesh( 0 )->getMeshlets( 0u ).front().indexStart == 0u );
+    INTERNAL_CORE_CHECK( meshManager.getNumSharedGeometryBuffers() == numSharedBuffersBefore + 1u );
+    meshManager.remove( meshletMesh );
+    std::remove( ( folder + meshNames[3] ).c_str() );
+
+    meshManager.setShareStaticBuffers( false );
+
+    // Shared buffers are gone once their last mesh is unloaded
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        meshManager.remove( meshes[i] );
+        meshes[i].reset();
+        std::remove( ( folder + meshNames[i] ).c_str() );
+    }
+    INTERNAL_CORE_CHECK( meshManager.getNumSharedGeometryBuffers() == numSharedBuffersBefore );
+
+    resourceGroupManager.destroyResourceGroup( groupName );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testCompressedSkeletonAnimation()
+{
+    using namespace Ogre;
+
+    SceneManager *sceneManager = mGraphicsSystem->getSceneManager();
+
+    const Real frameRate = 30.0f;
+    const size_t numKeyFrames = 61u;
+    const size_t numBones = 5u;
+
+    v1::SkeletonPtr oldSkeleton = v1::OldSkeletonManager::getSingleton().create(
+        "testCompressedSkeletonAnimation", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, true );
+    v1::OldBone *rootBone = oldSkeleton->createBone( "Root", 0u );
+    for( unsigned short i = 1u; i < numBones; ++i )
+    {
+        v1::OldBone *bone = oldSkeleton->createBone( "Bone" + StringConverter::toString( i ), i );
+        bone->setPosition( Vector3( Real( i ), 0.0f, 0.0f ) );
+        rootBone->addChild( bone );
+    }
+    oldSkeleton->setBindingPose();
+
+    v1::Animation *animation =
+        oldSkeleton->createAnimation( "Anim", Real( numKeyFrames - 1u ) / frameRate );
+    for( unsigned short i = 0u; i < numBones; ++i )
+    {
+        v1::OldNodeAnimationTrack *track = animation->createOldNodeTrack( i );
+        for( size_t k = 0u; k < numKeyFrames; ++k )
+        {
+            const Real t = Real( k ) / frameRate;
+            v1::TransformKeyFrame *keyFrame = track->createNodeKeyFrame( t );
+            switch( i )
+            {
+            case 0:  // Everything animated
+                keyFrame->setTranslate( Vector3( Math::Sin( t * 3.0f ), t, Math::Cos( t ) ) );
+                keyFrame->setRotation( Quaternion( Radian( Math::Sin( t * 2.0f ) ), Vector3::UNIT_Y ) );
+                keyFrame->setScale( Vector3( 1.0f + t * t * 0.25f ) );
+                break;
+            case 1:  // Linear translation
+                keyFrame->setTranslate( Vector3( 0.0f, t * 2.0f, 0.0f ) );
+                break;
+            case 2:  // Constant
+                keyFrame->setTranslate( Vector3( 0.5f, 0.25f, 0.0f ) );
+                keyFrame->setRotation( Quaternion( Degree( 45.0f ), Vector3::UNIT_Z ) );
+                break;
+            case 3:  // Rotation only
+                keyFrame->setRotation(
+                    Quaternion( Radian( t * Math::PI ), Vector3( 1.0f, 1.0f, 0.0f ).normalisedCopy() ) );
+                break;
+            default:  // Identity
+                break;
+            }
+        }
+    }
+
+    SkeletonDefPtr skeletonDefs[2];
+    for( size_t i = 0u; i < 2u; ++i )  // Same as SkeletonManager
+        skeletonDefs[i] = SkeletonDefPtr( new SkeletonDef( oldSkeleton.get(), 1.0f ) );
+
+    const SkeletonAnimationDef::CompressionSettings errorBudget;
+    const size_t bytesBefore = skeletonDefs[1]->getAnimationMemoryUsage();
+    const size_t keyFramesBefore = skeletonDefs[1]->getAnimationDefs()[0].getNumKeyFrames();
+    skeletonDefs[1]->compressAnimations( errorBudget );
+    INTERNAL_CORE_CHECK( skeletonDefs[1]->getAnimationDefs()[0].isCompressed() );
+    INTERNAL_CORE_CHECK( skeletonDefs[1]->getAnimationMemoryUsage() < bytesBefore / 2u );
+    INTERNAL_CORE_CHECK( skeletonDefs[1]->getAnimationDefs()[0].getNumKeyFrames() < keyFramesBefore );
+
+    // Sample forward, backwards & jumping around so the decoded keyframes
+    // cached by SkeletonAnimation get both reused and invalidated
+    const Real duration = Real( numKeyFrames - 1u ) / frameRate;
+    std::vector<Real> sampleTimes;
+    for( Real t = 0.0f; t < duration; t += 0.0137f )
+        sampleTimes.push_back( t );
+    for( Real t = duration; t > 0.0f; t -= 0.0291f )
+        sampleTimes.push_back( t );
+    for( size_t i = 0u; i < 16u; ++i )
+        sampleTimes.push_back( Real( ( i * 7u ) % 16u ) * duration / 16.0f );
+
+    // Sample both skeletons in between keyframes. SkeletonInstances are tracked
+    // by the definition's name, so only one can be alive at a time.
+    std::vector<Vector3> positions[2], scales[2];
+    std::vector<Quaternion> orientations[2];
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        SkeletonInstance *skeletonInstance =
+            sceneManager->createSkeletonInstance( skeletonDefs[i].get() );
+        SkeletonAnimation *skeletonAnimation = skeletonInstance->getAnimation( "Anim" );
+        skeletonAnimation->setEnabled( true );
+
+        for( size_t k = 0u; k < sampleTimes.size(); ++k )
+        {
+            skeletonAnimation->setTime( sampleTimes[k] );
+            skeletonInstance->update();
+            for( size_t j = 0u; j < numBones; ++j )
+            {
+                const Bone *bone = skeletonInstance->getBone( j );
+                positions[i].push_back( bone->getPosition() );
+                orientations[i].push_back( bone->getOrientation() );
+                scales[i].push_back( bone->getScale() );
+            }
+        }
+
+        sceneManager->destroySkeletonInstance( skeletonInstance );
+        sceneManager->_removeSkeletonDef( skeletonDefs[i].get() );
+    }
+
+    // Allow a bit of slack for float precision
+    const Real posTolerance = errorBudget.maxPositionError * 1.1f;
+    const Real rotTolerance = errorBudget.maxOrientationError * 1.1f;
+    const Real scaleTolerance = errorBudget.maxScaleError * 1.1f;
+    for( size_t i = 0u; i < positions[0].size(); ++i )
+    {
+        INTERNAL_CORE_CHECK( positions[0][i].positionEquals( positions[1][i], posTolerance ) );
+        INTERNAL_CORE_CHECK( scales[0][i].positionEquals( scales[1][i], scaleTolerance ) );
+        // Angle between both, accurate for small angles
+        const Quaternion &qA = orientations[0][i];
+        const Quaternion &qB = orientations[1][i];
+        const Quaternion diff = qA.Dot( qB ) < 0 ? qA + qB : qA - qB;
+        INTERNAL_CORE_CHECK( 4.0f * Math::ASin( Math::Sqrt( diff.Norm() ) * 0.5f ).valueRadians() <=
+                             rotTolerance );
+    }
+
+    skeletonDefs[0].reset();
+    skeletonDefs[1].reset();
+    v1::OldSkeletonManager::getSingleton().remove( oldSkeleton );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testAnimationLod()
+{
+    using namespace Ogre;
+
+    SceneManager *sceneManager = mGraphicsSystem->getSceneManager();
+    VaoManager *vaoManager = mGraphicsSystem->getRoot()->getRenderSystem()->getVaoManager();
+
+    // Root bone with one child; "Up" moves both along Y
+    v1::SkeletonPtr oldSkeleton = createTwoBoneSkeleton( "testAnimationLod" );
+    SkeletonDefPtr skeletonDef( new SkeletonDef( oldSkeleton.get(), 1.0f ) );
+
+    // Any MovableObject can drive the LOD. Use a quad
+    MeshPtr mesh = createQuadMesh( vaoManager, "testAnimationLod", 0.0f );
+
+    Item *item = sceneManager->createItem( mesh );
+    SceneNode *sceneNode = sceneManager->getRootSceneNode()->createChildSceneNode();
+    sceneNode->setPosition( 0.0f, 0.0f, -100.0f );
+    sceneNode->attachObject( item );
+    Camera *camera = sceneManager->createCamera( "testAnimationLod" );
+
+    SkeletonInstance *skeletonInstance = sceneManager->createSkeletonInstance( skeletonDef.get() );
+    SkeletonAnimation *skeletonAnimation = skeletonInstance->getAnimation( "Up" );
+    skeletonAnimation->setEnabled( true );
+
+    // Beyond 50 units: update every 4th frame, only the root bone
+    AnimationLodLevelVec lodLevels;
+    lodLevels.push_back( AnimationLodLevel( 50.0f, 4u, 1u ) );
+    skeletonInstance->setAnimationLodLevels( &lodLevels );
+    skeletonInstance->setAnimationLodSource( item );
+
+    sceneManager->updateSceneGraph();
+    sceneManager->updateAllLods( camera, 1.0f, 0u, 255u );
+    INTERNAL_CORE_CHECK( item->getLodValue() > 50.0f );
+
+    Bone *bones[2] = { skeletonInstance->getBone( size_t( 0u ) ),
+                       skeletonInstance->getBone( size_t( 1u ) ) };
+
+    const size_t numFrames = 16u;
+    size_t numRootChanges = 0u;
+    size_t numChildChanges = 0u;
+    for( size_t i = 0u; i < numFrames; ++i )
+    {
+        const Vector3 prevPos[2] = { bones[0]->getPosition(), bones[1]->getPosition() };
+        skeletonAnimation->addTime( 0.1f );
+        sceneManager->updateSceneGraph();
+        numRootChanges += prevPos[0] != bones[0]->getPosition() ? 1u : 0u;
+        numChildChanges += prevPos[1] != bones[1]->getPosition() ? 1u : 0u;
+    }
+    INTERNAL_CORE_CHECK( numRootChanges == numFrames / 4u );
+    INTERNAL_CORE_CHECK( numChildChanges == 0u );
+
+    // Up close everything gets animated every frame
+    sceneNode->setPosition( 0.0f, 0.0f, -10.0f );
+    sceneManager->updateSceneGraph();
+    sceneManager->updateAllLods( camera, 1.0f, 0u, 255u );
+    INTERNAL_CORE_CHECK( item->getLodValue() < 50.0f );
+    for( size_t i = 0u; i < numFrames; ++i )
+    {
+        const Vector3 prevPos[2] = { bones[0]->getPosition(), bones[1]->getPosition() };
+        skeletonAnimation->addTime( 0.1f );
+        sceneManager->updateSceneGraph();
+        INTERNAL_CORE_CHECK( prevPos[0] != bones[0]->getPosition() );
+        INTERNAL_CORE_CHECK( prevPos[1] != bones[1]->getPosition() );
+    }
+
+    sceneManager->destroySkeletonInstance( skeletonInstance );
+    sceneManager->_removeSkeletonDef( skeletonDef.get() );
+    skeletonDef.reset();
+    sceneManager->destroyCamera( camera );
+    sceneManager->destroyItem( item );
+    sceneManager->destroySceneNode( sceneNode );
+    MeshManager::getSingleton().remove( mesh );
+    v1::OldSkeletonManager::getSingleton().remove( oldSkeleton );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testPreSkinning()
+{
+    using namespace Ogre;
+
+    Root *root = mGraphicsSystem->getRoot();
+    SceneManager *sceneManager = mGraphicsSystem->getSceneManager();
+    VaoManager *vaoManager = root->getRenderSystem()->getVaoManager();
+
+    v1::SkeletonPtr oldSkeleton = createTwoBoneSkeleton( "testPreSkinning" );
+
+    struct SkinnedVertex
+    {
+        float pos[3];
+        float normal[3];
+        uint8 blendIndices[4];
+        float blendWeights[2];
+    };
+    SkinnedVertex vertexData[4];
+    for( size_t i = 0u; i < 4u; ++i )
+    {
+        vertexData[i].pos[0] = ( i == 0u || i == 3u ) ? -1.0f : 1.0f;
+        vertexData[i].pos[1] = 0.0f;
+        vertexData[i].pos[2] = i < 2u ? -1.0f : 1.0f;
+        vertexData[i].normal[0] = 0.0f;
+        vertexData[i].normal[1] = 1.0f;
+        vertexData[i].normal[2] = 0.0f;
+        vertexData[i].blendIndices[0] = 0u;
+        vertexData[i].blendIndices[1] = 1u;
+        vertexData[i].blendIndices[2] = 0u;
+        vertexData[i].blendIndices[3] = 0u;
+        vertexData[i].blendWeights[0] = 0.5f;
+        vertexData[i].blendWeights[1] = 0.5f;
+    }
+    const uint16 indexData[6] = { 0u, 1u, 2u, 0u, 2u, 3u };
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+    vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+    vertexElements.push_back( VertexElement2( VET_UBYTE4, VES_BLEND_INDICES ) );
+    vertexElements.push_back( VertexElement2( VET_FLOAT2, VES_BLEND_WEIGHTS ) );
+    // Half precision positions can't be pre-skinned
+    VertexElement2Vec halfVertexElements;
+    halfVertexElements.push_back( VertexElement2( VET_HALF4, VES_POSITION ) );
+    halfVertexElements.push_back( VertexElement2( VET_UBYTE4, VES_BLEND_INDICES ) );
+    halfVertexElements.push_back( VertexElement2( VET_FLOAT2, VES_BLEND_WEIGHTS ) );
+
+    MeshPtr mesh = MeshManager::getSingleton().createManual(
+        "testPreSkinning", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+    mesh->_notifySkeleton( oldSkeleton );
+
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        VertexBufferPackedVec vertexBuffers;
+        if( i == 0u )
+        {
+            vertexBuffers.push_back( vaoManager->createVertexBuffer( vertexElements, 4u, BT_IMMUTABLE,
+                                                                     vertexData, false ) );
+        }
+        else
+        {
+            vertexBuffers.push_back(
+                vaoManager->createVertexBuffer( halfVertexElements, 4u, BT_DEFAULT, 0, false ) );
+        }
+        IndexBufferPacked *indexBuffer =
+            vaoManager->createIndexBuffer( IndexBufferPacked::IT_16BIT, 6u, BT_IMMUTABLE,
+                                           const_cast<uint16 *>( indexData ), false );
 
-using namespace Demo;
+        SubMesh *subMesh = mesh->createSubMesh();
+        subMesh->mVao[VpNormal].push_back(
+            vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer, OT_TRIANGLE_LIST ) );
+        subMesh->mVao[VpShadow].push_back( subMesh->mVao[VpNormal][0] );
+        subMesh->mBlendIndexToBoneIndexMap.push_back( 0u );
+        subMesh->mBlendIndexToBoneIndexMap.push_back( 1u );
+    }
+    mesh->_setBounds( Aabb( Vector3::ZERO, Vector3( 1.0f, 0.0f, 1.0f ) ), false );
+    mesh->_setBoundingSphereRadius( 1.5f );
 
-InternalCoreGameState::InternalCoreGameState( const Ogre::String &helpDescription ) :
-    TutorialGameState( helpDescription )
+    Item *item = sceneManager->createItem( mesh );
+    INTERNAL_CORE_CHECK( item->getSkeletonInstance() );
+
+    SubItem *subItems[2] = { item->getSubItem( 0u ), item->getSubItem( 1u ) };
+    INTERNAL_CORE_CHECK( subItems[0]->hasSkeletonAnimation() && subItems[1]->hasSkeletonAnimation() );
+
+    const VertexArrayObject *srcVao = mesh->getSubMesh( 0u )->mVao[VpNormal][0];
+
+    {
+        // The compute job is only needed once something gets skinned
+        PreSkinning preSkinning( vaoManager, root->getHlmsManager()->getComputeHlms() );
+        INTERNAL_CORE_CHECK( preSkinning.addItem( item ) );
+
+        // SubItem 0 renders its own vertex buffer as static geometry, in all passes
+        const VertexArrayObject *vao = subItems[0]->getVaos( VpNormal )[0];
+        INTERNAL_CORE_CHECK( subItems[0]->isPreSkinned() );
+        INTERNAL_CORE_CHECK( !subItems[0]->hasSkeletonAnimation() );
+        INTERNAL_CORE_CHECK( vao != srcVao );
+        INTERNAL_CORE_CHECK( subItems[0]->getVaos( VpShadow )[0] == vao );
+        INTERNAL_CORE_CHECK( vao->getIndexBuffer() == srcVao->getIndexBuffer() );
+        INTERNAL_CORE_CHECK( vao->getVertexBuffers()[0] != srcVao->getVertexBuffers()[0] );
+        INTERNAL_CORE_CHECK( vao->getVertexBuffers()[0]->getBytesPerElement() ==
+                             srcVao->getVertexBuffers()[0]->getBytesPerElement() );
+        INTERNAL_CORE_CHECK( vao->getVertexBuffers()[0]->getNumElements() == 4u );
+
+        // SubItem 1 keeps being skinned in the vertex shader
+        INTERNAL_CORE_CHECK( !subItems[1]->isPreSkinned() && subItems[1]->hasSkeletonAnimation() );
+        INTERNAL_CORE_CHECK( subItems[1]->getVaos( VpNormal )[0] ==
+                             mesh->getSubMesh( 1u )->mVao[VpNormal][0] );
+
+        // Nothing left to pre-skin
+        INTERNAL_CORE_CHECK( !preSkinning.addItem( item ) );
+        INTERNAL_CORE_CHECK( preSkinning.getNumItems() == 1u );
+
+        preSkinning.removeItem( item );
+        INTERNAL_CORE_CHECK( preSkinning.getNumItems() == 0u );
+        INTERNAL_CORE_CHECK( !subItems[0]->isPreSkinned() && subItems[0]->hasSkeletonAnimation() );
+        INTERNAL_CORE_CHECK( subItems[0]->getVaos( VpNormal )[0] == srcVao );
+        INTERNAL_CORE_CHECK( subItems[0]->getVaos( VpShadow )[0] == srcVao );
+
+        // The destructor removes whatever is left
+        INTERNAL_CORE_CHECK( preSkinning.addItem( item ) );
+    }
+    INTERNAL_CORE_CHECK( !subItems[0]->isPreSkinned() && subItems[0]->hasSkeletonAnimation() );
+
+    const SkeletonDef *skeletonDef = mesh->getSkeleton().get();
+    sceneManager->destroyItem( item );
+    sceneManager->_removeSkeletonDef( skeletonDef );
+    MeshManager::getSingleton().remove( mesh );
+    v1::OldSkeletonManager::getSingleton().remove( oldSkeleton );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testSkeletonPoseSource()
+{
+    using namespace Ogre;
+
+    SceneManager *sceneManager = mGraphicsSystem->getSceneManager();
+
+    v1::SkeletonPtr oldSkeleton = createTwoBoneSkeleton( "testSkeletonPoseSource" );
+    const char *animNames[2] = { "Up", "Side" };
+    SkeletonDefPtr skeletonDef( new SkeletonDef( oldSkeleton.get(), 1.0f ) );
+
+    SceneNode *sceneNodes[2];
+    SkeletonInstance *skeletons[2];
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        sceneNodes[i] = sceneManager->getRootSceneNode()->createChildSceneNode();
+        sceneNodes[i]->setPosition( Real( i ) * 100.0f, 0.0f, 0.0f );
+        skeletons[i] = sceneManager->createSkeletonInstance( skeletonDef.get() );
+        skeletons[i]->setParentNode( sceneNodes[i] );
+        skeletons[i]->getAnimation( animNames[i] )->setEnabled( true );
+    }
+
+    // skeletons[1] follows skeletons[0], except for its manual child bone.
+    // Its own animation gets ignored
+    Bone *manualBone = skeletons[1]->getBone( size_t( 1u ) );
+    skeletons[1]->setManualBone( manualBone, true );
+    manualBone->setPosition( Vector3( 0.0f, 0.0f, 5.0f ) );
+    skeletons[1]->setPoseSource( skeletons[0] );
+
+    for( size_t i = 0u; i < 4u; ++i )
+    {
+        skeletons[0]->getAnimation( animNames[0] )->addTime( 1.0f );
+        skeletons[1]->getAnimation( animNames[1] )->addTime( 1.0f );
+        sceneManager->updateSceneGraph();
+
+        const Bone *rootBones[2] = { skeletons[0]->getBone( size_t( 0u ) ),
+                                     skeletons[1]->getBone( size_t( 0u ) ) };
+        INTERNAL_CORE_CHECK( rootBones[0]->getPosition().y > 0.0f );
+        INTERNAL_CORE_CHECK( rootBones[1]->getPosition() == rootBones[0]->getPosition() );
+        INTERNAL_CORE_CHECK( manualBone->getPosition() == Vector3( 0.0f, 0.0f, 5.0f ) );
+
+        // Each instance still follows its own node
+        const Vector3 offset = rootBones[1]->_getDerivedTransform().getTrans() -
+                               rootBones[0]->_getDerivedTransform().getTrans();
+        INTERNAL_CORE_CHECK( offset.positionEquals( Vector3( 100.0f, 0.0f, 0.0f ) ) );
+
+        // The manual bone makes its palette differ, it can't share the source's
+        Matrix4 paletteToWorld;
+        INTERNAL_CORE_CHECK( !skeletons[1]->_getPoseSourcePaletteTransform( paletteToWorld ) );
+    }
+
+    // Without manual bones, the source's palette plus one transform is enough
+    skeletons[1]->setManualBone( manualBone, false );
+    sceneManager->updateSceneGraph();
+    {
+        Matrix4 paletteToWorld;
+        INTERNAL_CORE_CHECK( skeletons[1]->_getPoseSourcePaletteTransform( paletteToWorld ) );
+        INTERNAL_CORE_CHECK( !skeletons[0]->_getPoseSourcePaletteTransform( paletteToWorld ) );
+        for( size_t i = 0u; i < 2u; ++i )
+        {
+            OGRE_ALIGNED_DECL( Matrix4, sourceMat, OGRE_SIMD_ALIGNMENT );
+            OGRE_ALIGNED_DECL( Matrix4, followerMat, OGRE_SIMD_ALIGNMENT );
+            skeletons[0]->_getBoneFullTransform( i ).store( &sourceMat );
+            skeletons[1]->_getBoneFullTransform( i ).store( &followerMat );
+            const Matrix4 sharedMat = paletteToWorld.concatenateAffine( sourceMat );
+            for( size_t j = 0u; j < 12u; ++j )
+            {
+                INTERNAL_CORE_CHECK( Math::RealEqual( sharedMat[j / 4u][j % 4u],
+                                                      followerMat[j / 4u][j % 4u], 1e-3f ) );
+            }
+        }
+    }
+
+    skeletons[1]->setPoseSource( 0 );
+    sceneManager->updateSceneGraph();
+    INTERNAL_CORE_CHECK( skeletons[1]->getBone( size_t( 0u ) )->getPosition().x > 0.0f );
+    INTERNAL_CORE_CHECK( skeletons[1]->getBone( size_t( 0u ) )->getPosition().y == 0.0f );
+
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        sceneManager->destroySkeletonInstance( skeletons[i] );
+        sceneManager->destroySceneNode( sceneNodes[i] );
+    }
+    sceneManager->_removeSkeletonDef( skeletonDef.get() );
+    skeletonDef.reset();
+    v1::OldSkeletonManager::getSingleton().remove( oldSkeleton );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testSkeletonBlendLayers()
+{
+    using namespace Ogre;
+
+    SceneManager *sceneManager = mGraphicsSystem->getSceneManager();
+
+    v1::SkeletonPtr oldSkeleton = createTwoBoneSkeleton( "testSkeletonBlendLayers" );
+    SkeletonDefPtr skeletonDef( new SkeletonDef( oldSkeleton.get(), 1.0f ) );
+
+    // skeletons[1] gets the same blend, but animated by all worker threads
+    SceneNode *sceneNodes[2];
+    SkeletonInstance *skeletons[2];
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        sceneNodes[i] = sceneManager->getRootSceneNode()->createChildSceneNode();
+        skeletons[i] = sceneManager->createSkeletonInstance( skeletonDef.get() );
+        skeletons[i]->setParentNode( sceneNodes[i] );
+        skeletons[i]->setParallelAnimation( i == 1u );
+
+        // Enabled before the base layer on purpose. Layers, not the order, rule
+        SkeletonAnimation *side = skeletons[i]->getAnimation( "Side" );
+        side->setLayer( 1u );
+        side->setBlendMode( SkeletonBlendMode::Override );
+        side->setEnabled( true );
+        side->setFrame( 5.0f );
+        side->mWeight = 0.5f;
+
+        SkeletonAnimation *up = skeletons[i]->getAnimation( "Up" );
+        up->setEnabled( true );
+        up->setFrame( 5.0f );
+        INTERNAL_CORE_CHECK( skeletons[i]->getActiveAnimations().front() == up );
+    }
+
+    // Halfway through the crossfade
+    sceneManager->updateSceneGraph();
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        for( size_t j = 0u; j < 2u; ++j )
+        {
+            INTERNAL_CORE_CHECK( skeletons[i]->getBone( j )->getPosition().positionEquals(
+                        Vector3( 2.5f, 2.5f, 0.0f ) ) );
+        }
+    }
+
+    // Every depth level is animated by exactly one thread, in contiguous ranges
+    const size_t numDepthLevels = skeletonDef->getDepthLevelInfo().size();
+    for( size_t numThreads = 1u; numThreads <= 4u; ++numThreads )
+    {
+        size_t nextLevel = 0u;
+        for( size_t threadIdx = 0u; threadIdx < numThreads; ++threadIdx )
+        {
+            size_t firstLevel, lastLevel;
+            skeletons[1]->_getOwnedDepthLevels( threadIdx, numThreads, firstLevel, lastLevel );
+            INTERNAL_CORE_CHECK( firstLevel <= lastLevel );
+            if( firstLevel != lastLevel )
+            {
+                INTERNAL_CORE_CHECK( firstLevel == nextLevel );
+                nextLevel = lastLevel;
+            }
+        }
+        INTERNAL_CORE_CHECK( nextLevel == numDepthLevels );
+    }
+
+    // Same result regardless of how many threads split the work
+    for( size_t threadIdx = 0u; threadIdx < 3u; ++threadIdx )
+        skeletons[1]->_updateBoneBlocks( threadIdx, 3u );
+    for( size_t j = 0u; j < 2u; ++j )
+    {
+        INTERNAL_CORE_CHECK( skeletons[1]->getBone( j )->getPosition().positionEquals(
+            Vector3( 2.5f, 2.5f, 0.0f ) ) );
+    }
+
+    // Crossfade done; the lower layer no longer has any effect. Except on the child bone,
+    // which is masked out of the upper layer
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        SkeletonAnimation *side = skeletons[i]->getAnimation( "Side" );
+        side->mWeight = 1.0f;
+        side->setSubtreeBoneWeight( "Child", 0.0f );
+        INTERNAL_CORE_CHECK( side->getBoneWeight( "Root" ) == 1.0f );
+    }
+    sceneManager->updateSceneGraph();
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        INTERNAL_CORE_CHECK( skeletons[i]->getBone( size_t( 0u ) )->getPosition().positionEquals(
+                    Vector3( 5.0f, 0.0f, 0.0f ) ) );
+        INTERNAL_CORE_CHECK( skeletons[i]->getBone( size_t( 1u ) )->getPosition().positionEquals(
+                    Vector3( 0.0f, 5.0f, 0.0f ) ) );
+    }
+
+    // Moving it to the base layer makes it additive to "Up" (which overrides nothing)
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        SkeletonAnimation *side = skeletons[i]->getAnimation( "Side" );
+        side->setLayer( 0u );
+        side->setBlendMode( SkeletonBlendMode::Additive );
+        side->setSubtreeBoneWeight( "Root", 1.0f );
+        INTERNAL_CORE_CHECK( skeletons[i]->getActiveAnimations().back() == side );
+    }
+    sceneManager->updateSceneGraph();
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        INTERNAL_CORE_CHECK( skeletons[i]->getBone( size_t( 1u ) )->getPosition().positionEquals(
+                    Vector3( 5.0f, 5.0f, 0.0f ) ) );
+    }
+
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        sceneManager->destroySkeletonInstance( skeletons[i] );
+        sceneManager->destroySceneNode( sceneNodes[i] );
+    }
+    sceneManager->_removeSkeletonDef( skeletonDef.get() );
+    skeletonDef.reset();
+    v1::OldSkeletonManager::getSingleton().remove( oldSkeleton );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testDynamicUploadRing()
+{
+    using namespace Ogre;
+
+    Root *root = mGraphicsSystem->getRoot();
+    VaoManager *vaoManager = root->getRenderSystem()->getVaoManager();
+
+    DynamicUploadRing *ring = vaoManager->getDynamicUploadRing( BP_TYPE_CONST );
+    INTERNAL_CORE_CHECK( ring == vaoManager->getDynamicUploadRing( BP_TYPE_CONST ) );
+
+    const size_t alignment = vaoManager->getConstBufferAlignment();
+    ring->setChunkSize( 16u * 1024u );
+    const size_t chunkSize = ring->getChunkSize();
+
+    // Consecutive small allocations share the same buffer and never overlap
+    DynamicUploadRing::Allocation prevAlloc;
+    size_t prevSize = 0u;
+    for( size_t i = 0u; i < 16u; ++i )
+    {
+        const size_t sizeBytes = 100u + i;
+        DynamicUploadRing::Allocation alloc = ring->allocate( sizeBytes );
+        INTERNAL_CORE_CHECK( alloc.buffer && alloc.data );
+        INTERNAL_CORE_CHECK( alloc.offset % alignment == 0u );
+        if( prevAlloc.buffer )
+        {
+            INTERNAL_CORE_CHECK( alloc.buffer == prevAlloc.buffer );
+            INTERNAL_CORE_CHECK( alloc.offset >= prevAlloc.offset + prevSize );
+        }
+        memset( alloc.data, int( i ), sizeBytes );
+        prevAlloc = alloc;
+        prevSize = sizeBytes;
+    }
+
+    // Extra alignment, i.e. the stride of an array of structures
+    {
+        DynamicUploadRing::Allocation alloc = ring->allocate( 48u * 3u, 48u );
+        INTERNAL_CORE_CHECK( alloc.offset % 48u == 0u && alloc.offset % alignment == 0u );
+    }
+
+    root->renderOneFrame();
+
+    INTERNAL_CORE_CHECK( ring->getStats().numAllocationsLastFrame == 17u );
+    INTERNAL_CORE_CHECK( ring->getStats().usedBytesLastFrame >= 17u * 100u );
+    INTERNAL_CORE_CHECK( ring->getStats().capacityBytes == chunkSize );
+    INTERNAL_CORE_CHECK( ring->getStats().numGrowths == 0u );
+
+    // Overflow the chunk. The frame must still get valid memory, and the ring must grow
+    const size_t numAllocs = chunkSize / alignment + 4u;
+    std::set<BufferPacked *> buffersUsed;
+    for( size_t i = 0u; i < numAllocs; ++i )
+    {
+        DynamicUploadRing::Allocation alloc = ring->allocate( alignment );
+        INTERNAL_CORE_CHECK( alloc.buffer && alloc.data );
+        memset( alloc.data, 0, alignment );
+        buffersUsed.insert( alloc.buffer );
+    }
+    INTERNAL_CORE_CHECK( buffersUsed.size() == 2u );
+
+    root->renderOneFrame();
+
+    INTERNAL_CORE_CHECK( ring->getStats().numGrowths == 1u );
+    INTERNAL_CORE_CHECK( ring->getStats().peakNumAllocations == numAllocs );
+    INTERNAL_CORE_CHECK( ring->getChunkSize() ==
+                         std::min( chunkSize * 2u, vaoManager->getConstBufferMaxSize() ) );
+
+    // Now the same workload fits in a single chunk
+    buffersUsed.clear();
+    for( size_t i = 0u; i < numAllocs; ++i )
+        buffersUsed.insert( ring->allocate( alignment ).buffer );
+    INTERNAL_CORE_CHECK( buffersUsed.size() == 1u );
+
+    root->renderOneFrame();
+
+    INTERNAL_CORE_CHECK( ring->getStats().numGrowths == 1u );
+
+    bool exceptionThrown = false;
+    try
+    {
+        ring->allocate( vaoManager->getConstBufferMaxSize() + 1u );
+    }
+    catch( Exception & )
+    {
+        exceptionThrown = true;
+    }
+    INTERNAL_CORE_CHECK( exceptionThrown );
+
+    DynamicUploadRing *readOnlyRing = vaoManager->getDynamicUploadRing( BP_TYPE_READONLY );
+    INTERNAL_CORE_CHECK( readOnlyRing != ring );
+    {
+        DynamicUploadRing::Allocation alloc = readOnlyRing->allocate( 16u * 5u );
+        INTERNAL_CORE_CHECK( alloc.buffer->getBufferPackedType() == BP_TYPE_READONLY );
+        INTERNAL_CORE_CHECK( alloc.offset % 16u == 0u );
+        memset( alloc.data, 0, 16u * 5u );
+    }
+
+    root->renderOneFrame();
+
+    INTERNAL_CORE_CHECK( readOnlyRing->getStats().numAllocationsLastFrame == 1u );
+    INTERNAL_CORE_CHECK( ring->getStats().numAllocationsLastFrame == 0u );
+
+    // BillboardSets are rewritten every frame, so they take their data from the ring
+    SceneManager *sceneManager = mGraphicsSystem->getSceneManager();
+    BillboardSet *billboardSet = sceneManager->createBillboardSet2();
+    billboardSet->setParticleQuota( 8u );
+    billboardSet->init( vaoManager );
+    INTERNAL_CORE_CHECK( !billboardSet->_getGpuDataBuffer() );
+    for( size_t i = 0u; i < 5u; ++i )
+    {
+        Billboard billboard = billboardSet->allocBillboard();
+        billboard.set( Vector3( Real( i ), 0.0f, 0.0f ), Vector3::NEGATIVE_UNIT_Z,
+                       Vector2( 1.0f, 1.0f ), ColourValue::White );
+    }
+
+    root->renderOneFrame();
+
+    INTERNAL_CORE_CHECK( readOnlyRing->getStats().numAllocationsLastFrame == 1u );
+    INTERNAL_CORE_CHECK( billboardSet->_getGpuDataBuffer() &&
+                         billboardSet->_getGpuDataBuffer()->getBufferPackedType() ==
+                             BP_TYPE_READONLY );
+    INTERNAL_CORE_CHECK( billboardSet->_getGpuDataOffset() % 16u == 0u );
+    INTERNAL_CORE_CHECK( billboardSet->_getGpuDataSizeBytes() <=
+                         readOnlyRing->getStats().usedBytesLastFrame );
+
+    sceneManager->destroyBillboardSet2( billboardSet );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testParticleGpuSimulation()
+{
+    using namespace Ogre;
+
+    class TestAffector final : public ParticleAffector2
+    {
+    public:
+        bool mGpuSupported;
+
+        TestAffector( bool gpuSupported ) : mGpuSupported( gpuSupported ) {}
+
+        void run( ParticleCpuData, size_t, ArrayReal ) const override {}
+
+        bool getGpuParams( GpuParticleAffector &outParams ) const override
+        {
+            outParams.type = GpuParticleAffectorType::Rotation;
+            return mGpuSupported;
+        }
+
+        void _cloneFrom( const ParticleAffector2 *original ) override
+        {
+            mGpuSupported = static_cast<const TestAffector *>( original )->mGpuSupported;
+        }
+
+        String getType() const override { return mGpuSupported ? "TestGpuAffector" : "TestCpuAffector"; }
+    };
+
+    class TestAffectorFactory final : public ParticleAffectorFactory2
+    {
+    public:
+        bool mGpuSupported;
+
+        TestAffectorFactory( bool gpuSupported ) : mGpuSupported( gpuSupported ) {}
+
+        String getName() const override
+        {
+            return mGpuSupported ? "TestGpuAffector" : "TestCpuAffector";
+        }
+
+        ParticleAffector2 *createAffector() override { return new TestAffector( mGpuSupported ); }
+    };
+
+    Root *root = mGraphicsSystem->getRoot();
+    SceneManager *sceneManager = mGraphicsSystem->getSceneManager();
+    VaoManager *vaoManager = root->getRenderSystem()->getVaoManager();
+    ParticleSystemManager2 *particleManager = sceneManager->getParticleSystemManager2();
+
+    TestAffectorFactory gpuFactory( true );
+    TestAffectorFactory cpuFactory( false );
+    ParticleSystemManager2::addAffectorFactory( &gpuFactory );
+    ParticleSystemManager2::addAffectorFactory( &cpuFactory );
+
+    ParticleSystemDef *gpuDef =
+        particleManager->createParticleSystemDef( "testParticleGpuSimulation/Gpu" );
+    gpuDef->setParticleQuota( 64u );
+    gpuDef->addAffector( "TestGpuAffector" );
+    gpuDef->init( vaoManager );
+
+    ParticleSystemDef *cpuDef =
+        particleManager->createParticleSystemDef( "testParticleGpuSimulation/Cpu" );
+    cpuDef->setParticleQuota( 64u );
+    cpuDef->addAffector( "TestGpuAffector" );
+    cpuDef->addAffector( "TestCpuAffector" );
+    cpuDef->init( vaoManager );
+
+    INTERNAL_CORE_CHECK( ParticleGpuSimulation::canBeGpuSimulated( gpuDef ) );
+    INTERNAL_CORE_CHECK( !ParticleGpuSimulation::canBeGpuSimulated( cpuDef ) );
+
+    {
+        const bool bHasCompute =
+            root->getRenderSystem()->getCapabilities()->hasCapability( RSC_COMPUTE_PROGRAM );
+
+        ParticleGpuSimulation gpuSimulation( vaoManager,
+                                             root->getHlmsManager()->getComputeHlms() );
+
+        // Affectors which can't run on the GPU keep the whole definition on the CPU
+        INTERNAL_CORE_CHECK( !gpuSimulation.addParticleSystemDef( cpuDef ) );
+        INTERNAL_CORE_CHECK( !cpuDef->isGpuSimulated() );
+
+        ReadOnlyBufferPacked *cpuGpuData = gpuDef->_getGpuDataBuffer();
+        INTERNAL_CORE_CHECK( gpuSimulation.addParticleSystemDef( gpuDef ) == bHasCompute );
+        INTERNAL_CORE_CHECK( gpuDef->isGpuSimulated() == bHasCompute );
+        INTERNAL_CORE_CHECK( gpuSimulation.getNumParticleSystemDefs() == ( bHasCompute ? 1u : 0u ) );
+
+        if( bHasCompute )
+        {
+            // It renders from the buffer filled by the compute shader
+            INTERNAL_CORE_CHECK( gpuDef->_getGpuDataBuffer() != cpuGpuData );
+            INTERNAL_CORE_CHECK( !gpuSimulation.addParticleSystemDef( gpuDef ) );
+
+            gpuSimulation.removeParticleSystemDef( gpuDef );
+            INTERNAL_CORE_CHECK( !gpuDef->isGpuSimulated() );
+            INTERNAL_CORE_CHECK( gpuDef->_getGpuDataBuffer() == cpuGpuData );
+        }
+    }
+    INTERNAL_CORE_CHECK( !gpuDef->isGpuSimulated() );
+
+    ParticleSystemManager2::removeAffectorFactory( &cpuFactory );
+    ParticleSystemManager2::removeAffectorFactory( &gpuFactory );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testParticleDepthSorting()
+{
+    using namespace Ogre;
+
+
+    Root *root = mGraphicsSystem->getRoot();
+    SceneManager *sceneManager = mGraphicsSystem->getSceneManager();
+    VaoManager *vaoManager = root->getRenderSystem()->getVaoManager();
+    ParticleSystemManager2 *particleManager = sceneManager->getParticleSystemManager2();
+
+    // Places each particle at a different distance along +Z, in scrambled order.
+    TestEmitterFactory emitterFactory( "TestSortedEmitter", []( uint32 handle ) {
+        return Vector3( 0.0f, 0.0f, static_cast<Real>( ( handle * 37u ) % 64u ) );
+    } );
+
+    ParticleSystemDef *unsortedDef =
+        particleManager->createParticleSystemDef( "testParticleDepthSorting/Unsorted" );
+    unsortedDef->setParticleQuota( 64u );
+    unsortedDef->init( vaoManager );
+    INTERNAL_CORE_CHECK( !unsortedDef->isDepthSorted() );
+
+    ParticleSystemDef *systemDef =
+        particleManager->createParticleSystemDef( "testParticleDepthSorting/Sorted" );
+    systemDef->setParticleQuota( 64u );
+    systemDef->setSortingEnabled( true );
+    systemDef->addEmitter( "TestSortedEmitter" )->asParticleEmitter()->setEmissionRate( 24.0f );
+    systemDef->init( vaoManager );
+    INTERNAL_CORE_CHECK( systemDef->isDepthSorted() );
+
+    ParticleSystem2 *system = sceneManager->createParticleSystem2( systemDef );
+    SceneNode *sceneNode = sceneManager->getRootSceneNode()->createChildSceneNode();
+    sceneNode->attachObject( system );
+    sceneManager->updateSceneGraph();
+
+    const Vector3 camPos( 0.0f, 0.0f, -10.0f );
+    particleManager->setCameraPosition( camPos );
+
+    for( size_t frame = 0u; frame < 2u; ++frame )
+    {
+        particleManager->prepareForUpdate( 1.0f );
+        particleManager->_prepareParallel();
+        particleManager->update();
+
+        const std::vector<uint32> &sortedParticles = systemDef->_getSortedParticles();
+        INTERNAL_CORE_CHECK( sortedParticles.size() == ( frame + 1u ) * 24u );
+
+        // Nothing has died yet, thus mParticleGpuData[i] belongs to the particle with handle i.
+        const ParticleCpuData cpuData = systemDef->getParticleCpuData();
+        Real prevDistance = std::numeric_limits<Real>::max();
+        for( const uint32 h : sortedParticles )
+        {
+            Vector3 pos;
+            cpuData.mPosition[h / ARRAY_PACKED_REALS].getAsVector3( pos, h % ARRAY_PACKED_REALS );
+            const Real distance = pos.distance( camPos );
+            INTERNAL_CORE_CHECK( distance <= prevDistance );
+            prevDistance = distance;
+        }
+    }
+
+    sceneNode->detachAllObjects();
+    sceneManager->destroyParticleSystem2( system );
+    sceneManager->destroySceneNode( sceneNode );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testParticleCullingAndThrottling()
+{
+    using namespace Ogre;
+
+
+    Root *root = mGraphicsSystem->getRoot();
+    SceneManager *sceneManager = mGraphicsSystem->getSceneManager();
+    VaoManager *vaoManager = root->getRenderSystem()->getVaoManager();
+    ParticleSystemManager2 *particleManager = sceneManager->getParticleSystemManager2();
+    RenderQueue *renderQueue = sceneManager->getRenderQueue();
+
+    TestEmitterFactory emitterFactory( "TestCullingEmitter",
+                                       []( uint32 ) { return Vector3::ZERO; } );
+
+    ParticleSystemDef *systemDef =
+        particleManager->createParticleSystemDef( "testParticleCullingAndThrottling" );
+    systemDef->setParticleQuota( 256u );
+    systemDef->setInvisibleTickInterval( 4u );
+    systemDef->addEmitter( "TestCullingEmitter" )->asParticleEmitter()->setEmissionRate( 8.0f );
+    systemDef->init( vaoManager );
+
+    // Instance A is in front of the camera, B is far to its right.
+    ParticleSystem2 *systems[2];
+    SceneNode *sceneNodes[2];
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        systems[i] = sceneManager->createParticleSystem2( systemDef );
+        systems[i]->setLocalAabb( Aabb( Vector3::ZERO, Vector3::UNIT_SCALE ) );
+        sceneNodes[i] = sceneManager->getRootSceneNode()->createChildSceneNode(
+            SCENE_DYNAMIC, Vector3( i == 0u ? 0.0f : 1000.0f, 0.0f, 0.0f ) );
+        sceneNodes[i]->attachObject( systems[i] );
+        // Don't use updateSceneGraph(), it would also update the particles.
+        sceneNodes[i]->_getFullTransformUpdated();
+    }
+
+    Camera *camera = sceneManager->createCamera( "testParticleCullingAndThrottling" );
+    camera->setNearClipDistance( 0.5f );
+    camera->setPosition( 0.0f, 0.0f, 50.0f );
+    camera->setOrientation( Quaternion::IDENTITY );
+    particleManager->setCullCamera( camera );
+
+    const auto cullAndUpdate = [&]( Real timeSinceLast )
+    {
+        // Render passes (e.g. shadow casters) must not affect visibility.
+        particleManager->_addToRenderQueue( 0u, 1u, renderQueue, systemDef->getRenderQueueGroup(),
+                                            0xFFFFFFFF, true );
+        renderQueue->clear();
+
+        particleManager->prepareForUpdate( timeSinceLast );
+        particleManager->_prepareParallel();
+        particleManager->update();
+    };
+
+    // Particles never die and are allocated contiguously, and all counts are multiple of 4.
+    // Thus getNumSimdActiveParticles() is the exact number of particles emitted so far.
+
+    // B starts as visible. Then it only emits every 4th frame, but with all the time it missed.
+    const size_t expectedVisible[5] = { 16u, 24u, 32u, 40u, 80u };
+    for( size_t frame = 0u; frame < 5u; ++frame )
+    {
+        cullAndUpdate( 1.0f );
+        INTERNAL_CORE_CHECK( systemDef->getNumSimdActiveParticles() == expectedVisible[frame] );
+    }
+    INTERNAL_CORE_CHECK( systems[0]->getLastVisibleFrame() == particleManager->getCurrentFrame() );
+    INTERNAL_CORE_CHECK( systems[1]->getLastVisibleFrame() != particleManager->getCurrentFrame() );
+
+    // Look away from both. The first update still uses the visibility culled by the previous
+    // one. Then the whole definition is updated once every 4 frames, and both A and B catch up
+    // with all the time that was skipped.
+    camera->setOrientation( Quaternion( Degree( 180.0f ), Vector3::UNIT_Y ) );
+
+    const size_t expectedInvisible[5] = { 88u, 88u, 88u, 88u, 160u };
+    for( size_t frame = 0u; frame < 5u; ++frame )
+    {
+        cullAndUpdate( 1.0f );
+        INTERNAL_CORE_CHECK( systemDef->getNumSimdActiveParticles() == expectedInvisible[frame] );
+    }
+
+    // Emission LOD: A is 4x further than the LOD distance; B is so far it doesn't emit.
+    systemDef->setInvisibleTickInterval( 1u );
+    systemDef->setEmissionLodDistance( 10.0f );
+    particleManager->setCameraPosition( Vector3( 0.0f, 0.0f, 40.0f ) );
+    cullAndUpdate( 4.0f );
+    INTERNAL_CORE_CHECK( systemDef->getNumSimdActiveParticles() == 168u );
+
+    particleManager->setCameraPosition( Vector3::ZERO );
+    sceneManager->destroyCamera( camera );
+    INTERNAL_CORE_CHECK( !particleManager->getCullCamera() );
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        sceneNodes[i]->detachAllObjects();
+        sceneManager->destroyParticleSystem2( systems[i] );
+        sceneManager->destroySceneNode( sceneNodes[i] );
+    }
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testParticleBulkEmission()
+{
+    using namespace Ogre;
+
+
+    Root *root = mGraphicsSystem->getRoot();
+    SceneManager *sceneManager = mGraphicsSystem->getSceneManager();
+    VaoManager *vaoManager = root->getRenderSystem()->getVaoManager();
+    ParticleSystemManager2 *particleManager = sceneManager->getParticleSystemManager2();
+
+    TestEmitterFactory emitterFactory( "TestBulkEmitter",
+                                       []( uint32 ) { return Vector3( 1.0f, 2.0f, 3.0f ); } );
+
+    const uint32 quota = 1024u;
+
+    ParticleSystemDef *systemDef =
+        particleManager->createParticleSystemDef( "testParticleBulkEmission" );
+    systemDef->setParticleQuota( quota );
+    systemDef->setDefaultDimensions( 0.5f, 0.25f );
+    ParticleEmitter *emitter = systemDef->addEmitter( "TestBulkEmitter" )->asParticleEmitter();
+    emitter->setEmissionRate( 20000.0f );
+    emitter->setParticleVelocity( 0.0f );
+    emitter->setTimeToLive( 0.1f, 2.0f );
+    systemDef->init( vaoManager );
+    TestEmitter *testEmitter = emitterFactory.mLastCreated;
+
+    const Vector3 instancePos( 10.0f, 0.0f, 0.0f );
+    const Quaternion instanceRot( Degree( 90.0f ), Vector3::UNIT_Y );
+    ParticleSystem2 *system = sceneManager->createParticleSystem2( systemDef );
+    SceneNode *sceneNode = sceneManager->getRootSceneNode()->createChildSceneNode(
+        SCENE_DYNAMIC, instancePos, instanceRot );
+    sceneNode->attachObject( system );
+    // Don't use updateSceneGraph(), it would also update the particles.
+    sceneNode->_getFullTransformUpdated();
+
+    const Vector3 expectedPos = instancePos + instanceRot * Vector3( 1.0f, 2.0f, 3.0f );
+
+    // The first frame is a burst much bigger than the quota, emitted as one contiguous range.
+    // Afterwards particles die in random order, thus the pool gets refilled from scattered
+    // slots, which must never be handed out twice.
+    for( size_t frame = 0u; frame < 16u; ++frame )
+    {
+        testEmitter->mEmittedHandles.clear();
+
+        particleManager->prepareForUpdate( 0.125f );
+        particleManager->_prepareParallel();
+        particleManager->update();
+
+        INTERNAL_CORE_CHECK( testEmitter->mNumDuplicatedHandles == 0u );
+        if( frame == 0u )
+        {
+            INTERNAL_CORE_CHECK( testEmitter->mEmittedHandles.size() == quota );
+            INTERNAL_CORE_CHECK( systemDef->getNumSimdActiveParticles() == quota );
+        }
+
+        const ParticleCpuData cpuData = systemDef->getParticleCpuData();
+        const Real *timeToLive = reinterpret_cast<const Real *>( cpuData.mTimeToLive );
+        for( const uint32 handle : testEmitter->mEmittedHandles )
+        {
+            const size_t j = handle / ARRAY_PACKED_REALS;
+            const size_t idx = handle % ARRAY_PACKED_REALS;
+            if( timeToLive[handle] > 0.0f )
+            {
+                Vector3 pos;
+                cpuData.mPosition[j].getAsVector3( pos, idx );
+                INTERNAL_CORE_CHECK( pos.positionEquals( expectedPos, 1e-4f ) );
+                INTERNAL_CORE_CHECK( cpuData.mDimensions[j].getAsVector2( idx ) ==
+                                     Vector2( 0.5f, 0.25f ) );
+                INTERNAL_CORE_CHECK( cpuData.mColour[j].getAsVector4( idx ) ==
+                                     Vector4( 1.0f, 1.0f, 1.0f, 1.0f ) );
+                INTERNAL_CORE_CHECK( timeToLive[handle] <= 2.0f );
+            }
+        }
+    }
+
+    // A burst that starts at an unaligned handle must still be written in whole packs,
+    // except for its unaligned head and tail.
+    ParticleSystemDef *unalignedDef =
+        particleManager->createParticleSystemDef( "testParticleBulkEmission/Unaligned" );
+    unalignedDef->setParticleQuota( 256u );
+    ParticleEmitter *unalignedEmitter =
+        unalignedDef->addEmitter( "TestBulkEmitter" )->asParticleEmitter();
+    unalignedEmitter->setEmissionRate( 8.0f );
+    unalignedEmitter->setParticleVelocity( 0.0f );
+    unalignedEmitter->setTimeToLive( 100.0f );
+    unalignedDef->init( vaoManager );
+    TestEmitter *unalignedTestEmitter = emitterFactory.mLastCreated;
+
+    ParticleSystem2 *unalignedSystem = sceneManager->createParticleSystem2( unalignedDef );
+    sceneNode->attachObject( unalignedSystem );
+
+    particleManager->prepareForUpdate( 0.375f );  // Emits handles [0; 3)
+    particleManager->_prepareParallel();
+    particleManager->update();
+    INTERNAL_CORE_CHECK( unalignedTestEmitter->mEmittedHandles.size() == 3u );
+
+    unalignedTestEmitter->mNumWholePacks = 0u;
+    particleManager->prepareForUpdate( 8.0f );  // Emits handles [3; 67)
+    particleManager->_prepareParallel();
+    particleManager->update();
+    INTERNAL_CORE_CHECK( unalignedTestEmitter->mEmittedHandles.size() == 67u );
+    const size_t unalignedHead = ( ARRAY_PACKED_REALS - 3u % ARRAY_PACKED_REALS ) % ARRAY_PACKED_REALS;
+    INTERNAL_CORE_CHECK( unalignedTestEmitter->mNumWholePacks ==
+                         ( 64u - unalignedHead ) / ARRAY_PACKED_REALS );
+
+    sceneNode->detachAllObjects();
+    sceneManager->destroyParticleSystem2( unalignedSystem );
+    sceneManager->destroyParticleSystem2( system );
+    sceneManager->destroySceneNode( sceneNode );
+}
+//-----------------------------------------------------------------------------------
+void InternalCoreGameState::testBillboardSetBatchedVertices()
 {
+    using namespace Ogre;
+
+    SceneManager *sceneManager = mGraphicsSystem->getSceneManager();
+    RenderQueue *renderQueue = sceneManager->getRenderQueue();
+
+    const size_t numBillboards = 3000u;
+
+    v1::BillboardSet *billboardSet =
+        sceneManager->createBillboardSet( static_cast<unsigned int>( numBillboards ) );
+    billboardSet->setTextureStacksAndSlices( 2u, 2u );
+    billboardSet->setDefaultDimensions( 0.5f, 0.25f );
+    for( size_t i = 0u; i < numBillboards; ++i )
+    {
+        v1::Billboard *billboard = billboardSet->createBillboard(
+            Vector3( Real( i % 20u ) - 10.0f, Real( ( i / 20u ) % 20u ) - 10.0f,
+                     -Real( i / 400u ) ),
+            ColourValue( Real( i % 7u ) / 7.0f, Real( i % 5u ) / 5.0f, 1.0f, 0.5f ) );
+        billboard->setTexcoordIndex( static_cast<uint16>( i % 4u ) );
+        if( i % 3u == 0u )
+            billboard->setDimensions( 0.1f + Real( i % 11u ) * 0.1f, 0.3f );
+        if( i % 5u == 0u )
+            billboard->setRotation( Radian( Real( i % 13u ) * 0.25f ) );
+    }
+
+    SceneNode *sceneNode = sceneManager->getRootSceneNode()->createChildSceneNode();
+    sceneNode->attachObject( billboardSet );
+    sceneNode->_getFullTransformUpdated();
+
+    Camera *camera = sceneManager->createCamera( "testBillboardSetBatchedVertices" );
+    camera->setNearClipDistance( 0.5f );
+    camera->setPosition( 1.0f, 2.0f, 40.0f );
+    camera->lookAt( Vector3::ZERO );
+    camera->getFrustumPlanes();  // Updates the cached planes.
+
+    // Culling each billboard individually forces the per-billboard path. All of them are
+    // visible, so both paths must output the same vertices.
+    std::vector<float> vertices[2];
+    for( size_t i = 0u; i < 2u; ++i )
+    {
+        billboardSet->setCullIndividually( i == 1u );
+        billboardSet->_updateRenderQueue( renderQueue, camera, camera );
+
+        v1::RenderOperation op;
+        billboardSet->getRenderOperation( op, false );
+        INTERNAL_CORE_CHECK( op.vertexData->vertexCount == numBillboards * 4u );
+
+        v1::HardwareVertexBufferSharedPtr vertexBuffer =
+            op.vertexData->vertexBufferBinding->getBuffer( 0 );
+        const size_t numFloats = op.vertexData->vertexCount * vertexBuffer->getVertexSize() / 4u;
+        const float *src =
+            static_cast<const float *>( vertexBuffer->lock( v1::HardwareBuffer::HBL_READ_ONLY ) );
+        vertices[i].assign( src, src + numFloats );
+        vertexBuffer->unlock();
+    }
+
+    // Position (3 floats), colour (1 RGBA) & texture coords (2 floats).
+    for( size_t i = 0u; i < vertices[0].size(); ++i )
+    {
+        if( i % 6u == 3u )
+        {
+            INTERNAL_CORE_CHECK( reinterpret_cast<const uint32 &>( vertices[0][i] ) ==
+                                 reinterpret_cast<const uint32 &>( vertices[1][i] ) );
+        }
+        else
+        {
+            INTERNAL_CORE_CHECK( Math::Abs( vertices[0][i] - vertices[1][i] ) <= 1e-5f );
+        }
+    }
+
+    sceneNode->detachObject( billboardSet );
+    sceneManager->destroySceneNode( sceneNode );
+    sceneManager->destroyBillboardSet( billboardSet );
+    sceneManager->destroyCamera( camera );
 }
 //-----------------------------------------------------------------------------------
 void InternalCoreGameState::createScene01()
@@ -109,5 +3264,33 @@ void InternalCoreGameState::createScene01()
         }
     }
 
+    testBulkPixelConversion();
+    testNormalMapConversion();
+    testBCnEncoder();
+    testFilteredTextureCache();
+    testAsyncTextureReadbackBatcher();
+    testAutomaticBatching();
+    testTlsfAllocator();
+    testVaoPoolGrowth();
+    testVaoDefragmentation();
+    testMeshOptimizer();
+    testMeshlets();
+    testVertexQuantization();
+    testMeshSerializerV3();
+    testAsyncMeshLoading();
+    testEdgeListBuilderThreads();
+    testDynamicUploadRing();
+    testSharedStaticMeshBuffers();
+    testCompressedSkeletonAnimation();
+    testAnimationLod();
+    testPreSkinning();
+    testSkeletonPoseSource();
+    testSkeletonBlendLayers();
+    testParticleGpuSimulation();
+    testParticleDepthSorting();
+    testParticleCullingAndThrottling();
+    testParticleBulkEmission();
+    testBillboardSetBatchedVertices();
+
     mGraphicsSystem->setQuit();
 }
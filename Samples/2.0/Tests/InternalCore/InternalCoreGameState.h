@@ -10,6 +10,114 @@ namespace Demo
 {
     class InternalCoreGameState : public TutorialGameState
     {
+        /// Validates PixelFormatGpuUtils::bulkPixelConversion's fast paths against
+        /// the brute force per-pixel conversion, and logs how long each one takes.
+        void testBulkPixelConversion();
+
+        /// Validates PixelFormatGpuUtils::convertForNormalMapping against the per-pixel
+        /// conversion for 8-bit, 16-bit, half & float sources, and logs how long each takes.
+        void testNormalMapConversion();
+
+        /// Encodes gradients into every format BCnEncoder supports, checking the PSNR of the
+        /// decoded result and that multithreaded encoding gives the same output.
+        void testBCnEncoder();
+
+        /// Checks the filtered texture cache keys change with everything that alters the filters'
+        /// output, and that every save job gets its own temporary file.
+        void testFilteredTextureCache();
+
+        /// Chains readbacks by calling AsyncTextureReadbackBatcher::download from inside the
+        /// listener, and checks none of them gets lost.
+        void testAsyncTextureReadbackBatcher();
+
+        /// Checks TextureGpuManager::setAutomaticBatchingMaxResolution batches small textures
+        /// only while Resident, and never changes their flags.
+        void testAutomaticBatching();
+
+        /// Stress tests TlsfAllocator with random allocations & alignments,
+        /// validating there are no overlaps and that free memory is fully coalesced.
+        void testTlsfAllocator();
+
+        /// Creates buffers that overflow the first pool, and one bigger than a whole default
+        /// pool, checking new pools get created and every buffer kept its contents.
+        void testVaoPoolGrowth();
+
+        /// Fragments the VaoManager's pools on purpose, defragments them and
+        /// validates the relocated buffers kept their contents.
+        void testVaoDefragmentation();
+
+        /// Runs MeshOptimizer on a shuffled grid and validates the ACMR improves
+        /// while the set of triangles and winding is preserved.
+        void testMeshOptimizer();
+
+        /// Splits a grid into meshlets with MeshOptimizer::buildMeshlets, checks they respect
+        /// the limits and cover every triangle, and that cullMeshlets rejects the right ones.
+        void testMeshlets();
+
+        /// Quantizes near & far away vertices with SubMesh::_quantizeVertexElements, checking
+        /// the chosen formats and that unpacking them stays within the expected error.
+        void testVertexQuantization();
+
+        /// Round trips a mesh through MESH_VERSION_2_1 and MESH_VERSION_3_0, with and without
+        /// compressed payloads, checking the buffers keep their contents.
+        void testMeshSerializerV3();
+
+        /// Loads a mesh with MeshManager::loadAsync and checks Items using it stay
+        /// empty until it's ready. Also checks a missing file fails gracefully.
+        void testAsyncMeshLoading();
+
+        /// Builds the edge list of a big torus welded along its seams on the calling
+        /// thread and on the worker threads of a SceneManager, checks both match and
+        /// logs how long each one takes.
+        void testEdgeListBuilderThreads();
+
+        /// Sub-allocates from the DynamicUploadRing across frames, overflowing
+        /// it on purpose to check it grows.
+        void testDynamicUploadRing();
+
+        /// Loads small meshes with MeshManager::setShareStaticBuffers and checks they
+        /// share the same Vao and their ranges & rebased indices are correct.
+        void testSharedStaticMeshBuffers();
+
+        /// Compresses a skeleton's animations and checks the memory went down and the
+        /// sampled bone transforms stay within the error budget.
+        void testCompressedSkeletonAnimation();
+
+        /// Animates a skeleton whose LOD source is far from the camera and checks it only
+        /// gets animated every N frames, with its leaf bones frozen.
+        void testAnimationLod();
+
+        /// Pre-skins an Item and checks the supported SubItems switch to their own static
+        /// Vaos in every pass, and go back to vertex shader skinning once removed.
+        void testPreSkinning();
+
+        /// Checks SkeletonInstances following a pose source copy its pose but keep
+        /// their own parent node and manual bones.
+        void testSkeletonPoseSource();
+
+        /// Crossfades two animations on different layers and checks the blended pose is the
+        /// same whether the skeleton is animated by one thread or split across several.
+        void testSkeletonBlendLayers();
+
+        /// Checks ParticleSystemDefs only get simulated on the GPU when all their affectors
+        /// support it, and that they go back to the CPU once removed.
+        void testParticleGpuSimulation();
+
+        /// Checks particles of a sorted ParticleSystemDef are drawn back to front.
+        void testParticleDepthSorting();
+
+        /// Checks ParticleSystem2 instances outside the frustum are simulated less often without
+        /// losing emissions, and that distant instances emit less.
+        void testParticleCullingAndThrottling();
+
+        /// Checks bursts are emitted as contiguous ranges and initialized in SIMD packs, and that
+        /// refilling a full pool never hands out the same particle twice.
+        void testParticleBulkEmission();
+
+        /// Checks v1::BillboardSet generates the same vertices through the batched SIMD path
+        /// as through the per-billboard path.
+        void testBillboardSetBatchedVertices();
+
     public:
         InternalCoreGameState( const Ogre::String &helpDescription );
 
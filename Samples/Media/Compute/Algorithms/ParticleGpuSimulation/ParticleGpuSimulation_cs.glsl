@@ -0,0 +1,51 @@
+@insertpiece( SetCrossPlatformSettings )
+
+@insertpiece( PreBindingsHeaderCS )
+
+@property( syntax == glsl )
+	#define ogre_U0 binding = 0
+	#define ogre_U1 binding = 1
+@end
+
+layout( std430, ogre_U0 ) restrict buffer particleStateLayout
+{
+	float4 particleState[];
+};
+@property( !spawn )
+layout( std430, ogre_U1 ) writeonly restrict buffer gpuDataLayout
+{
+	uint gpuData[];
+};
+@end
+
+layout( local_size_x = @value( threads_per_group_x ),
+		local_size_y = @value( threads_per_group_y ),
+		local_size_z = @value( threads_per_group_z ) ) in;
+
+@property( syntax == glsl )
+	@property( spawn )
+		ReadOnlyBufferF( 1, float4, srcData );
+	@else
+		ReadOnlyBufferF( 2, float4, srcData );
+	@end
+@else
+	ReadOnlyBufferF( 0, float4, srcData );
+@end
+
+@insertpiece( HeaderCS )
+
+vulkan( layout( ogre_P0 ) uniform Params { )
+	uniform uint4 jobParams;
+	uniform float timeSinceLast;
+vulkan( }; )
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+void main()
+{
+	@insertpiece( BodyCS )
+}
@@ -0,0 +1,30 @@
+@insertpiece( SetCrossPlatformSettings )
+
+@insertpiece( PreBindingsHeaderCS )
+
+RWStructuredBuffer<float4> particleState	: register(u0);
+@property( !spawn )
+RWStructuredBuffer<uint> gpuData			: register(u1);
+@end
+
+ReadOnlyBuffer( 0, float4, srcData );
+
+@insertpiece( HeaderCS )
+
+uniform uint4 jobParams;
+uniform float timeSinceLast;
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+[numthreads(@value( threads_per_group_x ), @value( threads_per_group_y ), @value( threads_per_group_z ))]
+void main
+(
+	uint3 gl_GlobalInvocationID : SV_DispatchThreadId
+)
+{
+	@insertpiece( BodyCS )
+}
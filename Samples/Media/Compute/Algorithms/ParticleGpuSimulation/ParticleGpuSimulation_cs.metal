@@ -0,0 +1,45 @@
+@insertpiece( SetCrossPlatformSettings )
+
+@property( spawn )
+	#define PARAMS_ARG_DECL , device float4 *particleState, device const float4 *srcData, constant Params &p
+	#define PARAMS_ARG , particleState, srcData, p
+@else
+	#define PARAMS_ARG_DECL , device float4 *particleState, device uint *gpuData, device const float4 *srcData, constant Params &p
+	#define PARAMS_ARG , particleState, gpuData, srcData, p
+@end
+
+struct Params
+{
+	uint4 jobParams;
+	float timeSinceLast;
+};
+
+#define jobParams p.jobParams
+#define timeSinceLast p.timeSinceLast
+
+@insertpiece( PreBindingsHeaderCS )
+
+@insertpiece( HeaderCS )
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+kernel void main_metal
+(
+	device float4 *particleState			[[buffer(UAV_SLOT_START+0)]],
+@property( !spawn )
+	device uint *gpuData					[[buffer(UAV_SLOT_START+1)]],
+@end
+
+	device const float4 *srcData			[[buffer(TEX_SLOT_START+0)]],
+
+	constant Params &p						[[buffer(PARAMETER_SLOT)]],
+
+	uint3 gl_GlobalInvocationID				[[thread_position_in_grid]]
+)
+{
+	@insertpiece( BodyCS )
+}
@@ -0,0 +1,28 @@
+@insertpiece( SetCrossPlatformSettings )
+
+@insertpiece( PreBindingsHeaderCS )
+
+RWStructuredBuffer<uint> srcVertexBuffer	: register(u0);
+RWStructuredBuffer<uint> dstVertexBuffer	: register(u1);
+
+ReadOnlyBuffer( 0, float4, boneMatrices );
+
+@insertpiece( HeaderCS )
+
+uniform uint4 vertexLayout0;
+uniform uint4 vertexLayout1;
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+[numthreads(@value( threads_per_group_x ), @value( threads_per_group_y ), @value( threads_per_group_z ))]
+void main
+(
+	uint3 gl_GlobalInvocationID : SV_DispatchThreadId
+)
+{
+	@insertpiece( BodyCS )
+}
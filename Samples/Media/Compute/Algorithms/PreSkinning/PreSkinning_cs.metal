@@ -0,0 +1,38 @@
+@insertpiece( SetCrossPlatformSettings )
+
+#define PARAMS_ARG_DECL , device const uint *srcVertexBuffer, device uint *dstVertexBuffer, device const float4 *boneMatrices, constant Params &p
+#define PARAMS_ARG , srcVertexBuffer, dstVertexBuffer, boneMatrices, p
+
+struct Params
+{
+	uint4 vertexLayout0;
+	uint4 vertexLayout1;
+};
+
+#define vertexLayout0 p.vertexLayout0
+#define vertexLayout1 p.vertexLayout1
+
+@insertpiece( PreBindingsHeaderCS )
+
+@insertpiece( HeaderCS )
+
+//in uvec3 gl_NumWorkGroups;
+//in uvec3 gl_WorkGroupID;
+//in uvec3 gl_LocalInvocationID;
+//in uvec3 gl_GlobalInvocationID;
+//in uint  gl_LocalInvocationIndex;
+
+kernel void main_metal
+(
+	device const uint *srcVertexBuffer		[[buffer(UAV_SLOT_START+0)]],
+	device uint *dstVertexBuffer			[[buffer(UAV_SLOT_START+1)]],
+
+	device const float4 *boneMatrices		[[buffer(TEX_SLOT_START+0)]],
+
+	constant Params &p						[[buffer(PARAMETER_SLOT)]],
+
+	uint3 gl_GlobalInvocationID				[[thread_position_in_grid]]
+)
+{
+	@insertpiece( BodyCS )
+}
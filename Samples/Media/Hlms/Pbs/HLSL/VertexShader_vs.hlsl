@@ -14,7 +14,8 @@ struct VS_INPUT
 {
 @property( !hlms_particle_system )
 	float4 vertex : POSITION;
-	@property( hlms_normal )	float3 normal : NORMAL;@end
+	@property( hlms_normal && !hlms_octahedral_normal )	float3 normal : NORMAL;@end
+	@property( hlms_octahedral_normal )	float2 normal : NORMAL;@end
 	@property( hlms_qtangent )	float4 qtangent : NORMAL;@end
 
 	@property( normal_map && !hlms_qtangent )
@@ -9,7 +9,8 @@ struct VS_INPUT
 {
 @property( !hlms_particle_system )
 	float4 position [[attribute(VES_POSITION)]];
-	@property( hlms_normal )	float3 normal [[attribute(VES_NORMAL)]];@end
+	@property( hlms_normal && !hlms_octahedral_normal )	float3 normal [[attribute(VES_NORMAL)]];@end
+	@property( hlms_octahedral_normal )	float2 normal [[attribute(VES_NORMAL)]];@end
 	@property( hlms_qtangent )	midf4 qtangent [[attribute(VES_NORMAL)]];@end
 
 	@property( normal_map && !hlms_qtangent )
@@ -41,8 +41,13 @@ struct UpgradeOptions
     bool halfPos;
     bool halfTexCoords;
     bool qTangents;
+    bool autoQuantize;
     bool optimizeForShadowMapping;
     bool stripShadowMapping;
+    bool optimizeVertexCache;
+    Ogre::Real overdrawThreshold;
+    bool buildMeshlets;
+    bool compressBuffers;
 };
 
 extern UpgradeOptions opts;
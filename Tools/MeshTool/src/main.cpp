@@ -39,6 +39,7 @@ THE SOFTWARE.
 
 #include "OgreMeshManager2.h"
 #include "OgreMesh2.h"
+#include "OgreSubMesh2.h"
 
 #include "UpgradeOptions.h"
 
@@ -100,17 +101,28 @@ void help()
     cout << "-E endian  = Set endian mode 'big' 'little' or 'native' (default)" << endl;
     cout << "-b         = Recalculate bounding box (static meshes only)" << endl;
     cout << "-V version = Specify OGRE version format to write instead of latest" << endl;
-    cout << "             Options are: 2.1, 1.10, 1.8, 1.7, 1.4, 1.0" << endl;
+    cout << "             Options are: 3.0 (only with -v2), 2.1, 1.10, 1.8, 1.7, 1.4, 1.0" << endl;
+    cout << "             3.0 stores the buffers page aligned and compressed for faster loading." << endl;
+    cout << "-nz        = DON'T compress the buffers when writing 3.0 meshes (i.e. to mmap them)" << endl;
     cout << "-v2          Export the mesh as a v2 object. Keeps the original format otherwise." << endl;
     cout << "             Use this format if you load the mesh by the SceneManager::createItem() method." << endl;
     cout << "-v1          Export the mesh as a v1 object. Keeps the original format otherwise." << endl;
     cout << "             Use this if you load the mesh by the SceneManager::createEntity() method or if you import from v1 to v2 at runtime." << endl;
-    cout << "-O puqs    = Optimize vertex buffers for shaders." << endl;
+    cout << "-O puqsa   = Optimize vertex buffers for shaders." << endl;
     cout << "             p converts POSITION to 16-bit floats" << endl;
     cout << "             q converts normal tangent and bitangent (28-36 bytes) to QTangents (8 bytes)." << endl;
+    cout << "             a picks the smallest position, normal and UV formats that keep enough" << endl;
+    cout << "               precision for each submesh. Overrides p, u & q. Only for v2 meshes." << endl;
     cout << "             u converts UVs to 16-bit floats." << endl;
     cout << "             s make shadow mapping passes have their own optimized buffers. Overrides existing ones if any." << endl;
     cout << "             S strips the buffers for shadow mapping (consumes less space and memory)." << endl;
+    cout << "-vc        = Reorders triangles and vertices for the post-transform vertex cache," << endl;
+    cout << "             reduced overdraw and sequential vertex fetches. Prints ACMR/ATVR" << endl;
+    cout << "             before and after. Only applies when saving v2 meshes." << endl;
+    cout << "-vct thres = Max ACMR degradation allowed by -vc to reduce overdraw (default 1.05)." << endl;
+    cout << "             0 disables the overdraw optimization." << endl;
+    cout << "-ml        = Splits every submesh LOD into meshlets with bounding spheres and normal" << endl;
+    cout << "             cones for cluster culling. Applied after -vc. Only for v2 meshes." << endl;
     cout << "-U         = Performs the opposite of -O puq: Converts 16-bit half to to float and " << endl;
     cout << "             converts QTangents to Normal + Tangent + Reflection. Needed by many" << endl;
     cout << "             other options that have to read from position, normals or UVs." << endl;
@@ -168,8 +180,13 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     opts.halfPos        = false;
     opts.halfTexCoords  = false;
     opts.qTangents      = false;
+    opts.autoQuantize   = false;
     opts.optimizeForShadowMapping = false;
     opts.stripShadowMapping = false;
+    opts.optimizeVertexCache = false;
+    opts.overdrawThreshold = 1.05f;
+    opts.buildMeshlets = false;
+    opts.compressBuffers = true;
 
 
     UnaryOptionList::iterator ui = unOpts.find("-e");
@@ -236,6 +253,12 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     {
         opts.unoptimizeBuffer = true;
     }
+    ui = unOpts.find("-vc");
+    opts.optimizeVertexCache = ui->second;
+    ui = unOpts.find("-ml");
+    opts.buildMeshlets = ui->second;
+    ui = unOpts.find("-nz");
+    opts.compressBuffers = !ui->second;
 
 
     BinaryOptionList::iterator bi = binOpts.find("-l");
@@ -265,6 +288,12 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
         opts.usePercent = false;
     }
 
+    bi = binOpts.find("-vct");
+    if (!bi->second.empty())
+    {
+        opts.overdrawThreshold = StringConverter::parseReal(bi->second);
+    }
+
     bi = binOpts.find("-E");
     if (!bi->second.empty())
     {
@@ -310,6 +339,10 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
             opts.targetVersion  = v1::MESH_VERSION_2_1;
             opts.targetVersionV2= MESH_VERSION_2_1;
         }
+        else if( bi->second == "3.0" && opts.exportAsV2 )
+        {
+            opts.targetVersionV2 = MESH_VERSION_3_0;
+        }
 
         if( !opts.exportAsV2 )
         {
@@ -359,6 +392,8 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
             opts.halfTexCoords = true;
         if( bi->second.find( 'q' ) != String::npos )
             opts.qTangents = true;
+        if( bi->second.find( 'a' ) != String::npos )
+            opts.autoQuantize = true;
         if( bi->second.find( 's' ) != String::npos )
             opts.optimizeForShadowMapping = true;
         if( bi->second.find( 'S' ) != String::npos )
@@ -377,6 +412,8 @@ void vertexBufferReorg(v1::Mesh& mesh);
 void buildEdgeLists( v1::MeshPtr &mesh );
 void generateTangents( v1::MeshPtr &mesh );
 void recalcBounds( v1::MeshPtr &v1Mesh, MeshPtr &v2Mesh );
+void optimizeVertexCache( MeshPtr &v2Mesh );
+void buildMeshlets( MeshPtr &v2Mesh );
 
 void printLodConfig(const LodConfig& lodConfig)
 {
@@ -1061,6 +1098,13 @@ void saveMesh( const String &destination, v1::MeshPtr &v1Mesh, MeshPtr &v2Mesh,
                     vertexBufferReorg( *v1Mesh.get() );
             }
 
+            if( opts.optimizeBuffer && opts.autoQuantize )
+                cout << "-O a is ignored when exporting v1 meshes" << endl;
+            if( opts.optimizeVertexCache )
+                cout << "-vc is ignored when exporting v1 meshes" << endl;
+            if( opts.buildMeshlets )
+                cout << "-ml is ignored when exporting v1 meshes" << endl;
+
             cout << "Saving as a v1 mesh..." << endl;
             meshSerializer->exportMesh( v1Mesh.get(), destination, opts.targetVersion, opts.endian );
         }
@@ -1074,9 +1118,18 @@ void saveMesh( const String &destination, v1::MeshPtr &v1Mesh, MeshPtr &v2Mesh,
             }
 
             if( v1Mesh )
-                v2Mesh->importV1( v1Mesh.get(), false, false, false );
+            {
+                if( opts.optimizeBuffer && opts.autoQuantize )
+                    v2Mesh->importV1( v1Mesh.get(), VertexQuantizationSettings() );
+                else
+                    v2Mesh->importV1( v1Mesh.get(), false, false, false );
+            }
+
+            optimizeVertexCache( v2Mesh );
+            buildMeshlets( v2Mesh );
 
             cout << "Saving as a v2 mesh..." << endl;
+            meshSerializer2.setCompressPayloads( opts.compressBuffers );
             meshSerializer2.exportMesh( v2Mesh.get(), destination, opts.targetVersionV2, opts.endian );
         }
 
@@ -1227,6 +1280,9 @@ int main(int numargs, char** args)
         unOptList["-U"] = false;
         unOptList["-v1"]= false;
         unOptList["-v2"]= false;
+        unOptList["-vc"]= false;
+        unOptList["-ml"]= false;
+        unOptList["-nz"]= false;
         binOptList["-l"] = "";
         binOptList["-d"] = "";
         binOptList["-p"] = "";
@@ -1236,6 +1292,7 @@ int main(int numargs, char** args)
         binOptList["-ts"] = "";
         binOptList["-V"] = "";
         binOptList["-O"] = "";
+        binOptList["-vct"] = "";
 
         int startIdx = findCommandLineOpts(numargs, args, unOptList, binOptList);
         parseOpts(unOptList, binOptList);
@@ -1322,10 +1379,16 @@ int main(int numargs, char** args)
 
         if( opts.optimizeBuffer )
         {
-            if( v1Mesh )
+            // With 'a' v1 meshes are quantized when imported to v2 in saveMesh
+            if( v1Mesh && !opts.autoQuantize )
                 mesh->arrangeEfficient( opts.halfPos, opts.halfTexCoords, opts.qTangents );
             if( v2Mesh )
-                v2Mesh->arrangeEfficient( opts.halfPos, opts.halfTexCoords, opts.qTangents );
+            {
+                if( opts.autoQuantize )
+                    v2Mesh->arrangeEfficient( VertexQuantizationSettings() );
+                else
+                    v2Mesh->arrangeEfficient( opts.halfPos, opts.halfTexCoords, opts.qTangents );
+            }
         }
 
         if (opts.recalcBounds)
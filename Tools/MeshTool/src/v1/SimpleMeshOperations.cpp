@@ -254,3 +254,35 @@ void recalcBounds( v1::MeshPtr &v1Mesh, MeshPtr &v2Mesh )
         v2Mesh->_setBoundingSphereRadius( radius );
     }
 }
+
+void optimizeVertexCache( MeshPtr &v2Mesh )
+{
+    if( !v2Mesh || !opts.optimizeVertexCache )
+        return;
+
+    const MeshOptimizer::VertexCacheStats before = v2Mesh->analyzeVertexCache();
+
+    cout << "Optimizing for the vertex cache..." << endl;
+    v2Mesh->optimizeVertexCache( opts.overdrawThreshold > 0.0f, true, opts.overdrawThreshold );
+
+    const MeshOptimizer::VertexCacheStats after = v2Mesh->analyzeVertexCache();
+
+    cout << "  ACMR: " << before.getAcmr() << " -> " << after.getAcmr() << endl;
+    cout << "  ATVR: " << before.getAtvr() << " -> " << after.getAtvr() << endl;
+}
+
+void buildMeshlets( MeshPtr &v2Mesh )
+{
+    if( !v2Mesh || !opts.buildMeshlets )
+        return;
+
+    cout << "Building meshlets..." << endl;
+    v2Mesh->buildMeshlets();
+
+    size_t numMeshlets = 0;
+    const size_t numSubMeshes = v2Mesh->getNumSubMeshes();
+    for( size_t i = 0; i < numSubMeshes; ++i )
+        numMeshlets += v2Mesh->getSubMesh( i )->getMeshlets( 0 ).size();
+
+    cout << "  Meshlets (LOD 0): " << numMeshlets << endl;
+}